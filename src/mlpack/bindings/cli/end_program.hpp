@@ -28,6 +28,21 @@ inline void EndProgram()
   // Stop the CLI timers.
   IO::GetSingleton().timer.StopAllTimers();
 
+  // Save the profile, if requested.
+  if (IO::HasParam("profile"))
+  {
+    Profiler::StopAll();
+    const std::string profileFile = IO::GetParam<std::string>("profile");
+    try
+    {
+      Profiler::Save(profileFile);
+    }
+    catch (std::exception& e)
+    {
+      Log::Warn << e.what() << std::endl;
+    }
+  }
+
   // Print any output.
   std::map<std::string, util::ParamData>& parameters = IO::Parameters();
   for (auto& it : parameters)
@@ -28,6 +28,10 @@ PARAM_STRING_IN("info", "Print help on a specific option.", "", "");
 PARAM_FLAG("verbose", "Display informational messages and the full list of "
     "parameters and timers at the end of execution.", "v");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_STRING_IN("profile", "If specified, a profile of the program (the time "
+    "spent in each nested timer, and counters such as the number of base "
+    "cases) is saved to this file as JSON, or in the Chrome trace-event format "
+    "if the filename ends in '.trace.json'.", "", "");
 
 /**
  * Parse the command line, setting all of the options inside of the CLI object
@@ -129,6 +133,10 @@ void ParseCommandLine(int argc, char** argv)
     Log::Info.ignoreInput = false;
   }
 
+  // Record the profile, if it will be saved.
+  if (IO::HasParam("profile"))
+    Profiler::Enable();
+
   // Now, issue an error if we forgot any required options.
   for (std::map<std::string, util::ParamData>::const_iterator iter =
        parameters.begin(); iter != parameters.end(); ++iter)
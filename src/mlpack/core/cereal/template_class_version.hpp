@@ -0,0 +1,44 @@
+/**
+ * @file core/cereal/template_class_version.hpp
+ *
+ * A version of CEREAL_CLASS_VERSION() for class templates.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_CEREAL_TEMPLATE_CLASS_VERSION_HPP
+#define MLPACK_CORE_CEREAL_TEMPLATE_CLASS_VERSION_HPP
+
+#include <cereal/details/helpers.hpp>
+#include <mlpack/core/util/sfinae_utility.hpp>
+
+/**
+ * Set the version of every instantiation of a class template, which is passed
+ * to its serialize() function.  CEREAL_CLASS_VERSION() only works for a single
+ * type, so this defines a partial specialization of cereal's Version struct
+ * instead.  If the template parameter list or the type contain commas, wrap
+ * them in SINGLE_ARG():
+ *
+ * @code
+ * CEREAL_TEMPLATE_CLASS_VERSION(SINGLE_ARG(template<typename A, typename B>),
+ *     SINGLE_ARG(Foo<A, B>), 1);
+ * @endcode
+ *
+ * @param SIGNATURE Template parameter list of the class template.
+ * @param T The class template, instantiated with those parameters.
+ * @param TVERSION Version number.
+ */
+#define CEREAL_TEMPLATE_CLASS_VERSION(SIGNATURE, T, TVERSION) \
+namespace cereal { \
+namespace detail { \
+SIGNATURE \
+struct Version<T> \
+{ \
+  static const std::uint32_t version = TVERSION; \
+}; \
+} \
+}
+
+#endif
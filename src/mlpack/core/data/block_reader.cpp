@@ -0,0 +1,368 @@
+/**
+ * @file core/data/block_reader.cpp
+ *
+ * Implementation of BlockReader.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "block_reader.hpp"
+#include "extension.hpp"
+#include "load_arff.hpp"
+#include "parallel_csv.hpp"
+
+#include <boost/algorithm/string/trim.hpp>
+
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+namespace {
+
+//! Get the size in bytes of the given Armadillo binary element type, or 0 if
+//! the type is not supported.
+size_t ElementSize(const std::string& elementType)
+{
+  if (elementType == "IU001" || elementType == "IS001")
+    return 1;
+  else if (elementType == "IU002" || elementType == "IS002")
+    return 2;
+  else if (elementType == "IU004" || elementType == "IS004" ||
+      elementType == "FN004")
+    return 4;
+  else if (elementType == "IU008" || elementType == "IS008" ||
+      elementType == "FN008")
+    return 8;
+  else
+    return 0;
+}
+
+//! Convert the given number of elements of type T, stored in the given bytes,
+//! to double.
+template<typename T>
+void ConvertElements(const char* bytes, const size_t count, double* out)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    T value;
+    std::memcpy(&value, bytes + i * sizeof(T), sizeof(T));
+    out[i] = double(value);
+  }
+}
+
+} // namespace
+
+BlockReader::BlockReader(const std::string& filename,
+                         const size_t blockSize,
+                         const bool transpose) :
+    filename(filename),
+    blockSize(blockSize),
+    transpose(transpose),
+    dimensionality(0),
+    pointsRead(0),
+    headerLines(0),
+    delimiter(','),
+    numPoints(0)
+{
+  Open(false);
+}
+
+BlockReader::BlockReader(const std::string& filename,
+                         const DatasetInfo& info,
+                         const size_t blockSize,
+                         const bool transpose) :
+    filename(filename),
+    blockSize(blockSize),
+    transpose(transpose),
+    dimensionality(0),
+    pointsRead(0),
+    headerLines(0),
+    info(info),
+    delimiter(','),
+    numPoints(0)
+{
+  Open(true);
+}
+
+void BlockReader::Open(const bool keepInfo)
+{
+  if (blockSize == 0)
+  {
+    throw std::invalid_argument("BlockReader: the block size must be greater "
+        "than 0.");
+  }
+
+  stream.open(filename, std::ios::in | std::ios::binary);
+  if (!stream.is_open())
+  {
+    std::ostringstream oss;
+    oss << "Cannot open file '" << filename << "'. " << std::endl;
+    throw std::runtime_error(oss.str());
+  }
+
+  const std::string extension = Extension(filename);
+  if (extension == "csv" || extension == "tsv" || extension == "txt")
+  {
+    type = TEXT;
+    delimiter = (extension == "csv") ? ',' :
+        ((extension == "txt") ? ' ' : '\t');
+
+    // The first line gives the dimensionality.
+    std::string line;
+    if (std::getline(stream, line))
+    {
+      std::vector<ParallelCSV::Token> tokens;
+      ParallelCSV::Tokenize(line.data(), line.data() + line.size(), delimiter,
+          tokens);
+      dimensionality = tokens.size();
+    }
+
+    stream.clear();
+    stream.seekg(0, std::ios::beg);
+    dataStart = stream.tellg();
+  }
+  else if (extension == "arff")
+  {
+    type = ARFF;
+    if (!keepInfo)
+      info = DatasetInfo();
+
+    headerLines = details::LoadARFFHeader<double>(stream, info,
+        categoryStrings);
+    dimensionality = info.Dimensionality();
+    dataStart = stream.tellg();
+  }
+  else if (extension == "bin")
+  {
+    type = ARMA_BINARY;
+
+    // The header is "ARMA_MAT_BIN_<type>", then the number of rows and columns
+    // and a single newline.
+    std::string header;
+    size_t rows = 0, cols = 0;
+    stream >> header >> rows >> cols;
+    stream.get();
+    if (!stream.good() || header.substr(0, 13) != "ARMA_MAT_BIN_")
+    {
+      throw std::runtime_error("BlockReader: '" + filename + "' is not an "
+          "Armadillo binary matrix.");
+    }
+
+    elementType = header.substr(13);
+    if (ElementSize(elementType) == 0)
+    {
+      throw std::runtime_error("BlockReader: elements of type '" + elementType
+          + "' in '" + filename + "' are not supported.");
+    }
+
+    dimensionality = transpose ? cols : rows;
+    numPoints = transpose ? rows : cols;
+    dataStart = stream.tellg();
+  }
+  else
+  {
+    throw std::runtime_error("BlockReader: unknown type of file '" + filename +
+        "'; only .csv, .tsv, .txt, .arff and .bin files can be read in "
+        "blocks.");
+  }
+
+  if (type != ARFF)
+  {
+    if (!keepInfo)
+    {
+      info = DatasetInfo(dimensionality);
+    }
+    else if (info.Dimensionality() != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "BlockReader: given DatasetInfo has dimensionality "
+          << info.Dimensionality() << ", but data has dimensionality "
+          << dimensionality << ".";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+}
+
+bool BlockReader::NextBlock(arma::mat& block)
+{
+  if (type == TEXT)
+    NextTextBlock(block);
+  else if (type == ARFF)
+    NextARFFBlock(block);
+  else
+    NextBinaryBlock(block);
+
+  pointsRead += block.n_cols;
+  return (block.n_cols > 0);
+}
+
+void BlockReader::Reset()
+{
+  stream.clear();
+  stream.seekg(dataStart);
+  pointsRead = 0;
+}
+
+void BlockReader::NextTextBlock(arma::mat& block)
+{
+  block.set_size(dimensionality, blockSize);
+
+  std::string line;
+  std::string token;
+  std::vector<ParallelCSV::Token> tokens;
+  size_t col = 0;
+  while (col < blockSize && std::getline(stream, line))
+  {
+    ParallelCSV::Tokenize(line.data(), line.data() + line.size(), delimiter,
+        tokens);
+    if (tokens.size() != dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "BlockReader::NextBlock(): wrong number of dimensions ("
+          << tokens.size() << ") on line " << (pointsRead + col)
+          << "; should be " << dimensionality << " dimensions.";
+      throw std::runtime_error(oss.str());
+    }
+
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      // Numeric dimensions can skip the DatasetInfo for numbers.
+      double value;
+      if (info.Type(d) == Datatype::numeric && ParallelCSV::ParseNumber(
+          tokens[d].first, tokens[d].second, value))
+      {
+        block(d, col) = value;
+      }
+      else
+      {
+        token.assign(tokens[d].first, tokens[d].second);
+        block(d, col) = info.MapString<double>(token, d);
+      }
+    }
+
+    ++col;
+  }
+
+  block.resize(dimensionality, col);
+}
+
+void BlockReader::NextARFFBlock(arma::mat& block)
+{
+  block.zeros(dimensionality, blockSize);
+
+  std::string line;
+  size_t col = 0;
+  while (col < blockSize && std::getline(stream, line))
+  {
+    // Empty lines and comments in the data section are skipped.
+    boost::trim(line);
+    if (line.empty() || line[0] == '%')
+      continue;
+
+    details::LoadARFFLine(line, info, categoryStrings,
+        headerLines + pointsRead + col, block.colptr(col));
+    ++col;
+  }
+
+  block.resize(dimensionality, col);
+}
+
+void BlockReader::NextBinaryBlock(arma::mat& block)
+{
+  const size_t count = std::min(blockSize, numPoints - pointsRead);
+  block.set_size(dimensionality, count);
+  if (count == 0)
+    return;
+
+  if (transpose)
+  {
+    // Each dimension is a column of the stored matrix, so the block is read
+    // one dimension at a time.
+    std::vector<double> values(count);
+    for (size_t d = 0; d < dimensionality; ++d)
+    {
+      ReadElements(d * numPoints + pointsRead, count, values.data());
+      for (size_t i = 0; i < count; ++i)
+        block(d, i) = values[i];
+    }
+  }
+  else
+  {
+    ReadElements(pointsRead * dimensionality, count * dimensionality,
+        block.memptr());
+  }
+}
+
+void BlockReader::ReadElements(const size_t index,
+                               const size_t count,
+                               double* out)
+{
+  const size_t elementSize = ElementSize(elementType);
+  std::vector<char> bytes(count * elementSize);
+  stream.clear();
+  stream.seekg(dataStart + std::streamoff(index * elementSize));
+  stream.read(bytes.data(), bytes.size());
+  if (!stream.good())
+  {
+    throw std::runtime_error("BlockReader::NextBlock(): unexpected end of '" +
+        filename + "'.");
+  }
+
+  if (elementType == "IU001")
+    ConvertElements<uint8_t>(bytes.data(), count, out);
+  else if (elementType == "IS001")
+    ConvertElements<int8_t>(bytes.data(), count, out);
+  else if (elementType == "IU002")
+    ConvertElements<uint16_t>(bytes.data(), count, out);
+  else if (elementType == "IS002")
+    ConvertElements<int16_t>(bytes.data(), count, out);
+  else if (elementType == "IU004")
+    ConvertElements<uint32_t>(bytes.data(), count, out);
+  else if (elementType == "IS004")
+    ConvertElements<int32_t>(bytes.data(), count, out);
+  else if (elementType == "IU008")
+    ConvertElements<uint64_t>(bytes.data(), count, out);
+  else if (elementType == "IS008")
+    ConvertElements<int64_t>(bytes.data(), count, out);
+  else if (elementType == "FN004")
+    ConvertElements<float>(bytes.data(), count, out);
+  else
+    ConvertElements<double>(bytes.data(), count, out);
+}
+
+bool NextLabeledBlock(BlockReader& reader,
+                      BlockReader& labelReader,
+                      arma::mat& block,
+                      arma::Row<size_t>& labels)
+{
+  if (labelReader.Dimensionality() != 1)
+  {
+    std::ostringstream oss;
+    oss << "NextLabeledBlock(): labels must have one dimension, but they have "
+        << labelReader.Dimensionality() << " dimensions.";
+    throw std::runtime_error(oss.str());
+  }
+
+  labelReader.BlockSize() = reader.BlockSize();
+  reader.NextBlock(block);
+  arma::mat labelBlock;
+  labelReader.NextBlock(labelBlock);
+  if (labelBlock.n_cols != block.n_cols)
+  {
+    std::ostringstream oss;
+    oss << "NextLabeledBlock(): " << (labelReader.PointsRead() <
+        reader.PointsRead() ? "fewer" : "more") << " labels than points "
+        << "after point " << std::min(reader.PointsRead(),
+        labelReader.PointsRead()) << ".";
+    throw std::runtime_error(oss.str());
+  }
+
+  labels = arma::conv_to<arma::Row<size_t>>::from(labelBlock);
+  return (block.n_cols > 0);
+}
+
+} // namespace data
+} // namespace mlpack
@@ -0,0 +1,207 @@
+/**
+ * @file core/data/block_reader.hpp
+ *
+ * Definition of BlockReader, which reads a dataset from disk one block of
+ * points at a time, so that datasets larger than memory can be used.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_BLOCK_READER_HPP
+#define MLPACK_CORE_DATA_BLOCK_READER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "dataset_mapper.hpp"
+
+#include <fstream>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A BlockReader streams a dataset from a file as a sequence of blocks of
+ * points; each block is a matrix with one point per column, as with
+ * data::Load(), and at most BlockSize() columns.  Only one block is held in
+ * memory at a time, so algorithms that can learn from one block at a time
+ * (such as the Fit() functions of StandardScaler and MinMaxScaler, streaming
+ * HoeffdingTree training and SGD-trained LogisticRegression and
+ * SoftmaxRegression) can be trained on datasets that are larger than memory.
+ *
+ * The supported formats are:
+ *
+ *  - CSV (.csv), TSV (.tsv) and space-separated text (.txt), with one point
+ *    per line, tokenized as data::Load() does.  Tokens that are not numbers
+ *    are mapped with the DatasetInfo (see Info()).  A dimension only becomes
+ *    categorical when its first such token is read, and numbers read before
+ *    then are not mapped; so for data with categorical dimensions, give the
+ *    DatasetInfo of a full load of the data (or of its ARFF header).
+ *  - ARFF (.arff); the dimension types and categories are taken from the
+ *    header.
+ *  - Armadillo binary (.bin).  As data::Save() stores the transpose of the
+ *    matrix by default, each row of the stored matrix is a point, unless
+ *    transpose is false.
+ *
+ * @code
+ * data::BlockReader reader("train.csv", 10000);
+ * arma::mat block;
+ * while (reader.NextBlock(block))
+ * {
+ *   // ... use the block ...
+ * }
+ * @endcode
+ */
+class BlockReader
+{
+ public:
+  /**
+   * Open the given file for reading in blocks of the given number of points.
+   * The type of the file is given by its extension.  A std::runtime_error is
+   * thrown if the file cannot be opened or its header cannot be read.
+   *
+   * @param filename Name of the file to read.
+   * @param blockSize Maximum number of points in each block.
+   * @param transpose For Armadillo binary files: if true, each row of the
+   *     stored matrix is a point (this is how data::Save() stores matrices).
+   */
+  BlockReader(const std::string& filename,
+              const size_t blockSize = 1024,
+              const bool transpose = true);
+
+  /**
+   * Open the given file for reading in blocks, mapping non-numeric tokens with
+   * the given DatasetInfo.  Pass the DatasetInfo of another load of the same
+   * kind of data (for instance, the training set) to get the same mappings.
+   * For CSV files, the dimensions of the DatasetInfo that are categorical map
+   * all of their tokens.
+   *
+   * @param filename Name of the file to read.
+   * @param info DatasetInfo to map tokens with.
+   * @param blockSize Maximum number of points in each block.
+   * @param transpose For Armadillo binary files: if true, each row of the
+   *     stored matrix is a point.
+   */
+  BlockReader(const std::string& filename,
+              const DatasetInfo& info,
+              const size_t blockSize = 1024,
+              const bool transpose = true);
+
+  /**
+   * Read the next block of points into the given matrix.  False is returned
+   * (and the matrix is emptied) once all points have been read.  A
+   * std::runtime_error is thrown if the file is malformed.
+   *
+   * @param block Matrix to store the points in, one per column.
+   */
+  bool NextBlock(arma::mat& block);
+
+  /**
+   * Read the next block of points into the given matrix, converting them to its
+   * element type (for instance, to read labels into an arma::Row<size_t>).
+   *
+   * @param block Matrix to store the points in, one per column.
+   */
+  template<typename eT>
+  bool NextBlock(arma::Mat<eT>& block)
+  {
+    arma::mat doubleBlock;
+    const bool read = NextBlock(doubleBlock);
+    block = arma::conv_to<arma::Mat<eT>>::from(doubleBlock);
+    return read;
+  }
+
+  //! Go back to the first point of the file.
+  void Reset();
+
+  //! Get the dimensionality of the points.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get the number of points read since the start of the file.
+  size_t PointsRead() const { return pointsRead; }
+
+  //! Get the maximum number of points in each block.
+  size_t BlockSize() const { return blockSize; }
+  //! Modify the maximum number of points in each block.
+  size_t& BlockSize() { return blockSize; }
+
+  //! Get the DatasetInfo with the types of the dimensions and the mappings of
+  //! the tokens read so far.
+  const DatasetInfo& Info() const { return info; }
+  //! Modify the DatasetInfo.
+  DatasetInfo& Info() { return info; }
+
+ private:
+  //! The kinds of files that can be read.
+  enum FileType
+  {
+    TEXT,
+    ARFF,
+    ARMA_BINARY
+  };
+
+  //! The name of the file.
+  std::string filename;
+  //! The kind of the file.
+  FileType type;
+  //! The open file.
+  std::ifstream stream;
+  //! The maximum number of points in each block.
+  size_t blockSize;
+  //! For binary files, whether each row of the stored matrix is a point.
+  bool transpose;
+  //! The dimensionality of the points.
+  size_t dimensionality;
+  //! The number of points read since the start of the file.
+  size_t pointsRead;
+  //! The position of the first point in the file.
+  std::streampos dataStart;
+  //! The number of lines before the first point (for error messages).
+  size_t headerLines;
+  //! The mappings of the tokens.
+  DatasetInfo info;
+  //! For text files, the delimiter between tokens.
+  char delimiter;
+  //! For ARFF files, the categories that the header lists for each dimension.
+  std::map<size_t, std::vector<std::string>> categoryStrings;
+  //! For binary files, the number of points in the file.
+  size_t numPoints;
+  //! For binary files, the type of the elements (such as "FN008").
+  std::string elementType;
+
+  //! Open the file and read its header.
+  void Open(const bool keepInfo);
+
+  //! Read the next block of a text file.
+  void NextTextBlock(arma::mat& block);
+  //! Read the next block of an ARFF file.
+  void NextARFFBlock(arma::mat& block);
+  //! Read the next block of a binary file.
+  void NextBinaryBlock(arma::mat& block);
+
+  //! Read the given number of elements of a binary file at the given index
+  //! of the stored matrix into the given memory, converting them to double.
+  void ReadElements(const size_t index, const size_t count, double* out);
+};
+
+/**
+ * Read the next block of points from the given reader, and the labels of those
+ * points from the given label reader.  The label file must hold one label per
+ * line (a single dimension); the block size of the label reader is set to the
+ * block size of the point reader, so that the labels line up with the points.
+ * False is returned once all points have been read.  A std::runtime_error is
+ * thrown if the files do not have the same number of points.
+ *
+ * @param reader Reader of the points.
+ * @param labelReader Reader of the labels.
+ * @param block Matrix to store the points in, one per column.
+ * @param labels Vector to store the labels of the points in.
+ */
+bool NextLabeledBlock(BlockReader& reader,
+                      BlockReader& labelReader,
+                      arma::mat& block,
+                      arma::Row<size_t>& labels);
+
+} // namespace data
+} // namespace mlpack
+
+#endif
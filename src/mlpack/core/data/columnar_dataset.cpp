@@ -0,0 +1,143 @@
+/**
+ * @file core/data/columnar_dataset.cpp
+ *
+ * Implementation of the non-templated functions of ColumnarDataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "columnar_dataset.hpp"
+
+namespace mlpack {
+namespace data {
+
+const size_t ColumnarDataset::HeaderSize;
+const size_t ColumnarDataset::EntrySize;
+const size_t ColumnarDataset::Alignment;
+
+ColumnarDataset::ColumnarDataset(const std::string& filename) :
+    file(filename, READ_ONLY),
+    elemSize(0),
+    elemKind(0),
+    dimensionality(0),
+    numPoints(0),
+    infoOffset(0),
+    infoSize(0)
+{
+  const char* header = file.Data();
+  if (file.Size() < HeaderSize ||
+      std::memcmp(header, columnarDatasetMagic, 8) != 0)
+  {
+    throw std::runtime_error("ColumnarDataset: '" + filename + "' is not a "
+        "columnar dataset file.");
+  }
+
+  uint32_t version;
+  uint64_t dims, points, offset, size;
+  std::memcpy(&version, header + 8, sizeof(uint32_t));
+  std::memcpy(&elemSize, header + 12, sizeof(uint32_t));
+  std::memcpy(&elemKind, header + 16, sizeof(uint32_t));
+  std::memcpy(&dims, header + 24, sizeof(uint64_t));
+  std::memcpy(&points, header + 32, sizeof(uint64_t));
+  std::memcpy(&offset, header + 40, sizeof(uint64_t));
+  std::memcpy(&size, header + 48, sizeof(uint64_t));
+
+  if (version != columnarDatasetVersion)
+  {
+    throw std::runtime_error("ColumnarDataset: '" + filename + "' has unknown "
+        "format version " + std::to_string(version) + ".");
+  }
+
+  const bool validType = (elemKind == 2) ? (elemSize == 4 || elemSize == 8) :
+      (elemKind <= 1 && (elemSize == 1 || elemSize == 2 || elemSize == 4 ||
+      elemSize == 8));
+  if (!validType)
+  {
+    throw std::runtime_error("ColumnarDataset: '" + filename + "' has an "
+        "unknown element type.");
+  }
+
+  // Make sure that everything the header points to is inside the file (and
+  // guard against overflow for corrupted sizes).
+  const size_t fileSize = file.Size();
+  if (dims > (fileSize - HeaderSize) / EntrySize || offset > fileSize ||
+      size > fileSize - offset)
+  {
+    throw std::runtime_error("ColumnarDataset: '" + filename + "' is "
+        "truncated.");
+  }
+
+  dimensionality = (size_t) dims;
+  numPoints = (size_t) points;
+  infoOffset = (size_t) offset;
+  infoSize = (size_t) size;
+
+  // Check every block now, so that loading never has to.
+  for (size_t d = 0; d < dimensionality; ++d)
+  {
+    const char* entry = header + HeaderSize + d * EntrySize;
+    uint64_t blockOffset, blockSize;
+    uint32_t codec;
+    std::memcpy(&blockOffset, entry, sizeof(uint64_t));
+    std::memcpy(&blockSize, entry + 8, sizeof(uint64_t));
+    std::memcpy(&codec, entry + 16, sizeof(uint32_t));
+
+    size_t width;
+    if (codec == UINT8_CODEC)
+      width = 1;
+    else if (codec == UINT16_CODEC)
+      width = 2;
+    else if (codec == UINT32_CODEC)
+      width = 4;
+    else if (codec == RAW_CODEC)
+      width = elemSize;
+    else
+      throw std::runtime_error("ColumnarDataset: dimension " +
+          std::to_string(d) + " of '" + filename + "' has an unknown codec.");
+
+    if (blockOffset % Alignment != 0 || blockOffset > fileSize ||
+        blockSize > fileSize - blockOffset || numPoints > blockSize / width ||
+        blockSize != numPoints * width)
+    {
+      throw std::runtime_error("ColumnarDataset: dimension " +
+          std::to_string(d) + " of '" + filename + "' is truncated or "
+          "corrupted.");
+    }
+  }
+}
+
+ColumnCodec ColumnarDataset::Codec(const size_t dimension) const
+{
+  size_t size;
+  ColumnCodec codec;
+  Block(dimension, size, codec);
+  return codec;
+}
+
+const char* ColumnarDataset::Block(const size_t dimension,
+                                   size_t& size,
+                                   ColumnCodec& codec) const
+{
+  if (dimension >= dimensionality)
+  {
+    throw std::invalid_argument("ColumnarDataset: dimension " +
+        std::to_string(dimension) + " is out of range (dimensionality " +
+        std::to_string(dimensionality) + ").");
+  }
+
+  const char* entry = file.Data() + HeaderSize + dimension * EntrySize;
+  uint64_t blockOffset, blockSize;
+  uint32_t blockCodec;
+  std::memcpy(&blockOffset, entry, sizeof(uint64_t));
+  std::memcpy(&blockSize, entry + 8, sizeof(uint64_t));
+  std::memcpy(&blockCodec, entry + 16, sizeof(uint32_t));
+
+  size = (size_t) blockSize;
+  codec = (ColumnCodec) blockCodec;
+  return file.Data() + blockOffset;
+}
+
+} // namespace data
+} // namespace mlpack
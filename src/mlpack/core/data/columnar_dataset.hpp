@@ -0,0 +1,222 @@
+/**
+ * @file core/data/columnar_dataset.hpp
+ *
+ * Definition of ColumnarDataset, mlpack's binary dataset format, which keeps
+ * the mappings of a DatasetMapper alongside the data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_COLUMNAR_DATASET_HPP
+#define MLPACK_CORE_DATA_COLUMNAR_DATASET_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "dataset_mapper.hpp"
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The ways in which the values of one dimension can be stored in a
+ * ColumnarDataset file.
+ */
+enum ColumnCodec
+{
+  //! The values are stored with the element type of the file.
+  RAW_CODEC = 0,
+  //! The values are non-negative integers stored in one byte each.
+  UINT8_CODEC = 1,
+  //! The values are non-negative integers stored in two bytes each.
+  UINT16_CODEC = 2,
+  //! The values are non-negative integers stored in four bytes each.
+  UINT32_CODEC = 3
+};
+
+/**
+ * A dataset held in mlpack's columnar binary format (denoted by .mlds).  The
+ * file holds a header, the values of each dimension as one contiguous,
+ * aligned block (one "column" of the file, as a CSV file would show it), and
+ * the types and mappings of a DatasetMapper.  Reloading the dataset needs no
+ * parsing, keeps the categorical mappings, and can read any subset of the
+ * dimensions without touching the others.
+ *
+ * When compression is enabled, a dimension whose values are all small
+ * non-negative integers (as categorical dimensions and labels are) is stored
+ * with the narrowest unsigned integer type that holds them; see ColumnCodec.
+ * Other dimensions are stored as they are.
+ *
+ * The file is accessed through a read-only memory mapping.  The blocks of
+ * uncompressed dimensions can be used in place with Dimension(), without any
+ * copy.
+ *
+ * Files are usually written and read with data::Save() and data::Load() with a
+ * DatasetMapper:
+ *
+ * @code
+ * arma::mat dataset;
+ * data::DatasetInfo info;
+ * data::Load("train.csv", dataset, info);
+ * data::Save("train.mlds", dataset, info);
+ *
+ * // Later, without parsing the CSV again:
+ * data::Load("train.mlds", dataset, info);
+ *
+ * // Or only read dimensions 0 and 3:
+ * data::ColumnarDataset file("train.mlds");
+ * file.Load({ 0, 3 }, dataset, info);
+ * @endcode
+ */
+class ColumnarDataset
+{
+ public:
+  //! Size of the header at the start of the file, in bytes.
+  static const size_t HeaderSize = 64;
+  //! Size of each entry of the directory of dimensions, in bytes.
+  static const size_t EntrySize = 24;
+  //! Alignment of the block of each dimension, in bytes.
+  static const size_t Alignment = 64;
+
+  /**
+   * Map the given file, which must have been written by Save().  A
+   * std::runtime_error is thrown if the file cannot be mapped or is not a
+   * valid ColumnarDataset file.
+   *
+   * @param filename File to map.
+   */
+  ColumnarDataset(const std::string& filename);
+
+  /**
+   * Write the given dataset, with the types and mappings of the given
+   * DatasetMapper, to a file.  A std::runtime_error is thrown if the file
+   * cannot be written.
+   *
+   * @param filename File to write.
+   * @param matrix Dataset to write.
+   * @param info DatasetMapper with the types and mappings of the dataset.
+   * @param transpose If true, each column of the matrix is a point (as usual
+   *     in mlpack); otherwise each row is a point.
+   * @param compress If true, dimensions of small non-negative integers are
+   *     stored in narrower types.
+   */
+  template<typename eT, typename PolicyType>
+  static void Save(const std::string& filename,
+                   const arma::Mat<eT>& matrix,
+                   const DatasetMapper<PolicyType>& info,
+                   const bool transpose = true,
+                   const bool compress = true);
+
+  /**
+   * Load all the dimensions of the dataset, converting the values to the
+   * element type of the matrix, and recreate the given DatasetMapper with the
+   * stored types and mappings (its policy is kept).
+   *
+   * @param matrix Matrix to load the dataset into.
+   * @param info DatasetMapper to store the types and mappings in.
+   * @param transpose If true, each column of the matrix is a point; otherwise
+   *     each row is a point.
+   */
+  template<typename eT, typename PolicyType>
+  void Load(arma::Mat<eT>& matrix,
+            DatasetMapper<PolicyType>& info,
+            const bool transpose = true) const;
+
+  /**
+   * Load only the given dimensions of the dataset, in the given order.  The
+   * DatasetMapper is recreated with the types and mappings of those
+   * dimensions only.  The blocks of the other dimensions are never read.
+   *
+   * @param dimensions Dimensions to load.
+   * @param matrix Matrix to load the dimensions into.
+   * @param info DatasetMapper to store the types and mappings in.
+   * @param transpose If true, each column of the matrix is a point; otherwise
+   *     each row is a point.
+   */
+  template<typename eT, typename PolicyType>
+  void Load(const std::vector<size_t>& dimensions,
+            arma::Mat<eT>& matrix,
+            DatasetMapper<PolicyType>& info,
+            const bool transpose = true) const;
+
+  /**
+   * Recreate the given DatasetMapper with the stored types and mappings of all
+   * dimensions, without loading any data.
+   *
+   * @param info DatasetMapper to store the types and mappings in.
+   */
+  template<typename PolicyType>
+  void LoadInfo(DatasetMapper<PolicyType>& info) const;
+
+  /**
+   * Get the values of one dimension as a const row vector that uses the
+   * read-only mapped memory directly.  The dimension must be stored
+   * uncompressed (RAW_CODEC) with element type eT, or a std::runtime_error is
+   * thrown.  The vector must not outlive this object; copy it to get a
+   * modifiable vector.
+   *
+   * @param dimension Dimension to get.
+   */
+  template<typename eT>
+  const arma::Row<eT> Dimension(const size_t dimension) const;
+
+  //! Get the number of dimensions.
+  size_t Dimensionality() const { return dimensionality; }
+  //! Get the number of points.
+  size_t NumPoints() const { return numPoints; }
+  //! Get the codec that the given dimension is stored with.
+  ColumnCodec Codec(const size_t dimension) const;
+
+ private:
+  //! The mapped file.
+  MappedFile file;
+  //! The size in bytes of the element type of the file.
+  uint32_t elemSize;
+  //! The kind of the element type: 0 is unsigned integer, 1 is signed integer,
+  //! and 2 is floating point.
+  uint32_t elemKind;
+  //! The number of dimensions.
+  size_t dimensionality;
+  //! The number of points.
+  size_t numPoints;
+  //! The offset of the serialized DatasetMapper in the file.
+  size_t infoOffset;
+  //! The size of the serialized DatasetMapper in bytes.
+  size_t infoSize;
+
+  //! Get the start of the block of the given dimension, with its size in bytes
+  //! and its codec.
+  const char* Block(const size_t dimension,
+                    size_t& size,
+                    ColumnCodec& codec) const;
+
+  //! Decode the block of the given dimension into the given memory, which has
+  //! room for NumPoints() elements.
+  template<typename eT>
+  void DecodeDimension(const size_t dimension, eT* out) const;
+
+  //! Decode the given number of values of type T into the given memory.
+  template<typename T, typename eT>
+  static void Convert(const char* block, const size_t count, eT* out);
+
+  //! Write the given values to the given stream as values of type T.
+  template<typename T, typename eT>
+  static void WriteValues(std::ostream& stream, const arma::Col<eT>& values);
+
+  //! Get the kind of element type used for eT (see elemKind).
+  template<typename eT>
+  static uint32_t ElemKind();
+
+  //! Get the narrowest codec that holds all the given values exactly.
+  template<typename eT>
+  static ColumnCodec ChooseCodec(const arma::Col<eT>& values);
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "columnar_dataset_impl.hpp"
+
+#endif
@@ -0,0 +1,344 @@
+/**
+ * @file core/data/columnar_dataset_impl.hpp
+ *
+ * Implementation of the templated functions of ColumnarDataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_COLUMNAR_DATASET_IMPL_HPP
+#define MLPACK_CORE_DATA_COLUMNAR_DATASET_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "columnar_dataset.hpp"
+
+#include <cereal/archives/binary.hpp>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+namespace mlpack {
+namespace data {
+
+// The file is laid out as follows (all values in native byte order):
+//
+//   bytes  0 -  7: the magic string "MLPACKCD"
+//   bytes  8 - 11: format version (uint32_t)
+//   bytes 12 - 15: size of one element in bytes (uint32_t)
+//   bytes 16 - 19: kind of element, see ElemKind() (uint32_t)
+//   bytes 24 - 31: number of dimensions (uint64_t)
+//   bytes 32 - 39: number of points (uint64_t)
+//   bytes 40 - 47: offset of the serialized DatasetMapper (uint64_t)
+//   bytes 48 - 55: size of the serialized DatasetMapper (uint64_t)
+//
+// The remaining bytes of the header are zero.  The header is followed by one
+// directory entry for each dimension: the offset of its block (uint64_t), the
+// size of its block in bytes (uint64_t) and its ColumnCodec (uint32_t), padded
+// to EntrySize bytes.  Each block starts at a multiple of Alignment bytes.
+// The DatasetMapper is serialized with cereal's binary archive after the last
+// block.
+static const char columnarDatasetMagic[8] = { 'M', 'L', 'P', 'A', 'C', 'K', 'C',
+    'D' };
+static const uint32_t columnarDatasetVersion = 1;
+
+template<typename eT, typename PolicyType>
+void ColumnarDataset::Save(const std::string& filename,
+                           const arma::Mat<eT>& matrix,
+                           const DatasetMapper<PolicyType>& info,
+                           const bool transpose,
+                           const bool compress)
+{
+  const size_t dimensionality = transpose ? matrix.n_rows : matrix.n_cols;
+  const size_t numPoints = transpose ? matrix.n_cols : matrix.n_rows;
+  if (info.Dimensionality() != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "ColumnarDataset::Save(): DatasetMapper has dimensionality "
+        << info.Dimensionality() << ", but the dataset has dimensionality "
+        << dimensionality << ".";
+    throw std::invalid_argument(oss.str());
+  }
+
+  std::ofstream stream(filename, std::ios::out | std::ios::binary |
+      std::ios::trunc);
+  if (!stream.is_open())
+  {
+    throw std::runtime_error("ColumnarDataset::Save(): cannot open '" +
+        filename + "' for writing.");
+  }
+
+  // The header and the directory are written once the blocks are in place.
+  std::vector<char> header(HeaderSize + dimensionality * EntrySize, 0);
+  stream.write(header.data(), header.size());
+  uint64_t offset = header.size();
+
+  const char padding[Alignment] = { 0 };
+  arma::Col<eT> values;
+  for (size_t d = 0; d < dimensionality; ++d)
+  {
+    if (transpose)
+      values = matrix.row(d).t();
+    else
+      values = matrix.col(d);
+
+    const uint32_t codec = compress ? ChooseCodec(values) : RAW_CODEC;
+
+    const size_t padSize = (Alignment - offset % Alignment) % Alignment;
+    stream.write(padding, padSize);
+    offset += padSize;
+
+    uint64_t size;
+    if (codec == UINT8_CODEC)
+    {
+      WriteValues<uint8_t>(stream, values);
+      size = numPoints * sizeof(uint8_t);
+    }
+    else if (codec == UINT16_CODEC)
+    {
+      WriteValues<uint16_t>(stream, values);
+      size = numPoints * sizeof(uint16_t);
+    }
+    else if (codec == UINT32_CODEC)
+    {
+      WriteValues<uint32_t>(stream, values);
+      size = numPoints * sizeof(uint32_t);
+    }
+    else
+    {
+      stream.write((const char*) values.memptr(), numPoints * sizeof(eT));
+      size = numPoints * sizeof(eT);
+    }
+
+    char* entry = header.data() + HeaderSize + d * EntrySize;
+    std::memcpy(entry, &offset, sizeof(uint64_t));
+    std::memcpy(entry + 8, &size, sizeof(uint64_t));
+    std::memcpy(entry + 16, &codec, sizeof(uint32_t));
+    offset += size;
+  }
+
+  // Now the mappings.
+  std::ostringstream infoStream(std::ios::out | std::ios::binary);
+  {
+    cereal::BinaryOutputArchive ar(infoStream);
+    ar(cereal::make_nvp("info", info));
+  }
+  const std::string infoBytes = infoStream.str();
+  stream.write(infoBytes.data(), infoBytes.size());
+
+  const uint32_t elemSize = sizeof(eT);
+  const uint32_t elemKind = ElemKind<eT>();
+  const uint64_t dims = dimensionality;
+  const uint64_t points = numPoints;
+  const uint64_t infoSize = infoBytes.size();
+  std::memcpy(header.data(), columnarDatasetMagic, 8);
+  std::memcpy(header.data() + 8, &columnarDatasetVersion, sizeof(uint32_t));
+  std::memcpy(header.data() + 12, &elemSize, sizeof(uint32_t));
+  std::memcpy(header.data() + 16, &elemKind, sizeof(uint32_t));
+  std::memcpy(header.data() + 24, &dims, sizeof(uint64_t));
+  std::memcpy(header.data() + 32, &points, sizeof(uint64_t));
+  std::memcpy(header.data() + 40, &offset, sizeof(uint64_t));
+  std::memcpy(header.data() + 48, &infoSize, sizeof(uint64_t));
+
+  stream.seekp(0);
+  stream.write(header.data(), header.size());
+  stream.close();
+  if (stream.fail())
+  {
+    throw std::runtime_error("ColumnarDataset::Save(): error while writing '"
+        + filename + "'.");
+  }
+}
+
+template<typename eT, typename PolicyType>
+void ColumnarDataset::Load(arma::Mat<eT>& matrix,
+                           DatasetMapper<PolicyType>& info,
+                           const bool transpose) const
+{
+  std::vector<size_t> dimensions(dimensionality);
+  for (size_t d = 0; d < dimensionality; ++d)
+    dimensions[d] = d;
+
+  Load(dimensions, matrix, info, transpose);
+}
+
+template<typename eT, typename PolicyType>
+void ColumnarDataset::Load(const std::vector<size_t>& dimensions,
+                           arma::Mat<eT>& matrix,
+                           DatasetMapper<PolicyType>& info,
+                           const bool transpose) const
+{
+  for (size_t i = 0; i < dimensions.size(); ++i)
+  {
+    if (dimensions[i] >= dimensionality)
+    {
+      std::ostringstream oss;
+      oss << "ColumnarDataset::Load(): dimension " << dimensions[i] << " is "
+          << "out of range (dimensionality " << dimensionality << ").";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  // Each dimension is decoded into a contiguous column; the blocks are
+  // independent, so they are decoded in parallel.
+  arma::Mat<eT> columns(numPoints, dimensions.size());
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) dimensions.size(); ++i)
+    DecodeDimension(dimensions[i], columns.colptr(i));
+
+  if (transpose)
+    matrix = columns.t();
+  else
+    matrix = std::move(columns);
+
+  LoadInfo(info);
+  if (dimensions.size() != dimensionality)
+    info.SelectDimensions(dimensions);
+}
+
+template<typename PolicyType>
+void ColumnarDataset::LoadInfo(DatasetMapper<PolicyType>& info) const
+{
+  std::istringstream infoStream(std::string(file.Data() + infoOffset,
+      infoSize), std::ios::in | std::ios::binary);
+  cereal::BinaryInputArchive ar(infoStream);
+  ar(cereal::make_nvp("info", info));
+}
+
+template<typename eT>
+const arma::Row<eT> ColumnarDataset::Dimension(
+    const size_t dimension) const
+{
+  size_t size;
+  ColumnCodec codec;
+  const char* block = Block(dimension, size, codec);
+  if (codec != RAW_CODEC || elemSize != sizeof(eT) ||
+      elemKind != ElemKind<eT>())
+  {
+    throw std::runtime_error("ColumnarDataset::Dimension(): dimension " +
+        std::to_string(dimension) + " of '" + file.Filename() + "' is not "
+        "stored uncompressed with the requested element type.");
+  }
+
+  // Use the advanced constructor to create a strict alias of the mapped data.
+  // The mapping is read-only, so the alias is returned as const.
+  return arma::Row<eT>((eT*) block, numPoints, false, true);
+}
+
+template<typename eT>
+void ColumnarDataset::DecodeDimension(const size_t dimension, eT* out) const
+{
+  size_t size;
+  ColumnCodec codec;
+  const char* block = Block(dimension, size, codec);
+
+  // The constructor has checked that the codec and the element type are valid
+  // and that the block holds numPoints values.
+  if (codec == UINT8_CODEC)
+    Convert<uint8_t>(block, numPoints, out);
+  else if (codec == UINT16_CODEC)
+    Convert<uint16_t>(block, numPoints, out);
+  else if (codec == UINT32_CODEC)
+    Convert<uint32_t>(block, numPoints, out);
+  else if (elemKind == 2)
+  {
+    if (elemSize == 4)
+      Convert<float>(block, numPoints, out);
+    else
+      Convert<double>(block, numPoints, out);
+  }
+  else if (elemKind == 1)
+  {
+    if (elemSize == 1)
+      Convert<int8_t>(block, numPoints, out);
+    else if (elemSize == 2)
+      Convert<int16_t>(block, numPoints, out);
+    else if (elemSize == 4)
+      Convert<int32_t>(block, numPoints, out);
+    else
+      Convert<int64_t>(block, numPoints, out);
+  }
+  else
+  {
+    if (elemSize == 1)
+      Convert<uint8_t>(block, numPoints, out);
+    else if (elemSize == 2)
+      Convert<uint16_t>(block, numPoints, out);
+    else if (elemSize == 4)
+      Convert<uint32_t>(block, numPoints, out);
+    else
+      Convert<uint64_t>(block, numPoints, out);
+  }
+}
+
+template<typename T, typename eT>
+void ColumnarDataset::Convert(const char* block, const size_t count, eT* out)
+{
+  // Blocks are aligned, so they can be read in place.
+  const T* values = (const T*) block;
+  if (std::is_same<T, eT>::value)
+  {
+    std::memcpy(out, values, count * sizeof(eT));
+    return;
+  }
+
+  for (size_t i = 0; i < count; ++i)
+    out[i] = eT(values[i]);
+}
+
+template<typename T, typename eT>
+void ColumnarDataset::WriteValues(std::ostream& stream,
+                                  const arma::Col<eT>& values)
+{
+  std::vector<T> narrowed(values.n_elem);
+  for (size_t i = 0; i < values.n_elem; ++i)
+    narrowed[i] = T(values[i]);
+
+  stream.write((const char*) narrowed.data(), narrowed.size() * sizeof(T));
+}
+
+template<typename eT>
+uint32_t ColumnarDataset::ElemKind()
+{
+  if (std::is_floating_point<eT>::value)
+    return 2;
+  else if (std::is_signed<eT>::value)
+    return 1;
+  else
+    return 0;
+}
+
+template<typename eT>
+ColumnCodec ColumnarDataset::ChooseCodec(const arma::Col<eT>& values)
+{
+  // Only values that are exact non-negative integers can be narrowed; NaN
+  // fails every comparison below.
+  double maxValue = 0.0;
+  for (size_t i = 0; i < values.n_elem; ++i)
+  {
+    const double value = double(values[i]);
+    if (!(value >= 0.0) || value != std::floor(value) ||
+        eT(value) != values[i])
+      return RAW_CODEC;
+
+    maxValue = std::max(maxValue, value);
+  }
+
+  if (sizeof(eT) > 1 && maxValue <= double(std::numeric_limits<uint8_t>::max()))
+    return UINT8_CODEC;
+  else if (sizeof(eT) > 2 &&
+      maxValue <= double(std::numeric_limits<uint16_t>::max()))
+    return UINT16_CODEC;
+  else if (sizeof(eT) > 4 &&
+      maxValue <= double(std::numeric_limits<uint32_t>::max()))
+    return UINT32_CODEC;
+  else
+    return RAW_CODEC;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -63,6 +63,16 @@ class DatasetMapper
    */
   void SetDimensionality(const size_t dimensionality);
 
+  /**
+   * Keep only the given dimensions, in the given order, with their types and
+   * mappings; dimension i of the result is dimension dimensions[i] of this
+   * object.  A std::invalid_argument is thrown if any dimension is out of
+   * range.
+   *
+   * @param dimensions Dimensions to keep.
+   */
+  void SelectDimensions(const std::vector<size_t>& dimensions);
+
   /**
    * Preprocessing: during a first pass of the data, pass the input on to the
    * MapPolicy if they are needed.
@@ -45,6 +45,33 @@ inline void DatasetMapper<PolicyType, InputType>::SetDimensionality(
   maps.clear();
 }
 
+template<typename PolicyType, typename InputType>
+inline void DatasetMapper<PolicyType, InputType>::SelectDimensions(
+    const std::vector<size_t>& dimensions)
+{
+  std::vector<Datatype> newTypes(dimensions.size());
+  MapType newMaps;
+  for (size_t i = 0; i < dimensions.size(); ++i)
+  {
+    if (dimensions[i] >= types.size())
+    {
+      std::ostringstream oss;
+      oss << "DatasetMapper<PolicyType, InputType>::SelectDimensions(): "
+          << "dimension " << dimensions[i] << " is out of range "
+          << "(dimensionality " << types.size() << ")";
+      throw std::invalid_argument(oss.str());
+    }
+
+    newTypes[i] = types[dimensions[i]];
+    typename MapType::const_iterator it = maps.find(dimensions[i]);
+    if (it != maps.end())
+      newMaps[i] = it->second;
+  }
+
+  types.swap(newTypes);
+  maps.swap(newMaps);
+}
+
 // Utility helper function to call MapFirstPass.
 template<typename PolicyType, typename InputType, typename T>
 void CallMapFirstPass(
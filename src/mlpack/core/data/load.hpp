@@ -255,12 +255,15 @@ bool Load(const std::string& filename,
  * Loads a matrix from a file, guessing the filetype from the extension and
  * mapping categorical features with a DatasetMapper object.  This will
  * transpose the matrix (unless the transpose parameter is set to false).
- * This particular overload of Load() can only load text-based formats, such as
- * those given below:
+ * This particular overload of Load() can only load the formats given below:
  *
  * - CSV (csv_ascii), denoted by .csv, or optionally .txt
  * - TSV (raw_ascii), denoted by .tsv, .csv, or .txt
  * - ASCII (raw_ascii), denoted by .txt
+ * - ARFF, denoted by .arff
+ * - mlpack's columnar binary format (see ColumnarDataset), denoted by .mlds;
+ *   this keeps the mappings of the DatasetMapper it was saved with, and needs
+ *   no parsing
  *
  * If the file extension is not one of those types, an error will be given.
  * This is preferable to Armadillo's default behavior of loading an unknown
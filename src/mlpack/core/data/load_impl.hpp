@@ -19,6 +19,7 @@
 #include <mlpack/core/util/timers.hpp>
 
 #include "load_csv.hpp"
+#include "parallel_csv.hpp"
 #include "load.hpp"
 #include "extension.hpp"
 #include "detect_file_type.hpp"
@@ -28,6 +29,7 @@
 #include <boost/algorithm/string.hpp>
 
 #include "load_arff.hpp"
+#include "columnar_dataset.hpp"
 
 namespace mlpack {
 namespace data {
@@ -162,9 +164,32 @@ bool Load(const std::string& filename,
     Log::Info << "Loading '" << filename << "' as " << stringType << ".  "
         << std::flush;
 
+  // Numeric CSV and text files are parsed in parallel, directly into their
+  // final layout.  Anything that the parallel parser can't read in full (such
+  // as missing values or ragged lines) is left to Armadillo.
+  bool success = false;
+  bool parsed = false;
+  const std::string extension = Extension(filename);
+  if (std::is_same<eT, double>::value &&
+      ((loadType == arma::csv_ascii && extension == "csv") ||
+       (loadType == arma::raw_ascii && (extension == "tsv" ||
+        extension == "txt"))))
+  {
+    try
+    {
+      ParallelCSV parser(filename);
+      parsed = parser.LoadNumeric(matrix, transpose);
+    }
+    catch (std::exception& /* e */)
+    {
+      parsed = false;
+    }
+  }
+
   // We can't use the stream if the type is HDF5.
-  bool success;
-  if (loadType != arma::hdf5_binary)
+  if (parsed)
+    success = true;
+  else if (loadType != arma::hdf5_binary)
     success = matrix.load(stream, loadType);
   else
     success = matrix.load(filename, loadType);
@@ -180,12 +205,16 @@ bool Load(const std::string& filename,
 
     return false;
   }
+  else if (parsed)
+    Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols
+        << ".\n";
   else
     Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
         << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
 
-  // Now transpose the matrix, if necessary.
-  if (transpose)
+  // Now transpose the matrix, if necessary.  The parallel parser has already
+  // done it.
+  if (transpose && !parsed)
   {
     success = inplace_transpose(matrix, fatal);
   }
@@ -270,6 +299,26 @@ bool Load(const std::string& filename,
       return false;
     }
   }
+  else if (extension == "mlds")
+  {
+    Log::Info << "Loading '" << filename << "' as columnar dataset.  "
+        << std::flush;
+    try
+    {
+      ColumnarDataset file(filename);
+      file.Load(matrix, info, transpose);
+    }
+    catch (std::exception& e)
+    {
+      Timer::Stop("loading_data");
+      if (fatal)
+        Log::Fatal << e.what() << std::endl;
+      else
+        Log::Warn << e.what() << std::endl;
+
+      return false;
+    }
+  }
   else
   {
     // The type is unknown.
@@ -400,12 +449,16 @@ bool Load(const std::string& filename,
 
     return false;
   }
+  else if (parsed)
+    Log::Info << "Size is " << matrix.n_rows << " x " << matrix.n_cols
+        << ".\n";
   else
     Log::Info << "Size is " << (transpose ? matrix.n_cols : matrix.n_rows)
         << " x " << (transpose ? matrix.n_rows : matrix.n_cols) << ".\n";
 
-  // Now transpose the matrix, if necessary.
-  if (transpose)
+  // Now transpose the matrix, if necessary.  The parallel parser has already
+  // done it.
+  if (transpose && !parsed)
   {
     success = inplace_transpose(matrix, fatal);
   }
@@ -142,6 +142,9 @@ class IncrementPolicy
     }
   }
 
+  //! Get whether or not all inputs are mapped.
+  bool ForceAllMappings() const { return forceAllMappings; }
+
  private:
   // Whether or not we should map all tokens.
   bool forceAllMappings;
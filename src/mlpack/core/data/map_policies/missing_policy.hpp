@@ -134,6 +134,9 @@ class MissingPolicy
     }
   }
 
+  //! Get the set of strings that are mapped.
+  const std::set<std::string>& MissingSet() const { return missingSet; }
+
  private:
   // Note that missingSet and maps are different.
   // missingSet specifies which value/string should be mapped and may be a
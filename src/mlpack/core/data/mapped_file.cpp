@@ -0,0 +1,253 @@
+/**
+ * @file core/data/mapped_file.cpp
+ *
+ * Implementation of MappedFile, for POSIX systems and Windows.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "mapped_file.hpp"
+
+#ifdef _WIN32
+  #ifndef NOMINMAX
+    #define NOMINMAX
+  #endif
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+MappedFile::MappedFile() :
+    mode(READ_ONLY),
+    data(NULL),
+    size(0),
+    fileHandle(-1),
+    mappingHandle(0)
+{
+  // Nothing to do.
+}
+
+MappedFile::MappedFile(const std::string& filename,
+                       const MappingMode mode,
+                       const size_t size) :
+    filename(filename),
+    mode(mode),
+    data(NULL),
+    size(0),
+    fileHandle(-1),
+    mappingHandle(0)
+{
+  if (size > 0 && mode != READ_WRITE)
+  {
+    throw std::invalid_argument("MappedFile: a new file can only be created "
+        "in READ_WRITE mode!");
+  }
+
+  // The reason for a failure, if there is one.
+  std::string error;
+
+#ifdef _WIN32
+  const DWORD access = (mode == READ_WRITE) ? (GENERIC_READ | GENERIC_WRITE) :
+      GENERIC_READ;
+  const DWORD creation = (size > 0) ? CREATE_ALWAYS : OPEN_EXISTING;
+  HANDLE file = CreateFileA(filename.c_str(), access, FILE_SHARE_READ, NULL,
+      creation, FILE_ATTRIBUTE_NORMAL, NULL);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    error = "could not open file (error " + std::to_string(GetLastError()) +
+        ")";
+  }
+  else
+  {
+    fileHandle = (intptr_t) file;
+
+    LARGE_INTEGER fileSize;
+    if (size > 0)
+    {
+      fileSize.QuadPart = (LONGLONG) size;
+      if (!SetFilePointerEx(file, fileSize, NULL, FILE_BEGIN) ||
+          !SetEndOfFile(file))
+      {
+        error = "could not resize file (error " +
+            std::to_string(GetLastError()) + ")";
+      }
+    }
+    else if (!GetFileSizeEx(file, &fileSize))
+    {
+      error = "could not get file size (error " +
+          std::to_string(GetLastError()) + ")";
+    }
+
+    if (error.empty())
+      this->size = (size_t) fileSize.QuadPart;
+  }
+
+  if (error.empty() && this->size == 0)
+    error = "file is empty";
+
+  if (error.empty())
+  {
+    const DWORD protect = (mode == READ_ONLY) ? PAGE_READONLY :
+        ((mode == COPY_ON_WRITE) ? PAGE_WRITECOPY : PAGE_READWRITE);
+    HANDLE mapping = CreateFileMappingA(file, NULL, protect, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+      error = "could not create mapping (error " +
+          std::to_string(GetLastError()) + ")";
+    }
+    else
+    {
+      mappingHandle = (intptr_t) mapping;
+
+      const DWORD viewAccess = (mode == READ_ONLY) ? FILE_MAP_READ :
+          ((mode == COPY_ON_WRITE) ? FILE_MAP_COPY : FILE_MAP_WRITE);
+      data = (char*) MapViewOfFile(mapping, viewAccess, 0, 0, 0);
+      if (data == NULL)
+      {
+        error = "could not map file (error " + std::to_string(GetLastError()) +
+            ")";
+      }
+    }
+  }
+#else
+  const int fd = (size > 0) ?
+      open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644) :
+      open(filename.c_str(), (mode == READ_WRITE) ? O_RDWR : O_RDONLY);
+  if (fd < 0)
+  {
+    error = std::string("could not open file: ") + std::strerror(errno);
+  }
+  else
+  {
+    fileHandle = fd;
+
+    if (size > 0)
+    {
+      if (ftruncate(fd, (off_t) size) != 0)
+        error = std::string("could not resize file: ") + std::strerror(errno);
+      else
+        this->size = size;
+    }
+    else
+    {
+      struct stat fileStat;
+      if (fstat(fd, &fileStat) != 0)
+        error = std::string("could not get file size: ") + std::strerror(errno);
+      else
+        this->size = (size_t) fileStat.st_size;
+    }
+  }
+
+  if (error.empty() && this->size == 0)
+    error = "file is empty";
+
+  if (error.empty())
+  {
+    const int protection = (mode == READ_ONLY) ? PROT_READ :
+        (PROT_READ | PROT_WRITE);
+    const int flags = (mode == READ_WRITE) ? MAP_SHARED : MAP_PRIVATE;
+    void* mapped = mmap(NULL, this->size, protection, flags, fd, 0);
+    if (mapped == MAP_FAILED)
+      error = std::string("could not map file: ") + std::strerror(errno);
+    else
+      data = (char*) mapped;
+  }
+#endif
+
+  if (!error.empty())
+  {
+    Close();
+    throw std::runtime_error("MappedFile: cannot map '" + filename + "': " +
+        error + ".");
+  }
+}
+
+MappedFile::MappedFile(MappedFile&& other) :
+    filename(std::move(other.filename)),
+    mode(other.mode),
+    data(other.data),
+    size(other.size),
+    fileHandle(other.fileHandle),
+    mappingHandle(other.mappingHandle)
+{
+  other.data = NULL;
+  other.size = 0;
+  other.fileHandle = -1;
+  other.mappingHandle = 0;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other)
+{
+  if (this != &other)
+  {
+    Close();
+
+    filename = std::move(other.filename);
+    mode = other.mode;
+    data = other.data;
+    size = other.size;
+    fileHandle = other.fileHandle;
+    mappingHandle = other.mappingHandle;
+
+    other.data = NULL;
+    other.size = 0;
+    other.fileHandle = -1;
+    other.mappingHandle = 0;
+  }
+
+  return *this;
+}
+
+MappedFile::~MappedFile()
+{
+  Close();
+}
+
+void MappedFile::Flush()
+{
+  if (data == NULL || mode != READ_WRITE)
+    return;
+
+#ifdef _WIN32
+  FlushViewOfFile(data, 0);
+  FlushFileBuffers((HANDLE) fileHandle);
+#else
+  msync(data, size, MS_SYNC);
+#endif
+}
+
+void MappedFile::Close()
+{
+#ifdef _WIN32
+  if (data != NULL)
+    UnmapViewOfFile(data);
+  if (mappingHandle != 0)
+    CloseHandle((HANDLE) mappingHandle);
+  if (fileHandle != -1)
+    CloseHandle((HANDLE) fileHandle);
+#else
+  if (data != NULL)
+    munmap(data, size);
+  if (fileHandle != -1)
+    close((int) fileHandle);
+#endif
+
+  data = NULL;
+  size = 0;
+  fileHandle = -1;
+  mappingHandle = 0;
+}
+
+} // namespace data
+} // namespace mlpack
@@ -0,0 +1,106 @@
+/**
+ * @file core/data/mapped_file.hpp
+ *
+ * Definition of MappedFile, a thin wrapper around an operating system memory
+ * mapping of a file.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_FILE_HPP
+#define MLPACK_CORE_DATA_MAPPED_FILE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace data {
+
+/**
+ * The ways in which a file can be mapped into memory.
+ */
+enum MappingMode
+{
+  //! The mapping can only be read; writing to it is an error.
+  READ_ONLY,
+  //! The mapping can be modified, but modified pages are private copies and
+  //! the file itself is never changed.
+  COPY_ON_WRITE,
+  //! Modifications to the mapping are written back to the file.
+  READ_WRITE
+};
+
+/**
+ * A file mapped into memory.  The contents of the file can be accessed through
+ * Data() without reading the file first; pages are loaded by the operating
+ * system when they are touched.  The mapping is released when the object is
+ * destroyed.  POSIX systems (via mmap()) and Windows are supported.
+ */
+class MappedFile
+{
+ public:
+  //! Create an empty object that does not map any file.
+  MappedFile();
+
+  /**
+   * Map the given file.  If size is not 0, the file is created (or
+   * truncated) with the given size first; this requires the READ_WRITE mode.
+   * A std::runtime_error is thrown if the file cannot be mapped.
+   *
+   * @param filename Name of the file to map.
+   * @param mode How the file is mapped.
+   * @param size Size of the file to create, or 0 to map an existing file.
+   */
+  MappedFile(const std::string& filename,
+             const MappingMode mode,
+             const size_t size = 0);
+
+  //! Take ownership of the mapping held by the other object.
+  MappedFile(MappedFile&& other);
+
+  //! Take ownership of the mapping held by the other object.
+  MappedFile& operator=(MappedFile&& other);
+
+  //! A mapping cannot be copied.
+  MappedFile(const MappedFile& other) = delete;
+  //! A mapping cannot be copied.
+  MappedFile& operator=(const MappedFile& other) = delete;
+
+  //! Release the mapping.
+  ~MappedFile();
+
+  //! Write any modified pages back to the file (READ_WRITE mode only).
+  void Flush();
+
+  //! Release the mapping.  This is done automatically by the destructor.
+  void Close();
+
+  //! Get the start of the mapped memory (NULL if nothing is mapped).
+  char* Data() const { return data; }
+  //! Get the size of the mapping in bytes.
+  size_t Size() const { return size; }
+  //! Get the mode of the mapping.
+  MappingMode Mode() const { return mode; }
+  //! Get the name of the mapped file.
+  const std::string& Filename() const { return filename; }
+
+ private:
+  //! The name of the mapped file.
+  std::string filename;
+  //! The mapping mode.
+  MappingMode mode;
+  //! The start of the mapped memory.
+  char* data;
+  //! The size of the mapping in bytes.
+  size_t size;
+  //! The platform-specific file handle (a file descriptor on POSIX systems).
+  intptr_t fileHandle;
+  //! The platform-specific mapping handle (unused on POSIX systems).
+  intptr_t mappingHandle;
+};
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,175 @@
+/**
+ * @file core/data/mapped_matrix.hpp
+ *
+ * Definition of MappedMatrix, a dense matrix stored in a binary file that is
+ * accessed through a memory mapping.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+#define MLPACK_CORE_DATA_MAPPED_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "mapped_file.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * A dense matrix held in a binary file and accessed through a memory mapping,
+ * so that it never has to be read into memory as a whole.  The file consists of
+ * a 64-byte header (holding the element type and the size of the matrix)
+ * followed by the elements of the matrix in column-major order.  Such a file
+ * can be written with Save() or Create().
+ *
+ * Matrix() returns an Armadillo matrix that uses the mapped memory directly.
+ * Since Armadillo keeps that memory when the matrix is moved, the result can
+ * be moved into any class that takes ownership of a reference set, such as
+ * NeighborSearch, RangeSearch, KDE or FastMKS, without copying the data:
+ *
+ * @code
+ * data::MappedMatrix<double> reference("reference.bin", data::COPY_ON_WRITE);
+ * neighbor::KNN knn(reference.Matrix());
+ * @endcode
+ *
+ * Most trees (kd-trees, ball trees and the other BinarySpaceTree types, and
+ * octrees) reorder the points of the reference set in place, so:
+ *
+ *  - READ_ONLY mappings must only be used with trees that do not rearrange
+ *    the dataset (see tree::TreeTraits), or without a tree; writing to them
+ *    crashes the process.
+ *  - COPY_ON_WRITE mappings are always safe, but every page that a tree
+ *    writes to becomes a private copy.
+ *  - READ_WRITE mappings write the reordered points back to the file.  The
+ *    owner must then record the permutation with SaveOrder(), which stores it
+ *    next to the file (see OrderFilename()), so that the original index of
+ *    each point is still known (see OldFromNew()).
+ *
+ * Once a file has been reordered for a tree, building the same kind of tree
+ * (with the same or a larger leaf size) on it again moves no point, since the
+ * points of each node are already partitioned; so later COPY_ON_WRITE
+ * mappings of it copy nothing.  NSModel::BuildModel() handles all of this for
+ * the mlpack_knn program.  In every case the MappedMatrix must outlive every
+ * object that uses the memory returned by Matrix().
+ *
+ * @tparam eT Type of element held in the matrix.
+ */
+template<typename eT = double>
+class MappedMatrix
+{
+ public:
+  //! Size of the header at the start of the file, in bytes.
+  static const size_t HeaderSize = 64;
+
+  //! Create an empty object that does not map any file.
+  MappedMatrix() : nRows(0), nCols(0) { }
+
+  /**
+   * Map the given file, which must have been written by Save() or Create().
+   * A std::runtime_error is thrown if the file cannot be mapped or is not a
+   * valid matrix file for the element type eT.
+   *
+   * @param filename File to map.
+   * @param mode How the file is mapped.
+   */
+  MappedMatrix(const std::string& filename,
+               const MappingMode mode = READ_ONLY);
+
+  /**
+   * Create a new matrix file of the given size (the contents of the matrix are
+   * initially zero) and map it in READ_WRITE mode, so that it can be filled
+   * through Matrix().  If the file exists it is overwritten, and any order
+   * saved for it is removed.
+   *
+   * @param filename File to create.
+   * @param nRows Number of rows of the matrix.
+   * @param nCols Number of columns of the matrix.
+   */
+  static MappedMatrix Create(const std::string& filename,
+                             const size_t nRows,
+                             const size_t nCols);
+
+  /**
+   * Write the given matrix to a file that can later be mapped.
+   *
+   * @param filename File to write.
+   * @param matrix Matrix to write.
+   */
+  static void Save(const std::string& filename, const arma::Mat<eT>& matrix);
+
+  /**
+   * Get a matrix that uses the mapped memory (this does not copy anything).
+   * The matrix cannot be resized.  If the mode is READ_ONLY, the matrix must
+   * not be modified.
+   */
+  arma::Mat<eT> Matrix() const;
+
+  /**
+   * Get the original index of each column of the file, if its columns have
+   * been reordered and the order was saved with SaveOrder(); otherwise this is
+   * empty, and the columns are in their original order.
+   */
+  const std::vector<size_t>& OldFromNew() const { return oldFromNew; }
+
+  /**
+   * Record that the columns of the mapped matrix have been reordered in place
+   * (for instance, by building a tree on Matrix()), so that column i now holds
+   * what was column oldFromNew[i].  This is combined with any order saved
+   * before, and written to OrderFilename(); nothing is written if the order
+   * did not change.  A std::invalid_argument is thrown if the mode is not
+   * READ_WRITE or the size of oldFromNew is not the number of columns.
+   *
+   * @param oldFromNew Column of the matrix before the reordering for each
+   *     column after it.
+   */
+  void SaveOrder(const std::vector<size_t>& oldFromNew);
+
+  //! Get the name of the file that holds the saved order of the given matrix
+  //! file.
+  static std::string OrderFilename(const std::string& filename)
+  {
+    return filename + ".order";
+  }
+
+  //! Get the number of rows of the matrix.
+  size_t NRows() const { return nRows; }
+  //! Get the number of columns of the matrix.
+  size_t NCols() const { return nCols; }
+  //! Get the mode of the mapping.
+  MappingMode Mode() const { return file.Mode(); }
+
+  //! Write any modified elements back to the file (READ_WRITE mode only).
+  void Flush() { file.Flush(); }
+
+  //! Release the mapping.  This is done automatically by the destructor.
+  void Close();
+
+ private:
+  //! The mapped file.
+  MappedFile file;
+  //! The number of rows of the matrix.
+  size_t nRows;
+  //! The number of columns of the matrix.
+  size_t nCols;
+  //! The original index of each column, or empty if the order was never
+  //! saved.
+  std::vector<size_t> oldFromNew;
+
+  //! Fill the header of the mapped file.
+  void WriteHeader();
+
+  //! Get the kind of element type used for eT: 0 is unsigned integer, 1 is
+  //! signed integer, and 2 is floating point.
+  static uint32_t ElemKind();
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "mapped_matrix_impl.hpp"
+
+#endif
@@ -0,0 +1,221 @@
+/**
+ * @file core/data/mapped_matrix_impl.hpp
+ *
+ * Implementation of MappedMatrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+#define MLPACK_CORE_DATA_MAPPED_MATRIX_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mapped_matrix.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+namespace mlpack {
+namespace data {
+
+// The header is laid out as follows (all values in native byte order):
+//
+//   bytes  0 -  7: the magic string "MLPACKMM"
+//   bytes  8 - 11: format version (uint32_t)
+//   bytes 12 - 15: size of one element in bytes (uint32_t)
+//   bytes 16 - 19: kind of element, see ElemKind() (uint32_t)
+//   bytes 24 - 31: number of rows (uint64_t)
+//   bytes 32 - 39: number of columns (uint64_t)
+//
+// The remaining bytes of the header are zero.
+static const char mappedMatrixMagic[8] = { 'M', 'L', 'P', 'A', 'C', 'K', 'M',
+    'M' };
+static const uint32_t mappedMatrixVersion = 1;
+
+template<typename eT>
+MappedMatrix<eT>::MappedMatrix(const std::string& filename,
+                               const MappingMode mode) :
+    file(filename, mode),
+    nRows(0),
+    nCols(0)
+{
+  const char* header = file.Data();
+  uint32_t version, elemSize, elemKind;
+  uint64_t rows, cols;
+
+  if (file.Size() < HeaderSize ||
+      std::memcmp(header, mappedMatrixMagic, 8) != 0)
+  {
+    throw std::runtime_error("MappedMatrix: '" + filename + "' is not a "
+        "mapped matrix file.");
+  }
+
+  std::memcpy(&version, header + 8, sizeof(uint32_t));
+  std::memcpy(&elemSize, header + 12, sizeof(uint32_t));
+  std::memcpy(&elemKind, header + 16, sizeof(uint32_t));
+  std::memcpy(&rows, header + 24, sizeof(uint64_t));
+  std::memcpy(&cols, header + 32, sizeof(uint64_t));
+
+  if (version != mappedMatrixVersion)
+  {
+    throw std::runtime_error("MappedMatrix: '" + filename + "' has unknown "
+        "format version " + std::to_string(version) + ".");
+  }
+
+  if (elemSize != sizeof(eT) || elemKind != ElemKind())
+  {
+    throw std::runtime_error("MappedMatrix: the element type of '" + filename +
+        "' does not match the requested element type.");
+  }
+
+  // Make sure that the file holds all of the elements (and guard against
+  // overflow for corrupted sizes).
+  const size_t maxElems = (file.Size() - HeaderSize) / sizeof(eT);
+  if (rows > maxElems || (rows > 0 && cols > maxElems / rows))
+  {
+    throw std::runtime_error("MappedMatrix: '" + filename + "' is truncated.");
+  }
+
+  nRows = (size_t) rows;
+  nCols = (size_t) cols;
+
+  // Load the order of the columns, if it was saved.
+  std::ifstream orderFile(OrderFilename(filename));
+  if (orderFile.good())
+  {
+    orderFile.close();
+    MappedMatrix<size_t> order(OrderFilename(filename), READ_ONLY);
+    if (order.NRows() != 1 || order.NCols() != nCols)
+    {
+      throw std::runtime_error("MappedMatrix: the saved order of '" + filename +
+          "' does not match its number of columns.");
+    }
+
+    const arma::Mat<size_t> orderMatrix = order.Matrix();
+    oldFromNew.assign(orderMatrix.begin(), orderMatrix.end());
+  }
+}
+
+template<typename eT>
+MappedMatrix<eT> MappedMatrix<eT>::Create(const std::string& filename,
+                                          const size_t nRows,
+                                          const size_t nCols)
+{
+  // Any order saved for an old file of the same name no longer applies.
+  std::remove(OrderFilename(filename).c_str());
+
+  MappedMatrix result;
+  result.file = MappedFile(filename, READ_WRITE,
+      HeaderSize + nRows * nCols * sizeof(eT));
+  result.nRows = nRows;
+  result.nCols = nCols;
+  result.WriteHeader();
+
+  return result;
+}
+
+template<typename eT>
+void MappedMatrix<eT>::Save(const std::string& filename,
+                            const arma::Mat<eT>& matrix)
+{
+  MappedMatrix result = Create(filename, matrix.n_rows, matrix.n_cols);
+  if (matrix.n_elem > 0)
+  {
+    std::memcpy(result.file.Data() + HeaderSize, matrix.memptr(),
+        matrix.n_elem * sizeof(eT));
+  }
+  result.Flush();
+}
+
+template<typename eT>
+arma::Mat<eT> MappedMatrix<eT>::Matrix() const
+{
+  if (file.Data() == NULL)
+    return arma::Mat<eT>();
+
+  // Use the advanced constructor to create a strict alias of the mapped data.
+  return arma::Mat<eT>((eT*) (file.Data() + HeaderSize), nRows, nCols, false,
+      true);
+}
+
+template<typename eT>
+void MappedMatrix<eT>::SaveOrder(const std::vector<size_t>& newOldFromNew)
+{
+  if (file.Mode() != READ_WRITE)
+  {
+    throw std::invalid_argument("MappedMatrix::SaveOrder(): the columns can "
+        "only be reordered in a READ_WRITE mapping.");
+  }
+
+  if (newOldFromNew.size() != nCols)
+  {
+    throw std::invalid_argument("MappedMatrix::SaveOrder(): the order must have"
+        " one element for each column.");
+  }
+
+  bool identity = true;
+  for (size_t i = 0; i < nCols && identity; ++i)
+    identity = (newOldFromNew[i] == i);
+  if (identity)
+    return;
+
+  // Column i now holds what was column newOldFromNew[i], whose original index
+  // was oldFromNew[newOldFromNew[i]].
+  arma::Mat<size_t> order(1, nCols);
+  for (size_t i = 0; i < nCols; ++i)
+  {
+    order[i] = oldFromNew.empty() ? newOldFromNew[i] :
+        oldFromNew[newOldFromNew[i]];
+  }
+
+  // Make sure that the data is on disk before the order that describes it.
+  Flush();
+  MappedMatrix<size_t>::Save(OrderFilename(file.Filename()), order);
+  oldFromNew.assign(order.begin(), order.end());
+}
+
+template<typename eT>
+void MappedMatrix<eT>::Close()
+{
+  file.Close();
+  nRows = 0;
+  nCols = 0;
+  oldFromNew.clear();
+}
+
+template<typename eT>
+void MappedMatrix<eT>::WriteHeader()
+{
+  char* header = file.Data();
+  const uint32_t elemSize = sizeof(eT);
+  const uint32_t elemKind = ElemKind();
+  const uint64_t rows = nRows;
+  const uint64_t cols = nCols;
+
+  std::memset(header, 0, HeaderSize);
+  std::memcpy(header, mappedMatrixMagic, 8);
+  std::memcpy(header + 8, &mappedMatrixVersion, sizeof(uint32_t));
+  std::memcpy(header + 12, &elemSize, sizeof(uint32_t));
+  std::memcpy(header + 16, &elemKind, sizeof(uint32_t));
+  std::memcpy(header + 24, &rows, sizeof(uint64_t));
+  std::memcpy(header + 32, &cols, sizeof(uint64_t));
+}
+
+template<typename eT>
+uint32_t MappedMatrix<eT>::ElemKind()
+{
+  if (std::is_floating_point<eT>::value)
+    return 2;
+  else if (std::is_signed<eT>::value)
+    return 1;
+  else
+    return 0;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
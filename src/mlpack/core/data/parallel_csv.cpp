@@ -0,0 +1,245 @@
+/**
+ * @file core/data/parallel_csv.cpp
+ *
+ * Implementation of the parts of ParallelCSV that do not depend on the type of
+ * the loaded matrix: finding the lines of the file and tokenizing them.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "parallel_csv.hpp"
+#include "extension.hpp"
+
+#include <cctype>
+#include <cstring>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace data {
+
+namespace {
+
+//! Chunks are never smaller than this, so that small files are not cut into
+//! many tiny chunks.
+const size_t minChunkSize = 1 << 16;
+
+//! Return true if the given character is whitespace, as for boost::trim().
+inline bool IsSpace(const char c)
+{
+  return std::isspace((unsigned char) c) != 0;
+}
+
+//! Find the end of the quoted token starting at the given position, or return
+//! NULL if there is no quote there or the quote is not closed.  A quote
+//! character is escaped by doubling it.
+const char* QuotedEnd(const char* begin, const char* end)
+{
+  const char quote = *begin;
+  if (quote != '"' && quote != '\'')
+    return NULL;
+
+  for (const char* c = begin + 1; c < end; ++c)
+  {
+    if (*c != quote)
+      continue;
+    if (c + 1 < end && *(c + 1) == quote)
+      ++c;
+    else
+      return c + 1;
+  }
+
+  return NULL;
+}
+
+} // namespace
+
+ParallelCSV::ParallelCSV(const std::string& filename) :
+    numLines(0),
+    numFields(0)
+{
+  const std::string extension = Extension(filename);
+  if (extension == "csv")
+    delimiter = ',';
+  else if (extension == "txt")
+    delimiter = ' ';
+  else
+    delimiter = '\t';
+
+  // An empty file can't be mapped, but it is still a valid (empty) dataset.
+  std::ifstream stream(filename, std::ios::binary | std::ios::ate);
+  if (!stream.is_open())
+  {
+    std::ostringstream oss;
+    oss << "Cannot open file '" << filename << "'. " << std::endl;
+    throw std::runtime_error(oss.str());
+  }
+  if (stream.tellg() <= 0)
+    return;
+  stream.close();
+
+  file = MappedFile(filename, READ_ONLY);
+  const char* data = file.Data();
+  const size_t size = file.Size();
+
+  // Cut the file into a few chunks per thread, so that threads that finish
+  // early can take more work; each chunk ends after a newline.
+  size_t numThreads = 1;
+  #ifdef HAS_OPENMP
+    numThreads = omp_get_max_threads();
+  #endif
+  const size_t chunkSize = std::max(minChunkSize,
+      (size + 4 * numThreads - 1) / (4 * numThreads));
+
+  size_t begin = 0;
+  while (begin < size)
+  {
+    size_t end = size;
+    if (size - begin > chunkSize)
+    {
+      const char* newline = (const char*) std::memchr(data + begin + chunkSize,
+          '\n', size - begin - chunkSize);
+      if (newline != NULL)
+        end = (newline - data) + 1;
+    }
+
+    chunks.push_back(Chunk { data + begin, data + end, 0, 0 });
+    begin = end;
+  }
+
+  // Count the lines of each chunk.  As with std::getline(), the last line
+  // doesn't need a newline.
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks.size(); ++c)
+  {
+    Chunk& chunk = chunks[c];
+    const char* position = chunk.begin;
+    while (position < chunk.end)
+    {
+      const char* newline = (const char*) std::memchr(position, '\n',
+          chunk.end - position);
+      ++chunk.numLines;
+      if (newline == NULL)
+        break;
+      position = newline + 1;
+    }
+  }
+
+  for (size_t c = 0; c < chunks.size(); ++c)
+  {
+    chunks[c].firstLine = numLines;
+    numLines += chunks[c].numLines;
+  }
+
+  // The first line gives the number of tokens on every line.
+  const char* firstEnd = (const char*) std::memchr(data, '\n', size);
+  std::vector<Token> tokens;
+  Tokenize(data, (firstEnd == NULL) ? data + size : firstEnd, delimiter,
+      tokens);
+  numFields = tokens.size();
+}
+
+bool ParallelCSV::Tokenize(const char* begin,
+                           const char* end,
+                           const char delimiter,
+                           std::vector<Token>& tokens)
+{
+  tokens.clear();
+
+  // Remove whitespace from either side of the line.
+  while (begin < end && IsSpace(*begin))
+    ++begin;
+  while (end > begin && IsSpace(*(end - 1)))
+    --end;
+
+  const char* position = begin;
+  while (true)
+  {
+    // A token is a quoted string, or everything up to the next delimiter.
+    // Text files also end tokens at commas, which are not delimiters.
+    const char* tokenBegin = position;
+    const char* tokenEnd = (position < end) ? QuotedEnd(position, end) : NULL;
+    if (tokenEnd == NULL)
+    {
+      while (position < end && *position != delimiter && *position != '\r' &&
+          !(delimiter == ' ' && *position == ','))
+        ++position;
+      tokenEnd = position;
+    }
+    position = tokenEnd;
+
+    while (tokenBegin < tokenEnd && IsSpace(*tokenBegin))
+      ++tokenBegin;
+    while (tokenEnd > tokenBegin && IsSpace(*(tokenEnd - 1)))
+      --tokenEnd;
+    tokens.push_back(Token(tokenBegin, tokenEnd));
+
+    // The delimiter may be surrounded by spaces; for text files, the delimiter
+    // is any number of spaces.
+    const char* next = position;
+    while (next < end && *next == ' ')
+      ++next;
+    if (delimiter != ' ')
+    {
+      if (next == end || *next != delimiter)
+        break;
+      ++next;
+      while (next < end && *next == ' ')
+        ++next;
+    }
+    else if (next == position)
+    {
+      break;
+    }
+
+    position = next;
+  }
+
+  return (position == end);
+}
+
+bool ParallelCSV::IsDecimal(const char* begin, const char* end)
+{
+  // [+-]? (digits [. digits?] | . digits) ([eE] [+-]? digits)?
+  const char* c = begin;
+  if (c < end && (*c == '+' || *c == '-'))
+    ++c;
+
+  size_t digits = 0;
+  while (c < end && std::isdigit((unsigned char) *c))
+  {
+    ++c;
+    ++digits;
+  }
+  if (c < end && *c == '.')
+  {
+    ++c;
+    while (c < end && std::isdigit((unsigned char) *c))
+    {
+      ++c;
+      ++digits;
+    }
+  }
+  if (digits == 0)
+    return false;
+
+  if (c < end && (*c == 'e' || *c == 'E'))
+  {
+    ++c;
+    if (c < end && (*c == '+' || *c == '-'))
+      ++c;
+    if (c == end || !std::isdigit((unsigned char) *c))
+      return false;
+    while (c < end && std::isdigit((unsigned char) *c))
+      ++c;
+  }
+
+  return (c == end);
+}
+
+} // namespace data
+} // namespace mlpack
@@ -0,0 +1,203 @@
+/**
+ * @file core/data/parallel_csv.hpp
+ *
+ * Definition of ParallelCSV, a CSV, TSV and text file reader that maps the file
+ * into memory and parses it with all available threads.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_PARALLEL_CSV_HPP
+#define MLPACK_CORE_DATA_PARALLEL_CSV_HPP
+
+#include <mlpack/prereqs.hpp>
+
+#include "dataset_mapper.hpp"
+#include "mapped_file.hpp"
+#include "map_policies/increment_policy.hpp"
+#include "map_policies/missing_policy.hpp"
+
+namespace mlpack {
+namespace data {
+
+/**
+ * ParallelCSV reads CSV (.csv), TSV (.tsv) and space-separated (.txt) files.
+ * The file is mapped into memory and cut into chunks of whole lines, which are
+ * tokenized and parsed in parallel with OpenMP, so the file is only read once
+ * from disk.  Lines and tokens are split exactly as LoadCSV does: each line is
+ * trimmed, quoted tokens may contain delimiters, and every token is trimmed.
+ *
+ * Numeric tokens are parsed with strtod() (or strtof()/strtold()) once they are
+ * known to be in the form that a std::istream reads in full, so the values are
+ * the same as those found by the map policies, which use std::stringstream.
+ *
+ * When loading with a DatasetMapper, the dimensions whose tokens can't all be
+ * read as numbers (or every dimension, if the policy may map numbers) are
+ * passed to the policy.  Each chunk collects the distinct tokens of these
+ * dimensions in the order that they first appear; the per-chunk lists are then
+ * merged in file order, and the policy sees every distinct token once, in the
+ * order of its first appearance in the file.  This gives the same mappings as
+ * a sequential pass for any policy whose mapping of a token only depends on the
+ * tokens mapped before it in the same dimension (as is the case for
+ * IncrementPolicy and MissingPolicy).
+ */
+class ParallelCSV
+{
+ public:
+  /**
+   * Map the given file and find its lines.  The type of the file is given by
+   * its extension ("csv", "tsv" or "txt"; anything else is treated as TSV, as
+   * LoadCSV does).  A std::runtime_error is thrown if the file cannot be
+   * opened.
+   *
+   * @param filename Name of the file to read.
+   */
+  ParallelCSV(const std::string& filename);
+
+  /**
+   * Load the file into the given matrix, passing non-numeric tokens to the
+   * given DatasetMapper, which is reset to the dimensionality of the file.  A
+   * std::runtime_error is thrown if the lines do not all have the same number
+   * of tokens.
+   *
+   * @param matrix Matrix to load into.
+   * @param info DatasetMapper to use while loading.
+   * @param transpose If true, each line is a column of the matrix (default).
+   */
+  template<typename eT, typename PolicyType>
+  void Load(arma::Mat<eT>& matrix,
+            DatasetMapper<PolicyType>& info,
+            const bool transpose = true);
+
+  /**
+   * Load the file into the given matrix if it only holds numbers, with the
+   * same number of them on every line.  Otherwise, false is returned (and the
+   * contents of the matrix are unspecified), so that the caller can load the
+   * file with a more lenient reader.
+   *
+   * @param matrix Matrix to load into.
+   * @param transpose If true, each line is a column of the matrix (default).
+   */
+  template<typename eT>
+  bool LoadNumeric(arma::Mat<eT>& matrix, const bool transpose = true);
+
+  //! Get the number of lines in the file.
+  size_t NumLines() const { return numLines; }
+  //! Get the number of tokens on the first line of the file.
+  size_t NumFields() const { return numFields; }
+
+  //! The beginning and the end of a token.
+  typedef std::pair<const char*, const char*> Token;
+
+  /**
+   * Split the given line (without its newline) into trimmed tokens, with the
+   * given delimiter (',' for CSV, '\t' for TSV, ' ' for text files).  Return
+   * false if the line has characters after its last token that are not part of
+   * any token (these are ignored, as LoadCSV does).
+   */
+  static bool Tokenize(const char* begin,
+                       const char* end,
+                       const char delimiter,
+                       std::vector<Token>& tokens);
+
+  //! Return true if the given token is a decimal number, in the form that a
+  //! std::istream reads in full.
+  static bool IsDecimal(const char* begin, const char* end);
+
+  //! Parse the given token as a floating-point number; return false if a
+  //! std::istream would not read it in full.
+  template<typename eT>
+  static bool ParseNumber(
+      const char* begin,
+      const char* end,
+      eT& value,
+      const typename std::enable_if<
+          std::is_floating_point<eT>::value>::type* = 0);
+
+  //! Parse the given token with a std::istringstream; return false if it is
+  //! not read in full.
+  template<typename eT>
+  static bool ParseNumber(
+      const char* begin,
+      const char* end,
+      eT& value,
+      const typename std::enable_if<
+          !std::is_floating_point<eT>::value>::type* = 0);
+
+ private:
+  //! A range of whole lines of the file.
+  struct Chunk
+  {
+    //! The first character of the chunk.
+    const char* begin;
+    //! One past the last character of the chunk.
+    const char* end;
+    //! The index of the first line of the chunk.
+    size_t firstLine;
+    //! The number of lines in the chunk.
+    size_t numLines;
+  };
+
+  //! The distinct tokens of one dimension in one chunk, in the order that they
+  //! first appear.
+  struct DimensionTokens
+  {
+    //! The distinct tokens.
+    std::vector<std::string> tokens;
+    //! The index of each token in 'tokens'.
+    std::unordered_map<std::string, size_t> indices;
+    //! The index of each token among the distinct tokens of the whole file.
+    std::vector<size_t> fileIndices;
+  };
+
+  //! The mapped file (nothing is mapped if the file is empty).
+  MappedFile file;
+  //! The delimiter between tokens: ',', '\t' or ' '.
+  char delimiter;
+  //! The chunks of the file.
+  std::vector<Chunk> chunks;
+  //! The number of lines in the file.
+  size_t numLines;
+  //! The number of tokens on the first line.
+  size_t numFields;
+
+  /**
+   * Parse all tokens that are numbers into the matrix, and mark the dimensions
+   * that have other tokens in stringDims.  If strict is false, a
+   * std::runtime_error is thrown if the lines do not all have the same number
+   * of tokens.  If strict is true, false is returned instead, and also if there
+   * are tokens that are not numbers or lines with unparsed characters.
+   */
+  template<typename eT>
+  bool ParseNumbers(arma::Mat<eT>& matrix,
+                    const bool transpose,
+                    const bool strict,
+                    std::vector<char>& stringDims) const;
+
+  //! Return true if the given policy may map a token that can be read as a
+  //! number, in a dimension where all tokens can be read as numbers.  This is
+  //! assumed for policies that are not known.
+  template<typename eT, typename PolicyType>
+  static bool MapsNumbers(const PolicyType& /* policy */) { return true; }
+
+  //! IncrementPolicy only maps numbers if it maps everything.
+  template<typename eT>
+  static bool MapsNumbers(const IncrementPolicy& policy)
+  {
+    return policy.ForceAllMappings();
+  }
+
+  //! MissingPolicy only maps numbers that are in its set of missing values.
+  template<typename eT>
+  static bool MapsNumbers(const MissingPolicy& policy);
+};
+
+} // namespace data
+} // namespace mlpack
+
+// Include implementation.
+#include "parallel_csv_impl.hpp"
+
+#endif
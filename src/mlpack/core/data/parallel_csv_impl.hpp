@@ -0,0 +1,373 @@
+/**
+ * @file core/data/parallel_csv_impl.hpp
+ *
+ * Implementation of the templated functions of ParallelCSV.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_DATA_PARALLEL_CSV_IMPL_HPP
+#define MLPACK_CORE_DATA_PARALLEL_CSV_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_csv.hpp"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace mlpack {
+namespace data {
+
+namespace details {
+
+//! Convert a null-terminated decimal number with the strto*() function of the
+//! given type, so that it is rounded correctly for that type.
+inline void StringToFloat(const char* str, float& value)
+{
+  value = std::strtof(str, NULL);
+}
+
+inline void StringToFloat(const char* str, double& value)
+{
+  value = std::strtod(str, NULL);
+}
+
+inline void StringToFloat(const char* str, long double& value)
+{
+  value = std::strtold(str, NULL);
+}
+
+} // namespace details
+
+template<typename eT, typename PolicyType>
+void ParallelCSV::Load(arma::Mat<eT>& matrix,
+                       DatasetMapper<PolicyType>& info,
+                       const bool transpose)
+{
+  std::vector<char> stringDims;
+  ParseNumbers(matrix, transpose, false, stringDims);
+
+  const size_t numDims = transpose ? numFields : numLines;
+  info.SetDimensionality(numDims);
+
+  // Find the dimensions whose tokens must be given to the policy.
+  const bool mapsNumbers = MapsNumbers<eT>(info.Policy());
+  std::vector<size_t> mappedDims;
+  std::vector<size_t> mappedIndices(numDims, size_t(-1));
+  for (size_t d = 0; d < numDims; ++d)
+  {
+    if (mapsNumbers || stringDims[d])
+    {
+      mappedIndices[d] = mappedDims.size();
+      mappedDims.push_back(d);
+    }
+  }
+
+  if (mappedDims.empty())
+    return;
+
+  // When transposing, each chunk has tokens of every mapped dimension; when
+  // not transposing, the dimensions are lines, so each chunk only has tokens of
+  // the mapped dimensions among its own lines.
+  const size_t numMapped = mappedDims.size();
+  std::vector<std::vector<DimensionTokens>> chunkTokens(chunks.size());
+  std::vector<size_t> chunkOffsets(chunks.size(), 0);
+  for (size_t c = 0; c < chunks.size(); ++c)
+  {
+    if (transpose)
+    {
+      chunkTokens[c].resize(numMapped);
+    }
+    else
+    {
+      chunkOffsets[c] = std::lower_bound(mappedDims.begin(), mappedDims.end(),
+          chunks[c].firstLine) - mappedDims.begin();
+      const size_t last = std::lower_bound(mappedDims.begin(),
+          mappedDims.end(), chunks[c].firstLine + chunks[c].numLines) -
+          mappedDims.begin();
+      chunkTokens[c].resize(last - chunkOffsets[c]);
+    }
+  }
+
+  // Collect the distinct tokens of the mapped dimensions in each chunk, and the
+  // index of the token of each mapped element among them.
+  const size_t numPoints = transpose ? numLines : numFields;
+  std::vector<size_t> elementIndices(numMapped * numPoints);
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks.size(); ++c)
+  {
+    const Chunk& chunk = chunks[c];
+    std::vector<Token> tokens;
+    std::string token;
+    const char* lineBegin = chunk.begin;
+    for (size_t l = 0; l < chunk.numLines; ++l)
+    {
+      const char* lineEnd = (const char*) std::memchr(lineBegin, '\n',
+          chunk.end - lineBegin);
+      if (lineEnd == NULL)
+        lineEnd = chunk.end;
+
+      const size_t line = chunk.firstLine + l;
+      if (transpose || mappedIndices[line] != size_t(-1))
+      {
+        Tokenize(lineBegin, lineEnd, delimiter, tokens);
+        for (size_t i = 0; i < (transpose ? numMapped : numFields); ++i)
+        {
+          const size_t m = transpose ? i : mappedIndices[line];
+          const Token& t = tokens[transpose ? mappedDims[i] : i];
+          token.assign(t.first, t.second);
+
+          DimensionTokens& dimTokens = chunkTokens[c][m - chunkOffsets[c]];
+          auto it = dimTokens.indices.find(token);
+          if (it == dimTokens.indices.end())
+          {
+            it = dimTokens.indices.insert(std::make_pair(token,
+                dimTokens.tokens.size())).first;
+            dimTokens.tokens.push_back(token);
+          }
+
+          elementIndices[transpose ? line * numMapped + m :
+              m * numFields + i] = it->second;
+        }
+      }
+
+      lineBegin = lineEnd + 1;
+    }
+  }
+
+  // Merge the distinct tokens of the chunks, in file order.
+  std::vector<std::unordered_map<std::string, size_t>> fileIndices(numMapped);
+  std::vector<std::vector<const std::string*>> fileTokens(numMapped);
+  for (size_t c = 0; c < chunks.size(); ++c)
+  {
+    for (size_t k = 0; k < chunkTokens[c].size(); ++k)
+    {
+      const size_t m = chunkOffsets[c] + k;
+      DimensionTokens& dimTokens = chunkTokens[c][k];
+      dimTokens.fileIndices.resize(dimTokens.tokens.size());
+      for (size_t i = 0; i < dimTokens.tokens.size(); ++i)
+      {
+        auto result = fileIndices[m].insert(std::make_pair(
+            dimTokens.tokens[i], fileTokens[m].size()));
+        if (result.second)
+          fileTokens[m].push_back(&dimTokens.tokens[i]);
+        dimTokens.fileIndices[i] = result.first->second;
+      }
+    }
+  }
+
+  // Give the distinct tokens to the policy, in the order that they first
+  // appear in the file.
+  if (PolicyType::NeedsFirstPass)
+  {
+    for (size_t m = 0; m < numMapped; ++m)
+      for (size_t i = 0; i < fileTokens[m].size(); ++i)
+        info.template MapFirstPass<eT>(*fileTokens[m][i], mappedDims[m]);
+  }
+
+  std::vector<std::vector<eT>> values(numMapped);
+  for (size_t m = 0; m < numMapped; ++m)
+  {
+    values[m].resize(fileTokens[m].size());
+    for (size_t i = 0; i < fileTokens[m].size(); ++i)
+    {
+      values[m][i] = info.template MapString<eT>(*fileTokens[m][i],
+          mappedDims[m]);
+    }
+  }
+
+  // Finally, store the mapped values.
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks.size(); ++c)
+  {
+    const Chunk& chunk = chunks[c];
+    for (size_t line = chunk.firstLine; line < chunk.firstLine +
+        chunk.numLines; ++line)
+    {
+      if (transpose)
+      {
+        for (size_t m = 0; m < numMapped; ++m)
+        {
+          const size_t index = elementIndices[line * numMapped + m];
+          matrix(mappedDims[m], line) =
+              values[m][chunkTokens[c][m].fileIndices[index]];
+        }
+      }
+      else if (mappedIndices[line] != size_t(-1))
+      {
+        const size_t m = mappedIndices[line];
+        const DimensionTokens& dimTokens = chunkTokens[c][m - chunkOffsets[c]];
+        for (size_t i = 0; i < numFields; ++i)
+        {
+          const size_t index = elementIndices[m * numFields + i];
+          matrix(line, i) = values[m][dimTokens.fileIndices[index]];
+        }
+      }
+    }
+  }
+}
+
+template<typename eT>
+bool ParallelCSV::LoadNumeric(arma::Mat<eT>& matrix, const bool transpose)
+{
+  std::vector<char> stringDims;
+  return ParseNumbers(matrix, transpose, true, stringDims);
+}
+
+template<typename eT>
+bool ParallelCSV::ParseNumber(
+    const char* begin,
+    const char* end,
+    eT& value,
+    const typename std::enable_if<std::is_floating_point<eT>::value>::type*)
+{
+  if (!IsDecimal(begin, end))
+    return false;
+
+  // The strto*() functions need a null-terminated string; almost all numbers
+  // fit in the buffer.
+  char buffer[64];
+  std::string longToken;
+  const char* str = buffer;
+  const size_t length = end - begin;
+  if (length < sizeof(buffer))
+  {
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+  }
+  else
+  {
+    longToken.assign(begin, end);
+    str = longToken.c_str();
+  }
+
+  details::StringToFloat(str, value);
+
+  // A std::istream fails on numbers that overflow.
+  return !std::isinf(value);
+}
+
+template<typename eT>
+bool ParallelCSV::ParseNumber(
+    const char* begin,
+    const char* end,
+    eT& value,
+    const typename std::enable_if<!std::is_floating_point<eT>::value>::type*)
+{
+  std::istringstream stream(std::string(begin, end));
+  stream >> value;
+  return !stream.fail() && stream.eof();
+}
+
+template<typename eT>
+bool ParallelCSV::ParseNumbers(arma::Mat<eT>& matrix,
+                               const bool transpose,
+                               const bool strict,
+                               std::vector<char>& stringDims) const
+{
+  if (transpose)
+    matrix.set_size(numFields, numLines);
+  else
+    matrix.set_size(numLines, numFields);
+
+  // The first line of each chunk with the wrong number of tokens (or a line
+  // that couldn't be parsed in full, in strict mode), and its number of
+  // tokens.
+  std::vector<size_t> badLines(chunks.size(), size_t(-1));
+  std::vector<size_t> badSizes(chunks.size(), 0);
+  // The dimensions of each chunk with tokens that are not numbers: every
+  // dimension when transposing, or the lines of the chunk otherwise.
+  std::vector<std::vector<char>> chunkStringDims(chunks.size());
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t c = 0; c < (omp_size_t) chunks.size(); ++c)
+  {
+    const Chunk& chunk = chunks[c];
+    std::vector<char>& flags = chunkStringDims[c];
+    flags.resize(transpose ? numFields : chunk.numLines, 0);
+
+    std::vector<Token> tokens;
+    const char* lineBegin = chunk.begin;
+    for (size_t l = 0; l < chunk.numLines; ++l)
+    {
+      const char* lineEnd = (const char*) std::memchr(lineBegin, '\n',
+          chunk.end - lineBegin);
+      if (lineEnd == NULL)
+        lineEnd = chunk.end;
+
+      const size_t line = chunk.firstLine + l;
+      const bool complete = Tokenize(lineBegin, lineEnd, delimiter, tokens);
+      if (tokens.size() != numFields || (strict && !complete))
+      {
+        badLines[c] = line;
+        badSizes[c] = tokens.size();
+        break;
+      }
+
+      for (size_t i = 0; i < numFields; ++i)
+      {
+        eT& element = transpose ? matrix(i, line) : matrix(line, i);
+        if (!ParseNumber(tokens[i].first, tokens[i].second, element))
+        {
+          element = eT(0);
+          flags[transpose ? i : l] = 1;
+        }
+      }
+
+      lineBegin = lineEnd + 1;
+    }
+  }
+
+  for (size_t c = 0; c < chunks.size(); ++c)
+  {
+    if (badLines[c] == size_t(-1))
+      continue;
+
+    if (strict)
+      return false;
+
+    std::ostringstream oss;
+    oss << "ParallelCSV::Load(): wrong number of dimensions (" << badSizes[c]
+        << ") on line " << badLines[c] << "; should be " << numFields
+        << " dimensions.";
+    throw std::runtime_error(oss.str());
+  }
+
+  stringDims.assign(transpose ? numFields : numLines, 0);
+  for (size_t c = 0; c < chunks.size(); ++c)
+  {
+    const size_t offset = transpose ? 0 : chunks[c].firstLine;
+    for (size_t i = 0; i < chunkStringDims[c].size(); ++i)
+      stringDims[offset + i] |= chunkStringDims[c][i];
+  }
+
+  if (strict)
+  {
+    for (size_t d = 0; d < stringDims.size(); ++d)
+      if (stringDims[d])
+        return false;
+  }
+
+  return true;
+}
+
+template<typename eT>
+bool ParallelCSV::MapsNumbers(const MissingPolicy& policy)
+{
+  for (const std::string& missing : policy.MissingSet())
+  {
+    eT value;
+    if (ParseNumber(missing.data(), missing.data() + missing.size(), value))
+      return true;
+  }
+
+  return false;
+}
+
+} // namespace data
+} // namespace mlpack
+
+#endif
@@ -20,6 +20,7 @@
 
 #include "format.hpp"
 #include "image_info.hpp"
+#include "dataset_mapper.hpp"
 
 namespace mlpack {
 namespace data /** Functions to load and save matrices. */ {
@@ -97,6 +98,33 @@ bool Save(const std::string& filename,
           const bool fatal = false,
           bool transpose = true);
 
+/**
+ * Saves a matrix to file, along with the types and mappings of the given
+ * DatasetMapper, so that a later call to Load() with a DatasetMapper gets the
+ * same mappings back.  The only supported format is mlpack's columnar binary
+ * format (see ColumnarDataset), denoted by .mlds; dimensions of small
+ * non-negative integers (such as categorical dimensions) are stored in
+ * narrower types.
+ *
+ * If the 'fatal' parameter is set to true, a std::runtime_error exception will
+ * be thrown upon failure.  If the 'transpose' parameter is set to true, each
+ * column of the matrix is a point, as is usual in mlpack; this should be left
+ * at its default value of 'true' unless the matrix holds one point per row.
+ *
+ * @param filename Name of file to save to.
+ * @param matrix Matrix to save into file.
+ * @param info DatasetMapper with the types and mappings of the matrix.
+ * @param fatal If an error should be reported as fatal (default false).
+ * @param transpose If true, each column of the matrix is a point.
+ * @return Boolean value indicating success or failure of save.
+ */
+template<typename eT, typename PolicyType>
+bool Save(const std::string& filename,
+          const arma::Mat<eT>& matrix,
+          const DatasetMapper<PolicyType>& info,
+          const bool fatal = false,
+          const bool transpose = true);
+
 /**
  * Saves a model to file, guessing the filetype from the extension, or,
  * optionally, saving the specified format.  If automatic extension detection is
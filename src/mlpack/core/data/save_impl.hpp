@@ -16,6 +16,7 @@
 #include "save.hpp"
 #include "extension.hpp"
 #include "detect_file_type.hpp"
+#include "columnar_dataset.hpp"
 
 #include <cereal/archives/xml.hpp>
 #include <cereal/archives/json.hpp>
@@ -259,6 +260,51 @@ bool Save(const std::string& filename,
   return true;
 }
 
+// Save with mappings.
+template<typename eT, typename PolicyType>
+bool Save(const std::string& filename,
+          const arma::Mat<eT>& matrix,
+          const DatasetMapper<PolicyType>& info,
+          const bool fatal,
+          const bool transpose)
+{
+  Timer::Start("saving_data");
+
+  if (Extension(filename) != "mlds")
+  {
+    Timer::Stop("saving_data");
+    if (fatal)
+      Log::Fatal << "Cannot save '" << filename << "' with a DatasetMapper; "
+          << "only the columnar format (.mlds) keeps mappings." << std::endl;
+    else
+      Log::Warn << "Cannot save '" << filename << "' with a DatasetMapper; "
+          << "only the columnar format (.mlds) keeps mappings." << std::endl;
+
+    return false;
+  }
+
+  Log::Info << "Saving columnar dataset to '" << filename << "'."
+      << std::endl;
+  try
+  {
+    ColumnarDataset::Save(filename, matrix, info, transpose);
+  }
+  catch (std::exception& e)
+  {
+    Timer::Stop("saving_data");
+    if (fatal)
+      Log::Fatal << e.what() << std::endl;
+    else
+      Log::Warn << e.what() << std::endl;
+
+    return false;
+  }
+
+  Timer::Stop("saving_data");
+
+  return true;
+}
+
 //! Save a model to file.
 template<typename T>
 bool Save(const std::string& filename,
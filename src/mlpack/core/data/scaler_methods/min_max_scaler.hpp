@@ -13,6 +13,7 @@
 #define MLPACK_CORE_DATA_SCALE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/block_reader.hpp>
 
 namespace mlpack {
 namespace data {
@@ -75,14 +76,40 @@ class MinMaxScaler
   {
     itemMin = arma::min(input, 1);
     itemMax = arma::max(input, 1);
-    scale = itemMax - itemMin;
-    // Handle zeros in scale vector.
-    scale.for_each([](arma::vec::elem_type& val) { val =
-        (val == 0) ? 1 : val; });
-    scale = (scaleMax - scaleMin) / scale;
-    scalerowmin.copy_size(itemMin);
-    scalerowmin.fill(scaleMin);
-    scalerowmin = scalerowmin - itemMin % scale;
+    ComputeScale();
+  }
+
+  /**
+   * Function to fit features from a file that is read one block at a time, so
+   * that the file does not need to fit in memory.  The reader is reset first,
+   * so all of its points are used.
+   *
+   * @param reader Reader of the dataset to fit.
+   */
+  void Fit(BlockReader& reader)
+  {
+    reader.Reset();
+    itemMin.set_size(reader.Dimensionality());
+    itemMin.fill(std::numeric_limits<double>::infinity());
+    itemMax.set_size(reader.Dimensionality());
+    itemMax.fill(-std::numeric_limits<double>::infinity());
+
+    arma::mat block;
+    bool read = false;
+    while (reader.NextBlock(block))
+    {
+      itemMin = arma::min(itemMin, arma::vec(arma::min(block, 1)));
+      itemMax = arma::max(itemMax, arma::vec(arma::max(block, 1)));
+      read = true;
+    }
+
+    if (!read)
+    {
+      throw std::runtime_error("MinMaxScaler::Fit(): no points to fit in "
+          "file.");
+    }
+
+    ComputeScale();
   }
 
   /**
@@ -151,6 +178,19 @@ class MinMaxScaler
   double scaleMax;
   // Column vector of scalemin
   arma::vec scalerowmin;
+
+  // Compute the scale and scalerowmin from itemMin and itemMax.
+  void ComputeScale()
+  {
+    scale = itemMax - itemMin;
+    // Handle zeros in scale vector.
+    scale.for_each([](arma::vec::elem_type& val) { val =
+        (val == 0) ? 1 : val; });
+    scale = (scaleMax - scaleMin) / scale;
+    scalerowmin.copy_size(itemMin);
+    scalerowmin.fill(scaleMin);
+    scalerowmin = scalerowmin - itemMin % scale;
+  }
 }; // class MinMaxScaler
 
 } // namespace data
@@ -13,6 +13,7 @@
 #define MLPACK_CORE_DATA_STANDARD_SCALE_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/block_reader.hpp>
 
 namespace mlpack {
 namespace data {
@@ -62,6 +63,48 @@ class StandardScaler
         (val == 0) ? 1 : val; });
   }
 
+  /**
+   * Function to fit features from a file that is read one block at a time, so
+   * that the file does not need to fit in memory.  The reader is reset first,
+   * so all of its points are used.  The means and standard deviations of the
+   * blocks are combined as each block is read, and are the same (up to
+   * floating-point error) as Fit() on the whole dataset gives.
+   *
+   * @param reader Reader of the dataset to fit.
+   */
+  void Fit(BlockReader& reader)
+  {
+    reader.Reset();
+    itemMean.zeros(reader.Dimensionality());
+    arma::vec sumSquares(reader.Dimensionality(), arma::fill::zeros);
+    size_t count = 0;
+
+    arma::mat block;
+    while (reader.NextBlock(block))
+    {
+      // Merge the mean and sum of squared deviations of the block into those
+      // of the points read so far (Chan et al.'s pairwise update).
+      const arma::vec blockMean = arma::mean(block, 1);
+      const arma::vec delta = blockMean - itemMean;
+      const double total = double(count + block.n_cols);
+      sumSquares += arma::sum(arma::square(block.each_col() - blockMean), 1) +
+          arma::square(delta) * (double(count) * block.n_cols / total);
+      itemMean += delta * (block.n_cols / total);
+      count += block.n_cols;
+    }
+
+    if (count == 0)
+    {
+      throw std::runtime_error("StandardScaler::Fit(): no points to fit in "
+          "file.");
+    }
+
+    itemStdDev = arma::sqrt(sumSquares / double(count));
+    // Handle zeros in scale vector.
+    itemStdDev.for_each([](arma::vec::elem_type& val) { val =
+        (val == 0) ? 1 : val; });
+  }
+
   /**
    * Function to scale features.
    *
@@ -138,6 +138,12 @@ class DiagonalGaussianDistribution
   //! Set the covariance matrix using move assignment.
   void Covariance(arma::vec&& covariance);
 
+  //! Return the inverse of the diagonal covariance.
+  const arma::vec& InvCov() const { return invCov; }
+
+  //! Return the log-determinant of the covariance.
+  double LogDetCov() const { return logDetCov; }
+
   //! Serialize the distribution.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t /* version */)
@@ -68,6 +68,24 @@ void LogSumExp(const T& x, arma::Col<typename T::elem_type>& y);
 template<typename T, bool InPlace = false>
 void LogSumExpT(const T& x, arma::Col<typename T::elem_type>& y);
 
+/**
+ * Compute the log of the product of the matrix `a`, whose elements are not in
+ * log space, with the exponential of the vector of log values `x`.  That is,
+ * this method will set `y` such that:
+ *
+ *     `y_i = log(sum_j(a_ij * exp(x_j)))`.
+ *
+ * This is a log-sum-exp over each row of `log(a)` plus `x`, but it takes only
+ * one exponential per element of `x` and a single matrix-vector product, so
+ * it is much faster when `a` is known in linear space.  Rows whose sum
+ * underflows because they only reach values of `x` far below its maximum are
+ * recomputed in log space; rows of `a` that give a sum of 0 give -inf.
+ */
+template<typename T>
+void LogSumExpProduct(const T& a,
+                      const arma::Col<typename T::elem_type>& x,
+                      arma::Col<typename T::elem_type>& y);
+
 } // namespace math
 } // namespace mlpack
 
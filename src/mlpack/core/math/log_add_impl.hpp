@@ -77,29 +77,20 @@ typename T::elem_type AccuLog(const T& x)
 template<typename T, bool InPlace>
 void LogSumExp(const T& x, arma::Col<typename T::elem_type>& y)
 {
-  arma::Col<typename T::elem_type> maxs;
+  typedef typename T::elem_type ElemType;
 
+  // Compute the maximum in each row (treating y as a column too, if needed).
+  // Rows whose maximum is infinite are not shifted, so that rows of -inf give
+  // -inf instead of NaN.
+  arma::Col<ElemType> maxs = max(x, 1);
   if (InPlace)
-  {
-    // Compute the maximum in each column (treating y as a column too).
-    maxs = max(max(x, 1), y);
+    maxs = max(maxs, y);
+  maxs.elem(arma::find_nonfinite(maxs)).zeros();
 
-    y = maxs + log(sum(exp(x - repmat(maxs, 1, x.n_cols)), 1) +
-        exp(y - maxs));
-  }
+  if (InPlace)
+    y = maxs + log(sum(exp(x.each_col() - maxs), 1) + exp(y - maxs));
   else
-  {
-    // Compute the maximum element in each column.
-    maxs = max(x, 1);
-
-    y = maxs + log(sum(exp(x - repmat(maxs, 1, x.n_cols)), 1));
-  }
-
-  if (maxs.has_inf())
-  {
-    y.replace(-std::numeric_limits<typename T::elem_type>::quiet_NaN(),
-              -std::numeric_limits<typename T::elem_type>::infinity());
-  }
+    y = maxs + log(sum(exp(x.each_col() - maxs), 1));
 }
 
 /**
@@ -110,28 +101,77 @@ void LogSumExp(const T& x, arma::Col<typename T::elem_type>& y)
 template<typename T, bool InPlace>
 void LogSumExpT(const T& x, arma::Col<typename T::elem_type>& y)
 {
-  arma::Row<typename T::elem_type> maxs;
+  typedef typename T::elem_type ElemType;
 
+  // Compute the maximum in each column (treating y as a row too, if needed).
+  // Columns whose maximum is infinite are not shifted, so that columns of -inf
+  // give -inf instead of NaN.
+  arma::Row<ElemType> maxs = max(x, 0);
   if (InPlace)
-  {
-    // Compute the maximum element in each column.
-    maxs = max(max(x, 0), y.t());
+    maxs = max(maxs, y.t());
+  maxs.elem(arma::find_nonfinite(maxs)).zeros();
 
-    y = maxs.t() + log(sum(exp(x - repmat(maxs, x.n_rows, 1)), 0) +
-        exp(y.t() - maxs)).t();
+  if (InPlace)
+  {
+    y = (maxs + log(sum(exp(x.each_row() - maxs), 0) +
+        exp(y.t() - maxs))).t();
   }
   else
   {
-    // Compute the maximum element in each column.
-    arma::Row<typename T::elem_type> maxs = max(x, 0);
-
-    y = (maxs + log(sum(exp(x - repmat(maxs, x.n_rows, 1)), 0))).t();
+    y = (maxs + log(sum(exp(x.each_row() - maxs), 0))).t();
   }
+}
 
-  if (maxs.has_inf())
+/**
+ * Compute the log of the product of the given matrix (in linear space) with
+ * the exponential of the given vector of log values.
+ */
+template<typename T>
+void LogSumExpProduct(const T& a,
+                      const arma::Col<typename T::elem_type>& x,
+                      arma::Col<typename T::elem_type>& y)
+{
+  typedef typename T::elem_type ElemType;
+
+  // Shift by the maximum so that the largest exponential is 1.
+  ElemType maxVal = x.max();
+  if (!std::isfinite(maxVal))
+    maxVal = 0;
+
+  y = log(a * exp(x - maxVal)) + maxVal;
+
+  // A row whose nonzero elements only meet values of x far below maxVal
+  // underflows to a sum of 0 above, even though its true sum is not 0.  Redo
+  // those rows (and the rows that really are 0) in log space, shifted by the
+  // row's own maximum.
+  const arma::uvec zeroRows = arma::find(y ==
+      -std::numeric_limits<ElemType>::infinity());
+  if (zeroRows.n_elem == 0)
+    return;
+
+  const arma::unwrap<T> tmp(a);
+  const arma::Mat<ElemType>& m = tmp.M;
+  for (size_t r = 0; r < zeroRows.n_elem; ++r)
   {
-    y.replace(-std::numeric_limits<typename T::elem_type>::quiet_NaN(),
-              -std::numeric_limits<typename T::elem_type>::infinity());
+    const size_t i = zeroRows[r];
+    ElemType rowMax = -std::numeric_limits<ElemType>::infinity();
+    for (size_t j = 0; j < m.n_cols; ++j)
+    {
+      if (m(i, j) != 0)
+        rowMax = std::max(rowMax, std::log(m(i, j)) + x[j]);
+    }
+
+    if (rowMax == -std::numeric_limits<ElemType>::infinity())
+      continue;
+
+    ElemType sum = 0;
+    for (size_t j = 0; j < m.n_cols; ++j)
+    {
+      if (m(i, j) != 0)
+        sum += std::exp(std::log(m(i, j)) + x[j] - rowMax);
+    }
+
+    y[i] = std::log(sum) + rowMax;
   }
 }
 
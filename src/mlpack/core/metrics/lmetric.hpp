@@ -83,6 +83,24 @@ class LMetric
   static typename VecTypeA::elem_type Evaluate(const VecTypeA& a,
                                                const VecTypeB& b);
 
+  /**
+   * Computes the distances between one point and each column of a dense
+   * matrix at once.  This gives the same results as calling Evaluate() on each
+   * column, but avoids the overhead of evaluating one expression per pair.
+   *
+   * @tparam VecType Type of the point (generally arma::vec or a column of a
+   *      matrix).
+   * @tparam MatType Type of the matrix (generally arma::mat or a contiguous
+   *      block of columns of a matrix).
+   * @param a Point to compute distances from.
+   * @param b Points to compute distances to.
+   * @param distances Vector to store the distance to each column of b in.
+   */
+  template<typename VecType, typename MatType>
+  static void BatchEvaluate(const VecType& a,
+                            const MatType& b,
+                            arma::Col<typename MatType::elem_type>& distances);
+
   //! Serialize the metric (nothing to do).
   template<typename Archive>
   void serialize(Archive& /* ar */, const uint32_t /* version */) { }
@@ -106,6 +106,70 @@ typename VecTypeA::elem_type LMetric<INT_MAX, false>::Evaluate(
   return arma::as_scalar(arma::max(arma::abs(a - b)));
 }
 
+// The batched evaluation works directly on the memory of the points.  The
+// branches on Power and TakeRoot are resolved at compile time, and each inner
+// loop is a plain reduction over contiguous memory that the compiler can
+// vectorize (the pragmas are ignored when OpenMP is not used).  We do not use
+// the ||a||^2 + ||b||^2 - 2 a^T b expansion, because it loses precision for
+// points that are close together, which would change which neighbors are
+// found.
+template<int Power, bool TakeRoot>
+template<typename VecType, typename MatType>
+void LMetric<Power, TakeRoot>::BatchEvaluate(
+    const VecType& a,
+    const MatType& b,
+    arma::Col<typename MatType::elem_type>& distances)
+{
+  typedef typename MatType::elem_type ElemType;
+
+  distances.set_size(b.n_cols);
+  const ElemType* aMem = a.colptr(0);
+  const size_t dim = a.n_elem;
+  for (size_t j = 0; j < b.n_cols; ++j)
+  {
+    const ElemType* bMem = b.colptr(j);
+    ElemType result = 0;
+    if (Power == 1)
+    {
+      #pragma omp simd reduction(+:result)
+      for (size_t d = 0; d < dim; ++d)
+        result += std::abs(aMem[d] - bMem[d]);
+    }
+    else if (Power == 2)
+    {
+      #pragma omp simd reduction(+:result)
+      for (size_t d = 0; d < dim; ++d)
+      {
+        const ElemType diff = aMem[d] - bMem[d];
+        result += diff * diff;
+      }
+
+      if (TakeRoot)
+        result = std::sqrt(result);
+    }
+    else if (Power == INT_MAX)
+    {
+      #pragma omp simd reduction(max:result)
+      for (size_t d = 0; d < dim; ++d)
+      {
+        const ElemType diff = std::abs(aMem[d] - bMem[d]);
+        result = (diff > result) ? diff : result;
+      }
+    }
+    else
+    {
+      #pragma omp simd reduction(+:result)
+      for (size_t d = 0; d < dim; ++d)
+        result += std::pow(std::abs(aMem[d] - bMem[d]), Power);
+
+      if (TakeRoot)
+        result = std::pow(result, (1.0 / Power));
+    }
+
+    distances[j] = result;
+  }
+}
+
 } // namespace metric
 } // namespace mlpack
 
@@ -13,8 +13,10 @@
 
 #include <mlpack/prereqs.hpp>
 
+#include "../rule_traits.hpp"
 #include "../statistic.hpp"
 #include "midpoint_split.hpp"
+#include "split_traits.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -30,7 +32,11 @@ namespace tree /** Trees and tree-building procedures. */ {
  * rebuild the tree entirely.
  *
  * This tree does take one runtime parameter in the constructor, which is the
- * max leaf size to be used.
+ * max leaf size to be used.  Optionally, a cutoff for parallel construction can
+ * also be given: when the SplitType allows it (see SplitTraits), nodes holding
+ * more points than the cutoff are split level by level in parallel, and smaller
+ * subtrees are built by one thread each.  The resulting tree and point ordering
+ * are identical to a serial build.
  *
  * @tparam MetricType The metric used for tree-building.  The BoundType may
  *     place restrictions on the metrics that can be used.
@@ -88,6 +94,11 @@ class BinarySpaceTree
   //! The dataset.  If we are the root of the tree, we own the dataset and must
   //! delete it.
   MatType* dataset;
+  //! The block holding all descendants of this node, if CompactNodes() has
+  //! been called on this node (which must be the root); otherwise, NULL.
+  BinarySpaceTree* nodePool;
+  //! The number of nodes in nodePool.
+  size_t poolSize;
 
  public:
   //! A single-tree traverser for binary space trees; see
@@ -109,8 +120,12 @@ class BinarySpaceTree
    *
    * @param data Dataset to create tree from.  This will be copied!
    * @param maxLeafSize Size of each leaf in the tree.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *     parallel, if OpenMP is available and the SplitType allows it.
    */
-  BinarySpaceTree(const MatType& data, const size_t maxLeafSize = 20);
+  BinarySpaceTree(const MatType& data,
+                  const size_t maxLeafSize = 20,
+                  const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of a binary space tree using the given
@@ -123,10 +138,13 @@ class BinarySpaceTree
    * @param oldFromNew Vector which will be filled with the old positions for
    *     each new point.
    * @param maxLeafSize Size of each leaf in the tree.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *     parallel, if OpenMP is available and the SplitType allows it.
    */
   BinarySpaceTree(const MatType& data,
                   std::vector<size_t>& oldFromNew,
-                  const size_t maxLeafSize = 20);
+                  const size_t maxLeafSize = 20,
+                  const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of a binary space tree using the given
@@ -142,11 +160,14 @@ class BinarySpaceTree
    * @param newFromOld Vector which will be filled with the new positions for
    *     each old point.
    * @param maxLeafSize Size of each leaf in the tree.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *     parallel, if OpenMP is available and the SplitType allows it.
    */
   BinarySpaceTree(const MatType& data,
                   std::vector<size_t>& oldFromNew,
                   std::vector<size_t>& newFromOld,
-                  const size_t maxLeafSize = 20);
+                  const size_t maxLeafSize = 20,
+                  const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of a binary space tree using the given
@@ -156,9 +177,12 @@ class BinarySpaceTree
    *
    * @param data Dataset to create tree from.
    * @param maxLeafSize Size of each leaf in the tree.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *     parallel, if OpenMP is available and the SplitType allows it.
    */
   BinarySpaceTree(MatType&& data,
-                  const size_t maxLeafSize = 20);
+                  const size_t maxLeafSize = 20,
+                  const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of a binary space tree using the given
@@ -171,10 +195,13 @@ class BinarySpaceTree
    * @param oldFromNew Vector which will be filled with the old positions for
    *     each new point.
    * @param maxLeafSize Size of each leaf in the tree.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *     parallel, if OpenMP is available and the SplitType allows it.
    */
   BinarySpaceTree(MatType&& data,
                   std::vector<size_t>& oldFromNew,
-                  const size_t maxLeafSize = 20);
+                  const size_t maxLeafSize = 20,
+                  const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of a binary space tree using the given
@@ -190,11 +217,14 @@ class BinarySpaceTree
    * @param newFromOld Vector which will be filled with the new positions for
    *     each old point.
    * @param maxLeafSize Size of each leaf in the tree.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *     parallel, if OpenMP is available and the SplitType allows it.
    */
   BinarySpaceTree(MatType&& data,
                   std::vector<size_t>& oldFromNew,
                   std::vector<size_t>& newFromOld,
-                  const size_t maxLeafSize = 20);
+                  const size_t maxLeafSize = 20,
+                  const size_t parallelCutoff = 10000);
 
   /**
    * Construct this node as a child of the given parent, starting at column
@@ -507,6 +537,19 @@ class BinarySpaceTree
   //! Store the center of the bounding region in the given vector.
   void Center(arma::vec& center) const { bound.Center(center); }
 
+  /**
+   * Move all descendants of this node into a single contiguous block of
+   * memory, laid out in depth-first order, so that traversals touch nearby
+   * memory and the tree can be freed with one deallocation.  The statistics of
+   * all nodes are recomputed, since they may refer to the moved nodes.  This
+   * can only be called on the root of the tree; after calling it, the children
+   * of the nodes must not be replaced or deleted individually.
+   */
+  void CompactNodes();
+
+  //! Return whether the descendants of this node are held in a node pool.
+  bool IsCompact() const { return nodePool != NULL; }
+
  private:
   /**
    * Splits the current node, assigning its left and right children recursively.
@@ -529,6 +572,57 @@ class BinarySpaceTree
                  const size_t maxLeafSize,
                  SplitType<BoundType<MetricType>, MatType>& splitter);
 
+  /**
+   * Build the tree rooted at this node.  If the SplitType allows it and the
+   * node holds more than parallelCutoff points, nodes are split one level at a
+   * time, with all nodes of a level split in parallel; any subtree holding at
+   * most parallelCutoff points is built recursively by a single thread.
+   * Otherwise, this is the same as SplitNode().
+   *
+   * @param oldFromNew Vector holding permuted indices (may be NULL).
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @param parallelCutoff Maximum number of points in a node built serially.
+   * @param splitter Instantiated SplitType object.
+   */
+  void BuildTree(std::vector<size_t>* oldFromNew,
+                 const size_t maxLeafSize,
+                 const size_t parallelCutoff,
+                 SplitType<BoundType<MetricType>, MatType>& splitter);
+
+  /**
+   * Partition the points of this node and create its children.  The bound of
+   * this node must already be computed.  If recurse is true, the children are
+   * split recursively; otherwise, only the bounds of the children are computed
+   * and the children are left unsplit.
+   *
+   * @param oldFromNew Vector holding permuted indices (may be NULL).
+   * @param maxLeafSize Maximum number of points held in a leaf.
+   * @param splitter Instantiated SplitType object.
+   * @param recurse Whether or not to split the children.
+   */
+  void SplitChildren(std::vector<size_t>* oldFromNew,
+                     const size_t maxLeafSize,
+                     SplitType<BoundType<MetricType>, MatType>& splitter,
+                     const bool recurse);
+
+  //! Compute the parent distances of the children of this node.
+  void ComputeChildParentDistances();
+
+  /**
+   * Delete the children of this node (and the node pool, if this node holds
+   * one), and set the children to NULL.
+   */
+  void DeleteChildren();
+
+  /**
+   * Construct this node as an unsplit child of the given parent, holding the
+   * points in the range [begin, begin + count).  Only the bound of the node is
+   * computed.  This is used by BuildTree().
+   */
+  BinarySpaceTree(BinarySpaceTree* parent,
+                  const size_t begin,
+                  const size_t count);
+
   /**
    * Update the bound of the current node. This method does not take into
    * account bound-specific properties.
@@ -558,6 +652,9 @@ class BinarySpaceTree
   //! Friend access is given for the default constructor.
   friend class cereal::access;
 
+  //! Friend access is given to build and flatten trees in the flat format.
+  template<typename FlatTreeType> friend class FlatTree;
+
  public:
   /**
    * Serialize the tree.
@@ -15,7 +15,9 @@
 #include "binary_space_tree.hpp"
 
 #include <mlpack/core/util/log.hpp>
+#include <memory>
 #include <queue>
+#include <stack>
 
 namespace mlpack {
 namespace tree {
@@ -31,7 +33,8 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 BinarySpaceTree(
     const MatType& data,
-    const size_t maxLeafSize) :
+    const size_t maxLeafSize,
+    const size_t parallelCutoff) :
     left(NULL),
     right(NULL),
     parent(NULL),
@@ -39,11 +42,13 @@ BinarySpaceTree(
     count(data.n_cols), /* and spans all of the dataset. */
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    nodePool(NULL),
+    poolSize(0)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(maxLeafSize, splitter);
+  BuildTree(NULL, maxLeafSize, parallelCutoff, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -59,7 +64,8 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 BinarySpaceTree(
     const MatType& data,
     std::vector<size_t>& oldFromNew,
-    const size_t maxLeafSize) :
+    const size_t maxLeafSize,
+    const size_t parallelCutoff) :
     left(NULL),
     right(NULL),
     parent(NULL),
@@ -67,7 +73,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    nodePool(NULL),
+    poolSize(0)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(data.n_cols);
@@ -76,7 +84,7 @@ BinarySpaceTree(
 
   // Now do the actual splitting.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
+  BuildTree(&oldFromNew, maxLeafSize, parallelCutoff, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -93,7 +101,8 @@ BinarySpaceTree(
     const MatType& data,
     std::vector<size_t>& oldFromNew,
     std::vector<size_t>& newFromOld,
-    const size_t maxLeafSize) :
+    const size_t maxLeafSize,
+    const size_t parallelCutoff) :
     left(NULL),
     right(NULL),
     parent(NULL),
@@ -101,7 +110,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(data)) // Copies the dataset.
+    dataset(new MatType(data)), // Copies the dataset.
+    nodePool(NULL),
+    poolSize(0)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(data.n_cols);
@@ -110,7 +121,7 @@ BinarySpaceTree(
 
   // Now do the actual splitting.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
+  BuildTree(&oldFromNew, maxLeafSize, parallelCutoff, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -128,7 +139,9 @@ template<typename MetricType,
          template<typename SplitBoundType, typename SplitMatType>
              class SplitType>
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
-BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
+BinarySpaceTree(MatType&& data,
+                const size_t maxLeafSize,
+                const size_t parallelCutoff) :
     left(NULL),
     right(NULL),
     parent(NULL),
@@ -136,11 +149,13 @@ BinarySpaceTree(MatType&& data, const size_t maxLeafSize) :
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Do the actual splitting of this node.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(maxLeafSize, splitter);
+  BuildTree(NULL, maxLeafSize, parallelCutoff, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -156,7 +171,8 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
 BinarySpaceTree(
     MatType&& data,
     std::vector<size_t>& oldFromNew,
-    const size_t maxLeafSize) :
+    const size_t maxLeafSize,
+    const size_t parallelCutoff) :
     left(NULL),
     right(NULL),
     parent(NULL),
@@ -164,7 +180,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Initialize oldFromNew correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -173,7 +191,7 @@ BinarySpaceTree(
 
   // Now do the actual splitting.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
+  BuildTree(&oldFromNew, maxLeafSize, parallelCutoff, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -190,7 +208,8 @@ BinarySpaceTree(
     MatType&& data,
     std::vector<size_t>& oldFromNew,
     std::vector<size_t>& newFromOld,
-    const size_t maxLeafSize) :
+    const size_t maxLeafSize,
+    const size_t parallelCutoff) :
     left(NULL),
     right(NULL),
     parent(NULL),
@@ -198,7 +217,9 @@ BinarySpaceTree(
     count(data.n_cols),
     bound(data.n_rows),
     parentDistance(0), // Parent distance for the root is 0: it has no parent.
-    dataset(new MatType(std::move(data)))
+    dataset(new MatType(std::move(data))),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Initialize the oldFromNew vector correctly.
   oldFromNew.resize(dataset->n_cols);
@@ -207,7 +228,7 @@ BinarySpaceTree(
 
   // Now do the actual splitting.
   SplitType<BoundType<MetricType>, MatType> splitter;
-  SplitNode(oldFromNew, maxLeafSize, splitter);
+  BuildTree(&oldFromNew, maxLeafSize, parallelCutoff, splitter);
 
   // Create the statistic depending on if we are a leaf or not.
   stat = StatisticType(*this);
@@ -237,7 +258,9 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset()) // Point to the parent's dataset.
+    dataset(&parent->Dataset()), // Point to the parent's dataset.
+    nodePool(NULL),
+    poolSize(0)
 {
   // Perform the actual splitting.
   SplitNode(maxLeafSize, splitter);
@@ -266,7 +289,9 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset().n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -300,7 +325,9 @@ BinarySpaceTree(
     begin(begin),
     count(count),
     bound(parent->Dataset()->n_rows),
-    dataset(&parent->Dataset())
+    dataset(&parent->Dataset()),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Hopefully the vector is initialized correctly!  We can't check that
   // entirely but we can do a minor sanity check.
@@ -318,6 +345,33 @@ BinarySpaceTree(
     newFromOld[oldFromNew[i]] = i;
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BinarySpaceTree(
+    BinarySpaceTree* parent,
+    const size_t begin,
+    const size_t count) :
+    left(NULL),
+    right(NULL),
+    parent(parent),
+    begin(begin),
+    count(count),
+    bound(parent->Dataset().n_rows),
+    parentDistance(0),
+    dataset(&parent->Dataset()),
+    nodePool(NULL),
+    poolSize(0)
+{
+  // Only compute the bound; BuildTree() will split this node later.
+  UpdateBound(bound);
+  furthestDescendantDistance = 0.5 * bound.Diameter();
+}
+
 /**
  * Create a binary space tree by copying the other tree.  Be careful!  This can
  * take a long time and use a lot of memory.
@@ -342,7 +396,9 @@ BinarySpaceTree(
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
     // Copy matrix, but only if we are the root.
-    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL)
+    dataset((other.parent == NULL) ? new MatType(*other.dataset) : NULL),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Create left and right children (if any).
   if (other.Left())
@@ -398,8 +454,7 @@ operator=(const BinarySpaceTree& other)
 
   // Freeing memory that will not be used anymore.
   delete dataset;
-  delete left;
-  delete right;
+  DeleteChildren();
 
   left = NULL;
   right = NULL;
@@ -470,8 +525,7 @@ operator=(BinarySpaceTree&& other)
 
   // Freeing memory that will not be used anymore.
   delete dataset;
-  delete left;
-  delete right;
+  DeleteChildren();
 
   parent = other.Parent();
   left = other.Left();
@@ -484,6 +538,8 @@ operator=(BinarySpaceTree&& other)
   furthestDescendantDistance = other.FurthestDescendantDistance();
   minimumBoundDistance = other.MinimumBoundDistance();
   dataset = other.dataset;
+  nodePool = other.nodePool;
+  poolSize = other.poolSize;
 
   other.left = NULL;
   other.right = NULL;
@@ -494,6 +550,8 @@ operator=(BinarySpaceTree&& other)
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.nodePool = NULL;
+  other.poolSize = 0;
 
   return *this;
 }
@@ -520,7 +578,9 @@ BinarySpaceTree(BinarySpaceTree&& other) :
     parentDistance(other.parentDistance),
     furthestDescendantDistance(other.furthestDescendantDistance),
     minimumBoundDistance(other.minimumBoundDistance),
-    dataset(other.dataset)
+    dataset(other.dataset),
+    nodePool(other.nodePool),
+    poolSize(other.poolSize)
 {
   // Now we are a clone of the other tree.  But we must also clear the other
   // tree's contents, so it doesn't delete anything when it is destructed.
@@ -533,6 +593,8 @@ BinarySpaceTree(BinarySpaceTree&& other) :
   other.furthestDescendantDistance = 0.0;
   other.minimumBoundDistance = 0.0;
   other.dataset = NULL;
+  other.nodePool = NULL;
+  other.poolSize = 0;
 
   // Set new parent.
   if (left)
@@ -576,8 +638,7 @@ template<typename MetricType,
 BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     ~BinarySpaceTree()
 {
-  delete left;
-  delete right;
+  DeleteChildren();
 
   // If we're the root, delete the matrix.
   if (!parent)
@@ -874,54 +935,8 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   // Calculate the furthest descendant distance.
   furthestDescendantDistance = 0.5 * bound.Diameter();
 
-  // Now, check if we need to split at all.
-  if (count <= maxLeafSize)
-    return; // We can't split this.
-
-  // splitCol denotes the two partitions of the dataset after the split. The
-  // points on its left go to the left child and the others go to the right
-  // child.
-  size_t splitCol;
-
-  // Find the partition of the node. This method does not perform the split.
-  typename Split::SplitInfo splitInfo;
-
-  const bool split = splitter.SplitNode(bound, *dataset, begin, count,
-      splitInfo);
-
-  // The node may not be always split. For instance, if all the points are the
-  // same, we can't split them.
-  if (!split)
-    return;
-
-  // Perform the actual splitting.  This will order the dataset such that
-  // points that belong to the left subtree are on the left of splitCol, and
-  // points from the right subtree are on the right side of splitCol.
-  splitCol = splitter.PerformSplit(*dataset, begin, count, splitInfo);
-
-  assert(splitCol > begin);
-  assert(splitCol < begin + count);
-
-  // Now that we know the split column, we will recursively split the children
-  // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
-      maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      splitter, maxLeafSize);
-
-  // Calculate parent distances for those two nodes.
-  arma::vec center, leftCenter, rightCenter;
-  Center(center);
-  left->Center(leftCenter);
-  right->Center(rightCenter);
-
-  const ElemType leftParentDistance = bound.Metric().Evaluate(center,
-      leftCenter);
-  const ElemType rightParentDistance = bound.Metric().Evaluate(center,
-      rightCenter);
-
-  left->ParentDistance() = leftParentDistance;
-  right->ParentDistance() = rightParentDistance;
+  // Now split the node and build the children recursively.
+  SplitChildren(NULL, maxLeafSize, splitter, true);
 }
 
 template<typename MetricType,
@@ -941,6 +956,100 @@ SplitNode(std::vector<size_t>& oldFromNew,
   // Calculate the furthest descendant distance.
   furthestDescendantDistance = 0.5 * bound.Diameter();
 
+  // Now split the node and build the children recursively.
+  SplitChildren(&oldFromNew, maxLeafSize, splitter, true);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+BuildTree(std::vector<size_t>* oldFromNew,
+          const size_t maxLeafSize,
+          const size_t parallelCutoff,
+          SplitType<BoundType<MetricType>, MatType>& splitter)
+{
+  // If the splitter can't be used by several threads at once, or if there are
+  // not enough points to make it worthwhile, build the tree serially.
+  if (!SplitTraits<Split>::ParallelSafe || count <= parallelCutoff)
+  {
+    if (oldFromNew)
+      SplitNode(*oldFromNew, maxLeafSize, splitter);
+    else
+      SplitNode(maxLeafSize, splitter);
+    return;
+  }
+
+  UpdateBound(bound);
+  furthestDescendantDistance = 0.5 * bound.Diameter();
+
+  // Split the large nodes one level at a time.  Every node of a level holds a
+  // disjoint range of the dataset (and of oldFromNew), so the nodes can be
+  // split in any order and the result is the same as a serial build.  Nodes
+  // that are small enough are built entirely by one thread.
+  std::vector<BinarySpaceTree*> upperNodes;
+  std::vector<BinarySpaceTree*> level(1, this);
+  while (!level.empty())
+  {
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) level.size(); ++i)
+    {
+      BinarySpaceTree* node = level[i];
+      if (node->count > parallelCutoff)
+      {
+        node->SplitChildren(oldFromNew, maxLeafSize, splitter, false);
+      }
+      else
+      {
+        node->SplitChildren(oldFromNew, maxLeafSize, splitter, true);
+        node->stat = StatisticType(*node);
+      }
+    }
+
+    std::vector<BinarySpaceTree*> nextLevel;
+    for (size_t i = 0; i < level.size(); ++i)
+    {
+      if (level[i]->count <= parallelCutoff)
+        continue;
+
+      upperNodes.push_back(level[i]);
+      if (level[i]->left)
+      {
+        nextLevel.push_back(level[i]->left);
+        nextLevel.push_back(level[i]->right);
+      }
+    }
+    level.swap(nextLevel);
+  }
+
+  // The parent distances and statistics of the large nodes depend on their
+  // children, so they are filled in bottom-up.  The statistic of this node is
+  // created by the constructor.
+  for (size_t i = upperNodes.size(); i > 0; --i)
+  {
+    BinarySpaceTree* node = upperNodes[i - 1];
+    if (node->left)
+      node->ComputeChildParentDistances();
+    if (node != this)
+      node->stat = StatisticType(*node);
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+SplitChildren(std::vector<size_t>* oldFromNew,
+              const size_t maxLeafSize,
+              SplitType<BoundType<MetricType>, MatType>& splitter,
+              const bool recurse)
+{
   // First, check if we need to split at all.
   if (count <= maxLeafSize)
     return; // We can't split this.
@@ -964,19 +1073,58 @@ SplitNode(std::vector<size_t>& oldFromNew,
   // Perform the actual splitting.  This will order the dataset such that
   // points that belong to the left subtree are on the left of splitCol, and
   // points from the right subtree are on the right side of splitCol.
-  splitCol = splitter.PerformSplit(*dataset, begin, count, splitInfo,
-      oldFromNew);
+  if (oldFromNew)
+  {
+    splitCol = splitter.PerformSplit(*dataset, begin, count, splitInfo,
+        *oldFromNew);
+  }
+  else
+  {
+    splitCol = splitter.PerformSplit(*dataset, begin, count, splitInfo);
+  }
 
   assert(splitCol > begin);
   assert(splitCol < begin + count);
 
+  if (!recurse)
+  {
+    // Only compute the bounds of the children; they will be split later.  The
+    // left child must be set before the right child is created, since the
+    // bound of the right child may depend on it.
+    left = new BinarySpaceTree(this, begin, splitCol - begin);
+    right = new BinarySpaceTree(this, splitCol, begin + count - splitCol);
+    return;
+  }
+
   // Now that we know the split column, we will recursively split the children
   // by calling their constructors (which perform this splitting process).
-  left = new BinarySpaceTree(this, begin, splitCol - begin, oldFromNew,
-      splitter, maxLeafSize);
-  right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
-      oldFromNew, splitter, maxLeafSize);
+  if (oldFromNew)
+  {
+    left = new BinarySpaceTree(this, begin, splitCol - begin, *oldFromNew,
+        splitter, maxLeafSize);
+    right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+        *oldFromNew, splitter, maxLeafSize);
+  }
+  else
+  {
+    left = new BinarySpaceTree(this, begin, splitCol - begin, splitter,
+        maxLeafSize);
+    right = new BinarySpaceTree(this, splitCol, begin + count - splitCol,
+        splitter, maxLeafSize);
+  }
 
+  ComputeChildParentDistances();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+ComputeChildParentDistances()
+{
   // Calculate parent distances for those two nodes.
   arma::vec center, leftCenter, rightCenter;
   Center(center);
@@ -992,6 +1140,117 @@ SplitNode(std::vector<size_t>& oldFromNew,
   right->ParentDistance() = rightParentDistance;
 }
 
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+DeleteChildren()
+{
+  if (nodePool != NULL)
+  {
+    // The nodes in the pool are destroyed here, so they must not delete their
+    // own children.
+    for (size_t i = 0; i < poolSize; ++i)
+    {
+      nodePool[i].left = NULL;
+      nodePool[i].right = NULL;
+      nodePool[i].~BinarySpaceTree();
+    }
+
+    std::allocator<BinarySpaceTree>().deallocate(nodePool, poolSize);
+    nodePool = NULL;
+    poolSize = 0;
+  }
+  else
+  {
+    delete left;
+    delete right;
+  }
+
+  left = NULL;
+  right = NULL;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
+CompactNodes()
+{
+  if (parent != NULL)
+  {
+    throw std::invalid_argument("BinarySpaceTree::CompactNodes(): can only be "
+        "called on the root of the tree!");
+  }
+
+  // Collect the descendants of this node in depth-first order.
+  std::vector<BinarySpaceTree*> nodes;
+  std::stack<BinarySpaceTree*> stack;
+  if (right)
+    stack.push(right);
+  if (left)
+    stack.push(left);
+  while (!stack.empty())
+  {
+    BinarySpaceTree* node = stack.top();
+    stack.pop();
+    nodes.push_back(node);
+
+    if (node->right)
+      stack.push(node->right);
+    if (node->left)
+      stack.push(node->left);
+  }
+
+  if (nodes.empty())
+    return;
+
+  // Move each node into the new pool.  A parent always comes before its
+  // children, so when a node is moved its parent has already been moved, and
+  // the move constructor points the children of the node at the new location.
+  std::allocator<BinarySpaceTree> allocator;
+  BinarySpaceTree* newPool = allocator.allocate(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    BinarySpaceTree* oldNode = nodes[i];
+    BinarySpaceTree* parentNode = oldNode->parent;
+    BinarySpaceTree* newNode = new (newPool + i)
+        BinarySpaceTree(std::move(*oldNode));
+
+    if (parentNode->left == oldNode)
+      parentNode->left = newNode;
+    else
+      parentNode->right = newNode;
+
+    // The moved-from node holds nothing anymore.  If it lives in an old pool,
+    // it is destroyed with that pool below.
+    if (nodePool == NULL)
+      delete oldNode;
+  }
+
+  if (nodePool != NULL)
+  {
+    for (size_t i = 0; i < poolSize; ++i)
+      nodePool[i].~BinarySpaceTree();
+    allocator.deallocate(nodePool, poolSize);
+  }
+
+  nodePool = newPool;
+  poolSize = nodes.size();
+
+  // Statistics may hold pointers to nodes, so they are recomputed.  Walking
+  // the pool in reverse visits children before their parents.
+  for (size_t i = poolSize; i > 0; --i)
+    nodePool[i - 1].stat = StatisticType(nodePool[i - 1]);
+  stat = StatisticType(*this);
+}
+
 template<typename MetricType,
          typename StatisticType,
          typename MatType,
@@ -1049,7 +1308,9 @@ BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
     stat(*this),
     parentDistance(0),
     furthestDescendantDistance(0),
-    dataset(NULL)
+    dataset(NULL),
+    nodePool(NULL),
+    poolSize(0)
 {
   // Nothing to do.
 }
@@ -1070,10 +1331,7 @@ void BinarySpaceTree<MetricType, StatisticType, MatType, BoundType, SplitType>::
   // If we're loading, and we have children, they need to be deleted.
   if (cereal::is_loading<Archive>())
   {
-    if (left)
-      delete left;
-    if (right)
-      delete right;
+    DeleteChildren();
     if (!parent)
       delete dataset;
 
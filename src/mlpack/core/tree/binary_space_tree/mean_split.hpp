@@ -16,6 +16,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/tree/perform_split.hpp>
+#include "split_traits.hpp"
 
 namespace mlpack {
 namespace tree /** Trees and tree-building procedures. */ {
@@ -117,6 +118,16 @@ class MeanSplit
   }
 };
 
+/**
+ * MeanSplit is deterministic and keeps no state, so nodes may be split
+ * concurrently.
+ */
+template<typename BoundType, typename MatType>
+struct SplitTraits<MeanSplit<BoundType, MatType>>
+{
+  static const bool ParallelSafe = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
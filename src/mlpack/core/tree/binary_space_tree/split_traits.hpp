@@ -0,0 +1,39 @@
+/**
+ * @file core/tree/binary_space_tree/split_traits.hpp
+ *
+ * A class for template metaprogramming traits for the SplitType classes used by
+ * BinarySpaceTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+#define MLPACK_CORE_TREE_BINARY_SPACE_TREE_SPLIT_TRAITS_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A class to obtain compile-time traits about SplitType classes.  If you are
+ * writing your own SplitType class, you may make a template specialization in
+ * order to set the values correctly.
+ *
+ * @see TreeTraits, BoundTraits
+ */
+template<typename SplitType>
+struct SplitTraits
+{
+  //! If true, then SplitNode() and PerformSplit() may be called concurrently
+  //! on disjoint ranges of the dataset, and their results depend only on the
+  //! points in the given range (so no random numbers or internal state are
+  //! used).  This allows BinarySpaceTree to be built in parallel.  This
+  //! defaults to false.
+  static const bool ParallelSafe = false;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
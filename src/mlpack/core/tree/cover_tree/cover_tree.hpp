@@ -561,6 +561,9 @@ class CoverTree
   //! Friend access is given for the default constructor.
   friend class cereal::access;
 
+  //! Friend access is given to build and flatten trees in the flat format.
+  template<typename FlatTreeType> friend class FlatTree;
+
  public:
   /**
    * Serialize the tree.
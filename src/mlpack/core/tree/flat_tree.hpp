@@ -0,0 +1,400 @@
+/**
+ * @file core/tree/flat_tree.hpp
+ *
+ * A flat, pointer-free file format for trees.  Every node of a tree is stored
+ * as a fixed-size record in a contiguous array, and the bounds of all nodes are
+ * stored in a second contiguous array; children are referenced by their offset
+ * in the node array.  Loading a tree from this format requires no distance
+ * computations, and the dataset can be used in place from a memory mapping.
+ * The nodes and their bounds are still allocated one at a time and filled in
+ * from the arrays, and the statistics are deserialized with cereal, so loading
+ * takes time linear in the number of nodes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_FLAT_TREE_HPP
+#define MLPACK_CORE_TREE_FLAT_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/data/mapped_file.hpp>
+#include <cereal/archives/binary.hpp>
+#include "binary_space_tree.hpp"
+#include "cover_tree.hpp"
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * A single node of a flattened tree.  The nodes of a flattened tree are stored
+ * in breadth-first order, so the children of a node are contiguous in the node
+ * array and can be found at [firstChild, firstChild + numChildren).  The root
+ * is the first node.
+ */
+struct FlatTreeNode
+{
+  //! The index of the first point of the node (for the CoverTree, the point
+  //! held by the node).
+  uint64_t begin;
+  //! The number of points in the node (for the CoverTree, the number of
+  //! descendant points).
+  uint64_t count;
+  //! The offset of the first child in the node array.
+  uint64_t firstChild;
+  //! The number of children of the node.
+  uint64_t numChildren;
+  //! The scale of the node (only used by the CoverTree).
+  int64_t scale;
+  //! The distance from the center of the node to the center of its parent.
+  double parentDistance;
+  //! The distance to the furthest descendant point.
+  double furthestDescendantDistance;
+  //! The minimum distance from the center to the edge of the bound.
+  double minimumBoundDistance;
+};
+
+/**
+ * Convert a bound to and from an array of doubles.  Specializations must
+ * provide the following static functions:
+ *
+ * @code
+ * // Return the number of doubles needed to store a bound in dim dimensions.
+ * static size_t Size(const size_t dim);
+ * // Store the given bound in the given array.
+ * static void Store(const BoundType& bound, double* out);
+ * // Restore a bound in dim dimensions from the given array.
+ * static void Load(const double* in, const size_t dim, BoundType& bound);
+ * @endcode
+ *
+ * Specializations are given for HRectBound, BallBound and HollowBallBound.
+ */
+template<typename BoundType>
+struct FlatBound;
+
+/**
+ * Convert a tree to and from the flat representation.  Specializations must
+ * provide the following:
+ *
+ * @code
+ * // The matrix type of the tree.
+ * typedef ... Mat;
+ * // A unique identifier for the kind of tree, stored in the file header.
+ * static const uint32_t Kind = ...;
+ *
+ * // Return the number of doubles used to store the bound of a node.
+ * static size_t BoundSize(const TreeType& tree);
+ * // Flatten the tree into the given node and bound arrays, and save the
+ * // statistic of each node, in the same order, to the given archive.  Any
+ * // other information (such as the metric) may be stored in extra.
+ * static void Flatten(const TreeType& tree,
+ *                     std::vector<FlatTreeNode>& nodes,
+ *                     std::vector<double>& bounds,
+ *                     std::string& extra,
+ *                     cereal::BinaryOutputArchive& statistics);
+ * // Build a tree on the given dataset (which the tree takes ownership of)
+ * // from the given arrays, loading the statistics from the given archive.
+ * static TreeType* Build(Mat* dataset,
+ *                        const FlatTreeNode* nodes,
+ *                        const size_t numNodes,
+ *                        const double* bounds,
+ *                        const size_t boundSize,
+ *                        const std::string& extra,
+ *                        cereal::BinaryInputArchive& statistics);
+ * @endcode
+ *
+ * Specializations are given for BinarySpaceTree (with HRectBound, BallBound or
+ * HollowBallBound) and CoverTree.  The RectangleTree variants are not
+ * supported, since their auxiliary information differs for each variant.
+ */
+template<typename TreeType>
+class FlatTree;
+
+/**
+ * HasFlatFormat<TreeType>::value is true if the given type of tree can be saved
+ * in the flat tree format, so that code that handles many types of trees (such
+ * as NSModel) can check for it at compile time.
+ */
+template<typename TreeType>
+struct HasFlatFormat
+{
+  static const bool value = false;
+};
+
+/**
+ * FlatBound for the HRectBound: the bounds of each dimension, followed by the
+ * minimum width.
+ */
+template<typename MetricType, typename ElemType>
+struct FlatBound<bound::HRectBound<MetricType, ElemType>>
+{
+  typedef bound::HRectBound<MetricType, ElemType> BoundType;
+
+  static size_t Size(const size_t dim) { return 2 * dim + 1; }
+
+  static void Store(const BoundType& bound, double* out)
+  {
+    for (size_t d = 0; d < bound.Dim(); ++d)
+    {
+      out[2 * d] = bound[d].Lo();
+      out[2 * d + 1] = bound[d].Hi();
+    }
+    out[2 * bound.Dim()] = bound.MinWidth();
+  }
+
+  static void Load(const double* in, const size_t dim, BoundType& bound)
+  {
+    bound = BoundType(dim);
+    for (size_t d = 0; d < dim; ++d)
+      bound[d] = math::RangeType<ElemType>(in[2 * d], in[2 * d + 1]);
+    bound.MinWidth() = in[2 * dim];
+  }
+};
+
+/**
+ * FlatBound for the BallBound: the center, followed by the radius.
+ */
+template<typename MetricType, typename VecType>
+struct FlatBound<bound::BallBound<MetricType, VecType>>
+{
+  typedef bound::BallBound<MetricType, VecType> BoundType;
+
+  static size_t Size(const size_t dim) { return dim + 1; }
+
+  static void Store(const BoundType& bound, double* out)
+  {
+    for (size_t d = 0; d < bound.Dim(); ++d)
+      out[d] = bound.Center()[d];
+    out[bound.Dim()] = bound.Radius();
+  }
+
+  static void Load(const double* in, const size_t dim, BoundType& bound)
+  {
+    bound = BoundType(dim);
+    for (size_t d = 0; d < dim; ++d)
+      bound.Center()[d] = in[d];
+    bound.Radius() = in[dim];
+  }
+};
+
+/**
+ * FlatBound for the HollowBallBound: the center and the hollow center,
+ * followed by the inner and outer radii.
+ */
+template<typename MetricType, typename ElemType>
+struct FlatBound<bound::HollowBallBound<MetricType, ElemType>>
+{
+  typedef bound::HollowBallBound<MetricType, ElemType> BoundType;
+
+  static size_t Size(const size_t dim) { return 2 * dim + 2; }
+
+  static void Store(const BoundType& bound, double* out)
+  {
+    const size_t dim = bound.Dim();
+    for (size_t d = 0; d < dim; ++d)
+    {
+      out[d] = bound.Center()[d];
+      out[dim + d] = bound.HollowCenter()[d];
+    }
+    out[2 * dim] = bound.InnerRadius();
+    out[2 * dim + 1] = bound.OuterRadius();
+  }
+
+  static void Load(const double* in, const size_t dim, BoundType& bound)
+  {
+    bound = BoundType(dim);
+    for (size_t d = 0; d < dim; ++d)
+    {
+      bound.Center()[d] = in[d];
+      bound.HollowCenter()[d] = in[dim + d];
+    }
+    bound.InnerRadius() = in[2 * dim];
+    bound.OuterRadius() = in[2 * dim + 1];
+  }
+};
+
+//! The BinarySpaceTree with HRectBound can be saved in the flat format.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+struct HasFlatFormat<BinarySpaceTree<MetricType, StatisticType, MatType,
+                                     bound::HRectBound, SplitType>>
+{
+  static const bool value = true;
+};
+
+//! The BinarySpaceTree with BallBound can be saved in the flat format.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+struct HasFlatFormat<BinarySpaceTree<MetricType, StatisticType, MatType,
+                                     bound::BallBound, SplitType>>
+{
+  static const bool value = true;
+};
+
+//! The BinarySpaceTree with HollowBallBound can be saved in the flat format.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+struct HasFlatFormat<BinarySpaceTree<MetricType, StatisticType, MatType,
+                                     bound::HollowBallBound, SplitType>>
+{
+  static const bool value = true;
+};
+
+//! The CoverTree can be saved in the flat format.
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename RootPointPolicy>
+struct HasFlatFormat<CoverTree<MetricType, StatisticType, MatType,
+                               RootPointPolicy>>
+{
+  static const bool value = true;
+};
+
+/**
+ * FlatTree for the BinarySpaceTree.  The bound of each node is stored with
+ * FlatBound; the metric is default-constructed when the tree is loaded.  All
+ * nodes but the root are built in one node pool (see
+ * BinarySpaceTree::CompactNodes()).
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+class FlatTree<BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
+                               SplitType>>
+{
+ public:
+  typedef BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
+      SplitType> TreeType;
+  typedef MatType Mat;
+
+  static const uint32_t Kind = 1;
+
+  static size_t BoundSize(const TreeType& tree);
+
+  static void Flatten(const TreeType& tree,
+                      std::vector<FlatTreeNode>& nodes,
+                      std::vector<double>& bounds,
+                      std::string& extra,
+                      cereal::BinaryOutputArchive& statistics);
+
+  static TreeType* Build(MatType* dataset,
+                         const FlatTreeNode* nodes,
+                         const size_t numNodes,
+                         const double* bounds,
+                         const size_t boundSize,
+                         const std::string& extra,
+                         cereal::BinaryInputArchive& statistics);
+};
+
+/**
+ * FlatTree for the CoverTree.  No bounds are stored; the base and the metric
+ * of the tree are stored with cereal as extra information.
+ */
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename RootPointPolicy>
+class FlatTree<CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>>
+{
+ public:
+  typedef CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>
+      TreeType;
+  typedef MatType Mat;
+
+  static const uint32_t Kind = 2;
+
+  static size_t BoundSize(const TreeType& /* tree */) { return 0; }
+
+  static void Flatten(const TreeType& tree,
+                      std::vector<FlatTreeNode>& nodes,
+                      std::vector<double>& bounds,
+                      std::string& extra,
+                      cereal::BinaryOutputArchive& statistics);
+
+  static TreeType* Build(MatType* dataset,
+                         const FlatTreeNode* nodes,
+                         const size_t numNodes,
+                         const double* bounds,
+                         const size_t boundSize,
+                         const std::string& extra,
+                         cereal::BinaryInputArchive& statistics);
+};
+
+/**
+ * Save the given tree, together with its dataset and the statistics of its
+ * nodes (with cereal), in the flat tree format.  Optionally, the mappings
+ * from the new indices of the points to the old ones (as returned by the
+ * BinarySpaceTree constructors) can be saved too.  A std::runtime_error is
+ * thrown if the file cannot be written.
+ *
+ * @param filename Name of the file to save to.
+ * @param tree Tree to save.
+ * @param oldFromNew Mappings of the point indices to save.
+ */
+template<typename TreeType>
+void SaveFlat(const std::string& filename,
+              const TreeType& tree,
+              const std::vector<size_t>& oldFromNew = std::vector<size_t>());
+
+/**
+ * Load a tree saved with SaveFlat(), using the dataset in place.  The file is
+ * mapped (COPY_ON_WRITE) into the given MappedFile, the dataset of the returned
+ * tree is an alias of the mapped memory, and the tree is rebuilt directly from
+ * the node and bound arrays, without any distance computations; the
+ * statistics of the nodes are loaded from the file.  Only the dataset is used
+ * in place: every node and its bound is allocated and copied out of the
+ * mapping.  The mapping must outlive the returned tree, which must be deleted
+ * by the caller.  A std::runtime_error is thrown if the file is not a valid
+ * flat tree file for the given type of tree.
+ *
+ * @param filename Name of the file to load from.
+ * @param oldFromNew Vector to store the saved mappings of point indices in.
+ * @param mapping Object that will hold the mapping of the file.
+ */
+template<typename TreeType>
+TreeType* LoadFlat(const std::string& filename,
+                   std::vector<size_t>& oldFromNew,
+                   data::MappedFile& mapping);
+
+/**
+ * Load a tree saved with SaveFlat(), like the overload above, but copy the
+ * dataset out of the file, so that the returned tree does not depend on the
+ * mapping.  The returned tree must be deleted by the caller.
+ *
+ * @param filename Name of the file to load from.
+ * @param oldFromNew Vector to store the saved mappings of point indices in.
+ */
+template<typename TreeType>
+TreeType* LoadFlat(const std::string& filename,
+                   std::vector<size_t>& oldFromNew);
+
+/**
+ * Load a tree saved with SaveFlat(), copying its dataset and ignoring any
+ * saved mappings.  The returned tree must be deleted by the caller.
+ *
+ * @param filename Name of the file to load from.
+ */
+template<typename TreeType>
+TreeType* LoadFlat(const std::string& filename);
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_tree_impl.hpp"
+
+#endif
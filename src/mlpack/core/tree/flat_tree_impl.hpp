@@ -0,0 +1,606 @@
+/**
+ * @file core/tree/flat_tree_impl.hpp
+ *
+ * Implementation of the flat tree format.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_FLAT_TREE_IMPL_HPP
+#define MLPACK_CORE_TREE_FLAT_TREE_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_tree.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <sstream>
+#include <streambuf>
+
+namespace mlpack {
+namespace tree {
+
+// A flat tree file is laid out as follows (all values in native byte order):
+//
+//   bytes  0 -  7: the magic string "MLPACKFT"
+//   bytes  8 - 11: format version (uint32_t)
+//   bytes 12 - 15: kind of tree, see FlatTree<>::Kind (uint32_t)
+//   bytes 16 - 19: size of one element of the dataset in bytes (uint32_t)
+//   bytes 20 - 23: number of doubles in the bound of each node (uint32_t)
+//   bytes 24 - 31: number of rows of the dataset (uint64_t)
+//   bytes 32 - 39: number of columns of the dataset (uint64_t)
+//   bytes 40 - 47: number of nodes (uint64_t)
+//   bytes 48 - 55: number of saved index mappings (uint64_t)
+//   bytes 56 - 63: size of the extra information in bytes (uint64_t)
+//   bytes 64 - 71: size of the statistics in bytes (uint64_t)
+//
+// The header is followed by the dataset, the index mappings (uint64_t), the
+// node array (FlatTreeNode), the bound array (double), the extra information,
+// and the statistics of the nodes (a cereal binary archive), in that order,
+// each zero-padded to a multiple of 8 bytes.  Because every section starts at a
+// multiple of 8 bytes, the dataset, node and bound arrays can be used directly
+// from the memory-mapped file.
+static const char flatTreeMagic[8] = { 'M', 'L', 'P', 'A', 'C', 'K', 'F',
+    'T' };
+static const uint32_t flatTreeVersion = 2;
+static const size_t flatTreeHeaderSize = 72;
+
+static_assert(sizeof(FlatTreeNode) == 64, "FlatTreeNode must be 64 bytes.");
+
+//! Return the number of padding bytes needed after a section of the given size.
+inline size_t FlatTreePadding(const size_t bytes)
+{
+  return (8 - (bytes % 8)) % 8;
+}
+
+/**
+ * Check that a section of count elements of the given size fits in a file of
+ * the given size when it starts at offset, and if so, advance offset past the
+ * section (and its padding).
+ */
+inline bool FlatTreeSection(size_t& offset,
+                            const uint64_t count,
+                            const size_t elemSize,
+                            const size_t fileSize)
+{
+  if (offset > fileSize || count > (fileSize - offset) / elemSize)
+    return false;
+
+  const size_t bytes = (size_t) count * elemSize;
+  offset += bytes + FlatTreePadding(bytes);
+  return true;
+}
+
+/**
+ * A read-only stream buffer over a block of memory, so that a section of a
+ * mapped file can be read with cereal without copying it.
+ */
+class FlatTreeBuffer : public std::streambuf
+{
+ public:
+  FlatTreeBuffer(const char* data, const size_t size)
+  {
+    char* begin = const_cast<char*>(data);
+    setg(begin, begin, begin + size);
+  }
+};
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+size_t FlatTree<BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
+    SplitType>>::BoundSize(const TreeType& tree)
+{
+  return FlatBound<BoundType<MetricType>>::Size(tree.Dataset().n_rows);
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+void FlatTree<BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
+    SplitType>>::Flatten(const TreeType& tree,
+                         std::vector<FlatTreeNode>& nodes,
+                         std::vector<double>& bounds,
+                         std::string& extra,
+                         cereal::BinaryOutputArchive& statistics)
+{
+  const size_t boundSize = BoundSize(tree);
+
+  // Visit the nodes in breadth-first order; the queue then holds the nodes in
+  // the order that they are stored.
+  std::vector<const TreeType*> queue;
+  queue.push_back(&tree);
+  nodes.clear();
+  bounds.clear();
+  extra.clear();
+  for (size_t i = 0; i < queue.size(); ++i)
+  {
+    const TreeType* node = queue[i];
+
+    FlatTreeNode flat;
+    flat.begin = node->begin;
+    flat.count = node->count;
+    flat.firstChild = queue.size();
+    flat.numChildren = node->NumChildren();
+    flat.scale = 0;
+    flat.parentDistance = node->parentDistance;
+    flat.furthestDescendantDistance = node->furthestDescendantDistance;
+    flat.minimumBoundDistance = node->minimumBoundDistance;
+    nodes.push_back(flat);
+
+    for (size_t c = 0; c < node->NumChildren(); ++c)
+      queue.push_back(&node->Child(c));
+
+    bounds.resize(bounds.size() + boundSize);
+    FlatBound<BoundType<MetricType>>::Store(node->bound,
+        bounds.data() + i * boundSize);
+
+    const StatisticType& stat = node->stat;
+    statistics(CEREAL_NVP(stat));
+  }
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         template<typename BoundMetricType, typename...> class BoundType,
+         template<typename SplitBoundType, typename SplitMatType>
+             class SplitType>
+typename FlatTree<BinarySpaceTree<MetricType, StatisticType, MatType,
+    BoundType, SplitType>>::TreeType*
+FlatTree<BinarySpaceTree<MetricType, StatisticType, MatType, BoundType,
+    SplitType>>::Build(MatType* dataset,
+                       const FlatTreeNode* nodes,
+                       const size_t numNodes,
+                       const double* bounds,
+                       const size_t boundSize,
+                       const std::string& /* extra */,
+                       cereal::BinaryInputArchive& statistics)
+{
+  const size_t dim = dataset->n_rows;
+  if (boundSize != FlatBound<BoundType<MetricType>>::Size(dim))
+  {
+    delete dataset;
+    throw std::runtime_error("FlatTree::Build(): the size of the saved bounds "
+        "does not match the bound type of the tree.");
+  }
+
+  // The root takes ownership of the dataset, and every other node is built in
+  // the node pool of the root, in the order that they are stored (node i is
+  // nodePool[i - 1]).  If anything goes wrong, deleting the root deletes
+  // everything that has been built so far.
+  TreeType* root = new TreeType();
+  root->dataset = dataset;
+  if (numNodes > 1)
+  {
+    TreeType* pool = std::allocator<TreeType>().allocate(numNodes - 1);
+    for (size_t i = 0; i < numNodes - 1; ++i)
+      new (pool + i) TreeType();
+    root->nodePool = pool;
+    root->poolSize = numNodes - 1;
+  }
+
+  try
+  {
+    std::vector<bool> reached(numNodes, false);
+    reached[0] = true;
+    for (size_t i = 0; i < numNodes; ++i)
+    {
+      TreeType* node = (i == 0) ? root : root->nodePool + (i - 1);
+      const FlatTreeNode& flat = nodes[i];
+      bool valid = reached[i] && (flat.begin <= dataset->n_cols) &&
+          (flat.count <= dataset->n_cols - flat.begin) &&
+          (flat.numChildren == 0 || flat.numChildren == 2);
+      if (valid && flat.numChildren == 2)
+      {
+        valid = (flat.firstChild > i) && (flat.firstChild < numNodes - 1) &&
+            !reached[flat.firstChild] && !reached[flat.firstChild + 1];
+      }
+
+      if (!valid)
+      {
+        throw std::runtime_error("FlatTree::Build(): the saved nodes do not "
+            "form a valid tree.");
+      }
+
+      node->begin = flat.begin;
+      node->count = flat.count;
+      node->parentDistance = flat.parentDistance;
+      node->furthestDescendantDistance = flat.furthestDescendantDistance;
+      node->minimumBoundDistance = flat.minimumBoundDistance;
+      node->dataset = dataset;
+      FlatBound<BoundType<MetricType>>::Load(bounds + i * boundSize, dim,
+          node->bound);
+      statistics(cereal::make_nvp("stat", node->stat));
+
+      if (flat.numChildren == 2)
+      {
+        node->left = root->nodePool + (flat.firstChild - 1);
+        node->left->parent = node;
+        node->right = root->nodePool + flat.firstChild;
+        node->right->parent = node;
+
+        reached[flat.firstChild] = true;
+        reached[flat.firstChild + 1] = true;
+      }
+    }
+  }
+  catch (...)
+  {
+    delete root;
+    throw;
+  }
+
+  return root;
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename RootPointPolicy>
+void FlatTree<CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>>::
+    Flatten(const TreeType& tree,
+            std::vector<FlatTreeNode>& nodes,
+            std::vector<double>& bounds,
+            std::string& extra,
+            cereal::BinaryOutputArchive& statistics)
+{
+  std::vector<const TreeType*> queue;
+  queue.push_back(&tree);
+  nodes.clear();
+  bounds.clear();
+  for (size_t i = 0; i < queue.size(); ++i)
+  {
+    const TreeType* node = queue[i];
+
+    FlatTreeNode flat;
+    flat.begin = node->point;
+    flat.count = node->numDescendants;
+    flat.firstChild = queue.size();
+    flat.numChildren = node->children.size();
+    flat.scale = node->scale;
+    flat.parentDistance = node->parentDistance;
+    flat.furthestDescendantDistance = node->furthestDescendantDistance;
+    flat.minimumBoundDistance = 0.0;
+    nodes.push_back(flat);
+
+    for (size_t c = 0; c < node->children.size(); ++c)
+      queue.push_back(node->children[c]);
+
+    const StatisticType& stat = node->stat;
+    statistics(CEREAL_NVP(stat));
+  }
+
+  // The base and the metric are the same for every node.
+  std::ostringstream stream;
+  {
+    cereal::BinaryOutputArchive ar(stream);
+    const typename TreeType::ElemType base = tree.base;
+    const MetricType& metric = *tree.metric;
+    ar(CEREAL_NVP(base));
+    ar(CEREAL_NVP(metric));
+  }
+  extra = stream.str();
+}
+
+template<typename MetricType,
+         typename StatisticType,
+         typename MatType,
+         typename RootPointPolicy>
+typename FlatTree<CoverTree<MetricType, StatisticType, MatType,
+    RootPointPolicy>>::TreeType*
+FlatTree<CoverTree<MetricType, StatisticType, MatType, RootPointPolicy>>::
+    Build(MatType* dataset,
+          const FlatTreeNode* nodes,
+          const size_t numNodes,
+          const double* /* bounds */,
+          const size_t boundSize,
+          const std::string& extra,
+          cereal::BinaryInputArchive& statistics)
+{
+  typename TreeType::ElemType base = 0.0;
+  MetricType* metric = new MetricType();
+  try
+  {
+    if (boundSize != 0)
+    {
+      throw std::runtime_error("FlatTree::Build(): cover trees do not have "
+          "saved bounds.");
+    }
+
+    std::istringstream stream(extra);
+    cereal::BinaryInputArchive ar(stream);
+    ar(CEREAL_NVP(base));
+    ar(cereal::make_nvp("metric", *metric));
+  }
+  catch (...)
+  {
+    delete metric;
+    delete dataset;
+    throw;
+  }
+
+  // The root takes ownership of the dataset and the metric.
+  std::vector<TreeType*> built(numNodes, NULL);
+  built[0] = new TreeType();
+  built[0]->dataset = dataset;
+  built[0]->localDataset = true;
+  built[0]->metric = metric;
+  built[0]->localMetric = true;
+
+  // The nodes are allocated one by one, since each node of a cover tree deletes
+  // its own children.
+  try
+  {
+    for (size_t i = 0; i < numNodes; ++i)
+    {
+      TreeType* node = built[i];
+      const FlatTreeNode& flat = nodes[i];
+      bool valid = (node != NULL) && (flat.begin < dataset->n_cols);
+      if (valid && flat.numChildren > 0)
+      {
+        valid = (flat.firstChild > i) && (flat.firstChild < numNodes) &&
+            (flat.numChildren <= numNodes - flat.firstChild);
+        for (size_t c = 0; valid && c < flat.numChildren; ++c)
+          valid = (built[flat.firstChild + c] == NULL);
+      }
+
+      if (!valid)
+      {
+        throw std::runtime_error("FlatTree::Build(): the saved nodes do not "
+            "form a valid tree.");
+      }
+
+      node->point = flat.begin;
+      node->numDescendants = flat.count;
+      node->scale = (int) flat.scale;
+      node->base = base;
+      node->parentDistance = flat.parentDistance;
+      node->furthestDescendantDistance = flat.furthestDescendantDistance;
+      node->dataset = dataset;
+      node->metric = metric;
+      statistics(cereal::make_nvp("stat", node->stat));
+
+      node->children.resize(flat.numChildren);
+      for (size_t c = 0; c < flat.numChildren; ++c)
+      {
+        node->children[c] = new TreeType();
+        node->children[c]->parent = node;
+        built[flat.firstChild + c] = node->children[c];
+      }
+    }
+  }
+  catch (...)
+  {
+    delete built[0];
+    throw;
+  }
+
+  return built[0];
+}
+
+template<typename TreeType>
+void SaveFlat(const std::string& filename,
+              const TreeType& tree,
+              const std::vector<size_t>& oldFromNew)
+{
+  typedef FlatTree<TreeType> Flat;
+  typedef typename Flat::Mat::elem_type ElemType;
+
+  std::vector<FlatTreeNode> nodes;
+  std::vector<double> bounds;
+  std::string extra;
+  std::ostringstream statStream;
+  {
+    cereal::BinaryOutputArchive statistics(statStream);
+    Flat::Flatten(tree, nodes, bounds, extra, statistics);
+  }
+  const std::string stats = statStream.str();
+
+  const typename Flat::Mat& dataset = tree.Dataset();
+  const std::vector<uint64_t> mappings(oldFromNew.begin(), oldFromNew.end());
+
+  char header[flatTreeHeaderSize];
+  const uint32_t kind = Flat::Kind;
+  const uint32_t elemSize = sizeof(ElemType);
+  const uint32_t boundSize = Flat::BoundSize(tree);
+  const uint64_t rows = dataset.n_rows;
+  const uint64_t cols = dataset.n_cols;
+  const uint64_t numNodes = nodes.size();
+  const uint64_t numMappings = mappings.size();
+  const uint64_t extraSize = extra.size();
+  const uint64_t statsSize = stats.size();
+
+  std::memset(header, 0, flatTreeHeaderSize);
+  std::memcpy(header, flatTreeMagic, 8);
+  std::memcpy(header + 8, &flatTreeVersion, sizeof(uint32_t));
+  std::memcpy(header + 12, &kind, sizeof(uint32_t));
+  std::memcpy(header + 16, &elemSize, sizeof(uint32_t));
+  std::memcpy(header + 20, &boundSize, sizeof(uint32_t));
+  std::memcpy(header + 24, &rows, sizeof(uint64_t));
+  std::memcpy(header + 32, &cols, sizeof(uint64_t));
+  std::memcpy(header + 40, &numNodes, sizeof(uint64_t));
+  std::memcpy(header + 48, &numMappings, sizeof(uint64_t));
+  std::memcpy(header + 56, &extraSize, sizeof(uint64_t));
+  std::memcpy(header + 64, &statsSize, sizeof(uint64_t));
+
+  std::ofstream stream(filename, std::ios::binary | std::ios::trunc);
+  if (!stream.is_open())
+  {
+    throw std::runtime_error("SaveFlat(): cannot open '" + filename + "' for "
+        "writing.");
+  }
+
+  const char padding[8] = { 0 };
+  const size_t dataBytes = dataset.n_elem * sizeof(ElemType);
+  stream.write(header, flatTreeHeaderSize);
+  stream.write((const char*) dataset.memptr(), dataBytes);
+  stream.write(padding, FlatTreePadding(dataBytes));
+  stream.write((const char*) mappings.data(),
+      mappings.size() * sizeof(uint64_t));
+  stream.write((const char*) nodes.data(), nodes.size() * sizeof(FlatTreeNode));
+  stream.write((const char*) bounds.data(), bounds.size() * sizeof(double));
+  stream.write(extra.data(), extra.size());
+  stream.write(padding, FlatTreePadding(extra.size()));
+  stream.write(stats.data(), stats.size());
+
+  if (!stream.good())
+  {
+    throw std::runtime_error("SaveFlat(): error while writing '" + filename +
+        "'.");
+  }
+}
+
+/**
+ * Load a tree from the given mapped flat tree file.  If alias is true, the
+ * dataset of the tree is an alias of the mapped memory, so the mapping must
+ * outlive the tree; otherwise the dataset is copied.
+ */
+template<typename TreeType>
+TreeType* LoadFlatMapped(const data::MappedFile& file,
+                         std::vector<size_t>& oldFromNew,
+                         const bool alias)
+{
+  typedef FlatTree<TreeType> Flat;
+  typedef typename Flat::Mat MatType;
+  typedef typename MatType::elem_type ElemType;
+
+  const std::string& filename = file.Filename();
+  const char* header = file.Data();
+  uint32_t version, kind, elemSize, boundSize;
+  uint64_t rows, cols, numNodes, numMappings, extraSize, statsSize;
+
+  if (file.Size() < flatTreeHeaderSize ||
+      std::memcmp(header, flatTreeMagic, 8) != 0)
+  {
+    throw std::runtime_error("LoadFlat(): '" + filename + "' is not a flat "
+        "tree file.");
+  }
+
+  std::memcpy(&version, header + 8, sizeof(uint32_t));
+  std::memcpy(&kind, header + 12, sizeof(uint32_t));
+  std::memcpy(&elemSize, header + 16, sizeof(uint32_t));
+  std::memcpy(&boundSize, header + 20, sizeof(uint32_t));
+  std::memcpy(&rows, header + 24, sizeof(uint64_t));
+  std::memcpy(&cols, header + 32, sizeof(uint64_t));
+  std::memcpy(&numNodes, header + 40, sizeof(uint64_t));
+  std::memcpy(&numMappings, header + 48, sizeof(uint64_t));
+  std::memcpy(&extraSize, header + 56, sizeof(uint64_t));
+  std::memcpy(&statsSize, header + 64, sizeof(uint64_t));
+
+  if (version != flatTreeVersion)
+  {
+    throw std::runtime_error("LoadFlat(): '" + filename + "' has unknown "
+        "format version " + std::to_string(version) + ".");
+  }
+
+  if (kind != Flat::Kind || elemSize != sizeof(ElemType))
+  {
+    throw std::runtime_error("LoadFlat(): the tree saved in '" + filename +
+        "' does not match the requested tree type.");
+  }
+
+  // Find each section, making sure that it is inside the file.
+  size_t offset = flatTreeHeaderSize;
+  const size_t dataOffset = offset;
+  bool valid = (cols == 0 || rows <= std::numeric_limits<uint64_t>::max() /
+      cols) && FlatTreeSection(offset, rows * cols, sizeof(ElemType),
+      file.Size());
+  const size_t mappingsOffset = offset;
+  valid = valid && FlatTreeSection(offset, numMappings, sizeof(uint64_t),
+      file.Size());
+  const size_t nodesOffset = offset;
+  valid = valid && FlatTreeSection(offset, numNodes, sizeof(FlatTreeNode),
+      file.Size());
+  const size_t boundsOffset = offset;
+  valid = valid && (numNodes == 0 || boundSize <=
+      std::numeric_limits<uint64_t>::max() / numNodes) &&
+      FlatTreeSection(offset, numNodes * boundSize, sizeof(double),
+      file.Size());
+  const size_t extraOffset = offset;
+  valid = valid && FlatTreeSection(offset, extraSize, 1, file.Size());
+  const size_t statsOffset = offset;
+  valid = valid && FlatTreeSection(offset, statsSize, 1, file.Size());
+  if (!valid || numNodes == 0)
+  {
+    throw std::runtime_error("LoadFlat(): '" + filename + "' is truncated or "
+        "corrupted.");
+  }
+
+  oldFromNew.resize(numMappings);
+  for (size_t i = 0; i < numMappings; ++i)
+  {
+    uint64_t mapping;
+    std::memcpy(&mapping, file.Data() + mappingsOffset + i * sizeof(uint64_t),
+        sizeof(uint64_t));
+    oldFromNew[i] = (size_t) mapping;
+  }
+
+  // The nodes and bounds are used in place; the dataset is too, unless it must
+  // be copied.
+  MatType* dataset;
+  if (alias)
+  {
+    dataset = new MatType((ElemType*) (file.Data() + dataOffset), rows, cols,
+        false, true);
+  }
+  else
+  {
+    dataset = new MatType(rows, cols);
+    if (dataset->n_elem > 0)
+    {
+      std::memcpy(dataset->memptr(), file.Data() + dataOffset,
+          dataset->n_elem * sizeof(ElemType));
+    }
+  }
+
+  const std::string extra(file.Data() + extraOffset, extraSize);
+  FlatTreeBuffer statsBuffer(file.Data() + statsOffset, statsSize);
+  std::istream statStream(&statsBuffer);
+  cereal::BinaryInputArchive statistics(statStream);
+  return Flat::Build(dataset,
+      (const FlatTreeNode*) (file.Data() + nodesOffset), numNodes,
+      (const double*) (file.Data() + boundsOffset), boundSize, extra,
+      statistics);
+}
+
+template<typename TreeType>
+TreeType* LoadFlat(const std::string& filename,
+                   std::vector<size_t>& oldFromNew,
+                   data::MappedFile& mapping)
+{
+  // Trees do not modify their dataset after they are built, but if anything
+  // does, it gets a private copy of the page instead of changing the file.
+  mapping = data::MappedFile(filename, data::COPY_ON_WRITE);
+  return LoadFlatMapped<TreeType>(mapping, oldFromNew, true);
+}
+
+template<typename TreeType>
+TreeType* LoadFlat(const std::string& filename,
+                   std::vector<size_t>& oldFromNew)
+{
+  data::MappedFile file(filename, data::READ_ONLY);
+  return LoadFlatMapped<TreeType>(file, oldFromNew, false);
+}
+
+template<typename TreeType>
+TreeType* LoadFlat(const std::string& filename)
+{
+  std::vector<size_t> oldFromNew;
+  return LoadFlat<TreeType>(filename, oldFromNew);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
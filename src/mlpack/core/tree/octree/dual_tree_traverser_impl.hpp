@@ -69,10 +69,7 @@ void Octree<MetricType, StatisticType, MatType>::DualTreeTraverser<RuleType>::
         continue;
       }
 
-      const size_t rBegin = referenceNode.Point(0);
-      const size_t rEnd = rBegin + referenceNode.NumPoints();
-      for (size_t r = rBegin; r < rEnd; ++r)
-        rule.BaseCase(q, r);
+      LeafBaseCases(rule, q, referenceNode.Point(0), referenceNode.NumPoints());
 
       numBaseCases += referenceNode.NumPoints();
     }
@@ -14,6 +14,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include "../hrectbound.hpp"
+#include "../rule_traits.hpp"
 #include "../statistic.hpp"
 
 namespace mlpack {
@@ -72,8 +73,12 @@ class Octree
    *
    * @param data Dataset to create tree from.  This will be copied!
    * @param maxLeafSize Maximum number of points in a leaf node.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *      parallel, if OpenMP is available.
    */
-  Octree(const MatType& data, const size_t maxLeafSize = 20);
+  Octree(const MatType& data,
+         const size_t maxLeafSize = 20,
+         const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of an octree on the given dataset.  This
@@ -86,10 +91,13 @@ class Octree
    * @param oldFromNew Vector which will be filled with the old positions for
    *      each new point.
    * @param maxLeafSize Maximum number of points in a leaf node.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *      parallel, if OpenMP is available.
    */
   Octree(const MatType& data,
          std::vector<size_t>& oldFromNew,
-         const size_t maxLeafSize = 20);
+         const size_t maxLeafSize = 20,
+         const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of an octree on the given dataset.  This
@@ -105,11 +113,14 @@ class Octree
    * @param newFromOld Vector which will be filled with the new positions for
    *      each old point.
    * @param maxLeafSize Maximum number of points in a leaf node.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *      parallel, if OpenMP is available.
    */
   Octree(const MatType& data,
          std::vector<size_t>& oldFromNew,
          std::vector<size_t>& newFromOld,
-         const size_t maxLeafSize = 20);
+         const size_t maxLeafSize = 20,
+         const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of an octree on the given dataset.  This
@@ -118,8 +129,12 @@ class Octree
    *
    * @param data Dataset to create tree from.  This will be copied!
    * @param maxLeafSize Maximum number of points in a leaf node.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *      parallel, if OpenMP is available.
    */
-  Octree(MatType&& data, const size_t maxLeafSize = 20);
+  Octree(MatType&& data,
+         const size_t maxLeafSize = 20,
+         const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of an octree on the given dataset. This
@@ -132,10 +147,13 @@ class Octree
    * @param oldFromNew Vector which will be filled with the old positions for
    *      each new point.
    * @param maxLeafSize Maximum number of points in a leaf node.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *      parallel, if OpenMP is available.
    */
   Octree(MatType&& data,
          std::vector<size_t>& oldFromNew,
-         const size_t maxLeafSize = 20);
+         const size_t maxLeafSize = 20,
+         const size_t parallelCutoff = 10000);
 
   /**
    * Construct this as the root node of an octree on the given dataset.  This
@@ -151,11 +169,14 @@ class Octree
    * @param newFromOld Vector which will be filled with the new positions for
    *      each old point.
    * @param maxLeafSize Maximum number of points in a leaf node.
+   * @param parallelCutoff Nodes holding more points than this are split in
+   *      parallel, if OpenMP is available.
    */
   Octree(MatType&& data,
          std::vector<size_t>& oldFromNew,
          std::vector<size_t>& newFromOld,
-         const size_t maxLeafSize = 20);
+         const size_t maxLeafSize = 20,
+         const size_t parallelCutoff = 10000);
 
   /**
    * Construct this node as a child of the given parent, starting at column
@@ -439,6 +460,50 @@ class Octree
                  std::vector<size_t>& oldFromNew,
                  const size_t maxLeafSize);
 
+  /**
+   * Build the tree rooted at this node, using the given center and the given
+   * maximum width of this node.  If the node holds more than parallelCutoff
+   * points, nodes are split one level at a time, with all nodes of a level
+   * split in parallel; any subtree holding at most parallelCutoff points is
+   * built recursively by a single thread.
+   *
+   * @param center Center of the node.
+   * @param width Width of the current node.
+   * @param oldFromNew Mappings from old to new (may be NULL).
+   * @param maxLeafSize Maximum number of points allowed in a leaf.
+   * @param parallelCutoff Maximum number of points in a node built serially.
+   */
+  void BuildTree(const arma::vec& center,
+                 const double width,
+                 std::vector<size_t>* oldFromNew,
+                 const size_t maxLeafSize,
+                 const size_t parallelCutoff);
+
+  /**
+   * Partition the points of this node and create its children.  If
+   * childCenters is NULL, the children are split recursively.  Otherwise, the
+   * children are left unsplit, and their centers are stored in childCenters.
+   *
+   * @param center Center of the node.
+   * @param width Width of the current node.
+   * @param oldFromNew Mappings from old to new (may be NULL).
+   * @param maxLeafSize Maximum number of points allowed in a leaf.
+   * @param childCenters If not NULL, filled with the centers of the unsplit
+   *      children.
+   */
+  void SplitChildren(const arma::vec& center,
+                     const double width,
+                     std::vector<size_t>* oldFromNew,
+                     const size_t maxLeafSize,
+                     std::vector<arma::vec>* childCenters);
+
+  /**
+   * Construct this node as an unsplit child of the given parent, holding the
+   * points in the range [begin, begin + count).  The statistic is not
+   * initialized.  This is used by BuildTree().
+   */
+  Octree(Octree* parent, const size_t begin, const size_t count);
+
   /**
    * This is used for sorting points while splitting.
    */
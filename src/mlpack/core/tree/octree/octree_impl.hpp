@@ -22,7 +22,8 @@ namespace tree {
 //! Construct the tree.
 template<typename MetricType, typename StatisticType, typename MatType>
 Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
-                                                   const size_t maxLeafSize) :
+                                                   const size_t maxLeafSize,
+                                                   const size_t parallelCutoff) :
     begin(0),
     count(dataset.n_cols),
     bound(dataset.n_rows),
@@ -42,7 +43,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(const MatType& dataset,
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, maxLeafSize);
+    BuildTree(center, maxWidth, NULL, maxLeafSize, parallelCutoff);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -60,7 +61,8 @@ template<typename MetricType, typename StatisticType, typename MatType>
 Octree<MetricType, StatisticType, MatType>::Octree(
     const MatType& dataset,
     std::vector<size_t>& oldFromNew,
-    const size_t maxLeafSize) :
+    const size_t maxLeafSize,
+    const size_t parallelCutoff) :
     begin(0),
     count(dataset.n_cols),
     bound(dataset.n_rows),
@@ -84,7 +86,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    BuildTree(center, maxWidth, &oldFromNew, maxLeafSize, parallelCutoff);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -103,7 +105,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     const MatType& dataset,
     std::vector<size_t>& oldFromNew,
     std::vector<size_t>& newFromOld,
-    const size_t maxLeafSize) :
+    const size_t maxLeafSize,
+    const size_t parallelCutoff) :
     begin(0),
     count(dataset.n_cols),
     bound(dataset.n_rows),
@@ -127,7 +130,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    BuildTree(center, maxWidth, &oldFromNew, maxLeafSize, parallelCutoff);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -148,7 +151,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
 //! Construct the tree.
 template<typename MetricType, typename StatisticType, typename MatType>
 Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
-                                                   const size_t maxLeafSize) :
+                                                   const size_t maxLeafSize,
+                                                   const size_t parallelCutoff) :
     begin(0),
     count(dataset.n_cols),
     bound(dataset.n_rows),
@@ -168,7 +172,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(MatType&& dataset,
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, maxLeafSize);
+    BuildTree(center, maxWidth, NULL, maxLeafSize, parallelCutoff);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -186,7 +190,8 @@ template<typename MetricType, typename StatisticType, typename MatType>
 Octree<MetricType, StatisticType, MatType>::Octree(
     MatType&& dataset,
     std::vector<size_t>& oldFromNew,
-    const size_t maxLeafSize) :
+    const size_t maxLeafSize,
+    const size_t parallelCutoff) :
     begin(0),
     count(dataset.n_cols),
     bound(dataset.n_rows),
@@ -210,7 +215,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    BuildTree(center, maxWidth, &oldFromNew, maxLeafSize, parallelCutoff);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -229,7 +234,8 @@ Octree<MetricType, StatisticType, MatType>::Octree(
     MatType&& dataset,
     std::vector<size_t>& oldFromNew,
     std::vector<size_t>& newFromOld,
-    const size_t maxLeafSize) :
+    const size_t maxLeafSize,
+    const size_t parallelCutoff) :
     begin(0),
     count(dataset.n_cols),
     bound(dataset.n_rows),
@@ -253,7 +259,7 @@ Octree<MetricType, StatisticType, MatType>::Octree(
       if (bound[i].Hi() - bound[i].Lo() > maxWidth)
         maxWidth = bound[i].Hi() - bound[i].Lo();
 
-    SplitNode(center, maxWidth, oldFromNew, maxLeafSize);
+    BuildTree(center, maxWidth, &oldFromNew, maxLeafSize, parallelCutoff);
 
     furthestDescendantDistance = 0.5 * bound.Diameter();
   }
@@ -340,6 +346,31 @@ Octree<MetricType, StatisticType, MatType>::Octree(
   stat = StatisticType(*this);
 }
 
+//! Construct an unsplit child node.
+template<typename MetricType, typename StatisticType, typename MatType>
+Octree<MetricType, StatisticType, MatType>::Octree(
+    Octree* parent,
+    const size_t begin,
+    const size_t count) :
+    begin(begin),
+    count(count),
+    bound(parent->dataset->n_rows),
+    dataset(parent->dataset),
+    parent(parent)
+{
+  // Calculate empirical center of data.
+  bound |= dataset->cols(begin, begin + count - 1);
+
+  // Calculate the distance from the empirical center of this node to the
+  // empirical center of the parent.
+  arma::vec trueCenter, parentCenter;
+  bound.Center(trueCenter);
+  parent->Bound().Center(parentCenter);
+  parentDistance = metric.Evaluate(trueCenter, parentCenter);
+
+  furthestDescendantDistance = 0.5 * bound.Diameter();
+}
+
 //! Copy the given tree.
 template<typename MetricType, typename StatisticType, typename MatType>
 Octree<MetricType, StatisticType, MatType>::Octree(const Octree& other) :
@@ -777,107 +808,104 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
     const double width,
     const size_t maxLeafSize)
 {
-  // No need to split if we have fewer than the maximum number of points in this
-  // node.
-  if (count <= maxLeafSize)
-    return;
-
-  // This will hold the index of the first point in each child.
-  arma::Col<size_t> childBegins(((size_t) 1 << dataset->n_rows) + 1);
-  childBegins[0] = begin;
-  childBegins[childBegins.n_elem - 1] = begin + count;
+  SplitChildren(center, width, NULL, maxLeafSize, NULL);
+}
 
-  // We will make log2(dim) passes, splitting along the last down to the first
-  // dimension.  The tuple holds { dim, begin, count, leftChildIndex }.
-  std::stack<std::tuple<size_t, size_t, size_t, size_t>> stack;
-  stack.push(std::tuple<size_t, size_t, size_t, size_t>(dataset->n_rows - 1,
-      begin, count, 0));
+//! Split the node, and store mappings.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::SplitNode(
+    const arma::vec& center,
+    const double width,
+    std::vector<size_t>& oldFromNew,
+    const size_t maxLeafSize)
+{
+  SplitChildren(center, width, &oldFromNew, maxLeafSize, NULL);
+}
 
-  while (!stack.empty())
+//! Build the tree, splitting large nodes in parallel.
+template<typename MetricType, typename StatisticType, typename MatType>
+void Octree<MetricType, StatisticType, MatType>::BuildTree(
+    const arma::vec& center,
+    const double width,
+    std::vector<size_t>* oldFromNew,
+    const size_t maxLeafSize,
+    const size_t parallelCutoff)
+{
+  // If there are not enough points to make it worthwhile, build the tree
+  // serially.
+  if (count <= parallelCutoff)
   {
-    std::tuple<size_t, size_t, size_t, size_t> t = stack.top();
-    stack.pop();
-
-    const size_t d = std::get<0>(t);
-    const size_t childBegin = std::get<1>(t);
-    const size_t childCount = std::get<2>(t);
-    const size_t leftChildIndex = std::get<3>(t);
-
-    // Perform a "half-split": after this split, all points belonging to
-    // children of index 2^(d - 1) - 1 and less will be on the left side, and
-    // all points belonging to children of index 2^(d - 1) and above will be on
-    // the right side.
-    typename SplitType::SplitInfo s(d, center);
-    const size_t firstRight = split::PerformSplit<MatType, SplitType>(*dataset,
-        childBegin, childCount, s);
+    SplitChildren(center, width, oldFromNew, maxLeafSize, NULL);
+    return;
+  }
 
-    // We can set the first index of the right child.  The first index of the
-    // left child is already set.
-    const size_t rightChildIndex = leftChildIndex + ((size_t) 1 << d);
-    childBegins[rightChildIndex] = firstRight;
+  // Split the large nodes one level at a time.  Every node of a level holds a
+  // disjoint range of the dataset (and of oldFromNew), so the nodes can be
+  // split in any order and the result is the same as a serial build.  Nodes
+  // that are small enough are built entirely by one thread.  All nodes of a
+  // level have the same width.
+  std::vector<Octree*> upperNodes;
+  std::vector<Octree*> level(1, this);
+  std::vector<arma::vec> levelCenters(1, center);
+  double levelWidth = width;
+  while (!level.empty())
+  {
+    std::vector<std::vector<arma::vec>> childCenters(level.size());
 
-    // Now we have to recurse, if this was not the last dimension.
-    if (d != 0)
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t i = 0; i < (omp_size_t) level.size(); ++i)
     {
-      if (firstRight > childBegin)
+      Octree* node = level[i];
+      if (node->count > parallelCutoff)
       {
-        stack.push(std::tuple<size_t, size_t, size_t, size_t>(d - 1, childBegin,
-            firstRight - childBegin, leftChildIndex));
+        node->SplitChildren(levelCenters[i], levelWidth, oldFromNew,
+            maxLeafSize, &childCenters[i]);
       }
       else
       {
-        // Set beginning indices correctly for all children below this level.
-        for (size_t c = leftChildIndex + 1; c < rightChildIndex; ++c)
-          childBegins[c] = childBegins[leftChildIndex];
+        node->SplitChildren(levelCenters[i], levelWidth, oldFromNew,
+            maxLeafSize, NULL);
+        node->stat = StatisticType(*node);
       }
+    }
 
-      if (firstRight < childBegin + childCount)
-      {
-        stack.push(std::tuple<size_t, size_t, size_t, size_t>(d - 1, firstRight,
-            childCount - (firstRight - childBegin), rightChildIndex));
-      }
-      else
+    std::vector<Octree*> nextLevel;
+    std::vector<arma::vec> nextCenters;
+    for (size_t i = 0; i < level.size(); ++i)
+    {
+      if (level[i]->count <= parallelCutoff)
+        continue;
+
+      upperNodes.push_back(level[i]);
+      for (size_t c = 0; c < level[i]->children.size(); ++c)
       {
-        // Set beginning indices correctly for all children below this level.
-        for (size_t c = rightChildIndex + 1;
-             c < rightChildIndex + (rightChildIndex - leftChildIndex); ++c)
-          childBegins[c] = childBegins[rightChildIndex];
+        nextLevel.push_back(level[i]->children[c]);
+        nextCenters.push_back(std::move(childCenters[i][c]));
       }
     }
+    level.swap(nextLevel);
+    levelCenters.swap(nextCenters);
+    levelWidth /= 2.0;
   }
 
-  // Now that the dataset is reordered, we can create the children.
-  arma::vec childCenter(center.n_elem);
-  const double childWidth = width / 2.0;
-  for (size_t i = 0; i < childBegins.n_elem - 1; ++i)
+  // The statistics of the large nodes depend on their children, so they are
+  // initialized bottom-up.  The statistic of this node is initialized by the
+  // constructor.
+  for (size_t i = upperNodes.size(); i > 0; --i)
   {
-    // If the child has no points, don't create it.
-    if (childBegins[i + 1] - childBegins[i] == 0)
-      continue;
-
-    // Create the correct center.
-    for (size_t d = 0; d < center.n_elem; ++d)
-    {
-      // Is the dimension "right" (1) or "left" (0)?
-      if (((i >> d) & 1) == 0)
-        childCenter[d] = center[d] - childWidth;
-      else
-        childCenter[d] = center[d] + childWidth;
-    }
-
-    children.push_back(new Octree(this, childBegins[i],
-        childBegins[i + 1] - childBegins[i], childCenter, childWidth,
-        maxLeafSize));
+    if (upperNodes[i - 1] != this)
+      upperNodes[i - 1]->stat = StatisticType(*upperNodes[i - 1]);
   }
 }
 
-//! Split the node, and store mappings.
+//! Partition the node and create its children.
 template<typename MetricType, typename StatisticType, typename MatType>
-void Octree<MetricType, StatisticType, MatType>::SplitNode(
+void Octree<MetricType, StatisticType, MatType>::SplitChildren(
     const arma::vec& center,
     const double width,
-    std::vector<size_t>& oldFromNew,
-    const size_t maxLeafSize)
+    std::vector<size_t>* oldFromNew,
+    const size_t maxLeafSize,
+    std::vector<arma::vec>* childCenters)
 {
   // No need to split if we have fewer than the maximum number of points in this
   // node.
@@ -910,8 +938,11 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
     // all points belonging to children of index 2^(d - 1) and above will be on
     // the right side.
     typename SplitType::SplitInfo s(d, center);
-    const size_t firstRight = split::PerformSplit<MatType, SplitType>(*dataset,
-        childBegin, childCount, s, oldFromNew);
+    const size_t firstRight = (oldFromNew == NULL) ?
+        split::PerformSplit<MatType, SplitType>(*dataset, childBegin,
+            childCount, s) :
+        split::PerformSplit<MatType, SplitType>(*dataset, childBegin,
+            childCount, s, *oldFromNew);
 
     // We can set the first index of the right child.  The first index of the
     // left child is already set.
@@ -967,9 +998,25 @@ void Octree<MetricType, StatisticType, MatType>::SplitNode(
         childCenter[d] = center[d] + childWidth;
     }
 
-    children.push_back(new Octree(this, childBegins[i],
-        childBegins[i + 1] - childBegins[i], oldFromNew, childCenter,
-        childWidth, maxLeafSize));
+    if (childCenters)
+    {
+      // The child will be split later.
+      children.push_back(new Octree(this, childBegins[i],
+          childBegins[i + 1] - childBegins[i]));
+      childCenters->push_back(childCenter);
+    }
+    else if (oldFromNew)
+    {
+      children.push_back(new Octree(this, childBegins[i],
+          childBegins[i + 1] - childBegins[i], *oldFromNew, childCenter,
+          childWidth, maxLeafSize));
+    }
+    else
+    {
+      children.push_back(new Octree(this, childBegins[i],
+          childBegins[i + 1] - childBegins[i], childCenter, childWidth,
+          maxLeafSize));
+    }
   }
 }
 
@@ -36,10 +36,8 @@ void Octree<MetricType, StatisticType, MatType>::SingleTreeTraverser<RuleType>::
   // If we are a leaf, run the base cases.
   if (referenceNode.NumChildren() == 0)
   {
-    const size_t refBegin = referenceNode.Point(0);
-    const size_t refEnd = refBegin + referenceNode.NumPoints();
-    for (size_t r = refBegin; r < refEnd; ++r)
-      rule.BaseCase(queryIndex, r);
+    LeafBaseCases(rule, queryIndex, referenceNode.Point(0),
+        referenceNode.NumPoints());
   }
   else
   {
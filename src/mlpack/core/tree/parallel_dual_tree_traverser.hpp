@@ -0,0 +1,100 @@
+/**
+ * @file core/tree/parallel_dual_tree_traverser.hpp
+ *
+ * A dual-tree traverser that splits the query tree into independent subtrees
+ * and traverses each of them against the reference tree in parallel, using the
+ * tree's own dual-tree traverser for each subtree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+#define MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <stack>
+
+#ifdef HAS_OPENMP
+  #include <omp.h>
+#endif
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The ParallelDualTreeTraverser performs a dual-tree traversal using all
+ * available OpenMP threads.  The query tree is first cut into a set of disjoint
+ * subtrees (the "frontier"); each frontier node is then scored against the
+ * reference root and traversed with its own instance of the serial dual-tree
+ * traverser given as DualTreeTraversalType.  Because the query subtrees are
+ * disjoint, each query point is only ever touched by a single thread.
+ *
+ * Each thread gets its own rules object, which is constructed from a pointer to
+ * the rules object given to the constructor; that is, RuleType must provide an
+ * (explicit) constructor RuleType(RuleType* other) that creates rules sharing
+ * the results of 'other' (see NeighborSearchRules for an example).  After the
+ * traversal, the number of base cases and scores of each thread are added to
+ * the rules object given to the constructor.
+ *
+ * The query tree must not hold points in internal nodes that are not also held
+ * by one of the descendants of that node; this is true for every tree type in
+ * mlpack.  If OpenMP is not available, or only one thread is available, this
+ * is equivalent to the serial traversal.
+ *
+ * @tparam TreeType Type of tree to traverse.
+ * @tparam RuleType Type of rules to use.
+ * @tparam DualTreeTraversalType Serial dual-tree traverser used for each query
+ *     subtree (i.e. TreeType::DualTreeTraverser<RuleType>).
+ */
+template<typename TreeType, typename RuleType, typename DualTreeTraversalType>
+class ParallelDualTreeTraverser
+{
+ public:
+  /**
+   * Instantiate the parallel dual-tree traverser with the given rule set.
+   *
+   * @param rule Rules to use for the traversal.
+   * @param tasksPerThread Number of query subtrees to create per thread; more
+   *     subtrees give better load balancing but less pruning.
+   */
+  ParallelDualTreeTraverser(RuleType& rule, const size_t tasksPerThread = 4);
+
+  /**
+   * Traverse the two trees.  This does not reset the number of prunes.
+   *
+   * @param queryNode The query node to be traversed.
+   * @param referenceNode The reference node to be traversed.
+   */
+  void Traverse(TreeType& queryNode, TreeType& referenceNode);
+
+  //! Get the number of prunes.
+  size_t NumPrunes() const { return numPrunes; }
+  //! Modify the number of prunes.
+  size_t& NumPrunes() { return numPrunes; }
+
+  //! Get the number of query subtrees used in the last traversal.
+  size_t NumTasks() const { return numTasks; }
+
+ private:
+  //! Reference to the rules with which the trees will be traversed.
+  RuleType& rule;
+
+  //! The number of query subtrees to create per thread.
+  size_t tasksPerThread;
+
+  //! The number of prunes.
+  size_t numPrunes;
+
+  //! The number of query subtrees used in the last traversal.
+  size_t numTasks;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "parallel_dual_tree_traverser_impl.hpp"
+
+#endif
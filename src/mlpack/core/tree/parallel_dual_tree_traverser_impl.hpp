@@ -0,0 +1,113 @@
+/**
+ * @file core/tree/parallel_dual_tree_traverser_impl.hpp
+ *
+ * Implementation of the ParallelDualTreeTraverser.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+#define MLPACK_CORE_TREE_PARALLEL_DUAL_TREE_TRAVERSER_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "parallel_dual_tree_traverser.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename TreeType, typename RuleType, typename DualTreeTraversalType>
+ParallelDualTreeTraverser<TreeType, RuleType, DualTreeTraversalType>::
+ParallelDualTreeTraverser(RuleType& rule, const size_t tasksPerThread) :
+    rule(rule),
+    tasksPerThread(std::max(tasksPerThread, (size_t) 1)),
+    numPrunes(0),
+    numTasks(0)
+{ /* Nothing to do. */ }
+
+template<typename TreeType, typename RuleType, typename DualTreeTraversalType>
+void ParallelDualTreeTraverser<TreeType, RuleType, DualTreeTraversalType>::
+Traverse(TreeType& queryNode, TreeType& referenceNode)
+{
+  size_t numThreads = 1;
+  #ifdef HAS_OPENMP
+    numThreads = omp_get_max_threads();
+  #endif
+
+  // With a single thread there is nothing to gain by cutting the query tree, so
+  // just run the regular traversal.
+  if (numThreads == 1 || queryNode.IsLeaf())
+  {
+    numTasks = 1;
+    DualTreeTraversalType traverser(rule);
+    traverser.Traverse(queryNode, referenceNode);
+    numPrunes += traverser.NumPrunes();
+    return;
+  }
+
+  // Collect the frontier: descend into the query tree until each subtree is
+  // small enough that we have roughly tasksPerThread subtrees per thread.
+  const size_t cutoff = std::max(queryNode.NumDescendants() /
+      (tasksPerThread * numThreads), (size_t) 1);
+  std::vector<TreeType*> frontier;
+  std::stack<TreeType*> nodes;
+  nodes.push(&queryNode);
+  while (!nodes.empty())
+  {
+    TreeType* node = nodes.top();
+    nodes.pop();
+
+    if (node->IsLeaf() || node->NumDescendants() <= cutoff)
+    {
+      frontier.push_back(node);
+    }
+    else
+    {
+      for (size_t i = 0; i < node->NumChildren(); ++i)
+        nodes.push(&node->Child(i));
+    }
+  }
+
+  numTasks = frontier.size();
+
+  size_t baseCases = 0;
+  size_t scores = 0;
+  size_t prunes = 0;
+
+  // The subtrees are likely to be very unbalanced in cost, so hand them out
+  // dynamically.
+  #pragma omp parallel for schedule(dynamic) \
+      reduction(+:baseCases, scores, prunes)
+  for (omp_size_t i = 0; i < (omp_size_t) frontier.size(); ++i)
+  {
+    RuleType threadRule(&rule);
+    TreeType& subtree = *frontier[i];
+
+    // Scoring the subtree root against the reference root sets the traversal
+    // information as the serial traversal expects it; the combination may
+    // also be pruned entirely.
+    if (threadRule.Score(subtree, referenceNode) == DBL_MAX)
+    {
+      ++prunes;
+    }
+    else
+    {
+      DualTreeTraversalType traverser(threadRule);
+      traverser.Traverse(subtree, referenceNode);
+      prunes += traverser.NumPrunes();
+    }
+
+    baseCases += threadRule.BaseCases();
+    scores += threadRule.Scores();
+  }
+
+  rule.BaseCases() += baseCases;
+  rule.Scores() += scores;
+  numPrunes += prunes;
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,276 @@
+/**
+ * @file core/tree/reference_levels.hpp
+ *
+ * Definition of ReferenceLevels, which lets tree-based search classes support
+ * insertions into and removals from their reference set without rebuilding
+ * their reference tree every time.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_REFERENCE_LEVELS_HPP
+#define MLPACK_CORE_TREE_REFERENCE_LEVELS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree /** Trees and tree-building procedures. */ {
+
+/**
+ * ReferenceLevels keeps track of the changes made to the reference set of a
+ * search object (such as NeighborSearch or RangeSearch) whose tree cannot be
+ * updated in place.  It uses the logarithmic method: the reference set is made
+ * of the main set, on which the tree of the search object was built, plus a
+ * number of levels, which are smaller search objects on the points inserted
+ * since.  When a level is at least as large as the level before it, the two
+ * are merged into one, so there are only O(log n) levels, and each point takes
+ * part in O(log n) rebuilds.  Once the levels hold as many points as the main
+ * set, the owner should rebuild its tree on all of the points (see
+ * MainNeedsRebuild()).
+ *
+ * Removed points are not taken out of the trees; they are recorded, and for
+ * each set a mask of its removed points, in the order of its tree, is kept
+ * (see MainRemoved() and LevelRemoved()), so that the search rules can skip
+ * them and still find k live neighbors.  A level that loses half of its points
+ * is rebuilt, and the owner should rebuild its tree once a quarter of the main
+ * set is removed, since the removed points still cost traversal time.
+ *
+ * Every point has an id: the points of the main set have the ids [0, n), and
+ * inserted points get the next ids.  Ids are never reused, and the position of
+ * a point in the reference set (the index seen by the user) is its id minus
+ * the number of removed ids smaller than it; so inserted points are appended
+ * to the reference set, and removing points shifts the points after them, as
+ * with arma::Mat::shed_cols().
+ *
+ * The search object must have the members 'referenceSet' (a pointer to its
+ * reference set) and 'oldFromNewReferences' (the mapping of the points
+ * rearranged by its tree, or empty), and must make ReferenceLevels a friend.
+ *
+ * @tparam SearchType Type of the search object.
+ * @tparam MatType Type of the reference set.
+ */
+template<typename SearchType, typename MatType>
+class ReferenceLevels
+{
+ public:
+  /**
+   * Create the object for a main set with the given number of points.
+   *
+   * @param numMain Number of points in the main set.
+   */
+  ReferenceLevels(const size_t numMain = 0);
+
+  //! Copy the given object, including its levels.
+  ReferenceLevels(const ReferenceLevels& other);
+
+  //! Take ownership of the levels of the given object.
+  ReferenceLevels(ReferenceLevels&& other);
+
+  //! Copy the given object, including its levels.
+  ReferenceLevels& operator=(const ReferenceLevels& other);
+
+  //! Take ownership of the levels of the given object.
+  ReferenceLevels& operator=(ReferenceLevels&& other);
+
+  //! Delete the levels.
+  ~ReferenceLevels();
+
+  /**
+   * Forget all levels and removed points; the reference set is now a main set
+   * with the given number of points.  This must be called whenever the owner
+   * builds a new tree.
+   *
+   * @param numMain Number of points in the main set.
+   */
+  void Reset(const size_t numMain);
+
+  //! Return true if there are levels or removed points, so that the main set
+  //! alone does not give the right results.
+  bool Active() const { return !levels.empty() || !removedIds.empty(); }
+
+  //! Get the number of points in the reference set.
+  size_t NumPoints() const { return nextId - removedIds.size(); }
+
+  /**
+   * Add the given points at the end of the reference set.  A new level is
+   * built on them, and levels are merged as necessary.  A
+   * std::invalid_argument is thrown if the dimensionality of the points does
+   * not match the reference set.
+   *
+   * @param main The search object that owns this object.
+   * @param points Points to add.
+   * @param build Function that builds a new search object on the given
+   *     points, of the signature SearchType*(MatType&&).
+   */
+  template<typename BuildFunctionType>
+  void Insert(const SearchType& main,
+              MatType&& points,
+              BuildFunctionType build);
+
+  /**
+   * Remove the points at the given positions of the reference set.  Levels
+   * that lose half of their points are rebuilt.  A std::invalid_argument is
+   * thrown if a position is not in the reference set.
+   *
+   * @param main The search object that owns this object.
+   * @param positions Positions of the points to remove.
+   * @param build Function that builds a new search object on the given
+   *     points, of the signature SearchType*(MatType&&).
+   */
+  template<typename BuildFunctionType>
+  void Remove(const SearchType& main,
+              const std::vector<size_t>& positions,
+              BuildFunctionType build);
+
+  //! Return true if the owner should rebuild its tree on all of the points
+  //! (see Gather()).
+  bool MainNeedsRebuild() const;
+
+  /**
+   * Store all points of the reference set, in order, in the given matrix.
+   *
+   * @param main The search object that owns this object.
+   * @param points Matrix to store the points in.
+   */
+  void Gather(const SearchType& main, MatType& points) const;
+
+  //! Return true if the point with the given id has been removed.
+  bool IsRemoved(const size_t id) const
+  {
+    return std::binary_search(removedIds.begin(), removedIds.end(), id);
+  }
+
+  //! Get the position in the reference set of the point with the given id.
+  size_t Position(const size_t id) const
+  {
+    return id - (std::lower_bound(removedIds.begin(), removedIds.end(), id) -
+        removedIds.begin());
+  }
+
+  //! Get the number of points in the main set (including removed ones).
+  size_t NumMainPoints() const { return numMain; }
+  //! Get the number of removed points in the main set.
+  size_t NumMainRemoved() const { return numMainRemoved; }
+  //! Get, for each point of the main set in the order of the reference tree,
+  //! whether it has been removed; empty if none have been.
+  const std::vector<bool>& MainRemoved() const { return mainRemoved; }
+
+  //! Get the number of levels.
+  size_t NumLevels() const { return levels.size(); }
+  //! Modify the search object of the given level.
+  SearchType& Level(const size_t i) { return *levels[i].search; }
+  //! Get the ids of the points of the given level, in the order of the points
+  //! it was built on.
+  const std::vector<size_t>& LevelIds(const size_t i) const
+  {
+    return levels[i].ids;
+  }
+  //! Get the number of removed points in the given level.
+  size_t NumLevelRemoved(const size_t i) const { return levels[i].numRemoved; }
+  //! Get, for each point of the given level in the order of its tree, whether
+  //! it has been removed; empty if none have been.
+  const std::vector<bool>& LevelRemoved(const size_t i) const
+  {
+    return levels[i].removed;
+  }
+
+  /**
+   * Serialize the levels and the removed points.  The tree or reference set
+   * of the main set is serialized by the search object that owns this object.
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const uint32_t /* version */);
+
+ private:
+  //! A level: a search object and the ids of its points.
+  struct LevelInfo
+  {
+    //! The search object, which is owned by this object.
+    SearchType* search;
+    //! The ids of the points of the search object.
+    std::vector<size_t> ids;
+    //! The number of removed points among them.
+    size_t numRemoved;
+    //! Whether each point of the search object, in the order of its tree, has
+    //! been removed; empty if none have been.
+    std::vector<bool> removed;
+    //! The position in the tree of each point, if the tree rearranged them
+    //! and a point has been removed; empty otherwise.
+    std::vector<size_t> newFromOld;
+
+    //! Serialize the level.
+    template<typename Archive>
+    void serialize(Archive& ar, const uint32_t /* version */)
+    {
+      ar(CEREAL_POINTER(search));
+      ar(CEREAL_NVP(ids));
+      ar(CEREAL_NVP(numRemoved));
+      ar(CEREAL_NVP(removed));
+      ar(CEREAL_NVP(newFromOld));
+    }
+  };
+
+  //! The levels, from the oldest (and usually largest) to the newest.
+  std::vector<LevelInfo> levels;
+  //! The number of points in the main set.
+  size_t numMain;
+  //! The number of removed points in the main set.
+  size_t numMainRemoved;
+  //! Whether each point of the main set, in the order of the reference tree,
+  //! has been removed; empty if none have been.
+  std::vector<bool> mainRemoved;
+  //! The position in the reference tree of each point of the main set, if the
+  //! tree rearranged them and a point has been removed; empty otherwise.
+  std::vector<size_t> mainNewFromOld;
+  //! The sorted ids of all removed points.
+  std::vector<size_t> removedIds;
+  //! The id of the next point to be inserted.
+  size_t nextId;
+
+  //! Get the id of the point at the given position of the reference set.
+  size_t Id(const size_t position) const;
+
+  //! Get the dimensionality of the reference set.
+  size_t Dimensionality(const SearchType& main) const;
+
+  /**
+   * Mark the point of the given search object with the given index (in the
+   * order of the points it was built on) in the given mask, which is indexed
+   * in the order of its tree.  The mask and the mapping newFromOld are
+   * created on the first call.
+   */
+  static void MarkRemoved(const SearchType& search,
+                          const size_t index,
+                          std::vector<bool>& removed,
+                          std::vector<size_t>& newFromOld);
+
+  /**
+   * Store the points of the given search object that have not been removed
+   * in the given matrix, starting at the given column, and append their ids to
+   * liveIds (if it is not NULL).  If ids is NULL, the points have the ids
+   * [0, n) (this is the main set).
+   */
+  void GatherSet(const SearchType& search,
+                 const std::vector<size_t>* ids,
+                 MatType& points,
+                 size_t& column,
+                 std::vector<size_t>* liveIds) const;
+
+  //! Build a new level on the points of the given levels that have not been
+  //! removed; the given levels are replaced by it (or deleted, if all of their
+  //! points have been removed).
+  template<typename BuildFunctionType>
+  void Rebuild(const size_t first,
+               const size_t last,
+               BuildFunctionType build);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "reference_levels_impl.hpp"
+
+#endif
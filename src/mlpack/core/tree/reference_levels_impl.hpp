@@ -0,0 +1,386 @@
+/**
+ * @file core/tree/reference_levels_impl.hpp
+ *
+ * Implementation of ReferenceLevels.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_REFERENCE_LEVELS_IMPL_HPP
+#define MLPACK_CORE_TREE_REFERENCE_LEVELS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "reference_levels.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename SearchType, typename MatType>
+ReferenceLevels<SearchType, MatType>::ReferenceLevels(const size_t numMain) :
+    numMain(numMain),
+    numMainRemoved(0),
+    nextId(numMain)
+{
+  // Nothing to do.
+}
+
+template<typename SearchType, typename MatType>
+ReferenceLevels<SearchType, MatType>::ReferenceLevels(
+    const ReferenceLevels& other) :
+    levels(other.levels),
+    numMain(other.numMain),
+    numMainRemoved(other.numMainRemoved),
+    mainRemoved(other.mainRemoved),
+    mainNewFromOld(other.mainNewFromOld),
+    removedIds(other.removedIds),
+    nextId(other.nextId)
+{
+  // Each level needs its own copy of the search object.
+  for (size_t i = 0; i < levels.size(); ++i)
+    levels[i].search = new SearchType(*levels[i].search);
+}
+
+template<typename SearchType, typename MatType>
+ReferenceLevels<SearchType, MatType>::ReferenceLevels(
+    ReferenceLevels&& other) :
+    levels(std::move(other.levels)),
+    numMain(other.numMain),
+    numMainRemoved(other.numMainRemoved),
+    mainRemoved(std::move(other.mainRemoved)),
+    mainNewFromOld(std::move(other.mainNewFromOld)),
+    removedIds(std::move(other.removedIds)),
+    nextId(other.nextId)
+{
+  other.levels.clear();
+  other.Reset(0);
+}
+
+template<typename SearchType, typename MatType>
+ReferenceLevels<SearchType, MatType>&
+ReferenceLevels<SearchType, MatType>::operator=(const ReferenceLevels& other)
+{
+  if (this != &other)
+  {
+    ReferenceLevels copy(other);
+    *this = std::move(copy);
+  }
+
+  return *this;
+}
+
+template<typename SearchType, typename MatType>
+ReferenceLevels<SearchType, MatType>&
+ReferenceLevels<SearchType, MatType>::operator=(ReferenceLevels&& other)
+{
+  if (this != &other)
+  {
+    Reset(0);
+
+    levels = std::move(other.levels);
+    numMain = other.numMain;
+    numMainRemoved = other.numMainRemoved;
+    mainRemoved = std::move(other.mainRemoved);
+    mainNewFromOld = std::move(other.mainNewFromOld);
+    removedIds = std::move(other.removedIds);
+    nextId = other.nextId;
+
+    other.levels.clear();
+    other.Reset(0);
+  }
+
+  return *this;
+}
+
+template<typename SearchType, typename MatType>
+ReferenceLevels<SearchType, MatType>::~ReferenceLevels()
+{
+  for (size_t i = 0; i < levels.size(); ++i)
+    delete levels[i].search;
+}
+
+template<typename SearchType, typename MatType>
+void ReferenceLevels<SearchType, MatType>::Reset(const size_t numMain)
+{
+  for (size_t i = 0; i < levels.size(); ++i)
+    delete levels[i].search;
+  levels.clear();
+
+  this->numMain = numMain;
+  numMainRemoved = 0;
+  mainRemoved.clear();
+  mainNewFromOld.clear();
+  removedIds.clear();
+  nextId = numMain;
+}
+
+template<typename SearchType, typename MatType>
+template<typename BuildFunctionType>
+void ReferenceLevels<SearchType, MatType>::Insert(
+    const SearchType& main,
+    MatType&& points,
+    BuildFunctionType build)
+{
+  if (points.n_cols == 0)
+    return;
+
+  const size_t dimensionality = Dimensionality(main);
+  if (dimensionality != 0 && points.n_rows != dimensionality)
+  {
+    std::ostringstream oss;
+    oss << "ReferenceLevels::Insert(): dimensionality of points ("
+        << points.n_rows << ") does not match dimensionality of reference set ("
+        << dimensionality << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  LevelInfo level;
+  level.ids.resize(points.n_cols);
+  for (size_t i = 0; i < level.ids.size(); ++i)
+    level.ids[i] = nextId + i;
+  level.numRemoved = 0;
+  level.search = build(std::move(points));
+
+  nextId += level.ids.size();
+  levels.push_back(std::move(level));
+
+  // Merge the newest levels for as long as the newest is at least as large as
+  // the one before it, like carries in a binary counter.
+  while (levels.size() >= 2)
+  {
+    const LevelInfo& newest = levels[levels.size() - 1];
+    const LevelInfo& previous = levels[levels.size() - 2];
+    if (newest.ids.size() - newest.numRemoved <
+        previous.ids.size() - previous.numRemoved)
+      break;
+
+    Rebuild(levels.size() - 2, levels.size(), build);
+  }
+}
+
+template<typename SearchType, typename MatType>
+template<typename BuildFunctionType>
+void ReferenceLevels<SearchType, MatType>::Remove(
+    const SearchType& main,
+    const std::vector<size_t>& positions,
+    BuildFunctionType build)
+{
+  std::vector<size_t> sortedPositions(positions);
+  std::sort(sortedPositions.begin(), sortedPositions.end());
+  sortedPositions.erase(std::unique(sortedPositions.begin(),
+      sortedPositions.end()), sortedPositions.end());
+
+  if (!sortedPositions.empty() && sortedPositions.back() >= NumPoints())
+  {
+    std::ostringstream oss;
+    oss << "ReferenceLevels::Remove(): cannot remove point "
+        << sortedPositions.back() << "; the reference set has only "
+        << NumPoints() << " points!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  // Find the ids of the points before marking any of them as removed.  They
+  // are sorted, since positions and ids are in the same order.
+  std::vector<size_t> ids(sortedPositions.size());
+  for (size_t i = 0; i < ids.size(); ++i)
+    ids[i] = Id(sortedPositions[i]);
+
+  // Count and mark the removed points of each set; the ids of the levels are
+  // sorted and come after the ids of the main set.
+  size_t level = 0;
+  for (size_t i = 0; i < ids.size(); ++i)
+  {
+    if (ids[i] < numMain)
+    {
+      ++numMainRemoved;
+      MarkRemoved(main, ids[i], mainRemoved, mainNewFromOld);
+      continue;
+    }
+
+    while (level + 1 < levels.size() && levels[level + 1].ids[0] <= ids[i])
+      ++level;
+
+    LevelInfo& info = levels[level];
+    ++info.numRemoved;
+    const size_t index = std::lower_bound(info.ids.begin(), info.ids.end(),
+        ids[i]) - info.ids.begin();
+    MarkRemoved(*info.search, index, info.removed, info.newFromOld);
+  }
+
+  std::vector<size_t> newRemovedIds;
+  newRemovedIds.reserve(removedIds.size() + ids.size());
+  std::merge(removedIds.begin(), removedIds.end(), ids.begin(), ids.end(),
+      std::back_inserter(newRemovedIds));
+  removedIds.swap(newRemovedIds);
+
+  // Rebuild the levels that have lost half of their points.
+  for (size_t i = levels.size(); i > 0; --i)
+  {
+    if (2 * levels[i - 1].numRemoved >= levels[i - 1].ids.size())
+      Rebuild(i - 1, i, build);
+  }
+}
+
+template<typename SearchType, typename MatType>
+bool ReferenceLevels<SearchType, MatType>::MainNeedsRebuild() const
+{
+  if (4 * numMainRemoved > numMain)
+    return true;
+
+  size_t levelPoints = 0;
+  for (size_t i = 0; i < levels.size(); ++i)
+    levelPoints += levels[i].ids.size() - levels[i].numRemoved;
+
+  return (levelPoints > 0 && levelPoints >= numMain - numMainRemoved);
+}
+
+template<typename SearchType, typename MatType>
+void ReferenceLevels<SearchType, MatType>::Gather(const SearchType& main,
+                                                  MatType& points) const
+{
+  points.set_size(Dimensionality(main), NumPoints());
+
+  size_t column = 0;
+  GatherSet(main, NULL, points, column, NULL);
+  for (size_t i = 0; i < levels.size(); ++i)
+    GatherSet(*levels[i].search, &levels[i].ids, points, column, NULL);
+}
+
+template<typename SearchType, typename MatType>
+size_t ReferenceLevels<SearchType, MatType>::Id(const size_t position) const
+{
+  // The id is the smallest solution of id = position + (number of removed ids
+  // that are not larger than id); iterating from below converges to it.
+  size_t id = position;
+  while (true)
+  {
+    const size_t newId = position + (std::upper_bound(removedIds.begin(),
+        removedIds.end(), id) - removedIds.begin());
+    if (newId == id)
+      return id;
+
+    id = newId;
+  }
+}
+
+template<typename SearchType, typename MatType>
+size_t ReferenceLevels<SearchType, MatType>::Dimensionality(
+    const SearchType& main) const
+{
+  if (numMain > 0)
+    return main.referenceSet->n_rows;
+  else if (!levels.empty())
+    return levels[0].search->referenceSet->n_rows;
+  else
+    return 0;
+}
+
+template<typename SearchType, typename MatType>
+void ReferenceLevels<SearchType, MatType>::MarkRemoved(
+    const SearchType& search,
+    const size_t index,
+    std::vector<bool>& removed,
+    std::vector<size_t>& newFromOld)
+{
+  const std::vector<size_t>& oldFromNew = search.oldFromNewReferences;
+  if (removed.empty())
+  {
+    removed.resize(search.referenceSet->n_cols, false);
+
+    newFromOld.resize(oldFromNew.size());
+    for (size_t i = 0; i < oldFromNew.size(); ++i)
+      newFromOld[oldFromNew[i]] = i;
+  }
+
+  removed[newFromOld.empty() ? index : newFromOld[index]] = true;
+}
+
+template<typename SearchType, typename MatType>
+void ReferenceLevels<SearchType, MatType>::GatherSet(
+    const SearchType& search,
+    const std::vector<size_t>* ids,
+    MatType& points,
+    size_t& column,
+    std::vector<size_t>* liveIds) const
+{
+  const MatType& set = *search.referenceSet;
+
+  // If the tree of the search object rearranged its points, we must find
+  // where each point went.
+  const std::vector<size_t>& oldFromNew = search.oldFromNewReferences;
+  std::vector<size_t> newFromOld(oldFromNew.size());
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    newFromOld[oldFromNew[i]] = i;
+
+  for (size_t i = 0; i < set.n_cols; ++i)
+  {
+    const size_t id = (ids == NULL) ? i : (*ids)[i];
+    if (IsRemoved(id))
+      continue;
+
+    points.col(column++) = set.col(newFromOld.empty() ? i : newFromOld[i]);
+    if (liveIds != NULL)
+      liveIds->push_back(id);
+  }
+}
+
+template<typename SearchType, typename MatType>
+template<typename BuildFunctionType>
+void ReferenceLevels<SearchType, MatType>::Rebuild(
+    const size_t first,
+    const size_t last,
+    BuildFunctionType build)
+{
+  size_t numLive = 0;
+  for (size_t i = first; i < last; ++i)
+    numLive += levels[i].ids.size() - levels[i].numRemoved;
+
+  LevelInfo level;
+  level.search = NULL;
+  level.numRemoved = 0;
+  if (numLive > 0)
+  {
+    MatType points(levels[first].search->referenceSet->n_rows, numLive);
+    level.ids.reserve(numLive);
+    size_t column = 0;
+    for (size_t i = first; i < last; ++i)
+    {
+      GatherSet(*levels[i].search, &levels[i].ids, points, column,
+          &level.ids);
+    }
+
+    level.search = build(std::move(points));
+  }
+
+  // Only remove the old levels once the new one has been built.
+  for (size_t i = first; i < last; ++i)
+    delete levels[i].search;
+  levels.erase(levels.begin() + first, levels.begin() + last);
+
+  if (level.search != NULL)
+    levels.insert(levels.begin() + first, std::move(level));
+}
+
+template<typename SearchType, typename MatType>
+template<typename Archive>
+void ReferenceLevels<SearchType, MatType>::serialize(
+    Archive& ar, const uint32_t /* version */)
+{
+  // Delete the current levels, if we are loading.
+  if (cereal::is_loading<Archive>())
+    Reset(0);
+
+  ar(CEREAL_NVP(levels));
+  ar(CEREAL_NVP(numMain));
+  ar(CEREAL_NVP(numMainRemoved));
+  ar(CEREAL_NVP(mainRemoved));
+  ar(CEREAL_NVP(mainNewFromOld));
+  ar(CEREAL_NVP(removedIds));
+  ar(CEREAL_NVP(nextId));
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
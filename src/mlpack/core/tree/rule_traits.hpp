@@ -0,0 +1,85 @@
+/**
+ * @file core/tree/rule_traits.hpp
+ *
+ * This file implements the basic, unspecialized RuleTraits class, which
+ * provides information about RuleType classes used by tree traversers, and the
+ * LeafBaseCases() function, which traversers use to run the base cases between
+ * a query point and all points of a leaf.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_TREE_RULE_TRAITS_HPP
+#define MLPACK_CORE_TREE_RULE_TRAITS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The RuleTraits class provides compile-time information on the
+ * characteristics of a given RuleType class.  By default, no assumptions are
+ * made about the rules; a RuleType class that supports any of the traits below
+ * should specialize this class.
+ */
+template<typename RuleType>
+class RuleTraits
+{
+ public:
+  /**
+   * This is true if the RuleType class has a batched base case:
+   *
+   * @code
+   * void BaseCase(const size_t queryIndex,
+   *               const size_t referenceBegin,
+   *               const size_t referenceCount);
+   * @endcode
+   *
+   * which has the same effect as calling BaseCase(queryIndex, r) for each r in
+   * [referenceBegin, referenceBegin + referenceCount), but computes all of the
+   * distances at once.  Traversers of trees whose leaves hold a contiguous
+   * range of points use it through LeafBaseCases().
+   */
+  static const bool HasBatchBaseCase = false;
+};
+
+/**
+ * Run the base cases between the given query point and the reference points in
+ * [referenceBegin, referenceBegin + referenceCount).  This uses the batched
+ * base case of the rules, if they have one.
+ */
+template<typename RuleType>
+inline void LeafBaseCases(
+    RuleType& rule,
+    const size_t queryIndex,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    typename std::enable_if_t<RuleTraits<RuleType>::HasBatchBaseCase>* = 0)
+{
+  rule.BaseCase(queryIndex, referenceBegin, referenceCount);
+}
+
+/**
+ * Run the base cases between the given query point and the reference points in
+ * [referenceBegin, referenceBegin + referenceCount), one at a time.
+ */
+template<typename RuleType>
+inline void LeafBaseCases(
+    RuleType& rule,
+    const size_t queryIndex,
+    const size_t referenceBegin,
+    const size_t referenceCount,
+    typename std::enable_if_t<!RuleTraits<RuleType>::HasBatchBaseCase>* = 0)
+{
+  const size_t referenceEnd = referenceBegin + referenceCount;
+  for (size_t r = referenceBegin; r < referenceEnd; ++r)
+    rule.BaseCase(queryIndex, r);
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
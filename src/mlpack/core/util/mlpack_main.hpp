@@ -481,6 +481,10 @@ PARAM_FLAG("verbose", "Display informational messages and the full list of "
 PARAM_FLAG("help", "Default help info.", "h");
 PARAM_STRING_IN("info", "Print help on a specific option.", "", "");
 PARAM_FLAG("version", "Display the version of mlpack.", "V");
+PARAM_STRING_IN("profile", "If specified, a profile of the program (the time "
+    "spent in each nested timer, and counters such as the number of base "
+    "cases) is saved to this file as JSON, or in the Chrome trace-event format "
+    "if the filename ends in '.trace.json'.", "", "");
 
 // Python-specific parameters.
 PARAM_FLAG("copy_all_inputs", "If specified, all input parameters will be deep"
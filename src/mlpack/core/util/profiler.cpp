@@ -0,0 +1,402 @@
+/**
+ * @file core/util/profiler.cpp
+ *
+ * Implementation of the Profiler.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "profiler.hpp"
+
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+using namespace mlpack;
+using namespace std;
+using namespace chrono;
+
+namespace {
+
+//! The maximum number of trace events kept for each thread.
+const size_t maxEvents = 10000000;
+
+//! The total time and number of calls of a scope.
+struct ScopeTotal
+{
+  microseconds time = microseconds(0);
+  size_t calls = 0;
+};
+
+//! A scope that has been entered and not yet left.
+struct OpenScope
+{
+  string name;
+  string path;
+  steady_clock::time_point start;
+};
+
+//! A call of a scope, for the trace.
+struct Event
+{
+  string path;
+  microseconds start;
+  microseconds duration;
+};
+
+//! Everything that the profiler records for one thread.
+struct ThreadProfile
+{
+  //! Index of the thread, in the order that threads first used the profiler.
+  size_t index;
+  //! Only held by the owning thread while it records, and by the functions
+  //! that read all threads, so it is almost never contended.
+  mutex lock;
+  //! The open scopes, from the outermost to the innermost.
+  vector<OpenScope> open;
+  //! The totals of each scope, by path.
+  map<string, ScopeTotal> scopes;
+  //! The counters, by path of their scope followed by their name.
+  map<string, size_t> counters;
+  //! The calls of each scope, in the order that they ended.
+  vector<Event> events;
+};
+
+//! The storage of all threads; it lives until the end of the program, so that
+//! the records of threads that have finished can still be saved.
+struct Registry
+{
+  mutex lock;
+  vector<unique_ptr<ThreadProfile>> threads;
+  steady_clock::time_point epoch = steady_clock::now();
+  bool epochSet = false;
+};
+
+Registry& GetRegistry()
+{
+  static Registry registry;
+  return registry;
+}
+
+//! The storage of the calling thread, or NULL if it has not recorded anything.
+thread_local ThreadProfile* threadProfile = NULL;
+
+//! Get the storage of the calling thread, creating it if necessary.
+ThreadProfile& GetThreadProfile()
+{
+  if (threadProfile == NULL)
+  {
+    Registry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry.lock);
+    registry.threads.emplace_back(new ThreadProfile());
+    threadProfile = registry.threads.back().get();
+    threadProfile->index = registry.threads.size() - 1;
+  }
+
+  return *threadProfile;
+}
+
+//! Record the end of the given scope in the given profile.  The lock of the
+//! profile must be held.
+void Close(ThreadProfile& profile,
+           const OpenScope& scope,
+           const steady_clock::time_point end)
+{
+  const microseconds duration = duration_cast<microseconds>(end - scope.start);
+  ScopeTotal& total = profile.scopes[scope.path];
+  total.time += duration;
+  ++total.calls;
+
+  if (profile.events.size() < maxEvents)
+  {
+    profile.events.push_back(Event { scope.path, duration_cast<microseconds>(
+        scope.start - GetRegistry().epoch), duration });
+  }
+}
+
+//! Write the given string as a JSON string.
+void WriteString(ostream& stream, const string& str)
+{
+  stream << '"';
+  for (const char c : str)
+  {
+    if (c == '"' || c == '\\')
+    {
+      stream << '\\' << c;
+    }
+    else if ((unsigned char) c < 0x20)
+    {
+      stream << "\\u" << hex << setw(4) << setfill('0') << (int) c << dec
+          << setfill(' ');
+    }
+    else
+    {
+      stream << c;
+    }
+  }
+  stream << '"';
+}
+
+//! Write the given scope totals and counters as the members "scopes" and
+//! "counters" of a JSON object.
+void WriteTotals(ostream& stream,
+                 const map<string, ScopeTotal>& scopes,
+                 const map<string, size_t>& counters,
+                 const string& indent)
+{
+  stream << indent << "\"scopes\": {";
+  bool first = true;
+  for (const auto& scope : scopes)
+  {
+    stream << (first ? "\n" : ",\n") << indent << "  ";
+    WriteString(stream, scope.first);
+    stream << ": { \"time_us\": " << scope.second.time.count()
+        << ", \"calls\": " << scope.second.calls << " }";
+    first = false;
+  }
+  stream << (first ? "" : "\n" + indent) << "},\n";
+
+  stream << indent << "\"counters\": {";
+  first = true;
+  for (const auto& counter : counters)
+  {
+    stream << (first ? "\n" : ",\n") << indent << "  ";
+    WriteString(stream, counter.first);
+    stream << ": " << counter.second;
+    first = false;
+  }
+  stream << (first ? "" : "\n" + indent) << "}";
+}
+
+} // namespace
+
+std::atomic<bool> Profiler::enabled(false);
+
+void Profiler::Enable()
+{
+  Registry& registry = GetRegistry();
+  {
+    lock_guard<mutex> lock(registry.lock);
+    if (!registry.epochSet)
+    {
+      registry.epoch = steady_clock::now();
+      registry.epochSet = true;
+    }
+  }
+
+  enabled = true;
+}
+
+void Profiler::Disable()
+{
+  enabled = false;
+}
+
+void Profiler::Enter(const string& name, const string& parent)
+{
+  if (!enabled)
+    return;
+
+  ThreadProfile& profile = GetThreadProfile();
+  lock_guard<mutex> lock(profile.lock);
+
+  OpenScope scope;
+  scope.name = name;
+  if (!profile.open.empty())
+    scope.path = profile.open.back().path + "/" + name;
+  else if (!parent.empty())
+    scope.path = parent + "/" + name;
+  else
+    scope.path = name;
+  scope.start = steady_clock::now();
+  profile.open.push_back(std::move(scope));
+}
+
+void Profiler::Leave(const string& name)
+{
+  // If this thread never entered a scope, there is nothing to leave.
+  if (threadProfile == NULL)
+    return;
+
+  const steady_clock::time_point end = steady_clock::now();
+  ThreadProfile& profile = *threadProfile;
+  lock_guard<mutex> lock(profile.lock);
+
+  // Scopes are usually left in the reverse order that they were entered, but
+  // the mlpack timers don't have to be; so look for the innermost scope with
+  // this name.
+  for (size_t i = profile.open.size(); i > 0; --i)
+  {
+    if (profile.open[i - 1].name == name)
+    {
+      Close(profile, profile.open[i - 1], end);
+      profile.open.erase(profile.open.begin() + (i - 1));
+      return;
+    }
+  }
+}
+
+string Profiler::Scope()
+{
+  if (!enabled || threadProfile == NULL)
+    return string();
+
+  lock_guard<mutex> lock(threadProfile->lock);
+  return threadProfile->open.empty() ? string() :
+      threadProfile->open.back().path;
+}
+
+void Profiler::AddCount(const string& name, const size_t value)
+{
+  ThreadProfile& profile = GetThreadProfile();
+  lock_guard<mutex> lock(profile.lock);
+
+  const string path = profile.open.empty() ? name :
+      profile.open.back().path + "/" + name;
+  profile.counters[path] += value;
+}
+
+void Profiler::StopAll()
+{
+  const steady_clock::time_point end = steady_clock::now();
+
+  Registry& registry = GetRegistry();
+  lock_guard<mutex> registryLock(registry.lock);
+  for (auto& profile : registry.threads)
+  {
+    lock_guard<mutex> lock(profile->lock);
+    for (size_t i = profile->open.size(); i > 0; --i)
+      Close(*profile, profile->open[i - 1], end);
+    profile->open.clear();
+  }
+}
+
+void Profiler::Reset()
+{
+  Registry& registry = GetRegistry();
+  lock_guard<mutex> registryLock(registry.lock);
+  for (auto& profile : registry.threads)
+  {
+    lock_guard<mutex> lock(profile->lock);
+    profile->open.clear();
+    profile->scopes.clear();
+    profile->counters.clear();
+    profile->events.clear();
+  }
+
+  registry.epoch = steady_clock::now();
+}
+
+void Profiler::SaveJSON(ostream& stream)
+{
+  Registry& registry = GetRegistry();
+  lock_guard<mutex> registryLock(registry.lock);
+
+  // Merge the records of all threads.
+  map<string, ScopeTotal> scopes;
+  map<string, size_t> counters;
+  for (auto& profile : registry.threads)
+  {
+    lock_guard<mutex> lock(profile->lock);
+    for (const auto& scope : profile->scopes)
+    {
+      scopes[scope.first].time += scope.second.time;
+      scopes[scope.first].calls += scope.second.calls;
+    }
+    for (const auto& counter : profile->counters)
+      counters[counter.first] += counter.second;
+  }
+
+  stream << "{\n";
+  WriteTotals(stream, scopes, counters, "  ");
+  stream << ",\n  \"threads\": [";
+  for (size_t t = 0; t < registry.threads.size(); ++t)
+  {
+    ThreadProfile& profile = *registry.threads[t];
+    lock_guard<mutex> lock(profile.lock);
+    stream << (t == 0 ? "\n" : ",\n") << "    {\n      \"thread\": "
+        << profile.index << ",\n";
+    WriteTotals(stream, profile.scopes, profile.counters, "      ");
+    stream << "\n    }";
+  }
+  stream << (registry.threads.empty() ? "" : "\n  ") << "]\n}\n";
+}
+
+void Profiler::SaveTrace(ostream& stream)
+{
+  Registry& registry = GetRegistry();
+  lock_guard<mutex> registryLock(registry.lock);
+
+  stream << "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [";
+  bool first = true;
+  microseconds last(0);
+  for (auto& profile : registry.threads)
+  {
+    lock_guard<mutex> lock(profile->lock);
+    for (const Event& event : profile->events)
+    {
+      // Only the name of the scope is shown on the timeline; the nesting is
+      // visible from the events themselves.
+      const size_t slash = event.path.rfind('/');
+      stream << (first ? "\n" : ",\n") << "    { \"name\": ";
+      WriteString(stream, (slash == string::npos) ? event.path :
+          event.path.substr(slash + 1));
+      stream << ", \"cat\": \"mlpack\", \"ph\": \"X\", \"pid\": 0, \"tid\": "
+          << profile->index << ", \"ts\": " << event.start.count()
+          << ", \"dur\": " << event.duration.count() << ", \"args\": { "
+          << "\"path\": ";
+      WriteString(stream, event.path);
+      stream << " } }";
+      first = false;
+
+      last = std::max(last, event.start + event.duration);
+    }
+  }
+
+  for (auto& profile : registry.threads)
+  {
+    lock_guard<mutex> lock(profile->lock);
+    for (const auto& counter : profile->counters)
+    {
+      stream << (first ? "\n" : ",\n") << "    { \"name\": ";
+      WriteString(stream, counter.first);
+      stream << ", \"cat\": \"mlpack\", \"ph\": \"C\", \"pid\": 0, \"tid\": "
+          << profile->index << ", \"ts\": " << last.count()
+          << ", \"args\": { \"value\": " << counter.second << " } }";
+      first = false;
+    }
+  }
+
+  stream << (first ? "" : "\n  ") << "]\n}\n";
+}
+
+void Profiler::Save(const string& filename)
+{
+  ofstream stream(filename);
+  if (!stream.is_open())
+  {
+    throw runtime_error("Profiler::Save(): cannot open '" + filename + "' for "
+        "writing.");
+  }
+
+  const string traceExtension = ".trace.json";
+  if (filename.size() >= traceExtension.size() &&
+      filename.compare(filename.size() - traceExtension.size(),
+      traceExtension.size(), traceExtension) == 0)
+    SaveTrace(stream);
+  else
+    SaveJSON(stream);
+
+  if (!stream.good())
+  {
+    throw runtime_error("Profiler::Save(): error while writing '" + filename +
+        "'.");
+  }
+}
@@ -0,0 +1,213 @@
+/**
+ * @file core/util/profiler.hpp
+ *
+ * A hierarchical profiler for mlpack: nested scoped timers and named counters,
+ * kept per thread and merged when the profile is saved.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_CORE_UTIL_PROFILER_HPP
+#define MLPACK_CORE_UTIL_PROFILER_HPP
+
+#include <atomic>
+#include <ostream>
+#include <string>
+
+namespace mlpack {
+
+/**
+ * The Profiler records where time is spent, as a tree of nested scopes, and how
+ * much work is done in each scope, as named counters (such as the number of
+ * base cases and scores of a tree traversal).
+ *
+ * Scopes are entered and left with Enter() and Leave(), or with a ScopedTimer
+ * object.  A scope that is entered while another is open on the same thread is
+ * nested inside it, and is identified by its path: the names of the enclosing
+ * scopes and its own name, separated by '/'.  The mlpack timers (Timer::Start()
+ * and Timer::Stop()) also enter and leave scopes, so the profile holds all of
+ * the timers of a program.  Counters added with Count() are attached to the
+ * innermost open scope of the calling thread.
+ *
+ * Each thread records into its own storage, so threads never wait on each
+ * other; the storage of all threads is merged by Save(), SaveJSON() and
+ * SaveTrace().  When profiling is disabled (the default), every call returns
+ * immediately.
+ *
+ * Command-line programs save their profile to the file given with --profile.
+ */
+class Profiler
+{
+ public:
+  /**
+   * Enable profiling.  The times in the Chrome trace are relative to the first
+   * time that profiling is enabled (or to the last Reset()).
+   */
+  static void Enable();
+
+  //! Disable profiling.  Scopes that are already open are still recorded when
+  //! they are left.
+  static void Disable();
+
+  //! Return whether profiling is enabled.
+  static bool Enabled() { return enabled; }
+
+  /**
+   * Enter a scope with the given name on the calling thread.  If the thread has
+   * no open scope and a parent path is given, the scope is nested inside the
+   * scope with that path; this lets the worker threads of a parallel region
+   * record into the scope of the thread that started it (see Scope()).
+   *
+   * @param name Name of the scope.
+   * @param parent Path of the enclosing scope, for threads without open scopes.
+   */
+  static void Enter(const std::string& name,
+                    const std::string& parent = std::string());
+
+  /**
+   * Leave the innermost open scope with the given name on the calling thread.
+   * Nothing happens if there is no such scope (for instance, because it was
+   * entered before profiling was enabled).
+   *
+   * @param name Name of the scope.
+   */
+  static void Leave(const std::string& name);
+
+  //! Get the path of the innermost open scope of the calling thread (or an
+  //! empty string if there is none or profiling is disabled).
+  static std::string Scope();
+
+  /**
+   * Add the given value to the counter with the given name, in the innermost
+   * open scope of the calling thread.
+   *
+   * @param name Name of the counter.
+   * @param value Value to add.
+   */
+  static void Count(const std::string& name, const size_t value)
+  {
+    if (enabled)
+      AddCount(name, value);
+  }
+
+  /**
+   * Leave all open scopes of all threads.  This must only be called when no
+   * other thread is using the profiler, such as at the end of a program.
+   */
+  static void StopAll();
+
+  /**
+   * Forget all recorded scopes, counters and events.  This must only be called
+   * when no other thread is using the profiler.
+   */
+  static void Reset();
+
+  /**
+   * Write the profile as a JSON object.  It has the member "scopes", which maps
+   * the path of every scope to its total time in microseconds and its number
+   * of calls, summed over all threads; the member "counters", which maps the
+   * path of the scope of every counter followed by '/' and its name to its
+   * value, summed over all threads; and the member "threads", which holds the
+   * same two objects for each thread.
+   *
+   * @param stream Stream to write to.
+   */
+  static void SaveJSON(std::ostream& stream);
+
+  /**
+   * Write the profile in the Chrome trace-event format, which can be loaded in
+   * chrome://tracing or Perfetto.  Every call of every scope is a complete
+   * event on the timeline of its thread, and the counters are given as counter
+   * events at the end of the profile.  Only the first ten million calls of each
+   * thread are kept for the trace.
+   *
+   * @param stream Stream to write to.
+   */
+  static void SaveTrace(std::ostream& stream);
+
+  /**
+   * Save the profile to the given file.  If the filename ends in ".trace.json",
+   * the Chrome trace-event format is used (see SaveTrace()); otherwise, the
+   * profile is saved as JSON (see SaveJSON()).  A std::runtime_error is thrown
+   * if the file cannot be written.
+   *
+   * @param filename Name of the file to save to.
+   */
+  static void Save(const std::string& filename);
+
+ private:
+  //! Whether or not profiling is enabled.
+  static std::atomic<bool> enabled;
+
+  //! Add to a counter; only called when profiling is enabled.
+  static void AddCount(const std::string& name, const size_t value);
+};
+
+/**
+ * A ScopedTimer enters a scope of the Profiler when it is created, and leaves
+ * it when it is destroyed:
+ *
+ * @code
+ * {
+ *   ScopedTimer t("tree_building");
+ *   // ... build the tree ...
+ * } // The scope ends here.
+ * @endcode
+ *
+ * Nothing is recorded if profiling is disabled when the object is created.
+ *
+ * In a parallel region, the worker threads have no open scopes; pass the scope
+ * of the thread that starts the region so that they record into it:
+ *
+ * @code
+ * const std::string scope = Profiler::Scope();
+ * #pragma omp parallel
+ * {
+ *   ScopedTimer t("traversal", scope);
+ *   // ...
+ * }
+ * @endcode
+ */
+class ScopedTimer
+{
+ public:
+  /**
+   * Enter the scope with the given name (see Profiler::Enter()).
+   *
+   * @param name Name of the scope.
+   * @param parent Path of the enclosing scope, for threads without open scopes.
+   */
+  ScopedTimer(const std::string& name,
+              const std::string& parent = std::string()) :
+      active(Profiler::Enabled())
+  {
+    if (active)
+    {
+      this->name = name;
+      Profiler::Enter(name, parent);
+    }
+  }
+
+  //! Leave the scope.
+  ~ScopedTimer()
+  {
+    if (active)
+      Profiler::Leave(name);
+  }
+
+  // A scope can't be copied.
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+ private:
+  //! Whether the scope was entered.
+  bool active;
+  //! The name of the scope.
+  std::string name;
+};
+
+} // namespace mlpack
+
+#endif
@@ -14,6 +14,7 @@
 #include "timers.hpp"
 #include "io.hpp"
 #include "log.hpp"
+#include "profiler.hpp"
 
 #include <map>
 #include <string>
@@ -23,19 +24,21 @@ using namespace std;
 using namespace chrono;
 
 /**
- * Start the given timer.
+ * Start the given timer.  This also enters a scope of the profiler.
  */
 void Timer::Start(const string& name)
 {
   IO::GetSingleton().timer.StartTimer(name, this_thread::get_id());
+  Profiler::Enter(name);
 }
 
 /**
- * Stop the given timer.
+ * Stop the given timer, and leave its scope of the profiler.
  */
 void Timer::Stop(const string& name)
 {
   IO::GetSingleton().timer.StopTimer(name, this_thread::get_id());
+  Profiler::Leave(name);
 }
 
 /**
@@ -52,6 +52,9 @@ class Timer
    * both runs -- that is, mlpack timers are additive for each time they are
    * run, and do not reset.
    *
+   * If profiling is enabled, this also enters a scope of the Profiler with the
+   * same name.
+   *
    * @note A std::runtime_error exception will be thrown if a timer is started
    * twice.
    *
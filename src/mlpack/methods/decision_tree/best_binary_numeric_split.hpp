@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_DECISION_TREE_BEST_BINARY_NUMERIC_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "numeric_split_traits.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -89,6 +90,18 @@ class BestBinaryNumericSplit
       const AuxiliarySplitInfo& /* aux */);
 };
 
+/**
+ * The splits of BestBinaryNumericSplit are thresholds.
+ */
+template<typename FitnessFunction>
+class NumericSplitTraits<BestBinaryNumericSplit<FitnessFunction>>
+{
+ public:
+  static const bool UsesBins = false;
+  static const bool UsesRandomness = false;
+  static const bool UsesThreshold = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -18,6 +18,9 @@
 #include "information_gain.hpp"
 #include "best_binary_numeric_split.hpp"
 #include "random_binary_numeric_split.hpp"
+#include "histogram_numeric_split.hpp"
+#include "numeric_split_traits.hpp"
+#include "indexed_matrix.hpp"
 #include "all_categorical_split.hpp"
 #include "all_dimension_select.hpp"
 #include <type_traits>
@@ -401,6 +404,123 @@ class DecisionTree :
                const std::enable_if_t<arma::is_arma_type<typename
                    std::remove_reference<WeightsType>::type>::value>* = 0);
 
+  /**
+   * Train the decision tree on the points of the given dataset with the given
+   * indices, without copying the dataset: while the tree is built, a copy of
+   * the indices is reordered instead of the points.  An index may appear more
+   * than once, as in a bootstrap sample; the point is then used as many times.
+   * This will overwrite the existing model.  The data may have numeric and
+   * categorical types, specified by the datasetInfo parameter.
+   *
+   * The data is used as it is, so if the numeric split type works on bins
+   * (see NumericSplitTraits), it must be the bins given by BinData(), and
+   * UnbinSplits() must be called after training.
+   *
+   * @param data Dataset to train on.
+   * @param indices Indices of the points of the dataset to train on.
+   * @param datasetInfo Type information for each dimension.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double Train(const MatType& data,
+               const arma::uvec& indices,
+               const data::DatasetInfo& datasetInfo,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const size_t minimumLeafSize = 10,
+               const double minimumGainSplit = 1e-7,
+               const size_t maximumDepth = 0,
+               DimensionSelectionType dimensionSelector =
+                   DimensionSelectionType());
+
+  /**
+   * Train the decision tree on the weighted points of the given dataset with
+   * the given indices, without copying the dataset.  See the unweighted
+   * overload for details.
+   *
+   * @param data Dataset to train on.
+   * @param indices Indices of the points of the dataset to train on.
+   * @param datasetInfo Type information for each dimension.
+   * @param labels Labels for each point of the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each point of the dataset.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<typename MatType>
+  double Train(const MatType& data,
+               const arma::uvec& indices,
+               const data::DatasetInfo& datasetInfo,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const arma::rowvec& weights,
+               const size_t minimumLeafSize = 10,
+               const double minimumGainSplit = 1e-7,
+               const size_t maximumDepth = 0,
+               DimensionSelectionType dimensionSelector =
+                   DimensionSelectionType());
+
+  /**
+   * If the numeric split type works on bins (see NumericSplitTraits), find the
+   * bin index of each value of each numeric dimension of the data, and store
+   * the split points between the bins of each dimension.  Categorical
+   * dimensions are copied as they are, so they may have at most 256
+   * categories.  Trees trained on the bins with the indexed Train() overloads
+   * must then be given the split points with UnbinSplits().  The other Train()
+   * overloads do all this themselves.
+   *
+   * @param data Dataset to bin.
+   * @param datasetInfo Type information for each dimension.
+   * @param bins Set to the bin indices of the dataset.
+   * @param splitPoints Vector to store the split points between the bins of
+   *     each dimension in.
+   */
+  template<typename MatType, typename SplitType = NumericSplit>
+  static void BinData(const MatType& data,
+                      const data::DatasetInfo& datasetInfo,
+                      arma::Mat<unsigned char>& bins,
+                      std::vector<arma::vec>& splitPoints,
+                      const std::enable_if_t<
+                          NumericSplitTraits<SplitType>::UsesBins>* = 0);
+
+  //! Nothing to do if the numeric split type works on values.
+  template<typename MatType,
+           typename BinsType,
+           typename SplitType = NumericSplit>
+  static void BinData(const MatType& /* data */,
+                      const data::DatasetInfo& /* datasetInfo */,
+                      BinsType& /* bins */,
+                      std::vector<arma::vec>& /* splitPoints */,
+                      const std::enable_if_t<
+                          !NumericSplitTraits<SplitType>::UsesBins>* = 0) { }
+
+  /**
+   * Convert the numeric splits of this node and its descendants, which were
+   * found on bin indices (see BinData()), back to split points on values.
+   *
+   * @param splitPoints Split points between the bins of each dimension, from
+   *     BinData().
+   */
+  template<typename SplitType = NumericSplit>
+  void UnbinSplits(const std::vector<arma::vec>& splitPoints,
+                   const std::enable_if_t<
+                       NumericSplitTraits<SplitType>::UsesBins>* = 0);
+
+  //! Nothing to do if the numeric split type works on values.
+  template<typename SplitType = NumericSplit>
+  void UnbinSplits(const std::vector<arma::vec>& /* splitPoints */,
+                   const std::enable_if_t<
+                       !NumericSplitTraits<SplitType>::UsesBins>* = 0) { }
+
   /**
    * Classify the given point, using the entire tree.  The predicted label is
    * returned.
@@ -467,6 +587,15 @@ class DecisionTree :
   //! Get the split dimension (only meaningful if this is a non-leaf in a
   //! trained tree).
   size_t SplitDimension() const { return splitDimension; }
+  //! Get the type of the split dimension (only meaningful if this is a
+  //! non-leaf in a trained tree).
+  data::Datatype SplitDimensionType() const
+  {
+    return (data::Datatype) dimensionTypeOrMajorityClass;
+  }
+  //! Get the class probabilities if this is a leaf, or the split information
+  //! used by the split type's CalculateDirection() otherwise.
+  const arma::vec& ClassProbabilities() const { return classProbabilities; }
 
   /**
    * Given a point and that this node is not a leaf, calculate the index of the
@@ -508,6 +637,58 @@ class DecisionTree :
   typedef typename CategoricalSplit::AuxiliarySplitInfo
       CategoricalAuxiliarySplitInfo;
 
+  /**
+   * A child whose subtree was set aside while the top of the tree was built,
+   * so that it can be built in parallel with the other set-aside subtrees.
+   */
+  struct Subtree
+  {
+    Subtree(DecisionTree* node,
+            const size_t begin,
+            const size_t count,
+            const size_t maximumDepth) :
+        node(node), begin(begin), count(count), maximumDepth(maximumDepth) { }
+
+    //! The (untrained) root of the subtree.
+    DecisionTree* node;
+    //! Index of the first point of the subtree.
+    size_t begin;
+    //! Number of points in the subtree.
+    size_t count;
+    //! Maximum depth of the subtree.
+    size_t maximumDepth;
+  };
+
+  //! The subtrees set aside while the top of a tree is built.
+  struct DeferredSubtrees
+  {
+    //! Children with at most this many points are set aside.
+    size_t maxPoints;
+    //! The children set aside, in the order in which they were found.
+    std::vector<Subtree> pending;
+  };
+
+  /**
+   * The class histograms of the bins of each dimension of the points of a
+   * node, if the numeric split type works on bins (see NumericSplitTraits).
+   */
+  struct Histogram
+  {
+    //! Number of points of each class (row) in each bin (column) of each
+    //! dimension (slice).  Empty if the node has no histograms.
+    arma::Cube<size_t> counts;
+    //! Total weight of the points of each class in each bin of each dimension,
+    //! if weights are used.
+    arma::cube weights;
+  };
+
+  //! Whether subtrees can be built in parallel.  The tree must not depend on
+  //! the order in which its nodes are built, so neither the numeric split nor
+  //! the dimension selection may draw random numbers.
+  static const bool ParallelSubtrees = !NoRecursion &&
+      !NumericSplitTraits<NumericSplit>::UsesRandomness &&
+      std::is_same<DimensionSelectionType, AllDimensionSelect>::value;
+
   /**
    * Calculate the class probabilities of the given labels.
    */
@@ -531,6 +712,10 @@ class DecisionTree :
    * @param minimumLeafSize Minimum number of points in each leaf node.
    * @param minimumGainSplit Minimum gain for the node to split.
    * @param maximumDepth Maximum depth for the tree.
+   * @param subtrees If not NULL, small enough children are added to it instead
+   *      of being trained.
+   * @param histogram If not NULL, the histograms of the points of this node,
+   *      which may be modified.
    * @return The final entropy of decision tree.
    */
   template<bool UseWeights, typename MatType>
@@ -544,7 +729,9 @@ class DecisionTree :
                const size_t minimumLeafSize,
                const double minimumGainSplit,
                const size_t maximumDepth,
-               DimensionSelectionType& dimensionSelector);
+               DimensionSelectionType& dimensionSelector,
+               DeferredSubtrees* subtrees = NULL,
+               Histogram* histogram = NULL);
 
   /**
    * Corresponding to the public Train() method, this method is designed for
@@ -560,6 +747,10 @@ class DecisionTree :
    * @param minimumLeafSize Minimum number of points in each leaf node.
    * @param minimumGainSplit Minimum gain for the node to split.
    * @param maximumDepth Maximum depth for the tree.
+   * @param subtrees If not NULL, small enough children are added to it instead
+   *      of being trained.
+   * @param histogram If not NULL, the histograms of the points of this node,
+   *      which may be modified.
    * @return The final entropy of decision tree.
    */
   template<bool UseWeights, typename MatType>
@@ -572,7 +763,214 @@ class DecisionTree :
                const size_t minimumLeafSize,
                const double minimumGainSplit,
                const size_t maximumDepth,
-               DimensionSelectionType& dimensionSelector);
+               DimensionSelectionType& dimensionSelector,
+               DeferredSubtrees* subtrees = NULL,
+               Histogram* histogram = NULL);
+
+  /**
+   * Train the tree on all the points of the given dataset.  Large trees are
+   * built in two steps: first the top of the tree, then the remaining subtrees
+   * in parallel.
+   *
+   * @param data Dataset to train on.
+   * @param datasetInfo Type information for each dimension, or NULL if all
+   *      dimensions are numeric.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each training point.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<bool UseWeights, typename MatType>
+  double TrainRoot(MatType& data,
+                   const data::DatasetInfo* datasetInfo,
+                   arma::Row<size_t>& labels,
+                   const size_t numClasses,
+                   arma::rowvec& weights,
+                   const size_t minimumLeafSize,
+                   const double minimumGainSplit,
+                   const size_t maximumDepth,
+                   DimensionSelectionType& dimensionSelector);
+
+  /**
+   * Train the tree with TrainRoot() on the bins of the given data (see
+   * BinData()), and convert the splits back to values.  The data is released
+   * once it is binned.
+   *
+   * @param data Dataset to train on.
+   * @param datasetInfo Type information for each dimension, or NULL if all
+   *      dimensions are numeric.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each training point.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @return The final entropy of decision tree.
+   */
+  template<bool UseWeights, typename MatType, typename SplitType = NumericSplit>
+  double TrainBins(MatType& data,
+                   const data::DatasetInfo* datasetInfo,
+                   arma::Row<size_t>& labels,
+                   const size_t numClasses,
+                   arma::rowvec& weights,
+                   const size_t minimumLeafSize,
+                   const double minimumGainSplit,
+                   const size_t maximumDepth,
+                   DimensionSelectionType& dimensionSelector,
+                   const std::enable_if_t<
+                       NumericSplitTraits<SplitType>::UsesBins>* = 0);
+
+  //! Train on the data itself if the numeric split type works on values.
+  template<bool UseWeights, typename MatType, typename SplitType = NumericSplit>
+  double TrainBins(MatType& data,
+                   const data::DatasetInfo* datasetInfo,
+                   arma::Row<size_t>& labels,
+                   const size_t numClasses,
+                   arma::rowvec& weights,
+                   const size_t minimumLeafSize,
+                   const double minimumGainSplit,
+                   const size_t maximumDepth,
+                   DimensionSelectionType& dimensionSelector,
+                   const std::enable_if_t<
+                       !NumericSplitTraits<SplitType>::UsesBins>* = 0)
+  {
+    return TrainRoot<UseWeights>(data, datasetInfo, labels, numClasses,
+        weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+        dimensionSelector);
+  }
+
+  /**
+   * Find the best split of the points of this node among the dimensions given
+   * by the dimension selector.  As in a serial search, a dimension is only
+   * taken if its gain beats the dimensions before it by minimumGainSplit.  If
+   * a split is found, bestGain and bestDim are set, and the split information
+   * is stored in this node.  The dimensions of large nodes are evaluated in
+   * parallel.
+   *
+   * @param data Dataset to train on.
+   * @param begin Index of the first point of this node.
+   * @param count Number of points in this node.
+   * @param datasetInfo Type information for each dimension, or NULL if all
+   *      dimensions are numeric.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each training point.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for the node to split.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @param histogram Histograms of the points of this node; built here if
+   *      they are empty and worth building.
+   * @param bestGain Gain of this node; set to the gain of the split if one is
+   *      found.
+   * @param bestDim Set to the dimension of the split if one is found.
+   */
+  template<bool UseWeights, typename MatType>
+  void FindSplit(MatType& data,
+                 const size_t begin,
+                 const size_t count,
+                 const data::DatasetInfo* datasetInfo,
+                 arma::Row<size_t>& labels,
+                 const size_t numClasses,
+                 arma::rowvec& weights,
+                 const size_t minimumLeafSize,
+                 const double minimumGainSplit,
+                 DimensionSelectionType& dimensionSelector,
+                 Histogram& histogram,
+                 double& bestGain,
+                 size_t& bestDim);
+
+  /**
+   * Give each child of this node the histograms of its points.  The points of
+   * all the children but the largest are counted, and the histograms of the
+   * largest are what is left of the histograms of this node.
+   *
+   * @param data Dataset to train on.
+   * @param childBegins Index of the first point of each child.
+   * @param childCounts Number of points of each child.
+   * @param labels Labels for each training point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights of each training point.
+   * @param histogram Histograms of the points of this node (moved to the
+   *      largest child).
+   * @param childHistograms Set to the histograms of each child.
+   */
+  template<bool UseWeights, typename MatType>
+  static void ChildHistograms(const MatType& data,
+                              const arma::Row<size_t>& childBegins,
+                              const arma::Row<size_t>& childCounts,
+                              const arma::Row<size_t>& labels,
+                              const size_t numClasses,
+                              const arma::rowvec& weights,
+                              Histogram& histogram,
+                              std::vector<Histogram>& childHistograms);
+
+  //! Build the histograms of the given points with the numeric split type.
+  template<bool UseWeights, typename MatType, typename SplitType = NumericSplit>
+  static void BuildHistogram(const MatType& data,
+                             const size_t begin,
+                             const size_t count,
+                             const arma::Row<size_t>& labels,
+                             const size_t numClasses,
+                             const arma::rowvec& weights,
+                             Histogram& histogram,
+                             const std::enable_if_t<
+                                 NumericSplitTraits<SplitType>::UsesBins>* = 0)
+  {
+    SplitType::template BuildHistogram<UseWeights>(data, begin, count, labels,
+        numClasses, weights, histogram.counts, histogram.weights);
+  }
+
+  //! Numeric split types that work on values have no histograms.
+  template<bool UseWeights, typename MatType, typename SplitType = NumericSplit>
+  static void BuildHistogram(const MatType& /* data */,
+                             const size_t /* begin */,
+                             const size_t /* count */,
+                             const arma::Row<size_t>& /* labels */,
+                             const size_t /* numClasses */,
+                             const arma::rowvec& /* weights */,
+                             Histogram& /* histogram */,
+                             const std::enable_if_t<
+                                 !NumericSplitTraits<SplitType>::UsesBins>* =
+                                 0) { }
+
+  //! Find the split of the given dimension from the histograms of a node.
+  template<bool UseWeights, typename SplitType = NumericSplit>
+  static double SplitHistogramIfBetter(
+      const double bestGain,
+      const Histogram& histogram,
+      const size_t dimension,
+      const size_t numClasses,
+      const size_t minimumLeafSize,
+      const double minimumGainSplit,
+      arma::vec& splitInfo,
+      NumericAuxiliarySplitInfo& aux,
+      const std::enable_if_t<NumericSplitTraits<SplitType>::UsesBins>* = 0)
+  {
+    return SplitType::template SplitHistogramIfBetter<UseWeights>(bestGain,
+        histogram.counts, histogram.weights, dimension, numClasses,
+        minimumLeafSize, minimumGainSplit, splitInfo, aux);
+  }
+
+  //! Numeric split types that work on values have no histograms.
+  template<bool UseWeights, typename SplitType = NumericSplit>
+  static double SplitHistogramIfBetter(
+      const double /* bestGain */,
+      const Histogram& /* histogram */,
+      const size_t /* dimension */,
+      const size_t /* numClasses */,
+      const size_t /* minimumLeafSize */,
+      const double /* minimumGainSplit */,
+      arma::vec& /* splitInfo */,
+      NumericAuxiliarySplitInfo& /* aux */,
+      const std::enable_if_t<!NumericSplitTraits<SplitType>::UsesBins>* = 0)
+  {
+    return DBL_MAX;
+  }
 };
 
 /**
@@ -50,7 +50,7 @@ DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
-  Train<false>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
+  TrainBins<false>(tmpData, &datasetInfo, tmpLabels, numClasses,
       weights, minimumLeafSize, minimumGainSplit, maximumDepth,
       dimensionSelector);
 }
@@ -87,7 +87,7 @@ DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
-  Train<false>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, weights,
+  TrainBins<false>(tmpData, NULL, tmpLabels, numClasses, weights,
       minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
 }
 
@@ -128,7 +128,7 @@ DecisionTree<FitnessFunction,
   dimensionSelector.Dimensions() = tmpData.n_rows;
 
   // Pass off work to the weighted Train() method.
-  Train<true>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
+  TrainBins<true>(tmpData, &datasetInfo, tmpLabels, numClasses,
       tmpWeights, minimumLeafSize, minimumGainSplit, maximumDepth,
       dimensionSelector);
 }
@@ -167,9 +167,11 @@ DecisionTree<FitnessFunction,
   TrueLabelsType tmpLabels(std::move(labels));
   TrueWeightsType tmpWeights(std::move(weights));
 
-  // Pass off work to the weighted Train() method.
-  Train<true>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels, numClasses,
-              tmpWeights, minimumLeafSize, minimumGainSplit);
+  // Pass off work to the weighted Train() method, with no maximum depth.
+  DimensionSelectionType dimensionSelector;
+  dimensionSelector.Dimensions() = tmpData.n_rows;
+  TrainBins<true>(tmpData, &datasetInfo, tmpLabels, numClasses, tmpWeights,
+      minimumLeafSize, minimumGainSplit, 0, dimensionSelector);
 }
 
 //! Construct and train with weights.
@@ -210,7 +212,7 @@ DecisionTree<FitnessFunction,
   dimensionSelector.Dimensions() = tmpData.n_rows;
 
   // Pass off work to the weighted Train() method.
-  Train<true>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, tmpWeights,
+  TrainBins<true>(tmpData, NULL, tmpLabels, numClasses, tmpWeights,
       minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
 }
 
@@ -254,7 +256,7 @@ DecisionTree<FitnessFunction,
   dimensionSelector.Dimensions() = tmpData.n_rows;
 
   // Pass off work to the weighted Train() method.
-  Train<true>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses, tmpWeights,
+  TrainBins<true>(tmpData, NULL, tmpLabels, numClasses, tmpWeights,
       minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
 }
 
@@ -455,7 +457,7 @@ double DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
-  return Train<false>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels,
+  return TrainBins<false>(tmpData, &datasetInfo, tmpLabels,
       numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
       dimensionSelector);
 }
@@ -495,8 +497,8 @@ double DecisionTree<FitnessFunction,
 
   // Pass off work to the Train() method.
   arma::rowvec weights; // Fake weights, not used.
-  return Train<false>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses,
-      weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+  return TrainBins<false>(tmpData, NULL, tmpLabels,
+      numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
       dimensionSelector);
 }
 
@@ -542,7 +544,7 @@ double DecisionTree<FitnessFunction,
   dimensionSelector.Dimensions() = tmpData.n_rows;
 
   // Pass off work to the Train() method.
-  return Train<true>(tmpData, 0, tmpData.n_cols, datasetInfo, tmpLabels,
+  return TrainBins<true>(tmpData, &datasetInfo, tmpLabels,
       numClasses, tmpWeights, minimumLeafSize, minimumGainSplit, maximumDepth,
       dimensionSelector);
 }
@@ -588,11 +590,101 @@ double DecisionTree<FitnessFunction,
   dimensionSelector.Dimensions() = tmpData.n_rows;
 
   // Pass off work to the Train() method.
-  return Train<true>(tmpData, 0, tmpData.n_cols, tmpLabels, numClasses,
-      tmpWeights, minimumLeafSize, minimumGainSplit, maximumDepth,
+  return TrainBins<true>(tmpData, NULL, tmpLabels,
+      numClasses, tmpWeights, minimumLeafSize, minimumGainSplit, maximumDepth,
       dimensionSelector);
 }
 
+//! Train on the points of the given data with the given indices.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    NoRecursion>::Train(
+    const MatType& data,
+    const arma::uvec& indices,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  // Sanity check on data.
+  util::CheckSameSizes(data, labels, "DecisionTree::Train()");
+  if (indices.n_elem > 0 && indices.max() >= data.n_cols)
+  {
+    throw std::invalid_argument("DecisionTree::Train(): index out of range "
+        "for a dataset with " + std::to_string(data.n_cols) + " points.");
+  }
+
+  // Only the indices and the labels of the sample are copied.
+  IndexedMatrix<MatType> sample(data, indices);
+  arma::Row<size_t> sampleLabels = labels.cols(indices);
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the Train() method.
+  arma::rowvec weights; // Fake weights, not used.
+  return TrainRoot<false>(sample, &datasetInfo, sampleLabels,
+      numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+      dimensionSelector);
+}
+
+//! Train on the weighted points of the given data with the given indices.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         bool NoRecursion>
+template<typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    NoRecursion>::Train(
+    const MatType& data,
+    const arma::uvec& indices,
+    const data::DatasetInfo& datasetInfo,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType dimensionSelector)
+{
+  // Sanity check on data.
+  util::CheckSameSizes(data, labels, "DecisionTree::Train()");
+  util::CheckSameSizes(data, weights, "DecisionTree::Train()", "weights");
+  if (indices.n_elem > 0 && indices.max() >= data.n_cols)
+  {
+    throw std::invalid_argument("DecisionTree::Train(): index out of range "
+        "for a dataset with " + std::to_string(data.n_cols) + " points.");
+  }
+
+  // Only the indices, the labels and the weights of the sample are copied.
+  IndexedMatrix<MatType> sample(data, indices);
+  arma::Row<size_t> sampleLabels = labels.cols(indices);
+  arma::rowvec sampleWeights = weights.cols(indices);
+
+  // Set the correct dimensionality for the dimension selector.
+  dimensionSelector.Dimensions() = data.n_rows;
+
+  // Pass off work to the Train() method.
+  return TrainRoot<true>(sample, &datasetInfo, sampleLabels,
+      numClasses, sampleWeights, minimumLeafSize, minimumGainSplit,
+      maximumDepth, dimensionSelector);
+}
+
 //! Train on the given data, assuming all dimensions are numeric.
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
@@ -615,7 +707,9 @@ double DecisionTree<FitnessFunction,
     const size_t minimumLeafSize,
     const double minimumGainSplit,
     const size_t maximumDepth,
-    DimensionSelectionType& dimensionSelector)
+    DimensionSelectionType& dimensionSelector,
+    DeferredSubtrees* subtrees,
+    Histogram* histogram)
 {
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
@@ -632,53 +726,17 @@ double DecisionTree<FitnessFunction,
       numClasses,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = datasetInfo.Dimensionality(); // This means "no split".
-  const size_t end = dimensionSelector.End();
+
+  // The histograms of this node, from its parent or built by FindSplit().
+  Histogram nodeHistogram;
+  if (histogram != NULL)
+    nodeHistogram = std::move(*histogram);
 
   if (maximumDepth != 1)
   {
-    for (size_t i = dimensionSelector.Begin(); i != end;
-         i = dimensionSelector.Next())
-    {
-      double dimGain = -DBL_MAX;
-      if (datasetInfo.Type(i) == data::Datatype::categorical)
-      {
-        dimGain = CategoricalSplit::template SplitIfBetter<UseWeights>(bestGain,
-            data.cols(begin, begin + count - 1).row(i),
-            datasetInfo.NumMappings(i),
-            labels.subvec(begin, begin + count - 1),
-            numClasses,
-            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-            minimumLeafSize,
-            minimumGainSplit,
-            classProbabilities,
-            *this);
-      }
-      else if (datasetInfo.Type(i) == data::Datatype::numeric)
-      {
-        dimGain = NumericSplit::template SplitIfBetter<UseWeights>(bestGain,
-            data.cols(begin, begin + count - 1).row(i),
-            labels.subvec(begin, begin + count - 1),
-            numClasses,
-            UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
-            minimumLeafSize,
-            minimumGainSplit,
-            classProbabilities,
-            *this);
-      }
-
-      // If the splitter reported that it did not split, move to the next
-      // dimension.
-      if (dimGain == DBL_MAX)
-        continue;
-
-      // Was there an improvement?  If so mark that it's the new best dimension.
-      bestDim = i;
-      bestGain = dimGain;
-
-      // If the gain is the best possible, no need to keep looking.
-      if (bestGain >= 0.0)
-        break;
-    }
+    FindSplit<UseWeights>(data, begin, count, &datasetInfo, labels, numClasses,
+        weights, minimumLeafSize, minimumGainSplit, dimensionSelector,
+        nodeHistogram, bestGain, bestDim);
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -723,11 +781,12 @@ double DecisionTree<FitnessFunction,
     }
 
     // Split into children.
+    arma::Row<size_t> childBegins(numChildren);
     size_t currentCol = begin;
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = currentCol; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -739,23 +798,41 @@ double DecisionTree<FitnessFunction,
           ++currentCol;
         }
       }
+    }
 
-      // Now build the child recursively.
+    // If this node has histograms, so do the children that will be split.
+    std::vector<Histogram> childHistograms(numChildren);
+    if (!NoRecursion && maximumDepth != 2 && !nodeHistogram.counts.is_empty() &&
+        !(subtrees && childCounts.max() <= subtrees->maxPoints))
+    {
+      ChildHistograms<UseWeights>(data, childBegins, childCounts, labels,
+          numClasses, weights, nodeHistogram, childHistograms);
+    }
+
+    // Now build the children recursively.
+    for (size_t i = 0; i < numChildren; ++i)
+    {
       DecisionTree* child = new DecisionTree();
       if (NoRecursion)
       {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, currentCol - currentChildBegin, minimumGainSplit,
-            maximumDepth - 1, dimensionSelector);
+        child->Train<UseWeights>(data, childBegins[i], childCounts[i],
+            datasetInfo, labels, numClasses, weights, childCounts[i],
+            minimumGainSplit, maximumDepth - 1, dimensionSelector);
+      }
+      else if (subtrees && childCounts[i] <= subtrees->maxPoints)
+      {
+        // Build this subtree later, in parallel with the others.  Its gain is
+        // added by TrainRoot().
+        subtrees->pending.push_back(Subtree(child, childBegins[i],
+            childCounts[i], maximumDepth - 1));
       }
       else
       {
         // During recursion entropy of child node may change.
-        double childGain = child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, datasetInfo, labels, numClasses,
-            weights, minimumLeafSize, minimumGainSplit, maximumDepth - 1,
-            dimensionSelector);
+        double childGain = child->Train<UseWeights>(data, childBegins[i],
+            childCounts[i], datasetInfo, labels, numClasses, weights,
+            minimumLeafSize, minimumGainSplit, maximumDepth - 1,
+            dimensionSelector, subtrees, &childHistograms[i]);
         bestGain += double(childCounts[i]) / double(count) * (-childGain);
       }
       children.push_back(child);
@@ -798,7 +875,9 @@ double DecisionTree<FitnessFunction,
     const size_t minimumLeafSize,
     const double minimumGainSplit,
     const size_t maximumDepth,
-    DimensionSelectionType& dimensionSelector)
+    DimensionSelectionType& dimensionSelector,
+    DeferredSubtrees* subtrees,
+    Histogram* histogram)
 {
   // Clear children if needed.
   for (size_t i = 0; i < children.size(); ++i)
@@ -819,36 +898,16 @@ double DecisionTree<FitnessFunction,
       UseWeights ? weights.subvec(begin, begin + count - 1) : weights);
   size_t bestDim = data.n_rows; // This means "no split".
 
+  // The histograms of this node, from its parent or built by FindSplit().
+  Histogram nodeHistogram;
+  if (histogram != NULL)
+    nodeHistogram = std::move(*histogram);
+
   if (maximumDepth != 1)
   {
-    for (size_t i = dimensionSelector.Begin(); i != dimensionSelector.End();
-         i = dimensionSelector.Next())
-    {
-      const double dimGain = NumericSplitType<FitnessFunction>::template
-          SplitIfBetter<UseWeights>(bestGain,
-                                    data.cols(begin, begin + count - 1).row(i),
-                                    labels.cols(begin, begin + count - 1),
-                                    numClasses,
-                                    UseWeights ?
-                                        weights.cols(begin, begin + count - 1) :
-                                        weights,
-                                    minimumLeafSize,
-                                    minimumGainSplit,
-                                    classProbabilities,
-                                    *this);
-
-      // If the splitter did not report that it improved, then move to the next
-      // dimension.
-      if (dimGain == DBL_MAX)
-        continue;
-
-      bestDim = i;
-      bestGain = dimGain;
-
-      // If the gain is the best possible, no need to keep looking.
-      if (bestGain >= 0.0)
-        break;
-    }
+    FindSplit<UseWeights>(data, begin, count, NULL, labels, numClasses,
+        weights, minimumLeafSize, minimumGainSplit, dimensionSelector,
+        nodeHistogram, bestGain, bestDim);
   }
 
   // Did we split or not?  If so, then split the data and create the children.
@@ -880,11 +939,13 @@ double DecisionTree<FitnessFunction,
       bestGain = 0.0;
     }
 
+    // Split into children.
+    arma::Row<size_t> childBegins(numChildren);
     size_t currentCol = begin;
     for (size_t i = 0; i < numChildren; ++i)
     {
-      size_t currentChildBegin = currentCol;
-      for (size_t j = currentChildBegin; j < begin + count; ++j)
+      childBegins[i] = currentCol;
+      for (size_t j = currentCol; j < begin + count; ++j)
       {
         if (childAssignments[j - begin] == i)
         {
@@ -896,23 +957,41 @@ double DecisionTree<FitnessFunction,
           ++currentCol;
         }
       }
+    }
+
+    // If this node has histograms, so do the children that will be split.
+    std::vector<Histogram> childHistograms(numChildren);
+    if (!NoRecursion && maximumDepth != 2 && !nodeHistogram.counts.is_empty() &&
+        !(subtrees && childCounts.max() <= subtrees->maxPoints))
+    {
+      ChildHistograms<UseWeights>(data, childBegins, childCounts, labels,
+          numClasses, weights, nodeHistogram, childHistograms);
+    }
 
-      // Now build the child recursively.
+    // Now build the children recursively.
+    for (size_t i = 0; i < numChildren; ++i)
+    {
       DecisionTree* child = new DecisionTree();
       if (NoRecursion)
       {
-        child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            currentCol - currentChildBegin, minimumGainSplit, maximumDepth - 1,
-            dimensionSelector);
+        child->Train<UseWeights>(data, childBegins[i], childCounts[i], labels,
+            numClasses, weights, childCounts[i], minimumGainSplit,
+            maximumDepth - 1, dimensionSelector);
+      }
+      else if (subtrees && childCounts[i] <= subtrees->maxPoints)
+      {
+        // Build this subtree later, in parallel with the others.  Its gain is
+        // added by TrainRoot().
+        subtrees->pending.push_back(Subtree(child, childBegins[i],
+            childCounts[i], maximumDepth - 1));
       }
       else
       {
         // During recursion entropy of child node may change.
-        double childGain = child->Train<UseWeights>(data, currentChildBegin,
-            currentCol - currentChildBegin, labels, numClasses, weights,
-            minimumLeafSize, minimumGainSplit, maximumDepth - 1,
-            dimensionSelector);
+        double childGain = child->Train<UseWeights>(data, childBegins[i],
+            childCounts[i], labels, numClasses, weights, minimumLeafSize,
+            minimumGainSplit, maximumDepth - 1, dimensionSelector, subtrees,
+            &childHistograms[i]);
         bestGain += double(childCounts[i]) / double(count) * (-childGain);
       }
       children.push_back(child);
@@ -1003,7 +1082,8 @@ void DecisionTree<FitnessFunction,
   }
 
   // Loop over each point.
-  for (size_t i = 0; i < data.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
     predictions[i] = Classify(data.col(i));
 }
 
@@ -1037,7 +1117,8 @@ void DecisionTree<FitnessFunction,
     node = &node->Child(0);
   probabilities.set_size(node->classProbabilities.n_elem, data.n_cols);
 
-  for (size_t i = 0; i < data.n_cols; ++i)
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_cols; ++i)
   {
     arma::vec v = probabilities.unsafe_col(i); // Alias of column.
     Classify(data.col(i), predictions[i], v);
@@ -1152,6 +1233,380 @@ void DecisionTree<FitnessFunction,
   dimensionTypeOrMajorityClass = (size_t) maxIndex;
 }
 
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         bool NoRecursion>
+template<typename MatType, typename SplitType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  NoRecursion>::BinData(
+    const MatType& data,
+    const data::DatasetInfo& datasetInfo,
+    arma::Mat<unsigned char>& bins,
+    std::vector<arma::vec>& splitPoints,
+    const std::enable_if_t<NumericSplitTraits<SplitType>::UsesBins>*)
+{
+  static_assert(SplitType::MaxBins <= 256, "The bin indices must fit in an "
+      "unsigned char.");
+
+  // Categorical values are kept as they are, so they must fit too.
+  for (size_t i = 0; i < data.n_rows; ++i)
+  {
+    if (datasetInfo.Type(i) == data::Datatype::categorical &&
+        datasetInfo.NumMappings(i) > 256)
+    {
+      std::ostringstream oss;
+      oss << "DecisionTree::BinData(): categorical dimension " << i << " has "
+          << datasetInfo.NumMappings(i) << " categories, but at most 256 are "
+          << "supported when the numeric split type works on bins!";
+      throw std::invalid_argument(oss.str());
+    }
+  }
+
+  // Each dimension is binned on its own.
+  bins.set_size(data.n_rows, data.n_cols);
+  splitPoints.resize(data.n_rows);
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) data.n_rows; ++i)
+  {
+    if (datasetInfo.Type(i) == data::Datatype::numeric)
+    {
+      arma::Row<unsigned char> dimensionBins;
+      SplitType::BinDimension(data.row(i), dimensionBins, splitPoints[i]);
+      bins.row(i) = dimensionBins;
+    }
+    else
+    {
+      bins.row(i) = arma::conv_to<arma::Row<unsigned char>>::from(
+          data.row(i));
+    }
+  }
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         bool NoRecursion>
+template<typename SplitType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  NoRecursion>::UnbinSplits(
+    const std::vector<arma::vec>& splitPoints,
+    const std::enable_if_t<NumericSplitTraits<SplitType>::UsesBins>*)
+{
+  if (children.size() == 0)
+    return;
+
+  if (dimensionTypeOrMajorityClass == (size_t) data::Datatype::numeric)
+    SplitType::UnbinSplit(splitPoints[splitDimension], classProbabilities,
+        *this);
+
+  for (size_t i = 0; i < children.size(); ++i)
+    children[i]->UnbinSplits(splitPoints);
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         bool NoRecursion>
+template<bool UseWeights, typename MatType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    NoRecursion>::TrainRoot(
+    MatType& data,
+    const data::DatasetInfo* datasetInfo,
+    arma::Row<size_t>& labels,
+    const size_t numClasses,
+    arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType& dimensionSelector)
+{
+  // Subtrees with few enough points are set aside while the top of the tree is
+  // built, and then built in parallel.  Which subtrees are set aside only
+  // depends on the number of points, so the tree is the same for any number of
+  // threads.
+  DeferredSubtrees subtrees;
+  subtrees.maxPoints = data.n_cols / 64;
+  DeferredSubtrees* deferred = (ParallelSubtrees && data.n_cols >= 4096) ?
+      &subtrees : NULL;
+
+  double gain = (datasetInfo != NULL) ?
+      Train<UseWeights>(data, 0, data.n_cols, *datasetInfo, labels, numClasses,
+          weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+          dimensionSelector, deferred) :
+      Train<UseWeights>(data, 0, data.n_cols, labels, numClasses, weights,
+          minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector,
+          deferred);
+
+  // Each subtree only touches its own points.
+  const std::vector<Subtree>& pending = subtrees.pending;
+  arma::vec subtreeGains(pending.size());
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t i = 0; i < (omp_size_t) pending.size(); ++i)
+  {
+    // The dimension selector keeps state, so each subtree needs its own.
+    DimensionSelectionType subtreeSelector(dimensionSelector);
+    const Subtree& subtree = pending[i];
+    subtreeGains[i] = (datasetInfo != NULL) ?
+        subtree.node->template Train<UseWeights>(data, subtree.begin,
+            subtree.count, *datasetInfo, labels, numClasses, weights,
+            minimumLeafSize, minimumGainSplit, subtree.maximumDepth,
+            subtreeSelector) :
+        subtree.node->template Train<UseWeights>(data, subtree.begin,
+            subtree.count, labels, numClasses, weights, minimumLeafSize,
+            minimumGainSplit, subtree.maximumDepth, subtreeSelector);
+  }
+
+  // Each subtree contributes to the gain of the tree in proportion to its
+  // number of points, as it would have through its ancestors.
+  for (size_t i = 0; i < pending.size(); ++i)
+    gain += double(pending[i].count) / double(data.n_cols) * subtreeGains[i];
+
+  return gain;
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         bool NoRecursion>
+template<bool UseWeights, typename MatType, typename SplitType>
+double DecisionTree<FitnessFunction,
+                    NumericSplitType,
+                    CategoricalSplitType,
+                    DimensionSelectionType,
+                    NoRecursion>::TrainBins(
+    MatType& data,
+    const data::DatasetInfo* datasetInfo,
+    arma::Row<size_t>& labels,
+    const size_t numClasses,
+    arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    const size_t maximumDepth,
+    DimensionSelectionType& dimensionSelector,
+    const std::enable_if_t<NumericSplitTraits<SplitType>::UsesBins>*)
+{
+  // Without a DatasetInfo, all dimensions are numeric.
+  const data::DatasetInfo numericInfo((datasetInfo != NULL) ? 0 : data.n_rows);
+  arma::Mat<unsigned char> bins;
+  std::vector<arma::vec> splitPoints;
+  BinData(data, (datasetInfo != NULL) ? *datasetInfo : numericInfo, bins,
+      splitPoints);
+
+  // Only the bins are needed from here on.
+  data.reset();
+
+  const double gain = TrainRoot<UseWeights>(bins, datasetInfo, labels,
+      numClasses, weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+      dimensionSelector);
+
+  UnbinSplits(splitPoints);
+  return gain;
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         bool NoRecursion>
+template<bool UseWeights, typename MatType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  NoRecursion>::FindSplit(
+    MatType& data,
+    const size_t begin,
+    const size_t count,
+    const data::DatasetInfo* datasetInfo,
+    arma::Row<size_t>& labels,
+    const size_t numClasses,
+    arma::rowvec& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    DimensionSelectionType& dimensionSelector,
+    Histogram& histogram,
+    double& bestGain,
+    size_t& bestDim)
+{
+  // Collect the candidate dimensions first, so that the dimension selector is
+  // used in the same way however the dimensions are evaluated.
+  std::vector<size_t> dimensions;
+  for (size_t i = dimensionSelector.Begin(); i != dimensionSelector.End();
+       i = dimensionSelector.Next())
+  {
+    dimensions.push_back(i);
+  }
+
+  // If the numeric split works on bins, the histograms of the node give the
+  // splits of all its numeric dimensions, and the histograms of its children
+  // then cost little to find.  Otherwise each candidate dimension is counted
+  // on its own, which is cheaper when few dimensions are candidates.
+  if (histogram.counts.is_empty() && 2 * dimensions.size() >= data.n_rows)
+  {
+    BuildHistogram<UseWeights>(data, begin, count, labels, numClasses,
+        weights, histogram);
+  }
+
+  // Each dimension gets its own split information, since they may be
+  // evaluated at the same time.
+  std::vector<double> gains(dimensions.size(), DBL_MAX);
+  std::vector<arma::vec> splitInfo(dimensions.size());
+  std::vector<NumericAuxiliarySplitInfo> numericAux(dimensions.size());
+  std::vector<CategoricalAuxiliarySplitInfo> categoricalAux(
+      dimensions.size());
+
+  // Evaluate dimension k, keeping its split only if its gain is better than
+  // the given gain by at least minimumGainSplit.
+  auto evaluate = [&](const size_t k, const double gain)
+  {
+    const size_t i = dimensions[k];
+    if (datasetInfo != NULL &&
+        datasetInfo->Type(i) == data::Datatype::categorical)
+    {
+      gains[k] = CategoricalSplit::template SplitIfBetter<UseWeights>(gain,
+          data.cols(begin, begin + count - 1).row(i),
+          datasetInfo->NumMappings(i),
+          labels.subvec(begin, begin + count - 1),
+          numClasses,
+          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+          minimumLeafSize,
+          minimumGainSplit,
+          splitInfo[k],
+          categoricalAux[k]);
+    }
+    else if (!histogram.counts.is_empty())
+    {
+      gains[k] = SplitHistogramIfBetter<UseWeights>(gain, histogram, i,
+          numClasses, minimumLeafSize, minimumGainSplit, splitInfo[k],
+          numericAux[k]);
+    }
+    else
+    {
+      gains[k] = NumericSplit::template SplitIfBetter<UseWeights>(gain,
+          data.cols(begin, begin + count - 1).row(i),
+          labels.subvec(begin, begin + count - 1),
+          numClasses,
+          UseWeights ? weights.subvec(begin, begin + count - 1) : weights,
+          minimumLeafSize,
+          minimumGainSplit,
+          splitInfo[k],
+          numericAux[k]);
+    }
+  };
+
+  // A dimension is only taken if its gain beats the best gain found in the
+  // dimensions before it by minimumGainSplit, so with a positive
+  // minimumGainSplit a later dimension that is only slightly better does not
+  // replace an earlier one.
+  size_t best = dimensions.size();
+  if (!NumericSplitTraits<NumericSplit>::UsesRandomness &&
+      count * dimensions.size() >= 16384)
+  {
+    // Large nodes are split in parallel over the dimensions (unless the numeric
+    // split draws random numbers, which must be drawn in a fixed order).  Each
+    // dimension is compared with the gain of the node itself, and then the
+    // dimensions are taken in order with the same rule as below.  This does not
+    // depend on the order of evaluation, so the tree is the same for any number
+    // of threads.
+    const double nodeGain = bestGain;
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t k = 0; k < (omp_size_t) dimensions.size(); ++k)
+      evaluate(k, nodeGain);
+
+    for (size_t k = 0; k < dimensions.size(); ++k)
+    {
+      // If the splitter reported that it did not split, skip the dimension.
+      if (gains[k] == DBL_MAX || gains[k] <= bestGain + minimumGainSplit)
+        continue;
+
+      best = k;
+      bestGain = gains[k];
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain >= 0.0)
+        break;
+    }
+  }
+  else
+  {
+    for (size_t k = 0; k < dimensions.size(); ++k)
+    {
+      evaluate(k, bestGain);
+
+      // If the splitter reported that it did not split, move to the next
+      // dimension.
+      if (gains[k] == DBL_MAX)
+        continue;
+
+      best = k;
+      bestGain = gains[k];
+
+      // If the gain is the best possible, no need to keep looking.
+      if (bestGain >= 0.0)
+        break;
+    }
+  }
+
+  if (best == dimensions.size())
+    return;
+
+  bestDim = dimensions[best];
+  classProbabilities = std::move(splitInfo[best]);
+  NumericAuxiliarySplitInfo::operator=(numericAux[best]);
+  CategoricalAuxiliarySplitInfo::operator=(categoricalAux[best]);
+}
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         bool NoRecursion>
+template<bool UseWeights, typename MatType>
+void DecisionTree<FitnessFunction,
+                  NumericSplitType,
+                  CategoricalSplitType,
+                  DimensionSelectionType,
+                  NoRecursion>::ChildHistograms(
+    const MatType& data,
+    const arma::Row<size_t>& childBegins,
+    const arma::Row<size_t>& childCounts,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const arma::rowvec& weights,
+    Histogram& histogram,
+    std::vector<Histogram>& childHistograms)
+{
+  const size_t largest = childCounts.index_max();
+  childHistograms.resize(childCounts.n_elem);
+  for (size_t i = 0; i < childCounts.n_elem; ++i)
+  {
+    if (i == largest || childCounts[i] == 0)
+      continue;
+
+    BuildHistogram<UseWeights>(data, childBegins[i], childCounts[i], labels,
+        numClasses, weights, childHistograms[i]);
+    histogram.counts -= childHistograms[i].counts;
+    if (UseWeights)
+      histogram.weights -= childHistograms[i].weights;
+  }
+
+  childHistograms[largest] = std::move(histogram);
+}
+
 } // namespace tree
 } // namespace mlpack
 
@@ -0,0 +1,226 @@
+/**
+ * @file methods/decision_tree/histogram_numeric_split.hpp
+ *
+ * A tree splitter that finds the best binary numeric split from histograms of
+ * pre-binned data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "numeric_split_traits.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The HistogramNumericSplit is a splitting function for decision trees that
+ * finds the best binary split of a numeric dimension among the boundaries of
+ * at most MaxBins quantile bins.
+ *
+ * Each numeric dimension of the training data is binned once, before the tree
+ * is built (see NumericSplitTraits): its values are sorted, cut into bins of
+ * about the same number of points (equal values always share a bin), and
+ * replaced with their bin index in an arma::Mat<unsigned char>.  A split is
+ * then found from the class histogram of the bins of a dimension, so no
+ * sorting is done during training and each candidate dimension costs
+ * O(n + MaxBins * numClasses) instead of O(n log n).
+ *
+ * When most dimensions are candidates at each node, DecisionTree builds the
+ * histograms of all the dimensions of a node at once with BuildHistogram(),
+ * and finds the split of each dimension with SplitHistogramIfBetter().  The
+ * histograms of the children are then found by counting the points of all the
+ * children but the largest; the histograms of the largest child are what is
+ * left of the histograms of its parent once the others are subtracted.
+ *
+ * When a dimension has at most MaxBins distinct values, every value gets its
+ * own bin and the splits found are the same as with BestBinaryNumericSplit.
+ * Otherwise only the bin boundaries are considered.  The split points stored
+ * in the tree are halfway between the largest value of a bin and the smallest
+ * value of the next, as with BestBinaryNumericSplit.
+ *
+ * This can be used with DecisionTree and RandomForest in place of
+ * BestBinaryNumericSplit:
+ *
+ * @code
+ * DecisionTree<GiniGain, HistogramNumericSplit> tree(data, labels, 3);
+ * RandomForest<GiniGain, MultipleRandomDimensionSelect,
+ *     HistogramNumericSplit> forest(data, labels, 3, 20);
+ * @endcode
+ *
+ * @tparam FitnessFunction Fitness function to use to calculate gain.
+ */
+template<typename FitnessFunction>
+class HistogramNumericSplit
+{
+ public:
+  //! The maximum number of bins of a dimension.
+  static const size_t MaxBins = 256;
+
+  // No extra info needed for split.
+  class AuxiliarySplitInfo { };
+
+  /**
+   * Check if we can split a node.  If we can split a node in a way that
+   * improves on 'bestGain', then we return the improved gain.  Otherwise we
+   * return DBL_MAX.  If a split is made, then classProbabilities holds the
+   * split point, in bin indices.
+   *
+   * @param bestGain Best gain seen so far (we'll only split if we find gain
+   *      better than this).
+   * @param data The bin indices of the points to check for a split in.
+   * @param labels Labels for each point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights associated with labels.
+   * @param minimumLeafSize Minimum number of points in a leaf node for
+   *      splitting.
+   * @param minimumGainSplit Minimum gain split.
+   * @param classProbabilities Class probabilities vector, which may be filled
+   *      with split information a successful split.
+   * @param aux Auxiliary split information, which may be modified on a
+   *      successful split.
+   */
+  template<bool UseWeights, typename VecType, typename WeightVecType>
+  static double SplitIfBetter(
+      const double bestGain,
+      const VecType& data,
+      const arma::Row<size_t>& labels,
+      const size_t numClasses,
+      const WeightVecType& weights,
+      const size_t minimumLeafSize,
+      const double minimumGainSplit,
+      arma::vec& classProbabilities,
+      AuxiliarySplitInfo& aux);
+
+  /**
+   * Check if we can split a node, as SplitIfBetter() does, from the class
+   * histogram of the bins of one dimension of the points of the node, as
+   * built by BuildHistogram().
+   *
+   * @param bestGain Best gain seen so far (we'll only split if we find gain
+   *      better than this).
+   * @param counts Number of points of each class (row) in each bin (column)
+   *      of each dimension (slice).
+   * @param weightSums Total weight of the points of each class in each bin of
+   *      each dimension (only used if UseWeights is true).
+   * @param dimension Dimension to check for a split in.
+   * @param numClasses Number of classes in the dataset.
+   * @param minimumLeafSize Minimum number of points in a leaf node for
+   *      splitting.
+   * @param minimumGainSplit Minimum gain split.
+   * @param classProbabilities Class probabilities vector, which may be filled
+   *      with split information a successful split.
+   * @param aux Auxiliary split information, which may be modified on a
+   *      successful split.
+   */
+  template<bool UseWeights>
+  static double SplitHistogramIfBetter(
+      const double bestGain,
+      const arma::Cube<size_t>& counts,
+      const arma::cube& weightSums,
+      const size_t dimension,
+      const size_t numClasses,
+      const size_t minimumLeafSize,
+      const double minimumGainSplit,
+      arma::vec& classProbabilities,
+      AuxiliarySplitInfo& aux);
+
+  /**
+   * Build the class histogram of the bins of every dimension of the given
+   * points.  Large sets of points are counted in parallel.
+   *
+   * @param data The bin indices of the points (one point per column).
+   * @param begin Index of the first point to count.
+   * @param count Number of points to count.
+   * @param labels Labels for each point.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights for each point (only used if UseWeights is true).
+   * @param counts Set to the number of points of each class (row) in each bin
+   *      (column) of each dimension (slice).
+   * @param weightSums Set to the total weight of the points of each class in
+   *      each bin of each dimension, if UseWeights is true.
+   */
+  template<bool UseWeights, typename MatType, typename WeightVecType>
+  static void BuildHistogram(const MatType& data,
+                             const size_t begin,
+                             const size_t count,
+                             const arma::Row<size_t>& labels,
+                             const size_t numClasses,
+                             const WeightVecType& weights,
+                             arma::Cube<size_t>& counts,
+                             arma::cube& weightSums);
+
+  /**
+   * Returns 2, since the binary split always has two children.
+   */
+  static size_t NumChildren(const arma::vec& /* classProbabilities */,
+                            const AuxiliarySplitInfo& /* aux */)
+  {
+    return 2;
+  }
+
+  /**
+   * Given a point, calculate which child it should go to (left or right).
+   *
+   * @param point Point to calculate direction of.
+   * @param classProbabilities Auxiliary information for the split.
+   * @param * (aux) Auxiliary information for the split (Unused).
+   */
+  template<typename ElemType>
+  static size_t CalculateDirection(
+      const ElemType& point,
+      const arma::vec& classProbabilities,
+      const AuxiliarySplitInfo& /* aux */);
+
+  /**
+   * Find the bin index of each of the given values of one dimension, and store
+   * the split point between each bin and the next in splitPoints.
+   *
+   * @param values Values of the dimension to bin.
+   * @param bins Set to the bin index of each value.
+   * @param splitPoints Vector to store the split points between bins in.
+   */
+  template<typename RowType>
+  static void BinDimension(const RowType& values,
+                           arma::Row<unsigned char>& bins,
+                           arma::vec& splitPoints);
+
+  /**
+   * Turn a split point found by SplitIfBetter() on bin indices into a split
+   * point on the values of the dimension.
+   *
+   * @param splitPoints Split points between bins, from BinDimension().
+   * @param classProbabilities Split information to convert.
+   * @param * (aux) Auxiliary information for the split (Unused).
+   */
+  static void UnbinSplit(const arma::vec& splitPoints,
+                         arma::vec& classProbabilities,
+                         AuxiliarySplitInfo& /* aux */)
+  {
+    // The split point is halfway between two bin indices.
+    classProbabilities[0] = splitPoints[(size_t) classProbabilities[0]];
+  }
+};
+
+//! HistogramNumericSplit works on bin indices.
+template<typename FitnessFunction>
+class NumericSplitTraits<HistogramNumericSplit<FitnessFunction>>
+{
+ public:
+  static const bool UsesBins = true;
+  static const bool UsesRandomness = false;
+  static const bool UsesThreshold = true;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "histogram_numeric_split_impl.hpp"
+
+#endif
@@ -0,0 +1,299 @@
+/**
+ * @file methods/decision_tree/histogram_numeric_split_impl.hpp
+ *
+ * Implementation of strategy that finds the best binary numeric split from
+ * histograms of pre-binned data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+#define MLPACK_METHODS_DECISION_TREE_HISTOGRAM_NUMERIC_SPLIT_IMPL_HPP
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction>
+template<bool UseWeights, typename VecType, typename WeightVecType>
+double HistogramNumericSplit<FitnessFunction>::SplitIfBetter(
+    const double bestGain,
+    const VecType& data,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const WeightVecType& weights,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    arma::vec& classProbabilities,
+    AuxiliarySplitInfo& /* aux */)
+{
+  // First sanity check: if we don't have enough points, we can't split.
+  if (data.n_elem < (minimumLeafSize * 2))
+    return DBL_MAX;
+  if (bestGain == 0.0)
+    return DBL_MAX; // It can't be outperformed.
+
+  // Build the histogram of the bins of this dimension.
+  arma::Cube<size_t> counts(numClasses, MaxBins, 1, arma::fill::zeros);
+  arma::cube weightSums;
+  if (UseWeights)
+    weightSums.zeros(numClasses, MaxBins, 1);
+
+  for (size_t i = 0; i < data.n_elem; ++i)
+  {
+    const size_t bin = (size_t) data[i];
+    ++counts(labels[i], bin, 0);
+    if (UseWeights)
+      weightSums(labels[i], bin, 0) += weights[i];
+  }
+
+  return SplitHistogramIfBetter<UseWeights>(bestGain, counts, weightSums, 0,
+      numClasses, minimumLeafSize, minimumGainSplit, classProbabilities, aux);
+}
+
+template<typename FitnessFunction>
+template<bool UseWeights>
+double HistogramNumericSplit<FitnessFunction>::SplitHistogramIfBetter(
+    const double bestGain,
+    const arma::Cube<size_t>& counts,
+    const arma::cube& weightSums,
+    const size_t dimension,
+    const size_t numClasses,
+    const size_t minimumLeafSize,
+    const double minimumGainSplit,
+    arma::vec& classProbabilities,
+    AuxiliarySplitInfo& /* aux */)
+{
+  const arma::Mat<size_t>& binCounts = counts.slice(dimension);
+  const arma::mat* binWeights = UseWeights ? &weightSums.slice(dimension) :
+      NULL;
+  const arma::Row<size_t> binPoints = arma::sum(binCounts, 0);
+  const size_t n = arma::accu(binPoints);
+
+  // First sanity check: if we don't have enough points, we can't split.
+  if (n < (minimumLeafSize * 2))
+    return DBL_MAX;
+  if (bestGain == 0.0)
+    return DBL_MAX; // It can't be outperformed.
+
+  // Sanity check: if all points are in the same bin, we can't split in this
+  // dimension.
+  const arma::uvec usedBins = arma::find(binPoints);
+  if (usedBins.n_elem < 2)
+    return DBL_MAX;
+  const size_t minBin = usedBins[0];
+  const size_t maxBin = usedBins[usedBins.n_elem - 1];
+
+  // Loop through all bin boundaries, choosing the best one.  Also, force a
+  // minimum leaf size of 1 (empty children don't make sense).
+  double bestFoundGain = std::min(bestGain + minimumGainSplit, 0.0);
+  bool improved = false;
+  const size_t minimum = std::max(minimumLeafSize, (size_t) 1);
+
+  // Column 0 holds the points to the left of the boundary, and column 1 the
+  // points to the right.  At first, all points are on the right.
+  arma::Mat<size_t> classCounts;
+  arma::mat classWeightSums;
+  double totalWeight = 0.0;
+  double totalLeftWeight = 0.0;
+  double totalRightWeight = 0.0;
+  if (UseWeights)
+  {
+    classWeightSums.zeros(numClasses, 2);
+    classWeightSums.col(1) = arma::sum(*binWeights, 1);
+    totalWeight = arma::accu(classWeightSums.col(1));
+    totalRightWeight = totalWeight;
+    bestFoundGain *= totalWeight;
+  }
+  else
+  {
+    classCounts.zeros(numClasses, 2);
+    classCounts.col(1) = arma::sum(binCounts, 1);
+    bestFoundGain *= n;
+  }
+
+  size_t leftPoints = 0;
+  for (size_t bin = minBin; bin < maxBin; ++bin)
+  {
+    // An empty bin does not change the split.
+    if (binPoints[bin] == 0)
+      continue;
+
+    // Move the points of this bin to the left.
+    if (UseWeights)
+    {
+      const double binWeight = arma::accu(binWeights->col(bin));
+      classWeightSums.col(0) += binWeights->col(bin);
+      classWeightSums.col(1) -= binWeights->col(bin);
+      totalLeftWeight += binWeight;
+      totalRightWeight -= binWeight;
+    }
+    else
+    {
+      classCounts.col(0) += binCounts.col(bin);
+      classCounts.col(1) -= binCounts.col(bin);
+    }
+    leftPoints += binPoints[bin];
+
+    // Make sure that both children are large enough.
+    if (leftPoints < minimum)
+      continue;
+    if (n - leftPoints < minimum)
+      break;
+
+    // Calculate the gain for the left and right child.  Only use weights if
+    // needed.
+    const double leftGain = UseWeights ?
+        FitnessFunction::template EvaluatePtr<true>(classWeightSums.colptr(0),
+            numClasses, totalLeftWeight) :
+        FitnessFunction::template EvaluatePtr<false>(classCounts.colptr(0),
+            numClasses, leftPoints);
+    const double rightGain = UseWeights ?
+        FitnessFunction::template EvaluatePtr<true>(classWeightSums.colptr(1),
+            numClasses, totalRightWeight) :
+        FitnessFunction::template EvaluatePtr<false>(classCounts.colptr(1),
+            numClasses, size_t(n - leftPoints));
+
+    double gain;
+    if (UseWeights)
+    {
+      gain = totalLeftWeight * leftGain + totalRightWeight * rightGain;
+    }
+    else
+    {
+      // Calculate the gain at this split point.
+      gain = double(leftPoints) * leftGain +
+          double(n - leftPoints) * rightGain;
+    }
+
+    // Corner case: is this the best possible split?
+    if (gain >= 0.0)
+    {
+      // We can take a shortcut: no split will be better than this, so just take
+      // this one.  The split point is halfway between this bin and the next.
+      classProbabilities.set_size(1);
+      classProbabilities[0] = bin + 0.5;
+
+      return gain;
+    }
+    else if (gain > bestFoundGain)
+    {
+      // We still have a better split.
+      bestFoundGain = gain;
+      classProbabilities.set_size(1);
+      classProbabilities[0] = bin + 0.5;
+      improved = true;
+    }
+  }
+
+  // If we didn't improve, return the original gain exactly as we got it
+  // (without introducing floating point errors).
+  if (!improved)
+    return DBL_MAX;
+
+  if (UseWeights)
+    bestFoundGain /= totalWeight;
+  else
+    bestFoundGain /= n;
+
+  return bestFoundGain;
+}
+
+template<typename FitnessFunction>
+template<typename ElemType>
+size_t HistogramNumericSplit<FitnessFunction>::CalculateDirection(
+    const ElemType& point,
+    const arma::vec& classProbabilities,
+    const AuxiliarySplitInfo& /* aux */)
+{
+  if (point <= classProbabilities[0])
+    return 0; // Go left.
+  else
+    return 1; // Go right.
+}
+
+template<typename FitnessFunction>
+template<bool UseWeights, typename MatType, typename WeightVecType>
+void HistogramNumericSplit<FitnessFunction>::BuildHistogram(
+    const MatType& data,
+    const size_t begin,
+    const size_t count,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const WeightVecType& weights,
+    arma::Cube<size_t>& counts,
+    arma::cube& weightSums)
+{
+  const size_t dimensions = data.n_rows;
+  counts.zeros(numClasses, MaxBins, dimensions);
+  if (UseWeights)
+    weightSums.zeros(numClasses, MaxBins, dimensions);
+
+  // Each thread counts a block of dimensions, going through the points in
+  // order so that the part of each point it needs is read at once.
+  const size_t blockSize = 16;
+  const size_t blocks = (dimensions + blockSize - 1) / blockSize;
+  #pragma omp parallel for if (count * dimensions >= 16384)
+  for (omp_size_t b = 0; b < (omp_size_t) blocks; ++b)
+  {
+    const size_t first = b * blockSize;
+    const size_t last = std::min(first + blockSize, dimensions);
+    for (size_t j = begin; j < begin + count; ++j)
+    {
+      for (size_t d = first; d < last; ++d)
+      {
+        const size_t bin = (size_t) data(d, j);
+        ++counts(labels[j], bin, d);
+        if (UseWeights)
+          weightSums(labels[j], bin, d) += weights[j];
+      }
+    }
+  }
+}
+
+template<typename FitnessFunction>
+template<typename RowType>
+void HistogramNumericSplit<FitnessFunction>::BinDimension(
+    const RowType& values,
+    arma::Row<unsigned char>& bins,
+    arma::vec& splitPoints)
+{
+  typedef typename RowType::elem_type ElemType;
+
+  const size_t n = values.n_elem;
+  const arma::Row<ElemType> sorted = arma::sort(values);
+
+  // Cut the sorted values into bins of about the same number of points.  The
+  // size of each bin is computed from the points that are left, so that long
+  // runs of equal values (which are never cut) do not use up the bins.
+  std::vector<ElemType> binMax;
+  std::vector<double> points;
+  size_t begin = 0;
+  while (begin < n)
+  {
+    const size_t binsLeft = MaxBins - binMax.size();
+    size_t end = begin + std::max((n - begin) / binsLeft, (size_t) 1);
+    while (end < n && sorted[end] == sorted[end - 1])
+      ++end;
+
+    if (!binMax.empty())
+      points.push_back((double(binMax.back()) + double(sorted[begin])) / 2.0);
+    binMax.push_back(sorted[end - 1]);
+    begin = end;
+  }
+  splitPoints = arma::conv_to<arma::vec>::from(points);
+
+  // The bin of a value is the first bin whose largest value is not smaller.
+  bins.set_size(n);
+  for (size_t i = 0; i < n; ++i)
+  {
+    bins[i] = (unsigned char) (std::lower_bound(binMax.begin(), binMax.end(),
+        values[i]) - binMax.begin());
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,117 @@
+/**
+ * @file methods/decision_tree/indexed_matrix.hpp
+ *
+ * A view of a subset of the columns of a matrix, given by indices, that can be
+ * used to train a DecisionTree without copying the data.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_INDEXED_MATRIX_HPP
+#define MLPACK_METHODS_DECISION_TREE_INDEXED_MATRIX_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * IndexedMatrix presents the columns of a matrix with the given indices as a
+ * matrix of its own.  An index may appear more than once, as in a bootstrap
+ * sample.  The view holds its own copy of the indices, and swap_cols() swaps
+ * indices instead of points, so that DecisionTree can reorder the points of
+ * the view while it builds the tree and the underlying matrix is never
+ * modified or copied.
+ *
+ * Only the operations that DecisionTree uses during training are provided.
+ *
+ * @tparam MatType Type of the underlying matrix.
+ */
+template<typename MatType>
+class IndexedMatrix
+{
+ public:
+  //! The type of the elements of the underlying matrix.
+  typedef typename MatType::elem_type elem_type;
+
+  /**
+   * A range of columns of an IndexedMatrix, as returned by cols().
+   */
+  class Columns
+  {
+   public:
+    //! Create the range [first, last] of the columns of the given matrix.
+    Columns(const IndexedMatrix& matrix,
+            const size_t first,
+            const size_t last) :
+        matrix(matrix), first(first), last(last) { }
+
+    //! Gather the values of the given row in this range of columns.
+    arma::Row<elem_type> row(const size_t i) const
+    {
+      arma::Row<elem_type> values(last - first + 1);
+      for (size_t j = first; j <= last; ++j)
+        values[j - first] = matrix(i, j);
+      return values;
+    }
+
+   private:
+    const IndexedMatrix& matrix;
+    const size_t first;
+    const size_t last;
+  };
+
+  /**
+   * Create a view of the columns of the given matrix with the given indices.
+   * The matrix must outlive the view.
+   *
+   * @param data Underlying matrix.
+   * @param indices Indices of the columns of the view.
+   */
+  IndexedMatrix(const MatType& data, const arma::uvec& indices) :
+      data(data),
+      indices(indices),
+      n_rows(data.n_rows),
+      n_cols(indices.n_elem)
+  { }
+
+  //! Get the element at the given row and column of the view.
+  elem_type operator()(const size_t row, const size_t col) const
+  {
+    return data(row, indices[col]);
+  }
+
+  //! Get the given range of columns of the view.
+  Columns cols(const size_t first, const size_t last) const
+  {
+    return Columns(*this, first, last);
+  }
+
+  //! Swap two columns of the view (not of the underlying matrix).
+  void swap_cols(const size_t a, const size_t b)
+  {
+    std::swap(indices[a], indices[b]);
+  }
+
+  //! Get the indices of the columns of the view, in their current order.
+  const arma::uvec& Indices() const { return indices; }
+
+ private:
+  //! The underlying matrix.
+  const MatType& data;
+  //! The indices of the columns of the view.
+  arma::uvec indices;
+
+ public:
+  //! The number of rows.
+  const size_t n_rows;
+  //! The number of columns.
+  const size_t n_cols;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file methods/decision_tree/numeric_split_traits.hpp
+ *
+ * A traits class that tells DecisionTree how a numeric split type expects to
+ * see the training data, whether it draws random numbers, and how it sends
+ * points to children.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_DECISION_TREE_NUMERIC_SPLIT_TRAITS_HPP
+#define MLPACK_METHODS_DECISION_TREE_NUMERIC_SPLIT_TRAITS_HPP
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * The NumericSplitTraits class provides information about a numeric split
+ * type.  By default, a numeric split type sees the values of the training
+ * data as they are.  Specialize this class for a split type to change that.
+ *
+ * @tparam NumericSplitType Numeric split type (with its fitness function).
+ */
+template<typename NumericSplitType>
+class NumericSplitTraits
+{
+ public:
+  /**
+   * If true, the split type works on bin indices instead of values.  Before
+   * training, DecisionTree calls NumericSplitType::BinDimension() for each
+   * numeric dimension of the training data, which gives the index of the bin
+   * of each value and the split point between each pair of adjacent bins, and
+   * trains on an arma::Mat<unsigned char> of bin indices; after training, it
+   * calls NumericSplitType::UnbinSplit() on each numeric split so that the
+   * tree works on values again.  The split type must also provide
+   * BuildHistogram() and SplitHistogramIfBetter(), which DecisionTree uses to
+   * find the splits of all the numeric dimensions of a node from the class
+   * histograms of their bins (see HistogramNumericSplit).
+   */
+  static const bool UsesBins = false;
+
+  /**
+   * If true, the split type draws random numbers, so the splits it finds
+   * depend on the order in which it is called.  DecisionTree then evaluates
+   * dimensions and builds nodes one at a time, in a fixed order.
+   */
+  static const bool UsesRandomness = false;
+
+  /**
+   * If true, CalculateDirection() sends a point to child 0 if its value is not
+   * greater than classProbabilities[0], and to child 1 otherwise.  Trees that
+   * use the split type can then be flattened for fast prediction (see
+   * FlatForest).
+   */
+  static const bool UsesThreshold = false;
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
@@ -13,6 +13,7 @@
 #define MLPACK_METHODS_DECISION_TREE_RANDOM_BINARY_NUMERIC_SPLIT_HPP
 
 #include <mlpack/prereqs.hpp>
+#include "numeric_split_traits.hpp"
 
 namespace mlpack {
 namespace tree {
@@ -115,6 +116,20 @@ class RandomBinaryNumericSplit
       const AuxiliarySplitInfo& /* aux */);
 };
 
+/**
+ * RandomBinaryNumericSplit draws its split points at random, so the nodes of a
+ * tree that uses it must be built in a fixed order.  Its splits are
+ * thresholds.
+ */
+template<typename FitnessFunction>
+class NumericSplitTraits<RandomBinaryNumericSplit<FitnessFunction>>
+{
+ public:
+  static const bool UsesBins = false;
+  static const bool UsesRandomness = true;
+  static const bool UsesThreshold = true;
+};
+
 } // namespace tree
 } // namespace mlpack
 
@@ -455,8 +455,10 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < querySet.n_cols; ++q)
+    // Simple double loop.  Stupid, slow, but a good benchmark.  Each query
+    // point is independent, so we can split them between threads.
+    #pragma omp parallel for
+    for (omp_size_t q = 0; q < (omp_size_t) querySet.n_cols; ++q)
     {
       const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
       std::vector<Candidate> cList(k, def);
@@ -592,8 +594,10 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
   // Naive implementation.
   if (naive)
   {
-    // Simple double loop.  Stupid, slow, but a good benchmark.
-    for (size_t q = 0; q < referenceSet->n_cols; ++q)
+    // Simple double loop.  Stupid, slow, but a good benchmark.  Each query
+    // point is independent, so we can split them between threads.
+    #pragma omp parallel for
+    for (omp_size_t q = 0; q < (omp_size_t) referenceSet->n_cols; ++q)
     {
       const Candidate def = std::make_pair(-DBL_MAX, size_t() - 1);
       std::vector<Candidate> cList(k, def);
@@ -601,7 +605,7 @@ void FastMKS<KernelType, MatType, TreeType>::Search(
 
       for (size_t r = 0; r < referenceSet->n_cols; ++r)
       {
-        if (q == r)
+        if ((size_t) q == r)
           continue; // Don't return the point as its own candidate.
 
         const double eval = metric.Kernel().Evaluate(referenceSet->col(q),
@@ -58,13 +58,11 @@ double DiagonalGMM::LogProbability(const arma::vec& observation) const
 {
   // Sum the probability for each Gaussian in our mixture (and we have to
   // multiply by the prior for each Gaussian too).
-  double sum = -std::numeric_limits<double>::infinity();
+  arma::vec logProbs(gaussians);
   for (size_t i = 0; i < gaussians; ++i)
-  {
-    sum = math::LogAdd(sum, log(weights[i]) +
-        dists[i].LogProbability(observation));
-  }
-  return sum;
+    logProbs[i] = dists[i].LogProbability(observation);
+
+  return math::AccuLog(arma::vec(logProbs + arma::log(weights)));
 }
 
 /**
@@ -204,24 +202,27 @@ double DiagonalGMM::LogLikelihood(
     const std::vector<distribution::DiagonalGaussianDistribution>& dists,
     const arma::vec& weights) const
 {
-  double logLikelihood = 0;
-  arma::vec phis;
-  arma::mat likelihoods(gaussians, observations.n_cols);
+  arma::vec logPhis;
+  arma::mat logLikelihoods(gaussians, observations.n_cols);
 
+  // Work in log-space, so that the likelihoods of points far from every
+  // component do not underflow.
   for (size_t i = 0; i < gaussians; ++i)
   {
-    dists[i].Probability(observations, phis);
-    likelihoods.row(i) = weights(i) * trans(phis);
+    dists[i].LogProbability(observations, logPhis);
+    logLikelihoods.row(i) = log(weights(i)) + trans(logPhis);
   }
 
   // Now sum over every point.
+  arma::vec pointLogLikelihoods;
+  math::LogSumExpT(logLikelihoods, pointLogLikelihoods);
   for (size_t j = 0; j < observations.n_cols; ++j)
   {
-    if (accu(likelihoods.col(j)) == 0)
+    if (pointLogLikelihoods[j] == -std::numeric_limits<double>::infinity())
       Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
           << "outlier." << std::endl;
-    logLikelihood += log(accu(likelihoods.col(j)));
   }
+  const double logLikelihood = arma::accu(pointLogLikelihoods);
 
   return logLikelihood;
 }
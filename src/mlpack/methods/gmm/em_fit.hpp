@@ -148,19 +148,90 @@ class EMFit
       arma::vec& weights);
 
   /**
-   * Calculate the log-likelihood of a model.  Yes, this is reimplemented in the
-   * GMM code.  Intuition suggests that the log-likelihood is not the best way
-   * to determine if the EM algorithm has converged.
+   * Compute the responsibility of each component for each observation (the
+   * E-step), and return the log-likelihood of the model.  Yes, the
+   * log-likelihood is reimplemented in the GMM code.  Intuition suggests that
+   * the log-likelihood is not the best way to determine if the EM algorithm has
+   * converged.
    *
-   * @param data Data matrix.
-   * @param means Vector of means.
-   * @param dists Distributions to store model in.
+   * The observations are processed in tiles of TileSize points, in parallel;
+   * each thread evaluates every component on its tile with buffers that are
+   * reused across components and tiles.
+   *
+   * @param observations List of observations.
+   * @param dists Distributions of the model.
    * @param weights Vector of a priori weights.
+   * @param responsibilities Matrix to store the responsibilities in, with one
+   *     row for each component and one column for each observation.
    */
-  double LogLikelihood(
-      const arma::mat& data,
-      const std::vector<Distribution>& dists,
-      const arma::vec& weights) const;
+  double EStep(const arma::mat& observations,
+               const std::vector<Distribution>& dists,
+               const arma::vec& weights,
+               arma::mat& responsibilities) const;
+
+  /**
+   * Update the means and covariances of the components from the given
+   * responsibilities (the M-step).  The weighted sums are accumulated over
+   * tiles of observations in parallel, with one set of accumulators for each
+   * thread.  Components with no responsibility for any point are not updated.
+   *
+   * @param observations List of observations.
+   * @param responsibilities Responsibility of each component (rows) for each
+   *     observation (columns).
+   * @param dists Distributions to store the model in.
+   * @param responsibilitySums Vector to store the total responsibility of each
+   *     component in.
+   */
+  void MStep(const arma::mat& observations,
+             const arma::mat& responsibilities,
+             std::vector<Distribution>& dists,
+             arma::vec& responsibilitySums);
+
+  /**
+   * Store the log-probability of the given tile of observations under a
+   * Gaussian component in the given row of logProbabilities.  diffs and
+   * products are used as scratch space.
+   */
+  static void TileLogProbability(
+      const arma::mat& observations,
+      const size_t begin,
+      const size_t end,
+      const distribution::GaussianDistribution& dist,
+      const size_t component,
+      arma::mat& diffs,
+      arma::mat& products,
+      arma::mat& logProbabilities);
+
+  /**
+   * Store the log-probability of the given tile of observations under a
+   * diagonal Gaussian component in the given row of logProbabilities.  No
+   * scratch space is needed.
+   */
+  static void TileLogProbability(
+      const arma::mat& observations,
+      const size_t begin,
+      const size_t end,
+      const distribution::DiagonalGaussianDistribution& dist,
+      const size_t component,
+      arma::mat& diffs,
+      arma::mat& products,
+      arma::mat& logProbabilities);
+
+  /**
+   * Store the log-probability of the given tile of observations under any
+   * other type of component in the given row of logProbabilities, using the
+   * distribution's own LogProbability().
+   */
+  template<typename DistributionType>
+  static void TileLogProbability(
+      const arma::mat& observations,
+      const size_t begin,
+      const size_t end,
+      const DistributionType& dist,
+      const size_t component,
+      arma::mat& diffs,
+      arma::mat& products,
+      arma::mat& logProbabilities);
 
   /**
    * Use the Armadillo gmm_diag clusterer to train a GMM with diagonal
@@ -178,6 +249,9 @@ class EMFit
       arma::vec& weights,
       const bool useInitialModel);
 
+  //! The number of observations in each tile of the E-step and the M-step.
+  static const size_t TileSize = 1024;
+
   //! Maximum iterations of EM algorithm.
   size_t maxIterations;
   //! Tolerance for convergence of EM.
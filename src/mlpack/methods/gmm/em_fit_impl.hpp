@@ -71,13 +71,14 @@ Estimate(const arma::mat& observations,
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  arma::mat responsibilities;
+  double l = EStep(observations, dists, weights, responsibilities);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condLogProb(observations.n_cols, dists.size());
+  arma::vec responsibilitySums;
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
@@ -86,81 +87,19 @@ Estimate(const arma::mat& observations,
     Log::Info << "EMFit::Estimate(): iteration " << iteration << ", "
         << "log-likelihood " << l << "." << std::endl;
 
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); ++i)
-    {
-      // Store conditional log probabilities into condLogProb vector for each
-      // Gaussian.  First we make an alias of the condLogProb vector.
-      arma::vec condLogProbAlias = condLogProb.unsafe_col(i);
-      dists[i].LogProbability(observations, condLogProbAlias);
-      condLogProbAlias += log(weights[i]);
-    }
-
-    // Normalize row-wise.
-    for (size_t i = 0; i < condLogProb.n_rows; ++i)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = mlpack::math::AccuLog(condLogProb.row(i));
-      if (probSum != -std::numeric_limits<double>::infinity())
-        condLogProb.row(i) -= probSum;
-    }
-
-    // Store the sum of the probability of each state over all the observations.
-    arma::vec probRowSums(dists.size());
-    for (size_t i = 0; i < dists.size(); ++i)
-    {
-      probRowSums(i) = mlpack::math::AccuLog(condLogProb.col(i));
-    }
-
-    // Calculate the new value of the means using the updated conditional
-    // probabilities.
-    for (size_t i = 0; i < dists.size(); ++i)
-    {
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != -std::numeric_limits<double>::infinity())
-        dists[i].Mean() = observations * arma::exp(condLogProb.col(i) -
-                                                   probRowSums[i]);
-      else
-        continue;
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations.each_col() - dists[i].Mean();
-
-      // If the distribution is DiagonalGaussianDistribution, calculate the
-      // covariance only with diagonal components.
-      if (std::is_same<Distribution,
-          distribution::DiagonalGaussianDistribution>::value)
-      {
-        arma::vec covariance = arma::sum((tmp % tmp) %
-            (arma::ones<arma::vec>(observations.n_rows) *
-            trans(arma::exp(condLogProb.col(i) - probRowSums[i]))), 1);
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
-      else
-      {
-        arma::mat tmpB = tmp.each_row() % trans(arma::exp(condLogProb.col(i) -
-                                                          probRowSums[i]));
-        arma::mat covariance = tmp * trans(tmpB);
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(covariance);
-        dists[i].Covariance(std::move(covariance));
-      }
-    }
+    // Calculate the new values of the means and covariances using the
+    // conditional probabilities of each Gaussian given the observations and the
+    // present theta value.
+    MStep(observations, responsibilities, dists, responsibilitySums);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
-    weights = arma::exp(probRowSums - std::log(observations.n_cols));
+    weights = responsibilitySums / observations.n_cols;
 
-    // Update values of l; calculate new log-likelihood.
+    // Update values of l; calculate new log-likelihood, and the conditional
+    // probabilities for the next iteration.
     lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    l = EStep(observations, dists, weights, responsibilities);
 
     iteration++;
   }
@@ -179,101 +118,36 @@ Estimate(const arma::mat& observations,
   if (!useInitialModel)
     InitialClustering(observations, dists, weights);
 
-  double l = LogLikelihood(observations, dists, weights);
+  arma::mat responsibilities;
+  double l = EStep(observations, dists, weights, responsibilities);
 
   Log::Debug << "EMFit::Estimate(): initial clustering log-likelihood: "
       << l << std::endl;
 
   double lOld = -DBL_MAX;
-  arma::mat condLogProb(observations.n_cols, dists.size());
+  arma::vec responsibilitySums;
 
   // Iterate to update the model until no more improvement is found.
   size_t iteration = 1;
   while (std::abs(l - lOld) > tolerance && iteration != maxIterations)
   {
-    // Calculate the conditional probabilities of choosing a particular
-    // Gaussian given the observations and the present theta value.
-    for (size_t i = 0; i < dists.size(); ++i)
-    {
-      // Store conditional log probabilities into condLogProb vector for each
-      // Gaussian.  First we make an alias of the condLogProb vector.
-      arma::vec condLogProbAlias = condLogProb.unsafe_col(i);
-      dists[i].LogProbability(observations, condLogProbAlias);
-      condLogProbAlias += log(weights[i]);
-    }
+    // The conditional probability of each point being from Gaussian i is
+    // multiplied by the probability of the point being from this mixture
+    // model.
+    responsibilities.each_row() %= probabilities.t();
 
-    // Normalize row-wise.
-    for (size_t i = 0; i < condLogProb.n_rows; ++i)
-    {
-      // Avoid dividing by zero; if the probability for everything is 0, we
-      // don't want to make it NaN.
-      const double probSum = mlpack::math::AccuLog(condLogProb.row(i));
-      if (probSum != -std::numeric_limits<double>::infinity())
-        condLogProb.row(i) -= probSum;
-    }
-
-    // This will store the sum of probabilities of each state over all the
-    // observations.
-    arma::vec probRowSums(dists.size());
-
-    // Calculate the new value of the means using the updated conditional
-    // probabilities.
-    arma::vec logProbabilities = arma::log(probabilities);
-    for (size_t i = 0; i < dists.size(); ++i)
-    {
-      // Calculate the sum of probabilities of points, which is the
-      // conditional probability of each point being from Gaussian i
-      // multiplied by the probability of the point being from this mixture
-      // model.
-      arma::vec tmpProb = condLogProb.col(i) + logProbabilities;
-      probRowSums[i] = mlpack::math::AccuLog(tmpProb);
-
-      // Don't update if there's no probability of the Gaussian having points.
-      if (probRowSums[i] != -std::numeric_limits<double>::infinity())
-      {
-        dists[i].Mean() = observations *
-              arma::exp(condLogProb.col(i) + logProbabilities - probRowSums[i]);
-      }
-      else
-        continue;
-
-      // Calculate the new value of the covariances using the updated
-      // conditional probabilities and the updated means.
-      arma::mat tmp = observations.each_col() - dists[i].Mean();
-
-      // If the distribution is DiagonalGaussianDistribution, calculate the
-      // covariance only with diagonal components.
-      if (std::is_same<Distribution,
-          distribution::DiagonalGaussianDistribution>::value)
-      {
-        arma::vec cov = arma::sum((tmp % tmp) %
-            (arma::ones<arma::vec>(observations.n_rows) *
-            trans(arma::exp(condLogProb.col(i) +
-                            logProbabilities - probRowSums[i]))), 1);
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(cov);
-        dists[i].Covariance(std::move(cov));
-      }
-      else
-      {
-        arma::mat tmpB = tmp.each_row() % trans(arma::exp(condLogProb.col(i) +
-            logProbabilities - probRowSums[i]));
-        arma::mat cov = (tmp * trans(tmpB));
-
-        // Apply covariance constraint.
-        constraint.ApplyConstraint(cov);
-        dists[i].Covariance(std::move(cov));
-      }
-    }
+    // Calculate the new values of the means and covariances using the weighted
+    // conditional probabilities.
+    MStep(observations, responsibilities, dists, responsibilitySums);
 
     // Calculate the new values for omega using the updated conditional
     // probabilities.
-    weights = arma::exp(probRowSums - mlpack::math::AccuLog(logProbabilities));
+    weights = responsibilitySums / arma::accu(probabilities);
 
-    // Update values of l; calculate new log-likelihood.
+    // Update values of l; calculate new log-likelihood, and the conditional
+    // probabilities for the next iteration.
     lOld = l;
-    l = LogLikelihood(observations, dists, weights);
+    l = EStep(observations, dists, weights, responsibilities);
 
     iteration++;
   }
@@ -377,34 +251,287 @@ template<typename InitialClusteringType,
          typename CovarianceConstraintPolicy,
          typename Distribution>
 double EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
-LogLikelihood(const arma::mat& observations,
-              const std::vector<Distribution>& dists,
-              const arma::vec& weights) const
+EStep(const arma::mat& observations,
+      const std::vector<Distribution>& dists,
+      const arma::vec& weights,
+      arma::mat& responsibilities) const
 {
-  double logLikelihood = 0;
+  responsibilities.set_size(dists.size(), observations.n_cols);
+  const arma::vec logWeights = arma::log(weights);
+
+  const size_t numTiles = (observations.n_cols + TileSize - 1) / TileSize;
+  double logLikelihood = 0.0;
+  size_t outliers = 0;
+
+  #pragma omp parallel reduction(+:logLikelihood, outliers)
+  {
+    // Scratch space, reused for every component and every tile.
+    arma::mat diffs, products;
 
-  arma::vec logPhis;
-  arma::mat logLikelihoods(dists.size(), observations.n_cols);
+    #pragma omp for
+    for (omp_size_t t = 0; t < (omp_size_t) numTiles; ++t)
+    {
+      const size_t begin = t * TileSize;
+      const size_t end = std::min(begin + TileSize,
+          (size_t) observations.n_cols);
+
+      // It has to be the log-probability, otherwise the probability would
+      // underflow easily.
+      for (size_t i = 0; i < dists.size(); ++i)
+      {
+        TileLogProbability(observations, begin, end, dists[i], i, diffs,
+            products, responsibilities);
+      }
 
-  // It has to be LogProbability() otherwise Probability() would overflow easily
+      // Normalize each column.  Avoid dividing by zero; if the probability for
+      // everything is 0, we don't want to make it NaN.
+      for (size_t j = begin; j < end; ++j)
+      {
+        double* logProbs = responsibilities.colptr(j);
+        double maxLogProb = -std::numeric_limits<double>::infinity();
+        for (size_t i = 0; i < dists.size(); ++i)
+        {
+          logProbs[i] += logWeights[i];
+          maxLogProb = std::max(maxLogProb, logProbs[i]);
+        }
+
+        if (maxLogProb == -std::numeric_limits<double>::infinity())
+        {
+          ++outliers;
+          logLikelihood += maxLogProb;
+          std::fill(logProbs, logProbs + dists.size(), 0.0);
+          continue;
+        }
+
+        double sum = 0.0;
+        for (size_t i = 0; i < dists.size(); ++i)
+          sum += std::exp(logProbs[i] - maxLogProb);
+
+        const double logSum = maxLogProb + std::log(sum);
+        logLikelihood += logSum;
+        for (size_t i = 0; i < dists.size(); ++i)
+          logProbs[i] = std::exp(logProbs[i] - logSum);
+      }
+    }
+  }
+
+  if (outliers > 0)
+  {
+    Log::Info << "Likelihood of " << outliers << " points is 0!  They are "
+        << "probably outliers." << std::endl;
+  }
+
+  return logLikelihood;
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+MStep(const arma::mat& observations,
+      const arma::mat& responsibilities,
+      std::vector<Distribution>& dists,
+      arma::vec& responsibilitySums)
+{
+  // If the distribution is DiagonalGaussianDistribution, calculate the
+  // covariance only with diagonal components.
+  const bool isDiagGaussDist = std::is_same<Distribution,
+      distribution::DiagonalGaussianDistribution>::value;
+  typedef typename std::conditional<isDiagGaussDist,
+      arma::vec, arma::mat>::type CovarianceType;
+
+  const size_t dimensionality = observations.n_rows;
+  const size_t numTiles = (observations.n_cols + TileSize - 1) / TileSize;
+
+  // First accumulate the total responsibility and the weighted sum of the
+  // points for each component.
+  arma::mat means(dimensionality, dists.size(), arma::fill::zeros);
+  responsibilitySums.zeros(dists.size());
+
+  #pragma omp parallel
+  {
+    arma::mat localMeans(dimensionality, dists.size(), arma::fill::zeros);
+    arma::vec localSums(dists.size(), arma::fill::zeros);
+
+    #pragma omp for
+    for (omp_size_t t = 0; t < (omp_size_t) numTiles; ++t)
+    {
+      const size_t begin = t * TileSize;
+      const size_t end = std::min(begin + TileSize,
+          (size_t) observations.n_cols) - 1;
+
+      localMeans += observations.cols(begin, end) *
+          responsibilities.cols(begin, end).t();
+      localSums += arma::sum(responsibilities.cols(begin, end), 1);
+    }
+
+    #pragma omp critical
+    {
+      means += localMeans;
+      responsibilitySums += localSums;
+    }
+  }
+
+  // Don't update if there's no probability of the Gaussian having points.
   for (size_t i = 0; i < dists.size(); ++i)
   {
-    dists[i].LogProbability(observations, logPhis);
-    logLikelihoods.row(i) = log(weights(i)) + trans(logPhis);
+    if (responsibilitySums[i] != 0.0)
+      dists[i].Mean() = means.col(i) / responsibilitySums[i];
   }
-  // Now sum over every point.
-  for (size_t j = 0; j < observations.n_cols; ++j)
+
+  // Now accumulate the weighted covariances around the updated means.
+  std::vector<CovarianceType> covs(dists.size());
+  for (size_t i = 0; i < dists.size(); ++i)
+    covs[i].zeros(dimensionality, isDiagGaussDist ? 1 : dimensionality);
+
+  #pragma omp parallel
   {
-    if (mlpack::math::AccuLog(logLikelihoods.col(j)) ==
-        -std::numeric_limits<double>::infinity())
+    std::vector<CovarianceType> localCovs(covs);
+    arma::mat diffs, weightedDiffs;
+
+    #pragma omp for
+    for (omp_size_t t = 0; t < (omp_size_t) numTiles; ++t)
     {
-      Log::Info << "Likelihood of point " << j << " is 0!  It is probably an "
-          << "outlier." << std::endl;
+      const size_t begin = t * TileSize;
+      const size_t end = std::min(begin + TileSize,
+          (size_t) observations.n_cols);
+
+      for (size_t i = 0; i < dists.size(); ++i)
+      {
+        if (responsibilitySums[i] == 0.0)
+          continue;
+
+        const arma::vec& mean = dists[i].Mean();
+        if (isDiagGaussDist)
+        {
+          for (size_t j = begin; j < end; ++j)
+          {
+            const double responsibility = responsibilities(i, j);
+            const double* point = observations.colptr(j);
+            for (size_t d = 0; d < dimensionality; ++d)
+            {
+              const double diff = point[d] - mean[d];
+              localCovs[i][d] += responsibility * diff * diff;
+            }
+          }
+        }
+        else
+        {
+          diffs = observations.cols(begin, end - 1);
+          diffs.each_col() -= mean;
+          weightedDiffs = diffs;
+          weightedDiffs.each_row() %= responsibilities(arma::span(i),
+              arma::span(begin, end - 1));
+          localCovs[i] += diffs * weightedDiffs.t();
+        }
+      }
+    }
+
+    #pragma omp critical
+    {
+      for (size_t i = 0; i < dists.size(); ++i)
+        covs[i] += localCovs[i];
     }
-    logLikelihood += mlpack::math::AccuLog(logLikelihoods.col(j));
   }
 
-  return logLikelihood;
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    if (responsibilitySums[i] == 0.0)
+      continue;
+
+    covs[i] /= responsibilitySums[i];
+
+    // Apply covariance constraint.
+    constraint.ApplyConstraint(covs[i]);
+    dists[i].Covariance(std::move(covs[i]));
+  }
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+TileLogProbability(const arma::mat& observations,
+                   const size_t begin,
+                   const size_t end,
+                   const distribution::GaussianDistribution& dist,
+                   const size_t component,
+                   arma::mat& diffs,
+                   arma::mat& products,
+                   arma::mat& logProbabilities)
+{
+  // Column j of 'diffs' is the difference between the j'th point of the tile
+  // and the mean.
+  diffs = observations.cols(begin, end - 1);
+  diffs.each_col() -= dist.Mean();
+  products = dist.InvCov() * diffs;
+
+  // We only need the diagonal elements of (diffs' * cov^-1 * diffs).
+  const double logNormalizer = -0.5 * observations.n_rows *
+      distribution::GaussianDistribution::log2pi - 0.5 * dist.LogDetCov();
+  for (size_t j = 0; j < diffs.n_cols; ++j)
+  {
+    const double* diff = diffs.colptr(j);
+    const double* product = products.colptr(j);
+    double mahalanobis = 0.0;
+    for (size_t d = 0; d < diffs.n_rows; ++d)
+      mahalanobis += diff[d] * product[d];
+
+    logProbabilities(component, begin + j) = logNormalizer -
+        0.5 * mahalanobis;
+  }
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+TileLogProbability(const arma::mat& observations,
+                   const size_t begin,
+                   const size_t end,
+                   const distribution::DiagonalGaussianDistribution& dist,
+                   const size_t component,
+                   arma::mat& /* diffs */,
+                   arma::mat& /* products */,
+                   arma::mat& logProbabilities)
+{
+  const arma::vec& mean = dist.Mean();
+  const arma::vec& invCov = dist.InvCov();
+  const double logNormalizer = -0.5 * observations.n_rows *
+      distribution::DiagonalGaussianDistribution::log2pi -
+      0.5 * dist.LogDetCov();
+  for (size_t j = begin; j < end; ++j)
+  {
+    const double* point = observations.colptr(j);
+    double mahalanobis = 0.0;
+    for (size_t d = 0; d < observations.n_rows; ++d)
+    {
+      const double diff = point[d] - mean[d];
+      mahalanobis += invCov[d] * diff * diff;
+    }
+
+    logProbabilities(component, j) = logNormalizer - 0.5 * mahalanobis;
+  }
+}
+
+template<typename InitialClusteringType,
+         typename CovarianceConstraintPolicy,
+         typename Distribution>
+template<typename DistributionType>
+void EMFit<InitialClusteringType, CovarianceConstraintPolicy, Distribution>::
+TileLogProbability(const arma::mat& observations,
+                   const size_t begin,
+                   const size_t end,
+                   const DistributionType& dist,
+                   const size_t component,
+                   arma::mat& /* diffs */,
+                   arma::mat& /* products */,
+                   arma::mat& logProbabilities)
+{
+  arma::vec logProbs;
+  dist.LogProbability(observations.cols(begin, end - 1), logProbs);
+  logProbabilities(arma::span(component), arma::span(begin, end - 1)) =
+      logProbs.t();
 }
 
 template<typename InitialClusteringType,
@@ -12,6 +12,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include "gmm.hpp"
+#include "gmm_tree_evaluator.hpp"
 #include <mlpack/core/math/log_add.hpp>
 
 namespace mlpack {
@@ -60,12 +61,11 @@ double GMM::LogProbability(const arma::vec& observation) const
 {
   // Sum the probability for each Gaussian in our mixture (and we have to
   // multiply by the prior for each Gaussian too).
-  double sum = -std::numeric_limits<double>::infinity();
+  arma::vec logProbs(gaussians);
   for (size_t i = 0; i < gaussians; ++i)
-    sum = math::LogAdd(sum, log(weights[i]) +
-        dists[i].LogProbability(observation));
+    logProbs[i] = dists[i].LogProbability(observation);
 
-  return sum;
+  return math::AccuLog(arma::vec(logProbs + arma::log(weights)));
 }
 
 /**
@@ -99,6 +99,22 @@ void GMM::LogProbability(const arma::mat& observation,
   math::LogSumExp(logProb, logProbs);
 }
 
+/**
+ * Return the log probability of the given observation GMM matrix, to within
+ * the given relative error.
+ *
+ * @param observation Observation matrix to compute log-probabilty.
+ * @param logProbs Stores the value of log-probability for Observation.
+ * @param relError Relative error tolerance.
+ */
+void GMM::LogProbability(const arma::mat& observation,
+                         arma::vec& logProbs,
+                         const double relError) const
+{
+  GMMTreeEvaluator evaluator(dists, weights, relError);
+  evaluator.LogProbability(observation, logProbs);
+}
+
 /**
  * Return the probability of the given observation being from this GMM.
  *
@@ -122,6 +138,22 @@ void GMM::Probability(const arma::mat& observation,
   probs = exp(probs);
 }
 
+/**
+ * Return the probability of the given observation GMM matrix, to within the
+ * given relative error.
+ *
+ * @param observation Observation matrix to compute probabilty.
+ * @param probs Stores the value of probability for x.
+ * @param relError Relative error tolerance.
+ */
+void GMM::Probability(const arma::mat& observation,
+                      arma::vec& probs,
+                      const double relError) const
+{
+  LogProbability(observation, probs, relError);
+  probs = exp(probs);
+}
+
 
 /**
  * Return the log probability of the given observation being from the given
@@ -214,6 +246,22 @@ void GMM::Classify(const arma::mat& observations,
   }
 }
 
+/**
+ * Classify the given observations as being from an individual component in this
+ * GMM, to within the given relative error.
+ *
+ * @param observation Observation matrix for classification.
+ * @param labels Save the labels for the given observation matrix.
+ * @param relError Relative error tolerance.
+ */
+void GMM::Classify(const arma::mat& observations,
+                   arma::Row<size_t>& labels,
+                   const double relError) const
+{
+  GMMTreeEvaluator evaluator(dists, weights, relError);
+  evaluator.Classify(observations, labels);
+}
+
 /**
  * Get the log-likelihood of this data's fit to the model.
  *
@@ -238,8 +286,9 @@ double GMM::LogLikelihood(
   }
 
   // Now sum over every point.
-  for (size_t j = 0; j < data.n_cols; ++j)
-    loglikelihood += mlpack::math::AccuLog(logLikelihoods.col(j));
+  arma::vec pointLogLikelihoods;
+  math::LogSumExpT(logLikelihoods, pointLogLikelihoods);
+  loglikelihood = arma::accu(pointLogLikelihoods);
   return loglikelihood;
 }
 
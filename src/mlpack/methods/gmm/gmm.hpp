@@ -188,6 +188,34 @@ class GMM
    */
   void LogProbability(const arma::mat& observation, arma::vec& logProbs) const;
 
+  /**
+   * Return the log-probability of the given observation matrix, to within the
+   * given relative error.  A kd-tree is built on the observations, and the
+   * components that contribute negligible mass to whole nodes of the tree are
+   * not evaluated for the points in them (see GMMTreeEvaluator).  This is much
+   * faster than evaluating every component when there are many components.
+   *
+   * @param observation Observation matrix.
+   * @param logProbs Vector to store log-probability value of observation.
+   * @param relError Relative error tolerance of the probabilities.
+   */
+  void LogProbability(const arma::mat& observation,
+                      arma::vec& logProbs,
+                      const double relError) const;
+
+  /**
+   * Return the probability of the given observation matrix, to within the
+   * given relative error, using a kd-tree on the observations (see
+   * GMMTreeEvaluator).
+   *
+   * @param observation Observation matrix.
+   * @param probs Vector to store probability value of observation x.
+   * @param relError Relative error tolerance of the probabilities.
+   */
+  void Probability(const arma::mat& observation,
+                   arma::vec& probs,
+                   const double relError) const;
+
   /**
    * Return the probability that the given observation came from the given
    * Gaussian component in this distribution.
@@ -295,6 +323,22 @@ class GMM
   void Classify(const arma::mat& observations,
                 arma::Row<size_t>& labels) const;
 
+  /**
+   * Classify the given observations as being from an individual component in
+   * this GMM, using a kd-tree on the observations to skip the components that
+   * cannot be the most likely one for whole nodes of the tree (see
+   * GMMTreeEvaluator).  The component of each label is at most a factor of (1
+   * + relError) less likely than the most likely component; with relError = 0,
+   * the labels are the same as those of the other overload.
+   *
+   * @param observations List of observations to classify.
+   * @param labels Object which will be filled with labels.
+   * @param relError Relative error tolerance of the labels' probabilities.
+   */
+  void Classify(const arma::mat& observations,
+                arma::Row<size_t>& labels,
+                const double relError) const;
+
   /**
    * Serialize the GMM.
    */
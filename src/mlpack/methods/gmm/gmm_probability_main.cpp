@@ -35,7 +35,13 @@ BINDING_LONG_DESC(
     PRINT_PARAM_STRING("input_model") + " parameter, and the points are "
     "specified with the " + PRINT_PARAM_STRING("input") + " parameter.  The "
     "output probabilities may be saved via the " +
-    PRINT_PARAM_STRING("output") + " output parameter.");
+    PRINT_PARAM_STRING("output") + " output parameter."
+    "\n\n"
+    "If " + PRINT_PARAM_STRING("rel_error") + " is greater than 0, the "
+    "probabilities are approximated to within that relative error with a "
+    "kd-tree built on the points, which skips the Gaussians that contribute "
+    "negligible probability to whole nodes of the tree.  This is much faster "
+    "for GMMs with many Gaussians.");
 
 // Example.
 BINDING_EXAMPLE(
@@ -59,21 +65,37 @@ PARAM_MODEL_IN_REQ(GMM, "input_model", "Input GMM to use as model.", "m");
 PARAM_MATRIX_IN_REQ("input", "Input matrix to calculate probabilities of.",
     "i");
 
+PARAM_DOUBLE_IN("rel_error", "Relative error tolerance of the probabilities; "
+    "if 0, the exact probabilities are computed.", "e", 0.0);
+
 PARAM_MATRIX_OUT("output", "Matrix to store calculated probabilities in.", "o");
 
 static void mlpackMain()
 {
   RequireAtLeastOnePassed({ "output" }, false, "no results will be saved");
 
+  RequireParamValue<double>("rel_error", [](double x) { return x >= 0.0; },
+      true, "relative error tolerance must be nonnegative");
+
   // Get the GMM and the points.
   GMM* gmm = IO::GetParam<GMM*>("input_model");
 
   arma::mat dataset = std::move(IO::GetParam<arma::mat>("input"));
 
   // Now calculate the probabilities.
+  const double relError = IO::GetParam<double>("rel_error");
   arma::rowvec probabilities(dataset.n_cols);
-  for (size_t i = 0; i < dataset.n_cols; ++i)
-    probabilities[i] = gmm->Probability(dataset.unsafe_col(i));
+  if (relError > 0.0)
+  {
+    arma::vec treeProbabilities;
+    gmm->Probability(dataset, treeProbabilities, relError);
+    probabilities = treeProbabilities.t();
+  }
+  else
+  {
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+      probabilities[i] = gmm->Probability(dataset.unsafe_col(i));
+  }
 
   // And save the result.
   IO::GetParam<arma::mat>("output") = std::move(probabilities);
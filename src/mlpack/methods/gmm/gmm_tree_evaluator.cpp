@@ -0,0 +1,287 @@
+/**
+ * @file methods/gmm/gmm_tree_evaluator.cpp
+ *
+ * Implementation of the tree-accelerated evaluation of Gaussian mixture
+ * models.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "gmm_tree_evaluator.hpp"
+#include <mlpack/core/math/log_add.hpp>
+
+namespace mlpack {
+namespace gmm {
+
+GMMTreeEvaluator::GMMTreeEvaluator(
+    const std::vector<distribution::GaussianDistribution>& dists,
+    const arma::vec& weights,
+    const double relError,
+    const size_t leafSize) :
+    dists(dists),
+    logWeights(arma::log(weights)),
+    logScales(dists.size()),
+    minEigenvalues(dists.size()),
+    maxEigenvalues(dists.size()),
+    relError(relError),
+    leafSize(leafSize),
+    prunes(0)
+{
+  if (relError < 0.0)
+  {
+    throw std::invalid_argument("GMMTreeEvaluator: relative error tolerance "
+        "must be nonnegative");
+  }
+
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    logScales[i] = logWeights[i] - 0.5 * dists[i].Mean().n_elem *
+        distribution::GaussianDistribution::log2pi - 0.5 * dists[i].LogDetCov();
+
+    // The Mahalanobis distance of a point to the mean is between the squared
+    // Euclidean distance times the smallest and the largest eigenvalue of the
+    // inverse covariance.
+    const arma::vec eigenvalues = arma::eig_sym(dists[i].InvCov());
+    minEigenvalues[i] = std::max(eigenvalues[0], 0.0);
+    maxEigenvalues[i] = eigenvalues[eigenvalues.n_elem - 1];
+  }
+}
+
+void GMMTreeEvaluator::LogProbability(const arma::mat& observations,
+                                      arma::vec& logProbs)
+{
+  prunes = 0;
+  logProbs.set_size(observations.n_cols);
+  if (observations.n_cols == 0)
+    return;
+
+  // Components with zero weight never contribute.
+  std::vector<size_t> active;
+  for (size_t i = 0; i < dists.size(); ++i)
+  {
+    if (logScales[i] != -std::numeric_limits<double>::infinity())
+      active.push_back(i);
+  }
+
+  std::vector<size_t> oldFromNew;
+  Tree tree(observations, oldFromNew, leafSize);
+
+  arma::vec newLogProbs(observations.n_cols);
+  LogProbability(tree, std::move(active),
+      -std::numeric_limits<double>::infinity(),
+      -std::numeric_limits<double>::infinity(),
+      -std::numeric_limits<double>::infinity(), newLogProbs);
+
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    logProbs[oldFromNew[i]] = newLogProbs[i];
+}
+
+void GMMTreeEvaluator::Classify(const arma::mat& observations,
+                                arma::Row<size_t>& labels)
+{
+  prunes = 0;
+  labels.set_size(observations.n_cols);
+  if (observations.n_cols == 0)
+    return;
+
+  std::vector<size_t> active(dists.size());
+  for (size_t i = 0; i < dists.size(); ++i)
+    active[i] = i;
+
+  std::vector<size_t> oldFromNew;
+  Tree tree(observations, oldFromNew, leafSize);
+
+  arma::Row<size_t> newLabels(observations.n_cols);
+  Classify(tree, std::move(active), std::vector<char>(dists.size(), 0),
+      newLabels);
+
+  for (size_t i = 0; i < oldFromNew.size(); ++i)
+    labels[oldFromNew[i]] = newLabels[i];
+}
+
+void GMMTreeEvaluator::Bounds(const Tree& node,
+                              const std::vector<size_t>& active,
+                              arma::vec& logLower,
+                              arma::vec& logUpper) const
+{
+  logLower.set_size(active.size());
+  logUpper.set_size(active.size());
+  for (size_t a = 0; a < active.size(); ++a)
+  {
+    const size_t i = active[a];
+    const double minDistance = node.Bound().MinDistance(dists[i].Mean());
+    const double maxDistance = node.Bound().MaxDistance(dists[i].Mean());
+
+    logUpper[a] = logScales[i] - 0.5 * minEigenvalues[i] * minDistance *
+        minDistance;
+    logLower[a] = logScales[i] - 0.5 * maxEigenvalues[i] * maxDistance *
+        maxDistance;
+  }
+}
+
+void GMMTreeEvaluator::LogProbability(const Tree& node,
+                                      std::vector<size_t> active,
+                                      double prunedLogMass,
+                                      double prunedLogLower,
+                                      double spentLogError,
+                                      arma::vec& logProbs)
+{
+  arma::vec logLower, logUpper;
+  Bounds(node, active, logLower, logUpper);
+
+  // The density of every point in the node is at least the sum of the lower
+  // bounds, including those of the components pruned above this node, so the
+  // error spent so far may grow to relError times that.
+  double logLowerSum = prunedLogLower;
+  for (size_t a = 0; a < active.size(); ++a)
+    logLowerSum = math::LogAdd(logLowerSum, logLower[a]);
+  const double logBudget = std::log(relError) + logLowerSum;
+
+  // Replacing a component by the midpoint of its bounds costs at most half the
+  // width of the bounds.  Prune the cheapest components first.
+  arma::vec logCosts(active.size());
+  for (size_t a = 0; a < active.size(); ++a)
+  {
+    logCosts[a] = logUpper[a] + std::log1p(-std::exp(logLower[a] -
+        logUpper[a])) - std::log(2.0);
+  }
+
+  const arma::uvec order = arma::sort_index(logCosts);
+  std::vector<char> pruned(active.size(), 0);
+  size_t numPruned = 0;
+  for (size_t o = 0; o < order.n_elem; ++o)
+  {
+    const size_t a = order[o];
+    const double newSpentLogError = math::LogAdd(spentLogError, logCosts[a]);
+    if (newSpentLogError > logBudget)
+      break;
+
+    spentLogError = newSpentLogError;
+    prunedLogMass = math::LogAdd(prunedLogMass,
+        math::LogAdd(logLower[a], logUpper[a]) - std::log(2.0));
+    prunedLogLower = math::LogAdd(prunedLogLower, logLower[a]);
+    pruned[a] = 1;
+    ++numPruned;
+  }
+
+  if (numPruned > 0)
+  {
+    prunes += numPruned;
+    size_t kept = 0;
+    for (size_t a = 0; a < active.size(); ++a)
+    {
+      if (!pruned[a])
+        active[kept++] = active[a];
+    }
+    active.resize(kept);
+  }
+
+  if (active.empty())
+  {
+    logProbs.subvec(node.Begin(), node.Begin() + node.Count() - 1).fill(
+        prunedLogMass);
+    return;
+  }
+
+  if (node.IsLeaf())
+  {
+    arma::mat leafLogProbs;
+    LeafLogProbabilities(node, active, leafLogProbs);
+    arma::vec pointLogProbs;
+    math::LogSumExpT(leafLogProbs, pointLogProbs);
+    for (size_t j = 0; j < node.Count(); ++j)
+    {
+      logProbs[node.Begin() + j] = math::LogAdd(prunedLogMass,
+          pointLogProbs[j]);
+    }
+    return;
+  }
+
+  for (size_t c = 0; c < node.NumChildren(); ++c)
+  {
+    LogProbability(node.Child(c), active, prunedLogMass, prunedLogLower,
+        spentLogError, logProbs);
+  }
+}
+
+void GMMTreeEvaluator::Classify(const Tree& node,
+                                std::vector<size_t> active,
+                                std::vector<char> protect,
+                                arma::Row<size_t>& labels)
+{
+  if (active.size() > 1)
+  {
+    arma::vec logLower, logUpper;
+    Bounds(node, active, logLower, logUpper);
+
+    // No point in the node is more likely to be from a component whose upper
+    // bound is below the lower bound of the best component, up to the
+    // tolerance.  The best component must then stay, so that the bound holds
+    // for all of the points below this node.
+    const size_t best = logLower.index_max();
+    protect[active[best]] = 1;
+    const double threshold = logLower[best] + std::log1p(relError);
+
+    size_t kept = 0;
+    for (size_t a = 0; a < active.size(); ++a)
+    {
+      if (protect[active[a]] || logUpper[a] >= threshold)
+        active[kept++] = active[a];
+    }
+    prunes += active.size() - kept;
+    active.resize(kept);
+  }
+
+  if (active.size() == 1)
+  {
+    labels.subvec(node.Begin(), node.Begin() + node.Count() - 1).fill(
+        active[0]);
+    return;
+  }
+
+  if (node.IsLeaf())
+  {
+    arma::mat leafLogProbs;
+    LeafLogProbabilities(node, active, leafLogProbs);
+    for (size_t j = 0; j < node.Count(); ++j)
+    {
+      // The active components are in increasing order, so this breaks ties
+      // in the same way as GMM::Classify().
+      double probability = -std::numeric_limits<double>::infinity();
+      for (size_t a = 0; a < active.size(); ++a)
+      {
+        if (leafLogProbs(a, j) >= probability)
+        {
+          probability = leafLogProbs(a, j);
+          labels[node.Begin() + j] = active[a];
+        }
+      }
+    }
+    return;
+  }
+
+  for (size_t c = 0; c < node.NumChildren(); ++c)
+    Classify(node.Child(c), active, protect, labels);
+}
+
+void GMMTreeEvaluator::LeafLogProbabilities(const Tree& node,
+                                            const std::vector<size_t>& active,
+                                            arma::mat& logProbs) const
+{
+  const arma::mat points = node.Dataset().cols(node.Begin(),
+      node.Begin() + node.Count() - 1);
+  logProbs.set_size(active.size(), node.Count());
+
+  arma::vec componentLogProbs;
+  for (size_t a = 0; a < active.size(); ++a)
+  {
+    const size_t i = active[a];
+    dists[i].LogProbability(points, componentLogProbs);
+    logProbs.row(a) = logWeights[i] + componentLogProbs.t();
+  }
+}
+
+} // namespace gmm
+} // namespace mlpack
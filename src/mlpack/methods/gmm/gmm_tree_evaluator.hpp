@@ -0,0 +1,166 @@
+/**
+ * @file methods/gmm/gmm_tree_evaluator.hpp
+ *
+ * Tree-accelerated evaluation of the density and the most likely component of
+ * a Gaussian mixture model, which prunes components that contribute negligible
+ * mass to whole nodes of a kd-tree built on the points.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GMM_GMM_TREE_EVALUATOR_HPP
+#define MLPACK_METHODS_GMM_GMM_TREE_EVALUATOR_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/dists/gaussian_distribution.hpp>
+#include <mlpack/core/tree/binary_space_tree.hpp>
+
+namespace mlpack {
+namespace gmm {
+
+/**
+ * This class evaluates a Gaussian mixture model on many points at once by
+ * building a kd-tree on the points and walking it with the list of components
+ * that still need to be evaluated exactly.  At each node, the HRectBound of the
+ * node gives the minimum and maximum distance from each component's mean to
+ * any point in the node, and so, with the extreme eigenvalues of the inverse
+ * covariance, bounds on the weighted density of the component over the node.
+ *
+ * For the log-probability, in the same way as the KDE rules, a component whose
+ * bounds are close enough is pruned and replaced by the midpoint of its
+ * bounds.  The error of each prune is charged against a budget of relError
+ * times the lower bound on the density of the mixture over the node, so the
+ * estimated density of every point is within a relative error of relError of
+ * the true density.  Far components have tiny upper bounds, and so are cheap
+ * to prune; with hundreds of components, most of them are pruned near the
+ * root.
+ *
+ * For classification, a component is pruned when its upper bound is less than
+ * (1 + relError) times the lower bound of the best component of the node, which
+ * is then never pruned below that node.  Therefore the component of each label
+ * has a weighted density within a factor of (1 + relError) of the most likely
+ * component, and with relError = 0 the labels are exact.
+ *
+ * @code
+ * GMMTreeEvaluator evaluator(dists, weights, 0.01);
+ * arma::vec logProbs;
+ * evaluator.LogProbability(points, logProbs);
+ * @endcode
+ */
+class GMMTreeEvaluator
+{
+ public:
+  //! The type of tree built on the points.
+  typedef tree::KDTree<metric::EuclideanDistance, tree::EmptyStatistic,
+      arma::mat> Tree;
+
+  /**
+   * Create the evaluator for the given components and weights, which must
+   * outlive the evaluator.
+   *
+   * @param dists Components of the mixture.
+   * @param weights A priori weights of the components.
+   * @param relError Relative error tolerance; 0 gives exact results.
+   * @param leafSize Maximum number of points in a leaf of the tree.
+   */
+  GMMTreeEvaluator(const std::vector<distribution::GaussianDistribution>& dists,
+                   const arma::vec& weights,
+                   const double relError = 0.0,
+                   const size_t leafSize = 20);
+
+  /**
+   * Compute the log-probability of each of the given points under the
+   * mixture, to within the relative error tolerance.
+   *
+   * @param observations Points to evaluate.
+   * @param logProbs Vector to store the log-probability of each point in.
+   */
+  void LogProbability(const arma::mat& observations, arma::vec& logProbs);
+
+  /**
+   * Find the most likely component for each of the given points, to within the
+   * relative error tolerance.  Ties are broken in the same way as in
+   * GMM::Classify().
+   *
+   * @param observations Points to classify.
+   * @param labels Object which will be filled with labels.
+   */
+  void Classify(const arma::mat& observations, arma::Row<size_t>& labels);
+
+  //! Get the relative error tolerance.
+  double RelativeError() const { return relError; }
+  //! Modify the relative error tolerance.
+  double& RelativeError() { return relError; }
+
+  //! Get the maximum number of points in a leaf.
+  size_t LeafSize() const { return leafSize; }
+  //! Modify the maximum number of points in a leaf.
+  size_t& LeafSize() { return leafSize; }
+
+  //! Get the number of (node, component) pairs pruned by the last call.
+  size_t Prunes() const { return prunes; }
+
+ private:
+  /**
+   * Compute the log of the lower and upper bounds on the weighted density of
+   * each of the active components over the given node.
+   */
+  void Bounds(const Tree& node,
+              const std::vector<size_t>& active,
+              arma::vec& logLower,
+              arma::vec& logUpper) const;
+
+  /**
+   * Recurse into the given node for LogProbability().  The log of the
+   * estimated mass and of the lower bound on the mass of the components pruned
+   * above this node, and the log of the error spent on them, are passed down.
+   */
+  void LogProbability(const Tree& node,
+                      std::vector<size_t> active,
+                      double prunedLogMass,
+                      double prunedLogLower,
+                      double spentLogError,
+                      arma::vec& logProbs);
+
+  /**
+   * Recurse into the given node for Classify().  Components marked in
+   * 'protect' were the best component of some ancestor and are not pruned.
+   */
+  void Classify(const Tree& node,
+                std::vector<size_t> active,
+                std::vector<char> protect,
+                arma::Row<size_t>& labels);
+
+  /**
+   * Compute the exact weighted log-density of each active component for each
+   * point in the given leaf, with one row for each active component.
+   */
+  void LeafLogProbabilities(const Tree& node,
+                            const std::vector<size_t>& active,
+                            arma::mat& logProbs) const;
+
+  //! The components of the mixture.
+  const std::vector<distribution::GaussianDistribution>& dists;
+  //! The log of the a priori weight of each component.
+  arma::vec logWeights;
+  //! log(weight) plus the log of the normalizing constant of each component.
+  arma::vec logScales;
+  //! The smallest eigenvalue of the inverse covariance of each component.
+  arma::vec minEigenvalues;
+  //! The largest eigenvalue of the inverse covariance of each component.
+  arma::vec maxEigenvalues;
+
+  //! The relative error tolerance.
+  double relError;
+  //! The maximum number of points in a leaf.
+  size_t leafSize;
+  //! The number of prunes in the last call.
+  size_t prunes;
+};
+
+} // namespace gmm
+} // namespace mlpack
+
+#endif
@@ -0,0 +1,44 @@
+/**
+ * @file methods/gradient_boosting/gradient_boosting.cpp
+ *
+ * Implementation of the non-templated functions of GradientBoosting.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "gradient_boosting.hpp"
+
+namespace mlpack {
+namespace tree {
+
+void GradientBoosting::Probabilities(const arma::mat& scores,
+                                     arma::mat& probabilities)
+{
+  if (scores.n_rows == 1)
+  {
+    // The score is the log-odds of class 1.
+    probabilities.set_size(2, scores.n_cols);
+    probabilities.row(1) = 1.0 / (1.0 + arma::exp(-scores));
+    probabilities.row(0) = 1.0 - probabilities.row(1);
+    return;
+  }
+
+  // Subtract the largest score of each point so that exp() cannot overflow.
+  probabilities = arma::exp(scores.each_row() - arma::max(scores, 0));
+  probabilities.each_row() /= arma::sum(probabilities, 0);
+}
+
+double GradientBoosting::LogLoss(const arma::mat& probabilities,
+                                 const arma::Row<size_t>& labels)
+{
+  double loss = 0.0;
+  for (size_t i = 0; i < labels.n_elem; ++i)
+    loss -= std::log(std::max(probabilities(labels[i], i), 1e-15));
+
+  return loss / labels.n_elem;
+}
+
+} // namespace tree
+} // namespace mlpack
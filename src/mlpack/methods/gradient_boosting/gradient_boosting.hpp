@@ -0,0 +1,295 @@
+/**
+ * @file methods/gradient_boosting/gradient_boosting.hpp
+ *
+ * Definition of GradientBoosting, an ensemble of regression trees trained by
+ * gradient boosting for classification.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_HPP
+#define MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/methods/decision_tree/gini_gain.hpp>
+#include <mlpack/methods/decision_tree/histogram_numeric_split.hpp>
+#include "gradient_boosting_tree.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A gradient boosting classifier: an ensemble of regression trees, each fitted
+ * to the gradients and Hessians of the log-loss of the trees before it (with
+ * Newton steps, as in XGBoost and LightGBM).  For two classes, one tree is
+ * built in each round and the model predicts the log-odds of class 1; for more
+ * classes, one tree per class is built in each round and the class
+ * probabilities are the softmax of the predicted scores.
+ *
+ * Before training, each dimension is binned into at most 256 quantile bins
+ * with HistogramNumericSplit::BinDimension(), in parallel over the dimensions,
+ * and the trees are grown from histograms of the binned data (see
+ * GradientBoostingTree).  The values of the leaves are shrunk by the learning
+ * rate.  Each round can be trained on a random subset of the points and each
+ * tree on a random subset of the dimensions.  If a validation set is given,
+ * training stops when the validation log-loss has not improved for a given
+ * number of rounds, and the model is cut back to its best round.
+ *
+ * The trees do not depend on the number of threads used to train them.
+ *
+ * @code
+ * extern arma::mat data;
+ * extern arma::Row<size_t> labels;
+ * extern arma::mat testData;
+ *
+ * // 200 rounds of trees of depth 6, with learning rate 0.05.
+ * GradientBoosting gb(data, labels, 3, 200, 0.05, 6);
+ *
+ * arma::Row<size_t> predictions;
+ * arma::mat probabilities;
+ * gb.Classify(testData, predictions, probabilities);
+ * @endcode
+ */
+class GradientBoosting
+{
+ public:
+  /**
+   * Construct a GradientBoosting object without training it.  It must be
+   * trained with Train() before Classify() is called.
+   */
+  GradientBoosting() : numClasses(0) { }
+
+  /**
+   * Create a GradientBoosting model and train it on the given data.
+   *
+   * @param dataset Dataset to train on.
+   * @param labels Labels for each point in the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param numRounds Number of boosting rounds.
+   * @param learningRate Factor that the values of the leaves of each tree are
+   *     multiplied by.
+   * @param maximumDepth Maximum depth of each tree (0 means no limit).
+   * @param minimumLeafSize Minimum number of points in each leaf.
+   * @param lambda L2 regularization of the values of the leaves.
+   * @param minimumGainSplit Minimum gain for a node to split.
+   * @param subsample Fraction of the points that each round is trained on.
+   * @param columnSubsample Fraction of the dimensions that each tree may split
+   *     on.
+   */
+  template<typename MatType>
+  GradientBoosting(const MatType& dataset,
+                   const arma::Row<size_t>& labels,
+                   const size_t numClasses,
+                   const size_t numRounds = 100,
+                   const double learningRate = 0.1,
+                   const size_t maximumDepth = 6,
+                   const size_t minimumLeafSize = 20,
+                   const double lambda = 1.0,
+                   const double minimumGainSplit = 0.0,
+                   const double subsample = 1.0,
+                   const double columnSubsample = 1.0);
+
+  /**
+   * Train the model on the given data.  Any previous model is discarded.
+   *
+   * @param dataset Dataset to train on.
+   * @param labels Labels for each point in the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param numRounds Number of boosting rounds.
+   * @param learningRate Factor that the values of the leaves of each tree are
+   *     multiplied by.
+   * @param maximumDepth Maximum depth of each tree (0 means no limit).
+   * @param minimumLeafSize Minimum number of points in each leaf.
+   * @param lambda L2 regularization of the values of the leaves.
+   * @param minimumGainSplit Minimum gain for a node to split.
+   * @param subsample Fraction of the points that each round is trained on.
+   * @param columnSubsample Fraction of the dimensions that each tree may split
+   *     on.
+   * @return The log-loss of the model on the training set.
+   */
+  template<typename MatType>
+  double Train(const MatType& dataset,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const size_t numRounds = 100,
+               const double learningRate = 0.1,
+               const size_t maximumDepth = 6,
+               const size_t minimumLeafSize = 20,
+               const double lambda = 1.0,
+               const double minimumGainSplit = 0.0,
+               const double subsample = 1.0,
+               const double columnSubsample = 1.0);
+
+  /**
+   * Train the model on the given data with early stopping: training stops when
+   * the log-loss on the validation set has not improved for
+   * earlyStoppingRounds rounds, and the model is cut back to the round with
+   * the lowest validation log-loss.  Any previous model is discarded.
+   *
+   * @param dataset Dataset to train on.
+   * @param labels Labels for each point in the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param validationDataset Dataset to measure the log-loss on.
+   * @param validationLabels Labels for each point in the validation set.
+   * @param earlyStoppingRounds Number of rounds without improvement after
+   *     which training stops.
+   * @param numRounds Maximum number of boosting rounds.
+   * @param learningRate Factor that the values of the leaves of each tree are
+   *     multiplied by.
+   * @param maximumDepth Maximum depth of each tree (0 means no limit).
+   * @param minimumLeafSize Minimum number of points in each leaf.
+   * @param lambda L2 regularization of the values of the leaves.
+   * @param minimumGainSplit Minimum gain for a node to split.
+   * @param subsample Fraction of the points that each round is trained on.
+   * @param columnSubsample Fraction of the dimensions that each tree may split
+   *     on.
+   * @return The log-loss of the model on the validation set.
+   */
+  template<typename MatType>
+  double Train(const MatType& dataset,
+               const arma::Row<size_t>& labels,
+               const size_t numClasses,
+               const MatType& validationDataset,
+               const arma::Row<size_t>& validationLabels,
+               const size_t earlyStoppingRounds = 10,
+               const size_t numRounds = 100,
+               const double learningRate = 0.1,
+               const size_t maximumDepth = 6,
+               const size_t minimumLeafSize = 20,
+               const double lambda = 1.0,
+               const double minimumGainSplit = 0.0,
+               const double subsample = 1.0,
+               const double columnSubsample = 1.0);
+
+  /**
+   * Predict the class of the given point.
+   *
+   * @param point Point to classify.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point) const;
+
+  /**
+   * Predict the class of the given point and the probabilities of each class.
+   *
+   * @param point Point to classify.
+   * @param prediction Variable to store the predicted class in.
+   * @param probabilities Vector to store the class probabilities in.
+   */
+  template<typename VecType>
+  void Classify(const VecType& point,
+                size_t& prediction,
+                arma::vec& probabilities) const;
+
+  /**
+   * Predict the class of each point in the given dataset.
+   *
+   * @param data Dataset to classify.
+   * @param predictions Row to store the predicted classes in.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions) const;
+
+  /**
+   * Predict the class of each point in the given dataset and the
+   * probabilities of each class.
+   *
+   * @param data Dataset to classify.
+   * @param predictions Row to store the predicted classes in.
+   * @param probabilities Matrix to store the class probabilities of each point
+   *     (column) in.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of classes.
+  size_t NumClasses() const { return numClasses; }
+  //! Get the number of boosting rounds.
+  size_t NumRounds() const { return trees.size() / NumOutputs(); }
+  //! Get the number of trees.
+  size_t NumTrees() const { return trees.size(); }
+  //! Get the given tree.
+  const GradientBoostingTree& Tree(const size_t i) const { return trees[i]; }
+
+  /**
+   * Serialize the model.
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const uint32_t /* version */);
+
+ private:
+  //! The number of classes of the model.
+  size_t numClasses;
+  //! The score of each output before any tree.
+  arma::vec initialScores;
+  //! The trees of each round, one per output.
+  std::vector<GradientBoostingTree> trees;
+
+  //! The binning used for training.
+  typedef HistogramNumericSplit<GiniGain> BinningType;
+
+  //! Get the number of scores of each point: one for two classes, one per
+  //! class otherwise.
+  size_t NumOutputs() const { return (numClasses == 2) ? 1 : numClasses; }
+
+  /**
+   * Train the model, with early stopping if a validation set is given.
+   */
+  template<typename MatType>
+  double TrainInternal(const MatType& dataset,
+                       const arma::Row<size_t>& labels,
+                       const size_t numClasses,
+                       const MatType* validationDataset,
+                       const arma::Row<size_t>* validationLabels,
+                       const size_t earlyStoppingRounds,
+                       const size_t numRounds,
+                       const double learningRate,
+                       const size_t maximumDepth,
+                       const size_t minimumLeafSize,
+                       const double lambda,
+                       const double minimumGainSplit,
+                       const double subsample,
+                       const double columnSubsample);
+
+  /**
+   * Bin each dimension of the given dataset; bins has one row per point and
+   * one column per dimension.
+   */
+  template<typename MatType>
+  static void Bin(const MatType& dataset,
+                  arma::Mat<unsigned char>& bins,
+                  std::vector<arma::vec>& splitPoints);
+
+  /**
+   * Add the predictions of the given trees to the scores of each point.
+   */
+  template<typename MatType>
+  void AddScores(const MatType& dataset,
+                 const size_t firstTree,
+                 arma::mat& scores) const;
+
+  /**
+   * Turn the scores of each point (column) into class probabilities.
+   */
+  static void Probabilities(const arma::mat& scores,
+                            arma::mat& probabilities);
+
+  /**
+   * Get the mean log-loss of the given class probabilities.
+   */
+  static double LogLoss(const arma::mat& probabilities,
+                        const arma::Row<size_t>& labels);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "gradient_boosting_impl.hpp"
+
+#endif
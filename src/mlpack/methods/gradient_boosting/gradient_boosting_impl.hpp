@@ -0,0 +1,356 @@
+/**
+ * @file methods/gradient_boosting/gradient_boosting_impl.hpp
+ *
+ * Implementation of the templated functions of GradientBoosting.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_IMPL_HPP
+#define MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "gradient_boosting.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename MatType>
+GradientBoosting::GradientBoosting(const MatType& dataset,
+                                   const arma::Row<size_t>& labels,
+                                   const size_t numClasses,
+                                   const size_t numRounds,
+                                   const double learningRate,
+                                   const size_t maximumDepth,
+                                   const size_t minimumLeafSize,
+                                   const double lambda,
+                                   const double minimumGainSplit,
+                                   const double subsample,
+                                   const double columnSubsample) :
+    numClasses(0)
+{
+  Train(dataset, labels, numClasses, numRounds, learningRate, maximumDepth,
+      minimumLeafSize, lambda, minimumGainSplit, subsample, columnSubsample);
+}
+
+template<typename MatType>
+double GradientBoosting::Train(const MatType& dataset,
+                               const arma::Row<size_t>& labels,
+                               const size_t numClasses,
+                               const size_t numRounds,
+                               const double learningRate,
+                               const size_t maximumDepth,
+                               const size_t minimumLeafSize,
+                               const double lambda,
+                               const double minimumGainSplit,
+                               const double subsample,
+                               const double columnSubsample)
+{
+  return TrainInternal(dataset, labels, numClasses, (const MatType*) NULL,
+      NULL, 0, numRounds, learningRate, maximumDepth, minimumLeafSize, lambda,
+      minimumGainSplit, subsample, columnSubsample);
+}
+
+template<typename MatType>
+double GradientBoosting::Train(const MatType& dataset,
+                               const arma::Row<size_t>& labels,
+                               const size_t numClasses,
+                               const MatType& validationDataset,
+                               const arma::Row<size_t>& validationLabels,
+                               const size_t earlyStoppingRounds,
+                               const size_t numRounds,
+                               const double learningRate,
+                               const size_t maximumDepth,
+                               const size_t minimumLeafSize,
+                               const double lambda,
+                               const double minimumGainSplit,
+                               const double subsample,
+                               const double columnSubsample)
+{
+  util::CheckSameSizes(validationDataset, validationLabels,
+      "GradientBoosting::Train()", "validation labels");
+  if (validationDataset.n_rows != dataset.n_rows)
+  {
+    throw std::invalid_argument("GradientBoosting::Train(): the validation "
+        "set must have the same dimensionality as the training set!");
+  }
+  if (validationDataset.n_cols == 0)
+  {
+    throw std::invalid_argument("GradientBoosting::Train(): the validation "
+        "set is empty!");
+  }
+  if (earlyStoppingRounds == 0)
+  {
+    throw std::invalid_argument("GradientBoosting::Train(): earlyStoppingRounds"
+        " must be positive!");
+  }
+
+  return TrainInternal(dataset, labels, numClasses, &validationDataset,
+      &validationLabels, earlyStoppingRounds, numRounds, learningRate,
+      maximumDepth, minimumLeafSize, lambda, minimumGainSplit, subsample,
+      columnSubsample);
+}
+
+template<typename VecType>
+size_t GradientBoosting::Classify(const VecType& point) const
+{
+  size_t prediction;
+  arma::vec probabilities;
+  Classify(point, prediction, probabilities);
+  return prediction;
+}
+
+template<typename VecType>
+void GradientBoosting::Classify(const VecType& point,
+                                size_t& prediction,
+                                arma::vec& probabilities) const
+{
+  if (numClasses == 0)
+  {
+    throw std::invalid_argument("GradientBoosting::Classify(): no model "
+        "trained!");
+  }
+
+  arma::mat scores(initialScores);
+  const size_t outputs = NumOutputs();
+  for (size_t t = 0; t < trees.size(); ++t)
+    scores[t % outputs] += trees[t].Predict(point);
+
+  arma::mat pointProbabilities;
+  Probabilities(scores, pointProbabilities);
+  probabilities = pointProbabilities.col(0);
+  prediction = probabilities.index_max();
+}
+
+template<typename MatType>
+void GradientBoosting::Classify(const MatType& data,
+                                arma::Row<size_t>& predictions) const
+{
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename MatType>
+void GradientBoosting::Classify(const MatType& data,
+                                arma::Row<size_t>& predictions,
+                                arma::mat& probabilities) const
+{
+  if (numClasses == 0)
+  {
+    predictions.clear();
+    probabilities.clear();
+
+    throw std::invalid_argument("GradientBoosting::Classify(): no model "
+        "trained!");
+  }
+
+  arma::mat scores = arma::repmat(initialScores, 1, data.n_cols);
+  AddScores(data, 0, scores);
+  Probabilities(scores, probabilities);
+  predictions = arma::conv_to<arma::Row<size_t>>::from(
+      arma::index_max(probabilities, 0));
+}
+
+template<typename Archive>
+void GradientBoosting::serialize(Archive& ar, const uint32_t /* version */)
+{
+  if (cereal::is_loading<Archive>())
+    trees.clear();
+
+  ar(CEREAL_NVP(numClasses));
+  ar(CEREAL_NVP(initialScores));
+  ar(CEREAL_NVP(trees));
+}
+
+template<typename MatType>
+double GradientBoosting::TrainInternal(
+    const MatType& dataset,
+    const arma::Row<size_t>& labels,
+    const size_t numClasses,
+    const MatType* validationDataset,
+    const arma::Row<size_t>* validationLabels,
+    const size_t earlyStoppingRounds,
+    const size_t numRounds,
+    const double learningRate,
+    const size_t maximumDepth,
+    const size_t minimumLeafSize,
+    const double lambda,
+    const double minimumGainSplit,
+    const double subsample,
+    const double columnSubsample)
+{
+  util::CheckSameSizes(dataset, labels, "GradientBoosting::Train()");
+  if (dataset.n_cols == 0 || dataset.n_rows == 0)
+  {
+    throw std::invalid_argument("GradientBoosting::Train(): the dataset is "
+        "empty!");
+  }
+  if (numClasses < 2)
+  {
+    throw std::invalid_argument("GradientBoosting::Train(): there must be at "
+        "least two classes!");
+  }
+  if (arma::max(labels) >= numClasses ||
+      (validationLabels && arma::max(*validationLabels) >= numClasses))
+  {
+    throw std::invalid_argument("GradientBoosting::Train(): labels must be "
+        "less than the number of classes!");
+  }
+  if (!(learningRate > 0.0) || !(subsample > 0.0 && subsample <= 1.0) ||
+      !(columnSubsample > 0.0 && columnSubsample <= 1.0) || lambda < 0.0)
+  {
+    throw std::invalid_argument("GradientBoosting::Train(): the learning rate "
+        "must be positive, the subsampling fractions must be in (0, 1], and "
+        "lambda must be nonnegative!");
+  }
+
+  this->numClasses = numClasses;
+  trees.clear();
+
+  const size_t n = dataset.n_cols;
+  const size_t outputs = NumOutputs();
+
+  arma::Mat<unsigned char> bins;
+  std::vector<arma::vec> splitPoints;
+  Bin(dataset, bins, splitPoints);
+
+  // Start from the (smoothed) log-prior of each class, or the log-odds of
+  // class 1 for two classes.
+  arma::vec priors(numClasses);
+  priors.fill(1.0);
+  for (size_t i = 0; i < n; ++i)
+    priors[labels[i]] += 1.0;
+  priors /= arma::accu(priors);
+  if (outputs == 1)
+    initialScores = arma::vec({ std::log(priors[1] / priors[0]) });
+  else
+    initialScores = arma::log(priors);
+
+  arma::mat scores = arma::repmat(initialScores, 1, n);
+  arma::mat validationScores;
+  if (validationDataset)
+  {
+    validationScores = arma::repmat(initialScores, 1,
+        validationDataset->n_cols);
+  }
+
+  const size_t numSampled = std::max((size_t) std::ceil(subsample * n),
+      (size_t) 1);
+  const size_t numDimensions = std::max((size_t) std::ceil(columnSubsample *
+      dataset.n_rows), (size_t) 1);
+  const arma::uvec allPoints = arma::regspace<arma::uvec>(0, n - 1);
+  const arma::uvec allDimensions =
+      arma::regspace<arma::uvec>(0, dataset.n_rows - 1);
+
+  arma::mat probabilities;
+  arma::vec gradients(n), hessians(n);
+  double bestLoss = DBL_MAX;
+  size_t bestRounds = 0;
+  for (size_t round = 0; round < numRounds; ++round)
+  {
+    Probabilities(scores, probabilities);
+
+    const arma::uvec points = (numSampled < n) ?
+        arma::uvec(arma::sort(arma::randperm<arma::uvec>(n, numSampled))) :
+        allPoints;
+
+    for (size_t k = 0; k < outputs; ++k)
+    {
+      // The gradient and Hessian of the log-loss with respect to the score of
+      // class c are p_c - [y = c] and p_c (1 - p_c).
+      const size_t c = (outputs == 1) ? 1 : k;
+      #pragma omp parallel for
+      for (omp_size_t i = 0; i < (omp_size_t) n; ++i)
+      {
+        const double p = probabilities(c, i);
+        gradients[i] = p - ((labels[i] == c) ? 1.0 : 0.0);
+        hessians[i] = std::max(p * (1.0 - p), 1e-16);
+      }
+
+      const arma::uvec dimensions = (numDimensions < dataset.n_rows) ?
+          arma::uvec(arma::sort(arma::randperm<arma::uvec>(dataset.n_rows,
+          numDimensions))) : allDimensions;
+
+      arma::uvec treePoints(points);
+      trees.push_back(GradientBoostingTree());
+      trees.back().Train(bins, splitPoints, gradients, hessians, treePoints,
+          dimensions, maximumDepth, minimumLeafSize, lambda, minimumGainSplit,
+          learningRate);
+    }
+
+    AddScores(dataset, trees.size() - outputs, scores);
+    if (!validationDataset)
+      continue;
+
+    // Keep going as long as the validation loss improves.
+    arma::mat validationProbabilities;
+    AddScores(*validationDataset, trees.size() - outputs, validationScores);
+    Probabilities(validationScores, validationProbabilities);
+    const double loss = LogLoss(validationProbabilities, *validationLabels);
+    Log::Debug << "GradientBoosting::Train(): round " << round + 1
+        << ", validation log-loss " << loss << "." << std::endl;
+    if (loss < bestLoss)
+    {
+      bestLoss = loss;
+      bestRounds = round + 1;
+    }
+    else if (round + 1 - bestRounds >= earlyStoppingRounds)
+    {
+      Log::Info << "GradientBoosting::Train(): stopping after " << round + 1
+          << " rounds; the best validation log-loss was at round "
+          << bestRounds << "." << std::endl;
+      break;
+    }
+  }
+
+  if (validationDataset)
+  {
+    trees.resize(bestRounds * outputs);
+    return bestLoss;
+  }
+
+  Probabilities(scores, probabilities);
+  return LogLoss(probabilities, labels);
+}
+
+template<typename MatType>
+void GradientBoosting::Bin(const MatType& dataset,
+                           arma::Mat<unsigned char>& bins,
+                           std::vector<arma::vec>& splitPoints)
+{
+  static_assert(BinningType::MaxBins <= 256, "The bin indices must fit in an "
+      "unsigned char.");
+
+  bins.set_size(dataset.n_cols, dataset.n_rows);
+  splitPoints.resize(dataset.n_rows);
+
+  // Each dimension is binned separately.
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t d = 0; d < (omp_size_t) dataset.n_rows; ++d)
+  {
+    arma::Row<unsigned char> dimensionBins;
+    BinningType::BinDimension(dataset.row(d), dimensionBins, splitPoints[d]);
+    bins.col(d) = dimensionBins.t();
+  }
+}
+
+template<typename MatType>
+void GradientBoosting::AddScores(const MatType& dataset,
+                                 const size_t firstTree,
+                                 arma::mat& scores) const
+{
+  const size_t outputs = NumOutputs();
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) dataset.n_cols; ++i)
+  {
+    for (size_t t = firstTree; t < trees.size(); ++t)
+      scores(t % outputs, i) += trees[t].Predict(dataset.col(i));
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
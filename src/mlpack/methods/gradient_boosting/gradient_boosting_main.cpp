@@ -0,0 +1,331 @@
+/**
+ * @file methods/gradient_boosting/gradient_boosting_main.cpp
+ *
+ * A program to build and evaluate gradient boosting classifiers.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/gradient_boosting/gradient_boosting.hpp>
+#include <mlpack/core/util/mlpack_main.hpp>
+
+using namespace mlpack;
+using namespace mlpack::tree;
+using namespace mlpack::util;
+using namespace std;
+
+// Program Name.
+BINDING_NAME("Gradient boosting");
+
+// Short description.
+BINDING_SHORT_DESC(
+    "An implementation of gradient boosted decision trees for classification. "
+    " Given labeled data, a gradient boosting model can be trained and saved "
+    "for future use; or, a pre-trained model can be used for classification.");
+
+// Long description.
+BINDING_LONG_DESC(
+    "This program is an implementation of gradient boosted decision trees for "
+    "classification.  In each boosting round, regression trees are fitted to "
+    "the gradients and Hessians of the log-loss of the model so far, and their "
+    "predictions, shrunk by the learning rate, are added to the model.  The "
+    "training data is binned into at most 256 bins per dimension before "
+    "training, and the trees are grown from histograms of the binned data."
+    "\n\n"
+    "The training set and associated labels are specified with the " +
+    PRINT_PARAM_STRING("training") + " and " + PRINT_PARAM_STRING("labels") +
+    " parameters, respectively.  The labels should be in the range [0, "
+    "num_classes - 1].  The " + PRINT_PARAM_STRING("num_rounds") + " parameter "
+    "sets the number of boosting rounds; one tree is built in each round for "
+    "two classes, and one tree per class otherwise.  The " +
+    PRINT_PARAM_STRING("learning_rate") + " parameter sets the shrinkage "
+    "applied to each tree.  The " + PRINT_PARAM_STRING("maximum_depth") + ", " +
+    PRINT_PARAM_STRING("minimum_leaf_size") + ", " +
+    PRINT_PARAM_STRING("lambda") + " and " +
+    PRINT_PARAM_STRING("minimum_gain_split") + " parameters control the size "
+    "of each tree and the regularization of its leaves.  The " +
+    PRINT_PARAM_STRING("subsample") + " and " +
+    PRINT_PARAM_STRING("column_subsample") + " parameters set the fraction of "
+    "points used in each round and the fraction of dimensions used by each "
+    "tree."
+    "\n\n"
+    "If a validation set is given with the " +
+    PRINT_PARAM_STRING("validation") + " and " +
+    PRINT_PARAM_STRING("validation_labels") + " parameters, training stops "
+    "when the log-loss on the validation set has not improved for " +
+    PRINT_PARAM_STRING("early_stopping_rounds") + " rounds, and the model is "
+    "cut back to the round with the lowest validation log-loss."
+    "\n\n"
+    "When a model is trained, the " + PRINT_PARAM_STRING("output_model") + " "
+    "output parameter may be used to save the trained model.  A model may be "
+    "loaded for predictions with the " + PRINT_PARAM_STRING("input_model") +
+    " parameter.  The " + PRINT_PARAM_STRING("input_model") + " parameter may "
+    "not be specified when the " + PRINT_PARAM_STRING("training") + " parameter"
+    " is specified.  If " + PRINT_PARAM_STRING("print_training_accuracy") +
+    " is specified, the accuracy on the training set will be printed."
+    "\n\n"
+    "Test data may be specified with the " + PRINT_PARAM_STRING("test") + " "
+    "parameter, and if performance measures are desired for that test set, "
+    "labels for the test points may be specified with the " +
+    PRINT_PARAM_STRING("test_labels") + " parameter.  Predictions for each "
+    "test point may be saved via the " + PRINT_PARAM_STRING("predictions") +
+    " output parameter.  Class probabilities for each prediction may be saved "
+    "with the " + PRINT_PARAM_STRING("probabilities") + " output parameter.");
+
+// Example.
+BINDING_EXAMPLE(
+    "For example, to train a gradient boosting model with 200 rounds and a "
+    "learning rate of 0.05 on the dataset contained in " +
+    PRINT_DATASET("data") + " with labels " + PRINT_DATASET("labels") + ", "
+    "saving the model to " + PRINT_MODEL("gb_model") + " and printing the "
+    "training accuracy, one could call"
+    "\n\n" +
+    PRINT_CALL("gradient_boosting", "training", "data", "labels", "labels",
+        "num_rounds", 200, "learning_rate", 0.05, "output_model", "gb_model",
+        "print_training_accuracy", true) +
+    "\n\n"
+    "Then, to use that model to classify points in " +
+    PRINT_DATASET("test_set") + " and print the test accuracy given the labels "
+    + PRINT_DATASET("test_labels") + ", while saving the predictions for each "
+    "point to " + PRINT_DATASET("predictions") + ", one could call "
+    "\n\n" +
+    PRINT_CALL("gradient_boosting", "input_model", "gb_model", "test",
+        "test_set", "test_labels", "test_labels", "predictions",
+        "predictions"));
+
+// See also...
+BINDING_SEE_ALSO("@random_forest", "#random_forest");
+BINDING_SEE_ALSO("@decision_tree", "#decision_tree");
+BINDING_SEE_ALSO("@adaboost", "#adaboost");
+BINDING_SEE_ALSO("Gradient boosting on Wikipedia",
+        "https://en.wikipedia.org/wiki/Gradient_boosting");
+BINDING_SEE_ALSO("XGBoost: A Scalable Tree Boosting System (pdf)",
+        "https://arxiv.org/pdf/1603.02754.pdf");
+BINDING_SEE_ALSO("mlpack::tree::GradientBoosting C++ class documentation",
+        "@doxygen/classmlpack_1_1tree_1_1GradientBoosting.html");
+
+PARAM_MATRIX_IN("training", "Training dataset.", "t");
+PARAM_UROW_IN("labels", "Labels for training dataset.", "l");
+PARAM_MATRIX_IN("validation", "Validation dataset for early stopping.", "");
+PARAM_UROW_IN("validation_labels", "Labels for validation dataset.", "");
+PARAM_MATRIX_IN("test", "Test dataset to produce predictions for.", "T");
+PARAM_UROW_IN("test_labels", "Test dataset labels, if accuracy calculation is "
+    "desired.", "L");
+
+PARAM_FLAG("print_training_accuracy", "If set, then the accuracy of the model "
+    "on the training set will be predicted (verbose must also be specified).",
+    "a");
+
+PARAM_INT_IN("num_rounds", "Number of boosting rounds.", "N", 100);
+PARAM_DOUBLE_IN("learning_rate", "Shrinkage applied to each tree.", "r", 0.1);
+PARAM_INT_IN("maximum_depth", "Maximum depth of each tree (0 means no limit).",
+    "D", 6);
+PARAM_INT_IN("minimum_leaf_size", "Minimum number of points in each leaf "
+    "node.", "n", 20);
+PARAM_DOUBLE_IN("lambda", "L2 regularization of the values of the leaves.",
+    "", 1.0);
+PARAM_DOUBLE_IN("minimum_gain_split", "Minimum gain needed to make a split "
+    "when building a tree.", "g", 0.0);
+PARAM_DOUBLE_IN("subsample", "Fraction of the training points used in each "
+    "round.", "S", 1.0);
+PARAM_DOUBLE_IN("column_subsample", "Fraction of the dimensions used by each "
+    "tree.", "c", 1.0);
+PARAM_INT_IN("early_stopping_rounds", "Number of rounds without improvement "
+    "of the validation log-loss after which training stops.", "e", 10);
+
+PARAM_MATRIX_OUT("probabilities", "Predicted class probabilities for each "
+    "point in the test set.", "P");
+PARAM_UROW_OUT("predictions", "Predicted classes for each point in the test "
+    "set.", "p");
+
+PARAM_INT_IN("seed", "Random seed.  If 0, 'std::time(NULL)' is used.", "s", 0);
+
+/**
+ * This is the class that we will serialize.  It is a simple wrapper around
+ * GradientBoosting.
+ */
+class GradientBoostingModel
+{
+ public:
+  // The model itself, left public for direct access by this program.
+  GradientBoosting gb;
+
+  // Create the model.
+  GradientBoostingModel() { /* Nothing to do. */ }
+
+  // Serialize the model.
+  template<typename Archive>
+  void serialize(Archive& ar, const uint32_t /* version */)
+  {
+    ar(CEREAL_NVP(gb));
+  }
+};
+
+PARAM_MODEL_IN(GradientBoostingModel, "input_model", "Pre-trained gradient "
+    "boosting model to use for classification.", "m");
+PARAM_MODEL_OUT(GradientBoostingModel, "output_model", "Model to save trained "
+    "gradient boosting model to.", "M");
+
+static void mlpackMain()
+{
+  // Initialize random seed if needed.
+  if (IO::GetParam<int>("seed") != 0)
+    math::RandomSeed((size_t) IO::GetParam<int>("seed"));
+  else
+    math::RandomSeed((size_t) std::time(NULL));
+
+  // Check for incompatible input parameters.
+  RequireOnlyOnePassed({ "training", "input_model" }, true);
+
+  ReportIgnoredParam({{ "training", false }}, "print_training_accuracy");
+  ReportIgnoredParam({{ "training", false }}, "validation");
+  ReportIgnoredParam({{ "validation", false }}, "early_stopping_rounds");
+  ReportIgnoredParam({{ "test", false }}, "test_labels");
+
+  RequireAtLeastOnePassed({ "test", "output_model", "print_training_accuracy" },
+      false, "the trained model will not be used or saved");
+
+  if (IO::HasParam("training"))
+  {
+    RequireAtLeastOnePassed({ "labels" }, true, "must pass labels when training"
+        " set given");
+  }
+  if (IO::HasParam("validation"))
+  {
+    RequireAtLeastOnePassed({ "validation_labels" }, true, "must pass labels "
+        "when validation set given");
+  }
+
+  ReportIgnoredParam({{ "test", false }}, "predictions");
+  ReportIgnoredParam({{ "test", false }}, "probabilities");
+
+  RequireParamValue<int>("num_rounds", [](int x) { return x > 0; }, true,
+      "number of rounds must be positive");
+  RequireParamValue<double>("learning_rate", [](double x) { return x > 0.0; },
+      true, "learning rate must be positive");
+  RequireParamValue<int>("minimum_leaf_size", [](int x) { return x > 0; }, true,
+      "minimum leaf size must be greater than 0");
+  RequireParamValue<int>("maximum_depth", [](int x) { return x >= 0; }, true,
+      "maximum depth must not be negative");
+  RequireParamValue<double>("lambda", [](double x) { return x >= 0.0; }, true,
+      "lambda must be nonnegative");
+  RequireParamValue<double>("minimum_gain_split",
+      [](double x) { return x >= 0.0; }, true,
+      "minimum gain for splitting must be nonnegative");
+  RequireParamValue<double>("subsample",
+      [](double x) { return x > 0.0 && x <= 1.0; }, true,
+      "subsample fraction must be in (0, 1]");
+  RequireParamValue<double>("column_subsample",
+      [](double x) { return x > 0.0 && x <= 1.0; }, true,
+      "column subsample fraction must be in (0, 1]");
+  RequireParamValue<int>("early_stopping_rounds", [](int x) { return x > 0; },
+      true, "number of early stopping rounds must be positive");
+
+  GradientBoostingModel* gbModel;
+  if (IO::HasParam("input_model"))
+    gbModel = IO::GetParam<GradientBoostingModel*>("input_model");
+  else
+    gbModel = new GradientBoostingModel();
+
+  if (IO::HasParam("training"))
+  {
+    Timer::Start("gb_training");
+
+    // Train the model on the given input data.
+    arma::mat data = std::move(IO::GetParam<arma::mat>("training"));
+    arma::Row<size_t> labels =
+        std::move(IO::GetParam<arma::Row<size_t>>("labels"));
+
+    const size_t numRounds = (size_t) IO::GetParam<int>("num_rounds");
+    const double learningRate = IO::GetParam<double>("learning_rate");
+    const size_t maxDepth = (size_t) IO::GetParam<int>("maximum_depth");
+    const size_t minimumLeafSize =
+        (size_t) IO::GetParam<int>("minimum_leaf_size");
+    const double lambda = IO::GetParam<double>("lambda");
+    const double minimumGainSplit = IO::GetParam<double>("minimum_gain_split");
+    const double subsample = IO::GetParam<double>("subsample");
+    const double columnSubsample = IO::GetParam<double>("column_subsample");
+
+    // Two classes are needed even if the labels only have one.
+    const size_t numClasses = std::max((size_t) arma::max(labels) + 1,
+        (size_t) 2);
+
+    Log::Info << "Training gradient boosting model with " << numRounds
+        << " rounds..." << endl;
+
+    if (IO::HasParam("validation"))
+    {
+      arma::mat validation = std::move(IO::GetParam<arma::mat>("validation"));
+      arma::Row<size_t> validationLabels =
+          std::move(IO::GetParam<arma::Row<size_t>>("validation_labels"));
+      const size_t earlyStoppingRounds =
+          (size_t) IO::GetParam<int>("early_stopping_rounds");
+
+      const double loss = gbModel->gb.Train(data, labels, numClasses,
+          validation, validationLabels, earlyStoppingRounds, numRounds,
+          learningRate, maxDepth, minimumLeafSize, lambda, minimumGainSplit,
+          subsample, columnSubsample);
+      Log::Info << "Kept " << gbModel->gb.NumRounds() << " rounds, with "
+          << "validation log-loss " << loss << "." << endl;
+    }
+    else
+    {
+      gbModel->gb.Train(data, labels, numClasses, numRounds, learningRate,
+          maxDepth, minimumLeafSize, lambda, minimumGainSplit, subsample,
+          columnSubsample);
+    }
+
+    Timer::Stop("gb_training");
+
+    // Did we want training accuracy?
+    if (IO::HasParam("print_training_accuracy"))
+    {
+      Timer::Start("gb_prediction");
+      arma::Row<size_t> predictions;
+      gbModel->gb.Classify(data, predictions);
+
+      const size_t correct = arma::accu(predictions == labels);
+
+      Log::Info << correct << " of " << labels.n_elem << " correct on training"
+          << " set (" << (double(correct) / double(labels.n_elem) * 100) << ")."
+          << endl;
+      Timer::Stop("gb_prediction");
+    }
+  }
+
+  if (IO::HasParam("test"))
+  {
+    arma::mat testData = std::move(IO::GetParam<arma::mat>("test"));
+    Timer::Start("gb_prediction");
+
+    // Get predictions and probabilities.
+    arma::Row<size_t> predictions;
+    arma::mat probabilities;
+    gbModel->gb.Classify(testData, predictions, probabilities);
+
+    Timer::Stop("gb_prediction");
+
+    // Did we want to calculate test accuracy?
+    if (IO::HasParam("test_labels"))
+    {
+      arma::Row<size_t> testLabels =
+          std::move(IO::GetParam<arma::Row<size_t>>("test_labels"));
+
+      const size_t correct = arma::accu(predictions == testLabels);
+
+      Log::Info << correct << " of " << testLabels.n_elem << " correct on test"
+          << " set (" << (double(correct) / double(testLabels.n_elem) * 100)
+          << ")." << endl;
+    }
+
+    // Save the outputs.
+    IO::GetParam<arma::mat>("probabilities") = std::move(probabilities);
+    IO::GetParam<arma::Row<size_t>>("predictions") = std::move(predictions);
+  }
+
+  // Save the output model.
+  IO::GetParam<GradientBoostingModel*>("output_model") = gbModel;
+}
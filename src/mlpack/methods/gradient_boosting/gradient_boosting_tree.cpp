@@ -0,0 +1,186 @@
+/**
+ * @file methods/gradient_boosting/gradient_boosting_tree.cpp
+ *
+ * Implementation of the training of GradientBoostingTree.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include "gradient_boosting_tree.hpp"
+
+#include <algorithm>
+
+namespace mlpack {
+namespace tree {
+
+// The number of bins a dimension can have; bin indices are stored in unsigned
+// chars.
+static const size_t maxBins = 256;
+
+// Below this number of (point, dimension) pairs, a node is not worth the
+// overhead of a parallel region.
+static const size_t minParallelWork = 16384;
+
+void GradientBoostingTree::Train(const arma::Mat<unsigned char>& bins,
+                                 const std::vector<arma::vec>& splitPoints,
+                                 const arma::vec& gradients,
+                                 const arma::vec& hessians,
+                                 arma::uvec& points,
+                                 const arma::uvec& dimensions,
+                                 const size_t maximumDepth,
+                                 const size_t minimumLeafSize,
+                                 const double lambda,
+                                 const double minimumGainSplit,
+                                 const double scale)
+{
+  splitDimensions.assign(1, 0);
+  values.assign(1, 0.0);
+  children.assign(1, 0);
+
+  if (points.n_elem == 0)
+    return;
+
+  const Context context = { bins, splitPoints, gradients, hessians, points,
+      dimensions, maximumDepth, minimumLeafSize, lambda, minimumGainSplit,
+      scale };
+
+  Histogram histogram;
+  BuildHistogram(context, 0, points.n_elem, histogram);
+  Grow(context, 0, 0, points.n_elem, 1, histogram);
+}
+
+void GradientBoostingTree::BuildHistogram(const Context& context,
+                                          const size_t begin,
+                                          const size_t count,
+                                          Histogram& histogram)
+{
+  const size_t numDimensions = context.dimensions.n_elem;
+  histogram.gradients.zeros(maxBins, numDimensions);
+  histogram.hessians.zeros(maxBins, numDimensions);
+  histogram.counts.zeros(maxBins, numDimensions);
+
+  // Each dimension has its own column of the histogram, so they can be built
+  // independently.
+  const arma::uvec& points = context.points;
+  #pragma omp parallel for if (count * numDimensions >= minParallelWork)
+  for (omp_size_t j = 0; j < (omp_size_t) numDimensions; ++j)
+  {
+    const unsigned char* bins = context.bins.colptr(context.dimensions[j]);
+    double* gradients = histogram.gradients.colptr(j);
+    double* hessians = histogram.hessians.colptr(j);
+    arma::uword* counts = histogram.counts.colptr(j);
+    for (size_t i = begin; i < begin + count; ++i)
+    {
+      const size_t point = points[i];
+      const size_t bin = bins[point];
+      gradients[bin] += context.gradients[point];
+      hessians[bin] += context.hessians[point];
+      ++counts[bin];
+    }
+  }
+}
+
+void GradientBoostingTree::Grow(const Context& context,
+                                const size_t node,
+                                const size_t begin,
+                                const size_t count,
+                                const size_t depth,
+                                const Histogram& histogram)
+{
+  // Every column of the histogram holds all the points of the node.
+  const double lambda = context.lambda;
+  const double sumGradients = arma::accu(histogram.gradients.col(0));
+  const double sumHessians = arma::accu(histogram.hessians.col(0));
+  values[node] = -context.scale * sumGradients / (sumHessians + lambda);
+
+  if ((context.maximumDepth != 0 && depth >= context.maximumDepth) ||
+      count < 2 * context.minimumLeafSize)
+    return;
+
+  // Find the best split of each dimension.  Splitting after bin b sends the
+  // points of bins 0 to b to the left child.
+  const size_t numDimensions = context.dimensions.n_elem;
+  const double nodeScore = sumGradients * sumGradients / (sumHessians + lambda);
+  arma::vec gains(numDimensions);
+  gains.fill(-DBL_MAX);
+  arma::uvec splitBins(numDimensions, arma::fill::zeros);
+  #pragma omp parallel for if (maxBins * numDimensions >= minParallelWork)
+  for (omp_size_t j = 0; j < (omp_size_t) numDimensions; ++j)
+  {
+    const size_t numSplits =
+        context.splitPoints[context.dimensions[j]].n_elem;
+    double leftGradients = 0.0, leftHessians = 0.0;
+    size_t leftCount = 0;
+    for (size_t b = 0; b < numSplits; ++b)
+    {
+      leftGradients += histogram.gradients(b, j);
+      leftHessians += histogram.hessians(b, j);
+      leftCount += histogram.counts(b, j);
+      if (leftCount < context.minimumLeafSize)
+        continue;
+      if (count - leftCount < context.minimumLeafSize)
+        break;
+
+      const double rightGradients = sumGradients - leftGradients;
+      const double rightHessians = sumHessians - leftHessians;
+      const double gain =
+          leftGradients * leftGradients / (leftHessians + lambda) +
+          rightGradients * rightGradients / (rightHessians + lambda) -
+          nodeScore;
+      if (gain > gains[j])
+      {
+        gains[j] = gain;
+        splitBins[j] = b;
+      }
+    }
+  }
+
+  // Take the best dimension; if several are equally good, the first one, so
+  // that the tree does not depend on the number of threads.
+  const size_t best = gains.index_max();
+  if (gains[best] <= context.minimumGainSplit)
+    return;
+
+  const size_t dimension = context.dimensions[best];
+  const size_t splitBin = splitBins[best];
+
+  // Move the points of the left child to the front of the node.
+  const unsigned char* bins = context.bins.colptr(dimension);
+  arma::uword* first = context.points.memptr() + begin;
+  arma::uword* middle = std::partition(first, first + count,
+      [bins, splitBin](const arma::uword point)
+      {
+        return (size_t) bins[point] <= splitBin;
+      });
+  const size_t leftCount = middle - first;
+
+  const size_t left = values.size();
+  splitDimensions[node] = dimension;
+  values[node] = context.splitPoints[dimension][splitBin];
+  children[node] = left;
+  splitDimensions.resize(left + 2, 0);
+  values.resize(left + 2, 0.0);
+  children.resize(left + 2, 0);
+
+  // Only the smaller child is scanned; the histogram of the larger child is
+  // what remains of the histogram of the node.
+  const bool leftSmaller = (leftCount <= count - leftCount);
+  Histogram smaller, larger;
+  if (leftSmaller)
+    BuildHistogram(context, begin, leftCount, smaller);
+  else
+    BuildHistogram(context, begin + leftCount, count - leftCount, smaller);
+  larger.gradients = histogram.gradients - smaller.gradients;
+  larger.hessians = histogram.hessians - smaller.hessians;
+  larger.counts = histogram.counts - smaller.counts;
+
+  Grow(context, left, begin, leftCount, depth + 1,
+      leftSmaller ? smaller : larger);
+  Grow(context, left + 1, begin + leftCount, count - leftCount, depth + 1,
+      leftSmaller ? larger : smaller);
+}
+
+} // namespace tree
+} // namespace mlpack
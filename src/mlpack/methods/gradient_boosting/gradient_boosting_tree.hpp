@@ -0,0 +1,173 @@
+/**
+ * @file methods/gradient_boosting/gradient_boosting_tree.hpp
+ *
+ * Definition of GradientBoostingTree, the regression tree that GradientBoosting
+ * fits to the gradients and Hessians of its loss in each round.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_TREE_HPP
+#define MLPACK_METHODS_GRADIENT_BOOSTING_GRADIENT_BOOSTING_TREE_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A regression tree fitted to the gradients and Hessians of a loss, as used by
+ * GradientBoosting.  If G and H are the sums of the gradients and Hessians of
+ * the points of a node, its value is the Newton step -G / (H + lambda), and
+ * each split maximizes
+ *
+ *   G_L^2 / (H_L + lambda) + G_R^2 / (H_R + lambda) - G^2 / (H + lambda),
+ *
+ * where L and R denote the left and right children.
+ *
+ * The tree is trained on binned data (see
+ * HistogramNumericSplit::BinDimension()).  The split of a node is found from
+ * the sums of the gradients and Hessians of its points in each bin of each
+ * dimension; these histograms are built in parallel over the dimensions, and
+ * the histograms of the larger child of each split are found by subtracting
+ * those of the smaller child from those of the node, so only the smaller child
+ * is ever scanned.
+ *
+ * The nodes are held in flat arrays, so that the many small trees of a boosted
+ * ensemble are cheap to store and to evaluate.
+ */
+class GradientBoostingTree
+{
+ public:
+  //! Create an empty tree.  Train() must be called before Predict().
+  GradientBoostingTree() { }
+
+  /**
+   * Train the tree on the given points of a binned dataset.
+   *
+   * @param bins Bin index of each point (row) in each dimension (column).
+   * @param splitPoints For each dimension, the split point between each pair
+   *     of adjacent bins.
+   * @param gradients Gradient of the loss for each point.
+   * @param hessians Hessian of the loss for each point.
+   * @param points Points to train on; they are reordered.
+   * @param dimensions Dimensions that may be split on.
+   * @param maximumDepth Maximum depth of the tree (0 means no limit).
+   * @param minimumLeafSize Minimum number of points in each leaf.
+   * @param lambda L2 regularization of the values of the leaves.
+   * @param minimumGainSplit Minimum gain for a node to split.
+   * @param scale Factor that the value of each leaf is multiplied by (the
+   *     learning rate of the ensemble).
+   */
+  void Train(const arma::Mat<unsigned char>& bins,
+             const std::vector<arma::vec>& splitPoints,
+             const arma::vec& gradients,
+             const arma::vec& hessians,
+             arma::uvec& points,
+             const arma::uvec& dimensions,
+             const size_t maximumDepth,
+             const size_t minimumLeafSize,
+             const double lambda,
+             const double minimumGainSplit,
+             const double scale);
+
+  /**
+   * Get the value of the leaf that the given point falls into.
+   *
+   * @param point Point to evaluate the tree at.
+   */
+  template<typename VecType>
+  double Predict(const VecType& point) const
+  {
+    size_t node = 0;
+    while (children[node] != 0)
+    {
+      node = children[node] +
+          ((point[splitDimensions[node]] <= values[node]) ? 0 : 1);
+    }
+
+    return values[node];
+  }
+
+  //! Get the number of nodes in the tree.
+  size_t NumNodes() const { return values.size(); }
+
+  /**
+   * Serialize the tree.
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const uint32_t /* version */)
+  {
+    ar(CEREAL_NVP(splitDimensions));
+    ar(CEREAL_NVP(values));
+    ar(CEREAL_NVP(children));
+  }
+
+ private:
+  //! The dimension each node splits on (unused for leaves).
+  std::vector<size_t> splitDimensions;
+  //! The split point of each node, or its value if it is a leaf.  Points not
+  //! greater than the split point go to the left child.
+  std::vector<double> values;
+  //! The index of the left child of each node, or 0 if it is a leaf.  The
+  //! right child always follows the left child.
+  std::vector<size_t> children;
+
+  //! The sums of the gradients and Hessians, and the number of points, in each
+  //! bin (row) of each candidate dimension (column) for the points of a node.
+  struct Histogram
+  {
+    arma::mat gradients;
+    arma::mat hessians;
+    arma::umat counts;
+  };
+
+  //! Everything the nodes of a tree are trained with.
+  struct Context
+  {
+    const arma::Mat<unsigned char>& bins;
+    const std::vector<arma::vec>& splitPoints;
+    const arma::vec& gradients;
+    const arma::vec& hessians;
+    arma::uvec& points;
+    const arma::uvec& dimensions;
+    const size_t maximumDepth;
+    const size_t minimumLeafSize;
+    const double lambda;
+    const double minimumGainSplit;
+    const double scale;
+  };
+
+  /**
+   * Build the histogram of the given points.
+   */
+  static void BuildHistogram(const Context& context,
+                             const size_t begin,
+                             const size_t count,
+                             Histogram& histogram);
+
+  /**
+   * Train the given node, which holds the points in [begin, begin + count) of
+   * the context's points, and its children.
+   *
+   * @param context Training data and parameters.
+   * @param node Index of the node.
+   * @param begin Index of the first point of the node.
+   * @param count Number of points of the node.
+   * @param depth Depth of the node (the root has depth 1).
+   * @param histogram Histogram of the points of the node.
+   */
+  void Grow(const Context& context,
+            const size_t node,
+            const size_t begin,
+            const size_t count,
+            const size_t depth,
+            const Histogram& histogram);
+};
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
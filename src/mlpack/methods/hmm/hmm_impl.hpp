@@ -114,89 +114,132 @@ double HMM<Distribution>::Train(const std::vector<arma::mat>& dataSeq)
   }
 
   // These are used later for training of each distribution.  We initialize it
-  // all now so we don't have to do any allocation later on.
+  // all now so we don't have to do any allocation later on.  The observations
+  // of each sequence start at its offset in these.
   std::vector<arma::vec> emissionProb(logTransition.n_cols,
       arma::vec(totalLength));
   arma::mat emissionList(dimensionality, totalLength);
+  std::vector<size_t> offsets(dataSeq.size(), 0);
+  for (size_t seq = 1; seq < dataSeq.size(); ++seq)
+    offsets[seq] = offsets[seq - 1] + dataSeq[seq - 1].n_cols;
+
+  // The E-step is run in parallel over the sequences.  The sequences are
+  // split into a fixed number of contiguous chunks, the sufficient statistics
+  // of each chunk are accumulated separately, and the chunks are then merged
+  // in order, so the model does not depend on the number of threads.
+  const size_t numChunks = std::min(dataSeq.size(), (size_t) 64);
+  std::vector<arma::vec> chunkLogInitial(numChunks);
+  std::vector<arma::mat> chunkLogTransition(numChunks);
+  arma::vec chunkLoglik(numChunks);
 
   // This should be the Baum-Welch algorithm (EM for HMM estimation). This
   // follows the procedure outlined in Elliot, Aggoun, and Moore's book "Hidden
   // Markov Models: Estimation and Control", pp. 36-40.
   for (size_t iter = 0; iter < iterations; iter++)
   {
-    // Clear new transition matrix and emission probabilities.
-    arma::vec newLogInitial(logTransition.n_rows);
-    newLogInitial.fill(-std::numeric_limits<double>::infinity());
-    arma::mat newLogTransition(logTransition.n_rows, logTransition.n_cols);
-    newLogTransition.fill(-std::numeric_limits<double>::infinity());
-
-    // Reset log likelihood.
-    loglik = 0;
-
-    // Sum over time.
-    size_t sumTime = 0;
+    // The log-space parameters are only read from here on, so make sure they
+    // are up to date before the threads use them.
+    ConvertToLogSpace();
 
-    // Loop over each sequence.
-    for (size_t seq = 0; seq < dataSeq.size(); seq++)
+    #pragma omp parallel for schedule(dynamic)
+    for (omp_size_t chunk = 0; chunk < (omp_size_t) numChunks; ++chunk)
     {
-      arma::mat stateLogProb;
-      arma::mat forwardLog;
-      arma::mat backwardLog;
-      arma::vec logScales;
-
-      // Add the log-likelihood of this sequence.  This is the E-step.
-      loglik += LogEstimate(dataSeq[seq], stateLogProb, forwardLog,
-          backwardLog, logScales);
-
-      // Add to estimate of initial probability for state j.
-      math::LogSumExp<arma::vec, true>(stateLogProb.unsafe_col(0),
-          newLogInitial);
-
-      // Define a variable to store the value of log-probability for data.
-      arma::mat logProbs(dataSeq[seq].n_cols, logTransition.n_rows);
-      // Save the values of log-probability to logProbs.
-      for (size_t i = 0; i < logTransition.n_rows; i++)
+      // Clear new transition matrix and initial probabilities.
+      arma::vec& newLogInitial = chunkLogInitial[chunk];
+      newLogInitial.set_size(logTransition.n_rows);
+      newLogInitial.fill(-std::numeric_limits<double>::infinity());
+      arma::mat& newLogTransition = chunkLogTransition[chunk];
+      newLogTransition.set_size(logTransition.n_rows, logTransition.n_cols);
+      newLogTransition.fill(-std::numeric_limits<double>::infinity());
+      chunkLoglik[chunk] = 0;
+
+      // Loop over each sequence of the chunk.
+      const size_t begin = (size_t) chunk * dataSeq.size() / numChunks;
+      const size_t end = ((size_t) chunk + 1) * dataSeq.size() / numChunks;
+      for (size_t seq = begin; seq < end; seq++)
       {
-        // Define alias of desired column.
-        arma::vec alias(logProbs.colptr(i), logProbs.n_rows, false, true);
-        // Use advanced constructor for using logProbs directly.
-        emission[i].LogProbability(dataSeq[seq], alias);
-      }
-
-      // Now re-estimate the parameters.  This is the M-step.
-      //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
-      //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t]) b(i,
-      //           t + 1)))
-      //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t) b(i, t)
-      // We store the new estimates in a different matrix.
-      for (size_t t = 0; t < dataSeq[seq].n_cols; ++t)
-      {
-        // Assemble temporary vector that's used in log-sum computation.
-        if (t < dataSeq[seq].n_cols - 1)
+        arma::mat stateLogProb;
+        arma::mat forwardLog;
+        arma::mat backwardLog;
+        arma::vec logScales;
+
+        // Add the log-likelihood of this sequence.  This is the E-step.
+        chunkLoglik[chunk] += LogEstimate(dataSeq[seq], stateLogProb,
+            forwardLog, backwardLog, logScales);
+
+        // Add to estimate of initial probability for state j.
+        math::LogSumExp<arma::vec, true>(stateLogProb.unsafe_col(0),
+            newLogInitial);
+
+        // Define a variable to store the value of log-probability for data.
+        arma::mat logProbs(dataSeq[seq].n_cols, logTransition.n_rows);
+        // Save the values of log-probability to logProbs.
+        for (size_t i = 0; i < logTransition.n_rows; i++)
         {
-          // This term is the same across all states, so compute it once and
-          // cache it.
-          const arma::vec tmp = backwardLog.col(t + 1) +
-              logProbs.row(t + 1).t() - logScales[t + 1];
-          arma::vec output;
-          math::LogSumExp(tmp, output);
+          // Define alias of desired column.
+          arma::vec alias(logProbs.colptr(i), logProbs.n_rows, false, true);
+          // Use advanced constructor for using logProbs directly.
+          emission[i].LogProbability(dataSeq[seq], alias);
+        }
 
-          for (size_t j = 0; j < logTransition.n_cols; ++j)
+        // Now re-estimate the parameters.  This is the M-step.
+        //   pi_i = sum_d ((1 / P(seq[d])) sum_t (f(i, 0) b(i, 0))
+        //   T_ij = sum_d ((1 / P(seq[d])) sum_t (f(i, t) T_ij E_i(seq[d][t])
+        //           b(i, t + 1)))
+        //   E_ij = sum_d ((1 / P(seq[d])) sum_{t | seq[d][t] = j} f(i, t)
+        //           b(i, t)
+        // We store the new estimates in a different matrix.
+        size_t sumTime = offsets[seq];
+        for (size_t t = 0; t < dataSeq[seq].n_cols; ++t)
+        {
+          // Assemble temporary vector that's used in log-sum computation.
+          if (t < dataSeq[seq].n_cols - 1)
           {
-            // Compute the estimate of T_ij (probability of transition from
-            // state j to state i).  We postpone multiplication of the old T_ij
-            // until later.
-            arma::vec tmp2 = output + forwardLog(j, t);
-            arma::vec alias = newLogTransition.unsafe_col(j);
-            math::LogSumExp<arma::vec, true>(tmp2, alias);
+            // This term is the same across all states, so compute it once
+            // and cache it.
+            const arma::vec tmp = backwardLog.col(t + 1) +
+                logProbs.row(t + 1).t() - logScales[t + 1];
+            arma::vec output;
+            math::LogSumExp(tmp, output);
+
+            for (size_t j = 0; j < logTransition.n_cols; ++j)
+            {
+              // Compute the estimate of T_ij (probability of transition from
+              // state j to state i).  We postpone multiplication of the old
+              // T_ij until later.
+              arma::vec tmp2 = output + forwardLog(j, t);
+              arma::vec alias = newLogTransition.unsafe_col(j);
+              math::LogSumExp<arma::vec, true>(tmp2, alias);
+            }
           }
+
+          // Add to list of emission observations, for Distribution::Train().
+          for (size_t j = 0; j < logTransition.n_cols; ++j)
+            emissionProb[j][sumTime] = exp(stateLogProb(j, t));
+          emissionList.col(sumTime) = dataSeq[seq].col(t);
+          sumTime++;
         }
+      }
+    }
 
-        // Add to list of emission observations, for Distribution::Train().
-        for (size_t j = 0; j < logTransition.n_cols; ++j)
-          emissionProb[j][sumTime] = exp(stateLogProb(j, t));
-        emissionList.col(sumTime) = dataSeq[seq].col(t);
-        sumTime++;
+    // Merge the statistics of the chunks.
+    arma::vec newLogInitial(logTransition.n_rows);
+    newLogInitial.fill(-std::numeric_limits<double>::infinity());
+    arma::mat newLogTransition(logTransition.n_rows, logTransition.n_cols);
+    newLogTransition.fill(-std::numeric_limits<double>::infinity());
+    loglik = 0;
+    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+      loglik += chunkLoglik[chunk];
+      for (size_t i = 0; i < newLogInitial.n_elem; ++i)
+      {
+        newLogInitial[i] = math::LogAdd(newLogInitial[i],
+            chunkLogInitial[chunk][i]);
+      }
+      for (size_t i = 0; i < newLogTransition.n_elem; ++i)
+      {
+        newLogTransition[i] = math::LogAdd(newLogTransition[i],
+            chunkLogTransition[chunk][i]);
       }
     }
 
@@ -547,6 +590,39 @@ double HMM<Distribution>::Predict(const arma::mat& dataSeq,
   return logStateProb(stateSeq(dataSeq.n_cols - 1), dataSeq.n_cols - 1);
 }
 
+/**
+ * Compute the most probable hidden state sequence of each of the given data
+ * sequences using the Viterbi algorithm.
+ */
+template<typename Distribution>
+void HMM<Distribution>::Predict(const std::vector<arma::mat>& dataSeq,
+                                std::vector<arma::Row<size_t>>& stateSeq) const
+{
+  arma::vec logLikelihoods;
+  Predict(dataSeq, stateSeq, logLikelihoods);
+}
+
+/**
+ * Compute the most probable hidden state sequence of each of the given data
+ * sequences using the Viterbi algorithm, and the log-likelihood of each of
+ * those state sequences.
+ */
+template<typename Distribution>
+void HMM<Distribution>::Predict(const std::vector<arma::mat>& dataSeq,
+                                std::vector<arma::Row<size_t>>& stateSeq,
+                                arma::vec& logLikelihoods) const
+{
+  stateSeq.resize(dataSeq.size());
+  logLikelihoods.set_size(dataSeq.size());
+
+  // The log-space parameters are only read by the threads.
+  ConvertToLogSpace();
+
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (omp_size_t i = 0; i < (omp_size_t) dataSeq.size(); ++i)
+    logLikelihoods[i] = Predict(dataSeq[i], stateSeq[i]);
+}
+
 /**
  * Compute the log-likelihood of the given data sequence.
  */
@@ -574,6 +650,23 @@ double HMM<Distribution>::LogLikelihood(const arma::mat& dataSeq) const
   return accu(logScales);
 }
 
+/**
+ * Compute the log-likelihood of each of the given data sequences.
+ */
+template<typename Distribution>
+void HMM<Distribution>::LogLikelihood(const std::vector<arma::mat>& dataSeq,
+                                      arma::vec& logLikelihoods) const
+{
+  logLikelihoods.set_size(dataSeq.size());
+
+  // The log-space parameters are only read by the threads.
+  ConvertToLogSpace();
+
+  #pragma omp parallel for schedule(dynamic, 16)
+  for (omp_size_t i = 0; i < (omp_size_t) dataSeq.size(); ++i)
+    logLikelihoods[i] = LogLikelihood(dataSeq[i]);
+}
+
 /**
  * Compute the log of the scaling factor of the given emission probability
  * at time t. To calculate the log-likelihood for the whole sequence,
@@ -748,11 +841,9 @@ arma::vec HMM<Distribution>::ForwardAtTn(const arma::vec& emissionLogProb,
   // The forward probability of state j at time t is the sum over all states of
   // the probability of the previous state transitioning to the current state
   // and emitting the given observation.  To do this computation in log-space,
-  // we can use LogSumExp().
+  // we can use LogSumExpProduct() with the transition matrix in linear space.
   arma::vec forwardLogProb;
-  arma::mat tmp = logTransition + repmat(prevForwardLogProb.t(),
-      logTransition.n_rows, 1);
-  math::LogSumExp(tmp, forwardLogProb);
+  math::LogSumExpProduct(transitionProxy, prevForwardLogProb, forwardLogProb);
   forwardLogProb += emissionLogProb;
 
   // Normalize probability.
@@ -816,12 +907,11 @@ void HMM<Distribution>::Backward(const arma::mat& dataSeq,
     // states of the probability of the next state having been a transition
     // from the current state multiplied by the probability of each of those
     // states emitting the given observation.  To compute this in log-space, we
-    // can use LogSumExpT().
-    const arma::mat tmp = logTransition +
-        repmat(backwardLogProb.col(t + 1), 1, logTransition.n_cols) +
-        repmat(logProbs.row(t + 1).t(), 1, logTransition.n_cols);
+    // can use LogSumExpProduct() with the transposed transition matrix.
+    const arma::vec tmp = backwardLogProb.col(t + 1) +
+        logProbs.row(t + 1).t();
     arma::vec alias = backwardLogProb.unsafe_col(t);
-    math::LogSumExpT<arma::mat, true>(tmp, alias);
+    math::LogSumExpProduct(transitionProxy.t(), tmp, alias);
 
     // Normalize by the weights from the forward algorithm.
     if (std::isfinite(logScales[t + 1]))
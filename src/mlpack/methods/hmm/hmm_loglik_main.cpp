@@ -43,7 +43,14 @@ BINDING_LONG_DESC(
     PRINT_PARAM_STRING("input_model") + " parameter, and evaluates the "
     "log-likelihood of a sequence of observations, given with the " +
     PRINT_PARAM_STRING("input") + " parameter.  The computed log-likelihood is"
-    " given as output.");
+    " given as output."
+    "\n\n"
+    "The log-likelihoods of many sequences can be computed at once, in "
+    "parallel: concatenate them in the " + PRINT_PARAM_STRING("input") +
+    " matrix and give the length of each with the " +
+    PRINT_PARAM_STRING("lengths") + " parameter.  The log-likelihood of each "
+    "sequence is then given by " + PRINT_PARAM_STRING("log_likelihoods") +
+    ", and " + PRINT_PARAM_STRING("log_likelihood") + " is their sum.");
 
 // Example.
 BINDING_EXAMPLE(
@@ -65,7 +72,13 @@ BINDING_SEE_ALSO("mlpack::hmm::HMM class documentation",
 PARAM_MATRIX_IN_REQ("input", "File containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "File containing HMM.", "m");
 
+PARAM_UROW_IN("lengths", "Lengths of the sequences that the observations are "
+    "made of, in order.  If not given, the observations are one sequence.",
+    "l");
+
 PARAM_DOUBLE_OUT("log_likelihood", "Log-likelihood of the sequence.");
+PARAM_COL_OUT("log_likelihoods", "Log-likelihood of each sequence, if "
+    "lengths is given.", "L");
 
 // Because we don't know what the type of our HMM is, we need to write a
 // function that can take arbitrary HMM types.
@@ -93,9 +106,36 @@ struct Loglik
           << hmm.Emission()[0].Dimensionality() << ")!" << endl;
     }
 
-    const double loglik = hmm.LogLikelihood(dataSeq);
+    if (!IO::HasParam("lengths"))
+    {
+      const double loglik = hmm.LogLikelihood(dataSeq);
+
+      IO::GetParam<double>("log_likelihood") = loglik;
+      return;
+    }
+
+    // Split the observations into sequences and evaluate them all at once.
+    const arma::Row<size_t>& lengths =
+        IO::GetParam<arma::Row<size_t>>("lengths");
+    if (arma::accu(lengths) != dataSeq.n_cols || arma::any(lengths == 0))
+    {
+      Log::Fatal << "The sequence lengths must be positive and sum to the "
+          << "number of observations (" << dataSeq.n_cols << ")!" << endl;
+    }
+
+    std::vector<arma::mat> sequences(lengths.n_elem);
+    size_t begin = 0;
+    for (size_t i = 0; i < lengths.n_elem; ++i)
+    {
+      sequences[i] = dataSeq.cols(begin, begin + lengths[i] - 1);
+      begin += lengths[i];
+    }
+
+    arma::vec logLikelihoods;
+    hmm.LogLikelihood(sequences, logLikelihoods);
 
-    IO::GetParam<double>("log_likelihood") = loglik;
+    IO::GetParam<double>("log_likelihood") = arma::accu(logLikelihoods);
+    IO::GetParam<arma::vec>("log_likelihoods") = std::move(logLikelihoods);
   }
 };
 
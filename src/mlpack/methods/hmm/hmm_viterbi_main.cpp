@@ -45,7 +45,13 @@ BINDING_LONG_DESC(
     "hidden state sequence of a given sequence of observations (specified as "
     "'" + PRINT_PARAM_STRING("input") + ", using the Viterbi algorithm.  The "
     "computed state sequence may be saved using the " +
-    PRINT_PARAM_STRING("output") + " output parameter.");
+    PRINT_PARAM_STRING("output") + " output parameter."
+    "\n\n"
+    "Many sequences can be decoded at once, in parallel: concatenate them in "
+    "the " + PRINT_PARAM_STRING("input") + " matrix and give the length of "
+    "each with the " + PRINT_PARAM_STRING("lengths") + " parameter.  The "
+    "state sequences are then concatenated in the same way in " +
+    PRINT_PARAM_STRING("output") + ".");
 
 // Example.
 BINDING_EXAMPLE(
@@ -68,6 +74,9 @@ BINDING_SEE_ALSO("mlpack::hmm::HMM class documentation",
 
 PARAM_MATRIX_IN_REQ("input", "Matrix containing observations,", "i");
 PARAM_MODEL_IN_REQ(HMMModel, "input_model", "Trained HMM to use.", "m");
+PARAM_UROW_IN("lengths", "Lengths of the sequences that the observations are "
+    "made of, in order.  If not given, the observations are one sequence.",
+    "l");
 PARAM_UMATRIX_OUT("output", "File to save predicted state sequence to.", "o");
 
 // Because we don't know what the type of our HMM is, we need to write a
@@ -97,7 +106,40 @@ struct Viterbi
     }
 
     arma::Row<size_t> sequence;
-    hmm.Predict(dataSeq, sequence);
+    if (!IO::HasParam("lengths"))
+    {
+      hmm.Predict(dataSeq, sequence);
+    }
+    else
+    {
+      // Split the observations into sequences and decode them all at once.
+      const arma::Row<size_t>& lengths =
+          IO::GetParam<arma::Row<size_t>>("lengths");
+      if (arma::accu(lengths) != dataSeq.n_cols || arma::any(lengths == 0))
+      {
+        Log::Fatal << "The sequence lengths must be positive and sum to the "
+            << "number of observations (" << dataSeq.n_cols << ")!" << endl;
+      }
+
+      std::vector<arma::mat> sequences(lengths.n_elem);
+      size_t begin = 0;
+      for (size_t i = 0; i < lengths.n_elem; ++i)
+      {
+        sequences[i] = dataSeq.cols(begin, begin + lengths[i] - 1);
+        begin += lengths[i];
+      }
+
+      std::vector<arma::Row<size_t>> stateSequences;
+      hmm.Predict(sequences, stateSequences);
+
+      sequence.set_size(dataSeq.n_cols);
+      begin = 0;
+      for (size_t i = 0; i < lengths.n_elem; ++i)
+      {
+        sequence.cols(begin, begin + lengths[i] - 1) = stateSequences[i];
+        begin += lengths[i];
+      }
+    }
 
     // Save output.
     IO::GetParam<arma::Mat<size_t>>("output") = std::move(sequence);
@@ -15,6 +15,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <mlpack/core/data/dataset_mapper.hpp>
+#include <mlpack/core/data/block_reader.hpp>
 #include "gini_impurity.hpp"
 #include "hoeffding_numeric_split.hpp"
 #include "hoeffding_categorical_split.hpp"
@@ -204,6 +205,19 @@ class HoeffdingTree
              const arma::Row<size_t>& labels,
              const bool batchTraining = true);
 
+  /**
+   * Train in streaming mode on all the points of the given file, which is read
+   * one block at a time, so that it does not need to fit in memory.  The labels
+   * are read from the given label file, which holds one label per line (see
+   * data::NextLabeledBlock()).  Both readers are reset first.  The tree must
+   * already have a DatasetInfo with the dimensionality of the file and the
+   * number of classes; use the constructor that takes no data for that.
+   *
+   * @param reader Reader of the points to train on.
+   * @param labelReader Reader of the labels of the points.
+   */
+  void Train(data::BlockReader& reader, data::BlockReader& labelReader);
+
   /**
    * Train on a single point in streaming mode, with the given label.
    *
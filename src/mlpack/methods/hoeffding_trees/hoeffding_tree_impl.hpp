@@ -504,6 +504,37 @@ void HoeffdingTree<
   Train(data, labels, batchTraining);
 }
 
+//! Train on the points of a file, one block at a time.
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType>
+void HoeffdingTree<
+    FitnessFunction,
+    NumericSplitType,
+    CategoricalSplitType
+>::Train(data::BlockReader& reader, data::BlockReader& labelReader)
+{
+  if (reader.Dimensionality() != datasetInfo->Dimensionality())
+  {
+    std::ostringstream oss;
+    oss << "HoeffdingTree::Train(): dimensionality of data ("
+        << reader.Dimensionality() << ") does not match dimensionality of "
+        << "DatasetInfo (" << datasetInfo->Dimensionality() << ")!";
+    throw std::invalid_argument(oss.str());
+  }
+
+  reader.Reset();
+  labelReader.Reset();
+
+  arma::mat block;
+  arma::Row<size_t> labels;
+  while (data::NextLabeledBlock(reader, labelReader, block, labels))
+  {
+    for (size_t i = 0; i < block.n_cols; ++i)
+      Train(block.col(i), labels[i]);
+  }
+}
+
 //! Train on one point.
 template<typename FitnessFunction,
          template<typename> class NumericSplitType,
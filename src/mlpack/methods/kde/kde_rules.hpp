@@ -13,6 +13,8 @@
 #ifndef MLPACK_METHODS_KDE_RULES_HPP
 #define MLPACK_METHODS_KDE_RULES_HPP
 
+#include <mlpack/core/tree/hrectbound.hpp>
+#include <mlpack/core/tree/rule_traits.hpp>
 #include <mlpack/core/tree/traversal_info.hpp>
 
 namespace mlpack {
@@ -63,6 +65,13 @@ class KDERules
   //! Base Case.
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  //! Base cases between the query point and each reference point in
+  //! [referenceBegin, referenceBegin + referenceCount), with all distances
+  //! computed at once.  This can only be used with an LMetric.
+  void BaseCase(const size_t queryIndex,
+                const size_t referenceBegin,
+                const size_t referenceCount);
+
   //! SingleTree Rescore.
   double Score(const size_t queryIndex, TreeType& referenceNode);
 
@@ -171,6 +180,9 @@ class KDERules
   //! The last reference index.
   size_t lastReferenceIndex;
 
+  //! Storage for the distances computed by the batched BaseCase().
+  arma::Col<typename TreeType::Mat::elem_type> batchDistances;
+
   //! Traversal information.
   TraversalInfoType traversalInfo;
 
@@ -225,6 +237,19 @@ class KDECleanRules
 };
 
 } // namespace kde
+
+namespace tree {
+
+//! KDERules has a batched base case when used with an LMetric.
+template<typename MetricType, typename KernelType, typename TreeType>
+class RuleTraits<kde::KDERules<MetricType, KernelType, TreeType>>
+{
+ public:
+  static const bool HasBatchBaseCase =
+      bound::meta::IsLMetric<MetricType>::Value;
+};
+
+} // namespace tree
 } // namespace mlpack
 
 // Include implementation.
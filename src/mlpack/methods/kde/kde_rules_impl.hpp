@@ -96,6 +96,39 @@ double KDERules<MetricType, KernelType, TreeType>::BaseCase(
   return distance;
 }
 
+template<typename MetricType, typename KernelType, typename TreeType>
+void KDERules<MetricType, KernelType, TreeType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceBegin,
+    const size_t referenceCount)
+{
+  if (referenceCount == 0)
+    return;
+
+  metric.BatchEvaluate(querySet.unsafe_col(queryIndex),
+      referenceSet.cols(referenceBegin, referenceBegin + referenceCount - 1),
+      batchDistances);
+
+  for (size_t i = 0; i < referenceCount; ++i)
+  {
+    // Skip the same pairs that BaseCase() skips.
+    const size_t referenceIndex = referenceBegin + i;
+    if ((sameSet && (queryIndex == referenceIndex)) ||
+        ((lastQueryIndex == queryIndex) &&
+         (lastReferenceIndex == referenceIndex)))
+      continue;
+
+    const double kernelValue = kernel.Evaluate(batchDistances[i]);
+    densities(queryIndex) += kernelValue;
+    accumError(queryIndex) += 2 * relError * kernelValue;
+
+    ++baseCases;
+    lastQueryIndex = queryIndex;
+    lastReferenceIndex = referenceIndex;
+    traversalInfo.LastBaseCase() = batchDistances[i];
+  }
+}
+
 //! Single-tree scoring function.
 template<typename MetricType, typename KernelType, typename TreeType>
 inline double KDERules<MetricType, KernelType, TreeType>::
@@ -18,6 +18,7 @@
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/methods/neighbor_search/neighbor_search.hpp>
 #include <mlpack/core/tree/cover_tree.hpp>
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
 
 #include "dual_tree_kmeans_statistic.hpp"
 
@@ -30,6 +31,9 @@ namespace kmeans {
  * dataset.  The conditions under which this will perform best are probably
  * limited to the case where k is close to the number of points in the dataset,
  * and the number of iterations of the k-means algorithm will be few.
+ *
+ * The traversal is run in parallel over disjoint subtrees of the tree built on
+ * the points (see ParallelDualTreeTraverser).
  */
 template<
     typename MetricType,
@@ -102,7 +106,9 @@ class DualTreeKMeans
 
   arma::Row<size_t> assignments;
 
-  std::vector<bool> visited; // Was the point visited this iteration?
+  // Was the point visited this iteration?  This is not a std::vector<bool>,
+  // because the points are visited by several threads at once.
+  std::vector<char> visited;
 
   arma::mat lastIterationCentroids; // For sanity checks.
 
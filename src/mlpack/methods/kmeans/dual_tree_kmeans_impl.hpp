@@ -155,7 +155,10 @@ double DualTreeKMeans<MetricType, MatType, TreeType>::Iterate(
       upperBounds, lowerBounds, metric, prunedPoints, oldFromNewCentroids,
       visited);
 
-  typename Tree::template BreadthFirstDualTreeTraverser<RuleType>
+  // Each point is only ever touched by the thread that handles its subtree, so
+  // the subtrees of the tree on the points can be traversed in parallel.
+  tree::ParallelDualTreeTraverser<Tree, RuleType,
+      typename Tree::template BreadthFirstDualTreeTraverser<RuleType>>
       traverser(rules);
 
   Timer::Start("tree_mod");
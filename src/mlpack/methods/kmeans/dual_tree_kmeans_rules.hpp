@@ -31,7 +31,15 @@ class DualTreeKMeansRules
                       MetricType& metric,
                       const std::vector<bool>& prunedPoints,
                       const std::vector<size_t>& oldFromNewCentroids,
-                      std::vector<bool>& visited);
+                      std::vector<char>& visited);
+
+  /**
+   * Create rules that share the bounds, assignments and the other per-point
+   * information of the given rules, for use by another thread (see
+   * ParallelDualTreeTraverser).  The counts of base cases and scores start at
+   * zero.
+   */
+  explicit DualTreeKMeansRules(DualTreeKMeansRules* other);
 
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
@@ -71,7 +79,7 @@ class DualTreeKMeansRules
 
   const std::vector<size_t>& oldFromNewCentroids;
 
-  std::vector<bool>& visited;
+  std::vector<char>& visited;
 
   size_t baseCases;
   size_t scores;
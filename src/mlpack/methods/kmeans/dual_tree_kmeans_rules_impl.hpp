@@ -27,7 +27,7 @@ DualTreeKMeansRules<MetricType, TreeType>::DualTreeKMeansRules(
     MetricType& metric,
     const std::vector<bool>& prunedPoints,
     const std::vector<size_t>& oldFromNewCentroids,
-    std::vector<bool>& visited) :
+    std::vector<char>& visited) :
     centroids(centroids),
     dataset(dataset),
     assignments(assignments),
@@ -50,6 +50,28 @@ DualTreeKMeansRules<MetricType, TreeType>::DualTreeKMeansRules(
   traversalInfo.LastReferenceNode() = (TreeType*) this;
 }
 
+template<typename MetricType, typename TreeType>
+DualTreeKMeansRules<MetricType, TreeType>::DualTreeKMeansRules(
+    DualTreeKMeansRules* other) :
+    centroids(other->centroids),
+    dataset(other->dataset),
+    assignments(other->assignments),
+    upperBounds(other->upperBounds),
+    lowerBounds(other->lowerBounds),
+    metric(other->metric),
+    prunedPoints(other->prunedPoints),
+    oldFromNewCentroids(other->oldFromNewCentroids),
+    visited(other->visited),
+    baseCases(0),
+    scores(0),
+    lastQueryIndex(dataset.n_cols),
+    lastReferenceIndex(centroids.n_cols),
+    lastBaseCase(0.0)
+{
+  traversalInfo.LastQueryNode() = (TreeType*) this;
+  traversalInfo.LastReferenceNode() = (TreeType*) this;
+}
+
 template<typename MetricType, typename TreeType>
 inline force_inline double DualTreeKMeansRules<MetricType, TreeType>::BaseCase(
     const size_t queryIndex,
@@ -112,12 +134,22 @@ inline double DualTreeKMeansRules<MetricType, TreeType>::Score(
   if (queryNode.Stat().StaticPruned() == true)
     return DBL_MAX;
 
-  // Pruned() for the root node must never be set to size_t(-1).
+  // Pruned() for the root node must never be set to size_t(-1).  If the
+  // parent has not been scored either, the traversal was started at this node
+  // (see ParallelDualTreeTraverser), so start from nothing, like the root.
   if (queryNode.Stat().Pruned() == size_t(-1))
   {
-    queryNode.Stat().Pruned() = queryNode.Parent()->Stat().Pruned();
-    queryNode.Stat().LowerBound() = queryNode.Parent()->Stat().LowerBound();
-    queryNode.Stat().Owner() = queryNode.Parent()->Stat().Owner();
+    if (queryNode.Parent() == NULL ||
+        queryNode.Parent()->Stat().Pruned() == size_t(-1))
+    {
+      queryNode.Stat().Pruned() = 0;
+    }
+    else
+    {
+      queryNode.Stat().Pruned() = queryNode.Parent()->Stat().Pruned();
+      queryNode.Stat().LowerBound() = queryNode.Parent()->Stat().LowerBound();
+      queryNode.Stat().Owner() = queryNode.Parent()->Stat().Owner();
+    }
   }
 
   if (queryNode.Stat().Pruned() == centroids.n_cols)
@@ -13,8 +13,10 @@
 #define MLPACK_METHODS_KMEANS_KMEANS_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/cereal/template_class_version.hpp>
 
 #include <mlpack/core/metrics/lmetric.hpp>
+#include <mlpack/core/data/block_reader.hpp>
 #include "sample_initialization.hpp"
 #include "max_variance_new_cluster.hpp"
 #include "naive_kmeans.hpp"
@@ -63,7 +65,7 @@ namespace kmeans /** K-Means clustering. */ {
  * @tparam LloydStepType Implementation of single Lloyd step to use.
  *
  * @see RandomPartition, SampleInitialization, RefinedStart, AllowEmptyClusters,
- *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans
+ *      MaxVarianceNewCluster, NaiveKMeans, ElkanKMeans, MiniBatchKMeans
  */
 template<typename MetricType = metric::EuclideanDistance,
          typename InitialPartitionPolicy = SampleInitialization,
@@ -155,6 +157,32 @@ class KMeans
                const bool initialAssignmentGuess = false,
                const bool initialCentroidGuess = false);
 
+  /**
+   * Perform mini-batch k-means clustering (Sculley, 2010) on all the points of
+   * the given file, which is read one block at a time so that it does not need
+   * to fit in memory; each block is one mini-batch.  The points of a block are
+   * assigned to their nearest centroids, and then each centroid is moved
+   * toward each of its points with a learning rate of one over the number of
+   * points it has been given so far.  Each iteration is one pass over the file,
+   * and iterations stop after MaxIterations() passes or when the centroids
+   * move less than 1e-5 in a pass.
+   *
+   * Unless initialGuess is true, the initial centroids are given by the
+   * InitialPartitionPolicy on the first block.  The EmptyClusterPolicy is not
+   * used, as it needs the whole dataset; a centroid that is given no points
+   * keeps its initial value.  The reader is reset first.
+   *
+   * @param reader Reader of the dataset to cluster.
+   * @param clusters Number of clusters to compute.
+   * @param centroids Matrix in which centroids are stored.
+   * @param initialGuess If true, then it is assumed that centroids contains the
+   *      initial cluster centroids.
+   */
+  void Cluster(data::BlockReader& reader,
+               const size_t clusters,
+               arma::mat& centroids,
+               const bool initialGuess = false);
+
   //! Get the maximum number of iterations.
   size_t MaxIterations() const { return maxIterations; }
   //! Set the maximum number of iterations.
@@ -176,6 +204,13 @@ class KMeans
   //! Modify the empty cluster policy.
   EmptyClusterPolicy& EmptyClusterAction() { return emptyClusterAction; }
 
+  //! Get the number of points in each mini-batch, for Lloyd step types that
+  //! use mini-batches (such as MiniBatchKMeans).
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points in each mini-batch, for Lloyd step types
+  //! that use mini-batches (such as MiniBatchKMeans).
+  size_t& BatchSize() { return batchSize; }
+
   //! Serialize the k-means object.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t version);
@@ -189,11 +224,24 @@ class KMeans
   InitialPartitionPolicy partitioner;
   //! Instantiated empty cluster policy.
   EmptyClusterPolicy emptyClusterAction;
+  //! Number of points in each mini-batch, for mini-batch Lloyd steps.
+  size_t batchSize;
 };
 
 } // namespace kmeans
 } // namespace mlpack
 
+//! Version 1 added the mini-batch size.
+CEREAL_TEMPLATE_CLASS_VERSION(
+    SINGLE_ARG(template<typename MetricType,
+                        typename InitialPartitionPolicy,
+                        typename EmptyClusterPolicy,
+                        template<class, class> class LloydStepType,
+                        typename MatType>),
+    SINGLE_ARG(mlpack::kmeans::KMeans<MetricType, InitialPartitionPolicy,
+        EmptyClusterPolicy, LloydStepType, MatType>),
+    1)
+
 // Include implementation.
 #include "kmeans_impl.hpp"
 
@@ -42,6 +42,34 @@ struct GivesCentroids
         void(*)(const arma::mat&, const size_t, arma::mat&)>::value;
 };
 
+/**
+ * This gives us a HasBatchSize object that we can use to tell whether or not
+ * a LloydStepType uses mini-batches.
+ */
+HAS_MEM_FUNC(BatchSize, HasBatchSizeCheck);
+
+//! Give the batch size to the Lloyd step, if it uses mini-batches.
+template<typename LloydStepType>
+void SetBatchSize(
+    LloydStepType& lloydStep,
+    const size_t batchSize,
+    const typename std::enable_if_t<HasBatchSizeCheck<LloydStepType,
+        size_t&(LloydStepType::*)()>::value>* = 0)
+{
+  lloydStep.BatchSize() = batchSize;
+}
+
+//! Do nothing, if the Lloyd step does not use mini-batches.
+template<typename LloydStepType>
+void SetBatchSize(
+    LloydStepType& /* lloydStep */,
+    const size_t /* batchSize */,
+    const typename std::enable_if_t<!HasBatchSizeCheck<LloydStepType,
+        size_t&(LloydStepType::*)()>::value>* = 0)
+{
+  // Nothing to do.
+}
+
 //! Call the initial partition policy, if it returns assignments.  This returns
 //! 'true' to indicate that assignments were given.
 template<typename MatType,
@@ -99,7 +127,8 @@ KMeans(const size_t maxIterations,
     maxIterations(maxIterations),
     metric(metric),
     partitioner(partitioner),
-    emptyClusterAction(emptyClusterAction)
+    emptyClusterAction(emptyClusterAction),
+    batchSize(1024)
 {
   // Nothing to do.
 }
@@ -208,6 +237,7 @@ Cluster(const MatType& data,
   size_t iteration = 0;
 
   LloydStepType<MetricType, MatType> lloydStep(data, metric);
+  SetBatchSize(lloydStep, batchSize);
   arma::mat centroidsOther;
   double cNorm;
 
@@ -337,6 +367,156 @@ Cluster(const MatType& data,
   }
 }
 
+/**
+ * Perform mini-batch k-means clustering on the points of a file, reading one
+ * block at a time.
+ */
+template<typename MetricType,
+         typename InitialPartitionPolicy,
+         typename EmptyClusterPolicy,
+         template<class, class> class LloydStepType,
+         typename MatType>
+void KMeans<
+    MetricType,
+    InitialPartitionPolicy,
+    EmptyClusterPolicy,
+    LloydStepType,
+    MatType>::
+Cluster(data::BlockReader& reader,
+        const size_t clusters,
+        arma::mat& centroids,
+        const bool initialGuess)
+{
+  if (clusters == 0)
+    Log::Warn << "KMeans::Cluster(): zero clusters requested.  This probably "
+        << "isn't going to work.  Brace for crash." << std::endl;
+
+  reader.Reset();
+  arma::mat block;
+  arma::Row<size_t> assignments;
+
+  if (initialGuess)
+  {
+    if (centroids.n_cols != clusters)
+      Log::Fatal << "KMeans::Cluster(): wrong number of initial cluster "
+        << "centroids (" << centroids.n_cols << ", should be " << clusters
+        << ")!" << std::endl;
+
+    if (centroids.n_rows != reader.Dimensionality())
+      Log::Fatal << "KMeans::Cluster(): initial cluster centroids have wrong "
+        << " dimensionality (" << centroids.n_rows << ", should be "
+        << reader.Dimensionality() << ")!" << std::endl;
+  }
+  else
+  {
+    // The initial centroids come from the first block.
+    if (!reader.NextBlock(block))
+      Log::Fatal << "KMeans::Cluster(): no points to cluster in file."
+          << std::endl;
+
+    if (clusters > block.n_cols)
+      Log::Warn << "KMeans::Cluster(): more clusters requested than points in "
+          << "the first block." << std::endl;
+
+    bool gotAssignments = GetInitialAssignmentsOrCentroids(partitioner, block,
+        clusters, assignments, centroids);
+    if (gotAssignments)
+    {
+      // The partitioner gives assignments, so we need to calculate centroids
+      // from those assignments.
+      arma::Row<size_t> counts;
+      counts.zeros(clusters);
+      centroids.zeros(block.n_rows, clusters);
+      for (size_t i = 0; i < block.n_cols; ++i)
+      {
+        centroids.col(assignments[i]) += block.col(i);
+        counts[assignments[i]]++;
+      }
+
+      for (size_t i = 0; i < clusters; ++i)
+        if (counts[i] != 0)
+          centroids.col(i) /= counts[i];
+    }
+  }
+
+  // The number of points given to each centroid so far, over all passes; the
+  // learning rate of a centroid is one over its count.
+  arma::Col<size_t> counts(clusters, arma::fill::zeros);
+  arma::mat oldCentroids;
+  size_t iteration = 0;
+  double cNorm;
+
+  do
+  {
+    oldCentroids = centroids;
+    reader.Reset();
+    while (reader.NextBlock(block))
+    {
+      // Assign the points of the mini-batch to the centroids as they were at
+      // the start of the mini-batch.
+      assignments.set_size(block.n_cols);
+
+      #pragma omp parallel for
+      for (omp_size_t i = 0; i < (omp_size_t) block.n_cols; ++i)
+      {
+        double minDistance = std::numeric_limits<double>::infinity();
+        size_t closestCluster = centroids.n_cols; // Invalid value.
+
+        for (size_t j = 0; j < centroids.n_cols; ++j)
+        {
+          const double distance = metric.Evaluate(block.col(i),
+              centroids.col(j));
+
+          if (distance < minDistance)
+          {
+            minDistance = distance;
+            closestCluster = j;
+          }
+        }
+
+        Log::Assert(closestCluster != centroids.n_cols);
+        assignments[i] = closestCluster;
+      }
+
+      // Now take a gradient step for each point.
+      for (size_t i = 0; i < block.n_cols; ++i)
+      {
+        const size_t c = assignments[i];
+        const double eta = 1.0 / double(++counts[c]);
+        const double* point = block.colptr(i);
+        double* centroid = centroids.colptr(c);
+        for (size_t d = 0; d < block.n_rows; ++d)
+          centroid[d] += eta * (point[d] - centroid[d]);
+      }
+    }
+
+    cNorm = 0.0;
+    for (size_t i = 0; i < clusters; ++i)
+    {
+      cNorm += std::pow(metric.Evaluate(oldCentroids.col(i),
+          centroids.col(i)), 2.0);
+    }
+    cNorm = std::sqrt(cNorm);
+
+    iteration++;
+    Log::Info << "KMeans::Cluster(): iteration " << iteration << ", residual "
+        << cNorm << ".\n";
+    if (std::isnan(cNorm) || std::isinf(cNorm))
+      cNorm = 1e-4; // Keep iterating.
+  } while (cNorm > 1e-5 && iteration != maxIterations);
+
+  if (iteration != maxIterations)
+  {
+    Log::Info << "KMeans::Cluster(): converged after " << iteration
+        << " passes." << std::endl;
+  }
+  else
+  {
+    Log::Info << "KMeans::Cluster(): terminated after limit of " << iteration
+        << " passes." << std::endl;
+  }
+}
+
 template<typename MetricType,
          typename InitialPartitionPolicy,
          typename EmptyClusterPolicy,
@@ -347,12 +527,18 @@ void KMeans<MetricType,
             InitialPartitionPolicy,
             EmptyClusterPolicy,
             LloydStepType,
-            MatType>::serialize(Archive& ar, const uint32_t /* version */)
+            MatType>::serialize(Archive& ar, const uint32_t version)
 {
   ar(CEREAL_NVP(maxIterations));
   ar(CEREAL_NVP(metric));
   ar(CEREAL_NVP(partitioner));
   ar(CEREAL_NVP(emptyClusterAction));
+
+  // Models saved before version 1 have no batch size, so they get the default.
+  if (version >= 1)
+    ar(CEREAL_NVP(batchSize));
+  else
+    batchSize = 1024;
 }
 
 } // namespace kmeans
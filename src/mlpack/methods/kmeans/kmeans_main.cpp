@@ -18,10 +18,12 @@
 #include "kill_empty_clusters.hpp"
 #include "refined_start.hpp"
 #include "kmeans_plus_plus_initialization.hpp"
+#include "kmeans_parallel_initialization.hpp"
 #include "elkan_kmeans.hpp"
 #include "hamerly_kmeans.hpp"
 #include "pelleg_moore_kmeans.hpp"
 #include "dual_tree_kmeans.hpp"
+#include "mini_batch_kmeans.hpp"
 
 using namespace mlpack;
 using namespace mlpack::kmeans;
@@ -47,7 +49,14 @@ BINDING_LONG_DESC(
     "\n\n"
     "Optionally, the strategy to choose initial centroids can be specified.  "
     "The k-means++ algorithm can be used to choose initial centroids with "
-    "the " + PRINT_PARAM_STRING("kmeans_plus_plus") + " parameter.  The "
+    "the " + PRINT_PARAM_STRING("kmeans_plus_plus") + " parameter.  For "
+    "large datasets or many clusters, its scalable variant k-means|| "
+    "(\"Scalable k-means++\", 2012), which samples candidate centroids in "
+    "parallel over a few passes of the data, can be used with the " +
+    PRINT_PARAM_STRING("kmeans_parallel") + " parameter; the " +
+    PRINT_PARAM_STRING("oversampling") + " and " +
+    PRINT_PARAM_STRING("rounds") + " parameters control how many candidates "
+    "are sampled.  The "
     "Bradley and Fayyad approach (\"Refining initial points for k-means "
     "clustering\", 1998) can be used to select initial points by specifying "
     "the " + PRINT_PARAM_STRING("refined_start") + " parameter.  This approach "
@@ -63,8 +72,12 @@ BINDING_LONG_DESC(
     "options include the Pelleg-Moore tree-based algorithm ('pelleg-moore'), "
     "Elkan's triangle-inequality based algorithm ('elkan'), Hamerly's "
     "modification to Elkan's algorithm ('hamerly'), the dual-tree k-means "
-    "algorithm ('dualtree'), and the dual-tree k-means algorithm using the "
-    "cover tree ('dualtree-covertree')."
+    "algorithm ('dualtree'), the dual-tree k-means algorithm using the "
+    "cover tree ('dualtree-covertree'), and mini-batch k-means ('minibatch')."
+    "  Mini-batch k-means updates the centroids from a random sample of " +
+    PRINT_PARAM_STRING("batch_size") + " points in each iteration instead of "
+    "the whole dataset, so it is much faster for large datasets, but its "
+    "clusters are approximate."
     "\n\n"
     "The behavior for when an empty cluster is encountered can be modified with"
     " the " + PRINT_PARAM_STRING("allow_empty_clusters") + " option.  When "
@@ -155,9 +168,20 @@ PARAM_DOUBLE_IN("percentage", "Percentage of dataset to use for each refined "
 PARAM_FLAG("kmeans_plus_plus", "Use the k-means++ initialization strategy to "
     "choose initial points.", "K");
 
+// Parameters for k-means|| initialization.
+PARAM_FLAG("kmeans_parallel", "Use the k-means|| initialization strategy to "
+    "choose initial points.", "L");
+PARAM_DOUBLE_IN("oversampling", "Expected number of candidate centroids "
+    "sampled in each round of k-means||, as a multiple of the number of "
+    "clusters (use when --kmeans_parallel is specified).", "O", 2.0);
+PARAM_INT_IN("rounds", "Number of sampling rounds of k-means|| (use when "
+    "--kmeans_parallel is specified).", "R", 5);
+
 PARAM_STRING_IN("algorithm", "Algorithm to use for the Lloyd iteration "
-    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', or "
-    "'dualtree-covertree').", "a", "naive");
+    "('naive', 'pelleg-moore', 'elkan', 'hamerly', 'dualtree', "
+    "'dualtree-covertree', or 'minibatch').", "a", "naive");
+PARAM_INT_IN("batch_size", "Number of points in each mini-batch (use when "
+    "--algorithm is 'minibatch').", "b", 1024);
 
 // Given the type of initial partition policy, figure out the empty cluster
 // policy and run k-means.
@@ -183,8 +207,11 @@ static void mlpackMain()
   else
     math::RandomSeed((size_t) std::time(NULL));
 
-  RequireOnlyOnePassed({ "refined_start", "kmeans_plus_plus" }, true,
+  RequireOnlyOnePassed({ "refined_start", "kmeans_plus_plus",
+      "kmeans_parallel" }, true,
       "Only one initialization strategy can be specified!", true);
+  ReportIgnoredParam({{ "kmeans_parallel", false }}, "oversampling");
+  ReportIgnoredParam({{ "kmeans_parallel", false }}, "rounds");
 
   // Now, start building the KMeans type that we'll be using.  Start with the
   // initial partition policy.  The call to FindEmptyClusterPolicy<> results in
@@ -206,6 +233,17 @@ static void mlpackMain()
     FindEmptyClusterPolicy<KMeansPlusPlusInitialization>(
         KMeansPlusPlusInitialization());
   }
+  else if (IO::HasParam("kmeans_parallel"))
+  {
+    RequireParamValue<double>("oversampling", [](double x) { return x > 0.0; },
+        true, "oversampling factor must be positive");
+    RequireParamValue<int>("rounds", [](int x) { return x > 0; }, true,
+        "number of rounds must be positive");
+
+    FindEmptyClusterPolicy<KMeansParallelInitialization>(
+        KMeansParallelInitialization(IO::GetParam<double>("oversampling"),
+        (size_t) IO::GetParam<int>("rounds")));
+  }
   else
   {
     FindEmptyClusterPolicy<SampleInitialization>(SampleInitialization());
@@ -236,8 +274,8 @@ template<typename InitialPartitionPolicy, typename EmptyClusterPolicy>
 void FindLloydStepType(const InitialPartitionPolicy& ipp)
 {
   RequireParamInSet<string>("algorithm", { "elkan", "hamerly", "pelleg-moore",
-      "dualtree", "dualtree-covertree", "naive" }, true, "unknown k-means "
-      "algorithm");
+      "dualtree", "dualtree-covertree", "naive", "minibatch" }, true,
+      "unknown k-means algorithm");
 
   const string algorithm = IO::GetParam<string>("algorithm");
   if (algorithm == "elkan")
@@ -255,6 +293,9 @@ void FindLloydStepType(const InitialPartitionPolicy& ipp)
         CoverTreeDualTreeKMeans>(ipp);
   else if (algorithm == "naive")
     RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy, NaiveKMeans>(ipp);
+  else if (algorithm == "minibatch")
+    RunKMeans<InitialPartitionPolicy, EmptyClusterPolicy,
+        MiniBatchKMeans>(ipp);
 }
 
 // Given the template parameters, sanitize/load input and run k-means.
@@ -283,6 +324,15 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
 
   RequireParamValue<int>("max_iterations", [](int x) { return x >= 0; }, true,
     "maximum iterations must be positive or 0 (for no limit)");
+  if (IO::GetParam<string>("algorithm") == "minibatch")
+  {
+    RequireParamValue<int>("batch_size", [](int x) { return x > 0; }, true,
+        "batch size must be positive");
+  }
+  else
+  {
+    ReportIgnoredParam("batch_size", "mini-batch k-means is not being used");
+  }
   const int maxIterations = IO::GetParam<int>("max_iterations");
 
   // Make sure we have an output file if we're not doing the work in-place.
@@ -311,6 +361,7 @@ void RunKMeans(const InitialPartitionPolicy& ipp)
          InitialPartitionPolicy,
          EmptyClusterPolicy,
          LloydStepType> kmeans(maxIterations, metric::EuclideanDistance(), ipp);
+  kmeans.BatchSize() = (size_t) IO::GetParam<int>("batch_size");
 
   if (IO::HasParam("output") || IO::HasParam("in_place"))
   {
@@ -0,0 +1,165 @@
+/**
+ * @file methods/kmeans/kmeans_parallel_initialization_impl.hpp
+ *
+ * Implementation of the k-means|| initialization strategy.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_KMEANS_PARALLEL_INITIALIZATION_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "kmeans_parallel_initialization.hpp"
+
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MatType>
+void KMeansParallelInitialization::Cluster(const MatType& data,
+                                           const size_t clusters,
+                                           arma::mat& centroids) const
+{
+  typedef metric::SquaredEuclideanDistance MetricType;
+
+  centroids.set_size(data.n_rows, clusters);
+  if (clusters == 0)
+    return;
+
+  // The candidates, as indices of points, starting with one random point.
+  std::vector<size_t> candidates;
+  candidates.push_back(math::RandInt(0, data.n_cols));
+
+  // The squared distance of each point to its nearest candidate, and the index
+  // of that candidate.
+  arma::vec minDistances(data.n_cols);
+  arma::Row<size_t> nearest(data.n_cols, arma::fill::zeros);
+  #pragma omp parallel for
+  for (omp_size_t p = 0; p < (omp_size_t) data.n_cols; ++p)
+  {
+    minDistances[p] = MetricType::Evaluate(data.col(p),
+        data.col(candidates[0]));
+  }
+
+  const size_t numChunks = (data.n_cols + ChunkSize - 1) / ChunkSize;
+  std::vector<std::vector<size_t>> chunkSamples(numChunks);
+  std::vector<size_t> seeds(numChunks);
+  const double expectedSamples = oversampling * clusters;
+  for (size_t r = 0; r < rounds; ++r)
+  {
+    // If every point is a candidate, there is nothing left to sample.
+    const double cost = arma::accu(minDistances);
+    if (cost == 0.0)
+      break;
+
+    // Sample each point with probability proportional to its squared distance
+    // to the nearest candidate.
+    for (size_t c = 0; c < numChunks; ++c)
+      seeds[c] = math::randGen();
+
+    #pragma omp parallel for
+    for (omp_size_t c = 0; c < (omp_size_t) numChunks; ++c)
+    {
+      std::mt19937 generator(seeds[c]);
+      std::uniform_real_distribution<> uniform;
+
+      chunkSamples[c].clear();
+      const size_t end = std::min((size_t) (c + 1) * ChunkSize,
+          (size_t) data.n_cols);
+      for (size_t p = c * ChunkSize; p < end; ++p)
+      {
+        if (uniform(generator) * cost < expectedSamples * minDistances[p])
+          chunkSamples[c].push_back(p);
+      }
+    }
+
+    const size_t firstNew = candidates.size();
+    for (size_t c = 0; c < numChunks; ++c)
+    {
+      candidates.insert(candidates.end(), chunkSamples[c].begin(),
+          chunkSamples[c].end());
+    }
+
+    // Only the new candidates can be nearer than the nearest candidate so far.
+    #pragma omp parallel for
+    for (omp_size_t p = 0; p < (omp_size_t) data.n_cols; ++p)
+    {
+      for (size_t j = firstNew; j < candidates.size(); ++j)
+      {
+        const double distance = MetricType::Evaluate(data.col(p),
+            data.col(candidates[j]));
+        if (distance < minDistances[p])
+        {
+          minDistances[p] = distance;
+          nearest[p] = j;
+        }
+      }
+    }
+  }
+
+  // If there are too few candidates, use them all and fill the remaining
+  // centroids with random points.
+  if (candidates.size() <= clusters)
+  {
+    for (size_t i = 0; i < candidates.size(); ++i)
+      centroids.col(i) = data.col(candidates[i]);
+    for (size_t i = candidates.size(); i < clusters; ++i)
+      centroids.col(i) = data.col(math::RandInt(0, data.n_cols));
+
+    return;
+  }
+
+  // Weight each candidate by the number of points it is the nearest candidate
+  // of.
+  arma::vec weights(candidates.size(), arma::fill::zeros);
+  for (size_t p = 0; p < data.n_cols; ++p)
+    ++weights[nearest[p]];
+
+  arma::mat candidatePoints(data.n_rows, candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i)
+    candidatePoints.col(i) = data.col(candidates[i]);
+
+  // Now run k-means++ on the weighted candidates.  The first centroid is
+  // sampled in proportion to the weights alone.
+  arma::vec candidateDistances(candidates.size());
+  candidateDistances.fill(1.0);
+  for (size_t i = 0; i < clusters; ++i)
+  {
+    const arma::vec cdf = arma::cumsum(weights % candidateDistances);
+    const double total = cdf[cdf.n_elem - 1];
+
+    // If all the weight is on candidates that are already centroids, any
+    // candidate will do.
+    size_t chosen;
+    if (total > 0.0)
+    {
+      const double sample = math::Random() * total;
+      chosen = std::upper_bound(cdf.begin(), cdf.end(), sample) - cdf.begin();
+      chosen = std::min(chosen, (size_t) cdf.n_elem - 1);
+    }
+    else
+    {
+      chosen = math::RandInt(0, candidates.size());
+    }
+
+    centroids.col(i) = candidatePoints.col(chosen);
+
+    #pragma omp parallel for
+    for (omp_size_t j = 0; j < (omp_size_t) candidates.size(); ++j)
+    {
+      const double distance = MetricType::Evaluate(candidatePoints.col(j),
+          centroids.col(i));
+      if (i == 0 || distance < candidateDistances[j])
+        candidateDistances[j] = distance;
+    }
+  }
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
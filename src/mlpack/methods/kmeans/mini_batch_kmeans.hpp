@@ -0,0 +1,115 @@
+/**
+ * @file methods/kmeans/mini_batch_kmeans.hpp
+ *
+ * An implementation of a step of mini-batch k-means (Sculley, 2010), which
+ * updates the centroids from a random sample of the dataset instead of the
+ * whole dataset.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_HPP
+
+#include <mlpack/prereqs.hpp>
+
+namespace mlpack {
+namespace kmeans {
+
+/**
+ * This is an implementation of a single step of mini-batch k-means, for use
+ * as the LloydStepType of KMeans.  Each call to Iterate() samples a mini-batch
+ * of points uniformly at random (with replacement), assigns each point of the
+ * mini-batch to its nearest centroid, and then moves each centroid toward each
+ * of its points with a learning rate of one over the number of points it has
+ * been given over all iterations so far.  The cost of an iteration depends on
+ * the batch size, not on the size of the dataset, so this is much faster than
+ * Lloyd's algorithm on large datasets, at the cost of somewhat worse clusters.
+ *
+ * The per-centroid counts given to Iterate() are the number of points given to
+ * each centroid over all iterations, and they are carried from one iteration
+ * to the next through that parameter; so the empty cluster policy of KMeans is
+ * only used for centroids that have never been given a point.
+ *
+ * For more information, see the following paper:
+ *
+ * @code
+ * @inproceedings{sculley2010web,
+ *   title={Web-scale k-means clustering},
+ *   author={Sculley, D.},
+ *   booktitle={Proceedings of the 19th International Conference on World Wide
+ *       Web (WWW '10)},
+ *   pages={1177--1178},
+ *   year={2010}
+ * }
+ * @endcode
+ *
+ * @tparam MetricType Type of metric used with this implementation.
+ * @tparam MatType Matrix type (arma::mat or arma::sp_mat).
+ */
+template<typename MetricType, typename MatType>
+class MiniBatchKMeans
+{
+ public:
+  /**
+   * Construct the MiniBatchKMeans object with the given dataset and metric.
+   *
+   * @param dataset Dataset.
+   * @param metric Instantiated metric.
+   * @param batchSize Number of points in each mini-batch; if 0 or at least the
+   *     number of points in the dataset, every iteration uses the whole
+   *     dataset.
+   */
+  MiniBatchKMeans(const MatType& dataset,
+                  MetricType& metric,
+                  const size_t batchSize = 1024);
+
+  /**
+   * Run a single iteration of mini-batch k-means, updating the given centroids
+   * into the newCentroids matrix.
+   *
+   * @param centroids Current cluster centroids.
+   * @param newCentroids New cluster centroids.
+   * @param counts Number of points given to each cluster over all iterations;
+   *     this must hold the counts of the previous iteration (it is reset on
+   *     the first iteration).
+   */
+  double Iterate(const arma::mat& centroids,
+                 arma::mat& newCentroids,
+                 arma::Col<size_t>& counts);
+
+  //! Get the number of distance calculations.
+  size_t DistanceCalculations() const { return distanceCalculations; }
+
+  //! Get the number of points in each mini-batch.
+  size_t BatchSize() const { return batchSize; }
+  //! Modify the number of points in each mini-batch.
+  size_t& BatchSize() { return batchSize; }
+
+ private:
+  //! The dataset.
+  const MatType& dataset;
+  //! The instantiated metric.
+  MetricType& metric;
+  //! The number of points in each mini-batch.
+  size_t batchSize;
+  //! The number of iterations so far.
+  size_t iteration;
+  //! The points of the current mini-batch.
+  arma::uvec batch;
+  //! The nearest centroid of each point of the current mini-batch.
+  arma::Row<size_t> assignments;
+
+  //! Number of distance calculations.
+  size_t distanceCalculations;
+};
+
+} // namespace kmeans
+} // namespace mlpack
+
+// Include implementation.
+#include "mini_batch_kmeans_impl.hpp"
+
+#endif
@@ -0,0 +1,105 @@
+/**
+ * @file methods/kmeans/mini_batch_kmeans_impl.hpp
+ *
+ * Implementation of a step of mini-batch k-means.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+#define MLPACK_METHODS_KMEANS_MINI_BATCH_KMEANS_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "mini_batch_kmeans.hpp"
+
+namespace mlpack {
+namespace kmeans {
+
+template<typename MetricType, typename MatType>
+MiniBatchKMeans<MetricType, MatType>::MiniBatchKMeans(const MatType& dataset,
+                                                      MetricType& metric,
+                                                      const size_t batchSize) :
+    dataset(dataset),
+    metric(metric),
+    batchSize(batchSize),
+    iteration(0),
+    distanceCalculations(0)
+{ /* Nothing to do. */ }
+
+// Run a single iteration.
+template<typename MetricType, typename MatType>
+double MiniBatchKMeans<MetricType, MatType>::Iterate(
+    const arma::mat& centroids,
+    arma::mat& newCentroids,
+    arma::Col<size_t>& counts)
+{
+  if (iteration++ == 0 || counts.n_elem != centroids.n_cols)
+    counts.zeros(centroids.n_cols);
+
+  // Sample the mini-batch.
+  if (batchSize == 0 || batchSize >= dataset.n_cols)
+  {
+    batch = arma::regspace<arma::uvec>(0, dataset.n_cols - 1);
+  }
+  else
+  {
+    batch.set_size(batchSize);
+    for (size_t i = 0; i < batchSize; ++i)
+      batch[i] = math::RandInt(dataset.n_cols);
+  }
+
+  // Find the closest centroid to each point of the mini-batch, in parallel.
+  assignments.set_size(batch.n_elem);
+
+  #pragma omp parallel for
+  for (omp_size_t i = 0; i < (omp_size_t) batch.n_elem; ++i)
+  {
+    double minDistance = std::numeric_limits<double>::infinity();
+    size_t closestCluster = centroids.n_cols; // Invalid value.
+
+    for (size_t j = 0; j < centroids.n_cols; ++j)
+    {
+      const double distance = metric.Evaluate(dataset.col(batch[i]),
+          centroids.unsafe_col(j));
+      if (distance < minDistance)
+      {
+        minDistance = distance;
+        closestCluster = j;
+      }
+    }
+
+    Log::Assert(closestCluster != centroids.n_cols);
+    assignments[i] = closestCluster;
+  }
+
+  distanceCalculations += centroids.n_cols * batch.n_elem;
+
+  // Now move each centroid toward each of its points, in order, with a
+  // learning rate that decays with the number of points it has been given.
+  newCentroids = centroids;
+  for (size_t i = 0; i < batch.n_elem; ++i)
+  {
+    const size_t c = assignments[i];
+    const double eta = 1.0 / (double) (++counts[c]);
+    newCentroids.col(c) *= (1.0 - eta);
+    newCentroids.col(c) += eta * dataset.col(batch[i]);
+  }
+
+  // Calculate cluster distortion for this iteration.
+  double cNorm = 0.0;
+  for (size_t i = 0; i < centroids.n_cols; ++i)
+  {
+    cNorm += std::pow(metric.Evaluate(centroids.col(i), newCentroids.col(i)),
+        2.0);
+  }
+  distanceCalculations += centroids.n_cols;
+
+  return std::sqrt(cNorm);
+}
+
+} // namespace kmeans
+} // namespace mlpack
+
+#endif
@@ -37,6 +37,9 @@ namespace kmeans {
  * organization={ACM}
  * }
  * @endcode
+ *
+ * The top of the tree is traversed by one thread; below it, the subtrees are
+ * traversed in parallel.
  */
 template<typename MetricType, typename MatType>
 class PellegMooreKMeans
@@ -74,6 +77,10 @@ class PellegMooreKMeans
       TreeType;
 
  private:
+  //! The number of subtrees that the top of the tree is cut into, to be
+  //! traversed in parallel.
+  static const size_t ParallelSubtrees = 256;
+
   //! The original dataset reference.
   const MatType& datasetOrig; // Maybe not necessary.
   //! The tree built on the points.
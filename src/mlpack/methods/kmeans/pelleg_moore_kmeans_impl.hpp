@@ -16,6 +16,8 @@
 #include "pelleg_moore_kmeans.hpp"
 #include "pelleg_moore_kmeans_rules.hpp"
 
+#include <stack>
+
 namespace mlpack {
 namespace kmeans {
 
@@ -49,16 +51,78 @@ double PellegMooreKMeans<MetricType, MatType>::Iterate(
   newCentroids.zeros(centroids.n_rows, centroids.n_cols);
   counts.zeros(centroids.n_cols);
 
-  // Create rules object.
   typedef PellegMooreKMeansRules<MetricType, TreeType> RulesType;
+  typedef typename TreeType::template SingleTreeTraverser<RulesType>
+      TraverserType;
+
+  // Create rules object.
   RulesType rules(dataset, centroids, newCentroids, counts, metric);
 
-  // Use single-tree traverser.
-  typename TreeType::template SingleTreeTraverser<RulesType> traverser(rules);
+  if (tree->IsLeaf())
+  {
+    // Use single-tree traverser.  Now, do a traversal with a fake query index
+    // (since the query index is irrelevant; we are checking each node with all
+    // clusters.
+    TraverserType traverser(rules);
+    traverser.Traverse(0, *tree);
+  }
+  else
+  {
+    // Score the top of the tree here, until the subtrees are small enough that
+    // there are about ParallelSubtrees of them.  Scoring a node only needs the
+    // blacklist of its parent, so the subtrees can then be traversed
+    // independently.  Their number doesn't depend on the number of threads.
+    const size_t cutoff = std::max(tree->NumDescendants() / ParallelSubtrees,
+        (size_t) 1);
+    std::vector<TreeType*> subtrees;
+    std::stack<TreeType*> nodes;
+    if (rules.Score(0, *tree) != DBL_MAX)
+      nodes.push(tree);
+    while (!nodes.empty())
+    {
+      TreeType* node = nodes.top();
+      nodes.pop();
+
+      if (node->IsLeaf() || node->NumDescendants() <= cutoff)
+      {
+        subtrees.push_back(node);
+        continue;
+      }
 
-  // Now, do a traversal with a fake query index (since the query index is
-  // irrelevant; we are checking each node with all clusters.
-  traverser.Traverse(0, *tree);
+      for (size_t i = 0; i < node->NumChildren(); ++i)
+        if (rules.Score(0, node->Child(i)) != DBL_MAX)
+          nodes.push(&node->Child(i));
+    }
+
+    // Each thread sums the points it finds for each cluster in its own
+    // accumulators.  The subtrees are likely to be unbalanced in cost, so hand
+    // them out dynamically.
+    size_t subtreeDistanceCalculations = 0;
+    #pragma omp parallel reduction(+:subtreeDistanceCalculations)
+    {
+      arma::mat localCentroids(centroids.n_rows, centroids.n_cols,
+          arma::fill::zeros);
+      arma::Col<size_t> localCounts(centroids.n_cols, arma::fill::zeros);
+      RulesType localRules(dataset, centroids, localCentroids, localCounts,
+          metric);
+      TraverserType traverser(localRules);
+
+      // The root of each subtree has already been scored; Traverse() scores
+      // only its descendants.
+      #pragma omp for schedule(dynamic)
+      for (omp_size_t i = 0; i < (omp_size_t) subtrees.size(); ++i)
+        traverser.Traverse(0, *subtrees[i]);
+
+      subtreeDistanceCalculations += localRules.DistanceCalculations();
+
+      #pragma omp critical
+      {
+        newCentroids += localCentroids;
+        counts += localCounts;
+      }
+    }
+    rules.DistanceCalculations() += subtreeDistanceCalculations;
+  }
 
   distanceCalculations += rules.DistanceCalculations();
 
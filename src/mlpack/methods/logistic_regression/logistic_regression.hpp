@@ -16,6 +16,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <ensmallen.hpp>
+#include <mlpack/core/data/block_reader.hpp>
 
 #include "logistic_regression_function.hpp"
 
@@ -159,6 +160,39 @@ class LogisticRegression
                OptimizerType& optimizer,
                CallbackTypes&&... callbacks);
 
+  /**
+   * Train the LogisticRegression model on all the points of the given file,
+   * which is read one block at a time so that it does not need to fit in
+   * memory.  The labels are read from the given label file, which holds one
+   * label per line (see data::NextLabeledBlock()).
+   *
+   * The given number of passes is made over the file.  On each block, the
+   * optimizer makes one pass over the points of the block (its MaxIterations()
+   * is set to the size of the block), starting from the parameters that the
+   * previous block gave; so this is meant for stochastic optimizers such as
+   * ens::SGD.  The regularization of each block is scaled by the fraction of
+   * the points it holds, so that one pass over the file regularizes in the
+   * same way as one pass over the whole dataset in memory.  The points are
+   * read as an arma::mat, so MatType must be arma::mat.
+   *
+   * @tparam OptimizerType Type of optimizer to use to train the model; it must
+   *      have MaxIterations(), like the ensmallen SGD variants.
+   * @tparam CallbackTypes Types of Callback Functions.
+   * @param predictors Reader of the input training variables.
+   * @param responses Reader of the outputs of the input training variables.
+   * @param optimizer Instantiated optimizer, used for every block.
+   * @param passes Number of passes over the file.
+   * @param callbacks Callback function for ensmallen optimizer `OptimizerType`.
+   *      See https://www.ensmallen.org/docs.html#callback-documentation.
+   * @return The final objective of the model on the last block.
+   */
+  template<typename OptimizerType, typename... CallbackTypes>
+  double Train(data::BlockReader& predictors,
+               data::BlockReader& responses,
+               OptimizerType& optimizer,
+               const size_t passes,
+               CallbackTypes&&... callbacks);
+
   //! Return the parameters (the b vector).
   const arma::rowvec& Parameters() const { return parameters; }
   //! Modify the parameters (the b vector).
@@ -101,6 +101,63 @@ double LogisticRegression<MatType>::Train(
   return out;
 }
 
+template<typename MatType>
+template<typename OptimizerType, typename... CallbackTypes>
+double LogisticRegression<MatType>::Train(
+    data::BlockReader& predictors,
+    data::BlockReader& responses,
+    OptimizerType& optimizer,
+    const size_t passes,
+    CallbackTypes&&... callbacks)
+{
+  // Set size of parameters vector according to the input data received.
+  if (parameters.n_elem != predictors.Dimensionality() + 1)
+    parameters = arma::rowvec(predictors.Dimensionality() + 1,
+        arma::fill::zeros);
+
+  // The regularization term of LogisticRegressionFunction is added once for
+  // each block, so we need the number of points to scale it; counting the
+  // labels is much cheaper than reading the points.
+  size_t numPoints = 0;
+  if (lambda != 0.0)
+  {
+    responses.Reset();
+    arma::Row<size_t> labels;
+    while (responses.NextBlock(labels))
+      numPoints += labels.n_elem;
+  }
+
+  const size_t maxIterations = optimizer.MaxIterations();
+
+  Timer::Start("logistic_regression_optimization");
+  double out = 0.0;
+  arma::mat block;
+  arma::Row<size_t> labels;
+  for (size_t pass = 0; pass < passes; ++pass)
+  {
+    predictors.Reset();
+    responses.Reset();
+    while (data::NextLabeledBlock(predictors, responses, block, labels))
+    {
+      const double blockLambda = (lambda == 0.0) ? 0.0 :
+          lambda * block.n_cols / numPoints;
+      LogisticRegressionFunction<MatType> errorFunction(block, labels,
+          blockLambda);
+
+      optimizer.MaxIterations() = block.n_cols;
+      out = optimizer.Optimize(errorFunction, parameters, callbacks...);
+    }
+  }
+  Timer::Stop("logistic_regression_optimization");
+
+  optimizer.MaxIterations() = maxIterations;
+
+  Log::Info << "LogisticRegression::LogisticRegression(): final objective of "
+      << "trained model on last block is " << out << "." << std::endl;
+
+  return out;
+}
+
 template<typename MatType>
 template<typename VecType>
 size_t LogisticRegression<MatType>::Classify(const VecType& point,
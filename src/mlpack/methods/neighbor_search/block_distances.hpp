@@ -0,0 +1,185 @@
+/**
+ * @file methods/neighbor_search/block_distances.hpp
+ *
+ * Definition of the BlockDistances class, which computes the distances between
+ * a block of reference points and a block of query points at once.  It is used
+ * by the brute-force search mode of NeighborSearch.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_BLOCK_DISTANCES_HPP
+#define MLPACK_METHODS_NEIGHBOR_SEARCH_BLOCK_DISTANCES_HPP
+
+#include <mlpack/prereqs.hpp>
+#include <mlpack/core/metrics/lmetric.hpp>
+
+namespace mlpack {
+namespace neighbor {
+
+/**
+ * Compute blocks of distances between the points of a reference set and the
+ * points of a query set.  This general version calls MetricType::Evaluate() for
+ * every pair of points, so the computed distances are exact.
+ *
+ * @tparam MetricType Metric to compute distances with.
+ * @tparam MatType Type of the datasets.
+ */
+template<typename MetricType, typename MatType>
+class BlockDistances
+{
+ public:
+  //! This is true if the computed distances are exactly the distances given by
+  //! MetricType::Evaluate().
+  static const bool Exact = true;
+
+  /**
+   * Prepare to compute distances to the points of the given reference set.
+   * The reference set and the metric must stay valid while this object is
+   * used.
+   */
+  BlockDistances(MetricType& metric, const MatType& referenceSet) :
+      metric(metric),
+      referenceSet(referenceSet)
+  { }
+
+  /**
+   * Compute the distances between the reference points in [referenceBegin,
+   * referenceEnd) and the query points in [queryBegin, queryEnd).  After the
+   * call, distances(i, j) holds the distance between reference point
+   * (referenceBegin + i) and query point (queryBegin + j).
+   */
+  void Compute(const MatType& querySet,
+               const size_t queryBegin,
+               const size_t queryEnd,
+               const size_t referenceBegin,
+               const size_t referenceEnd,
+               arma::mat& distances) const
+  {
+    distances.set_size(referenceEnd - referenceBegin, queryEnd - queryBegin);
+    for (size_t j = queryBegin; j < queryEnd; ++j)
+    {
+      for (size_t i = referenceBegin; i < referenceEnd; ++i)
+      {
+        distances(i - referenceBegin, j - queryBegin) = metric.Evaluate(
+            querySet.col(j), referenceSet.col(i));
+      }
+    }
+  }
+
+  /**
+   * Return a bound on the difference between the computed distances to the
+   * given query point and the exact ones; here, the distances are exact.
+   */
+  double Error(const MatType& /* querySet */,
+               const size_t /* queryIndex */) const
+  {
+    return 0.0;
+  }
+
+ private:
+  //! The metric.
+  MetricType& metric;
+  //! The reference set.
+  const MatType& referenceSet;
+};
+
+/**
+ * BlockDistances for the (squared) Euclidean distance on dense data.  The
+ * squared distances are expanded as ||r||^2 + ||q||^2 - 2 r^T q, so that the
+ * inner products of a whole block are computed with a single matrix
+ * multiplication (GEMM).  The squared norms of the reference points are
+ * computed once, when the object is built.
+ *
+ * The expansion suffers from cancellation when the points are far from the
+ * origin relative to their distance, so the computed distances are only
+ * approximate; Error() bounds the difference, and callers that need exact
+ * distances should recompute them with the metric.
+ */
+template<bool TakeRoot, typename eT>
+class BlockDistances<metric::LMetric<2, TakeRoot>, arma::Mat<eT>>
+{
+ public:
+  //! The computed distances carry roundoff error from the expansion.
+  static const bool Exact = false;
+
+  //! Prepare to compute distances to the points of the given reference set.
+  BlockDistances(metric::LMetric<2, TakeRoot>& /* metric */,
+                 const arma::Mat<eT>& referenceSet) :
+      referenceSet(referenceSet),
+      referenceNorms(arma::sum(arma::square(referenceSet), 0)),
+      maxReferenceNorm(referenceNorms.is_empty() ? 0.0 :
+          double(referenceNorms.max()))
+  { }
+
+  /**
+   * Compute the distances between the reference points in [referenceBegin,
+   * referenceEnd) and the query points in [queryBegin, queryEnd).  After the
+   * call, distances(i, j) holds the distance between reference point
+   * (referenceBegin + i) and query point (queryBegin + j).
+   */
+  void Compute(const arma::Mat<eT>& querySet,
+               const size_t queryBegin,
+               const size_t queryEnd,
+               const size_t referenceBegin,
+               const size_t referenceEnd,
+               arma::mat& distances) const
+  {
+    const arma::Row<eT> queryNorms = arma::sum(arma::square(
+        querySet.cols(queryBegin, queryEnd - 1)), 0);
+
+    // All of the inner products at once.
+    const arma::Mat<eT> products =
+        referenceSet.cols(referenceBegin, referenceEnd - 1).t() *
+        querySet.cols(queryBegin, queryEnd - 1);
+
+    distances.set_size(products.n_rows, products.n_cols);
+    for (size_t j = 0; j < products.n_cols; ++j)
+    {
+      const eT* productCol = products.colptr(j);
+      double* distanceCol = distances.colptr(j);
+      for (size_t i = 0; i < products.n_rows; ++i)
+      {
+        // Roundoff may make the expansion slightly negative.
+        const double squared = std::max(double(referenceNorms[referenceBegin +
+            i] + queryNorms[j] - 2 * productCol[i]), 0.0);
+        distanceCol[i] = TakeRoot ? std::sqrt(squared) : squared;
+      }
+    }
+  }
+
+  /**
+   * Return a bound on the difference between the computed distances to the
+   * given query point and the exact ones.  For d-dimensional points r and q,
+   * the norms and twice the inner product carry an error of at most
+   * d eps (||r||^2 + ||q||^2) in total, whatever the order of summation, and
+   * the two additions at most 2 eps (||r||^2 + ||q||^2).  The bound on the
+   * squared distances is twice the sum, to cover the higher-order terms.
+   * Since |sqrt(a) - sqrt(b)| <= sqrt(|a - b|), the distances are within the
+   * square root of that.
+   */
+  double Error(const arma::Mat<eT>& querySet, const size_t queryIndex) const
+  {
+    const double queryNorm = arma::accu(arma::square(querySet.col(
+        queryIndex)));
+    const double squaredError = 2 * (referenceSet.n_rows + 2) *
+        double(std::numeric_limits<eT>::epsilon()) * (maxReferenceNorm +
+        queryNorm);
+    return TakeRoot ? std::sqrt(squaredError) : squaredError;
+  }
+
+ private:
+  //! The reference set.
+  const arma::Mat<eT>& referenceSet;
+  //! The squared norms of the reference points.
+  arma::Row<eT> referenceNorms;
+  //! The largest squared norm of a reference point.
+  double maxReferenceNorm;
+};
+
+} // namespace neighbor
+} // namespace mlpack
+
+#endif
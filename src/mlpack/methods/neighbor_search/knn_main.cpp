@@ -81,6 +81,13 @@ BINDING_SEE_ALSO("mlpack::neighbor::NeighborSearch C++ class documentation",
 
 // Define our input parameters that this program will take.
 PARAM_MATRIX_IN("reference", "Matrix containing the reference dataset.", "r");
+PARAM_STRING_IN("reference_mapped_file", "File holding the reference dataset "
+    "as a memory-mapped matrix (written by data::MappedMatrix), to use instead "
+    "of 'reference'; the tree is built directly on the mapped memory.", "", "");
+PARAM_FLAG("reorder_mapped_file", "If set, the points of the reference mapped "
+    "file are reordered in place for the tree and the order is saved next to "
+    "it, so that later runs with the same tree type and leaf size copy none of "
+    "it.", "");
 PARAM_MATRIX_OUT("distances", "Matrix to output distances into.", "d");
 PARAM_UMATRIX_OUT("neighbors", "Matrix to output neighbors into.", "n");
 PARAM_MATRIX_IN("true_distances", "Matrix of true distances to compute "
@@ -94,6 +101,17 @@ PARAM_MODEL_IN(KNNModel, "input_model", "Pre-trained kNN model.", "m");
 PARAM_MODEL_OUT(KNNModel, "output_model", "If specified, the kNN model will be "
     "output here.", "M");
 
+// The reference tree can also be saved in, and loaded from, the flat tree
+// format, which avoids rebuilding the tree when it is loaded.
+PARAM_STRING_IN("input_flat_tree_file", "File holding a reference tree in the "
+    "flat tree format (written with 'output_flat_tree_file'), to use instead of "
+    "'reference'; the dataset is used in place from a memory mapping, and the "
+    "nodes of the tree are read from the file without being rebuilt.  "
+    "'tree_type' must be the type of the saved tree.", "", "");
+PARAM_STRING_IN("output_flat_tree_file", "If specified, the reference tree is "
+    "saved to this file in the flat tree format.  Only kd-trees, ball trees, vp "
+    "trees, random projection trees and cover trees can be saved.", "", "");
+
 // The user may specify a query file of query points and a number of nearest
 // neighbors to search for.
 PARAM_MATRIX_IN("query", "Matrix containing query points (optional).", "q");
@@ -119,9 +137,17 @@ PARAM_INT_IN("seed", "Random seed (if 0, std::time(NULL) is used).", "s", 0);
 
 // Search settings.
 PARAM_STRING_IN("algorithm", "Type of neighbor search: 'naive', 'single_tree', "
-    "'dual_tree', 'greedy'.", "a", "dual_tree");
+    "'dual_tree', 'greedy', 'brute_force'.  'brute_force' compares all pairs of "
+    "points like 'naive', but computes blocks of distances at once with matrix "
+    "multiplications, which is often fastest for high-dimensional data.", "a",
+    "dual_tree");
 PARAM_DOUBLE_IN("epsilon", "If specified, will do approximate nearest neighbor "
     "search with given relative error.", "e", 0);
+PARAM_INT_IN("threads", "Number of threads to use for dual-tree and "
+    "brute-force search.  If this is not 1, independent query subtrees (or "
+    "blocks of query points) are searched in parallel; 0 means that all "
+    "available cores are used.  Only used with the 'dual_tree' and "
+    "'brute_force' algorithms.", "j", 1);
 
 static void mlpackMain()
 {
@@ -131,7 +157,17 @@ static void mlpackMain()
     math::RandomSeed((size_t) std::time(NULL));
 
   // A user cannot specify both reference data and a model.
-  RequireOnlyOnePassed({ "reference", "input_model" }, true);
+  RequireOnlyOnePassed({ "reference", "reference_mapped_file", "input_model",
+      "input_flat_tree_file" }, true);
+  ReportIgnoredParam({{ "reference_mapped_file", false }},
+      "reorder_mapped_file");
+  ReportIgnoredParam({{ "input_flat_tree_file", true }}, "random_basis");
+  if (IO::HasParam("random_basis") && IO::HasParam("output_flat_tree_file"))
+  {
+    Log::Fatal << "A random basis is not saved in the flat tree format, so "
+        << PRINT_PARAM_STRING("random_basis") << " cannot be used with "
+        << PRINT_PARAM_STRING("output_flat_tree_file") << "." << endl;
+  }
 
   ReportIgnoredParam({{ "input_model", true }}, "tree_type");
   ReportIgnoredParam({{ "input_model", true }}, "random_basis");
@@ -145,8 +181,8 @@ static void mlpackMain()
   }
 
   // The user should give something to do...
-  RequireAtLeastOnePassed({ "k", "output_model" }, false,
-      "no results will be saved");
+  RequireAtLeastOnePassed({ "k", "output_model", "output_flat_tree_file" },
+      false, "no results will be saved");
 
   // If the user specifies k but no output files, they should be warned.
   if (IO::HasParam("k"))
@@ -189,12 +225,23 @@ static void mlpackMain()
   RequireParamValue<double>("epsilon", [](double x) { return x >= 0.0; }, true,
       "epsilon must be positive");
 
+  // Sanity check on the number of threads.
+  RequireParamValue<int>("threads", [](int x) { return x >= 0; }, true,
+      "number of threads must be non-negative");
+  const int threads = IO::GetParam<int>("threads");
+  if (IO::GetParam<string>("algorithm") != "dual_tree" &&
+      IO::GetParam<string>("algorithm") != "brute_force")
+  {
+    ReportIgnoredParam("threads", "parallel search is only available for the "
+        "dual-tree and brute-force algorithms");
+  }
+
   // We either have to load the reference data, or we have to load the model.
   KNNModel* knn;
 
   const string algorithm = IO::GetParam<string>("algorithm");
   RequireParamInSet<string>("algorithm", { "naive", "single_tree", "dual_tree",
-      "greedy" }, true, "unknown neighbor search algorithm");
+      "greedy", "brute_force" }, true, "unknown neighbor search algorithm");
   NeighborSearchMode searchMode = DUAL_TREE_MODE;
 
   if (algorithm == "naive")
@@ -202,15 +249,42 @@ static void mlpackMain()
   else if (algorithm == "single_tree")
     searchMode = SINGLE_TREE_MODE;
   else if (algorithm == "dual_tree")
-    searchMode = DUAL_TREE_MODE;
+    searchMode = (threads == 1) ? DUAL_TREE_MODE : PARALLEL_DUAL_TREE_MODE;
   else if (algorithm == "greedy")
     searchMode = GREEDY_SINGLE_TREE_MODE;
+  else if (algorithm == "brute_force")
+    searchMode = BRUTE_FORCE_MODE;
+
+  if (searchMode == PARALLEL_DUAL_TREE_MODE || searchMode == BRUTE_FORCE_MODE)
+  {
+    #ifdef HAS_OPENMP
+      if (threads > 0)
+        omp_set_num_threads(threads);
+    #else
+      if (threads != 1)
+      {
+        Log::Warn << "mlpack was not compiled with OpenMP support, so "
+            << PRINT_PARAM_STRING("threads") << " is ignored and the search "
+            << "will use a single thread." << endl;
+      }
+    #endif
+  }
+
+  if ((IO::HasParam("input_flat_tree_file") ||
+       IO::HasParam("output_flat_tree_file")) && !UsesReferenceTree(searchMode))
+  {
+    Log::Fatal << "The 'naive' and 'brute_force' algorithms do not use a "
+        << "reference tree, so they cannot be used with "
+        << PRINT_PARAM_STRING("input_flat_tree_file") << " or "
+        << PRINT_PARAM_STRING("output_flat_tree_file") << "." << endl;
+  }
 
-  if (IO::HasParam("reference"))
+  if (!IO::HasParam("input_model"))
   {
     // Get all the parameters.
     const string treeType = IO::GetParam<string>("tree_type");
-    const bool randomBasis = IO::HasParam("random_basis");
+    const bool randomBasis = IO::HasParam("random_basis") &&
+        !IO::HasParam("input_flat_tree_file");
 
     KNNModel::TreeTypes tree = KNNModel::KD_TREE;
     RequireParamInSet<string>("tree_type", { "kd", "cover", "r", "r-star",
@@ -256,12 +330,34 @@ static void mlpackMain()
     knn->Tau() = tau;
     knn->Rho() = rho;
 
-    Log::Info << "Using reference data from "
-        << IO::GetPrintableParam<arma::mat>("reference") << "." << endl;
+    if (IO::HasParam("input_flat_tree_file"))
+    {
+      // The tree is not built again; it is used directly from the file.
+      knn->LoadFlat(IO::GetParam<string>("input_flat_tree_file"), searchMode,
+          epsilon);
+    }
+    else if (IO::HasParam("reference_mapped_file"))
+    {
+      // Without reordering, the pages of the file that the tree writes to are
+      // copied, and the file is left unchanged.
+      const string filename = IO::GetParam<string>("reference_mapped_file");
+      Log::Info << "Mapping reference data from '" << filename << "'."
+          << endl;
+      data::MappedMatrix<double> referenceSet(filename,
+          IO::HasParam("reorder_mapped_file") ? data::READ_WRITE :
+          data::COPY_ON_WRITE);
+
+      knn->BuildModel(std::move(referenceSet), searchMode, epsilon);
+    }
+    else
+    {
+      Log::Info << "Using reference data from "
+          << IO::GetPrintableParam<arma::mat>("reference") << "." << endl;
 
-    arma::mat referenceSet = std::move(IO::GetParam<arma::mat>("reference"));
+      arma::mat referenceSet = std::move(IO::GetParam<arma::mat>("reference"));
 
-    knn->BuildModel(std::move(referenceSet), searchMode, epsilon);
+      knn->BuildModel(std::move(referenceSet), searchMode, epsilon);
+    }
   }
   else
   {
@@ -284,6 +380,13 @@ static void mlpackMain()
         << " dataset)." << endl;
   }
 
+  if (IO::HasParam("output_flat_tree_file"))
+  {
+    const string filename = IO::GetParam<string>("output_flat_tree_file");
+    Log::Info << "Saving the reference tree to '" << filename << "'." << endl;
+    knn->SaveFlat(filename);
+  }
+
   // Perform search, if desired.
   if (IO::HasParam("k"))
   {
@@ -299,7 +402,7 @@ static void mlpackMain()
       {
         // Clean memory if needed before crashing.
         const size_t dimensions = knn->Dataset().n_rows;
-        if (IO::HasParam("reference"))
+        if (!IO::HasParam("input_model"))
           delete knn;
         Log::Fatal << "Query has invalid dimensions(" << queryData.n_rows <<
             "); should be " << dimensions << "!" << endl;
@@ -313,7 +416,7 @@ static void mlpackMain()
     {
       // Clean memory if needed before crashing.
       const size_t referencePoints = knn->Dataset().n_cols;
-      if (IO::HasParam("reference"))
+      if (!IO::HasParam("input_model"))
         delete knn;
       Log::Fatal << "Invalid k: " << k << "; must be greater than 0 and less "
           << "than or equal to the number of reference points ("
@@ -326,7 +429,7 @@ static void mlpackMain()
     {
       // Clean memory if needed before crashing.
       const size_t referencePoints = knn->Dataset().n_cols;
-      if (IO::HasParam("reference"))
+      if (!IO::HasParam("input_model"))
         delete knn;
       Log::Fatal << "Invalid k: " << k << "; must be less than the number of "
           << "reference points (" << referencePoints << ") if query data has "
@@ -357,7 +460,7 @@ static void mlpackMain()
       if (trueDistances.n_rows != distances.n_rows ||
           trueDistances.n_cols != distances.n_cols)
       {
-        if (IO::HasParam("reference"))
+        if (!IO::HasParam("input_model"))
           delete knn;
         Log::Fatal << "The true distances file must have the same number of "
             << "values than the set of distances being queried!" << endl;
@@ -381,7 +484,7 @@ static void mlpackMain()
       if (trueNeighbors.n_rows != neighbors.n_rows ||
           trueNeighbors.n_cols != neighbors.n_cols)
       {
-        if (IO::HasParam("reference"))
+        if (!IO::HasParam("input_model"))
           delete knn;
         Log::Fatal << "The true neighbors file must have the same number of "
             << "values than the set of neighbors being queried!" << endl;
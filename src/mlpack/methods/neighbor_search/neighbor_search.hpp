@@ -14,16 +14,20 @@
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/cereal/template_class_version.hpp>
 #include <vector>
 #include <string>
 
 #include <mlpack/core/tree/binary_space_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/binary_space_tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/parallel_dual_tree_traverser.hpp>
+#include <mlpack/core/tree/reference_levels.hpp>
 
 #include "neighbor_search_stat.hpp"
 #include "sort_policies/nearest_neighbor_sort.hpp"
 #include "neighbor_search_rules.hpp"
+#include "block_distances.hpp"
 
 namespace mlpack {
 // Neighbor-search routines. These include all-nearest-neighbors and
@@ -40,14 +44,27 @@ template<typename SortPolicy,
 class LeafSizeNSWrapper;
 
 //! NeighborSearchMode represents the different neighbor search modes available.
+//! PARALLEL_DUAL_TREE_MODE is dual-tree search where independent query subtrees
+//! are traversed by different OpenMP threads; its results are the same as
+//! DUAL_TREE_MODE.  BRUTE_FORCE_MODE compares every query point with every
+//! reference point like NAIVE_MODE, but computes the distances in blocks (with
+//! matrix multiplications for the Euclidean distance on dense data).
 enum NeighborSearchMode
 {
   NAIVE_MODE,
   SINGLE_TREE_MODE,
   DUAL_TREE_MODE,
-  GREEDY_SINGLE_TREE_MODE
+  GREEDY_SINGLE_TREE_MODE,
+  PARALLEL_DUAL_TREE_MODE,
+  BRUTE_FORCE_MODE
 };
 
+//! Return true if the given search mode uses a reference tree.
+inline bool UsesReferenceTree(const NeighborSearchMode mode)
+{
+  return (mode != NAIVE_MODE && mode != BRUTE_FORCE_MODE);
+}
+
 /**
  * The NeighborSearch class is a template class for performing distance-based
  * neighbor searches.  It takes a query dataset and a reference dataset (or just
@@ -211,6 +228,44 @@ class NeighborSearch
    */
   void Train(Tree referenceTree);
 
+  /**
+   * Add the given points at the end of the reference set; the first of them
+   * gets the index n, where n is the number of points in the reference set.
+   *
+   * Without a tree (NAIVE_MODE and BRUTE_FORCE_MODE), the points are simply
+   * appended to the reference set.  Otherwise the reference tree is not
+   * rebuilt: a small tree is built on the new points, and these trees are
+   * merged with each other as they grow (see tree::ReferenceLevels), so that
+   * each point takes part in O(log n) tree builds.  Searches then search every
+   * tree and merge the results.  The reference tree is rebuilt on all points
+   * once the other trees hold as many points as it does.
+   *
+   * @param points Points to add to the reference set.
+   */
+  void Insert(const MatType& points);
+
+  /**
+   * Remove the points with the given indices from the reference set.  The
+   * points after them move down, so that the reference set is the same as if
+   * the points had been removed with arma::Mat::shed_cols(), and the indices
+   * returned by later searches refer to the new reference set.
+   *
+   * With a reference tree, the points are not removed from the trees but
+   * skipped by the search rules, so that k live neighbors are still found,
+   * until the tree holding them is rebuilt.  A std::invalid_argument is thrown
+   * if an index is not in the reference set.
+   *
+   * @param indices Indices of the points to remove.
+   */
+  void Remove(const std::vector<size_t>& indices);
+
+  //! Get the number of points in the reference set (including the points
+  //! inserted since the reference tree was built).
+  size_t NumReferencePoints() const
+  {
+    return levels.Active() ? levels.NumPoints() : referenceSet->n_cols;
+  }
+
   /**
    * For each point in the query set, compute the nearest neighbors and store
    * the output in the given matrices.  The matrices will be set to the size of
@@ -326,7 +381,9 @@ class NeighborSearch
   //! Modify the relative error to be considered in approximate search.
   double& Epsilon() { return epsilon; }
 
-  //! Access the reference dataset.
+  //! Access the reference dataset.  After Insert() or Remove(), this is the
+  //! dataset of the reference tree only, which may not hold all of the points
+  //! (see NumReferencePoints()).
   const MatType& ReferenceSet() const { return *referenceSet; }
 
   //! Access the reference tree.
@@ -334,6 +391,16 @@ class NeighborSearch
   //! Modify the reference tree.
   Tree& ReferenceTree() { return *referenceTree; }
 
+  //! Get the index in the reference set of each point of the reference tree
+  //! (empty if the tree did not rearrange the points).
+  const std::vector<size_t>& OldFromNewReferences() const
+  {
+    return oldFromNewReferences;
+  }
+  //! Modify the index in the reference set of each point of the reference
+  //! tree.  This must remain a permutation.
+  std::vector<size_t>& OldFromNewReferences() { return oldFromNewReferences; }
+
   //! Serialize the NeighborSearch model.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t version);
@@ -363,14 +430,114 @@ class NeighborSearch
   //! Search() without a query set.
   bool treeNeedsReset;
 
+  //! The points inserted into and removed from the reference set since the
+  //! reference tree was built.
+  tree::ReferenceLevels<NeighborSearch, MatType> levels;
+
+  /**
+   * Search for the neighbors of the given query points in the reference tree
+   * (or reference set) only, ignoring any inserted points.  This is the search
+   * done by Search() when the reference set has not changed.  If removed is
+   * not NULL, the reference points i (in the order of the reference tree) for
+   * which removed[i] is true are skipped by the rules, so that k live
+   * neighbors are still found.
+   */
+  void SearchReference(const MatType& querySet,
+                       const size_t k,
+                       arma::Mat<size_t>& neighbors,
+                       arma::mat& distances,
+                       const std::vector<bool>* removed = NULL);
+
+  /**
+   * Search for the neighbors of the given query points in the reference tree
+   * and all of the levels of inserted points, merging the results and leaving
+   * out removed points.  If sameSet is true, query point i is the reference
+   * point with index i, and it is not returned as its own neighbor.
+   */
+  void SearchLevels(const MatType& querySet,
+                    const size_t k,
+                    arma::Mat<size_t>& neighbors,
+                    arma::mat& distances,
+                    const bool sameSet);
+
+  //! Rebuild the reference tree on all points of the reference set, so that no
+  //! levels or removed points are left.
+  void RebuildReference();
+
+  /**
+   * Perform the dual-tree traversal of the given trees with the given rules,
+   * using the parallel traverser if the search mode is
+   * PARALLEL_DUAL_TREE_MODE.
+   */
+  template<typename RuleType>
+  void DualTreeTraverse(RuleType& rules, Tree& queryTree, Tree& refTree);
+
+  /**
+   * Run the single-tree traversal for each of the given number of query points
+   * with the given rules.  The query points are split between OpenMP threads,
+   * each of which has its own rules object that shares the results of 'rules';
+   * the per-thread base case and score counts are added to 'rules'.
+   */
+  template<typename TraverserType, typename RuleType>
+  void SingleTreeTraverse(RuleType& rules, const size_t numQueries);
+
+  /**
+   * Find the k best neighbors of each point of the given query set by
+   * comparing it with every reference point.  The query set is split into
+   * blocks that are handled by different OpenMP threads; the distances between
+   * a block of query points and a block of reference points are computed at
+   * once with BlockDistances.  If the computed distances are not exact, all
+   * points that are within the roundoff error of the k-th best one are kept,
+   * and their distances are recomputed with the metric before the k best are
+   * taken, so that the results are those of the naive search.
+   *
+   * @param querySet Set of query points.
+   * @param k Number of neighbors to find.
+   * @param neighbors Matrix to store the indices of the neighbors in.
+   * @param distances Matrix to store the distances to the neighbors in.
+   * @param sameSet If true, a point is never returned as its own neighbor.
+   * @param removed If not NULL, the reference points i for which removed[i] is
+   *     true are skipped.
+   */
+  void BruteForceSearch(const MatType& querySet,
+                        const size_t k,
+                        arma::Mat<size_t>& neighbors,
+                        arma::mat& distances,
+                        const bool sameSet,
+                        const std::vector<bool>* removed = NULL);
+
+  //! Return true if the search mode is one of the dual-tree modes.
+  bool IsDualTreeMode() const
+  {
+    return (searchMode == DUAL_TREE_MODE ||
+            searchMode == PARALLEL_DUAL_TREE_MODE);
+  }
+
   //! The NSModel class should have access to internal members.
   friend class LeafSizeNSWrapper<SortPolicy, TreeType, DualTreeTraversalType,
       SingleTreeTraversalType>;
+
+  //! ReferenceLevels needs access to the reference set and its mapping.
+  friend class tree::ReferenceLevels<NeighborSearch, MatType>;
 }; // class NeighborSearch
 
 } // namespace neighbor
 } // namespace mlpack
 
+//! Version 1 added the inserted and removed points.
+CEREAL_TEMPLATE_CLASS_VERSION(
+    SINGLE_ARG(template<typename SortPolicy,
+                        typename MetricType,
+                        typename MatType,
+                        template<typename TreeMetricType,
+                                 typename TreeStatType,
+                                 typename TreeMatType> class TreeType,
+                        template<typename> class DualTreeTraversalType,
+                        template<typename> class SingleTreeTraversalType>),
+    SINGLE_ARG(mlpack::neighbor::NeighborSearch<SortPolicy, MetricType,
+        MatType, TreeType, DualTreeTraversalType, SingleTreeTraversalType>),
+    1)
+
 // Include implementation.
 #include "neighbor_search_impl.hpp"
 
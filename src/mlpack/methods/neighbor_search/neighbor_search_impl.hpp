@@ -59,16 +59,17 @@ SingleTreeTraversalType>::NeighborSearch(MatType referenceSetIn,
                                          const NeighborSearchMode mode,
                                          const double epsilon,
                                          const MetricType metric) :
-    referenceTree(mode == NAIVE_MODE ? NULL :
+    referenceTree(!UsesReferenceTree(mode) ? NULL :
         BuildTree<Tree>(std::move(referenceSetIn), oldFromNewReferences)),
-    referenceSet(mode == NAIVE_MODE ?  new MatType(std::move(referenceSetIn)) :
-        &referenceTree->Dataset()),
+    referenceSet(!UsesReferenceTree(mode) ?
+        new MatType(std::move(referenceSetIn)) : &referenceTree->Dataset()),
     searchMode(mode),
     epsilon(epsilon),
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    levels(referenceSet->n_cols)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
@@ -95,7 +96,8 @@ SingleTreeTraversalType>::NeighborSearch(Tree referenceTree,
     metric(metric),
     baseCases(0),
     scores(0),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    levels(referenceSet->n_cols)
 {
   if (epsilon < 0)
     throw std::invalid_argument("epsilon must be non-negative");
@@ -115,7 +117,8 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
                                          const double epsilon,
                                          const MetricType metric) :
     referenceTree(NULL),
-    referenceSet(mode == NAIVE_MODE ? new MatType() : NULL), // Empty matrix.
+    // Empty matrix.
+    referenceSet(!UsesReferenceTree(mode) ? new MatType() : NULL),
     searchMode(mode),
     epsilon(epsilon),
     metric(metric),
@@ -127,7 +130,7 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearchMode mode,
     throw std::invalid_argument("epsilon must be non-negative");
 
   // Build the tree on the empty dataset, if necessary.
-  if (mode != NAIVE_MODE)
+  if (UsesReferenceTree(mode))
   {
     referenceTree = BuildTree<Tree>(std::move(arma::mat()),
         oldFromNewReferences);
@@ -155,7 +158,8 @@ SingleTreeTraversalType>::NeighborSearch(const NeighborSearch& other) :
     metric(other.metric),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(false)
+    treeNeedsReset(false),
+    levels(other.levels)
 {
   // Nothing else to do.
 }
@@ -179,7 +183,8 @@ SingleTreeTraversalType>::NeighborSearch(NeighborSearch&& other) :
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
     scores(other.scores),
-    treeNeedsReset(other.treeNeedsReset)
+    treeNeedsReset(other.treeNeedsReset),
+    levels(std::move(other.levels))
 {
   // Clear the other model.
   other.referenceTree = BuildTree<Tree>(std::move(MatType()),
@@ -233,6 +238,7 @@ NeighborSearch<SortPolicy,
   baseCases = other.baseCases;
   scores = other.scores;
   treeNeedsReset = false;
+  levels = other.levels;
 }
 
 // Move operator.
@@ -275,6 +281,7 @@ NeighborSearch<SortPolicy,
   baseCases = other.baseCases;
   scores = other.scores;
   treeNeedsReset = other.treeNeedsReset;
+  levels = std::move(other.levels);
 
   // Reset the other object.  Clean memory if needed.
   if (!other.referenceTree)
@@ -332,7 +339,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType referenceSetIn)
   }
 
   // We may need to rebuild the tree.
-  if (searchMode != NAIVE_MODE)
+  if (UsesReferenceTree(searchMode))
   {
     referenceTree = BuildTree<Tree>(std::move(referenceSetIn),
         oldFromNewReferences);
@@ -342,6 +349,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(MatType referenceSetIn)
   {
     referenceSet = new MatType(std::move(referenceSetIn));
   }
+
+  levels.Reset(referenceSet->n_cols);
 }
 
 template<typename SortPolicy,
@@ -355,9 +364,9 @@ template<typename SortPolicy,
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree referenceTree)
 {
-  if (searchMode == NAIVE_MODE)
+  if (!UsesReferenceTree(searchMode))
     throw std::invalid_argument("cannot train on given reference tree when "
-        "naive search (without trees) is desired");
+        "naive or brute-force search (without trees) is desired");
 
   if (this->referenceTree)
   {
@@ -371,6 +380,101 @@ DualTreeTraversalType, SingleTreeTraversalType>::Train(Tree referenceTree)
 
   this->referenceTree = new Tree(std::move(referenceTree));
   this->referenceSet = &this->referenceTree->Dataset();
+  levels.Reset(this->referenceSet->n_cols);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Insert(const MatType& points)
+{
+  if (!referenceTree)
+  {
+    // Without a tree, we can just add the points to the reference set.
+    if (referenceSet->n_cols > 0 && points.n_rows != referenceSet->n_rows)
+    {
+      std::ostringstream oss;
+      oss << "NeighborSearch::Insert(): dimensionality of points ("
+          << points.n_rows << ") does not match dimensionality of reference "
+          << "set (" << referenceSet->n_rows << ")!";
+      throw std::invalid_argument(oss.str());
+    }
+
+    MatType* newReferenceSet = new MatType(arma::join_rows(*referenceSet,
+        points));
+    delete referenceSet;
+    referenceSet = newReferenceSet;
+    levels.Reset(referenceSet->n_cols);
+    return;
+  }
+
+  levels.Insert(*this, MatType(points), [this](MatType&& levelSet)
+      {
+        return new NeighborSearch(std::move(levelSet), searchMode, epsilon,
+            metric);
+      });
+
+  if (levels.MainNeedsRebuild())
+    RebuildReference();
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::Remove(
+    const std::vector<size_t>& indices)
+{
+  if (!referenceTree)
+  {
+    // Without a tree, we can just take the points out of the reference set.
+    std::vector<bool> removed(referenceSet->n_cols, false);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      if (indices[i] >= referenceSet->n_cols)
+      {
+        std::ostringstream oss;
+        oss << "NeighborSearch::Remove(): cannot remove point " << indices[i]
+            << "; the reference set has only " << referenceSet->n_cols
+            << " points!";
+        throw std::invalid_argument(oss.str());
+      }
+      removed[indices[i]] = true;
+    }
+
+    const size_t numRemoved = std::count(removed.begin(), removed.end(), true);
+    MatType* newReferenceSet = new MatType(referenceSet->n_rows,
+        referenceSet->n_cols - numRemoved);
+    size_t column = 0;
+    for (size_t i = 0; i < referenceSet->n_cols; ++i)
+      if (!removed[i])
+        newReferenceSet->col(column++) = referenceSet->col(i);
+
+    delete referenceSet;
+    referenceSet = newReferenceSet;
+    levels.Reset(referenceSet->n_cols);
+    return;
+  }
+
+  levels.Remove(*this, indices, [this](MatType&& levelSet)
+      {
+        return new NeighborSearch(std::move(levelSet), searchMode, epsilon,
+            metric);
+      });
+
+  if (levels.MainNeedsRebuild())
+    RebuildReference();
 }
 
 /**
@@ -392,14 +496,36 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferencePoints())
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferencePoints() << ")";
     throw std::invalid_argument(ss.str());
   }
 
+  if (levels.Active())
+    SearchLevels(querySet, k, neighbors, distances, false);
+  else
+    SearchReference(querySet, k, neighbors, distances);
+}
+
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SearchReference(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    const std::vector<bool>* removed)
+{
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -418,7 +544,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   // Mapping is only necessary if the tree rearranges points.
   if (tree::TreeTraits<Tree>::RearrangesDataset)
   {
-    if (searchMode == DUAL_TREE_MODE)
+    if (IsDualTreeMode())
     {
       distancePtr = new arma::mat; // Query indices need to be mapped.
       neighborPtr = new arma::Mat<size_t>;
@@ -438,29 +564,41 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     case NAIVE_MODE:
     {
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
+      RuleType rules(*referenceSet, querySet, k, metric, epsilon, false,
+          removed);
 
-      // The naive brute-force traversal.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
+      // The naive brute-force traversal.  Each thread handles its own query
+      // points with rules that share the results of 'rules'.
+      #pragma omp parallel
+      {
+        RuleType threadRules(&rules);
+
+        #pragma omp for
+        for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+          for (size_t j = 0; j < referenceSet->n_cols; ++j)
+            threadRules.BaseCase(i, j);
+      }
 
       baseCases += querySet.n_cols * referenceSet->n_cols;
 
       rules.GetResults(*neighborPtr, *distancePtr);
       break;
     }
+    case BRUTE_FORCE_MODE:
+    {
+      BruteForceSearch(querySet, k, *neighborPtr, *distancePtr, false,
+          removed);
+      break;
+    }
     case SINGLE_TREE_MODE:
     {
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric, epsilon);
-
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
+      RuleType rules(*referenceSet, querySet, k, metric, epsilon, false,
+          removed);
 
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Now traverse for each point.
+      SingleTreeTraverse<SingleTreeTraversalType<RuleType>>(rules,
+          querySet.n_cols);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -474,6 +612,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       break;
     }
     case DUAL_TREE_MODE:
+    case PARALLEL_DUAL_TREE_MODE:
     {
       // Build the query tree.
       Timer::Stop("computing_neighbors");
@@ -483,12 +622,10 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       Timer::Start("computing_neighbors");
 
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon);
-
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
+      RuleType rules(*referenceSet, queryTree->Dataset(), k, metric, epsilon,
+          false, removed);
 
-      traverser.Traverse(*queryTree, *referenceTree);
+      DualTreeTraverse(rules, *queryTree, *referenceTree);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -506,14 +643,11 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     case GREEDY_SINGLE_TREE_MODE:
     {
       // Create the helper object for the tree traversal.
-      RuleType rules(*referenceSet, querySet, k, metric);
+      RuleType rules(*referenceSet, querySet, k, metric, 0, false, removed);
 
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < querySet.n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Now traverse for each point.
+      SingleTreeTraverse<tree::GreedySingleTreeTraverser<Tree, RuleType>>(
+          rules, querySet.n_cols);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -533,7 +667,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   // Map points back to original indices, if necessary.
   if (tree::TreeTraits<Tree>::RearrangesDataset)
   {
-    if (searchMode == DUAL_TREE_MODE && !oldFromNewReferences.empty())
+    if (IsDualTreeMode() && !oldFromNewReferences.empty())
     {
       // We must map both query and reference indices.
       neighbors.set_size(k, querySet.n_cols);
@@ -556,7 +690,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       delete neighborPtr;
       delete distancePtr;
     }
-    else if (searchMode == DUAL_TREE_MODE)
+    else if (IsDualTreeMode())
     {
       // We must map query indices only.
       neighbors.set_size(k, querySet.n_cols);
@@ -588,7 +722,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       delete neighborPtr;
     }
   }
-} // Search()
+} // SearchReference()
 
 template<typename SortPolicy,
          typename MetricType,
@@ -606,19 +740,27 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::mat& distances,
     bool sameSet)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferencePoints())
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferencePoints() << ")";
     throw std::invalid_argument(ss.str());
   }
 
   // Make sure we are in dual-tree mode.
-  if (searchMode != DUAL_TREE_MODE)
+  if (!IsDualTreeMode())
     throw std::invalid_argument("cannot call NeighborSearch::Search() with a "
         "query tree when naive or singleMode are set to true");
 
+  // If points were inserted or removed, the query tree can't be traversed
+  // with the reference tree alone, so search the levels with its points.
+  if (levels.Active())
+  {
+    SearchLevels(queryTree.Dataset(), k, neighbors, distances, sameSet);
+    return;
+  }
+
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -640,10 +782,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
   RuleType rules(*referenceSet, querySet, k, metric, epsilon, sameSet);
-
-  // Create the traverser.
-  DualTreeTraversalType<RuleType> traverser(rules);
-  traverser.Traverse(queryTree, *referenceTree);
+  DualTreeTraverse(rules, queryTree, *referenceTree);
 
   scores += rules.Scores();
   baseCases += rules.BaseCases();
@@ -689,22 +828,32 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     arma::Mat<size_t>& neighbors,
     arma::mat& distances)
 {
-  if (k > referenceSet->n_cols)
+  if (k > NumReferencePoints())
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is greater than the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ")";
+        << "points in the reference set (" << NumReferencePoints() << ")";
     throw std::invalid_argument(ss.str());
   }
-  if (k == referenceSet->n_cols)
+  if (k == NumReferencePoints())
   {
     std::stringstream ss;
     ss << "Requested value of k (" << k << ") is equal to the number of "
-        << "points in the reference set (" << referenceSet->n_cols << ") and "
+        << "points in the reference set (" << NumReferencePoints() << ") and "
         << "no query set has been provided.";
     throw std::invalid_argument(ss.str());
   }
 
+  // If points were inserted or removed, we search for the neighbors of all
+  // points in the reference set as a query set.
+  if (levels.Active())
+  {
+    MatType points;
+    levels.Gather(*this, points);
+    SearchLevels(points, k, neighbors, distances, true);
+    return;
+  }
+
   Timer::Start("computing_neighbors");
 
   baseCases = 0;
@@ -725,31 +874,45 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   neighborPtr->set_size(k, referenceSet->n_cols);
   distancePtr->set_size(k, referenceSet->n_cols);
 
+  // The brute-force search does not use the rules to store its results, so in
+  // that case the rules do not need any candidate lists.
+  const bool useRules = (searchMode != BRUTE_FORCE_MODE);
+
   // Create the helper object for the traversal.
   typedef NeighborSearchRules<SortPolicy, MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, k, metric, epsilon,
-      true /* don't return the same point as nearest neighbor */);
+  RuleType rules(*referenceSet, *referenceSet, useRules ? k : 0, metric,
+      epsilon, true /* don't return the same point as nearest neighbor */);
 
   switch (searchMode)
   {
     case NAIVE_MODE:
     {
-      // The naive brute-force solution.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        for (size_t j = 0; j < referenceSet->n_cols; ++j)
-          rules.BaseCase(i, j);
+      // The naive brute-force solution.  Each thread handles its own query
+      // points with rules that share the results of 'rules'.
+      #pragma omp parallel
+      {
+        RuleType threadRules(&rules);
+
+        #pragma omp for
+        for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
+          for (size_t j = 0; j < referenceSet->n_cols; ++j)
+            threadRules.BaseCase(i, j);
+      }
 
       baseCases += referenceSet->n_cols * referenceSet->n_cols;
       break;
     }
+    case BRUTE_FORCE_MODE:
+    {
+      BruteForceSearch(*referenceSet, k, *neighborPtr, *distancePtr,
+          true /* don't return the same point as nearest neighbor */);
+      break;
+    }
     case SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      SingleTreeTraversalType<RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Now traverse for each point.
+      SingleTreeTraverse<SingleTreeTraversalType<RuleType>>(rules,
+          referenceSet->n_cols);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -761,6 +924,7 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
       break;
     }
     case DUAL_TREE_MODE:
+    case PARALLEL_DUAL_TREE_MODE:
     {
       // The dual-tree monochromatic search case may require resetting the
       // bounds in the tree.
@@ -782,19 +946,16 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
         }
       }
 
-      // Create the traverser.
-      DualTreeTraversalType<RuleType> traverser(rules);
-
       if (tree::IsSpillTree<Tree>::value)
       {
         // For Dual Tree Search on SpillTree, the queryTree must be built with
         // non overlapping (tau = 0).
         Tree queryTree(*referenceSet);
-        traverser.Traverse(queryTree, *referenceTree);
+        DualTreeTraverse(rules, queryTree, *referenceTree);
       }
       else
       {
-        traverser.Traverse(*referenceTree, *referenceTree);
+        DualTreeTraverse(rules, *referenceTree, *referenceTree);
         // Next time we perform this search, we'll need to reset the tree.
         treeNeedsReset = true;
       }
@@ -813,12 +974,9 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
     case GREEDY_SINGLE_TREE_MODE:
     {
-      // Create the traverser.
-      tree::GreedySingleTreeTraverser<Tree, RuleType> traverser(rules);
-
-      // Now have it traverse for each point.
-      for (size_t i = 0; i < referenceSet->n_cols; ++i)
-        traverser.Traverse(i, *referenceTree);
+      // Now traverse for each point.
+      SingleTreeTraverse<tree::GreedySingleTreeTraverser<Tree, RuleType>>(
+          rules, referenceSet->n_cols);
 
       scores += rules.Scores();
       baseCases += rules.BaseCases();
@@ -831,7 +989,8 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
     }
   }
 
-  rules.GetResults(*neighborPtr, *distancePtr);
+  if (useRules)
+    rules.GetResults(*neighborPtr, *distancePtr);
 
   Timer::Stop("computing_neighbors");
 
@@ -859,6 +1018,386 @@ DualTreeTraversalType, SingleTreeTraversalType>::Search(
   }
 }
 
+//! Find the neighbors of each query point by blocked brute-force search.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::BruteForceSearch(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    const bool sameSet,
+    const std::vector<bool>* removed)
+{
+  // The number of query and reference points in each block.  A block of
+  // distances then takes 2MB.
+  const size_t queryBlockSize = 256;
+  const size_t referenceBlockSize = 1024;
+
+  // Candidates are handled as in NeighborSearchRules: each list holds the k
+  // best candidates so far, with the worst of them on top.
+  typedef std::pair<double, size_t> Candidate;
+  struct CandidateCmp
+  {
+    bool operator()(const Candidate& c1, const Candidate& c2)
+    {
+      return !SortPolicy::IsBetter(c2.first, c1.first);
+    };
+  };
+  typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
+      CandidateList;
+
+  typedef BlockDistances<MetricType, MatType> BlockDistancesType;
+  const BlockDistancesType blockDistances(metric, *referenceSet);
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+
+  const size_t numReferences = referenceSet->n_cols;
+  const size_t numQueryBlocks = (querySet.n_cols + queryBlockSize - 1) /
+      queryBlockSize;
+
+  #pragma omp parallel for schedule(dynamic)
+  for (omp_size_t b = 0; b < (omp_size_t) numQueryBlocks; ++b)
+  {
+    const size_t queryBegin = b * queryBlockSize;
+    const size_t queryEnd = std::min(queryBegin + queryBlockSize,
+        (size_t) querySet.n_cols);
+
+    const Candidate def = std::make_pair(SortPolicy::WorstDistance(),
+        size_t() - 1);
+    std::vector<CandidateList> candidates(queryEnd - queryBegin,
+        CandidateList(CandidateCmp(), std::vector<Candidate>(k, def)));
+
+    // If the computed distances are not exact, a point whose computed distance
+    // is worse than that of the k-th candidate by no more than twice the error
+    // may still be one of the k best.  These points are kept as extra
+    // candidates, and the distances to all candidates are recomputed exactly
+    // at the end.
+    const bool exact = BlockDistancesType::Exact;
+    std::vector<std::vector<Candidate>> extras(exact ? 0 :
+        queryEnd - queryBegin);
+    std::vector<double> margins(extras.size());
+    for (size_t q = 0; q < margins.size(); ++q)
+      margins[q] = 2 * blockDistances.Error(querySet, queryBegin + q);
+
+    arma::mat block;
+    for (size_t refBegin = 0; refBegin < numReferences;
+         refBegin += referenceBlockSize)
+    {
+      const size_t refEnd = std::min(refBegin + referenceBlockSize,
+          numReferences);
+      blockDistances.Compute(querySet, queryBegin, queryEnd, refBegin, refEnd,
+          block);
+
+      for (size_t q = 0; q < block.n_cols; ++q)
+      {
+        const size_t queryIndex = queryBegin + q;
+        CandidateList& pqueue = candidates[q];
+        const double* blockCol = block.colptr(q);
+        for (size_t r = 0; r < block.n_rows; ++r)
+        {
+          if (sameSet && (refBegin + r == queryIndex))
+            continue;
+          if (removed != NULL && (*removed)[refBegin + r])
+            continue;
+
+          // This is the candidate that does not make it into the list.
+          const Candidate c = std::make_pair(blockCol[r], refBegin + r);
+          Candidate dropped = c;
+          if (CandidateCmp()(c, pqueue.top()))
+          {
+            dropped = pqueue.top();
+            pqueue.pop();
+            pqueue.push(c);
+          }
+
+          if (!exact && dropped.second != size_t() - 1 &&
+              SortPolicy::IsBetter(dropped.first, SortPolicy::CombineWorst(
+              pqueue.top().first, margins[q])))
+            extras[q].push_back(dropped);
+        }
+
+        // The k-th computed distance only gets better, so the extra
+        // candidates that are now too far from it can be dropped for good.
+        if (!exact)
+        {
+          const double bound = SortPolicy::CombineWorst(pqueue.top().first,
+              margins[q]);
+          std::vector<Candidate>& extra = extras[q];
+          extra.erase(std::remove_if(extra.begin(), extra.end(),
+              [bound](const Candidate& e)
+              {
+                return !SortPolicy::IsBetter(e.first, bound);
+              }), extra.end());
+        }
+      }
+    }
+
+    // Extract the results, best candidate first.
+    std::vector<Candidate> best;
+    for (size_t q = 0; q < candidates.size(); ++q)
+    {
+      const size_t queryIndex = queryBegin + q;
+      CandidateList& pqueue = candidates[q];
+      best.resize(k);
+      for (size_t j = 1; j <= k; ++j)
+      {
+        best[k - j] = pqueue.top();
+        pqueue.pop();
+      }
+
+      // Approximate distances are replaced by the exact ones, and the k best
+      // of the candidates and the extra candidates are taken.  Ties are broken
+      // by index, like the naive search does.
+      if (!exact)
+      {
+        best.insert(best.end(), extras[q].begin(), extras[q].end());
+        for (size_t j = 0; j < best.size(); ++j)
+        {
+          // Fewer than k points may be left after removals.
+          if (best[j].second == size_t() - 1)
+            continue;
+
+          best[j].first = metric.Evaluate(querySet.col(queryIndex),
+              referenceSet->col(best[j].second));
+        }
+
+        std::partial_sort(best.begin(), best.begin() + k, best.end(),
+            [](const Candidate& c1, const Candidate& c2)
+            {
+              if (c1.first == c2.first)
+                return c1.second < c2.second;
+              return SortPolicy::IsBetter(c1.first, c2.first);
+            });
+      }
+
+      for (size_t j = 0; j < k; ++j)
+      {
+        neighbors(j, queryIndex) = best[j].second;
+        distances(j, queryIndex) = best[j].first;
+      }
+    }
+  }
+
+  baseCases += querySet.n_cols * numReferences;
+}
+
+//! Search the reference tree and the levels, and merge the results.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SearchLevels(
+    const MatType& querySet,
+    const size_t k,
+    arma::Mat<size_t>& neighbors,
+    arma::mat& distances,
+    const bool sameSet)
+{
+  // The candidate neighbors (distance, index) of each query point.
+  typedef std::pair<double, size_t> Candidate;
+  std::vector<std::vector<Candidate>> candidates(querySet.n_cols);
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+
+  arma::Mat<size_t> setNeighbors;
+  arma::mat setDistances;
+  for (size_t s = 0; s <= levels.NumLevels(); ++s)
+  {
+    // Set 0 is the reference tree; the others are the levels.
+    const size_t setSize = (s == 0) ? levels.NumMainPoints() :
+        levels.LevelIds(s - 1).size();
+    const size_t setRemoved = (s == 0) ? levels.NumMainRemoved() :
+        levels.NumLevelRemoved(s - 1);
+    if (setSize == setRemoved)
+      continue;
+
+    // The rules skip the removed points, so only the query point itself (for
+    // sameSet) can take the place of one of the k neighbors.
+    const size_t setK = std::min(k + (sameSet ? 1 : 0), setSize - setRemoved);
+    const std::vector<bool>& removed = (s == 0) ? levels.MainRemoved() :
+        levels.LevelRemoved(s - 1);
+    const std::vector<bool>* removedPtr = removed.empty() ? NULL : &removed;
+    if (s == 0)
+    {
+      SearchReference(querySet, setK, setNeighbors, setDistances, removedPtr);
+      totalBaseCases += baseCases;
+      totalScores += scores;
+    }
+    else
+    {
+      NeighborSearch& level = levels.Level(s - 1);
+      level.SearchMode() = searchMode;
+      level.Epsilon() = epsilon;
+      level.SearchReference(querySet, setK, setNeighbors, setDistances,
+          removedPtr);
+      totalBaseCases += level.BaseCases();
+      totalScores += level.Scores();
+    }
+
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+    {
+      for (size_t j = 0; j < setK; ++j)
+      {
+        // Approximate search may not find all neighbors.
+        const size_t index = setNeighbors(j, q);
+        if (index == size_t() - 1)
+          continue;
+
+        const size_t id = (s == 0) ? index : levels.LevelIds(s - 1)[index];
+        const size_t position = levels.Position(id);
+        if (sameSet && position == q)
+          continue;
+
+        candidates[q].push_back(Candidate(setDistances(j, q), position));
+      }
+    }
+  }
+
+  neighbors.set_size(k, querySet.n_cols);
+  distances.set_size(k, querySet.n_cols);
+  for (size_t q = 0; q < querySet.n_cols; ++q)
+  {
+    std::vector<Candidate>& queryCandidates = candidates[q];
+    const size_t found = std::min(k, queryCandidates.size());
+    std::partial_sort(queryCandidates.begin(), queryCandidates.begin() + found,
+        queryCandidates.end(), [](const Candidate& c1, const Candidate& c2)
+        {
+          if (c1.first == c2.first)
+            return c1.second < c2.second;
+          return SortPolicy::IsBetter(c1.first, c2.first);
+        });
+
+    for (size_t j = 0; j < k; ++j)
+    {
+      neighbors(j, q) = (j < found) ? queryCandidates[j].second : size_t() - 1;
+      distances(j, q) = (j < found) ? queryCandidates[j].first :
+          SortPolicy::WorstDistance();
+    }
+  }
+
+  baseCases = totalBaseCases;
+  scores = totalScores;
+}
+
+//! Rebuild the reference tree on all points of the reference set.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::RebuildReference()
+{
+  MatType points;
+  levels.Gather(*this, points);
+
+  // Training resets the levels.
+  Train(std::move(points));
+  treeNeedsReset = false;
+}
+
+//! Run the dual-tree traversal, in parallel if requested.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::DualTreeTraverse(
+    RuleType& rules,
+    Tree& queryTree,
+    Tree& refTree)
+{
+  if (searchMode == PARALLEL_DUAL_TREE_MODE)
+  {
+    // Each thread gets its own copy of the rules, which writes into the
+    // candidate lists of 'rules'.
+    tree::ParallelDualTreeTraverser<Tree, RuleType,
+        DualTreeTraversalType<RuleType>> traverser(rules);
+    traverser.Traverse(queryTree, refTree);
+
+    Log::Info << "Parallel traversal used " << traverser.NumTasks()
+        << " query subtrees." << std::endl;
+    Profiler::Count("prunes", traverser.NumPrunes());
+  }
+  else
+  {
+    DualTreeTraversalType<RuleType> traverser(rules);
+    traverser.Traverse(queryTree, refTree);
+    Profiler::Count("prunes", traverser.NumPrunes());
+  }
+
+  Profiler::Count("base_cases", rules.BaseCases());
+  Profiler::Count("scores", rules.Scores());
+}
+
+//! Run the single-tree traversal for each query point, in parallel.
+template<typename SortPolicy,
+         typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename> class DualTreeTraversalType,
+         template<typename> class SingleTreeTraversalType>
+template<typename TraverserType, typename RuleType>
+void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
+DualTreeTraversalType, SingleTreeTraversalType>::SingleTreeTraverse(
+    RuleType& rules,
+    const size_t numQueries)
+{
+  size_t threadBaseCases = 0;
+  size_t threadScores = 0;
+
+  // The worker threads record their counters in the scope of this thread.
+  const std::string scope = Profiler::Scope();
+
+  // Trees with self-children cache the last distance evaluation of each
+  // reference node in its statistic, so these can't be shared between threads.
+  #pragma omp parallel if (!tree::TreeTraits<Tree>::HasSelfChildren) \
+      reduction(+:threadBaseCases, threadScores)
+  {
+    ScopedTimer timer("single_tree_traversal", scope);
+    RuleType threadRules(&rules);
+    TraverserType traverser(threadRules);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) numQueries; ++i)
+      traverser.Traverse(i, *referenceTree);
+
+    threadBaseCases += threadRules.BaseCases();
+    threadScores += threadRules.Scores();
+    Profiler::Count("base_cases", threadRules.BaseCases());
+    Profiler::Count("scores", threadRules.Scores());
+    Profiler::Count("prunes", traverser.NumPrunes());
+  }
+
+  rules.BaseCases() += threadBaseCases;
+  rules.Scores() += threadScores;
+}
+
 //! Calculate the average relative error.
 template<typename SortPolicy,
          typename MetricType,
@@ -940,15 +1479,15 @@ template<typename SortPolicy,
 template<typename Archive>
 void NeighborSearch<SortPolicy, MetricType, MatType, TreeType,
 DualTreeTraversalType, SingleTreeTraversalType>::serialize(
-    Archive& ar, const uint32_t /* version */)
+    Archive& ar, const uint32_t version)
 {
   // Serialize preferences for search.
   ar(CEREAL_NVP(searchMode));
   ar(CEREAL_NVP(treeNeedsReset));
 
-  // If we are doing naive search, we serialize the dataset.  Otherwise we
-  // serialize the tree.
-  if (searchMode == NAIVE_MODE)
+  // If we are doing naive or brute-force search, we serialize the dataset.
+  // Otherwise we serialize the tree.
+  if (!UsesReferenceTree(searchMode))
   {
     // Delete the current reference set, if necessary and if we are loading.
     if (cereal::is_loading<Archive>() && referenceSet)
@@ -995,6 +1534,13 @@ DualTreeTraversalType, SingleTreeTraversalType>::serialize(
     baseCases = 0;
     scores = 0;
   }
+
+  // The points inserted or removed since the reference tree was built are
+  // kept in the levels.  Models saved before version 1 have none.
+  if (version >= 1)
+    ar(CEREAL_NVP(levels));
+  else if (cereal::is_loading<Archive>())
+    levels.Reset(referenceSet->n_cols);
 }
 
 } // namespace neighbor
@@ -13,6 +13,8 @@
 #ifndef MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 #define MLPACK_METHODS_NEIGHBOR_SEARCH_NEIGHBOR_SEARCH_RULES_HPP
 
+#include <mlpack/core/tree/hrectbound.hpp>
+#include <mlpack/core/tree/rule_traits.hpp>
 #include <mlpack/core/tree/traversal_info.hpp>
 
 #include <queue>
@@ -46,13 +48,42 @@ class NeighborSearchRules
    * @param epsilon Relative approximate error.
    * @param sameSet If true, the query and reference set are taken to be the
    *      same, and a query point will not return itself in the results.
+   * @param removed If not NULL, the reference points i for which removed[i] is
+   *      true are never returned as neighbors (they are still evaluated, so
+   *      the traversal is unchanged).  It must outlive this object.
    */
   NeighborSearchRules(const typename TreeType::Mat& referenceSet,
                       const typename TreeType::Mat& querySet,
                       const size_t k,
                       MetricType& metric,
                       const double epsilon = 0,
-                      const bool sameSet = false);
+                      const bool sameSet = false,
+                      const std::vector<bool>* removed = NULL);
+
+  /**
+   * Construct a NeighborSearchRules object that shares the candidate lists of
+   * the given rules object.  This is meant for parallel traversals, where each
+   * thread needs its own rules object: the base case cache, the traversal
+   * information and the counters are not shared, but any neighbor found is
+   * written directly into the candidate lists of the given object.  Rules
+   * objects created this way must only ever be used on disjoint sets of query
+   * points, and must not outlive the given object.
+   *
+   * @param other Rules object whose candidate lists will be used.
+   */
+  explicit NeighborSearchRules(NeighborSearchRules* other);
+
+  /**
+   * Copy the given NeighborSearchRules object, including its candidate lists.
+   *
+   * @param other Rules object to copy.
+   */
+  NeighborSearchRules(const NeighborSearchRules& other);
+
+  /**
+   * Clean up the candidate lists, if this object owns them.
+   */
+  ~NeighborSearchRules();
 
   /**
    * Store the list of candidates for each query point in the given matrices.
@@ -73,6 +104,20 @@ class NeighborSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between the query point and each reference point in
+   * [referenceBegin, referenceBegin + referenceCount), computing all of the
+   * distances at once.  This has the same effect as calling BaseCase() for
+   * each of the reference points, and can only be used with an LMetric.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceBegin Index of the first reference point.
+   * @param referenceCount Number of reference points.
+   */
+  void BaseCase(const size_t queryIndex,
+                const size_t referenceBegin,
+                const size_t referenceCount);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -183,8 +228,12 @@ class NeighborSearchRules
   typedef std::priority_queue<Candidate, std::vector<Candidate>, CandidateCmp>
       CandidateList;
 
-  //! Set of candidate neighbors for each point.
-  std::vector<CandidateList> candidates;
+  //! Set of candidate neighbors for each point.  This may be shared with
+  //! another rules object during a parallel traversal.
+  std::vector<CandidateList>* candidates;
+
+  //! If true, this object owns the candidate lists and must delete them.
+  bool ownsCandidates;
 
   //! Number of neighbors to search for.
   const size_t k;
@@ -195,6 +244,9 @@ class NeighborSearchRules
   //! Denotes whether or not the reference and query sets are the same.
   bool sameSet;
 
+  //! The reference points that must not be returned as neighbors, or NULL.
+  const std::vector<bool>* removed;
+
   //! Relative error to be considered in approximate search.
   const double epsilon;
 
@@ -205,6 +257,9 @@ class NeighborSearchRules
   //! The last base case result.
   double lastBaseCase;
 
+  //! Storage for the distances computed by the batched BaseCase().
+  arma::Col<typename TreeType::Mat::elem_type> batchDistances;
+
   //! The number of base cases that have been performed.
   size_t baseCases;
   //! The number of scores that have been performed.
@@ -232,6 +287,22 @@ class NeighborSearchRules
 };
 
 } // namespace neighbor
+
+namespace tree {
+
+//! NeighborSearchRules has a batched base case when used with an LMetric on
+//! dense data.
+template<typename SortPolicy, typename MetricType, typename TreeType>
+class RuleTraits<neighbor::NeighborSearchRules<SortPolicy, MetricType,
+                                               TreeType>>
+{
+ public:
+  static const bool HasBatchBaseCase =
+      bound::meta::IsLMetric<MetricType>::Value &&
+      !arma::is_SpMat<typename TreeType::Mat>::value;
+};
+
+} // namespace tree
 } // namespace mlpack
 
 // Include implementation.
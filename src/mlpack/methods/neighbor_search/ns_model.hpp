@@ -21,6 +21,8 @@
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/spill_tree.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/tree/flat_tree.hpp>
+#include <mlpack/core/data/mapped_matrix.hpp>
 #include "neighbor_search.hpp"
 
 namespace mlpack {
@@ -79,6 +81,28 @@ class NSWrapperBase
   virtual void Search(const size_t k,
                       arma::Mat<size_t>& neighbors,
                       arma::mat& distances) = 0;
+
+  //! Add the given points at the end of the reference set.
+  virtual void Insert(const arma::mat& points) = 0;
+
+  //! Remove the points with the given indices from the reference set.
+  virtual void Remove(const std::vector<size_t>& indices) = 0;
+
+  //! Return true if the reference tree rearranged the points of the reference
+  //! set (so that OldFromNewReferences() is not empty).
+  virtual bool RearrangesDataset() const = 0;
+
+  //! Modify the index in the reference set of each point of the reference
+  //! tree.
+  virtual std::vector<size_t>& OldFromNewReferences() = 0;
+
+  //! Save the reference tree in the flat tree format.
+  virtual void SaveFlat(const std::string& filename) const = 0;
+
+  //! Load the reference tree from a file in the flat tree format, holding the
+  //! mapping of the file in the given object.
+  virtual void LoadFlat(const std::string& filename,
+                        data::MappedFile& mapping) = 0;
 };
 
 /**
@@ -150,6 +174,39 @@ class NSWrapper : public NSWrapperBase
                       arma::Mat<size_t>& neighbors,
                       arma::mat& distances);
 
+  //! Add the given points at the end of the reference set.
+  virtual void Insert(const arma::mat& points) { ns.Insert(points); }
+
+  //! Remove the points with the given indices from the reference set.
+  virtual void Remove(const std::vector<size_t>& indices)
+  {
+    ns.Remove(indices);
+  }
+
+  //! Return true if the reference tree rearranged the points of the reference
+  //! set.
+  virtual bool RearrangesDataset() const
+  {
+    return UsesReferenceTree(ns.SearchMode()) &&
+        tree::TreeTraits<typename NSType::Tree>::RearrangesDataset;
+  }
+
+  //! Modify the index in the reference set of each point of the reference
+  //! tree.
+  virtual std::vector<size_t>& OldFromNewReferences()
+  {
+    return ns.OldFromNewReferences();
+  }
+
+  //! Save the reference tree and the original indices of its points in the
+  //! flat tree format.
+  virtual void SaveFlat(const std::string& filename) const;
+
+  //! Load the reference tree and the original indices of its points from a
+  //! file in the flat tree format; the tree uses the mapped file in place.
+  virtual void LoadFlat(const std::string& filename,
+                        data::MappedFile& mapping);
+
   //! Serialize the NeighborSearch model.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t /* version */)
@@ -168,6 +225,39 @@ class NSWrapper : public NSWrapperBase
 
   //! The instantiated NeighborSearch object that we are wrapping.
   NSType ns;
+
+ private:
+  //! Save the given tree in the flat tree format.
+  template<typename Tree>
+  static void SaveFlatTree(
+      const std::string& filename,
+      const Tree& referenceTree,
+      const std::vector<size_t>& oldFromNew,
+      const typename std::enable_if_t<tree::HasFlatFormat<Tree>::value>* = 0);
+
+  //! Throw an exception, since the given type of tree has no flat format.
+  template<typename Tree>
+  static void SaveFlatTree(
+      const std::string& filename,
+      const Tree& referenceTree,
+      const std::vector<size_t>& oldFromNew,
+      const typename std::enable_if_t<!tree::HasFlatFormat<Tree>::value>* = 0);
+
+  //! Load a tree of the given type from a file in the flat tree format.
+  template<typename Tree>
+  static Tree* LoadFlatTree(
+      const std::string& filename,
+      std::vector<size_t>& oldFromNew,
+      data::MappedFile& mapping,
+      const typename std::enable_if_t<tree::HasFlatFormat<Tree>::value>* = 0);
+
+  //! Throw an exception, since the given type of tree has no flat format.
+  template<typename Tree>
+  static Tree* LoadFlatTree(
+      const std::string& filename,
+      std::vector<size_t>& oldFromNew,
+      data::MappedFile& mapping,
+      const typename std::enable_if_t<!tree::HasFlatFormat<Tree>::value>* = 0);
 };
 
 /**
@@ -372,6 +462,13 @@ class NSModel
    */
   NSWrapperBase* nSearch;
 
+  //! The memory-mapped reference set that the model was built on, if any; the
+  //! reference tree uses its memory.
+  std::shared_ptr<data::MappedMatrix<double>> mappedReference;
+  //! The memory-mapped flat tree file that the model was loaded from, if any;
+  //! the reference tree uses its memory.
+  std::shared_ptr<data::MappedFile> mappedTree;
+
  public:
   /**
    * Initialize the NSModel with the given type and whether or not a random
@@ -458,6 +555,57 @@ class NSModel
                   const NeighborSearchMode searchMode,
                   const double epsilon = 0);
 
+  /**
+   * Build the reference tree directly on the memory of the given mapped
+   * matrix, which the model takes ownership of.  The indices returned by the
+   * searches are the original indices of the points, even if the file was
+   * reordered before (see data::MappedMatrix::OldFromNew()).
+   *
+   * If the tree rearranges the points, the mapping must not be READ_ONLY (a
+   * std::invalid_argument is thrown).  With a READ_WRITE mapping the file is
+   * reordered in place and the order is saved next to it, so that later
+   * COPY_ON_WRITE mappings of it copy nothing.  If the points must be in their
+   * original order in memory (with a random basis, or without a tree that
+   * rearranges them, once the file has been reordered), they are copied.
+   *
+   * @param referenceSet Memory-mapped reference set.
+   * @param searchMode Search mode to use.
+   * @param epsilon Relative approximate error.
+   */
+  void BuildModel(data::MappedMatrix<double>&& referenceSet,
+                  const NeighborSearchMode searchMode,
+                  const double epsilon = 0);
+
+  /**
+   * Save the reference tree, its dataset and the original indices of its points
+   * in the flat tree format (see tree::SaveFlat()), so that the model can be
+   * loaded again with LoadFlat() without rebuilding it.  Only kd-trees, ball
+   * trees, vantage point trees, random projection trees and cover trees can be
+   * saved.  A std::invalid_argument is thrown for other trees, if the search
+   * mode uses no reference tree, or if a random basis is used (it is not
+   * saved).
+   *
+   * @param filename Name of the file to save to.
+   */
+  void SaveFlat(const std::string& filename) const;
+
+  /**
+   * Load the reference tree from a file written by SaveFlat().  The file is
+   * memory-mapped and the tree uses the saved dataset in place; the nodes,
+   * their bounds and their statistics are copied out of the file without any
+   * distance computations (see tree::LoadFlat()).  The model holds the
+   * mapping.  The tree type of the model
+   * must be the tree type that the file was saved with, and the model must not
+   * use a random basis.
+   *
+   * @param filename Name of the file to load from.
+   * @param searchMode Search mode to use; it must use a reference tree.
+   * @param epsilon Relative approximate error.
+   */
+  void LoadFlat(const std::string& filename,
+                const NeighborSearchMode searchMode,
+                const double epsilon = 0);
+
   //! Perform neighbor search.  The query set will be reordered.
   void Search(arma::mat&& querySet,
               const size_t k,
@@ -469,6 +617,23 @@ class NSModel
               arma::Mat<size_t>& neighbors,
               arma::mat& distances);
 
+  /**
+   * Add the given points at the end of the reference set, without rebuilding
+   * the whole reference tree (see NeighborSearch::Insert()).  If a random basis
+   * is used, the points are projected onto it first.
+   *
+   * @param points Points to add to the reference set.
+   */
+  void Insert(const arma::mat& points);
+
+  /**
+   * Remove the points with the given indices from the reference set; the
+   * points after them move down (see NeighborSearch::Remove()).
+   *
+   * @param indices Indices of the points to remove.
+   */
+  void Remove(const std::vector<size_t>& indices);
+
   //! Return a string representation of the current tree type.
   std::string TreeName() const;
 };
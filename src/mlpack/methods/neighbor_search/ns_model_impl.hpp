@@ -76,6 +76,127 @@ void NSWrapper<
   ns.Search(k, neighbors, distances);
 }
 
+//! Save the reference tree in the flat tree format.
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+void NSWrapper<
+    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+>::SaveFlat(const std::string& filename) const
+{
+  if (!UsesReferenceTree(ns.SearchMode()))
+  {
+    throw std::invalid_argument("NSModel::SaveFlat(): there is no reference "
+        "tree in naive or brute-force search mode");
+  }
+
+  SaveFlatTree(filename, ns.ReferenceTree(), ns.OldFromNewReferences());
+}
+
+//! Load the reference tree from a file in the flat tree format.
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+void NSWrapper<
+    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+>::LoadFlat(const std::string& filename,
+            data::MappedFile& mapping)
+{
+  if (!UsesReferenceTree(ns.SearchMode()))
+  {
+    throw std::invalid_argument("NSModel::LoadFlat(): a reference tree cannot "
+        "be used in naive or brute-force search mode");
+  }
+
+  std::vector<size_t> oldFromNewReferences;
+  typename NSType::Tree* referenceTree =
+      LoadFlatTree<typename NSType::Tree>(filename, oldFromNewReferences,
+      mapping);
+  ns.Train(std::move(*referenceTree));
+  delete referenceTree;
+  ns.OldFromNewReferences() = std::move(oldFromNewReferences);
+}
+
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+template<typename Tree>
+void NSWrapper<
+    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+>::SaveFlatTree(
+    const std::string& filename,
+    const Tree& referenceTree,
+    const std::vector<size_t>& oldFromNew,
+    const typename std::enable_if_t<tree::HasFlatFormat<Tree>::value>*)
+{
+  tree::SaveFlat(filename, referenceTree, oldFromNew);
+}
+
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+template<typename Tree>
+void NSWrapper<
+    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+>::SaveFlatTree(
+    const std::string& /* filename */,
+    const Tree& /* referenceTree */,
+    const std::vector<size_t>& /* oldFromNew */,
+    const typename std::enable_if_t<!tree::HasFlatFormat<Tree>::value>*)
+{
+  throw std::invalid_argument("NSModel::SaveFlat(): this type of tree cannot "
+      "be saved in the flat tree format");
+}
+
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+template<typename Tree>
+Tree* NSWrapper<
+    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+>::LoadFlatTree(
+    const std::string& filename,
+    std::vector<size_t>& oldFromNew,
+    data::MappedFile& mapping,
+    const typename std::enable_if_t<tree::HasFlatFormat<Tree>::value>*)
+{
+  return tree::LoadFlat<Tree>(filename, oldFromNew, mapping);
+}
+
+template<typename SortPolicy,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType,
+         template<typename RuleType> class DualTreeTraversalType,
+         template<typename RuleType> class SingleTreeTraversalType>
+template<typename Tree>
+Tree* NSWrapper<
+    SortPolicy, TreeType, DualTreeTraversalType, SingleTreeTraversalType
+>::LoadFlatTree(
+    const std::string& /* filename */,
+    std::vector<size_t>& /* oldFromNew */,
+    data::MappedFile& /* mapping */,
+    const typename std::enable_if_t<!tree::HasFlatFormat<Tree>::value>*)
+{
+  throw std::invalid_argument("NSModel::LoadFlat(): this type of tree cannot "
+      "be loaded from the flat tree format");
+}
+
 //! Train a model with the given parameters.  This overload uses leafSize but
 //! ignores the other parameters.
 template<typename SortPolicy,
@@ -91,7 +212,7 @@ void LeafSizeNSWrapper<
          const double /* tau */,
          const double /* rho */)
 {
-  if (ns.SearchMode() == NAIVE_MODE)
+  if (!UsesReferenceTree(ns.SearchMode()))
   {
     ns.Train(std::move(referenceSet));
   }
@@ -123,7 +244,8 @@ void LeafSizeNSWrapper<
           const size_t leafSize,
           const double /* rho */)
 {
-  if (ns.SearchMode() == DUAL_TREE_MODE)
+  if (ns.SearchMode() == DUAL_TREE_MODE ||
+      ns.SearchMode() == PARALLEL_DUAL_TREE_MODE)
   {
     // We actually have to do the mapping of query points ourselves, since the
     // NeighborSearch class does not provide a way for us to specify the leaf
@@ -159,9 +281,16 @@ void SpillNSWrapper<SortPolicy>::Train(arma::mat&& referenceSet,
                                        const double tau,
                                        const double rho)
 {
-  typename decltype(ns)::Tree tree(std::move(referenceSet), tau, leafSize,
-      rho);
-  ns.Train(std::move(tree));
+  if (!UsesReferenceTree(ns.SearchMode()))
+  {
+    ns.Train(std::move(referenceSet));
+  }
+  else
+  {
+    typename decltype(ns)::Tree tree(std::move(referenceSet), tau, leafSize,
+        rho);
+    ns.Train(std::move(tree));
+  }
 }
 
 //! Perform bichromatic search (i.e. search with a different query set) using
@@ -174,7 +303,8 @@ void SpillNSWrapper<SortPolicy>::Search(arma::mat&& querySet,
                                         const size_t leafSize,
                                         const double rho)
 {
-  if (ns.SearchMode() == DUAL_TREE_MODE)
+  if (ns.SearchMode() == DUAL_TREE_MODE ||
+      ns.SearchMode() == PARALLEL_DUAL_TREE_MODE)
   {
     // For Dual Tree Search on SpillTrees, the queryTree must be built with
     // non overlapping (tau = 0).
@@ -212,7 +342,9 @@ NSModel<SortPolicy>::NSModel(const NSModel& other) :
     leafSize(other.leafSize),
     tau(other.tau),
     rho(other.rho),
-    nSearch(other.nSearch->Clone())
+    nSearch(other.nSearch->Clone()),
+    mappedReference(other.mappedReference),
+    mappedTree(other.mappedTree)
 {
   // Nothing to do.
 }
@@ -225,7 +357,9 @@ NSModel<SortPolicy>::NSModel(NSModel&& other) :
     leafSize(other.leafSize),
     tau(other.tau),
     rho(other.rho),
-    nSearch(other.nSearch)
+    nSearch(other.nSearch),
+    mappedReference(std::move(other.mappedReference)),
+    mappedTree(std::move(other.mappedTree))
 {
   // Reset parameters of the other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -250,6 +384,8 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(const NSModel& other)
     tau = other.tau;
     rho = other.rho;
     nSearch = other.nSearch->Clone();
+    mappedReference = other.mappedReference;
+    mappedTree = other.mappedTree;
   }
 
   return *this;
@@ -269,6 +405,8 @@ NSModel<SortPolicy>& NSModel<SortPolicy>::operator=(NSModel&& other)
     tau = other.tau;
     rho = other.rho;
     nSearch = other.nSearch;
+    mappedReference = std::move(other.mappedReference);
+    mappedTree = std::move(other.mappedTree);
 
     // Reset parameters of the other model.
     other.treeType = TreeTypes::KD_TREE;
@@ -301,9 +439,13 @@ void NSModel<SortPolicy>::serialize(Archive& ar, const uint32_t /* version */)
   ar(CEREAL_NVP(tau));
   ar(CEREAL_NVP(rho));
 
-  // This should never happen, but just in case, be clean with memory.
+  // This should never happen, but just in case, be clean with memory.  A
+  // loaded model holds its own reference set, so it needs no mapping.
   if (cereal::is_loading<Archive>())
+  {
     InitializeModel(DUAL_TREE_MODE, 0.0); // Values will be overwritten.
+    mappedReference.reset();
+  }
 
   // Avoid polymorphic serialization by explicitly serializing the correct type.
   switch (treeType)
@@ -458,9 +600,11 @@ template<typename SortPolicy>
 void NSModel<SortPolicy>::InitializeModel(const NeighborSearchMode searchMode,
                                           const double epsilon)
 {
-  // Clear existing memory.
+  // Clear existing memory.  A tree loaded from a flat tree file is deleted with
+  // the old model, so its mapping is no longer needed.
   if (nSearch)
     delete nSearch;
+  mappedTree.reset();
 
   switch (treeType)
   {
@@ -561,7 +705,7 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   if (randomBasis)
     referenceSet = q * referenceSet;
 
-  if (searchMode != NAIVE_MODE)
+  if (UsesReferenceTree(searchMode))
   {
     Timer::Start("tree_building");
     Log::Info << "Building reference tree..." << std::endl;
@@ -570,13 +714,104 @@ void NSModel<SortPolicy>::BuildModel(arma::mat&& referenceSet,
   InitializeModel(searchMode, epsilon);
   nSearch->Train(std::move(referenceSet), leafSize, tau, rho);
 
-  if (searchMode != NAIVE_MODE)
+  if (UsesReferenceTree(searchMode))
   {
     Timer::Stop("tree_building");
     Log::Info << "Tree built." << std::endl;
   }
 }
 
+//! Build the reference tree on a memory-mapped reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::BuildModel(data::MappedMatrix<double>&& referenceSet,
+                                     const NeighborSearchMode searchMode,
+                                     const double epsilon)
+{
+  const std::vector<size_t> order = referenceSet.OldFromNew();
+
+  // This also removes the old tree, which may have used the old mapping.
+  InitializeModel(searchMode, epsilon);
+  mappedReference.reset();
+
+  const bool rearranges = nSearch->RearrangesDataset();
+  if (randomBasis || (!rearranges && !order.empty()))
+  {
+    // The points are needed in their original order, or will be projected
+    // anyway, so the mapping is of no use.
+    Log::Info << "Copying the memory-mapped reference set..." << std::endl;
+    const arma::mat mapped = referenceSet.Matrix();
+    arma::mat points(mapped.n_rows, mapped.n_cols);
+    for (size_t i = 0; i < mapped.n_cols; ++i)
+      points.col(order.empty() ? i : order[i]) = mapped.col(i);
+
+    BuildModel(std::move(points), searchMode, epsilon);
+    return;
+  }
+
+  if (rearranges && referenceSet.Mode() == data::READ_ONLY)
+  {
+    throw std::invalid_argument("NSModel::BuildModel(): the " + TreeName() +
+        " rearranges the points of the reference set, so it cannot be built on "
+        "a READ_ONLY mapping; use COPY_ON_WRITE or READ_WRITE instead");
+  }
+
+  mappedReference = std::make_shared<data::MappedMatrix<double>>(
+      std::move(referenceSet));
+  BuildModel(mappedReference->Matrix(), searchMode, epsilon);
+
+  if (rearranges)
+  {
+    std::vector<size_t>& oldFromNew = nSearch->OldFromNewReferences();
+    if (mappedReference->Mode() == data::READ_WRITE)
+      mappedReference->SaveOrder(oldFromNew);
+
+    // Point i of the tree was column oldFromNew[i] of the file when it was
+    // mapped, whose original index is order[oldFromNew[i]].
+    if (!order.empty())
+    {
+      for (size_t i = 0; i < oldFromNew.size(); ++i)
+        oldFromNew[i] = order[oldFromNew[i]];
+    }
+  }
+}
+
+//! Save the reference tree in the flat tree format.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::SaveFlat(const std::string& filename) const
+{
+  if (randomBasis)
+  {
+    throw std::invalid_argument("NSModel::SaveFlat(): models that use a random "
+        "basis cannot be saved in the flat tree format");
+  }
+
+  nSearch->SaveFlat(filename);
+}
+
+//! Load the reference tree from a file in the flat tree format.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::LoadFlat(const std::string& filename,
+                                   const NeighborSearchMode searchMode,
+                                   const double epsilon)
+{
+  if (randomBasis)
+  {
+    throw std::invalid_argument("NSModel::LoadFlat(): models that use a random "
+        "basis cannot be loaded from the flat tree format");
+  }
+
+  Log::Info << "Loading " << TreeName() << " from '" << filename << "'..."
+      << std::endl;
+
+  InitializeModel(searchMode, epsilon);
+  mappedReference.reset();
+
+  std::shared_ptr<data::MappedFile> mapping =
+      std::make_shared<data::MappedFile>();
+  nSearch->LoadFlat(filename, *mapping);
+  mappedTree = std::move(mapping);
+}
+
 //! Perform neighbor search.  The query set will be reordered.
 template<typename SortPolicy>
 void NSModel<SortPolicy>::Search(arma::mat&& querySet,
@@ -595,12 +830,19 @@ void NSModel<SortPolicy>::Search(arma::mat&& querySet,
     case NAIVE_MODE:
       Log::Info << "brute-force (naive) search..." << std::endl;
       break;
+    case BRUTE_FORCE_MODE:
+      Log::Info << "blocked brute-force search..." << std::endl;
+      break;
     case SINGLE_TREE_MODE:
       Log::Info << "single-tree " << TreeName() << " search..." << std::endl;
       break;
     case DUAL_TREE_MODE:
       Log::Info << "dual-tree " << TreeName() << " search..." << std::endl;
       break;
+    case PARALLEL_DUAL_TREE_MODE:
+      Log::Info << "parallel dual-tree " << TreeName() << " search..."
+          << std::endl;
+      break;
     case GREEDY_SINGLE_TREE_MODE:
       Log::Info << "greedy single-tree " << TreeName() << " search..."
           << std::endl;
@@ -623,25 +865,49 @@ void NSModel<SortPolicy>::Search(const size_t k,
     case NAIVE_MODE:
       Log::Info << "brute-force (naive) search..." << std::endl;
       break;
+    case BRUTE_FORCE_MODE:
+      Log::Info << "blocked brute-force search..." << std::endl;
+      break;
     case SINGLE_TREE_MODE:
       Log::Info << "single-tree " << TreeName() << " search..." << std::endl;
       break;
     case DUAL_TREE_MODE:
       Log::Info << "dual-tree " << TreeName() << " search..." << std::endl;
       break;
+    case PARALLEL_DUAL_TREE_MODE:
+      Log::Info << "parallel dual-tree " << TreeName() << " search..."
+          << std::endl;
+      break;
     case GREEDY_SINGLE_TREE_MODE:
       Log::Info << "greedy single-tree " << TreeName() << " search..."
           << std::endl;
       break;
   }
 
-  if (Epsilon() != 0 && SearchMode() != NAIVE_MODE)
+  if (Epsilon() != 0 && UsesReferenceTree(SearchMode()))
     Log::Info << "Maximum of " << Epsilon() * 100 << "% relative error."
         << std::endl;
 
   nSearch->Search(k, neighbors, distances);
 }
 
+//! Add points to the reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Insert(const arma::mat& points)
+{
+  if (randomBasis)
+    nSearch->Insert(q * points);
+  else
+    nSearch->Insert(points);
+}
+
+//! Remove points from the reference set.
+template<typename SortPolicy>
+void NSModel<SortPolicy>::Remove(const std::vector<size_t>& indices)
+{
+  nSearch->Remove(indices);
+}
+
 //! Get the name of the tree type.
 template<typename SortPolicy>
 std::string NSModel<SortPolicy>::TreeName() const
@@ -16,6 +16,17 @@
 namespace mlpack {
 namespace tree {
 
+/**
+ * Draw a bootstrap sample of a dataset with the given number of points, as
+ * the indices of the drawn points.  A point drawn several times appears as
+ * many times.
+ */
+inline arma::uvec BootstrapIndices(const size_t numPoints)
+{
+  return arma::randi<arma::uvec>(numPoints,
+      arma::distr_param(0, numPoints - 1));
+}
+
 /**
  * Given a dataset, create another dataset via bootstrap sampling, with labels.
  */
@@ -36,8 +47,7 @@ void Bootstrap(const MatType& dataset,
     bootstrapWeights.set_size(weights.n_elem);
 
   // Random sampling with replacement.
-  arma::uvec indices = arma::randi<arma::uvec>(dataset.n_cols,
-      arma::distr_param(0, dataset.n_cols - 1));
+  arma::uvec indices = BootstrapIndices(dataset.n_cols);
   bootstrapDataset = dataset.cols(indices);
   bootstrapLabels = labels.cols(indices);
   if (UseWeights)
@@ -0,0 +1,236 @@
+/**
+ * @file methods/random_forest/flat_forest.hpp
+ *
+ * Definition of FlatForest, a read-only copy of a DecisionTree or RandomForest
+ * laid out for fast prediction.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_HPP
+
+#include <mlpack/prereqs.hpp>
+#include "random_forest.hpp"
+
+namespace mlpack {
+namespace tree {
+
+/**
+ * A FlatForest is a copy of a trained DecisionTree or RandomForest that can
+ * only make predictions, but makes them faster.  The nodes of all the trees
+ * are held in one contiguous array, with the children of each node next to
+ * each other, and each node only holds what is needed to choose a child: the
+ * split dimension, the split point, and the index of the first child.  Leaves
+ * point to themselves and never move a point, whatever its value (even NaN),
+ * so a point can be moved down a tree a fixed number of times (the depth of
+ * the tree) without testing whether it has reached a leaf.
+ *
+ * Batches of points are classified a block of points at a time: each block is
+ * moved down each tree one level at a time for all of its points, so the
+ * memory accesses of different points overlap instead of waiting on each
+ * other.  Blocks are classified in parallel.
+ *
+ * The predictions and probabilities are the same as those of the tree or
+ * forest the FlatForest was built from.  The numeric split type of the trees
+ * must split on a threshold (see NumericSplitTraits::UsesThreshold), and the
+ * categorical split type, if any categorical split was made, must be
+ * AllCategoricalSplit.
+ *
+ * @code
+ * RandomForest<> rf(data, labels, numClasses, 100);
+ * FlatForest flat(rf);
+ *
+ * arma::Row<size_t> predictions;
+ * flat.Classify(testData, predictions);
+ * @endcode
+ */
+class FlatForest
+{
+ public:
+  //! Create an empty FlatForest.
+  FlatForest() : numClasses(0) { }
+
+  /**
+   * Flatten the given decision tree.
+   *
+   * @param tree Trained decision tree.
+   */
+  template<typename FitnessFunction,
+           template<typename> class NumericSplitType,
+           template<typename> class CategoricalSplitType,
+           typename DimensionSelectionType,
+           bool NoRecursion>
+  explicit FlatForest(const DecisionTree<FitnessFunction,
+                                         NumericSplitType,
+                                         CategoricalSplitType,
+                                         DimensionSelectionType,
+                                         NoRecursion>& tree);
+
+  /**
+   * Flatten the given random forest.
+   *
+   * @param forest Trained random forest.
+   */
+  template<typename FitnessFunction,
+           typename DimensionSelectionType,
+           template<typename> class NumericSplitType,
+           template<typename> class CategoricalSplitType,
+           bool UseBootstrap>
+  explicit FlatForest(const RandomForest<FitnessFunction,
+                                         DimensionSelectionType,
+                                         NumericSplitType,
+                                         CategoricalSplitType,
+                                         UseBootstrap>& forest);
+
+  /**
+   * Predict the class of the given point.
+   *
+   * @param point Point to classify.
+   */
+  template<typename VecType>
+  size_t Classify(const VecType& point) const;
+
+  /**
+   * Predict the class of the given point and the probabilities of each class.
+   *
+   * @param point Point to classify.
+   * @param prediction Variable to store the predicted class in.
+   * @param probabilities Vector to store the class probabilities in.
+   */
+  template<typename VecType>
+  void Classify(const VecType& point,
+                size_t& prediction,
+                arma::vec& probabilities) const;
+
+  /**
+   * Predict the class of each point in the given dataset.
+   *
+   * @param data Dataset to classify.
+   * @param predictions Row to store the predicted classes in.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions) const;
+
+  /**
+   * Predict the class of each point in the given dataset and the
+   * probabilities of each class.
+   *
+   * @param data Dataset to classify.
+   * @param predictions Row to store the predicted classes in.
+   * @param probabilities Matrix to store the class probabilities of each point
+   *     (column) in.
+   */
+  template<typename MatType>
+  void Classify(const MatType& data,
+                arma::Row<size_t>& predictions,
+                arma::mat& probabilities) const;
+
+  //! Get the number of trees.
+  size_t NumTrees() const { return roots.size(); }
+  //! Get the number of classes.
+  size_t NumClasses() const { return numClasses; }
+  //! Get the number of nodes of all the trees.
+  size_t NumNodes() const { return nodes.size(); }
+
+  /**
+   * Serialize the flattened forest.
+   */
+  template<typename Archive>
+  void serialize(Archive& ar, const uint32_t /* version */)
+  {
+    ar(CEREAL_NVP(numClasses));
+    ar(CEREAL_NVP(nodes));
+    ar(CEREAL_NVP(roots));
+    ar(CEREAL_NVP(depths));
+    ar(CEREAL_NVP(leaves));
+    ar(CEREAL_NVP(leafProbabilities));
+  }
+
+ private:
+  //! A node of a tree.
+  struct Node
+  {
+    //! The split point of a numeric split: points whose value is not greater
+    //! go to the first child, and the others (including NaN) to the second
+    //! child, as with the split types of DecisionTree.  Infinite for leaves.
+    double threshold;
+    //! The dimension the node splits on (0 for leaves).
+    size_t dimension;
+    //! The index of the first child; leaves hold their own index.
+    size_t child;
+    //! If true, the split is categorical and the value of the point is the
+    //! index of its child, counted from the first child.
+    bool categorical;
+    //! 1 for nodes with children, and 0 for leaves, so that a leaf keeps every
+    //! point.
+    size_t internal;
+
+    //! Serialize the node.
+    template<typename Archive>
+    void serialize(Archive& ar, const uint32_t /* version */)
+    {
+      ar(CEREAL_NVP(threshold));
+      ar(CEREAL_NVP(dimension));
+      ar(CEREAL_NVP(child));
+      ar(CEREAL_NVP(categorical));
+      ar(CEREAL_NVP(internal));
+    }
+  };
+
+  //! The number of points of each block for batch classification.
+  static const size_t BlockSize = 64;
+
+  //! The number of classes.
+  size_t numClasses;
+  //! The nodes of all the trees.
+  std::vector<Node> nodes;
+  //! The index of the root of each tree.
+  std::vector<size_t> roots;
+  //! The depth of each tree (the number of moves from the root to the deepest
+  //! leaf).
+  std::vector<size_t> depths;
+  //! For each leaf, the column of leafProbabilities that holds its class
+  //! probabilities (unused for other nodes).
+  std::vector<size_t> leaves;
+  //! The class probabilities of each leaf.
+  arma::mat leafProbabilities;
+
+  /**
+   * Add the given tree.
+   */
+  template<typename TreeType>
+  void AddTree(const TreeType& tree, const bool allCategoricalSplit);
+
+  /**
+   * Fill the given node (already allocated) from the given tree node, and
+   * allocate and fill its children.
+   */
+  template<typename TreeType>
+  void Flatten(const TreeType& tree,
+               const size_t node,
+               const size_t depth,
+               const bool allCategoricalSplit,
+               std::vector<arma::vec>& probabilities,
+               size_t& maxDepth);
+
+  //! Get the node that the given node sends the given value to.
+  template<typename ElemType>
+  static size_t Next(const Node& node, const ElemType value)
+  {
+    const size_t step = node.categorical ? (size_t) value :
+        (size_t) !(value <= node.threshold);
+    return node.child + node.internal * step;
+  }
+};
+
+} // namespace tree
+} // namespace mlpack
+
+// Include implementation.
+#include "flat_forest_impl.hpp"
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * @file methods/random_forest/flat_forest_impl.hpp
+ *
+ * Implementation of FlatForest.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#ifndef MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_IMPL_HPP
+#define MLPACK_METHODS_RANDOM_FOREST_FLAT_FOREST_IMPL_HPP
+
+// In case it hasn't been included yet.
+#include "flat_forest.hpp"
+
+namespace mlpack {
+namespace tree {
+
+template<typename FitnessFunction,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         typename DimensionSelectionType,
+         bool NoRecursion>
+FlatForest::FlatForest(const DecisionTree<FitnessFunction,
+                                          NumericSplitType,
+                                          CategoricalSplitType,
+                                          DimensionSelectionType,
+                                          NoRecursion>& tree) :
+    numClasses(tree.NumClasses())
+{
+  static_assert(NumericSplitTraits<NumericSplitType<FitnessFunction>>::
+      UsesThreshold, "FlatForest: the numeric split type must split on a "
+      "threshold (see NumericSplitTraits::UsesThreshold).");
+
+  if (numClasses == 0)
+  {
+    throw std::invalid_argument("FlatForest::FlatForest(): the decision tree "
+        "is not trained!");
+  }
+
+  AddTree(tree, std::is_same<CategoricalSplitType<FitnessFunction>,
+      AllCategoricalSplit<FitnessFunction>>::value);
+}
+
+template<typename FitnessFunction,
+         typename DimensionSelectionType,
+         template<typename> class NumericSplitType,
+         template<typename> class CategoricalSplitType,
+         bool UseBootstrap>
+FlatForest::FlatForest(const RandomForest<FitnessFunction,
+                                          DimensionSelectionType,
+                                          NumericSplitType,
+                                          CategoricalSplitType,
+                                          UseBootstrap>& forest) :
+    numClasses(0)
+{
+  static_assert(NumericSplitTraits<NumericSplitType<FitnessFunction>>::
+      UsesThreshold, "FlatForest: the numeric split type must split on a "
+      "threshold (see NumericSplitTraits::UsesThreshold).");
+
+  if (forest.NumTrees() == 0)
+  {
+    throw std::invalid_argument("FlatForest::FlatForest(): the random forest "
+        "is not trained!");
+  }
+
+  numClasses = forest.Tree(0).NumClasses();
+  for (size_t i = 0; i < forest.NumTrees(); ++i)
+  {
+    AddTree(forest.Tree(i), std::is_same<CategoricalSplitType<FitnessFunction>,
+        AllCategoricalSplit<FitnessFunction>>::value);
+  }
+}
+
+template<typename VecType>
+size_t FlatForest::Classify(const VecType& point) const
+{
+  size_t prediction;
+  arma::vec probabilities;
+  Classify(point, prediction, probabilities);
+  return prediction;
+}
+
+template<typename VecType>
+void FlatForest::Classify(const VecType& point,
+                          size_t& prediction,
+                          arma::vec& probabilities) const
+{
+  if (roots.size() == 0)
+  {
+    probabilities.clear();
+    prediction = 0;
+
+    throw std::invalid_argument("FlatForest::Classify(): no trees!");
+  }
+
+  probabilities.zeros(numClasses);
+  for (size_t t = 0; t < roots.size(); ++t)
+  {
+    size_t node = roots[t];
+    for (size_t level = 0; level < depths[t]; ++level)
+      node = Next(nodes[node], point[nodes[node].dimension]);
+
+    probabilities += leafProbabilities.col(leaves[node]);
+  }
+
+  probabilities /= roots.size();
+  prediction = probabilities.index_max();
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions) const
+{
+  arma::mat probabilities;
+  Classify(data, predictions, probabilities);
+}
+
+template<typename MatType>
+void FlatForest::Classify(const MatType& data,
+                          arma::Row<size_t>& predictions,
+                          arma::mat& probabilities) const
+{
+  if (roots.size() == 0)
+  {
+    predictions.clear();
+    probabilities.clear();
+
+    throw std::invalid_argument("FlatForest::Classify(): no trees!");
+  }
+
+  probabilities.zeros(numClasses, data.n_cols);
+  predictions.set_size(data.n_cols);
+
+  const size_t numBlocks = (data.n_cols + BlockSize - 1) / BlockSize;
+  #pragma omp parallel for
+  for (omp_size_t b = 0; b < (omp_size_t) numBlocks; ++b)
+  {
+    const size_t begin = b * BlockSize;
+    const size_t count = std::min((size_t) BlockSize, data.n_cols - begin);
+
+    size_t current[BlockSize];
+    for (size_t t = 0; t < roots.size(); ++t)
+    {
+      // Move every point of the block down one level at a time; the points
+      // are independent, so their loads can be in flight together.
+      for (size_t i = 0; i < count; ++i)
+        current[i] = roots[t];
+      for (size_t level = 0; level < depths[t]; ++level)
+      {
+        for (size_t i = 0; i < count; ++i)
+        {
+          const Node& node = nodes[current[i]];
+          current[i] = Next(node, data(node.dimension, begin + i));
+        }
+      }
+
+      for (size_t i = 0; i < count; ++i)
+      {
+        probabilities.col(begin + i) +=
+            leafProbabilities.col(leaves[current[i]]);
+      }
+    }
+
+    for (size_t i = begin; i < begin + count; ++i)
+    {
+      probabilities.col(i) /= roots.size();
+      predictions[i] = probabilities.col(i).index_max();
+    }
+  }
+}
+
+template<typename TreeType>
+void FlatForest::AddTree(const TreeType& tree, const bool allCategoricalSplit)
+{
+  if (tree.NumClasses() != numClasses)
+  {
+    throw std::invalid_argument("FlatForest: all trees must have the same "
+        "number of classes!");
+  }
+
+  const size_t root = nodes.size();
+  nodes.resize(root + 1);
+  leaves.resize(root + 1);
+
+  std::vector<arma::vec> probabilities;
+  size_t maxDepth = 0;
+  Flatten(tree, root, 0, allCategoricalSplit, probabilities, maxDepth);
+
+  const size_t firstLeaf = leafProbabilities.n_cols;
+  leafProbabilities.resize(numClasses, firstLeaf + probabilities.size());
+  for (size_t i = 0; i < probabilities.size(); ++i)
+    leafProbabilities.col(firstLeaf + i) = probabilities[i];
+  for (size_t i = root; i < nodes.size(); ++i)
+    leaves[i] += firstLeaf;
+
+  roots.push_back(root);
+  depths.push_back(maxDepth);
+}
+
+template<typename TreeType>
+void FlatForest::Flatten(const TreeType& tree,
+                         const size_t node,
+                         const size_t depth,
+                         const bool allCategoricalSplit,
+                         std::vector<arma::vec>& probabilities,
+                         size_t& maxDepth)
+{
+  if (tree.NumChildren() == 0)
+  {
+    // A leaf sends every point to itself.
+    nodes[node].threshold = std::numeric_limits<double>::infinity();
+    nodes[node].dimension = 0;
+    nodes[node].child = node;
+    nodes[node].categorical = false;
+    nodes[node].internal = 0;
+    leaves[node] = probabilities.size();
+    probabilities.push_back(tree.ClassProbabilities());
+    maxDepth = std::max(maxDepth, depth);
+    return;
+  }
+
+  const bool categorical =
+      (tree.SplitDimensionType() == data::Datatype::categorical);
+  if (categorical && !allCategoricalSplit)
+  {
+    throw std::invalid_argument("FlatForest: categorical splits must be made "
+        "with AllCategoricalSplit!");
+  }
+
+  // The children are next to each other.
+  const size_t child = nodes.size();
+  nodes.resize(child + tree.NumChildren());
+  leaves.resize(child + tree.NumChildren(), 0);
+
+  nodes[node].threshold = categorical ? 0.0 : tree.ClassProbabilities()[0];
+  nodes[node].dimension = tree.SplitDimension();
+  nodes[node].child = child;
+  nodes[node].categorical = categorical;
+  nodes[node].internal = 1;
+  leaves[node] = 0;
+
+  for (size_t i = 0; i < tree.NumChildren(); ++i)
+  {
+    Flatten(tree.Child(i), child + i, depth + 1, allCategoricalSplit,
+        probabilities, maxDepth);
+  }
+}
+
+} // namespace tree
+} // namespace mlpack
+
+#endif
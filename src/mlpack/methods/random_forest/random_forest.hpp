@@ -403,6 +403,42 @@ class RandomForest
                DimensionSelectionType& dimensionSelector,
                const bool warmStart = false);
 
+  /**
+   * Train the given number of trees of the forest, starting with the given
+   * tree, on the given dataset.  If the numeric split type works on bins, the
+   * dataset holds the bin indices of the points (see DecisionTree::BinData()).
+   *
+   * @param data Dataset to train on.
+   * @param datasetInfo Dimension information for the dataset.
+   * @param labels Labels for the dataset.
+   * @param numClasses Number of classes in the dataset.
+   * @param weights Weights for each point in the dataset (may be ignored).
+   * @param firstTree Index of the first tree to train.
+   * @param numTrees Number of trees to train.
+   * @param minimumLeafSize Minimum number of points in each leaf node.
+   * @param minimumGainSplit Minimum gain for splitting a decision tree node.
+   * @param maximumDepth Maximum depth for the tree.
+   * @param dimensionSelector Instantiated dimension selection policy.
+   * @param splitPoints Split points between the bins of each dimension, if the
+   *     numeric split type works on bins.
+   * @tparam UseWeights Whether or not to use the weights parameter.
+   * @tparam MatType The type of data matrix.
+   * @return The total entropy of the trees trained.
+   */
+  template<bool UseWeights, typename MatType>
+  double TrainTrees(const MatType& data,
+                    const data::DatasetInfo& datasetInfo,
+                    const arma::Row<size_t>& labels,
+                    const size_t numClasses,
+                    const arma::rowvec& weights,
+                    const size_t firstTree,
+                    const size_t numTrees,
+                    const size_t minimumLeafSize,
+                    const double minimumGainSplit,
+                    const size_t maximumDepth,
+                    DimensionSelectionType& dimensionSelector,
+                    const std::vector<arma::vec>& splitPoints);
+
   //! The trees in the forest.
   std::vector<DecisionTreeType> trees;
 
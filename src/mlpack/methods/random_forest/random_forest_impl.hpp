@@ -504,74 +504,100 @@ double RandomForest<
   // Convert avgGain to total gain.
   double totalGain = avgGain * oldNumTrees;
 
-  // Train each tree individually.
+  // Without a DatasetInfo, all dimensions are numeric.
+  const data::DatasetInfo numericInfo(UseDatasetInfo ? 0 : dataset.n_rows);
+  const data::DatasetInfo& info = UseDatasetInfo ? datasetInfo : numericInfo;
+
+  // If the numeric split works on bins, bin the dataset once for all trees.
+  typedef NumericSplitType<FitnessFunction> NumericSplit;
+  typedef typename std::conditional<NumericSplitTraits<NumericSplit>::UsesBins,
+      arma::Mat<unsigned char>, MatType>::type BinnedMatType;
+  if (NumericSplitTraits<NumericSplit>::UsesBins)
+  {
+    BinnedMatType binnedDataset;
+    std::vector<arma::vec> splitPoints;
+    DecisionTreeType::BinData(dataset, info, binnedDataset, splitPoints);
+    totalGain += TrainTrees<UseWeights>(binnedDataset, info, labels,
+        numClasses, weights, oldNumTrees, numTrees, minimumLeafSize,
+        minimumGainSplit, maximumDepth, dimensionSelector, splitPoints);
+  }
+  else
+  {
+    totalGain += TrainTrees<UseWeights>(dataset, info, labels, numClasses,
+        weights, oldNumTrees, numTrees, minimumLeafSize, minimumGainSplit,
+        maximumDepth, dimensionSelector, std::vector<arma::vec>());
+  }
+
+  avgGain = totalGain / trees.size();
+  return avgGain;
+}
+
+template<
+    typename FitnessFunction,
+    typename DimensionSelectionType,
+    template<typename> class NumericSplitType,
+    template<typename> class CategoricalSplitType,
+    bool UseBootstrap
+>
+template<bool UseWeights, typename MatType>
+double RandomForest<
+    FitnessFunction,
+    DimensionSelectionType,
+    NumericSplitType,
+    CategoricalSplitType,
+    UseBootstrap
+>::TrainTrees(const MatType& data,
+              const data::DatasetInfo& datasetInfo,
+              const arma::Row<size_t>& labels,
+              const size_t numClasses,
+              const arma::rowvec& weights,
+              const size_t firstTree,
+              const size_t numTrees,
+              const size_t minimumLeafSize,
+              const double minimumGainSplit,
+              const size_t maximumDepth,
+              DimensionSelectionType& dimensionSelector,
+              const std::vector<arma::vec>& splitPoints)
+{
+  // Without bootstrapping, each tree is trained on all points.
+  arma::uvec allIndices;
+  if (!UseBootstrap)
+    allIndices = arma::regspace<arma::uvec>(0, data.n_cols - 1);
+
+  // Train each tree individually.  The trees are trained on indices into the
+  // dataset, so it is never copied.
+  double totalGain = 0.0;
   #pragma omp parallel for reduction( + : totalGain)
   for (omp_size_t i = 0; i < numTrees; ++i)
   {
-    MatType bootstrapDataset;
-    arma::Row<size_t> bootstrapLabels;
-    arma::rowvec bootstrapWeights;
+    arma::uvec bootstrapIndices;
     if (UseBootstrap)
     {
       Timer::Start("bootstrap");
-      Bootstrap<UseWeights>(dataset, labels, weights, bootstrapDataset,
-          bootstrapLabels, bootstrapWeights);
+      bootstrapIndices = BootstrapIndices(data.n_cols);
       Timer::Stop("bootstrap");
     }
+    const arma::uvec& indices = UseBootstrap ? bootstrapIndices : allIndices;
 
     Timer::Start("train_tree");
+    DecisionTreeType& tree = trees[firstTree + i];
     if (UseWeights)
     {
-      if (UseDatasetInfo)
-      {
-        totalGain += UseBootstrap ?
-            trees[oldNumTrees + i].Train(bootstrapDataset, datasetInfo,
-                bootstrapLabels, numClasses, bootstrapWeights, minimumLeafSize,
-                minimumGainSplit, maximumDepth, dimensionSelector) :
-            trees[oldNumTrees + i].Train(dataset, datasetInfo, labels,
-                numClasses, weights, minimumLeafSize, minimumGainSplit,
-                maximumDepth, dimensionSelector);
-      }
-      else
-      {
-        totalGain += UseBootstrap ?
-            trees[oldNumTrees + i].Train(bootstrapDataset, bootstrapLabels,
-                numClasses, bootstrapWeights, minimumLeafSize,
-                minimumGainSplit, maximumDepth, dimensionSelector) :
-            trees[oldNumTrees + i].Train(dataset, labels, numClasses,
-                weights, minimumLeafSize, minimumGainSplit, maximumDepth,
-                dimensionSelector);
-      }
+      totalGain += tree.Train(data, indices, datasetInfo, labels, numClasses,
+          weights, minimumLeafSize, minimumGainSplit, maximumDepth,
+          dimensionSelector);
     }
     else
     {
-      if (UseDatasetInfo)
-      {
-        totalGain += UseBootstrap ?
-            trees[oldNumTrees + i].Train(bootstrapDataset, datasetInfo,
-                bootstrapLabels, numClasses, minimumLeafSize, minimumGainSplit,
-                maximumDepth, dimensionSelector) :
-            trees[oldNumTrees + i].Train(dataset, datasetInfo, labels,
-                numClasses, minimumLeafSize, minimumGainSplit, maximumDepth,
-                dimensionSelector);
-      }
-      else
-      {
-        totalGain += UseBootstrap ?
-            trees[oldNumTrees + i].Train(bootstrapDataset, bootstrapLabels,
-                numClasses, minimumLeafSize, minimumGainSplit, maximumDepth,
-                dimensionSelector) :
-            trees[oldNumTrees + i].Train(dataset, labels, numClasses,
-                minimumLeafSize, minimumGainSplit, maximumDepth,
-                dimensionSelector);
-      }
+      totalGain += tree.Train(data, indices, datasetInfo, labels, numClasses,
+          minimumLeafSize, minimumGainSplit, maximumDepth, dimensionSelector);
     }
+    tree.UnbinSplits(splitPoints);
 
     Timer::Stop("train_tree");
   }
 
-  avgGain = totalGain / trees.size();
-  return avgGain;
+  return totalGain;
 }
 
 } // namespace tree
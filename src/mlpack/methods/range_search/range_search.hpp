@@ -14,8 +14,10 @@
 #define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_HPP
 
 #include <mlpack/prereqs.hpp>
+#include <mlpack/core/cereal/template_class_version.hpp>
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/tree/binary_space_tree.hpp>
+#include <mlpack/core/tree/reference_levels.hpp>
 #include "range_search_stat.hpp"
 
 namespace mlpack {
@@ -27,6 +29,12 @@ template<template<typename TreeMetricType,
                   typename TreeMatType> class TreeType>
 class LeafSizeRSWrapper;
 
+//! Forward declaration.
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+class RSWrapper;
+
 /**
  * The RangeSearch class is a template class for performing range searches.  It
  * is implemented in the style of a generalized tree-independent dual-tree
@@ -162,6 +170,43 @@ class RangeSearch
    */
   void Train(Tree* referenceTree);
 
+  /**
+   * Add the given points at the end of the reference set; the first of them
+   * gets the index n, where n is the number of points in the reference set.
+   *
+   * In naive mode, the points are simply appended to the reference set.
+   * Otherwise the reference tree is not rebuilt: a small tree is built on the
+   * new points, and these trees are merged with each other as they grow (see
+   * tree::ReferenceLevels), so that each point takes part in O(log n) tree
+   * builds.  Searches then search every tree and concatenate the results.  The
+   * reference tree is rebuilt on all points once the other trees hold as many
+   * points as it does.
+   *
+   * @param points Points to add to the reference set.
+   */
+  void Insert(const MatType& points);
+
+  /**
+   * Remove the points with the given indices from the reference set.  The
+   * points after them move down, so that the reference set is the same as if
+   * the points had been removed with arma::Mat::shed_cols(), and the indices
+   * returned by later searches refer to the new reference set.
+   *
+   * With a reference tree, the points are not removed from the trees but left
+   * out of the search results, until the tree holding them is rebuilt.  A
+   * std::invalid_argument is thrown if an index is not in the reference set.
+   *
+   * @param indices Indices of the points to remove.
+   */
+  void Remove(const std::vector<size_t>& indices);
+
+  //! Get the number of points in the reference set (including the points
+  //! inserted since the reference tree was built).
+  size_t NumReferencePoints() const
+  {
+    return levels.Active() ? levels.NumPoints() : referenceSet->n_cols;
+  }
+
   /**
    * Search for all reference points in the given range for each point in the
    * query set, returning the results in the neighbors and distances objects.
@@ -287,7 +332,9 @@ class RangeSearch
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t version);
 
-  //! Return the reference set.
+  //! Return the reference set.  After Insert() or Remove(), this is the
+  //! dataset of the reference tree only, which may not hold all of the points
+  //! (see NumReferencePoints()).
   const MatType& ReferenceSet() const { return *referenceSet; }
 
   //! Return the reference tree (or NULL if in naive mode).
@@ -318,13 +365,72 @@ class RangeSearch
   //! The total number of scores during the last search.
   size_t scores;
 
+  //! The points inserted into and removed from the reference set since the
+  //! reference tree was built.
+  tree::ReferenceLevels<RangeSearch, MatType> levels;
+
+  /**
+   * Search the reference tree (or reference set) only, ignoring any inserted
+   * or removed points.  This is the search done by Search() when the reference
+   * set has not changed.
+   */
+  void SearchReference(const MatType& querySet,
+                       const math::Range& range,
+                       std::vector<std::vector<size_t>>& neighbors,
+                       std::vector<std::vector<double>>& distances);
+
+  /**
+   * Search the reference tree and all of the levels of inserted points,
+   * concatenating the results and leaving out removed points.  If sameSet is
+   * true, query point i is the reference point with index i, and it is not
+   * returned as its own neighbor.
+   */
+  void SearchLevels(const MatType& querySet,
+                    const math::Range& range,
+                    std::vector<std::vector<size_t>>& neighbors,
+                    std::vector<std::vector<double>>& distances,
+                    const bool sameSet);
+
+  //! Rebuild the reference tree on all points of the reference set, so that no
+  //! levels or removed points are left.
+  void RebuildReference();
+
+  /**
+   * Run the single-tree traversal for each point in the query set.  The query
+   * points are split between OpenMP threads, each of which uses its own rules
+   * object; the base case and score counts of every thread are added to
+   * baseCases and scores.
+   */
+  void SingleTreeTraverse(const MatType& querySet,
+                          const math::Range& range,
+                          std::vector<std::vector<size_t>>& neighbors,
+                          std::vector<std::vector<double>>& distances,
+                          const bool sameSet);
+
   //! For access to mappings when building models.
   friend class LeafSizeRSWrapper<TreeType>;
+
+  //! For access to the tree and mappings when saving and loading models in the
+  //! flat tree format.
+  friend class RSWrapper<TreeType>;
+
+  //! ReferenceLevels needs access to the reference set and its mapping.
+  friend class tree::ReferenceLevels<RangeSearch, MatType>;
 };
 
 } // namespace range
 } // namespace mlpack
 
+//! Version 1 added the inserted and removed points.
+CEREAL_TEMPLATE_CLASS_VERSION(
+    SINGLE_ARG(template<typename MetricType,
+                        typename MatType,
+                        template<typename TreeMetricType,
+                                 typename TreeStatType,
+                                 typename TreeMatType> class TreeType>),
+    SINGLE_ARG(mlpack::range::RangeSearch<MetricType, MatType, TreeType>),
+    1)
+
 // Include implementation.
 #include "range_search_impl.hpp"
 
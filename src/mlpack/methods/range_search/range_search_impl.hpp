@@ -61,7 +61,8 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     singleMode(!naive && singleMode),
     metric(metric),
     baseCases(0),
-    scores(0)
+    scores(0),
+    levels(this->referenceSet->n_cols)
 {
   // Nothing to do.
 }
@@ -82,7 +83,8 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     singleMode(singleMode),
     metric(metric),
     baseCases(0),
-    scores(0)
+    scores(0),
+    levels(referenceTree->Dataset().n_cols)
 {
   // Nothing else to initialize.
 }
@@ -131,7 +133,8 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(
     singleMode(other.singleMode),
     metric(other.metric),
     baseCases(other.baseCases),
-    scores(other.scores)
+    scores(other.scores),
+    levels(other.levels)
 {
   // Nothing to do.
 }
@@ -150,7 +153,8 @@ RangeSearch<MetricType, MatType, TreeType>::RangeSearch(RangeSearch&& other) :
     singleMode(other.singleMode),
     metric(std::move(other.metric)),
     baseCases(other.baseCases),
-    scores(other.scores)
+    scores(other.scores),
+    levels(std::move(other.levels))
 {
   // Clear other object.
   other.referenceTree =
@@ -183,6 +187,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(const RangeSearch& other)
     metric = other.metric;
     baseCases = other.baseCases;
     scores = other.scores;
+    levels = other.levels;
   }
   return *this;
 }
@@ -213,6 +218,7 @@ RangeSearch<MetricType, MatType, TreeType>::operator=(RangeSearch&& other)
     metric = std::move(other.metric);
     baseCases = other.baseCases;
     scores = other.scores;
+    levels = std::move(other.levels);
 
     // Clear other object.
     other.referenceTree = nullptr;
@@ -276,6 +282,8 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
   {
     this->referenceSet = new MatType(std::move(referenceSet));
   }
+
+  levels.Reset(this->referenceSet->n_cols);
 }
 
 template<typename MetricType,
@@ -298,7 +306,94 @@ void RangeSearch<MetricType, MatType, TreeType>::Train(
     this->referenceTree = referenceTree;
     this->referenceSet = &referenceTree->Dataset();
     treeOwner = false;
+    levels.Reset(this->referenceSet->n_cols);
+  }
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Insert(const MatType& points)
+{
+  if (!referenceTree)
+  {
+    // Without a tree, we can just add the points to the reference set.
+    if (referenceSet->n_cols > 0 && points.n_rows != referenceSet->n_rows)
+    {
+      std::ostringstream oss;
+      oss << "RangeSearch::Insert(): dimensionality of points ("
+          << points.n_rows << ") does not match dimensionality of reference "
+          << "set (" << referenceSet->n_rows << ")!";
+      throw std::invalid_argument(oss.str());
+    }
+
+    MatType* newReferenceSet = new MatType(arma::join_rows(*referenceSet,
+        points));
+    delete referenceSet;
+    referenceSet = newReferenceSet;
+    levels.Reset(referenceSet->n_cols);
+    return;
+  }
+
+  levels.Insert(*this, MatType(points), [this](MatType&& levelSet)
+      {
+        return new RangeSearch(std::move(levelSet), false, singleMode,
+            metric);
+      });
+
+  if (levels.MainNeedsRebuild())
+    RebuildReference();
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::Remove(
+    const std::vector<size_t>& indices)
+{
+  if (!referenceTree)
+  {
+    // Without a tree, we can just take the points out of the reference set.
+    std::vector<bool> removed(referenceSet->n_cols, false);
+    for (size_t i = 0; i < indices.size(); ++i)
+    {
+      if (indices[i] >= referenceSet->n_cols)
+      {
+        std::ostringstream oss;
+        oss << "RangeSearch::Remove(): cannot remove point " << indices[i]
+            << "; the reference set has only " << referenceSet->n_cols
+            << " points!";
+        throw std::invalid_argument(oss.str());
+      }
+      removed[indices[i]] = true;
+    }
+
+    const size_t numRemoved = std::count(removed.begin(), removed.end(), true);
+    MatType* newReferenceSet = new MatType(referenceSet->n_rows,
+        referenceSet->n_cols - numRemoved);
+    size_t column = 0;
+    for (size_t i = 0; i < referenceSet->n_cols; ++i)
+      if (!removed[i])
+        newReferenceSet->col(column++) = referenceSet->col(i);
+
+    delete referenceSet;
+    referenceSet = newReferenceSet;
+    levels.Reset(referenceSet->n_cols);
+    return;
   }
+
+  levels.Remove(*this, indices, [this](MatType&& levelSet)
+      {
+        return new RangeSearch(std::move(levelSet), false, singleMode,
+            metric);
+      });
+
+  if (levels.MainNeedsRebuild())
+    RebuildReference();
 }
 
 template<typename MetricType,
@@ -311,6 +406,23 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     const math::Range& range,
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
+{
+  if (levels.Active())
+    SearchLevels(querySet, range, neighbors, distances, false);
+  else
+    SearchReference(querySet, range, neighbors, distances);
+}
+
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::SearchReference(
+    const MatType& querySet,
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances)
 {
   util::CheckSameDimensionality(querySet, *referenceSet,
       "RangeSearch::Search()", "query set");
@@ -363,29 +475,24 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
 
   if (naive)
   {
-    RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
-        metric);
+    // The naive brute-force solution.  The results for each query point are
+    // only touched by one thread, so each thread can use its own rules.
+    #pragma omp parallel
+    {
+      RuleType rules(*referenceSet, querySet, range, *neighborPtr,
+          *distancePtr, metric);
 
-    // The naive brute-force solution.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+      #pragma omp for
+      for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+        for (size_t j = 0; j < referenceSet->n_cols; ++j)
+          rules.BaseCase(i, j);
+    }
 
     baseCases += (querySet.n_cols * referenceSet->n_cols);
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    RuleType rules(*referenceSet, querySet, range, *neighborPtr, *distancePtr,
-        metric);
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < querySet.n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    baseCases += rules.BaseCases();
-    scores += rules.Scores();
+    SingleTreeTraverse(querySet, range, *neighborPtr, *distancePtr, false);
   }
   else // Dual-tree recursion.
   {
@@ -402,6 +509,9 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
     traverser.Traverse(*queryTree, *referenceTree);
+    Profiler::Count("base_cases", rules.BaseCases());
+    Profiler::Count("scores", rules.Scores());
+    Profiler::Count("prunes", traverser.NumPrunes());
 
     baseCases += rules.BaseCases();
     scores += rules.Scores();
@@ -490,6 +600,19 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
 {
+  // Make sure we are in dual-tree mode.
+  if (singleMode || naive)
+    throw std::invalid_argument("cannot call RangeSearch::Search() with a "
+        "query tree when naive or singleMode are set to true");
+
+  // If points were inserted or removed, the query tree can't be traversed
+  // with the reference tree alone, so search the levels with its points.
+  if (levels.Active())
+  {
+    SearchLevels(queryTree->Dataset(), range, neighbors, distances, false);
+    return;
+  }
+
   // If there are no points, there is no search to be done.
   if (referenceSet->n_cols == 0)
     return;
@@ -499,11 +622,6 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   // Get a reference to the query set.
   const MatType& querySet = queryTree->Dataset();
 
-  // Make sure we are in dual-tree mode.
-  if (singleMode || naive)
-    throw std::invalid_argument("cannot call RangeSearch::Search() with a "
-        "query tree when naive or singleMode are set to true");
-
   // We won't need to map query indices, but will we need to map distances?
   std::vector<std::vector<size_t>>* neighborPtr = &neighbors;
 
@@ -525,6 +643,9 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
   traverser.Traverse(*queryTree, *referenceTree);
+  Profiler::Count("base_cases", rules.BaseCases());
+  Profiler::Count("scores", rules.Scores());
+  Profiler::Count("prunes", traverser.NumPrunes());
 
   Timer::Stop("range_search/computing_neighbors");
 
@@ -560,6 +681,16 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
     std::vector<std::vector<size_t>>& neighbors,
     std::vector<std::vector<double>>& distances)
 {
+  // If points were inserted or removed, we search with all points in the
+  // reference set as a query set.
+  if (levels.Active())
+  {
+    MatType points;
+    levels.Gather(*this, points);
+    SearchLevels(points, range, neighbors, distances, true);
+    return;
+  }
+
   // If there are no points, there is no search to be done.
   if (referenceSet->n_cols == 0)
     return;
@@ -585,37 +716,43 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
 
   // Create the helper object for the traversal.
   typedef RangeSearchRules<MetricType, Tree> RuleType;
-  RuleType rules(*referenceSet, *referenceSet, range, *neighborPtr,
-      *distancePtr, metric, true /* don't return the query in the results */);
 
   if (naive)
   {
-    // The naive brute-force solution.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      for (size_t j = 0; j < referenceSet->n_cols; ++j)
-        rules.BaseCase(i, j);
+    // The naive brute-force solution.  The results for each query point are
+    // only touched by one thread, so each thread can use its own rules.
+    #pragma omp parallel
+    {
+      RuleType rules(*referenceSet, *referenceSet, range, *neighborPtr,
+          *distancePtr, metric, true /* don't return the query */);
+
+      #pragma omp for
+      for (omp_size_t i = 0; i < (omp_size_t) referenceSet->n_cols; ++i)
+        for (size_t j = 0; j < referenceSet->n_cols; ++j)
+          rules.BaseCase(i, j);
+    }
 
     baseCases = (referenceSet->n_cols * referenceSet->n_cols);
     scores = 0;
   }
   else if (singleMode)
   {
-    // Create the traverser.
-    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
-
-    // Now have it traverse for each point.
-    for (size_t i = 0; i < referenceSet->n_cols; ++i)
-      traverser.Traverse(i, *referenceTree);
-
-    baseCases = rules.BaseCases();
-    scores = rules.Scores();
+    baseCases = 0;
+    scores = 0;
+    SingleTreeTraverse(*referenceSet, range, *neighborPtr, *distancePtr, true);
   }
   else // Dual-tree recursion.
   {
+    RuleType rules(*referenceSet, *referenceSet, range, *neighborPtr,
+        *distancePtr, metric, true /* don't return the query in the results */);
+
     // Create the traverser.
     typename Tree::template DualTreeTraverser<RuleType> traverser(rules);
 
     traverser.Traverse(*referenceTree, *referenceTree);
+    Profiler::Count("base_cases", rules.BaseCases());
+    Profiler::Count("scores", rules.Scores());
+    Profiler::Count("prunes", traverser.NumPrunes());
 
     baseCases = rules.BaseCases();
     scores = rules.Scores();
@@ -651,6 +788,140 @@ void RangeSearch<MetricType, MatType, TreeType>::Search(
   }
 }
 
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::SingleTreeTraverse(
+    const MatType& querySet,
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances,
+    const bool sameSet)
+{
+  typedef RangeSearchRules<MetricType, Tree> RuleType;
+
+  size_t threadBaseCases = 0;
+  size_t threadScores = 0;
+
+  // The worker threads record their counters in the scope of this thread.
+  const std::string scope = Profiler::Scope();
+
+  // Trees with self-children cache the last distance evaluation of each
+  // reference node in its statistic, so these can't be shared between threads.
+  #pragma omp parallel if (!tree::TreeTraits<Tree>::HasSelfChildren) \
+      reduction(+:threadBaseCases, threadScores)
+  {
+    ScopedTimer timer("single_tree_traversal", scope);
+
+    // The results for each query point are only touched by one thread, so
+    // each thread can use its own rules.
+    RuleType rules(*referenceSet, querySet, range, neighbors, distances,
+        metric, sameSet);
+    typename Tree::template SingleTreeTraverser<RuleType> traverser(rules);
+
+    #pragma omp for schedule(dynamic, 16)
+    for (omp_size_t i = 0; i < (omp_size_t) querySet.n_cols; ++i)
+      traverser.Traverse(i, *referenceTree);
+
+    threadBaseCases += rules.BaseCases();
+    threadScores += rules.Scores();
+    Profiler::Count("base_cases", rules.BaseCases());
+    Profiler::Count("scores", rules.Scores());
+    Profiler::Count("prunes", traverser.NumPrunes());
+  }
+
+  baseCases += threadBaseCases;
+  scores += threadScores;
+}
+
+//! Search the reference tree and the levels, and concatenate the results.
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::SearchLevels(
+    const MatType& querySet,
+    const math::Range& range,
+    std::vector<std::vector<size_t>>& neighbors,
+    std::vector<std::vector<double>>& distances,
+    const bool sameSet)
+{
+  neighbors.clear();
+  neighbors.resize(querySet.n_cols);
+  distances.clear();
+  distances.resize(querySet.n_cols);
+
+  size_t totalBaseCases = 0;
+  size_t totalScores = 0;
+
+  std::vector<std::vector<size_t>> setNeighbors;
+  std::vector<std::vector<double>> setDistances;
+  for (size_t s = 0; s <= levels.NumLevels(); ++s)
+  {
+    // Set 0 is the reference tree; the others are the levels.
+    const size_t setSize = (s == 0) ? levels.NumMainPoints() :
+        levels.LevelIds(s - 1).size();
+    const size_t setRemoved = (s == 0) ? levels.NumMainRemoved() :
+        levels.NumLevelRemoved(s - 1);
+    if (setSize == setRemoved)
+      continue;
+
+    if (s == 0)
+    {
+      SearchReference(querySet, range, setNeighbors, setDistances);
+      totalBaseCases += baseCases;
+      totalScores += scores;
+    }
+    else
+    {
+      RangeSearch& level = levels.Level(s - 1);
+      level.SingleMode() = singleMode;
+      level.Search(querySet, range, setNeighbors, setDistances);
+      totalBaseCases += level.BaseCases();
+      totalScores += level.Scores();
+    }
+
+    for (size_t q = 0; q < querySet.n_cols; ++q)
+    {
+      for (size_t j = 0; j < setNeighbors[q].size(); ++j)
+      {
+        const size_t index = setNeighbors[q][j];
+        const size_t id = (s == 0) ? index : levels.LevelIds(s - 1)[index];
+        if (levels.IsRemoved(id))
+          continue;
+
+        const size_t position = levels.Position(id);
+        if (sameSet && position == q)
+          continue;
+
+        neighbors[q].push_back(position);
+        distances[q].push_back(setDistances[q][j]);
+      }
+    }
+  }
+
+  baseCases = totalBaseCases;
+  scores = totalScores;
+}
+
+//! Rebuild the reference tree on all points of the reference set.
+template<typename MetricType,
+         typename MatType,
+         template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RangeSearch<MetricType, MatType, TreeType>::RebuildReference()
+{
+  MatType points;
+  levels.Gather(*this, points);
+
+  // Training resets the levels.
+  Train(std::move(points));
+}
+
 template<typename MetricType,
          typename MatType,
          template<typename TreeMetricType,
@@ -658,7 +929,7 @@ template<typename MetricType,
                   typename TreeMatType> class TreeType>
 template<typename Archive>
 void RangeSearch<MetricType, MatType, TreeType>::serialize(
-    Archive& ar, const uint32_t /* version */)
+    Archive& ar, const uint32_t version)
 {
   // Serialize preferences for search.
   ar(CEREAL_NVP(naive));
@@ -718,6 +989,13 @@ void RangeSearch<MetricType, MatType, TreeType>::serialize(
       metric = referenceTree->Metric(); // Get the metric from the tree.
     }
   }
+
+  // The points inserted or removed since the reference tree was built are
+  // kept in the levels.  Models saved before version 1 have none.
+  if (version >= 1)
+    ar(CEREAL_NVP(levels));
+  else if (cereal::is_loading<Archive>())
+    levels.Reset(referenceSet->n_cols);
 }
 
 } // namespace range
@@ -12,6 +12,8 @@
 #ifndef MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 #define MLPACK_METHODS_RANGE_SEARCH_RANGE_SEARCH_RULES_HPP
 
+#include <mlpack/core/tree/hrectbound.hpp>
+#include <mlpack/core/tree/rule_traits.hpp>
 #include <mlpack/core/tree/traversal_info.hpp>
 
 namespace mlpack {
@@ -57,6 +59,20 @@ class RangeSearchRules
    */
   double BaseCase(const size_t queryIndex, const size_t referenceIndex);
 
+  /**
+   * Compute the base cases between the query point and each reference point in
+   * [referenceBegin, referenceBegin + referenceCount), computing all of the
+   * distances at once.  This has the same effect as calling BaseCase() for
+   * each of the reference points, and can only be used with an LMetric.
+   *
+   * @param queryIndex Index of query point.
+   * @param referenceBegin Index of the first reference point.
+   * @param referenceCount Number of reference points.
+   */
+  void BaseCase(const size_t queryIndex,
+                const size_t referenceBegin,
+                const size_t referenceCount);
+
   /**
    * Get the score for recursion order.  A low score indicates priority for
    * recursion, while DBL_MAX indicates that the node should not be recursed
@@ -148,6 +164,9 @@ class RangeSearchRules
   //! The last reference index.
   size_t lastReferenceIndex;
 
+  //! Storage for the distances computed by the batched BaseCase().
+  arma::Col<typename TreeType::Mat::elem_type> batchDistances;
+
   //! Add all the points in the given node to the results for the given query
   //! point.  If the base case has already been calculated, we make sure to not
   //! add that to the results twice.
@@ -163,6 +182,19 @@ class RangeSearchRules
 };
 
 } // namespace range
+
+namespace tree {
+
+//! RangeSearchRules has a batched base case when used with an LMetric.
+template<typename MetricType, typename TreeType>
+class RuleTraits<range::RangeSearchRules<MetricType, TreeType>>
+{
+ public:
+  static const bool HasBatchBaseCase =
+      bound::meta::IsLMetric<MetricType>::Value;
+};
+
+} // namespace tree
 } // namespace mlpack
 
 // Include implementation.
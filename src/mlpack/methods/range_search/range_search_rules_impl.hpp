@@ -75,6 +75,40 @@ double RangeSearchRules<MetricType, TreeType>::BaseCase(
   return distance;
 }
 
+template<typename MetricType, typename TreeType>
+void RangeSearchRules<MetricType, TreeType>::BaseCase(
+    const size_t queryIndex,
+    const size_t referenceBegin,
+    const size_t referenceCount)
+{
+  if (referenceCount == 0)
+    return;
+
+  metric.BatchEvaluate(querySet.unsafe_col(queryIndex),
+      referenceSet.cols(referenceBegin, referenceBegin + referenceCount - 1),
+      batchDistances);
+
+  for (size_t i = 0; i < referenceCount; ++i)
+  {
+    // Skip the same pairs that BaseCase() skips.
+    const size_t referenceIndex = referenceBegin + i;
+    if ((sameSet && (queryIndex == referenceIndex)) ||
+        ((lastQueryIndex == queryIndex) &&
+         (lastReferenceIndex == referenceIndex)))
+      continue;
+
+    ++baseCases;
+    lastQueryIndex = queryIndex;
+    lastReferenceIndex = referenceIndex;
+
+    if (range.Contains(batchDistances[i]))
+    {
+      neighbors[queryIndex].push_back(referenceIndex);
+      distances[queryIndex].push_back(batchDistances[i]);
+    }
+  }
+}
+
 //! Single-tree scoring function.
 template<typename MetricType, typename TreeType>
 double RangeSearchRules<MetricType, TreeType>::Score(const size_t queryIndex,
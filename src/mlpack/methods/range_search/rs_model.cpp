@@ -35,7 +35,8 @@ RSModel::RSModel(const RSModel& other) :
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
     q(other.q),
-    rSearch(other.rSearch->Clone())
+    rSearch(other.rSearch->Clone()),
+    mappedTree(other.mappedTree)
 {
   // Nothing to do.
 }
@@ -46,7 +47,8 @@ RSModel::RSModel(RSModel&& other) :
     leafSize(other.leafSize),
     randomBasis(other.randomBasis),
     q(std::move(other.q)),
-    rSearch(std::move(other.rSearch))
+    rSearch(std::move(other.rSearch)),
+    mappedTree(std::move(other.mappedTree))
 {
   // Reset other model.
   other.treeType = TreeTypes::KD_TREE;
@@ -66,6 +68,7 @@ RSModel& RSModel::operator=(const RSModel& other)
     randomBasis = other.randomBasis;
     q = other.q;
     rSearch = other.rSearch->Clone();
+    mappedTree = other.mappedTree;
   }
 
   return *this;
@@ -83,6 +86,7 @@ RSModel& RSModel::operator=(RSModel&& other)
     randomBasis = other.randomBasis;
     q = std::move(other.q);
     rSearch = std::move(other.rSearch);
+    mappedTree = std::move(other.mappedTree);
 
     other.treeType = TreeTypes::KD_TREE;
     other.leafSize = 0;
@@ -100,8 +104,10 @@ RSModel::~RSModel()
 
 void RSModel::InitializeModel(const bool naive, const bool singleMode)
 {
-  // Clean memory, if necessary.
+  // Clean memory, if necessary.  A tree loaded from a flat tree file is deleted
+  // with the old model, so its mapping is no longer needed.
   delete rSearch;
+  mappedTree.reset();
 
   switch (treeType)
   {
@@ -198,6 +204,38 @@ void RSModel::BuildModel(arma::mat&& referenceSet,
   }
 }
 
+// Save the reference tree in the flat tree format.
+void RSModel::SaveFlat(const std::string& filename) const
+{
+  if (randomBasis)
+  {
+    throw std::invalid_argument("RSModel::SaveFlat(): models that use a random "
+        "basis cannot be saved in the flat tree format");
+  }
+
+  rSearch->SaveFlat(filename);
+}
+
+// Load the reference tree from a file in the flat tree format.
+void RSModel::LoadFlat(const std::string& filename, const bool singleMode)
+{
+  if (randomBasis)
+  {
+    throw std::invalid_argument("RSModel::LoadFlat(): models that use a random "
+        "basis cannot be loaded from the flat tree format");
+  }
+
+  Log::Info << "Loading " << TreeName() << " from '" << filename << "'..."
+      << std::endl;
+
+  InitializeModel(false, singleMode);
+
+  std::shared_ptr<data::MappedFile> mapping =
+      std::make_shared<data::MappedFile>();
+  rSearch->LoadFlat(filename, *mapping);
+  mappedTree = std::move(mapping);
+}
+
 // Perform range search.
 void RSModel::Search(arma::mat&& querySet,
                      const math::Range& range,
@@ -19,6 +19,7 @@
 #include <mlpack/core/tree/cover_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
 #include <mlpack/core/tree/octree.hpp>
+#include <mlpack/core/tree/flat_tree.hpp>
 
 #include "range_search.hpp"
 
@@ -75,6 +76,14 @@ class RSWrapperBase
   virtual void Search(const math::Range& range,
                       std::vector<std::vector<size_t>>& neighbors,
                       std::vector<std::vector<double>>& distances) = 0;
+
+  //! Save the reference tree in the flat tree format.
+  virtual void SaveFlat(const std::string& filename) const = 0;
+
+  //! Load the reference tree from a file in the flat tree format, holding the
+  //! mapping of the file in the given object.
+  virtual void LoadFlat(const std::string& filename,
+                        data::MappedFile& mapping) = 0;
 };
 
 /**
@@ -132,6 +141,15 @@ class RSWrapper : public RSWrapperBase
                       std::vector<std::vector<size_t>>& neighbors,
                       std::vector<std::vector<double>>& distances);
 
+  //! Save the reference tree and the original indices of its points in the
+  //! flat tree format.
+  virtual void SaveFlat(const std::string& filename) const;
+
+  //! Load the reference tree and the original indices of its points from a
+  //! file in the flat tree format; the tree uses the mapped dataset in place.
+  virtual void LoadFlat(const std::string& filename,
+                        data::MappedFile& mapping);
+
   //! Serialize the RangeSearch model.
   template<typename Archive>
   void serialize(Archive& ar, const uint32_t /* version */)
@@ -144,6 +162,39 @@ class RSWrapper : public RSWrapperBase
 
   //! The instantiated RangeSearch object that we are wrapping.
   RSType rs;
+
+ private:
+  //! Save the given tree in the flat tree format.
+  template<typename Tree>
+  static void SaveFlatTree(
+      const std::string& filename,
+      const Tree& referenceTree,
+      const std::vector<size_t>& oldFromNew,
+      const typename std::enable_if_t<tree::HasFlatFormat<Tree>::value>* = 0);
+
+  //! Throw an exception, since the given type of tree has no flat format.
+  template<typename Tree>
+  static void SaveFlatTree(
+      const std::string& filename,
+      const Tree& referenceTree,
+      const std::vector<size_t>& oldFromNew,
+      const typename std::enable_if_t<!tree::HasFlatFormat<Tree>::value>* = 0);
+
+  //! Load a tree of the given type from a file in the flat tree format.
+  template<typename Tree>
+  static Tree* LoadFlatTree(
+      const std::string& filename,
+      std::vector<size_t>& oldFromNew,
+      data::MappedFile& mapping,
+      const typename std::enable_if_t<tree::HasFlatFormat<Tree>::value>* = 0);
+
+  //! Throw an exception, since the given type of tree has no flat format.
+  template<typename Tree>
+  static Tree* LoadFlatTree(
+      const std::string& filename,
+      std::vector<size_t>& oldFromNew,
+      data::MappedFile& mapping,
+      const typename std::enable_if_t<!tree::HasFlatFormat<Tree>::value>* = 0);
 };
 
 /**
@@ -319,6 +370,31 @@ class RSModel
                   const bool naive,
                   const bool singleMode);
 
+  /**
+   * Save the reference tree, its dataset and the original indices of its points
+   * in the flat tree format (see tree::SaveFlat()), so that the model can be
+   * loaded again with LoadFlat() without any parsing.  Only kd-trees, ball
+   * trees, vantage point trees, random projection trees and cover trees can be
+   * saved.  A std::invalid_argument is thrown for other trees, in naive mode,
+   * or if a random basis is used (it is not saved).
+   *
+   * @param filename Name of the file to save to.
+   */
+  void SaveFlat(const std::string& filename) const;
+
+  /**
+   * Load the reference tree from a file written by SaveFlat().  The file is
+   * memory-mapped, and the tree uses the dataset, the bounds and the
+   * statistics saved in the file without computing anything (see
+   * tree::LoadFlat()); the model holds the mapping.  The tree type of the model
+   * must be the tree type that the file was saved with, and the model must not
+   * use a random basis.
+   *
+   * @param filename Name of the file to load from.
+   * @param singleMode Whether single-tree search should be used.
+   */
+  void LoadFlat(const std::string& filename, const bool singleMode);
+
   /**
    * Perform range search.  This takes possession of the query set, so the query
    * set will not be usable after the search.  For more information on the
@@ -365,6 +441,10 @@ class RSModel
    */
   RSWrapperBase* rSearch;
 
+  //! The memory-mapped flat tree file that the model was loaded from, if any;
+  //! the reference tree uses its memory.
+  std::shared_ptr<data::MappedFile> mappedTree;
+
   /**
    * Return a string representing the name of the tree.  This is used for
    * logging output.
@@ -51,6 +51,97 @@ void RSWrapper<TreeType>::Search(const math::Range& range,
   rs.Search(range, neighbors, distances);
 }
 
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RSWrapper<TreeType>::SaveFlat(const std::string& filename) const
+{
+  if (rs.Naive())
+  {
+    throw std::invalid_argument("RSModel::SaveFlat(): there is no reference "
+        "tree in naive search mode");
+  }
+
+  SaveFlatTree(filename, *rs.referenceTree, rs.oldFromNewReferences);
+}
+
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+void RSWrapper<TreeType>::LoadFlat(const std::string& filename,
+                                   data::MappedFile& mapping)
+{
+  if (rs.Naive())
+  {
+    throw std::invalid_argument("RSModel::LoadFlat(): a reference tree cannot "
+        "be used in naive search mode");
+  }
+
+  std::vector<size_t> oldFromNewReferences;
+  typename RSType::Tree* referenceTree =
+      LoadFlatTree<typename RSType::Tree>(filename, oldFromNewReferences,
+      mapping);
+  rs.Train(referenceTree);
+
+  // Give the model ownership of the tree and the mappings.
+  rs.treeOwner = true;
+  rs.oldFromNewReferences = std::move(oldFromNewReferences);
+}
+
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename Tree>
+void RSWrapper<TreeType>::SaveFlatTree(
+    const std::string& filename,
+    const Tree& referenceTree,
+    const std::vector<size_t>& oldFromNew,
+    const typename std::enable_if_t<tree::HasFlatFormat<Tree>::value>*)
+{
+  tree::SaveFlat(filename, referenceTree, oldFromNew);
+}
+
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename Tree>
+void RSWrapper<TreeType>::SaveFlatTree(
+    const std::string& /* filename */,
+    const Tree& /* referenceTree */,
+    const std::vector<size_t>& /* oldFromNew */,
+    const typename std::enable_if_t<!tree::HasFlatFormat<Tree>::value>*)
+{
+  throw std::invalid_argument("RSModel::SaveFlat(): this type of tree cannot "
+      "be saved in the flat tree format");
+}
+
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename Tree>
+Tree* RSWrapper<TreeType>::LoadFlatTree(
+    const std::string& filename,
+    std::vector<size_t>& oldFromNew,
+    data::MappedFile& mapping,
+    const typename std::enable_if_t<tree::HasFlatFormat<Tree>::value>*)
+{
+  return tree::LoadFlat<Tree>(filename, oldFromNew, mapping);
+}
+
+template<template<typename TreeMetricType,
+                  typename TreeStatType,
+                  typename TreeMatType> class TreeType>
+template<typename Tree>
+Tree* RSWrapper<TreeType>::LoadFlatTree(
+    const std::string& /* filename */,
+    std::vector<size_t>& /* oldFromNew */,
+    data::MappedFile& /* mapping */,
+    const typename std::enable_if_t<!tree::HasFlatFormat<Tree>::value>*)
+{
+  throw std::invalid_argument("RSModel::LoadFlat(): this type of tree cannot "
+      "be loaded from the flat tree format");
+}
+
 template<template<typename TreeMetricType,
                   typename TreeStatType,
                   typename TreeMatType> class TreeType>
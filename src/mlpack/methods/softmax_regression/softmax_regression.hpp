@@ -14,6 +14,7 @@
 
 #include <mlpack/prereqs.hpp>
 #include <ensmallen.hpp>
+#include <mlpack/core/data/block_reader.hpp>
 
 #include "softmax_regression_function.hpp"
 
@@ -205,6 +206,40 @@ class SoftmaxRegression
                OptimizerType optimizer,
                CallbackTypes&&... callbacks);
 
+  /**
+   * Train the softmax regression on all the points of the given file, which is
+   * read one block at a time so that it does not need to fit in memory.  The
+   * labels are read from the given label file, which holds one label per line
+   * (see data::NextLabeledBlock()).
+   *
+   * The given number of passes is made over the file.  On each block, the
+   * optimizer makes one pass over the points of the block (its MaxIterations()
+   * is set to the size of the block), starting from the parameters that the
+   * previous block gave; so this is meant for stochastic optimizers such as
+   * ens::SGD.  The objective of SoftmaxRegressionFunction is the mean over
+   * the points plus the regularization, so it does not need to be rescaled for
+   * each block.
+   *
+   * @tparam OptimizerType Desired optimizer type; it must have
+   *      MaxIterations(), like the ensmallen SGD variants.
+   * @tparam CallbackTypes Types of Callback Functions.
+   * @param dataReader Reader of the input data.
+   * @param labelReader Reader of the labels associated with the input data.
+   * @param numClasses Number of classes for classification.
+   * @param optimizer Desired optimizer, used for every block.
+   * @param passes Number of passes over the file.
+   * @param callbacks Callback function for ensmallen optimizer `OptimizerType`.
+   *      See https://www.ensmallen.org/docs.html#callback-documentation.
+   * @return Objective value of the final point on the last block.
+   */
+  template<typename OptimizerType, typename... CallbackTypes>
+  double Train(data::BlockReader& dataReader,
+               data::BlockReader& labelReader,
+               const size_t numClasses,
+               OptimizerType optimizer,
+               const size_t passes,
+               CallbackTypes&&... callbacks);
+
   //! Sets the number of classes.
   size_t& NumClasses() { return numClasses; }
   //! Gets the number of classes.
@@ -102,6 +102,41 @@ double SoftmaxRegression::Train(const arma::mat& data,
   return out;
 }
 
+template<typename OptimizerType, typename... CallbackTypes>
+double SoftmaxRegression::Train(data::BlockReader& dataReader,
+                                data::BlockReader& labelReader,
+                                const size_t numClasses,
+                                OptimizerType optimizer,
+                                const size_t passes,
+                                CallbackTypes&&... callbacks)
+{
+  Timer::Start("softmax_regression_optimization");
+  double out = 0.0;
+  arma::mat block;
+  arma::Row<size_t> labels;
+  for (size_t pass = 0; pass < passes; ++pass)
+  {
+    dataReader.Reset();
+    labelReader.Reset();
+    while (data::NextLabeledBlock(dataReader, labelReader, block, labels))
+    {
+      SoftmaxRegressionFunction regressor(block, labels, numClasses, lambda,
+                                          fitIntercept);
+      if (parameters.n_elem != regressor.GetInitialPoint().n_elem)
+        parameters = regressor.GetInitialPoint();
+
+      optimizer.MaxIterations() = block.n_cols;
+      out = optimizer.Optimize(regressor, parameters, callbacks...);
+    }
+  }
+  Timer::Stop("softmax_regression_optimization");
+
+  Log::Info << "SoftmaxRegression::SoftmaxRegression(): final objective of "
+            << "trained model on last block is " << out << "." << std::endl;
+
+  return out;
+}
+
 } // namespace regression
 } // namespace mlpack
 
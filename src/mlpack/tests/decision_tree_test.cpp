@@ -1403,3 +1403,452 @@ TEST_CASE("DifferentMaximumDepthTest", "[DecisionTreeTest]")
   REQUIRE(d2.Child(0).NumChildren() == 2);
   REQUIRE(d2.Child(1).NumChildren() == 2);
 }
+
+/**
+ * Check that the HistogramNumericSplit will split on an obviously splittable
+ * dimension of bin indices, between two bins.
+ */
+TEST_CASE("HistogramNumericSplitSimpleSplitTest", "[DecisionTreeTest]")
+{
+  arma::rowvec bins("0 1 2 3 4 5 6 7 8 9 10");
+  arma::Row<size_t> labels("0 0 0 0 0 1 1 1 1 1 1");
+  arma::rowvec weights(labels.n_elem, arma::fill::ones);
+
+  arma::vec classProbabilities;
+  HistogramNumericSplit<GiniGain>::AuxiliarySplitInfo aux;
+
+  const double bestGain = GiniGain::Evaluate<false>(labels, 2, weights);
+  const double gain = HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(
+      bestGain, bins, labels, 2, weights, 3, 1e-7, classProbabilities, aux);
+  const double weightedGain =
+      HistogramNumericSplit<GiniGain>::SplitIfBetter<true>(bestGain, bins,
+      labels, 2, weights, 3, 1e-7, classProbabilities, aux);
+
+  REQUIRE(gain > bestGain);
+  REQUIRE(gain == weightedGain);
+  REQUIRE(gain == Approx(0.0).margin(1e-7));
+
+  // The split is between bins 4 and 5.
+  REQUIRE(classProbabilities.n_elem == 1);
+  REQUIRE(classProbabilities[0] == 4.5);
+
+  // If all points are in one bin, there is no split.
+  bins.fill(3);
+  REQUIRE(HistogramNumericSplit<GiniGain>::SplitIfBetter<false>(bestGain,
+      bins, labels, 2, weights, 3, 1e-7, classProbabilities, aux) == DBL_MAX);
+}
+
+/**
+ * Check that binning a dimension keeps the order of the values, never
+ * separates equal values, and uses at most MaxBins bins.
+ */
+TEST_CASE("HistogramNumericSplitBinDimensionTest", "[DecisionTreeTest]")
+{
+  arma::mat dataset(2, 5000, arma::fill::randu);
+  // The second dimension only has three distinct values.
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset(1, i) = double(i % 3);
+
+  arma::Row<unsigned char> bins;
+  arma::vec splitPoints;
+  HistogramNumericSplit<GiniGain>::BinDimension(dataset.row(0), bins,
+      splitPoints);
+  REQUIRE(bins.n_elem == dataset.n_cols);
+  REQUIRE(splitPoints.n_elem + 1 <= HistogramNumericSplit<GiniGain>::MaxBins);
+  REQUIRE(splitPoints.n_elem > 200);
+  REQUIRE(arma::max(bins) == splitPoints.n_elem);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    // The value must be between the split points of its bin.
+    const size_t bin = bins[i];
+    if (bin > 0)
+      REQUIRE(dataset(0, i) > splitPoints[bin - 1]);
+    if (bin < splitPoints.n_elem)
+      REQUIRE(dataset(0, i) < splitPoints[bin]);
+  }
+
+  // The dimension of three values gets one bin for each value.
+  HistogramNumericSplit<GiniGain>::BinDimension(dataset.row(1), bins,
+      splitPoints);
+  REQUIRE(splitPoints.n_elem == 2);
+  REQUIRE(splitPoints[0] == Approx(0.5));
+  REQUIRE(splitPoints[1] == Approx(1.5));
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    REQUIRE(bins[i] == dataset(1, i));
+}
+
+/**
+ * Check that a decision tree with HistogramNumericSplit splits on values once
+ * it is trained, and finds the same split as BestBinaryNumericSplit when there
+ * are fewer distinct values than bins.
+ */
+TEST_CASE("HistogramDecisionTreeSplitPointTest", "[DecisionTreeTest]")
+{
+  arma::mat dataset(3, 2000);
+  dataset.row(0) = arma::floor(100 * arma::randu<arma::rowvec>(2000));
+  dataset.rows(1, 2).randu();
+  arma::Row<size_t> labels(2000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    labels[i] = (dataset(0, i) > 40.0) ? 1 : 0;
+
+  DecisionTree<GiniGain, HistogramNumericSplit> tree(dataset, labels, 2, 10,
+      1e-7, 2);
+  DecisionTree<> exact(dataset, labels, 2, 10, 1e-7, 2);
+
+  REQUIRE(tree.NumChildren() == 2);
+  REQUIRE(tree.SplitDimension() == 0);
+  REQUIRE(exact.SplitDimension() == 0);
+
+  // The split point must be 40.5, like the exact one.
+  arma::vec point("40.4 0.5 0.5");
+  REQUIRE(tree.CalculateDirection(point) == 0);
+  REQUIRE(exact.CalculateDirection(point) == 0);
+  point[0] = 40.6;
+  REQUIRE(tree.CalculateDirection(point) == 1);
+  REQUIRE(exact.CalculateDirection(point) == 1);
+
+  // The training data was binned on a copy.
+  REQUIRE(arma::max(dataset.row(2)) < 1.0);
+  arma::Row<size_t> predictions;
+  tree.Classify(dataset, predictions);
+  REQUIRE(arma::accu(predictions == labels) == labels.n_elem);
+}
+
+/**
+ * Test that a decision tree with HistogramNumericSplit generalizes about as
+ * well as one with BestBinaryNumericSplit, with and without weights.
+ */
+TEST_CASE("HistogramDecisionTreeGeneralizationTest", "[DecisionTreeTest]")
+{
+  arma::mat dataset;
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2.csv", dataset))
+    FAIL("Cannot load test dataset vc2.csv!");
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt!");
+
+  arma::mat testData;
+  arma::Row<size_t> testLabels;
+  if (!data::Load("vc2_test.csv", testData))
+    FAIL("Cannot load test dataset vc2_test.csv!");
+  if (!data::Load("vc2_test_labels.txt", testLabels))
+    FAIL("Cannot load labels for vc2_test_labels.txt!");
+
+  arma::rowvec weights(labels.n_elem, arma::fill::ones);
+  DecisionTree<GiniGain, HistogramNumericSplit> d(dataset, labels, 3, 10);
+  DecisionTree<GiniGain, HistogramNumericSplit> wd(dataset, labels, 3,
+      weights, 10);
+
+  arma::Row<size_t> predictions;
+  d.Classify(testData, predictions);
+  REQUIRE(arma::accu(predictions == testLabels) > 0.75 * testLabels.n_elem);
+
+  wd.Classify(testData, predictions);
+  REQUIRE(arma::accu(predictions == testLabels) > 0.75 * testLabels.n_elem);
+
+  // Train with a DatasetInfo too.
+  data::DatasetInfo info(dataset.n_rows);
+  DecisionTree<GiniGain, HistogramNumericSplit> id(dataset, info, labels, 3,
+      10);
+  id.Classify(testData, predictions);
+  REQUIRE(arma::accu(predictions == testLabels) > 0.75 * testLabels.n_elem);
+}
+
+/**
+ * Check that BinData() gives the bins of the numeric dimensions as unsigned
+ * chars, keeps the categorical dimensions as they are, and rejects categorical
+ * dimensions that do not fit.
+ */
+TEST_CASE("HistogramDecisionTreeBinDataTest", "[DecisionTreeTest]")
+{
+  arma::mat dataset;
+  arma::Row<size_t> labels;
+  data::DatasetInfo info;
+  MockCategoricalData(dataset, labels, info);
+
+  typedef DecisionTree<GiniGain, HistogramNumericSplit> TreeType;
+  arma::Mat<unsigned char> bins;
+  std::vector<arma::vec> splitPoints;
+  TreeType::BinData(dataset, info, bins, splitPoints);
+
+  REQUIRE(bins.n_rows == dataset.n_rows);
+  REQUIRE(bins.n_cols == dataset.n_cols);
+  REQUIRE(splitPoints.size() == dataset.n_rows);
+  for (size_t d = 0; d < dataset.n_rows; ++d)
+  {
+    for (size_t i = 0; i < dataset.n_cols; ++i)
+    {
+      if (info.Type(d) == data::Datatype::categorical)
+      {
+        REQUIRE(bins(d, i) == dataset(d, i));
+        continue;
+      }
+
+      const size_t bin = bins(d, i);
+      if (bin > 0)
+        REQUIRE(dataset(d, i) > splitPoints[d][bin - 1]);
+      if (bin < splitPoints[d].n_elem)
+        REQUIRE(dataset(d, i) < splitPoints[d][bin]);
+    }
+  }
+
+  // A tree trained on the bins works on the values.
+  TreeType tree(dataset, info, labels, 5, 10);
+  arma::Row<size_t> predictions;
+  tree.Classify(dataset, predictions);
+  REQUIRE(arma::accu(predictions == labels) > 0.7 * labels.n_elem);
+
+  // A categorical dimension with more categories than an unsigned char holds
+  // cannot be binned.
+  data::DatasetInfo wideInfo(1);
+  for (size_t i = 0; i < 300; ++i)
+    wideInfo.MapString<double>(std::to_string(i), 0);
+  arma::mat wideData(1, 300);
+  for (size_t i = 0; i < wideData.n_cols; ++i)
+    wideData[i] = i;
+  REQUIRE_THROWS_AS(TreeType::BinData(wideData, wideInfo, bins, splitPoints),
+      std::invalid_argument);
+}
+
+/**
+ * A dimension selection policy that only selects the given number of first
+ * dimensions.
+ */
+class FirstDimensionsSelect
+{
+ public:
+  FirstDimensionsSelect(const size_t count = 0) :
+      count(count), i(0), dimensions(0) { }
+
+  size_t Begin()
+  {
+    i = 0;
+    return 0;
+  }
+
+  size_t End() const { return std::min(count, dimensions); }
+
+  size_t Next() { return ++i; }
+
+  size_t Dimensions() const { return dimensions; }
+  size_t& Dimensions() { return dimensions; }
+
+ private:
+  size_t count;
+  size_t i;
+  size_t dimensions;
+};
+
+/**
+ * Check that the histograms of a child found by subtracting its sibling from
+ * its parent are the ones counted from its points, and that a tree built by
+ * passing histograms down to the children is the same as one that counts the
+ * candidate dimensions of each node on their own.
+ */
+TEST_CASE("HistogramDecisionTreeSubtractionTest", "[DecisionTreeTest]")
+{
+  // Four informative dimensions, and five constant dimensions that are never
+  // split on.
+  arma::mat dataset(9, 5000, arma::fill::zeros);
+  dataset.rows(0, 3) = arma::floor(1000 * arma::randu<arma::mat>(4, 5000));
+  arma::Row<size_t> labels(5000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    if (math::Random() < 0.1)
+      labels[i] = math::RandInt(3);
+    else if (dataset(0, i) + dataset(1, i) > 1000.0)
+      labels[i] = 1;
+    else
+      labels[i] = (dataset(2, i) > dataset(3, i)) ? 2 : 0;
+  }
+  // Integer weights, so that their sums are exact.
+  const arma::rowvec weights = arma::floor(4 * arma::randu<arma::rowvec>(
+      5000)) + 1;
+
+  typedef HistogramNumericSplit<GiniGain> SplitType;
+  arma::Mat<unsigned char> bins;
+  std::vector<arma::vec> splitPoints;
+  DecisionTree<GiniGain, HistogramNumericSplit>::BinData(dataset,
+      data::DatasetInfo(dataset.n_rows), bins, splitPoints);
+
+  arma::Cube<size_t> counts, leftCounts, rightCounts;
+  arma::cube weightSums, leftWeightSums, rightWeightSums;
+  SplitType::BuildHistogram<true>(bins, 0, 5000, labels, 3, weights, counts,
+      weightSums);
+  SplitType::BuildHistogram<true>(bins, 0, 1200, labels, 3, weights,
+      leftCounts, leftWeightSums);
+  SplitType::BuildHistogram<true>(bins, 1200, 3800, labels, 3, weights,
+      rightCounts, rightWeightSums);
+  REQUIRE(arma::accu(counts) == 5000 * dataset.n_rows);
+  REQUIRE(arma::accu(counts - leftCounts != rightCounts) == 0);
+  REQUIRE(arma::approx_equal(weightSums - leftWeightSums, rightWeightSums,
+      "absdiff", 0.0));
+
+  // With all dimensions as candidates, each node gets its histograms from its
+  // parent.  With only the informative ones, they are too few for histograms
+  // to be built, so each node counts them on its own.
+  DecisionTree<GiniGain, HistogramNumericSplit> tree(dataset, labels, 3, 5);
+  DecisionTree<GiniGain, HistogramNumericSplit, AllCategoricalSplit,
+      FirstDimensionsSelect> countedTree(dataset, labels, 3, 5, 1e-7, 0,
+      FirstDimensionsSelect(4));
+  DecisionTree<GiniGain, HistogramNumericSplit> weightedTree(dataset, labels,
+      3, weights, 5);
+  DecisionTree<GiniGain, HistogramNumericSplit, AllCategoricalSplit,
+      FirstDimensionsSelect> weightedCountedTree(dataset, labels, 3, weights,
+      5, 1e-7, 0, FirstDimensionsSelect(4));
+
+  arma::Row<size_t> predictions, countedPredictions;
+  arma::mat probabilities, countedProbabilities;
+  tree.Classify(dataset, predictions, probabilities);
+  countedTree.Classify(dataset, countedPredictions, countedProbabilities);
+  REQUIRE(tree.NumChildren() == 2);
+  REQUIRE(arma::all(predictions == countedPredictions));
+  REQUIRE(arma::approx_equal(probabilities, countedProbabilities, "absdiff",
+      0.0));
+
+  weightedTree.Classify(dataset, predictions, probabilities);
+  weightedCountedTree.Classify(dataset, countedPredictions,
+      countedProbabilities);
+  REQUIRE(arma::all(predictions == countedPredictions));
+  REQUIRE(arma::approx_equal(probabilities, countedProbabilities, "absdiff",
+      0.0));
+}
+
+/**
+ * Make sure that training on indices into a dataset gives the same tree as
+ * training on a copy of the indexed points, and leaves the dataset alone.
+ */
+TEST_CASE("DecisionTreeIndexedTrainTest", "[DecisionTreeTest]")
+{
+  arma::mat dataset;
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2.csv", dataset))
+    FAIL("Cannot load test dataset vc2.csv!");
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt!");
+  const arma::mat original(dataset);
+
+  // A bootstrap sample, so some points appear more than once.
+  arma::uvec indices = arma::randi<arma::uvec>(dataset.n_cols,
+      arma::distr_param(0, dataset.n_cols - 1));
+  arma::rowvec weights(dataset.n_cols, arma::fill::randu);
+  data::DatasetInfo info(dataset.n_rows);
+
+  const arma::mat sample = dataset.cols(indices);
+  const arma::Row<size_t> sampleLabels = labels.cols(indices);
+  const arma::rowvec sampleWeights = weights.cols(indices);
+
+  DecisionTree<> indexed, copied;
+  indexed.Train(dataset, indices, info, labels, 3, 5);
+  copied.Train(sample, info, sampleLabels, 3, 5);
+
+  DecisionTree<> weightedIndexed, weightedCopied;
+  weightedIndexed.Train(dataset, indices, info, labels, 3, weights, 5);
+  weightedCopied.Train(sample, info, sampleLabels, 3, sampleWeights, 5);
+
+  REQUIRE(arma::approx_equal(dataset, original, "absdiff", 0.0));
+
+  arma::Row<size_t> indexedPredictions, copiedPredictions;
+  indexed.Classify(dataset, indexedPredictions);
+  copied.Classify(dataset, copiedPredictions);
+  REQUIRE(arma::all(indexedPredictions == copiedPredictions));
+
+  weightedIndexed.Classify(dataset, indexedPredictions);
+  weightedCopied.Classify(dataset, copiedPredictions);
+  REQUIRE(arma::all(indexedPredictions == copiedPredictions));
+
+  // An index past the end of the dataset is an error.
+  indices[0] = dataset.n_cols;
+  REQUIRE_THROWS_AS(indexed.Train(dataset, indices, info, labels, 3),
+      std::invalid_argument);
+}
+
+/**
+ * Make sure that a tree large enough to be built in parallel is the same no
+ * matter how many threads build it.
+ */
+TEST_CASE("DecisionTreeParallelDeterministicTest", "[DecisionTreeTest]")
+{
+  // Enough points and dimensions for the split search and the subtrees to be
+  // parallelized, with noisy labels so that the tree is deep.
+  arma::mat dataset(8, 20000, arma::fill::randu);
+  arma::Row<size_t> labels(dataset.n_cols);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    labels[i] = (dataset(0, i) + dataset(3, i) > 1.0) ? 1 : 0;
+    if (math::Random() < 0.1)
+      labels[i] = 2;
+  }
+  arma::rowvec weights(dataset.n_cols, arma::fill::randu);
+  data::DatasetInfo info(dataset.n_rows);
+
+  #ifdef HAS_OPENMP
+  const int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+
+  DecisionTree<> serial(dataset, info, labels, 3, 5);
+  DecisionTree<> weightedSerial(dataset, labels, 3, weights, 5);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(std::max(maxThreads, 4));
+  #endif
+
+  DecisionTree<> parallel(dataset, info, labels, 3, 5);
+  DecisionTree<> weightedParallel(dataset, labels, 3, weights, 5);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(maxThreads);
+  #endif
+
+  arma::Row<size_t> serialPredictions, parallelPredictions;
+  arma::mat serialProbabilities, parallelProbabilities;
+  serial.Classify(dataset, serialPredictions, serialProbabilities);
+  parallel.Classify(dataset, parallelPredictions, parallelProbabilities);
+  REQUIRE(arma::all(serialPredictions == parallelPredictions));
+  REQUIRE(arma::approx_equal(serialProbabilities, parallelProbabilities,
+      "absdiff", 0.0));
+
+  weightedSerial.Classify(dataset, serialPredictions, serialProbabilities);
+  weightedParallel.Classify(dataset, parallelPredictions,
+      parallelProbabilities);
+  REQUIRE(arma::all(serialPredictions == parallelPredictions));
+  REQUIRE(arma::approx_equal(serialProbabilities, parallelProbabilities,
+      "absdiff", 0.0));
+}
+
+/**
+ * A later dimension that is better than an earlier one by less than
+ * minimumGainSplit must not be chosen, both for small nodes (searched serially)
+ * and for large nodes (searched in parallel).
+ */
+TEST_CASE("DecisionTreeMinimumGainSplitDimensionTest", "[DecisionTreeTest]")
+{
+  for (const size_t n : { (size_t) 1000, (size_t) 10000 })
+  {
+    // Both dimensions hold the label with some of the points flipped; the
+    // second dimension has 2% fewer flipped points, so its Gini gain is better
+    // by about 0.003.
+    const size_t flipped = n / 20;
+    arma::mat dataset(2, n);
+    arma::Row<size_t> labels(n);
+    for (size_t i = 0; i < n; ++i)
+    {
+      labels[i] = i % 2;
+      const size_t j = i / 2;
+      dataset(0, i) = (j < flipped) ? 1 - labels[i] : labels[i];
+      dataset(1, i) = (j < flipped - flipped / 50) ? 1 - labels[i] :
+          labels[i];
+    }
+
+    // With a small minimumGainSplit the better dimension is taken.
+    DecisionTree<> tree(dataset, labels, 2, 1, 1e-7, 2);
+    REQUIRE(tree.NumChildren() == 2);
+    REQUIRE(tree.SplitDimension() == 1);
+
+    // But not when it is not better by at least minimumGainSplit.
+    DecisionTree<> marginTree(dataset, labels, 2, 1, 0.01, 2);
+    REQUIRE(marginTree.NumChildren() == 2);
+    REQUIRE(marginTree.SplitDimension() == 0);
+  }
+}
@@ -14,6 +14,7 @@
 
 #include <mlpack/methods/gmm/gmm.hpp>
 #include <mlpack/methods/gmm/diagonal_gmm.hpp>
+#include <mlpack/methods/gmm/gmm_tree_evaluator.hpp>
 
 #include <mlpack/methods/gmm/no_constraint.hpp>
 #include <mlpack/methods/gmm/positive_definite_constraint.hpp>
@@ -1239,3 +1240,219 @@ TEST_CASE("DiagonalGMMLoadSaveTest", "[GMMTest]")
     }
   }
 }
+
+/**
+ * Make sure that one iteration of EMFit, which computes the E-step and the
+ * M-step over tiles of points in parallel, gives the same model as computing
+ * the conditional probabilities, means and covariances directly, and that the
+ * result does not depend on the number of threads.
+ */
+TEST_CASE("EMFitTiledStepsTest", "[GMMTest]")
+{
+  // Use enough points for several tiles, the last of which is not full.
+  arma::mat data(3, 3500);
+  data.cols(0, 1499) = arma::randn<arma::mat>(3, 1500);
+  data.cols(1500, 2699) = arma::randn<arma::mat>(3, 1200) * 2.0 + 4.0;
+  data.cols(2700, 3499) = arma::randn<arma::mat>(3, 800) - 5.0;
+
+  std::vector<distribution::GaussianDistribution> dists;
+  dists.push_back(distribution::GaussianDistribution("0.5 0 0",
+      "1.5 0.2 0; 0.2 1 0; 0 0 1"));
+  dists.push_back(distribution::GaussianDistribution("3 3 3",
+      "3 0 0.5; 0 3 0; 0.5 0 3"));
+  dists.push_back(distribution::GaussianDistribution("-4 -4 -5",
+      "1 0 0; 0 2 0.3; 0 0.3 1"));
+  arma::vec weights("0.3 0.4 0.3");
+
+  // Compute one iteration of EM directly.
+  arma::mat condProb(3, data.n_cols);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    arma::vec logProbs;
+    dists[i].LogProbability(data, logProbs);
+    condProb.row(i) = std::log(weights[i]) + logProbs.t();
+  }
+  condProb.each_row() -= arma::max(condProb, 0);
+  condProb = arma::exp(condProb);
+  condProb.each_row() /= arma::sum(condProb, 0);
+
+  std::vector<distribution::GaussianDistribution> fitDists(dists);
+  arma::vec fitWeights(weights);
+  EMFit<kmeans::KMeans<>, NoConstraint> fitter(2, 1e-10);
+  fitter.Estimate(data, fitDists, fitWeights, true);
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    const double sum = arma::accu(condProb.row(i));
+    const arma::vec mean = data * condProb.row(i).t() / sum;
+    arma::mat diffs = data.each_col() - mean;
+    const arma::mat covariance = (diffs.each_row() % condProb.row(i)) *
+        diffs.t() / sum;
+
+    REQUIRE(fitWeights[i] == Approx(sum / data.n_cols).epsilon(1e-7));
+    for (size_t j = 0; j < 3; ++j)
+    {
+      REQUIRE(fitDists[i].Mean()[j] == Approx(mean[j]).epsilon(1e-7));
+      for (size_t l = 0; l < 3; ++l)
+      {
+        REQUIRE(fitDists[i].Covariance()(j, l) ==
+            Approx(covariance(j, l)).epsilon(1e-7).margin(1e-10));
+      }
+    }
+  }
+
+  // Now run a few more iterations with one thread and with many threads.
+  #ifdef HAS_OPENMP
+  const int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+
+  std::vector<distribution::GaussianDistribution> serialDists(dists);
+  arma::vec serialWeights(weights);
+  EMFit<kmeans::KMeans<>, NoConstraint> longFitter(10, 1e-10);
+  longFitter.Estimate(data, serialDists, serialWeights, true);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(std::max(maxThreads, 4));
+  #endif
+
+  std::vector<distribution::GaussianDistribution> parallelDists(dists);
+  arma::vec parallelWeights(weights);
+  longFitter.Estimate(data, parallelDists, parallelWeights, true);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(maxThreads);
+  #endif
+
+  for (size_t i = 0; i < 3; ++i)
+  {
+    REQUIRE(parallelWeights[i] == Approx(serialWeights[i]).epsilon(1e-7));
+    for (size_t j = 0; j < 3; ++j)
+    {
+      REQUIRE(parallelDists[i].Mean()[j] ==
+          Approx(serialDists[i].Mean()[j]).epsilon(1e-7));
+      for (size_t l = 0; l < 3; ++l)
+      {
+        REQUIRE(parallelDists[i].Covariance()(j, l) ==
+            Approx(serialDists[i].Covariance()(j, l)).epsilon(1e-7)
+            .margin(1e-10));
+      }
+    }
+  }
+}
+
+/**
+ * Make sure that one iteration of EMFit with diagonal Gaussians and
+ * probabilities for each point gives the same model as computing the weighted
+ * conditional probabilities, means and covariances directly.
+ */
+TEST_CASE("EMFitTiledStepsDiagonalWithProbabilityTest", "[GMMTest]")
+{
+  arma::mat data(4, 2500);
+  data.cols(0, 1299) = arma::randn<arma::mat>(4, 1300);
+  data.cols(1300, 2499) = arma::randn<arma::mat>(4, 1200) * 1.5 + 3.0;
+  const arma::vec probabilities = 0.5 + 0.5 * arma::randu<arma::vec>(2500);
+
+  std::vector<distribution::DiagonalGaussianDistribution> dists;
+  dists.push_back(distribution::DiagonalGaussianDistribution("0 0 0.5 0",
+      "1 1.5 1 1"));
+  dists.push_back(distribution::DiagonalGaussianDistribution("2.5 3 3 3",
+      "2 2 3 2"));
+  arma::vec weights("0.5 0.5");
+
+  // Compute one iteration of EM directly.
+  arma::mat condProb(2, data.n_cols);
+  for (size_t i = 0; i < 2; ++i)
+  {
+    arma::vec logProbs;
+    dists[i].LogProbability(data, logProbs);
+    condProb.row(i) = std::log(weights[i]) + logProbs.t();
+  }
+  condProb.each_row() -= arma::max(condProb, 0);
+  condProb = arma::exp(condProb);
+  condProb.each_row() /= arma::sum(condProb, 0);
+  condProb.each_row() %= probabilities.t();
+
+  EMFit<kmeans::KMeans<>, NoConstraint,
+      distribution::DiagonalGaussianDistribution> fitter(2, 1e-10);
+  fitter.Estimate(data, probabilities, dists, weights, true);
+
+  for (size_t i = 0; i < 2; ++i)
+  {
+    const double sum = arma::accu(condProb.row(i));
+    const arma::vec mean = data * condProb.row(i).t() / sum;
+    const arma::mat diffs = data.each_col() - mean;
+    const arma::vec covariance = (diffs % diffs) * condProb.row(i).t() / sum;
+
+    REQUIRE(weights[i] ==
+        Approx(sum / arma::accu(probabilities)).epsilon(1e-7));
+    for (size_t j = 0; j < 4; ++j)
+    {
+      REQUIRE(dists[i].Mean()[j] == Approx(mean[j]).epsilon(1e-7));
+      REQUIRE(dists[i].Covariance()[j] == Approx(covariance[j]).epsilon(1e-7));
+    }
+  }
+}
+
+/**
+ * Make sure that the tree-based log-probabilities of a GMM with many components
+ * are within the relative error of the exact ones, and that the tree-based
+ * labels are exact when the relative error is 0, and within the relative error
+ * otherwise.
+ */
+TEST_CASE("GMMTreeEvaluatorTest", "[GMMTest]")
+{
+  const size_t gaussians = 50;
+  GMM gmm(gaussians, 3);
+  for (size_t i = 0; i < gaussians; ++i)
+  {
+    const arma::vec mean = 40.0 * arma::randu<arma::vec>(3) - 20.0;
+    const arma::mat factor = arma::randu<arma::mat>(3, 3);
+    gmm.Component(i) = distribution::GaussianDistribution(mean,
+        factor * factor.t() + 0.5 * arma::eye<arma::mat>(3, 3));
+  }
+  gmm.Weights() = arma::randu<arma::vec>(gaussians) + 0.1;
+  gmm.Weights() /= arma::accu(gmm.Weights());
+
+  arma::mat points(3, 3000);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    points.col(i) = gmm.Random();
+
+  arma::vec logProbs;
+  gmm.LogProbability(points, logProbs);
+
+  // The tree-based log-probabilities.
+  arma::vec treeLogProbs;
+  gmm.LogProbability(points, treeLogProbs, 0.05);
+  REQUIRE(treeLogProbs.n_elem == points.n_cols);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    REQUIRE(std::exp(treeLogProbs[i] - logProbs[i]) ==
+        Approx(1.0).epsilon(0.05));
+  }
+
+  // Make sure that components were actually pruned.
+  std::vector<distribution::GaussianDistribution> dists;
+  for (size_t i = 0; i < gaussians; ++i)
+    dists.push_back(gmm.Component(i));
+  GMMTreeEvaluator evaluator(dists, gmm.Weights(), 0.05);
+  evaluator.LogProbability(points, treeLogProbs);
+  REQUIRE(evaluator.Prunes() > 0);
+
+  // With no error, the labels must be the same.
+  arma::Row<size_t> labels, treeLabels;
+  gmm.Classify(points, labels);
+  gmm.Classify(points, treeLabels, 0.0);
+  REQUIRE(treeLabels.n_elem == points.n_cols);
+  for (size_t i = 0; i < points.n_cols; ++i)
+    REQUIRE(treeLabels[i] == labels[i]);
+
+  // With some error, the label must be nearly as likely as the best.
+  gmm.Classify(points, treeLabels, 0.1);
+  for (size_t i = 0; i < points.n_cols; ++i)
+  {
+    const double best = gmm.LogProbability(points.col(i), labels[i]);
+    const double chosen = gmm.LogProbability(points.col(i), treeLabels[i]);
+    REQUIRE(chosen >= best - std::log(1.1) - 1e-10);
+  }
+}
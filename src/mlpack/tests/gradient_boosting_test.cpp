@@ -0,0 +1,322 @@
+/**
+ * @file tests/gradient_boosting_test.cpp
+ *
+ * Tests for the GradientBoosting and GradientBoostingTree classes.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/methods/gradient_boosting/gradient_boosting.hpp>
+#include <mlpack/methods/random_forest/random_forest.hpp>
+
+#include "catch.hpp"
+#include "serialization.hpp"
+
+using namespace mlpack;
+using namespace mlpack::tree;
+
+/**
+ * Make sure that a single tree fitted to the gradients of a step function
+ * finds the step, with the Newton step as the value of each leaf.
+ */
+TEST_CASE("GradientBoostingTreeStepTest", "[GradientBoostingTest]")
+{
+  // One dimension with 100 bins; the points of bins 0 to 39 have gradient -1,
+  // and the others have gradient 1.
+  arma::Mat<unsigned char> bins(100, 1);
+  std::vector<arma::vec> splitPoints(1, arma::vec(99));
+  arma::vec gradients(100), hessians(100, arma::fill::ones);
+  arma::mat data(1, 100);
+  for (size_t i = 0; i < 100; ++i)
+  {
+    bins(i, 0) = i;
+    data(0, i) = i;
+    gradients[i] = (i < 40) ? -1.0 : 1.0;
+    if (i < 99)
+      splitPoints[0][i] = i + 0.5;
+  }
+  arma::uvec points = arma::regspace<arma::uvec>(0, 99);
+  arma::uvec dimensions = { 0 };
+
+  GradientBoostingTree tree;
+  tree.Train(bins, splitPoints, gradients, hessians, points, dimensions, 2, 1,
+      0.0, 0.0, 1.0);
+
+  REQUIRE(tree.NumNodes() == 3);
+  REQUIRE(tree.Predict(data.col(0)) == Approx(1.0));
+  REQUIRE(tree.Predict(data.col(39)) == Approx(1.0));
+  REQUIRE(tree.Predict(data.col(40)) == Approx(-1.0));
+  REQUIRE(tree.Predict(data.col(99)) == Approx(-1.0));
+
+  // The leaves must hold at least the minimum number of points, so with 50 the
+  // split is moved to the middle.
+  points = arma::regspace<arma::uvec>(0, 99);
+  tree.Train(bins, splitPoints, gradients, hessians, points, dimensions, 2, 50,
+      0.0, 0.0, 0.5);
+  REQUIRE(tree.NumNodes() == 3);
+  REQUIRE(tree.Predict(data.col(49)) == Approx(0.5 * 30.0 / 50.0));
+  REQUIRE(tree.Predict(data.col(50)) == Approx(-0.5));
+}
+
+/**
+ * Make sure that two well-separated Gaussians are classified correctly.
+ */
+TEST_CASE("GradientBoostingBinaryTest", "[GradientBoostingTest]")
+{
+  arma::mat data(5, 1000, arma::fill::randn);
+  arma::Row<size_t> labels(1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    labels[i] = i % 2;
+    data.col(i) += 3.0 * labels[i];
+  }
+
+  GradientBoosting gb(data, labels, 2, 50);
+  REQUIRE(gb.NumClasses() == 2);
+  REQUIRE(gb.NumRounds() == 50);
+  REQUIRE(gb.NumTrees() == 50);
+
+  arma::mat testData(5, 1000, arma::fill::randn);
+  arma::Row<size_t> testLabels(1000);
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    testLabels[i] = i % 2;
+    testData.col(i) += 3.0 * testLabels[i];
+  }
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  gb.Classify(testData, predictions, probabilities);
+  REQUIRE(arma::accu(predictions == testLabels) > 950);
+  REQUIRE(probabilities.n_rows == 2);
+  REQUIRE(probabilities.n_cols == 1000);
+  REQUIRE(arma::approx_equal(arma::sum(probabilities, 0),
+      arma::rowvec(1000, arma::fill::ones), "absdiff", 1e-10));
+
+  // Classifying single points gives the same results.
+  for (size_t i = 0; i < 1000; i += 97)
+  {
+    size_t prediction;
+    arma::vec pointProbabilities;
+    gb.Classify(testData.col(i), prediction, pointProbabilities);
+    REQUIRE(prediction == predictions[i]);
+    REQUIRE(gb.Classify(testData.col(i)) == predictions[i]);
+    REQUIRE(pointProbabilities[1] == Approx(probabilities(1, i)));
+  }
+}
+
+/**
+ * Make sure that the vc2 dataset, with three classes, is learned well, also
+ * with subsampling.
+ */
+TEST_CASE("GradientBoostingMulticlassTest", "[GradientBoostingTest]")
+{
+  arma::mat dataset;
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2.csv", dataset))
+    FAIL("Cannot load test dataset vc2.csv!");
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt!");
+
+  arma::mat testData;
+  arma::Row<size_t> testLabels;
+  if (!data::Load("vc2_test.csv", testData))
+    FAIL("Cannot load test dataset vc2_test.csv!");
+  if (!data::Load("vc2_test_labels.txt", testLabels))
+    FAIL("Cannot load labels for vc2_test_labels.txt!");
+
+  GradientBoosting gb;
+  const double loss = gb.Train(dataset, labels, 3, 50, 0.1, 4, 5);
+  REQUIRE(std::isfinite(loss));
+  REQUIRE(gb.NumRounds() == 50);
+  REQUIRE(gb.NumTrees() == 150);
+
+  arma::Row<size_t> predictions;
+  gb.Classify(testData, predictions);
+  REQUIRE(arma::accu(predictions == testLabels) > 0.75 * testLabels.n_elem);
+
+  GradientBoosting sgb;
+  sgb.Train(dataset, labels, 3, 50, 0.1, 4, 5, 1.0, 0.0, 0.7, 0.7);
+  sgb.Classify(testData, predictions);
+  REQUIRE(arma::accu(predictions == testLabels) > 0.75 * testLabels.n_elem);
+}
+
+/**
+ * Compare GradientBoosting with RandomForest on the same data.  The accuracy of
+ * the boosted model must be at least close to that of the forest.
+ */
+TEST_CASE("GradientBoostingRandomForestComparisonTest",
+          "[GradientBoostingTest]")
+{
+  // Both models are randomized; fix the seed so the comparison is stable.
+  math::RandomSeed(42);
+
+  arma::mat dataset;
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2.csv", dataset))
+    FAIL("Cannot load test dataset vc2.csv!");
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt!");
+
+  arma::mat testData;
+  arma::Row<size_t> testLabels;
+  if (!data::Load("vc2_test.csv", testData))
+    FAIL("Cannot load test dataset vc2_test.csv!");
+  if (!data::Load("vc2_test_labels.txt", testLabels))
+    FAIL("Cannot load labels for vc2_test_labels.txt!");
+
+  arma::Row<size_t> predictions;
+
+  GradientBoosting gb(dataset, labels, 3, 50, 0.1, 4, 5);
+  gb.Classify(testData, predictions);
+  const double gbAccuracy = arma::accu(predictions == testLabels) /
+      double(testLabels.n_elem);
+
+  RandomForest<> rf(dataset, labels, 3, 50 /* 50 trees */, 5);
+  rf.Classify(testData, predictions);
+  const double rfAccuracy = arma::accu(predictions == testLabels) /
+      double(testLabels.n_elem);
+
+  REQUIRE(gbAccuracy >= rfAccuracy - 0.05);
+}
+
+/**
+ * Make sure that training stops when the validation loss stops improving, and
+ * that the model is cut back to its best round.
+ */
+TEST_CASE("GradientBoostingEarlyStoppingTest", "[GradientBoostingTest]")
+{
+  // Labels that are pure noise: the validation loss can only get worse after
+  // the first few rounds.
+  arma::mat data(3, 500, arma::fill::randu);
+  arma::Row<size_t> labels = arma::randi<arma::Row<size_t>>(500,
+      arma::distr_param(0, 1));
+  arma::mat validation(3, 500, arma::fill::randu);
+  arma::Row<size_t> validationLabels = arma::randi<arma::Row<size_t>>(500,
+      arma::distr_param(0, 1));
+
+  GradientBoosting gb;
+  const double loss = gb.Train(data, labels, 2, validation, validationLabels,
+      5, 1000, 0.3, 0, 1);
+  REQUIRE(gb.NumRounds() < 1000);
+  REQUIRE(std::isfinite(loss));
+
+  // The returned loss is the loss of the model that was kept.
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  gb.Classify(validation, predictions, probabilities);
+  double modelLoss = 0.0;
+  for (size_t i = 0; i < validationLabels.n_elem; ++i)
+    modelLoss -= std::log(probabilities(validationLabels[i], i));
+  modelLoss /= validationLabels.n_elem;
+  REQUIRE(modelLoss == Approx(loss).epsilon(1e-7));
+
+  // Bad validation sets are rejected.
+  REQUIRE_THROWS_AS(gb.Train(data, labels, 2, validation,
+      arma::Row<size_t>(10, arma::fill::zeros)), std::invalid_argument);
+  REQUIRE_THROWS_AS(gb.Train(data, labels, 2, arma::mat(2, 500,
+      arma::fill::randu), validationLabels), std::invalid_argument);
+}
+
+/**
+ * Make sure that invalid parameters and untrained models are rejected.
+ */
+TEST_CASE("GradientBoostingInvalidTest", "[GradientBoostingTest]")
+{
+  arma::mat data(3, 100, arma::fill::randu);
+  arma::Row<size_t> labels(100, arma::fill::zeros);
+  labels.subvec(50, 99).fill(1);
+
+  GradientBoosting gb;
+  arma::Row<size_t> predictions;
+  REQUIRE_THROWS_AS(gb.Classify(data, predictions), std::invalid_argument);
+
+  REQUIRE_THROWS_AS(gb.Train(data, labels, 1), std::invalid_argument);
+  REQUIRE_THROWS_AS(gb.Train(data, labels, 2, 10, 0.0),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(gb.Train(data, labels, 2, 10, 0.1, 6, 20, 1.0, 0.0, 1.5),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(gb.Train(data, labels.subvec(0, 49), 2),
+      std::invalid_argument);
+  labels[0] = 2;
+  REQUIRE_THROWS_AS(gb.Train(data, labels, 2), std::invalid_argument);
+}
+
+/**
+ * Make sure that a trained model survives serialization.
+ */
+TEST_CASE("GradientBoostingSerializationTest", "[GradientBoostingTest]")
+{
+  arma::mat dataset;
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2.csv", dataset))
+    FAIL("Cannot load test dataset vc2.csv!");
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt!");
+
+  GradientBoosting gb(dataset, labels, 3, 20);
+
+  arma::Row<size_t> beforePredictions;
+  arma::mat beforeProbabilities;
+  gb.Classify(dataset, beforePredictions, beforeProbabilities);
+
+  GradientBoosting xmlGb, jsonGb, binaryGb;
+  binaryGb.Train(dataset, labels, 3, 5);
+  SerializeObjectAll(gb, xmlGb, jsonGb, binaryGb);
+
+  REQUIRE(binaryGb.NumTrees() == gb.NumTrees());
+
+  arma::Row<size_t> xmlPredictions, jsonPredictions, binaryPredictions;
+  arma::mat xmlProbabilities, jsonProbabilities, binaryProbabilities;
+  xmlGb.Classify(dataset, xmlPredictions, xmlProbabilities);
+  jsonGb.Classify(dataset, jsonPredictions, jsonProbabilities);
+  binaryGb.Classify(dataset, binaryPredictions, binaryProbabilities);
+
+  CheckMatrices(beforePredictions, xmlPredictions, jsonPredictions,
+      binaryPredictions);
+  CheckMatrices(beforeProbabilities, xmlProbabilities, jsonProbabilities,
+      binaryProbabilities);
+}
+
+/**
+ * Make sure that the model does not depend on the number of threads.
+ */
+TEST_CASE("GradientBoostingDeterministicTest", "[GradientBoostingTest]")
+{
+  arma::mat data(20, 5000, arma::fill::randu);
+  arma::Row<size_t> labels(5000);
+  for (size_t i = 0; i < 5000; ++i)
+    labels[i] = (data(0, i) + data(7, i) > 1.0) ? 1 : 0;
+
+  #ifdef HAS_OPENMP
+  const int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+
+  math::RandomSeed(42);
+  GradientBoosting serial(data, labels, 2, 10, 0.1, 6, 20, 1.0, 0.0, 0.8,
+      0.5);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(std::max(maxThreads, 4));
+  #endif
+
+  math::RandomSeed(42);
+  GradientBoosting parallel(data, labels, 2, 10, 0.1, 6, 20, 1.0, 0.0, 0.8,
+      0.5);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(maxThreads);
+  #endif
+
+  arma::Row<size_t> serialPredictions, parallelPredictions;
+  arma::mat serialProbabilities, parallelProbabilities;
+  serial.Classify(data, serialPredictions, serialProbabilities);
+  parallel.Classify(data, parallelPredictions, parallelProbabilities);
+  REQUIRE(arma::all(serialPredictions == parallelPredictions));
+  REQUIRE(arma::approx_equal(serialProbabilities, parallelProbabilities,
+      "absdiff", 1e-12));
+}
@@ -1510,6 +1510,104 @@ TEST_CASE("HMMTrainReturnLogLikelihood", "[HMMTest]")
   REQUIRE(std::isfinite(loglik) == true);
 }
 
+/**
+ * Make sure that decoding and evaluating many sequences at once gives the same
+ * results as doing it one sequence at a time.
+ */
+TEST_CASE("HMMBatchPredictLogLikelihoodTest", "[HMMTest]")
+{
+  // Three states with one-dimensional Gaussian emissions.
+  std::vector<GaussianDistribution> emissions(3);
+  emissions[0] = GaussianDistribution("0.0", "1.0");
+  emissions[1] = GaussianDistribution("3.0", "0.5");
+  emissions[2] = GaussianDistribution("-4.0", "2.0");
+  arma::mat transition("0.8 0.1 0.3; 0.1 0.7 0.2; 0.1 0.2 0.5");
+  HMM<GaussianDistribution> hmm(arma::vec("0.5 0.3 0.2"), transition,
+      emissions);
+
+  std::vector<arma::mat> sequences(200);
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    hmm.Generate(math::RandInt(1, 30), sequences[i], states,
+        math::RandInt(3));
+  }
+
+  std::vector<arma::Row<size_t>> stateSequences;
+  arma::vec viterbiLogLikelihoods, logLikelihoods;
+  hmm.Predict(sequences, stateSequences, viterbiLogLikelihoods);
+  hmm.LogLikelihood(sequences, logLikelihoods);
+
+  REQUIRE(stateSequences.size() == sequences.size());
+  REQUIRE(viterbiLogLikelihoods.n_elem == sequences.size());
+  REQUIRE(logLikelihoods.n_elem == sequences.size());
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    const double viterbiLogLikelihood = hmm.Predict(sequences[i], states);
+    REQUIRE(arma::all(states == stateSequences[i]));
+    REQUIRE(viterbiLogLikelihoods[i] == Approx(viterbiLogLikelihood));
+    REQUIRE(logLikelihoods[i] == Approx(hmm.LogLikelihood(sequences[i])));
+
+    // The most likely state sequence cannot be more likely than the data.
+    REQUIRE(viterbiLogLikelihoods[i] <= logLikelihoods[i] + 1e-10);
+  }
+}
+
+/**
+ * Make sure that Baum-Welch training on many sequences does not depend on the
+ * number of threads.
+ */
+TEST_CASE("HMMBaumWelchDeterministicTest", "[HMMTest]")
+{
+  arma::mat transition("0.7 0.4; 0.3 0.6");
+  std::vector<DiscreteDistribution> emissions(2);
+  emissions[0].Probabilities() = arma::vec("0.6 0.3 0.1");
+  emissions[1].Probabilities() = arma::vec("0.1 0.2 0.7");
+  HMM<DiscreteDistribution> generator(arma::vec("0.5 0.5"), transition,
+      emissions);
+
+  std::vector<arma::mat> sequences(500);
+  for (size_t i = 0; i < sequences.size(); ++i)
+  {
+    arma::Row<size_t> states;
+    generator.Generate(math::RandInt(5, 20), sequences[i], states,
+        math::RandInt(2));
+  }
+
+  HMM<DiscreteDistribution> serial(2, DiscreteDistribution(3));
+  serial.Emission()[0].Probabilities() = arma::vec("0.4 0.4 0.2");
+  HMM<DiscreteDistribution> parallel(serial);
+
+  #ifdef HAS_OPENMP
+  const int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+
+  const double serialLoglik = serial.Train(sequences);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(std::max(maxThreads, 4));
+  #endif
+
+  const double parallelLoglik = parallel.Train(sequences);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(maxThreads);
+  #endif
+
+  REQUIRE(serialLoglik == Approx(parallelLoglik).epsilon(1e-12));
+  REQUIRE(arma::approx_equal(serial.Initial(), parallel.Initial(), "absdiff",
+      1e-12));
+  REQUIRE(arma::approx_equal(serial.Transition(), parallel.Transition(),
+      "absdiff", 1e-12));
+  for (size_t i = 0; i < 2; ++i)
+  {
+    REQUIRE(arma::approx_equal(serial.Emission()[i].Probabilities(),
+        parallel.Emission()[i].Probabilities(), "absdiff", 1e-12));
+  }
+}
+
 /********************************************/
 /** DiagonalGMM Hidden Markov Models Tests **/
 /********************************************/
@@ -2109,3 +2207,65 @@ TEST_CASE("DiagonalGMMHMMLoadSaveTest", "[HMMTest]")
     }
   }
 }
+
+/**
+ * Make sure that a left-to-right HMM whose states have log-probabilities
+ * thousands of nats apart gives the same log-likelihood as the forward
+ * algorithm computed directly in log space.  The transition matrix only lets
+ * the last state be reached from a state that is very unlikely at that time,
+ * which must not underflow.
+ */
+TEST_CASE("HMMLeftToRightFarApartTest", "[HMMTest]")
+{
+  std::vector<GaussianDistribution> emission;
+  emission.push_back(GaussianDistribution("0.0", "1.0"));
+  emission.push_back(GaussianDistribution("60.0", "1.0"));
+  emission.push_back(GaussianDistribution("120.0", "1.0"));
+
+  arma::vec initial("1 0 0");
+  arma::mat transition("0.9 0.0 0.0; 0.1 0.9 0.0; 0.0 0.1 1.0");
+  HMM<GaussianDistribution> hmm(initial, transition, emission);
+
+  // The observations jump from the first state to the last one.
+  arma::mat observations("0.1 -0.2 0.0 0.3 -0.1 120.2 119.8 120.1");
+
+  // Compute the forward algorithm in log space.
+  const double inf = std::numeric_limits<double>::infinity();
+  arma::vec forward(3);
+  for (size_t j = 0; j < 3; ++j)
+  {
+    forward[j] = std::log(initial[j]) +
+        emission[j].LogProbability(observations.col(0));
+  }
+
+  for (size_t t = 1; t < observations.n_cols; ++t)
+  {
+    arma::vec next(3);
+    for (size_t j = 0; j < 3; ++j)
+    {
+      double sum = -inf;
+      for (size_t i = 0; i < 3; ++i)
+        sum = math::LogAdd(sum, std::log(transition(j, i)) + forward[i]);
+
+      next[j] = sum + emission[j].LogProbability(observations.col(t));
+    }
+    forward = next;
+  }
+
+  const double logLikelihood = math::AccuLog(forward);
+  REQUIRE(std::isfinite(logLikelihood));
+  REQUIRE(hmm.LogLikelihood(observations) ==
+      Approx(logLikelihood).epsilon(1e-10));
+
+  // The state probabilities at the last time step are the normalized forward
+  // probabilities.
+  arma::mat stateProb;
+  hmm.Estimate(observations, stateProb);
+  REQUIRE(!stateProb.has_nan());
+  for (size_t j = 0; j < 3; ++j)
+  {
+    REQUIRE(stateProb(j, observations.n_cols - 1) ==
+        Approx(std::exp(forward[j] - logLikelihood)).epsilon(1e-8)
+        .margin(1e-12));
+  }
+}
@@ -1475,3 +1475,41 @@ TEST_CASE("HoeffdingTreeModelSerializationTest", "[HoeffdingTreeTest]")
     }
   }
 }
+
+/**
+ * Make sure that training on a file read in blocks gives the same tree as
+ * training on each point in turn.
+ */
+TEST_CASE("HoeffdingTreeBlockReaderTest", "[HoeffdingTreeTest]")
+{
+  arma::mat dataset(4, 5000, arma::fill::randu);
+  arma::Row<size_t> labels(5000);
+  for (size_t i = 0; i < 5000; ++i)
+    labels[i] = (dataset(1, i) > 0.5) ? 1 : 0;
+
+  data::Save("test_hoeffding.bin", dataset);
+  data::Save("test_hoeffding_labels.csv", labels);
+
+  data::DatasetInfo info(4);
+  HoeffdingTree<> streamTree(info, 2);
+  for (size_t i = 0; i < 5000; ++i)
+    streamTree.Train(dataset.col(i), labels[i]);
+
+  data::BlockReader reader("test_hoeffding.bin", 128);
+  data::BlockReader labelReader("test_hoeffding_labels.csv");
+  HoeffdingTree<> blockTree(info, 2);
+  blockTree.Train(reader, labelReader);
+
+  REQUIRE(blockTree.NumChildren() == streamTree.NumChildren());
+  REQUIRE(blockTree.NumChildren() > 0);
+  REQUIRE(blockTree.SplitDimension() == streamTree.SplitDimension());
+
+  arma::Row<size_t> streamPredictions, blockPredictions;
+  streamTree.Classify(dataset, streamPredictions);
+  blockTree.Classify(dataset, blockPredictions);
+  for (size_t i = 0; i < 5000; ++i)
+    REQUIRE(blockPredictions[i] == streamPredictions[i]);
+
+  remove("test_hoeffding.bin");
+  remove("test_hoeffding_labels.csv");
+}
@@ -424,6 +424,42 @@ TEST_CASE("KFNSingleTreeVsNaive", "[KFNTest]")
   }
 }
 
+/**
+ * Test the blocked brute-force furthest-neighbors method against the naive
+ * method, both with a query set and without one.
+ */
+TEST_CASE("KFNBruteForceVsNaive", "[KFNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 1300);
+  arma::mat querySet = arma::randu<arma::mat>(5, 400);
+
+  KFN bruteForce(dataset, BRUTE_FORCE_MODE);
+  KFN naive(dataset, NAIVE_MODE);
+
+  arma::Mat<size_t> neighborsBruteForce, neighborsNaive;
+  arma::mat distancesBruteForce, distancesNaive;
+
+  bruteForce.Search(querySet, 8, neighborsBruteForce, distancesBruteForce);
+  naive.Search(querySet, 8, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsNaive.n_elem; ++i)
+  {
+    REQUIRE(neighborsBruteForce[i] == neighborsNaive[i]);
+    REQUIRE(distancesBruteForce[i] ==
+        Approx(distancesNaive[i]).epsilon(1e-7));
+  }
+
+  bruteForce.Search(8, neighborsBruteForce, distancesBruteForce);
+  naive.Search(8, neighborsNaive, distancesNaive);
+
+  for (size_t i = 0; i < neighborsNaive.n_elem; ++i)
+  {
+    REQUIRE(neighborsBruteForce[i] == neighborsNaive[i]);
+    REQUIRE(distancesBruteForce[i] ==
+        Approx(distancesNaive[i]).epsilon(1e-7));
+  }
+}
+
 /**
  * Test the cover tree single-tree furthest-neighbors method against the naive
  * method.  This uses only a random reference dataset.
@@ -13,10 +13,12 @@
 #include <mlpack/methods/kmeans/allow_empty_clusters.hpp>
 #include <mlpack/methods/kmeans/refined_start.hpp>
 #include <mlpack/methods/kmeans/kmeans_plus_plus_initialization.hpp>
+#include <mlpack/methods/kmeans/kmeans_parallel_initialization.hpp>
 #include <mlpack/methods/kmeans/elkan_kmeans.hpp>
 #include <mlpack/methods/kmeans/hamerly_kmeans.hpp>
 #include <mlpack/methods/kmeans/pelleg_moore_kmeans.hpp>
 #include <mlpack/methods/kmeans/dual_tree_kmeans.hpp>
+#include <mlpack/methods/kmeans/mini_batch_kmeans.hpp>
 #include <mlpack/methods/kmeans/sample_initialization.hpp>
 #include <mlpack/methods/kmeans/random_partition.hpp>
 
@@ -553,6 +555,82 @@ TEST_CASE("KMeansPlusPlusTest", "[KMeansTest]")
   REQUIRE(distortion < 14500.0);
 }
 
+/**
+ * Test that the k-means|| initialization strategy returns decent initial
+ * cluster estimates, and that they don't depend on the number of threads.
+ */
+TEST_CASE("KMeansParallelInitializationTest", "[KMeansTest]")
+{
+  // The same five Gaussians as in KMeansPlusPlusTest.
+  arma::mat data(3, 3000);
+  data.randn();
+
+  arma::mat centroids(" 0  5 -2 -6  1;"
+                      " 0  0 -2  8  6;"
+                      " 0 -2 -2  8  1");
+
+  for (size_t i = 1000; i < 1200; ++i)
+    data.col(i) += centroids.col(1);
+  for (size_t i = 1200; i < 1700; ++i)
+    data.col(i) += centroids.col(2);
+  for (size_t i = 1700; i < 1800; ++i)
+    data.col(i) += centroids.col(3);
+  for (size_t i = 1800; i < 3000; ++i)
+    data.col(i) += centroids.col(4);
+
+  #ifdef HAS_OPENMP
+  const int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+  #endif
+
+  KMeansParallelInitialization k;
+  arma::mat resultingCentroids;
+  math::RandomSeed(42);
+  k.Cluster(data, 5, resultingCentroids);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(std::max(maxThreads, 4));
+  #endif
+
+  arma::mat parallelCentroids;
+  math::RandomSeed(42);
+  k.Cluster(data, 5, parallelCentroids);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(maxThreads);
+  #endif
+
+  REQUIRE(resultingCentroids.n_rows == 3);
+  REQUIRE(resultingCentroids.n_cols == 5);
+  REQUIRE(arma::approx_equal(resultingCentroids, parallelCentroids, "absdiff",
+      1e-12));
+
+  // Calculate sum of distances from the closest centroids.
+  double distortion = 0;
+  for (size_t i = 0; i < data.n_cols; ++i)
+  {
+    double bestDist = DBL_MAX;
+    for (size_t j = 0; j < 5; ++j)
+    {
+      bestDist = std::min(bestDist, metric::EuclideanDistance::Evaluate(
+          data.col(i), resultingCentroids.col(j)));
+    }
+    distortion += bestDist;
+  }
+
+  // This should be at least as good as k-means++.
+  REQUIRE(distortion < 14500.0);
+
+  // With only a few distinct points, every centroid is one of them.
+  arma::mat smallData(3, 20, arma::fill::zeros);
+  smallData.cols(10, 19).fill(1.0);
+  arma::mat smallCentroids;
+  k.Cluster(smallData, 4, smallCentroids);
+  REQUIRE(smallCentroids.n_cols == 4);
+  for (size_t i = 0; i < smallCentroids.n_elem; ++i)
+    REQUIRE((smallCentroids[i] == 0.0 || smallCentroids[i] == 1.0));
+}
+
 #ifdef ARMA_HAS_SPMAT
 /**
  * Make sure sparse k-means works okay.
@@ -800,3 +878,205 @@ TEST_CASE("SampleInitializationTest", "[KMeansTest]")
     REQUIRE(j < dataset.n_cols);
   }
 }
+
+/**
+ * Run k-means with the given Lloyd step type with the given number of threads,
+ * from the given initial centroids.
+ */
+template<template<class, class> class LloydStepType>
+void RunThreadedKMeans(const arma::mat& dataset,
+                       const int threads,
+                       arma::Row<size_t>& assignments,
+                       arma::mat& centroids)
+{
+  #ifdef HAS_OPENMP
+  const int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(threads);
+  #else
+  (void) threads;
+  #endif
+
+  KMeans<metric::EuclideanDistance, SampleInitialization,
+      MaxVarianceNewCluster, LloydStepType> kmeans;
+  kmeans.Cluster(dataset, centroids.n_cols, assignments, centroids, false,
+      true);
+
+  #ifdef HAS_OPENMP
+  omp_set_num_threads(maxThreads);
+  #endif
+}
+
+/**
+ * Make sure that the Elkan, Hamerly, Pelleg-Moore and dual-tree steps give the
+ * same clusters as the naive step with one thread when they are run with
+ * several threads.
+ */
+TEST_CASE("ParallelKMeansStepsTest", "[KMeansTest]")
+{
+  arma::mat dataset(5, 10000, arma::fill::randu);
+  arma::mat initialCentroids(5, 30, arma::fill::randu);
+
+  #ifdef HAS_OPENMP
+  const int threads = std::max(omp_get_max_threads(), 4);
+  #else
+  const int threads = 1;
+  #endif
+
+  arma::Row<size_t> naiveAssignments;
+  arma::mat naiveCentroids(initialCentroids);
+  RunThreadedKMeans<NaiveKMeans>(dataset, 1, naiveAssignments,
+      naiveCentroids);
+
+  arma::Row<size_t> elkanAssignments, hamerlyAssignments, pmAssignments,
+      dtAssignments, coverTreeAssignments;
+  arma::mat elkanCentroids(initialCentroids);
+  arma::mat hamerlyCentroids(initialCentroids);
+  arma::mat pmCentroids(initialCentroids);
+  arma::mat dtCentroids(initialCentroids);
+  arma::mat coverTreeCentroids(initialCentroids);
+  RunThreadedKMeans<ElkanKMeans>(dataset, threads, elkanAssignments,
+      elkanCentroids);
+  RunThreadedKMeans<HamerlyKMeans>(dataset, threads, hamerlyAssignments,
+      hamerlyCentroids);
+  RunThreadedKMeans<PellegMooreKMeans>(dataset, threads, pmAssignments,
+      pmCentroids);
+  RunThreadedKMeans<DefaultDualTreeKMeans>(dataset, threads, dtAssignments,
+      dtCentroids);
+  RunThreadedKMeans<CoverTreeDualTreeKMeans>(dataset, threads,
+      coverTreeAssignments, coverTreeCentroids);
+
+  REQUIRE(arma::all(naiveAssignments == elkanAssignments));
+  REQUIRE(arma::all(naiveAssignments == hamerlyAssignments));
+  REQUIRE(arma::all(naiveAssignments == pmAssignments));
+  REQUIRE(arma::all(naiveAssignments == dtAssignments));
+  REQUIRE(arma::all(naiveAssignments == coverTreeAssignments));
+
+  for (size_t i = 0; i < naiveCentroids.n_elem; ++i)
+  {
+    REQUIRE(elkanCentroids[i] == Approx(naiveCentroids[i]).epsilon(1e-7));
+    REQUIRE(hamerlyCentroids[i] == Approx(naiveCentroids[i]).epsilon(1e-7));
+    REQUIRE(pmCentroids[i] == Approx(naiveCentroids[i]).epsilon(1e-7));
+    REQUIRE(dtCentroids[i] == Approx(naiveCentroids[i]).epsilon(1e-7));
+    REQUIRE(coverTreeCentroids[i] ==
+        Approx(naiveCentroids[i]).epsilon(1e-7));
+  }
+}
+
+/**
+ * Make sure that mini-batch k-means on a file read in blocks finds
+ * well-separated clusters.
+ */
+TEST_CASE("MiniBatchKMeansBlockReaderTest", "[KMeansTest]")
+{
+  // Three well-separated Gaussians, with the points shuffled so that every
+  // block holds points of every cluster.
+  arma::mat means("0.0 10.0 -10.0;"
+                  "0.0 10.0 5.0");
+  arma::mat dataset(2, 3000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset.col(i) = means.col(i % 3) + 0.3 * arma::randn<arma::vec>(2);
+  data::Save("test_minibatch.bin", dataset);
+
+  data::BlockReader reader("test_minibatch.bin", 100);
+
+  // Start from centroids that are off, and make sure they move to the means.
+  arma::mat centroids = means + 2.0;
+  KMeans<> kmeans(20);
+  kmeans.Cluster(reader, 3, centroids, true);
+
+  REQUIRE(centroids.n_rows == 2);
+  REQUIRE(centroids.n_cols == 3);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    REQUIRE(metric::EuclideanDistance::Evaluate(centroids.col(i),
+        means.col(i)) < 0.1);
+  }
+
+  // The initial centroids can also be taken from the first block.
+  arma::mat sampledCentroids;
+  kmeans.Cluster(reader, 3, sampledCentroids);
+  REQUIRE(sampledCentroids.n_rows == 2);
+  REQUIRE(sampledCentroids.n_cols == 3);
+
+  remove("test_minibatch.bin");
+}
+
+/**
+ * Make sure that the mini-batch k-means step finds well-separated clusters,
+ * both with small mini-batches and with the whole dataset.
+ */
+TEST_CASE("MiniBatchKMeansStepTest", "[KMeansTest]")
+{
+  arma::mat means("0.0 10.0 -10.0;"
+                  "0.0 10.0 5.0");
+  arma::mat dataset(2, 3000);
+  arma::Row<size_t> trueAssignments(3000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+  {
+    trueAssignments[i] = i % 3;
+    dataset.col(i) = means.col(i % 3) + 0.3 * arma::randn<arma::vec>(2);
+  }
+
+  for (const size_t batchSize : { (size_t) 100, (size_t) 0 })
+  {
+    KMeans<metric::EuclideanDistance, SampleInitialization,
+        MaxVarianceNewCluster, MiniBatchKMeans> kmeans(100);
+    kmeans.BatchSize() = batchSize;
+    REQUIRE(kmeans.BatchSize() == batchSize);
+
+    arma::Row<size_t> assignments;
+    arma::mat centroids = means + 2.0;
+    kmeans.Cluster(dataset, 3, assignments, centroids, false, true);
+
+    REQUIRE(centroids.n_cols == 3);
+    for (size_t i = 0; i < 3; ++i)
+    {
+      REQUIRE(metric::EuclideanDistance::Evaluate(centroids.col(i),
+          means.col(i)) < 0.2);
+    }
+    REQUIRE(arma::all(assignments == trueAssignments));
+  }
+}
+
+/**
+ * Make sure that the batch size is serialized, and that KMeans objects saved
+ * before it was serialized (version 0) get the default batch size.
+ */
+TEST_CASE("KMeansBatchSizeSerializationTest", "[KMeansTest]")
+{
+  KMeans<> kmeans(50);
+  kmeans.BatchSize() = 17;
+
+  std::ostringstream oss;
+  {
+    cereal::JSONOutputArchive ar(oss);
+    ar(cereal::make_nvp("kmeans", kmeans));
+  }
+  std::string json = oss.str();
+
+  KMeans<> loaded;
+  loaded.BatchSize() = 5;
+  {
+    std::istringstream iss(json);
+    cereal::JSONInputArchive ar(iss);
+    ar(cereal::make_nvp("kmeans", loaded));
+  }
+  REQUIRE(loaded.MaxIterations() == 50);
+  REQUIRE(loaded.BatchSize() == 17);
+
+  // The first version number in the archive is the one of the KMeans object.
+  const std::string version = "\"cereal_class_version\": 1";
+  const size_t position = json.find(version);
+  REQUIRE(position != std::string::npos);
+  json.replace(position, version.size(), "\"cereal_class_version\": 0");
+
+  KMeans<> oldLoaded;
+  oldLoaded.BatchSize() = 5;
+  {
+    std::istringstream iss(json);
+    cereal::JSONInputArchive ar(iss);
+    ar(cereal::make_nvp("kmeans", oldLoaded));
+  }
+  REQUIRE(oldLoaded.MaxIterations() == 50);
+  REQUIRE(oldLoaded.BatchSize() == 1024);
+}
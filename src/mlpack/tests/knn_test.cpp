@@ -718,6 +718,218 @@ TEST_CASE("KNNDualTreeVsNaive2", "[KNNTest]")
   }
 }
 
+/**
+ * Test that the parallel dual-tree search gives the same results as the
+ * regular dual-tree search, both with a query set and without one.
+ */
+TEST_CASE("KNNParallelDualTreeVsDualTree", "[KNNTest]")
+{
+  arma::mat dataset;
+  if (!data::Load("test_data_3_1000.csv", dataset))
+    FAIL("Cannot load test dataset test_data_3_1000.csv!");
+
+  arma::mat querySet = arma::randu<arma::mat>(3, 300);
+
+  KNN knn(dataset);
+  KNN parallelKnn(dataset, PARALLEL_DUAL_TREE_MODE);
+
+  arma::Mat<size_t> neighbors, parallelNeighbors;
+  arma::mat distances, parallelDistances;
+
+  knn.Search(querySet, 10, neighbors, distances);
+  parallelKnn.Search(querySet, 10, parallelNeighbors, parallelDistances);
+
+  CheckMatrices(neighbors, parallelNeighbors);
+  CheckMatrices(distances, parallelDistances);
+
+  // Now run the search twice in monochromatic mode, so that the tree bounds
+  // have to be reset too.
+  for (size_t trial = 0; trial < 2; ++trial)
+  {
+    knn.Search(10, neighbors, distances);
+    parallelKnn.Search(10, parallelNeighbors, parallelDistances);
+
+    CheckMatrices(neighbors, parallelNeighbors);
+    CheckMatrices(distances, parallelDistances);
+  }
+}
+
+/**
+ * Make sure that NeighborSearch gives correct results with a reference tree
+ * whose nodes were moved into one block.
+ */
+TEST_CASE("KNNCompactTreeTest", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 1000);
+
+  KNN knn(dataset);
+  KNN naive(dataset, NAIVE_MODE);
+  REQUIRE(!knn.ReferenceTree().IsCompact());
+  knn.ReferenceTree().CompactNodes();
+  REQUIRE(knn.ReferenceTree().IsCompact());
+
+  arma::Mat<size_t> neighbors, naiveNeighbors;
+  arma::mat distances, naiveDistances;
+  knn.Search(dataset, 5, neighbors, distances);
+  naive.Search(dataset, 5, naiveNeighbors, naiveDistances);
+
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+/**
+ * Test that the single-tree, greedy single-tree and naive searches give the
+ * same results with several OpenMP threads as with one thread, both with a
+ * query set and without one.
+ */
+TEST_CASE("KNNParallelSingleTreeVsSerial", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 2000);
+  arma::mat querySet = arma::randu<arma::mat>(4, 500);
+
+  const NeighborSearchMode modes[] = { NAIVE_MODE, SINGLE_TREE_MODE,
+      GREEDY_SINGLE_TREE_MODE };
+  for (size_t m = 0; m < 3; ++m)
+  {
+    KNN knn(dataset, modes[m]);
+
+    arma::Mat<size_t> neighbors, parallelNeighbors;
+    arma::mat distances, parallelDistances;
+    arma::Mat<size_t> monoNeighbors, parallelMonoNeighbors;
+    arma::mat monoDistances, parallelMonoDistances;
+
+    #ifdef HAS_OPENMP
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    #endif
+
+    knn.Search(querySet, 10, neighbors, distances);
+    knn.Search(10, monoNeighbors, monoDistances);
+
+    #ifdef HAS_OPENMP
+    omp_set_num_threads(std::max(maxThreads, 4));
+    #endif
+
+    knn.Search(querySet, 10, parallelNeighbors, parallelDistances);
+    knn.Search(10, parallelMonoNeighbors, parallelMonoDistances);
+
+    #ifdef HAS_OPENMP
+    omp_set_num_threads(maxThreads);
+    #endif
+
+    CheckMatrices(neighbors, parallelNeighbors);
+    CheckMatrices(distances, parallelDistances);
+    CheckMatrices(monoNeighbors, parallelMonoNeighbors);
+    CheckMatrices(monoDistances, parallelMonoDistances);
+  }
+}
+
+/**
+ * Test that the blocked brute-force search gives the same results as the naive
+ * search, both with a query set and without one.  The datasets are larger than
+ * a single block so that several blocks are used.
+ */
+TEST_CASE("KNNBruteForceVsNaive", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(10, 1500);
+  arma::mat querySet = arma::randu<arma::mat>(10, 600);
+
+  KNN naive(dataset, NAIVE_MODE);
+  KNN bruteForce(dataset, BRUTE_FORCE_MODE);
+
+  arma::Mat<size_t> naiveNeighbors, bruteForceNeighbors;
+  arma::mat naiveDistances, bruteForceDistances;
+
+  naive.Search(querySet, 10, naiveNeighbors, naiveDistances);
+  bruteForce.Search(querySet, 10, bruteForceNeighbors, bruteForceDistances);
+
+  CheckMatrices(naiveNeighbors, bruteForceNeighbors);
+  CheckMatrices(naiveDistances, bruteForceDistances);
+  REQUIRE(bruteForce.BaseCases() == 600 * 1500);
+
+  naive.Search(10, naiveNeighbors, naiveDistances);
+  bruteForce.Search(10, bruteForceNeighbors, bruteForceDistances);
+
+  CheckMatrices(naiveNeighbors, bruteForceNeighbors);
+  CheckMatrices(naiveDistances, bruteForceDistances);
+}
+
+/**
+ * Test that the blocked brute-force search gives the same results as the naive
+ * search with a metric that does not use matrix multiplications.
+ */
+TEST_CASE("KNNBruteForceManhattanVsNaive", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(4, 1200);
+
+  NeighborSearch<NearestNeighborSort, ManhattanDistance> naive(dataset,
+      NAIVE_MODE);
+  NeighborSearch<NearestNeighborSort, ManhattanDistance> bruteForce(dataset,
+      BRUTE_FORCE_MODE);
+
+  arma::Mat<size_t> naiveNeighbors, bruteForceNeighbors;
+  arma::mat naiveDistances, bruteForceDistances;
+
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  bruteForce.Search(5, bruteForceNeighbors, bruteForceDistances);
+
+  CheckMatrices(naiveNeighbors, bruteForceNeighbors);
+  CheckMatrices(naiveDistances, bruteForceDistances);
+}
+
+/**
+ * Test that the blocked brute-force search gives the same results as the naive
+ * search on near-duplicate points far from the origin, where the distances
+ * computed with matrix multiplications are dominated by roundoff error.
+ */
+TEST_CASE("KNNBruteForceNearDuplicatesVsNaive", "[KNNTest]")
+{
+  arma::mat dataset = 1e-5 * arma::randu<arma::mat>(3, 1500);
+  dataset.each_col() += arma::vec("1e5 -2e5 3e5");
+  arma::mat querySet = 1e-5 * arma::randu<arma::mat>(3, 300);
+  querySet.each_col() += arma::vec("1e5 -2e5 3e5");
+
+  KNN naive(dataset, NAIVE_MODE);
+  KNN bruteForce(dataset, BRUTE_FORCE_MODE);
+
+  arma::Mat<size_t> naiveNeighbors, bruteForceNeighbors;
+  arma::mat naiveDistances, bruteForceDistances;
+
+  naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+  bruteForce.Search(querySet, 5, bruteForceNeighbors, bruteForceDistances);
+
+  CheckMatrices(naiveNeighbors, bruteForceNeighbors);
+  CheckMatrices(naiveDistances, bruteForceDistances);
+
+  naive.Search(5, naiveNeighbors, naiveDistances);
+  bruteForce.Search(5, bruteForceNeighbors, bruteForceDistances);
+
+  CheckMatrices(naiveNeighbors, bruteForceNeighbors);
+  CheckMatrices(naiveDistances, bruteForceDistances);
+}
+
+/**
+ * Test that the parallel dual-tree search works with cover trees, whose
+ * traverser is quite different from the kd-tree traverser.
+ */
+TEST_CASE("KNNParallelDualCoverTreeTest", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(5, 500);
+
+  KNN naive(dataset, NAIVE_MODE);
+  NeighborSearch<NearestNeighborSort, EuclideanDistance, arma::mat,
+      StandardCoverTree> coverTreeSearch(dataset, PARALLEL_DUAL_TREE_MODE);
+
+  arma::Mat<size_t> naiveNeighbors, coverNeighbors;
+  arma::mat naiveDistances, coverDistances;
+
+  naive.Search(7, naiveNeighbors, naiveDistances);
+  coverTreeSearch.Search(7, coverNeighbors, coverDistances);
+
+  CheckMatrices(naiveNeighbors, coverNeighbors);
+  CheckMatrices(naiveDistances, coverDistances);
+}
+
 /**
  * Test the single-tree nearest-neighbors method with the naive method.  This
  * uses only a reference dataset.
@@ -1816,3 +2028,198 @@ TEST_CASE("KNNSpillTreeSearchEnoughResults", "[KNNTest]")
   REQUIRE(arma::accu(distancesGreedy < 0.0 || distancesGreedy > std::sqrt(3.0))
       == 0);
 }
+
+/**
+ * Insert points into and remove points from the reference set of a tree-based
+ * search, and make sure that the results are the same as naive search on the
+ * modified dataset.
+ */
+TEST_CASE("KNNInsertRemoveTest", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 200);
+  const NeighborSearchMode modes[] = { DUAL_TREE_MODE, SINGLE_TREE_MODE,
+      NAIVE_MODE };
+
+  for (size_t m = 0; m < 3; ++m)
+  {
+    arma::mat current = dataset;
+    KNN knn(dataset, modes[m]);
+
+    // Enough insertions to merge levels and to rebuild the reference tree.
+    for (size_t round = 0; round < 12; ++round)
+    {
+      arma::mat points = arma::randu<arma::mat>(3, 10 + 5 * round);
+      knn.Insert(points);
+      current = arma::join_rows(current, points);
+
+      std::vector<size_t> indices;
+      for (size_t i = round; i < current.n_cols; i += 13)
+        indices.push_back(i);
+      knn.Remove(indices);
+      current.shed_cols(arma::conv_to<arma::uvec>::from(indices));
+
+      REQUIRE(knn.NumReferencePoints() == current.n_cols);
+
+      KNN naive(current, NAIVE_MODE);
+      arma::mat querySet = arma::randu<arma::mat>(3, 50);
+      arma::Mat<size_t> neighbors, naiveNeighbors;
+      arma::mat distances, naiveDistances;
+
+      knn.Search(querySet, 5, neighbors, distances);
+      naive.Search(querySet, 5, naiveNeighbors, naiveDistances);
+      CheckMatrices(neighbors, naiveNeighbors);
+      CheckMatrices(distances, naiveDistances);
+
+      // Monochromatic search.
+      knn.Search(5, neighbors, distances);
+      naive.Search(5, naiveNeighbors, naiveDistances);
+      CheckMatrices(neighbors, naiveNeighbors);
+      CheckMatrices(distances, naiveDistances);
+    }
+  }
+}
+
+/**
+ * Remove a cluster of many more than k points around the query points, without
+ * triggering a rebuild of the reference tree, and make sure that the k nearest
+ * live points are still found.
+ */
+TEST_CASE("KNNRemoveClusterTest", "[KNNTest]")
+{
+  arma::mat dataset(1, 1000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset(0, i) = (double) i;
+
+  std::vector<size_t> indices;
+  for (size_t i = 400; i < 600; ++i)
+    indices.push_back(i);
+
+  arma::mat current = dataset;
+  current.shed_cols(400, 599);
+  KNN naive(current, NAIVE_MODE);
+
+  arma::mat querySet = arma::linspace<arma::rowvec>(450.0, 550.0, 21);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(querySet, 3, naiveNeighbors, naiveDistances);
+
+  const NeighborSearchMode modes[] = { DUAL_TREE_MODE, SINGLE_TREE_MODE };
+  for (size_t m = 0; m < 2; ++m)
+  {
+    KNN knn(dataset, modes[m]);
+    knn.Remove(indices);
+    REQUIRE(knn.NumReferencePoints() == current.n_cols);
+
+    arma::Mat<size_t> neighbors;
+    arma::mat distances;
+    knn.Search(querySet, 3, neighbors, distances);
+    CheckMatrices(neighbors, naiveNeighbors);
+    CheckMatrices(distances, naiveDistances);
+  }
+}
+
+/**
+ * Remove points from a model whose reference tree was built, then switch it to
+ * brute-force search, and make sure that the removed points are not returned.
+ */
+TEST_CASE("KNNRemoveBruteForceTest", "[KNNTest]")
+{
+  arma::mat dataset(1, 1000);
+  for (size_t i = 0; i < dataset.n_cols; ++i)
+    dataset(0, i) = (double) i;
+
+  std::vector<size_t> indices;
+  for (size_t i = 400; i < 600; ++i)
+    indices.push_back(i);
+
+  arma::mat current = dataset;
+  current.shed_cols(400, 599);
+  KNN naive(current, NAIVE_MODE);
+
+  arma::mat querySet = arma::linspace<arma::rowvec>(450.0, 550.0, 21);
+  arma::Mat<size_t> naiveNeighbors;
+  arma::mat naiveDistances;
+  naive.Search(querySet, 3, naiveNeighbors, naiveDistances);
+
+  KNN knn(dataset, DUAL_TREE_MODE);
+  knn.Remove(indices);
+  knn.SearchMode() = BRUTE_FORCE_MODE;
+
+  arma::Mat<size_t> neighbors;
+  arma::mat distances;
+  knn.Search(querySet, 3, neighbors, distances);
+  CheckMatrices(neighbors, naiveNeighbors);
+  CheckMatrices(distances, naiveDistances);
+}
+
+/**
+ * Make sure that removing a point outside of the reference set throws.
+ */
+TEST_CASE("KNNRemoveInvalidTest", "[KNNTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 100);
+  KNN knn(dataset);
+  knn.Insert(arma::randu<arma::mat>(3, 10));
+
+  REQUIRE_THROWS_AS(knn.Remove(std::vector<size_t>(1, 110)),
+      std::invalid_argument);
+  REQUIRE_THROWS_AS(knn.Insert(arma::randu<arma::mat>(4, 10)),
+      std::invalid_argument);
+  REQUIRE(knn.NumReferencePoints() == 110);
+}
+
+/**
+ * Save the reference tree of a KNNModel in the flat tree format, load it into
+ * another model, and make sure that the results are the same.
+ */
+TEST_CASE("KNNModelFlatSaveLoadTest", "[KNNTest]")
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat referenceData = arma::randu<arma::mat>(4, 600);
+  arma::mat queryData = arma::randu<arma::mat>(4, 100);
+
+  const KNNModel::TreeTypes treeTypes[] = {
+      KNNModel::TreeTypes::KD_TREE,
+      KNNModel::TreeTypes::BALL_TREE,
+      KNNModel::TreeTypes::VP_TREE,
+      KNNModel::TreeTypes::RP_TREE,
+      KNNModel::TreeTypes::COVER_TREE };
+  for (size_t t = 0; t < 5; ++t)
+  {
+    KNNModel model(treeTypes[t]);
+    model.BuildModel(arma::mat(referenceData), DUAL_TREE_MODE);
+    model.SaveFlat("test_flat_tree.bin");
+
+    KNNModel loadedModel(treeTypes[t]);
+    loadedModel.LoadFlat("test_flat_tree.bin", DUAL_TREE_MODE);
+    REQUIRE(loadedModel.Dataset().n_cols == referenceData.n_cols);
+
+    arma::Mat<size_t> neighbors, loadedNeighbors;
+    arma::mat distances, loadedDistances;
+    model.Search(arma::mat(queryData), 5, neighbors, distances);
+    loadedModel.Search(arma::mat(queryData), 5, loadedNeighbors,
+        loadedDistances);
+    CheckMatrices(neighbors, loadedNeighbors);
+    CheckMatrices(distances, loadedDistances);
+
+    // Copies of the loaded model own their data.
+    KNNModel copy(loadedModel);
+    loadedModel = KNNModel(treeTypes[t]);
+    copy.Search(5, loadedNeighbors, loadedDistances);
+    model.Search(5, neighbors, distances);
+    CheckMatrices(neighbors, loadedNeighbors);
+    CheckMatrices(distances, loadedDistances);
+  }
+
+  // Other trees have no flat format.
+  KNNModel rTreeModel(KNNModel::TreeTypes::R_TREE);
+  rTreeModel.BuildModel(arma::mat(referenceData), DUAL_TREE_MODE);
+  REQUIRE_THROWS_AS(rTreeModel.SaveFlat("test_flat_tree.bin"),
+      std::invalid_argument);
+  KNNModel rTreeLoadedModel(KNNModel::TreeTypes::R_TREE);
+  REQUIRE_THROWS_AS(rTreeLoadedModel.LoadFlat("test_flat_tree.bin",
+      DUAL_TREE_MODE), std::invalid_argument);
+
+  remove("test_flat_tree.bin");
+}
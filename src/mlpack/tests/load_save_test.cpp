@@ -13,6 +13,8 @@
 
 #include <mlpack/core.hpp>
 #include <mlpack/core/data/load_arff.hpp>
+#include <mlpack/core/data/block_reader.hpp>
+#include <mlpack/core/data/columnar_dataset.hpp>
 #include <mlpack/core/data/map_policies/missing_policy.hpp>
 #include "catch.hpp"
 #include "test_catch_tools.hpp"
@@ -2504,3 +2506,373 @@ TEST_CASE("LoadCSVHeaderTest", "[LoadSaveTest]")
   REQUIRE(dataset.n_rows == 4);
   REQUIRE(dataset.n_cols == 2);
 }
+
+/**
+ * Test that a file large enough to be split into many chunks is loaded in
+ * parallel with the same values and mappings as a sequential pass would give.
+ */
+TEST_CASE("ParallelLoadCSVLargeTest", "[LoadSaveTest]")
+{
+  // Categories first appear in a different order than their names, and the
+  // last dimension only becomes categorical near the end of the file.
+  const size_t points = 50000;
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < points; ++i)
+  {
+    f << ((i % 1000) / 8.0) << ", cat" << ((i * 7) % 13) << " ,"
+        << ((i == points - 10) ? std::string("none") : std::to_string(i % 5))
+        << endl;
+  }
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo di;
+  REQUIRE(data::Load("test.csv", dataset, di, true));
+
+  REQUIRE(dataset.n_rows == 3);
+  REQUIRE(dataset.n_cols == points);
+  REQUIRE(di.Type(0) == Datatype::numeric);
+  REQUIRE(di.Type(1) == Datatype::categorical);
+  REQUIRE(di.Type(2) == Datatype::categorical);
+  REQUIRE(di.NumMappings(1) == 13);
+  REQUIRE(di.NumMappings(2) == 6);
+
+  // The mappings are given in order of first appearance.
+  std::vector<size_t> firstCategory(13, 0);
+  for (size_t i = 0; i < 13; ++i)
+    firstCategory[(i * 7) % 13] = i;
+
+  for (size_t i = 0; i < points; ++i)
+  {
+    REQUIRE(dataset(0, i) == (i % 1000) / 8.0);
+    REQUIRE(dataset(1, i) == firstCategory[(i * 7) % 13]);
+    if (i == points - 10)
+      REQUIRE(dataset(2, i) == 5);
+    else
+      REQUIRE(dataset(2, i) == i % 5);
+  }
+  REQUIRE(di.UnmapString(0, 1) == "cat0");
+  REQUIRE(di.UnmapString(5, 2) == "none");
+
+  // Without a DatasetMapper, the numeric dimension can be loaded on its own.
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < points; ++i)
+    f << ((i % 1000) / 8.0) << "," << (i % 5) << endl;
+  f.close();
+
+  arma::mat numeric;
+  REQUIRE(data::Load("test.csv", numeric, true));
+  REQUIRE(numeric.n_rows == 2);
+  REQUIRE(numeric.n_cols == points);
+  for (size_t i = 0; i < points; ++i)
+  {
+    REQUIRE(numeric(0, i) == (i % 1000) / 8.0);
+    REQUIRE(numeric(1, i) == i % 5);
+  }
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure that a CSV file read in blocks gives the same points as a full
+ * load, and that the reader can be reset.
+ */
+TEST_CASE("BlockReaderCSVTest", "[LoadSaveTest]")
+{
+  arma::mat points(3, 107, arma::fill::randu);
+  REQUIRE(data::Save("test.csv", points));
+
+  arma::mat loaded;
+  REQUIRE(data::Load("test.csv", loaded));
+
+  data::BlockReader reader("test.csv", 10);
+  REQUIRE(reader.Dimensionality() == 3);
+
+  for (size_t pass = 0; pass < 2; ++pass)
+  {
+    reader.Reset();
+    arma::mat block;
+    size_t blocks = 0;
+    while (reader.NextBlock(block))
+    {
+      REQUIRE(block.n_rows == 3);
+      REQUIRE(block.n_cols == ((blocks < 10) ? 10 : 7));
+      for (size_t i = 0; i < block.n_cols; ++i)
+        for (size_t d = 0; d < 3; ++d)
+          REQUIRE(block(d, i) == loaded(d, blocks * 10 + i));
+      ++blocks;
+    }
+
+    REQUIRE(blocks == 11);
+    REQUIRE(reader.PointsRead() == 107);
+    REQUIRE(block.n_cols == 0);
+  }
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure that non-numeric tokens of a CSV file read in blocks are mapped
+ * with the given DatasetInfo.
+ */
+TEST_CASE("BlockReaderCSVCategoricalTest", "[LoadSaveTest]")
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  f << "1, a, 2" << endl;
+  f << "3, b, 4" << endl;
+  f << "5, a, 6" << endl;
+  f << "7, c, 8" << endl;
+  f.close();
+
+  arma::mat loaded;
+  DatasetInfo info;
+  REQUIRE(data::Load("test.csv", loaded, info));
+
+  data::BlockReader reader("test.csv", info, 3);
+  arma::mat block;
+  REQUIRE(reader.NextBlock(block));
+  REQUIRE(block.n_cols == 3);
+  REQUIRE(reader.NextBlock(block));
+  REQUIRE(block.n_cols == 1);
+  REQUIRE(block(0, 0) == 7.0);
+  REQUIRE(block(1, 0) == loaded(1, 3));
+  REQUIRE(block(2, 0) == 8.0);
+  REQUIRE(!reader.NextBlock(block));
+
+  // A line with the wrong number of tokens is an error.
+  f.open("test.csv", fstream::out);
+  f << "1, 2, 3" << endl;
+  f << "4, 5" << endl;
+  f.close();
+
+  data::BlockReader badReader("test.csv", 5);
+  REQUIRE_THROWS_AS(badReader.NextBlock(block), std::runtime_error);
+
+  remove("test.csv");
+}
+
+/**
+ * Make sure that an ARFF file read in blocks gives the same points and
+ * categories as a full load.
+ */
+TEST_CASE("BlockReaderARFFTest", "[LoadSaveTest]")
+{
+  fstream f;
+  f.open("test.arff", fstream::out);
+  f << "@relation test" << endl;
+  f << endl;
+  f << "@attribute one NUMERIC" << endl;
+  f << "@attribute two {red, green, blue}" << endl;
+  f << endl;
+  f << "@data" << endl;
+  f << "1, blue" << endl;
+  f << "2, red" << endl;
+  f << "3, green" << endl;
+  f << "4, blue" << endl;
+  f << "5, red" << endl;
+  f.close();
+
+  arma::mat loaded;
+  DatasetInfo info;
+  REQUIRE(data::Load("test.arff", loaded, info));
+
+  data::BlockReader reader("test.arff", 2);
+  REQUIRE(reader.Dimensionality() == 2);
+  REQUIRE(reader.Info().Type(1) == Datatype::categorical);
+  REQUIRE(reader.Info().NumMappings(1) == 3);
+
+  arma::mat block;
+  size_t points = 0;
+  while (reader.NextBlock(block))
+  {
+    REQUIRE(block.n_cols <= 2);
+    for (size_t i = 0; i < block.n_cols; ++i)
+    {
+      REQUIRE(block(0, i) == loaded(0, points + i));
+      REQUIRE(block(1, i) == loaded(1, points + i));
+    }
+    points += block.n_cols;
+  }
+  REQUIRE(points == 5);
+
+  remove("test.arff");
+}
+
+/**
+ * Make sure that an Armadillo binary file read in blocks gives the same points
+ * as a full load, in both orientations.
+ */
+TEST_CASE("BlockReaderBinaryTest", "[LoadSaveTest]")
+{
+  arma::mat dataset(4, 53, arma::fill::randn);
+  REQUIRE(data::Save("test.bin", dataset));
+
+  arma::mat block;
+  data::BlockReader reader("test.bin", 20);
+  REQUIRE(reader.Dimensionality() == 4);
+  size_t points = 0;
+  while (reader.NextBlock(block))
+  {
+    REQUIRE(arma::approx_equal(block, dataset.cols(points,
+        points + block.n_cols - 1), "absdiff", 0.0));
+    points += block.n_cols;
+  }
+  REQUIRE(points == 53);
+
+  // Without transposing, each column of the stored matrix is a point.
+  REQUIRE(data::Save("test.bin", dataset, true, false));
+  data::BlockReader untransposedReader("test.bin", 20, false);
+  REQUIRE(untransposedReader.Dimensionality() == 4);
+  points = 0;
+  while (untransposedReader.NextBlock(block))
+  {
+    REQUIRE(arma::approx_equal(block, dataset.cols(points,
+        points + block.n_cols - 1), "absdiff", 0.0));
+    points += block.n_cols;
+  }
+  REQUIRE(points == 53);
+
+  // Labels can be read alongside points.
+  arma::Row<size_t> labels = arma::linspace<arma::Row<size_t>>(0, 52, 53);
+  REQUIRE(data::Save("test_labels.csv", labels));
+  reader.Reset();
+  data::BlockReader labelReader("test_labels.csv", 7);
+  arma::Row<size_t> blockLabels;
+  points = 0;
+  while (data::NextLabeledBlock(reader, labelReader, block, blockLabels))
+  {
+    REQUIRE(blockLabels.n_elem == block.n_cols);
+    for (size_t i = 0; i < blockLabels.n_elem; ++i)
+      REQUIRE(blockLabels[i] == points + i);
+    points += block.n_cols;
+  }
+  REQUIRE(points == 53);
+
+  remove("test.bin");
+  remove("test_labels.csv");
+}
+
+/**
+ * Make sure that a dataset saved in the columnar format with a DatasetInfo is
+ * loaded back with the same values and mappings.
+ */
+TEST_CASE("ColumnarDatasetRoundTripTest", "[LoadSaveTest]")
+{
+  fstream f;
+  f.open("test.csv", fstream::out);
+  for (size_t i = 0; i < 500; ++i)
+  {
+    f << (i / 7.0) << ", cat" << (i % 11) << ", " << (i % 300) << ", "
+        << ((i % 2 == 0) ? "yes" : "no") << endl;
+  }
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo info;
+  REQUIRE(data::Load("test.csv", dataset, info));
+  REQUIRE(data::Save("test.mlds", dataset, info));
+
+  arma::mat loaded;
+  DatasetInfo loadedInfo;
+  REQUIRE(data::Load("test.mlds", loaded, loadedInfo));
+
+  REQUIRE(loaded.n_rows == 4);
+  REQUIRE(loaded.n_cols == 500);
+  REQUIRE(arma::approx_equal(loaded, dataset, "absdiff", 0.0));
+  REQUIRE(loadedInfo.Dimensionality() == 4);
+  for (size_t d = 0; d < 4; ++d)
+  {
+    REQUIRE(loadedInfo.Type(d) == info.Type(d));
+    REQUIRE(loadedInfo.NumMappings(d) == info.NumMappings(d));
+  }
+  for (size_t i = 0; i < 11; ++i)
+  {
+    REQUIRE(loadedInfo.UnmapString(i, 1) == info.UnmapString(i, 1));
+    REQUIRE(loadedInfo.MapString<double>("cat" + std::to_string(i), 1) ==
+        info.MapString<double>("cat" + std::to_string(i), 1));
+  }
+
+  // Small integers are stored in narrower types; other values are not.
+  data::ColumnarDataset file("test.mlds");
+  REQUIRE(file.Dimensionality() == 4);
+  REQUIRE(file.NumPoints() == 500);
+  REQUIRE(file.Codec(0) == data::RAW_CODEC);
+  REQUIRE(file.Codec(1) == data::UINT8_CODEC);
+  REQUIRE(file.Codec(2) == data::UINT16_CODEC);
+  REQUIRE(file.Codec(3) == data::UINT8_CODEC);
+
+  // Uncompressed dimensions can be used in place.
+  const arma::rowvec first = file.Dimension<double>(0);
+  REQUIRE(arma::approx_equal(first, dataset.row(0), "absdiff", 0.0));
+  REQUIRE_THROWS_AS(file.Dimension<double>(1), std::runtime_error);
+
+  // Without transposing, each row is a point.
+  arma::fmat untransposed;
+  file.Load(untransposed, loadedInfo, false);
+  REQUIRE(untransposed.n_rows == 500);
+  REQUIRE(untransposed.n_cols == 4);
+  REQUIRE(untransposed(10, 2) == 10.0f);
+
+  remove("test.csv");
+  remove("test.mlds");
+}
+
+/**
+ * Make sure that a subset of the dimensions of a columnar dataset can be
+ * loaded, with the mappings of those dimensions only.
+ */
+TEST_CASE("ColumnarDatasetSubsetTest", "[LoadSaveTest]")
+{
+  arma::mat dataset(5, 200, arma::fill::randu);
+  DatasetInfo info(5);
+  for (size_t i = 0; i < 200; ++i)
+  {
+    dataset(3, i) = info.MapString<double>(std::to_string(i % 4) + "x", 3);
+  }
+  REQUIRE(data::Save("test.mlds", dataset, info));
+
+  data::ColumnarDataset file("test.mlds");
+  arma::mat subset;
+  DatasetInfo subsetInfo;
+  file.Load({ 3, 0 }, subset, subsetInfo);
+
+  REQUIRE(subset.n_rows == 2);
+  REQUIRE(subset.n_cols == 200);
+  REQUIRE(arma::approx_equal(subset.row(0), dataset.row(3), "absdiff", 0.0));
+  REQUIRE(arma::approx_equal(subset.row(1), dataset.row(0), "absdiff", 0.0));
+  REQUIRE(subsetInfo.Dimensionality() == 2);
+  REQUIRE(subsetInfo.Type(0) == Datatype::categorical);
+  REQUIRE(subsetInfo.Type(1) == Datatype::numeric);
+  REQUIRE(subsetInfo.NumMappings(0) == 4);
+  REQUIRE(subsetInfo.UnmapString(2, 0) == "2x");
+
+  REQUIRE_THROWS_AS(file.Load({ 5 }, subset, subsetInfo),
+      std::invalid_argument);
+
+  remove("test.mlds");
+}
+
+/**
+ * Make sure that files that are not columnar datasets are rejected.
+ */
+TEST_CASE("ColumnarDatasetInvalidTest", "[LoadSaveTest]")
+{
+  fstream f;
+  f.open("test.mlds", fstream::out);
+  f << "1, 2, 3" << endl;
+  f.close();
+
+  arma::mat dataset;
+  DatasetInfo info;
+  REQUIRE(!data::Load("test.mlds", dataset, info));
+  REQUIRE_THROWS_AS(data::ColumnarDataset("test.mlds"), std::runtime_error);
+
+  // Saving with a DatasetInfo to another format is an error.
+  dataset.randu(3, 10);
+  info = DatasetInfo(3);
+  REQUIRE(!data::Save("test.csv", dataset, info));
+
+  remove("test.mlds");
+}
@@ -1081,3 +1081,41 @@ TEST_CASE("IncrementalTraining", "[LogisticRegressionTest]")
 
   REQUIRE(acc == Approx(100.0).epsilon(0.03)); // 3% error tolerance.
 }
+
+/**
+ * Test training of logistic regression with SGD on a file read in blocks.
+ */
+TEST_CASE("LogisticRegressionBlockReaderSGDTest", "[LogisticRegressionTest]")
+{
+  // Generate a two-Gaussian dataset, with the classes interleaved so that each
+  // block holds both classes.
+  GaussianDistribution g1(arma::vec("-3.0 -3.0 -3.0"),
+      arma::eye<arma::mat>(3, 3));
+  GaussianDistribution g2(arma::vec("3.0 3.0 3.0"), arma::eye<arma::mat>(3, 3));
+
+  arma::mat dataset(3, 2000);
+  arma::Row<size_t> responses(2000);
+  for (size_t i = 0; i < 2000; ++i)
+  {
+    dataset.col(i) = (i % 2 == 0) ? g1.Random() : g2.Random();
+    responses[i] = i % 2;
+  }
+
+  data::Save("test_lr.bin", dataset);
+  data::Save("test_lr_labels.csv", responses);
+
+  // Make two passes over the file, in blocks of 100 points.  The optimizer
+  // makes only one pass over each block, whatever its MaxIterations().
+  data::BlockReader reader("test_lr.bin", 100);
+  data::BlockReader labelReader("test_lr_labels.csv");
+  ens::StandardSGD sgd(0.01, 1, 100000, 1e-10);
+  LogisticRegression<> lr(dataset.n_rows, 0.001);
+  lr.Train(reader, labelReader, sgd, 2);
+  REQUIRE(sgd.MaxIterations() == 100000);
+
+  const double acc = lr.ComputeAccuracy(dataset, responses);
+  REQUIRE(acc >= 99.0);
+
+  remove("test_lr.bin");
+  remove("test_lr_labels.csv");
+}
@@ -65,3 +65,50 @@ TEST_CASE_METHOD(GmmProbabilityTestFixture, "GmmProbabilityDimensionality",
   REQUIRE(IO::GetParam<arma::mat>("output").n_cols == 5);
   REQUIRE(IO::GetParam<arma::mat>("output").n_rows == 1);
 }
+
+// Check that the tree-based probabilities are within the relative error of the
+// exact probabilities.
+TEST_CASE_METHOD(GmmProbabilityTestFixture, "GmmProbabilityRelErrorTest",
+                 "[GmmProbabilityMainTest][BindingTests]")
+{
+  GMM gmm(3, 2);
+  gmm.Component(0) = distribution::GaussianDistribution("0 0", "1 0; 0 1");
+  gmm.Component(1) = distribution::GaussianDistribution("6 6", "2 1; 1 2");
+  gmm.Component(2) = distribution::GaussianDistribution("-6 5",
+      "1 0.2; 0.2 0.5");
+  gmm.Weights() = "0.3 0.5 0.2";
+
+  arma::mat inputPoints(2, 1000, arma::fill::randn);
+  inputPoints *= 5.0;
+
+  arma::vec probabilities;
+  gmm.Probability(inputPoints, probabilities);
+
+  SetInputParam("input", inputPoints);
+  SetInputParam("input_model", &gmm);
+  SetInputParam("rel_error", 0.01);
+
+  mlpackMain();
+
+  const arma::mat& output = IO::GetParam<arma::mat>("output");
+  REQUIRE(output.n_rows == 1);
+  REQUIRE(output.n_cols == 1000);
+  for (size_t i = 0; i < 1000; ++i)
+    REQUIRE(output[i] == Approx(probabilities[i]).epsilon(0.01));
+}
+
+// Ensure that the relative error must not be negative.
+TEST_CASE_METHOD(GmmProbabilityTestFixture, "GmmProbabilityNegativeErrorTest",
+                 "[GmmProbabilityMainTest][BindingTests]")
+{
+  GMM gmm(1, 5);
+  gmm.Train(arma::mat(5, 10, arma::fill::randu), 5);
+
+  SetInputParam("input", arma::mat(5, 5, arma::fill::randu));
+  SetInputParam("input_model", &gmm);
+  SetInputParam("rel_error", -0.1); // Invalid.
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
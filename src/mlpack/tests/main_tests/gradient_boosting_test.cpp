@@ -0,0 +1,209 @@
+/**
+ * @file tests/main_tests/gradient_boosting_test.cpp
+ *
+ * Test mlpackMain() of gradient_boosting_main.cpp.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#define BINDING_TYPE BINDING_TYPE_TEST
+
+#include <mlpack/core.hpp>
+static const std::string testName = "GradientBoosting";
+
+#include <mlpack/core/util/mlpack_main.hpp>
+#include <mlpack/methods/gradient_boosting/gradient_boosting_main.cpp>
+#include "test_helper.hpp"
+
+#include "../catch.hpp"
+#include "../test_catch_tools.hpp"
+
+using namespace mlpack;
+
+struct GradientBoostingTestFixture
+{
+ public:
+  GradientBoostingTestFixture()
+  {
+    // Cache in the options for this program.
+    IO::RestoreSettings(testName);
+  }
+
+  ~GradientBoostingTestFixture()
+  {
+    // Clear the settings.
+    bindings::tests::CleanMemory();
+    IO::ClearSettings();
+  }
+};
+
+/**
+ * Check that number of output points and number of input
+ * points are equal and have appropriate number of classes.
+ */
+TEST_CASE_METHOD(GradientBoostingTestFixture,
+                 "GradientBoostingOutputDimensionTest",
+                 "[GradientBoostingMainTest][BindingTests]")
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    FAIL("Cannot load train dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt");
+
+  arma::mat testData;
+  if (!data::Load("vc2_test.csv", testData))
+    FAIL("Cannot load test dataset vc2.csv!");
+
+  size_t testSize = testData.n_cols;
+
+  // Input training data.
+  SetInputParam("training", std::move(inputData));
+  SetInputParam("labels", std::move(labels));
+  SetInputParam("num_rounds", (int) 10);
+
+  // Input test data.
+  SetInputParam("test", std::move(testData));
+
+  mlpackMain();
+
+  // Check that number of output points are equal to number of input points.
+  REQUIRE(IO::GetParam<arma::Row<size_t>>("predictions").n_cols == testSize);
+  REQUIRE(IO::GetParam<arma::mat>("probabilities").n_cols == testSize);
+
+  // Check number of output rows equals number of classes in case of
+  // probabilities and 1 for predictions.
+  REQUIRE(IO::GetParam<arma::Row<size_t>>("predictions").n_rows == 1);
+  REQUIRE(IO::GetParam<arma::mat>("probabilities").n_rows == 3);
+}
+
+/**
+ * Ensure that saved model can be used again.
+ */
+TEST_CASE_METHOD(GradientBoostingTestFixture, "GradientBoostingModelReuseTest",
+                 "[GradientBoostingMainTest][BindingTests]")
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    FAIL("Cannot load train dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt");
+
+  arma::mat testData;
+  if (!data::Load("vc2_test.csv", testData))
+    FAIL("Cannot load test dataset vc2.csv!");
+
+  // Input training data.
+  SetInputParam("training", std::move(inputData));
+  SetInputParam("labels", std::move(labels));
+  SetInputParam("num_rounds", (int) 10);
+
+  // Input test data.
+  SetInputParam("test", testData);
+
+  mlpackMain();
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  predictions = std::move(IO::GetParam<arma::Row<size_t>>("predictions"));
+  probabilities = std::move(IO::GetParam<arma::mat>("probabilities"));
+
+  // Reset passed parameters.
+  IO::GetSingleton().Parameters()["training"].wasPassed = false;
+  IO::GetSingleton().Parameters()["labels"].wasPassed = false;
+  IO::GetSingleton().Parameters()["test"].wasPassed = false;
+
+  // Input trained model.
+  SetInputParam("test", std::move(testData));
+  SetInputParam("input_model",
+                IO::GetParam<GradientBoostingModel*>("output_model"));
+
+  mlpackMain();
+
+  // Check that initial predictions and predictions using saved model are same.
+  CheckMatrices(predictions, IO::GetParam<arma::Row<size_t>>("predictions"));
+  CheckMatrices(probabilities, IO::GetParam<arma::mat>("probabilities"));
+}
+
+/**
+ * Make sure that a validation set stops training early.
+ */
+TEST_CASE_METHOD(GradientBoostingTestFixture,
+                 "GradientBoostingEarlyStoppingTest",
+                 "[GradientBoostingMainTest][BindingTests]")
+{
+  // Labels that are pure noise.
+  arma::mat inputData(3, 300, arma::fill::randu);
+  arma::Row<size_t> labels = arma::randi<arma::Row<size_t>>(300,
+      arma::distr_param(0, 1));
+  arma::mat validation(3, 300, arma::fill::randu);
+  arma::Row<size_t> validationLabels = arma::randi<arma::Row<size_t>>(300,
+      arma::distr_param(0, 1));
+
+  SetInputParam("training", std::move(inputData));
+  SetInputParam("labels", std::move(labels));
+  SetInputParam("validation", std::move(validation));
+  SetInputParam("validation_labels", std::move(validationLabels));
+  SetInputParam("num_rounds", (int) 500);
+  SetInputParam("learning_rate", 0.5);
+  SetInputParam("maximum_depth", (int) 0);
+  SetInputParam("minimum_leaf_size", (int) 1);
+  SetInputParam("early_stopping_rounds", (int) 3);
+
+  mlpackMain();
+
+  REQUIRE(IO::GetParam<GradientBoostingModel*>("output_model")->gb.NumRounds()
+      < 500);
+}
+
+/**
+ * Make sure the number of rounds is always a positive number.
+ */
+TEST_CASE_METHOD(GradientBoostingTestFixture, "GradientBoostingNumRoundsTest",
+                 "[GradientBoostingMainTest][BindingTests]")
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    FAIL("Cannot load train dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt");
+
+  SetInputParam("training", std::move(inputData));
+  SetInputParam("labels", std::move(labels));
+  SetInputParam("num_rounds", (int) 0); // Invalid.
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
+/**
+ * Make sure the subsampling fractions are in (0, 1].
+ */
+TEST_CASE_METHOD(GradientBoostingTestFixture, "GradientBoostingSubsampleTest",
+                 "[GradientBoostingMainTest][BindingTests]")
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    FAIL("Cannot load train dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt");
+
+  SetInputParam("training", std::move(inputData));
+  SetInputParam("labels", std::move(labels));
+  SetInputParam("column_subsample", 1.5); // Invalid.
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
@@ -70,3 +70,38 @@ TEST_CASE_METHOD(HMMLoglikTestFixture, "HMMLoglikOutputNegativeTest",
   // Since the log of a probability <= 0 ...
   REQUIRE(loglik <= 0);
 }
+
+TEST_CASE_METHOD(HMMLoglikTestFixture, "HMMLoglikLengthsTest",
+                 "[HMMLoglikMainTest][BindingTests]")
+{
+  // Load data to train a discrete HMM model with.
+  arma::mat inp;
+  data::Load("obs1.csv", inp);
+  std::vector<arma::mat> trainSeq = {inp};
+
+  // Initialize and train an HMM model.
+  HMMModel* h = new HMMModel(DiscreteHMM);
+  h->PerformAction<InitHMMModel, std::vector<arma::mat>>(&trainSeq);
+  h->PerformAction<TrainHMMModel, std::vector<arma::mat>>(&trainSeq);
+
+  // Evaluate the sequence and its first half separately.
+  const size_t half = inp.n_cols / 2;
+  const double expected = h->DiscreteHMM()->LogLikelihood(inp);
+  const double expectedHalf =
+      h->DiscreteHMM()->LogLikelihood(inp.cols(0, half - 1));
+
+  // Now evaluate both at once.
+  SetInputParam("input_model", h);
+  SetInputParam("input", arma::mat(arma::join_rows(inp,
+      inp.cols(0, half - 1))));
+  SetInputParam("lengths", arma::Row<size_t>({ (size_t) inp.n_cols, half }));
+
+  mlpackMain();
+
+  const arma::vec& loglik = IO::GetParam<arma::vec>("log_likelihoods");
+  REQUIRE(loglik.n_elem == 2);
+  REQUIRE(loglik[0] == Approx(expected));
+  REQUIRE(loglik[1] == Approx(expectedHalf));
+  REQUIRE(IO::GetParam<double>("log_likelihood") ==
+      Approx(expected + expectedHalf));
+}
@@ -244,3 +244,63 @@ TEST_CASE_METHOD(HMMViterbiTestFixture,
   REQUIRE(out.n_rows == 1);
   REQUIRE(out.n_cols == observations.n_cols);
 }
+
+TEST_CASE_METHOD(HMMViterbiTestFixture,
+                 "HMMViterbiLengthsTest",
+                 "[HMMViterbiMainTest][BindingTests]")
+{
+  // Load data to train a discrete HMM model with.
+  arma::mat inp;
+  data::Load("obs1.csv", inp);
+  std::vector<arma::mat> trainSeq = {inp};
+
+  // Initialize and train a discrete HMM model.
+  HMMModel* h = new HMMModel(DiscreteHMM);
+  h->PerformAction<InitHMMModel, std::vector<arma::mat>>(&trainSeq);
+  h->PerformAction<TrainHMMModel, std::vector<arma::mat>>(&trainSeq);
+
+  // Decode the sequence and its first half separately.
+  const size_t half = inp.n_cols / 2;
+  arma::Row<size_t> expected, expectedHalf;
+  h->DiscreteHMM()->Predict(inp, expected);
+  h->DiscreteHMM()->Predict(inp.cols(0, half - 1), expectedHalf);
+
+  // Now decode both at once.
+  SetInputParam("input_model", h);
+  SetInputParam("input", arma::mat(arma::join_rows(inp,
+      inp.cols(0, half - 1))));
+  SetInputParam("lengths", arma::Row<size_t>({ (size_t) inp.n_cols, half }));
+
+  mlpackMain();
+
+  arma::Mat<size_t> out = IO::GetParam<arma::Mat<size_t> >("output");
+
+  REQUIRE(out.n_rows == 1);
+  REQUIRE(out.n_cols == inp.n_cols + half);
+  REQUIRE(arma::all(arma::vectorise(out.cols(0, inp.n_cols - 1)) ==
+      arma::vectorise(expected)));
+  REQUIRE(arma::all(arma::vectorise(out.cols(inp.n_cols, out.n_cols - 1)) ==
+      arma::vectorise(expectedHalf)));
+}
+
+TEST_CASE_METHOD(HMMViterbiTestFixture,
+                 "HMMViterbiInvalidLengthsTest",
+                 "[HMMViterbiMainTest][BindingTests]")
+{
+  arma::mat inp;
+  data::Load("obs1.csv", inp);
+  std::vector<arma::mat> trainSeq = {inp};
+
+  HMMModel* h = new HMMModel(DiscreteHMM);
+  h->PerformAction<InitHMMModel, std::vector<arma::mat>>(&trainSeq);
+  h->PerformAction<TrainHMMModel, std::vector<arma::mat>>(&trainSeq);
+
+  // The lengths do not sum to the number of observations.
+  SetInputParam("input_model", h);
+  SetInputParam("input", inp);
+  SetInputParam("lengths", arma::Row<size_t>({ 1, (size_t) inp.n_cols }));
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
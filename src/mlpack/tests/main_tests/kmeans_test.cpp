@@ -401,3 +401,128 @@ TEST_CASE_METHOD(KmTestFixture, "AlgorithmsSimilarTest",
   CheckMatrices(naiveCentroid, dualTreeCentroid);
   CheckMatrices(naiveCentroid, dualCoverTreeCentroid);
 }
+
+/**
+ * Make sure that mini-batch k-means runs and finds well-separated clusters.
+ */
+TEST_CASE_METHOD(KmTestFixture, "KmeansMiniBatchTest",
+                 "[KmeansMainTest][BindingTests]")
+{
+  arma::mat means("0.0 10.0 -10.0;"
+                  "0.0 10.0 5.0");
+  arma::mat inputData(2, 1500);
+  for (size_t i = 0; i < inputData.n_cols; ++i)
+    inputData.col(i) = means.col(i % 3) + 0.3 * arma::randn<arma::vec>(2);
+
+  SetInputParam("input", std::move(inputData));
+  SetInputParam("clusters", (int) 3);
+  SetInputParam("algorithm", std::string("minibatch"));
+  SetInputParam("batch_size", (int) 100);
+  SetInputParam("labels_only", true);
+  SetInputParam("initial_centroids", arma::mat(means + 2.0));
+
+  mlpackMain();
+
+  const arma::mat& output = IO::GetParam<arma::mat>("output");
+  const arma::mat& centroids = IO::GetParam<arma::mat>("centroid");
+  REQUIRE(output.n_rows == 1);
+  REQUIRE(output.n_cols == 1500);
+  REQUIRE(centroids.n_rows == 2);
+  REQUIRE(centroids.n_cols == 3);
+  for (size_t i = 0; i < 3; ++i)
+    REQUIRE(arma::norm(centroids.col(i) - means.col(i)) < 0.2);
+}
+
+/**
+ * Make sure that the batch size of mini-batch k-means must be positive.
+ */
+TEST_CASE_METHOD(KmTestFixture, "KmeansMiniBatchInvalidBatchSizeTest",
+                 "[KmeansMainTest][BindingTests]")
+{
+  SetInputParam("input", arma::mat(arma::randu<arma::mat>(2, 100)));
+  SetInputParam("clusters", (int) 3);
+  SetInputParam("algorithm", std::string("minibatch"));
+  SetInputParam("batch_size", (int) 0); // Invalid.
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
+
+/**
+ * Make sure that k-means|| initialization runs and finds well-separated
+ * clusters.
+ */
+TEST_CASE_METHOD(KmTestFixture, "KmeansParallelInitializationTest",
+                 "[KmeansMainTest][BindingTests]")
+{
+  arma::mat means("0.0 10.0 -10.0;"
+                  "0.0 10.0 5.0");
+  arma::mat inputData(2, 1500);
+  for (size_t i = 0; i < inputData.n_cols; ++i)
+    inputData.col(i) = means.col(i % 3) + 0.3 * arma::randn<arma::vec>(2);
+
+  SetInputParam("input", std::move(inputData));
+  SetInputParam("clusters", (int) 3);
+  SetInputParam("kmeans_parallel", true);
+  SetInputParam("oversampling", 3.0);
+  SetInputParam("rounds", (int) 3);
+
+  mlpackMain();
+
+  // Each mean must have a centroid next to it.
+  const arma::mat& centroids = IO::GetParam<arma::mat>("centroid");
+  REQUIRE(centroids.n_rows == 2);
+  REQUIRE(centroids.n_cols == 3);
+  for (size_t i = 0; i < 3; ++i)
+  {
+    double minDistance = DBL_MAX;
+    for (size_t j = 0; j < 3; ++j)
+    {
+      minDistance = std::min(minDistance,
+          arma::norm(centroids.col(j) - means.col(i)));
+    }
+    REQUIRE(minDistance < 0.2);
+  }
+}
+
+/**
+ * Make sure that invalid k-means|| parameters are rejected, and that only one
+ * initialization strategy can be used.
+ */
+TEST_CASE_METHOD(KmTestFixture, "KmeansParallelInitializationInvalidTest",
+                 "[KmeansMainTest][BindingTests]")
+{
+  arma::mat inputData(arma::randu<arma::mat>(2, 100));
+
+  SetInputParam("input", inputData);
+  SetInputParam("clusters", (int) 3);
+  SetInputParam("kmeans_parallel", true);
+  SetInputParam("oversampling", 0.0); // Invalid.
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+
+  ResetKmSettings();
+
+  SetInputParam("input", inputData);
+  SetInputParam("clusters", (int) 3);
+  SetInputParam("kmeans_parallel", true);
+  SetInputParam("rounds", (int) 0); // Invalid.
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+
+  ResetKmSettings();
+
+  SetInputParam("input", std::move(inputData));
+  SetInputParam("clusters", (int) 3);
+  SetInputParam("kmeans_parallel", true);
+  SetInputParam("kmeans_plus_plus", true); // Only one can be given.
+
+  Log::Fatal.ignoreInput = true;
+  REQUIRE_THROWS_AS(mlpackMain(), std::runtime_error);
+  Log::Fatal.ignoreInput = false;
+}
@@ -601,6 +601,48 @@ TEST_CASE_METHOD(KNNTestFixture, "KNNAllAlgorithmsTest",
   }
 }
 
+/*
+ * Ensure that the parallel dual-tree search gives the same result as the
+ * single-threaded search.
+ */
+TEST_CASE_METHOD(KNNTestFixture, "KNNThreadsTest",
+                 "[KNNMainTest][BindingTests]")
+{
+  arma::mat referenceData;
+  referenceData.randu(3, 200); // 200 points in 3 dimensions.
+
+  arma::mat queryData;
+  queryData.randu(3, 90); // 90 points in 3 dimensions.
+
+  SetInputParam("reference", referenceData);
+  SetInputParam("query", queryData);
+  SetInputParam("k", (int) 10);
+
+  mlpackMain();
+
+  arma::Mat<size_t> neighbors =
+      std::move(IO::GetParam<arma::Mat<size_t>>("neighbors"));
+  arma::mat distances = std::move(IO::GetParam<arma::mat>("distances"));
+
+  delete IO::GetParam<KNNModel*>("output_model");
+  IO::GetParam<KNNModel*>("output_model") = NULL;
+
+  // Reset passed parameters.
+  IO::GetSingleton().Parameters()["reference"].wasPassed = false;
+  IO::GetSingleton().Parameters()["query"].wasPassed = false;
+
+  SetInputParam("reference", std::move(referenceData));
+  SetInputParam("query", std::move(queryData));
+  SetInputParam("threads", (int) 0);
+
+  mlpackMain();
+
+  REQUIRE(IO::GetParam<KNNModel*>("output_model")->SearchMode() ==
+      PARALLEL_DUAL_TREE_MODE);
+  CheckMatrices(neighbors, IO::GetParam<arma::Mat<size_t>>("neighbors"));
+  CheckMatrices(distances, IO::GetParam<arma::mat>("distances"));
+}
+
 /*
  * Ensure that different tree types give same result.
  */
@@ -525,3 +525,38 @@ TEST_CASE_METHOD(RandomForestTestFixture, "RandomForestWarmStart",
 
   REQUIRE(oldNumTrees + 10 == newNumTrees);
 }
+
+/**
+ * Make sure that the predictions of the binding match those of the random
+ * forest held by the output model.
+ */
+TEST_CASE_METHOD(RandomForestTestFixture, "RandomForestPredictionsMatchModel",
+                 "[RandomForestMainTest][BindingTests]")
+{
+  arma::mat inputData;
+  if (!data::Load("vc2.csv", inputData))
+    FAIL("Cannot load train dataset vc2.csv!");
+
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load labels for vc2_labels.txt");
+
+  arma::mat testData;
+  if (!data::Load("vc2_test.csv", testData))
+    FAIL("Cannot load test dataset vc2.csv!");
+
+  SetInputParam("training", std::move(inputData));
+  SetInputParam("labels", std::move(labels));
+  SetInputParam("test", testData);
+  SetInputParam("num_trees", (int) 10);
+
+  mlpackMain();
+
+  arma::Row<size_t> predictions;
+  arma::mat probabilities;
+  IO::GetParam<RandomForestModel*>("output_model")->rf.Classify(testData,
+      predictions, probabilities);
+
+  CheckMatrices(predictions, IO::GetParam<arma::Row<size_t>>("predictions"));
+  CheckMatrices(probabilities, IO::GetParam<arma::mat>("probabilities"));
+}
@@ -0,0 +1,258 @@
+/**
+ * @file tests/mapped_matrix_test.cpp
+ *
+ * Tests for data::MappedMatrix.
+ *
+ * mlpack is free software; you may redistribute it and/or modify it under the
+ * terms of the 3-clause BSD license.  You should have received a copy of the
+ * 3-clause BSD license along with mlpack.  If not, see
+ * http://www.opensource.org/licenses/BSD-3-Clause for more information.
+ */
+#include <mlpack/core.hpp>
+#include <mlpack/core/data/mapped_matrix.hpp>
+#include <mlpack/methods/neighbor_search/neighbor_search.hpp>
+#include <mlpack/methods/neighbor_search/ns_model.hpp>
+#include "catch.hpp"
+#include "test_catch_tools.hpp"
+
+using namespace mlpack;
+using namespace mlpack::data;
+using namespace mlpack::neighbor;
+using namespace mlpack::tree;
+
+/**
+ * Make sure a saved matrix can be mapped again.
+ */
+TEST_CASE("MappedMatrixSaveLoadTest", "[MappedMatrixTest]")
+{
+  arma::mat dataset(4, 100, arma::fill::randu);
+  MappedMatrix<>::Save("test_mapped.bin", dataset);
+
+  {
+    MappedMatrix<> mapped("test_mapped.bin");
+    REQUIRE(mapped.NRows() == 4);
+    REQUIRE(mapped.NCols() == 100);
+    REQUIRE(mapped.Mode() == READ_ONLY);
+
+    const arma::mat m = mapped.Matrix();
+    REQUIRE(m.n_rows == 4);
+    REQUIRE(m.n_cols == 100);
+    CheckMatrices(m, dataset);
+  }
+
+  remove("test_mapped.bin");
+}
+
+/**
+ * Make sure invalid files are rejected.
+ */
+TEST_CASE("MappedMatrixInvalidFileTest", "[MappedMatrixTest]")
+{
+  arma::mat dataset(3, 10, arma::fill::randu);
+  MappedMatrix<>::Save("test_mapped.bin", dataset);
+
+  // Wrong element type.
+  REQUIRE_THROWS_AS(MappedMatrix<float>("test_mapped.bin"),
+      std::runtime_error);
+  REQUIRE_THROWS_AS(MappedMatrix<size_t>("test_mapped.bin"),
+      std::runtime_error);
+
+  // Not a mapped matrix file.
+  std::fstream f("test_not_mapped.bin", std::fstream::out);
+  f << "this is not a matrix file, but it is long enough to hold a header of "
+      << "sixty-four bytes." << std::endl;
+  f.close();
+  REQUIRE_THROWS_AS(MappedMatrix<>("test_not_mapped.bin"), std::runtime_error);
+
+  // Nonexistent file.
+  REQUIRE_THROWS_AS(MappedMatrix<>("test_nonexistent.bin"),
+      std::runtime_error);
+
+  remove("test_mapped.bin");
+  remove("test_not_mapped.bin");
+}
+
+/**
+ * Make sure a matrix can be created and filled in place.
+ */
+TEST_CASE("MappedMatrixCreateTest", "[MappedMatrixTest]")
+{
+  {
+    MappedMatrix<int> mapped = MappedMatrix<int>::Create("test_mapped.bin", 5,
+        7);
+    REQUIRE(mapped.Mode() == READ_WRITE);
+
+    arma::Mat<int> m = mapped.Matrix();
+    REQUIRE(arma::accu(m != 0) == 0);
+    for (size_t i = 0; i < m.n_elem; ++i)
+      m[i] = (int) i;
+  }
+
+  MappedMatrix<int> mapped("test_mapped.bin");
+  const arma::Mat<int> m = mapped.Matrix();
+  REQUIRE(m.n_rows == 5);
+  REQUIRE(m.n_cols == 7);
+  for (size_t i = 0; i < m.n_elem; ++i)
+    REQUIRE(m[i] == (int) i);
+
+  mapped.Close();
+  remove("test_mapped.bin");
+}
+
+/**
+ * Run k-nearest-neighbor search on a mapped reference set, and make sure the
+ * data is not copied and the file is not changed in COPY_ON_WRITE mode.
+ */
+TEST_CASE("MappedMatrixKNNTest", "[MappedMatrixTest]")
+{
+  arma::mat dataset(5, 1000, arma::fill::randu);
+  MappedMatrix<>::Save("test_mapped.bin", dataset);
+
+  arma::Mat<size_t> neighbors, mappedNeighbors;
+  arma::mat distances, mappedDistances;
+
+  KNN knn(dataset);
+  knn.Search(dataset, 5, neighbors, distances);
+
+  {
+    MappedMatrix<> mapped("test_mapped.bin", COPY_ON_WRITE);
+    KNN mappedKnn(mapped.Matrix());
+
+    // The tree was built directly on the mapped memory.
+    REQUIRE(mappedKnn.ReferenceSet().memptr() == mapped.Matrix().memptr());
+
+    mappedKnn.Search(dataset, 5, mappedNeighbors, mappedDistances);
+  }
+
+  CheckMatrices(neighbors, mappedNeighbors);
+  CheckMatrices(distances, mappedDistances);
+
+  // The file must still hold the original ordering.
+  MappedMatrix<> mapped("test_mapped.bin");
+  CheckMatrices(mapped.Matrix(), dataset);
+
+  mapped.Close();
+  remove("test_mapped.bin");
+}
+
+/**
+ * Build a tree on a mapped matrix in READ_WRITE mode, and make sure the
+ * reordered points are written back to the file.
+ */
+TEST_CASE("MappedMatrixReadWriteTreeTest", "[MappedMatrixTest]")
+{
+  arma::mat dataset(3, 500, arma::fill::randu);
+  MappedMatrix<>::Save("test_mapped.bin", dataset);
+
+  std::vector<size_t> oldFromNew;
+  arma::mat treeData;
+  {
+    MappedMatrix<> mapped("test_mapped.bin", READ_WRITE);
+    KDTree<metric::EuclideanDistance, EmptyStatistic, arma::mat> tree(
+        mapped.Matrix(), oldFromNew);
+    treeData = tree.Dataset();
+  }
+
+  MappedMatrix<> mapped("test_mapped.bin");
+  const arma::mat m = mapped.Matrix();
+  CheckMatrices(m, treeData);
+  for (size_t i = 0; i < m.n_cols; ++i)
+    CheckMatrices(m.col(i), dataset.col(oldFromNew[i]));
+
+  mapped.Close();
+  remove("test_mapped.bin");
+}
+
+/**
+ * Save the order of a mapped matrix reordered by a tree, and make sure that it
+ * is loaded again and that the same tree built on the reordered file moves no
+ * point.
+ */
+TEST_CASE("MappedMatrixSaveOrderTest", "[MappedMatrixTest]")
+{
+  arma::mat dataset(3, 500, arma::fill::randu);
+  MappedMatrix<>::Save("test_mapped.bin", dataset);
+
+  typedef KDTree<metric::EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+  std::vector<size_t> oldFromNew;
+  {
+    MappedMatrix<> mapped("test_mapped.bin", READ_WRITE);
+    REQUIRE(mapped.OldFromNew().empty());
+    TreeType tree(mapped.Matrix(), oldFromNew);
+    mapped.SaveOrder(oldFromNew);
+
+    // The order can only be saved for a READ_WRITE mapping.
+    MappedMatrix<> readOnly("test_mapped.bin", READ_ONLY);
+    REQUIRE_THROWS_AS(readOnly.SaveOrder(oldFromNew), std::invalid_argument);
+  }
+
+  MappedMatrix<> mapped("test_mapped.bin", COPY_ON_WRITE);
+  REQUIRE(mapped.OldFromNew() == oldFromNew);
+
+  std::vector<size_t> newOldFromNew;
+  TreeType tree(mapped.Matrix(), newOldFromNew);
+  for (size_t i = 0; i < newOldFromNew.size(); ++i)
+    REQUIRE(newOldFromNew[i] == i);
+
+  // Saving a matrix under the same name removes the old order.
+  mapped.Close();
+  MappedMatrix<>::Save("test_mapped.bin", dataset);
+  REQUIRE(MappedMatrix<>("test_mapped.bin").OldFromNew().empty());
+
+  remove("test_mapped.bin");
+  remove(MappedMatrix<>::OrderFilename("test_mapped.bin").c_str());
+}
+
+/**
+ * Build an NSModel on a mapped reference set in each mode, and make sure that
+ * the results use the original indices of the points.
+ */
+TEST_CASE("MappedMatrixNSModelTest", "[MappedMatrixTest]")
+{
+  typedef NSModel<NearestNeighborSort> KNNModel;
+
+  arma::mat dataset(4, 800, arma::fill::randu);
+  arma::mat querySet(4, 50, arma::fill::randu);
+  MappedMatrix<>::Save("test_mapped.bin", dataset);
+
+  arma::Mat<size_t> neighbors, mappedNeighbors;
+  arma::mat distances, mappedDistances;
+  KNN knn(dataset);
+  knn.Search(querySet, 3, neighbors, distances);
+
+  // A kd-tree cannot be built on a READ_ONLY mapping.
+  KNNModel model(KNNModel::KD_TREE);
+  REQUIRE_THROWS_AS(model.BuildModel(MappedMatrix<>("test_mapped.bin",
+      READ_ONLY), DUAL_TREE_MODE), std::invalid_argument);
+
+  // The first build reorders the file; the second uses the saved order.
+  const MappingMode modes[] = { READ_WRITE, COPY_ON_WRITE };
+  for (size_t m = 0; m < 2; ++m)
+  {
+    model.BuildModel(MappedMatrix<>("test_mapped.bin", modes[m]),
+        DUAL_TREE_MODE);
+    model.Search(arma::mat(querySet), 3, mappedNeighbors, mappedDistances);
+    CheckMatrices(neighbors, mappedNeighbors);
+    CheckMatrices(distances, mappedDistances);
+
+    // Monochromatic search must also use the original indices.
+    arma::Mat<size_t> monoNeighbors, mappedMonoNeighbors;
+    arma::mat monoDistances, mappedMonoDistances;
+    knn.Search(3, monoNeighbors, monoDistances);
+    model.Search(3, mappedMonoNeighbors, mappedMonoDistances);
+    CheckMatrices(monoNeighbors, mappedMonoNeighbors);
+    CheckMatrices(monoDistances, mappedMonoDistances);
+  }
+
+  // A cover tree does not rearrange the points, so they are put back in their
+  // original order.
+  KNNModel coverModel(KNNModel::COVER_TREE);
+  coverModel.BuildModel(MappedMatrix<>("test_mapped.bin", READ_ONLY),
+      DUAL_TREE_MODE);
+  coverModel.Search(arma::mat(querySet), 3, mappedNeighbors, mappedDistances);
+  CheckMatrices(neighbors, mappedNeighbors);
+  CheckMatrices(distances, mappedDistances);
+
+  remove("test_mapped.bin");
+  remove(MappedMatrix<>::OrderFilename("test_mapped.bin").c_str());
+}
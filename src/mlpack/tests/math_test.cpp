@@ -10,6 +10,7 @@
  * http://www.opensource.org/licenses/BSD-3-Clause for more information.
  */
 #include <mlpack/core/math/clamp.hpp>
+#include <mlpack/core/math/log_add.hpp>
 #include <mlpack/core/math/random.hpp>
 #include <mlpack/core/math/range.hpp>
 #include "catch.hpp"
@@ -1006,3 +1007,131 @@ TEST_CASE("InplaceSparseShuffleWeightsTest", "[MathTest]")
     REQUIRE(weightCounts[i] == 1);
   }
 }
+
+/**
+ * Make sure that LogSumExp() and LogSumExpT() match LogAdd() applied one
+ * element at a time, including for rows and columns that are all -inf.
+ */
+TEST_CASE("LogSumExpTest", "[MathTest]")
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  arma::mat x = 50.0 * arma::randn<arma::mat>(6, 9);
+  x.row(2).fill(-inf);
+  x.col(4).fill(-inf);
+  x(0, 0) = -inf;
+
+  arma::vec rowSums, colSums;
+  LogSumExp(x, rowSums);
+  LogSumExpT(x, colSums);
+  REQUIRE(rowSums.n_elem == x.n_rows);
+  REQUIRE(colSums.n_elem == x.n_cols);
+
+  for (size_t i = 0; i < x.n_rows; ++i)
+  {
+    double sum = -inf;
+    for (size_t j = 0; j < x.n_cols; ++j)
+      sum = LogAdd(sum, x(i, j));
+
+    if (std::isinf(sum))
+      REQUIRE(rowSums[i] == sum);
+    else
+      REQUIRE(rowSums[i] == Approx(sum).epsilon(1e-12));
+  }
+
+  for (size_t j = 0; j < x.n_cols; ++j)
+  {
+    double sum = -inf;
+    for (size_t i = 0; i < x.n_rows; ++i)
+      sum = LogAdd(sum, x(i, j));
+
+    if (std::isinf(sum))
+      REQUIRE(colSums[j] == sum);
+    else
+      REQUIRE(colSums[j] == Approx(sum).epsilon(1e-12));
+  }
+
+  // The in-place versions also add the previous values.
+  arma::vec rowSumsInPlace = arma::randn<arma::vec>(x.n_rows);
+  rowSumsInPlace[2] = -inf;
+  arma::vec colSumsInPlace = arma::randn<arma::vec>(x.n_cols);
+  const arma::vec rowStart(rowSumsInPlace), colStart(colSumsInPlace);
+  LogSumExp<arma::mat, true>(x, rowSumsInPlace);
+  LogSumExpT<arma::mat, true>(x, colSumsInPlace);
+
+  for (size_t i = 0; i < x.n_rows; ++i)
+  {
+    const double sum = LogAdd(rowSums[i], rowStart[i]);
+    if (std::isinf(sum))
+      REQUIRE(rowSumsInPlace[i] == sum);
+    else
+      REQUIRE(rowSumsInPlace[i] == Approx(sum).epsilon(1e-12));
+  }
+
+  for (size_t j = 0; j < x.n_cols; ++j)
+  {
+    REQUIRE(colSumsInPlace[j] ==
+        Approx(LogAdd(colSums[j], colStart[j])).epsilon(1e-12));
+  }
+}
+
+/**
+ * Make sure that LogSumExpProduct() gives the log of the product of a matrix
+ * with the exponential of a vector of log values.
+ */
+TEST_CASE("LogSumExpProductTest", "[MathTest]")
+{
+  const double inf = std::numeric_limits<double>::infinity();
+  arma::mat a = arma::randu<arma::mat>(7, 5);
+  a.row(3).zeros();
+  a(0, 1) = 0.0;
+  arma::vec x = -100.0 * arma::randu<arma::vec>(5) - 600.0;
+  x[2] = -inf;
+
+  arma::vec y;
+  LogSumExpProduct(a, x, y);
+  REQUIRE(y.n_elem == a.n_rows);
+
+  for (size_t i = 0; i < a.n_rows; ++i)
+  {
+    double sum = -inf;
+    for (size_t j = 0; j < a.n_cols; ++j)
+      sum = LogAdd(sum, std::log(a(i, j)) + x[j]);
+
+    if (std::isinf(sum))
+      REQUIRE(y[i] == sum);
+    else
+      REQUIRE(y[i] == Approx(sum).epsilon(1e-12));
+  }
+
+  // Transposed matrices are handled too.
+  arma::vec xt = 10.0 * arma::randn<arma::vec>(7);
+  arma::vec yt;
+  LogSumExpProduct(a.t(), xt, yt);
+  REQUIRE(yt.n_elem == a.n_cols);
+  for (size_t j = 0; j < a.n_cols; ++j)
+  {
+    double sum = -inf;
+    for (size_t i = 0; i < a.n_rows; ++i)
+      sum = LogAdd(sum, std::log(a(i, j)) + xt[i]);
+
+    REQUIRE(yt[j] == Approx(sum).epsilon(1e-12));
+  }
+
+  // A vector of -inf gives -inf.
+  arma::vec z(5);
+  z.fill(-inf);
+  LogSumExpProduct(a, z, y);
+  REQUIRE(arma::all(y == -inf));
+
+  // A row that only reaches values far below the maximum does not underflow.
+  arma::mat b("0.5 0.5 0.0; 0.0 0.3 0.7; 0.0 0.0 1.0");
+  arma::vec w("0.0 -2000.0 -5000.0");
+  LogSumExpProduct(b, w, y);
+  REQUIRE(y[0] == Approx(std::log(0.5)).epsilon(1e-12));
+  REQUIRE(y[1] == Approx(LogAdd(std::log(0.3) - 2000.0,
+      std::log(0.7) - 5000.0)).epsilon(1e-12));
+  REQUIRE(y[2] == Approx(-5000.0).epsilon(1e-12));
+
+  LogSumExpProduct(b.t(), w, y);
+  REQUIRE(y[2] == Approx(std::log(0.7) - 2000.0).epsilon(1e-12));
+}
@@ -97,6 +97,50 @@ TEST_CASE("LINFMetricTest", "[MetricTest]")
       Approx(lMetric.Evaluate(a2, b2)).epsilon(1e-7));
 }
 
+//! Check that BatchEvaluate() gives the same results as Evaluate(), both for a
+//! separate point and for a column of the same matrix as the rules use.
+template<typename MetricType, typename MatType = arma::mat>
+void CheckBatchEvaluate(const double tolerance = 1e-7)
+{
+  typedef typename MatType::elem_type ElemType;
+
+  MatType points(7, 50, arma::fill::randn);
+  arma::Col<ElemType> point(7, arma::fill::randn);
+
+  arma::Col<ElemType> distances;
+  MetricType::BatchEvaluate(point, points.cols(10, 39), distances);
+
+  REQUIRE(distances.n_elem == 30);
+  for (size_t i = 0; i < distances.n_elem; ++i)
+  {
+    REQUIRE(distances[i] == Approx(MetricType::Evaluate(point,
+        points.col(10 + i))).epsilon(tolerance));
+  }
+
+  MetricType::BatchEvaluate(points.unsafe_col(3), points.cols(10, 39),
+      distances);
+
+  REQUIRE(distances.n_elem == 30);
+  for (size_t i = 0; i < distances.n_elem; ++i)
+  {
+    REQUIRE(distances[i] == Approx(MetricType::Evaluate(points.col(3),
+        points.col(10 + i))).epsilon(tolerance));
+  }
+}
+
+TEST_CASE("LMetricBatchEvaluateTest", "[MetricTest]")
+{
+  CheckBatchEvaluate<ManhattanDistance>();
+  CheckBatchEvaluate<SquaredEuclideanDistance>();
+  CheckBatchEvaluate<EuclideanDistance>();
+  CheckBatchEvaluate<LMetric<3, true>>();
+  CheckBatchEvaluate<ChebyshevDistance>();
+
+  CheckBatchEvaluate<ManhattanDistance, arma::fmat>(1e-5);
+  CheckBatchEvaluate<EuclideanDistance, arma::fmat>(1e-5);
+  CheckBatchEvaluate<ChebyshevDistance, arma::fmat>(1e-5);
+}
+
 /**
  * Simple test for IoU metric.
  */
@@ -323,6 +323,36 @@ TEST_CASE("OcTreeTestMoveConstructorTest", "[OctreeTest]")
   CheckSameNode(tcopy, t2);
 }
 
+//! Check that two trees have the same structure.
+template<typename TreeType>
+void CheckSameTree(TreeType& node1, TreeType& node2)
+{
+  CheckSameNode(node1, node2);
+  REQUIRE(node1.ParentDistance() == node2.ParentDistance());
+
+  for (size_t i = 0; i < node1.NumChildren(); ++i)
+    CheckSameTree(node1.Child(i), node2.Child(i));
+}
+
+/**
+ * Make sure that building an octree in parallel gives exactly the same tree as
+ * a serial build.
+ */
+TEST_CASE("OctreeParallelBuildTest", "[OctreeTest]")
+{
+  arma::mat dataset(3, 5000, arma::fill::randu);
+  std::vector<size_t> oldFromNewSerial, oldFromNewParallel;
+
+  // A cutoff larger than the dataset means a serial build.
+  Octree<> serialTree(dataset, oldFromNewSerial, 10, dataset.n_cols);
+  Octree<> parallelTree(dataset, oldFromNewParallel, 10, 100);
+
+  REQUIRE(oldFromNewSerial == oldFromNewParallel);
+  REQUIRE(arma::all(arma::vectorise(serialTree.Dataset() ==
+      parallelTree.Dataset())));
+  CheckSameTree(serialTree, parallelTree);
+}
+
 /**
  * Test serialization.
  */
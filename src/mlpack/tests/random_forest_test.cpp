@@ -11,6 +11,7 @@
  */
 #include <mlpack/core.hpp>
 #include <mlpack/methods/random_forest/random_forest.hpp>
+#include <mlpack/methods/random_forest/flat_forest.hpp>
 #include <mlpack/methods/decision_tree/random_dimension_select.hpp>
 
 #include "serialization.hpp"
@@ -609,3 +610,222 @@ TEST_CASE("ExtraTreesAccuracyTest", "[RandomForestTest]")
 
   REQUIRE(accuracy >= 0.91);
 }
+
+/**
+ * Make sure that a random forest built with HistogramNumericSplit gives
+ * accuracy similar to one built with BestBinaryNumericSplit.
+ */
+TEST_CASE("HistogramRandomForestAccuracyTest", "[RandomForestTest]")
+{
+  arma::mat dataset;
+  if (!data::Load("vc2.csv", dataset))
+    FAIL("Cannot load dataset vc2.csv");
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load dataset vc2_labels.txt");
+
+  arma::mat testDataset;
+  if (!data::Load("vc2_test.csv", testDataset))
+    FAIL("Cannot load dataset vc2_test.csv");
+  arma::Row<size_t> testLabels;
+  if (!data::Load("vc2_test_labels.txt", testLabels))
+    FAIL("Cannot load dataset vc2_test_labels.txt");
+
+  RandomForest<GiniGain, MultipleRandomDimensionSelect, HistogramNumericSplit>
+      hrf(dataset, labels, 3, 20 /* 20 trees */, 1, 1e-7);
+  RandomForest<> rf(dataset, labels, 3, 20 /* 20 trees */, 1, 1e-7);
+
+  arma::Row<size_t> hrfPredictions;
+  arma::Row<size_t> rfPredictions;
+  hrf.Classify(testDataset, hrfPredictions);
+  rf.Classify(testDataset, rfPredictions);
+
+  const size_t hrfCorrect = arma::accu(hrfPredictions == testLabels);
+  const size_t rfCorrect = arma::accu(rfPredictions == testLabels);
+
+  REQUIRE(hrfCorrect >= size_t(0.7 * testDataset.n_cols));
+  REQUIRE(hrfCorrect >= rfCorrect * 0.9);
+}
+
+/**
+ * Make sure that a flattened random forest gives the same predictions and
+ * probabilities as the forest, both for batches and single points.
+ */
+TEST_CASE("FlatForestRandomForestTest", "[RandomForestTest]")
+{
+  arma::mat dataset;
+  if (!data::Load("vc2.csv", dataset))
+    FAIL("Cannot load dataset vc2.csv");
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load dataset vc2_labels.txt");
+
+  arma::mat testDataset;
+  if (!data::Load("vc2_test.csv", testDataset))
+    FAIL("Cannot load dataset vc2_test.csv");
+
+  RandomForest<> rf(dataset, labels, 3, 20 /* 20 trees */, 1);
+  FlatForest flat(rf);
+  REQUIRE(flat.NumTrees() == 20);
+  REQUIRE(flat.NumClasses() == 3);
+
+  arma::Row<size_t> rfPredictions, flatPredictions;
+  arma::mat rfProbabilities, flatProbabilities;
+  rf.Classify(testDataset, rfPredictions, rfProbabilities);
+  flat.Classify(testDataset, flatPredictions, flatProbabilities);
+
+  REQUIRE(arma::all(rfPredictions == flatPredictions));
+  REQUIRE(arma::approx_equal(rfProbabilities, flatProbabilities, "absdiff",
+      1e-12));
+
+  for (size_t i = 0; i < testDataset.n_cols; ++i)
+    REQUIRE(flat.Classify(testDataset.col(i)) == rfPredictions[i]);
+
+  // A histogram-based forest can be flattened too.
+  RandomForest<GiniGain, MultipleRandomDimensionSelect, HistogramNumericSplit>
+      hrf(dataset, labels, 3, 5 /* 5 trees */, 1);
+  FlatForest hflat(hrf);
+  hrf.Classify(testDataset, rfPredictions);
+  hflat.Classify(testDataset, flatPredictions);
+  REQUIRE(arma::all(rfPredictions == flatPredictions));
+}
+
+/**
+ * Make sure that a flattened random forest sends NaN values to the same child
+ * as the forest, and that a point with NaN values never leaves a leaf.
+ */
+TEST_CASE("FlatForestNaNTest", "[RandomForestTest]")
+{
+  arma::mat dataset;
+  if (!data::Load("vc2.csv", dataset))
+    FAIL("Cannot load dataset vc2.csv");
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load dataset vc2_labels.txt");
+
+  arma::mat testDataset;
+  if (!data::Load("vc2_test.csv", testDataset))
+    FAIL("Cannot load dataset vc2_test.csv");
+
+  // Some points are all NaN, and the others have one NaN value.
+  for (size_t i = 0; i < testDataset.n_cols; ++i)
+  {
+    if (i % 5 == 0)
+      testDataset.col(i).fill(std::numeric_limits<double>::quiet_NaN());
+    else
+      testDataset(i % testDataset.n_rows, i) =
+          std::numeric_limits<double>::quiet_NaN();
+  }
+
+  RandomForest<> rf(dataset, labels, 3, 10 /* 10 trees */, 1);
+  FlatForest flat(rf);
+
+  arma::Row<size_t> rfPredictions, flatPredictions;
+  arma::mat rfProbabilities, flatProbabilities;
+  rf.Classify(testDataset, rfPredictions, rfProbabilities);
+  flat.Classify(testDataset, flatPredictions, flatProbabilities);
+
+  REQUIRE(arma::all(rfPredictions == flatPredictions));
+  REQUIRE(arma::approx_equal(rfProbabilities, flatProbabilities, "absdiff",
+      1e-12));
+
+  for (size_t i = 0; i < testDataset.n_cols; ++i)
+    REQUIRE(flat.Classify(testDataset.col(i)) == rfPredictions[i]);
+}
+
+/**
+ * Make sure that a flattened decision tree with categorical splits gives the
+ * same predictions and probabilities as the tree.
+ */
+TEST_CASE("FlatForestCategoricalDecisionTreeTest", "[RandomForestTest]")
+{
+  arma::mat d;
+  arma::Row<size_t> l;
+  data::DatasetInfo di;
+  MockCategoricalData(d, l, di);
+
+  arma::mat trainingData = d.cols(0, 1999);
+  arma::mat testData = d.cols(2000, 3999);
+  arma::Row<size_t> trainingLabels = l.subvec(0, 1999);
+
+  DecisionTree<> dt(trainingData, di, trainingLabels, 5, 5);
+  FlatForest flat(dt);
+  REQUIRE(flat.NumTrees() == 1);
+  REQUIRE(flat.NumClasses() == 5);
+
+  arma::Row<size_t> dtPredictions, flatPredictions;
+  arma::mat dtProbabilities, flatProbabilities;
+  dt.Classify(testData, dtPredictions, dtProbabilities);
+  flat.Classify(testData, flatPredictions, flatProbabilities);
+
+  REQUIRE(arma::all(dtPredictions == flatPredictions));
+  REQUIRE(arma::approx_equal(dtProbabilities, flatProbabilities, "absdiff",
+      0.0));
+
+  size_t prediction;
+  arma::vec probabilities;
+  flat.Classify(testData.col(0), prediction, probabilities);
+  REQUIRE(prediction == dtPredictions[0]);
+  REQUIRE(arma::approx_equal(probabilities, dtProbabilities.col(0), "absdiff",
+      0.0));
+}
+
+/**
+ * Make sure that untrained models cannot be flattened.
+ */
+TEST_CASE("FlatForestEmptyTest", "[RandomForestTest]")
+{
+  RandomForest<> rf;
+  REQUIRE_THROWS_AS(FlatForest(rf), std::invalid_argument);
+
+  DecisionTree<> dt;
+  REQUIRE_THROWS_AS(FlatForest(dt), std::invalid_argument);
+
+  FlatForest flat;
+  arma::Row<size_t> predictions;
+  REQUIRE_THROWS_AS(flat.Classify(arma::mat(4, 10, arma::fill::randu),
+      predictions), std::invalid_argument);
+}
+
+/**
+ * Make sure that a flattened forest gives the same results after
+ * serialization.
+ */
+TEST_CASE("FlatForestSerializationTest", "[RandomForestTest]")
+{
+  arma::mat dataset;
+  if (!data::Load("vc2.csv", dataset))
+    FAIL("Cannot load dataset vc2.csv");
+  arma::Row<size_t> labels;
+  if (!data::Load("vc2_labels.txt", labels))
+    FAIL("Cannot load dataset vc2_labels.txt");
+
+  arma::mat testDataset;
+  if (!data::Load("vc2_test.csv", testDataset))
+    FAIL("Cannot load dataset vc2_test.csv");
+
+  RandomForest<> rf(dataset, labels, 3, 10 /* 10 trees */, 1);
+  FlatForest flat(rf);
+
+  arma::Row<size_t> beforePredictions;
+  arma::mat beforeProbabilities;
+  flat.Classify(testDataset, beforePredictions, beforeProbabilities);
+
+  FlatForest xmlFlat, jsonFlat, binaryFlat;
+  SerializeObjectAll(flat, xmlFlat, jsonFlat, binaryFlat);
+
+  REQUIRE(xmlFlat.NumTrees() == flat.NumTrees());
+  REQUIRE(jsonFlat.NumClasses() == flat.NumClasses());
+  REQUIRE(binaryFlat.NumNodes() == flat.NumNodes());
+
+  arma::Row<size_t> xmlPredictions, jsonPredictions, binaryPredictions;
+  arma::mat xmlProbabilities, jsonProbabilities, binaryProbabilities;
+  xmlFlat.Classify(testDataset, xmlPredictions, xmlProbabilities);
+  jsonFlat.Classify(testDataset, jsonPredictions, jsonProbabilities);
+  binaryFlat.Classify(testDataset, binaryPredictions, binaryProbabilities);
+
+  CheckMatrices(beforePredictions, xmlPredictions, jsonPredictions,
+      binaryPredictions);
+  CheckMatrices(beforeProbabilities, xmlProbabilities, jsonProbabilities,
+      binaryProbabilities);
+}
@@ -1714,3 +1714,197 @@ TEST_CASE("MoveOperatorNaiveTest", "[RangeSearchTest]")
     }
   }
 }
+
+/**
+ * Insert points into and remove points from the reference set of a tree-based
+ * search, and make sure that the results are the same as naive search on the
+ * modified dataset.
+ */
+TEST_CASE("RangeSearchInsertRemoveTest", "[RangeSearchTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 200);
+  const bool naiveModes[] = { false, false, true };
+  const bool singleModes[] = { false, true, false };
+  const Range range(0.1, 0.3);
+
+  for (size_t m = 0; m < 3; ++m)
+  {
+    arma::mat current = dataset;
+    RangeSearch<> rs(dataset, naiveModes[m], singleModes[m]);
+
+    // Enough insertions to merge levels and to rebuild the reference tree.
+    for (size_t round = 0; round < 12; ++round)
+    {
+      arma::mat points = arma::randu<arma::mat>(3, 10 + 5 * round);
+      rs.Insert(points);
+      current = arma::join_rows(current, points);
+
+      vector<size_t> indices;
+      for (size_t i = round; i < current.n_cols; i += 13)
+        indices.push_back(i);
+      rs.Remove(indices);
+      current.shed_cols(arma::conv_to<arma::uvec>::from(indices));
+
+      REQUIRE(rs.NumReferencePoints() == current.n_cols);
+
+      RangeSearch<> naive(current, true);
+      arma::mat querySet = arma::randu<arma::mat>(3, 50);
+      vector<vector<size_t>> neighbors, naiveNeighbors;
+      vector<vector<double>> distances, naiveDistances;
+      vector<vector<pair<double, size_t>>> sorted, naiveSorted;
+
+      rs.Search(querySet, range, neighbors, distances);
+      naive.Search(querySet, range, naiveNeighbors, naiveDistances);
+      SortResults(neighbors, distances, sorted);
+      SortResults(naiveNeighbors, naiveDistances, naiveSorted);
+      REQUIRE(sorted.size() == naiveSorted.size());
+      for (size_t i = 0; i < sorted.size(); ++i)
+      {
+        REQUIRE(sorted[i].size() == naiveSorted[i].size());
+        for (size_t j = 0; j < sorted[i].size(); ++j)
+        {
+          REQUIRE(sorted[i][j].second == naiveSorted[i][j].second);
+          REQUIRE(sorted[i][j].first ==
+              Approx(naiveSorted[i][j].first).epsilon(1e-7));
+        }
+      }
+
+      // Monochromatic search.
+      rs.Search(range, neighbors, distances);
+      naive.Search(range, naiveNeighbors, naiveDistances);
+      SortResults(neighbors, distances, sorted);
+      SortResults(naiveNeighbors, naiveDistances, naiveSorted);
+      REQUIRE(sorted.size() == naiveSorted.size());
+      for (size_t i = 0; i < sorted.size(); ++i)
+      {
+        REQUIRE(sorted[i].size() == naiveSorted[i].size());
+        for (size_t j = 0; j < sorted[i].size(); ++j)
+        {
+          REQUIRE(sorted[i][j].second == naiveSorted[i][j].second);
+          REQUIRE(sorted[i][j].first ==
+              Approx(naiveSorted[i][j].first).epsilon(1e-7));
+        }
+      }
+    }
+  }
+}
+
+//! Make sure that two sets of range search results are the same.
+void CheckSameResults(const vector<vector<size_t>>& neighbors,
+                      const vector<vector<double>>& distances,
+                      const vector<vector<size_t>>& otherNeighbors,
+                      const vector<vector<double>>& otherDistances)
+{
+  vector<vector<pair<double, size_t>>> sorted, otherSorted;
+  SortResults(neighbors, distances, sorted);
+  SortResults(otherNeighbors, otherDistances, otherSorted);
+
+  REQUIRE(sorted.size() == otherSorted.size());
+  for (size_t i = 0; i < sorted.size(); ++i)
+  {
+    REQUIRE(sorted[i].size() == otherSorted[i].size());
+    for (size_t j = 0; j < sorted[i].size(); ++j)
+    {
+      REQUIRE(sorted[i][j].second == otherSorted[i][j].second);
+      REQUIRE(sorted[i][j].first ==
+          Approx(otherSorted[i][j].first).epsilon(1e-7));
+    }
+  }
+}
+
+/**
+ * Test that the single-tree and naive searches give the same results with
+ * several OpenMP threads as with one thread, both with a query set and without
+ * one.
+ */
+TEST_CASE("RangeSearchParallelSingleTreeVsSerial", "[RangeSearchTest]")
+{
+  arma::mat dataset = arma::randu<arma::mat>(3, 2000);
+  arma::mat querySet = arma::randu<arma::mat>(3, 500);
+  const math::Range range(0.05, 0.15);
+
+  for (size_t naive = 0; naive < 2; ++naive)
+  {
+    RangeSearch<> rs(dataset, (naive == 1), (naive == 0));
+
+    vector<vector<size_t>> neighbors, parallelNeighbors;
+    vector<vector<double>> distances, parallelDistances;
+    vector<vector<size_t>> monoNeighbors, parallelMonoNeighbors;
+    vector<vector<double>> monoDistances, parallelMonoDistances;
+
+    #ifdef HAS_OPENMP
+    const int maxThreads = omp_get_max_threads();
+    omp_set_num_threads(1);
+    #endif
+
+    rs.Search(querySet, range, neighbors, distances);
+    rs.Search(range, monoNeighbors, monoDistances);
+
+    #ifdef HAS_OPENMP
+    omp_set_num_threads(std::max(maxThreads, 4));
+    #endif
+
+    rs.Search(querySet, range, parallelNeighbors, parallelDistances);
+    rs.Search(range, parallelMonoNeighbors, parallelMonoDistances);
+
+    #ifdef HAS_OPENMP
+    omp_set_num_threads(maxThreads);
+    #endif
+
+    CheckSameResults(neighbors, distances, parallelNeighbors,
+        parallelDistances);
+    CheckSameResults(monoNeighbors, monoDistances, parallelMonoNeighbors,
+        parallelMonoDistances);
+  }
+}
+
+/**
+ * Save the reference tree of an RSModel in the flat tree format, load it into
+ * another model, and make sure that the results are the same.
+ */
+TEST_CASE("RSModelFlatSaveLoadTest", "[RangeSearchTest]")
+{
+  arma::mat referenceData = arma::randu<arma::mat>(3, 500);
+  arma::mat queryData = arma::randu<arma::mat>(3, 100);
+  const math::Range range(0.1, 0.3);
+
+  const RSModel::TreeTypes treeTypes[] = { RSModel::KD_TREE,
+      RSModel::BALL_TREE, RSModel::COVER_TREE };
+  for (size_t t = 0; t < 3; ++t)
+  {
+    RSModel model(treeTypes[t]);
+    model.BuildModel(arma::mat(referenceData), 10, false, false);
+    model.SaveFlat("test_flat_tree.bin");
+
+    RSModel loadedModel(treeTypes[t]);
+    loadedModel.LoadFlat("test_flat_tree.bin", false);
+
+    vector<vector<size_t>> neighbors, loadedNeighbors;
+    vector<vector<double>> distances, loadedDistances;
+    model.Search(arma::mat(queryData), range, neighbors, distances);
+    loadedModel.Search(arma::mat(queryData), range, loadedNeighbors,
+        loadedDistances);
+
+    vector<vector<pair<double, size_t>>> sorted, loadedSorted;
+    SortResults(neighbors, distances, sorted);
+    SortResults(loadedNeighbors, loadedDistances, loadedSorted);
+    REQUIRE(sorted.size() == loadedSorted.size());
+    for (size_t i = 0; i < sorted.size(); ++i)
+    {
+      REQUIRE(sorted[i].size() == loadedSorted[i].size());
+      for (size_t j = 0; j < sorted[i].size(); ++j)
+      {
+        REQUIRE(sorted[i][j].second == loadedSorted[i][j].second);
+        REQUIRE(sorted[i][j].first ==
+            Approx(loadedSorted[i][j].first).epsilon(1e-7));
+      }
+    }
+  }
+
+  RSModel rTreeModel(RSModel::R_TREE);
+  rTreeModel.BuildModel(arma::mat(referenceData), 10, false, false);
+  REQUIRE_THROWS_AS(rTreeModel.SaveFlat("test_flat_tree.bin"),
+      std::invalid_argument);
+
+  remove("test_flat_tree.bin");
+}
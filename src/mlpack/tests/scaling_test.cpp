@@ -15,6 +15,7 @@
 #include <mlpack/core/data/scaler_methods/max_abs_scaler.hpp>
 #include <mlpack/core/data/scaler_methods/standard_scaler.hpp>
 #include <mlpack/core/data/scaler_methods/mean_normalization.hpp>
+#include <mlpack/core/data/block_reader.hpp>
 
 #include "test_catch_tools.hpp"
 #include "catch.hpp"
@@ -172,3 +173,33 @@ TEST_CASE("ZCAWhiteningTest", "[ScalingTest]")
   scale.InverseTransform(output, temp);
   CheckMatrices(dataset, temp);
 }
+
+/**
+ * Test that fitting the StandardScaler and MinMaxScaler on a file read in
+ * blocks gives the same result as fitting on the whole dataset.
+ */
+TEST_CASE("BlockReaderFitTest", "[ScalingTest]")
+{
+  arma::mat points = arma::randn<arma::mat>(5, 1003);
+  points.row(2) *= 100.0;
+  points.row(3) += 50.0;
+  data::Save("test_scale.bin", points);
+
+  data::BlockReader reader("test_scale.bin", 100);
+
+  data::StandardScaler standardScaler, streamingStandardScaler;
+  standardScaler.Fit(points);
+  streamingStandardScaler.Fit(reader);
+  CheckMatrices(standardScaler.ItemMean(), streamingStandardScaler.ItemMean());
+  CheckMatrices(standardScaler.ItemStdDev(),
+      streamingStandardScaler.ItemStdDev());
+
+  data::MinMaxScaler minMaxScaler, streamingMinMaxScaler;
+  minMaxScaler.Fit(points);
+  streamingMinMaxScaler.Fit(reader);
+  CheckMatrices(minMaxScaler.ItemMin(), streamingMinMaxScaler.ItemMin());
+  CheckMatrices(minMaxScaler.ItemMax(), streamingMinMaxScaler.ItemMax());
+  CheckMatrices(minMaxScaler.Scale(), streamingMinMaxScaler.Scale());
+
+  remove("test_scale.bin");
+}
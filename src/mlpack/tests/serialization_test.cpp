@@ -654,6 +654,56 @@ TEST_CASE("KNNTest", "[SerializationTest]")
   CheckMatrices(neighbors, xmlNeighbors, jsonNeighbors, binaryNeighbors);
 }
 
+/**
+ * Make sure that the points inserted into and removed from a KNN model are
+ * serialized, and that saving the model does not rebuild its reference tree.
+ */
+TEST_CASE("KNNInsertRemoveTest", "[SerializationTest]")
+{
+  using neighbor::KNN;
+  arma::mat dataset = arma::randu<arma::mat>(5, 2000);
+
+  KNN knn(dataset, DUAL_TREE_MODE);
+  knn.Insert(arma::randu<arma::mat>(5, 100));
+  std::vector<size_t> indices;
+  for (size_t i = 0; i < 2100; i += 40)
+    indices.push_back(i);
+  knn.Remove(indices);
+
+  KNN knnXml, knnText, knnBinary;
+
+  SerializeObjectAll(knn, knnXml, knnText, knnBinary);
+
+  // The levels were saved as they are.
+  REQUIRE(knn.ReferenceTree().Dataset().n_cols == 2000);
+  REQUIRE(knnXml.ReferenceTree().Dataset().n_cols == 2000);
+  REQUIRE(knn.NumReferencePoints() == 2100 - indices.size());
+  REQUIRE(knnXml.NumReferencePoints() == knn.NumReferencePoints());
+  REQUIRE(knnText.NumReferencePoints() == knn.NumReferencePoints());
+  REQUIRE(knnBinary.NumReferencePoints() == knn.NumReferencePoints());
+
+  arma::mat querySet = arma::randu<arma::mat>(5, 1000);
+
+  arma::mat distances, xmlDistances, jsonDistances, binaryDistances;
+  arma::Mat<size_t> neighbors, xmlNeighbors, jsonNeighbors, binaryNeighbors;
+
+  knn.Search(querySet, 5, neighbors, distances);
+  knnXml.Search(querySet, 5, xmlNeighbors, xmlDistances);
+  knnText.Search(querySet, 5, jsonNeighbors, jsonDistances);
+  knnBinary.Search(querySet, 5, binaryNeighbors, binaryDistances);
+
+  CheckMatrices(distances, xmlDistances, jsonDistances, binaryDistances);
+  CheckMatrices(neighbors, xmlNeighbors, jsonNeighbors, binaryNeighbors);
+
+  knn.Search(5, neighbors, distances);
+  knnXml.Search(5, xmlNeighbors, xmlDistances);
+  knnText.Search(5, jsonNeighbors, jsonDistances);
+  knnBinary.Search(5, binaryNeighbors, binaryDistances);
+
+  CheckMatrices(distances, xmlDistances, jsonDistances, binaryDistances);
+  CheckMatrices(neighbors, xmlNeighbors, jsonNeighbors, binaryNeighbors);
+}
+
 TEST_CASE("SoftmaxRegressionTest", "[SerializationTest]")
 {
   using regression::SoftmaxRegression;
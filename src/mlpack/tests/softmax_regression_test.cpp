@@ -674,3 +674,40 @@ TEST_CASE("SoftmaxRegressionComputeProbabilitiesAndLabelsTest",
     REQUIRE(testLabels(i) == labels(i));
   }
 }
+
+/**
+ * Test training of softmax regression with SGD on a file read in blocks.
+ */
+TEST_CASE("SoftmaxRegressionBlockReaderSGDTest", "[SoftmaxRegressionTest]")
+{
+  // Generate a three-Gaussian dataset, with the classes interleaved so that
+  // each block holds every class.
+  GaussianDistribution g1(arma::vec("-4.0 0.0"), arma::eye<arma::mat>(2, 2));
+  GaussianDistribution g2(arma::vec("4.0 0.0"), arma::eye<arma::mat>(2, 2));
+  GaussianDistribution g3(arma::vec("0.0 6.0"), arma::eye<arma::mat>(2, 2));
+
+  arma::mat dataset(2, 3000);
+  arma::Row<size_t> responses(3000);
+  for (size_t i = 0; i < 3000; ++i)
+  {
+    dataset.col(i) = (i % 3 == 0) ? g1.Random() :
+        ((i % 3 == 1) ? g2.Random() : g3.Random());
+    responses[i] = i % 3;
+  }
+
+  data::Save("test_softmax.bin", dataset);
+  data::Save("test_softmax_labels.csv", responses);
+
+  // Make two passes over the file, in blocks of 150 points.
+  data::BlockReader reader("test_softmax.bin", 150);
+  data::BlockReader labelReader("test_softmax_labels.csv");
+  SoftmaxRegression sr(dataset.n_rows, 3, true);
+  sr.Train(reader, labelReader, 3, ens::StandardSGD(0.01, 1, 100000, 1e-10),
+      2);
+
+  const double acc = sr.ComputeAccuracy(dataset, responses);
+  REQUIRE(acc >= 97.0);
+
+  remove("test_softmax.bin");
+  remove("test_softmax_labels.csv");
+}
@@ -143,3 +143,99 @@ TEST_CASE("DisabledTimingTest", "[TimerTest]")
 
   REQUIRE(Timer::Get("test_timer") == std::chrono::microseconds(0));
 }
+
+/**
+ * Nested scopes should be recorded by their path, and counters should be
+ * attached to the innermost open scope.
+ */
+TEST_CASE("ProfilerNestedScopesTest", "[TimerTest]")
+{
+  Profiler::Reset();
+  Profiler::Enable();
+
+  {
+    ScopedTimer outer("outer");
+    {
+      ScopedTimer inner("inner");
+      Profiler::Count("work", 3);
+    }
+    Profiler::Count("work", 2);
+  }
+
+  // Timers are scopes of the profiler too.
+  Timer::Start("timer_scope");
+  Profiler::Count("work", 1);
+  Timer::Stop("timer_scope");
+
+  Profiler::Disable();
+
+  std::ostringstream stream;
+  Profiler::SaveJSON(stream);
+  const std::string json = stream.str();
+
+  REQUIRE(json.find("\"outer\": { \"time_us\"") != std::string::npos);
+  REQUIRE(json.find("\"outer/inner\": { \"time_us\"") != std::string::npos);
+  REQUIRE(json.find("\"outer/inner/work\": 3") != std::string::npos);
+  REQUIRE(json.find("\"outer/work\": 2") != std::string::npos);
+  REQUIRE(json.find("\"timer_scope/work\": 1") != std::string::npos);
+
+  // Nothing is recorded while profiling is disabled.
+  {
+    ScopedTimer disabled("disabled");
+    Profiler::Count("work", 1);
+  }
+
+  std::ostringstream stream2;
+  Profiler::SaveJSON(stream2);
+  REQUIRE(stream2.str() == json);
+
+  Profiler::Reset();
+}
+
+/**
+ * Counters of several threads should be merged, and threads without open
+ * scopes should record into the given parent scope.
+ */
+TEST_CASE("ProfilerMultithreadTest", "[TimerTest]")
+{
+  Profiler::Reset();
+  Profiler::Enable();
+
+  std::thread threads[4];
+  for (size_t i = 0; i < 4; ++i)
+  {
+    threads[i] = std::thread([]()
+        {
+          ScopedTimer timer("task", "root");
+          for (size_t j = 0; j < 10; ++j)
+            Profiler::Count("items", 1);
+        });
+  }
+
+  for (size_t i = 0; i < 4; ++i)
+    threads[i].join();
+
+  Profiler::Disable();
+
+  std::ostringstream stream;
+  Profiler::SaveJSON(stream);
+  const std::string json = stream.str();
+
+  REQUIRE(json.find("\"root/task/items\": 40") != std::string::npos);
+  REQUIRE(json.find("\"root/task\": { \"time_us\"") != std::string::npos);
+  REQUIRE(json.find("\"calls\": 4") != std::string::npos);
+
+  // Each thread has its own complete events in the trace.
+  std::ostringstream traceStream;
+  Profiler::SaveTrace(traceStream);
+  const std::string trace = traceStream.str();
+
+  REQUIRE(trace.find("\"traceEvents\"") != std::string::npos);
+  size_t events = 0;
+  for (size_t pos = trace.find("\"ph\": \"X\""); pos != std::string::npos;
+       pos = trace.find("\"ph\": \"X\"", pos + 1))
+    ++events;
+  REQUIRE(events == 4);
+
+  Profiler::Reset();
+}
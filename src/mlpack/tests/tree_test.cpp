@@ -14,7 +14,9 @@
 #include <mlpack/core/metrics/lmetric.hpp>
 #include <mlpack/core/metrics/mahalanobis_distance.hpp>
 #include <mlpack/core/tree/cover_tree/cover_tree.hpp>
+#include <mlpack/core/tree/flat_tree.hpp>
 #include <mlpack/core/tree/rectangle_tree.hpp>
+#include <mlpack/methods/range_search/range_search_stat.hpp>
 
 #include <queue>
 #include <stack>
@@ -2172,6 +2174,269 @@ TEST_CASE("BinarySpaceTreeCopyConstructor", "[TreeTest]")
   delete &b.Right()->Dataset();
 }
 
+//! Check that two trees have exactly the same structure.
+template<typename TreeType>
+void CheckIdenticalTrees(TreeType& node1, TreeType& node2)
+{
+  REQUIRE(node1.NumChildren() == node2.NumChildren());
+  REQUIRE(node1.NumDescendants() == node2.NumDescendants());
+  REQUIRE(node1.Descendant(0) == node2.Descendant(0));
+  REQUIRE(node1.ParentDistance() == node2.ParentDistance());
+  REQUIRE(node1.FurthestDescendantDistance() ==
+      node2.FurthestDescendantDistance());
+
+  arma::vec center1, center2;
+  node1.Center(center1);
+  node2.Center(center2);
+  REQUIRE(arma::all(center1 == center2));
+
+  for (size_t i = 0; i < node1.NumChildren(); ++i)
+    CheckIdenticalTrees(node1.Child(i), node2.Child(i));
+}
+
+//! Build a tree serially and in parallel, and make sure the results match.
+template<typename TreeType>
+void CheckParallelBuild()
+{
+  arma::mat dataset(5, 5000, arma::fill::randu);
+  std::vector<size_t> oldFromNewSerial, oldFromNewParallel;
+
+  // A cutoff larger than the dataset means a serial build.
+  TreeType serialTree(dataset, oldFromNewSerial, 10, dataset.n_cols);
+  TreeType parallelTree(dataset, oldFromNewParallel, 10, 100);
+
+  REQUIRE(oldFromNewSerial == oldFromNewParallel);
+  REQUIRE(arma::all(arma::vectorise(serialTree.Dataset() ==
+      parallelTree.Dataset())));
+  CheckIdenticalTrees(serialTree, parallelTree);
+}
+
+/**
+ * Make sure that building a binary space tree in parallel gives exactly the
+ * same tree as a serial build.
+ */
+TEST_CASE("BinarySpaceTreeParallelBuildTest", "[TreeTest]")
+{
+  CheckParallelBuild<KDTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+  CheckParallelBuild<MeanSplitKDTree<EuclideanDistance, EmptyStatistic,
+      arma::mat>>();
+  CheckParallelBuild<BallTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+}
+
+//! Check that the descendants of the given node are stored contiguously in
+//! depth-first order, starting at the given address.
+template<typename TreeType>
+void CheckDepthFirstLayout(TreeType& node, TreeType*& next)
+{
+  for (size_t i = 0; i < node.NumChildren(); ++i)
+  {
+    REQUIRE(&node.Child(i) == next);
+    REQUIRE(node.Child(i).Parent() == &node);
+    ++next;
+    CheckDepthFirstLayout(node.Child(i), next);
+  }
+}
+
+/**
+ * Make sure that compacting the nodes of a binary space tree keeps the tree
+ * the same, and that the nodes are laid out in depth-first order.
+ */
+TEST_CASE("BinarySpaceTreeCompactNodesTest", "[TreeTest]")
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> TreeType;
+
+  arma::mat dataset(3, 1000, arma::fill::randu);
+  TreeType tree(dataset, 10);
+  TreeType compactTree(tree);
+
+  REQUIRE(!compactTree.IsCompact());
+  compactTree.CompactNodes();
+  REQUIRE(compactTree.IsCompact());
+  CheckIdenticalTrees(tree, compactTree);
+
+  TreeType* next = &compactTree.Child(0);
+  CheckDepthFirstLayout(compactTree, next);
+
+  // Compacting again, copying, and moving must all work with a node pool.
+  compactTree.CompactNodes();
+  CheckIdenticalTrees(tree, compactTree);
+
+  TreeType copiedTree(compactTree);
+  REQUIRE(!copiedTree.IsCompact());
+  CheckIdenticalTrees(tree, copiedTree);
+
+  TreeType movedTree(std::move(compactTree));
+  REQUIRE(movedTree.IsCompact());
+  REQUIRE(!compactTree.IsCompact());
+  CheckIdenticalTrees(tree, movedTree);
+  next = &movedTree.Child(0);
+  CheckDepthFirstLayout(movedTree, next);
+
+  // Compacting a child is not allowed.
+  REQUIRE_THROWS_AS(movedTree.Child(0).CompactNodes(), std::invalid_argument);
+}
+
+//! Check that the bounds of two identical trees give the same distances.
+template<typename TreeType>
+void CheckSameBounds(TreeType& node1, TreeType& node2, const arma::vec& point)
+{
+  REQUIRE(node1.MinimumBoundDistance() == node2.MinimumBoundDistance());
+  REQUIRE(node1.Bound().MinDistance(point) == node2.Bound().MinDistance(point));
+  REQUIRE(node1.Bound().MaxDistance(point) == node2.Bound().MaxDistance(point));
+
+  for (size_t i = 0; i < node1.NumChildren(); ++i)
+    CheckSameBounds(node1.Child(i), node2.Child(i), point);
+}
+
+//! Save a binary space tree in the flat format, load it, and make sure the
+//! loaded tree is the same.
+template<typename TreeType>
+void CheckFlatSaveLoad()
+{
+  arma::mat dataset(4, 1000, arma::fill::randu);
+  std::vector<size_t> oldFromNew, loadedOldFromNew;
+  TreeType tree(dataset, oldFromNew, 15);
+
+  SaveFlat("test_flat_tree.bin", tree, oldFromNew);
+  TreeType* loadedTree = LoadFlat<TreeType>("test_flat_tree.bin",
+      loadedOldFromNew);
+  remove("test_flat_tree.bin");
+
+  REQUIRE(oldFromNew == loadedOldFromNew);
+  REQUIRE(arma::all(arma::vectorise(tree.Dataset() ==
+      loadedTree->Dataset())));
+  CheckIdenticalTrees(tree, *loadedTree);
+  CheckSameBounds(tree, *loadedTree, arma::vec(4, arma::fill::randu));
+
+  delete loadedTree;
+}
+
+/**
+ * Make sure that binary space trees can be saved and loaded in the flat tree
+ * format.
+ */
+TEST_CASE("BinarySpaceTreeFlatSaveLoadTest", "[TreeTest]")
+{
+  CheckFlatSaveLoad<KDTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+  CheckFlatSaveLoad<BallTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+  CheckFlatSaveLoad<VPTree<EuclideanDistance, EmptyStatistic, arma::mat>>();
+}
+
+/**
+ * Make sure that a binary space tree loaded with a mapping uses its dataset in
+ * place, holds its nodes in one pool, and gets the saved statistics.
+ */
+TEST_CASE("BinarySpaceTreeFlatMappedTest", "[TreeTest]")
+{
+  typedef KDTree<EuclideanDistance, range::RangeSearchStat, arma::mat>
+      TreeType;
+
+  arma::mat dataset(4, 1000, arma::fill::randu);
+  std::vector<size_t> oldFromNew, loadedOldFromNew;
+  TreeType tree(dataset, oldFromNew, 15);
+
+  // These statistics would be 0 if they were recomputed.
+  tree.Stat().LastDistance() = 3.0;
+  tree.Child(0).Stat().LastDistance() = 5.0;
+  tree.Child(1).Child(1).Stat().LastDistance() = 7.0;
+
+  SaveFlat("test_flat_tree.bin", tree, oldFromNew);
+  {
+    data::MappedFile mapping;
+    TreeType* loadedTree = LoadFlat<TreeType>("test_flat_tree.bin",
+        loadedOldFromNew, mapping);
+
+    const char* data = (const char*) loadedTree->Dataset().memptr();
+    REQUIRE(data >= mapping.Data());
+    REQUIRE(data < mapping.Data() + mapping.Size());
+    REQUIRE(loadedTree->IsCompact());
+
+    REQUIRE(oldFromNew == loadedOldFromNew);
+    REQUIRE(arma::all(arma::vectorise(tree.Dataset() ==
+        loadedTree->Dataset())));
+    CheckIdenticalTrees(tree, *loadedTree);
+    CheckSameBounds(tree, *loadedTree, arma::vec(4, arma::fill::randu));
+
+    REQUIRE(loadedTree->Stat().LastDistance() == 3.0);
+    REQUIRE(loadedTree->Child(0).Stat().LastDistance() == 5.0);
+    REQUIRE(loadedTree->Child(1).Child(1).Stat().LastDistance() == 7.0);
+    REQUIRE(loadedTree->Child(1).Stat().LastDistance() == 0.0);
+
+    delete loadedTree;
+  }
+  remove("test_flat_tree.bin");
+}
+
+//! Check that the scales of two identical cover trees are the same.
+template<typename TreeType>
+void CheckSameScales(TreeType& node1, TreeType& node2)
+{
+  REQUIRE(node1.Scale() == node2.Scale());
+  REQUIRE(node1.Base() == node2.Base());
+  REQUIRE(node1.Point() == node2.Point());
+
+  for (size_t i = 0; i < node1.NumChildren(); ++i)
+    CheckSameScales(node1.Child(i), node2.Child(i));
+}
+
+/**
+ * Make sure that cover trees can be saved and loaded in the flat tree format.
+ */
+TEST_CASE("CoverTreeFlatSaveLoadTest", "[TreeTest]")
+{
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      TreeType;
+
+  arma::mat dataset(4, 500, arma::fill::randu);
+  TreeType tree(dataset, 1.5);
+
+  SaveFlat("test_flat_tree.bin", tree);
+  TreeType* loadedTree = LoadFlat<TreeType>("test_flat_tree.bin");
+  remove("test_flat_tree.bin");
+
+  REQUIRE(arma::all(arma::vectorise(tree.Dataset() ==
+      loadedTree->Dataset())));
+  CheckIdenticalTrees(tree, *loadedTree);
+  CheckSameScales(tree, *loadedTree);
+
+  delete loadedTree;
+}
+
+/**
+ * Make sure that loading a flat tree file of the wrong tree type, or a
+ * truncated file, throws an exception.
+ */
+TEST_CASE("FlatTreeInvalidFileTest", "[TreeTest]")
+{
+  typedef KDTree<EuclideanDistance, EmptyStatistic, arma::mat> KDTreeType;
+  typedef StandardCoverTree<EuclideanDistance, EmptyStatistic, arma::mat>
+      CoverTreeType;
+
+  arma::mat dataset(3, 200, arma::fill::randu);
+  KDTreeType tree(dataset);
+  SaveFlat("test_flat_tree.bin", tree);
+
+  REQUIRE_THROWS_AS(LoadFlat<CoverTreeType>("test_flat_tree.bin"),
+      std::runtime_error);
+
+  // Truncate the file by removing its last node.
+  std::string contents;
+  {
+    std::ifstream in("test_flat_tree.bin", std::ios::binary);
+    contents.assign(std::istreambuf_iterator<char>(in),
+        std::istreambuf_iterator<char>());
+  }
+  {
+    std::ofstream out("test_flat_tree.bin", std::ios::binary |
+        std::ios::trunc);
+    out.write(contents.data(), contents.size() - 100);
+  }
+
+  REQUIRE_THROWS_AS(LoadFlat<KDTreeType>("test_flat_tree.bin"),
+      std::runtime_error);
+  remove("test_flat_tree.bin");
+}
+
 //! Count the number of leaves under this node.
 template<typename TreeType>
 size_t NumLeaves(TreeType* node)